@@ -117,3 +117,23 @@ function (ltjs_add_defaults)
 		endif ()
 	endif ()
 endfunction (ltjs_add_defaults)
+
+# Makes the GoogleTest targets available for unit test executables.  A system
+# GoogleTest is used when there is one, otherwise it's fetched.  Link tests
+# against GTest::gtest_main, which both provide.
+macro (ltjs_add_googletest)
+	if (NOT TARGET GTest::gtest_main)
+		include (FetchContent)
+		set (BUILD_GMOCK OFF CACHE BOOL "Disable gmock for unit tests." FORCE)
+		set (INSTALL_GTEST OFF CACHE BOOL "Disable GoogleTest install for unit tests." FORCE)
+		FetchContent_Declare (
+			googletest
+			GIT_REPOSITORY https://github.com/google/googletest.git
+			GIT_TAG v1.14.0
+			FIND_PACKAGE_ARGS NAMES GTest
+		)
+		FetchContent_MakeAvailable (googletest)
+	endif ()
+
+	include (GoogleTest)
+endmacro (ltjs_add_googletest)
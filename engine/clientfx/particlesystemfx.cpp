@@ -268,7 +268,6 @@ bool CParticleSystemProps::ParseProperties(FX_PROP* pProps, uint32 nNumProps)
 
 CParticleSystemFX::CParticleSystemFX( void )
 :	CBaseFX						( CBaseFX::eParticleSystemFX ),
-	m_nOptCount					( 0 ),
 	m_nNumParticles				( 0 ),
 	m_nNumBounceParticles		( 0 ),
 	m_nNumSplatParticles		( 0 ),
@@ -347,8 +346,9 @@ bool CParticleSystemFX::Init( ILTClient *pLTClient, FX_BASEDATA *pData, const CB
 	m_pLTClient->GetSurfaceDims(hScreen, &dwWidth, &dwHeight);
     m_fVisRadius /= ((LTFLOAT)dwWidth);
 
-	//The flags for the particle system
-	uint32 nFlags = PS_DUMB;
+	//The flags for the particle system. The particles are kept in arrays so
+	//that the whole system can be updated at once
+	uint32 nFlags = PS_DUMB | PS_ARRAYS;
 
 	if(GetProps()->m_bRotate)
 		nFlags |= PS_USEROTATION;
@@ -362,6 +362,10 @@ bool CParticleSystemFX::Init( ILTClient *pLTClient, FX_BASEDATA *pData, const CB
 	if(!GetProps()->m_bObjectSpace)
 		nFlags |= PS_WORLDSPACE;
 
+	//to change the rendering order, draw the newest particles first
+	if(GetProps()->m_bFlipOrder)
+		nFlags |= PS_DRAWREVERSED;
+
 	m_pLTClient->SetupParticleSystem(	m_hObject, 
 										GetProps()->m_szFileName, 
 										0.0f, 
@@ -392,101 +396,103 @@ bool CParticleSystemFX::Init( ILTClient *pLTClient, FX_BASEDATA *pData, const CB
 
 // ----------------------------------------------------------------------- //
 //
-//  ROUTINE:	CParticleSystemFX::UpdateParticleColor
+//  ROUTINE:	CParticleSystemFX::UpdateParticleColors
 //
-//  Given a particle, it will calculate the color of it where RGB range 
+//  Calculates the color of every particle where RGB range 
 //	from 0..255, and A ranges from 0..1.
 //
 // ----------------------------------------------------------------------- //
-void CParticleSystemFX::UpdateParticleColor(LTParticle* pLTParticle)
+void CParticleSystemFX::UpdateParticleColors(const LTParticleArrays& arrays)
 {
-	assert(pLTParticle);
-
-	float tmActual = (1.0f - pLTParticle->m_Lifetime / pLTParticle->m_TotalLifetime);
-
 	FX_COLOURKEY*	pKeys = GetProps()->m_pColorKeys;
 	uint32			nNumKeys = GetProps()->m_nNumColorKeys;
 
-	// Locate the keyframe, we can start at the cached keyframe since particle
-	// lifetimes only move forward (this is stored in the high word of the user
-	// data)
-	uint32 nCurrColour = GetKeyOffset(pLTParticle->m_nUserData, COLOR_KEY_OFFSET);
-
-	for (; nCurrColour + 1 < nNumKeys; nCurrColour++)
+	for(uint32 i = 0; i < arrays.m_nParticles; i++)
 	{
-		FX_COLOURKEY& endKey	= pKeys[nCurrColour + 1];
+		float tmActual = (1.0f - arrays.m_pLifetime[i] / arrays.m_pTotalLifetime[i]);
+
+		// Locate the keyframe, we can start at the cached keyframe since particle
+		// lifetimes only move forward (this is stored in the high word of the user
+		// data)
+		uint32 nCurrColour = GetKeyOffset(arrays.m_pUserData[i], COLOR_KEY_OFFSET);
 
-		if (tmActual < endKey.m_tmKey)
+		for (; nCurrColour + 1 < nNumKeys; nCurrColour++)
 		{
-			FX_COLOURKEY& startKey	= pKeys[nCurrColour];
+			FX_COLOURKEY& endKey	= pKeys[nCurrColour + 1];
 
-			// Use this and the previous key to compute the colour
+			if (tmActual < endKey.m_tmKey)
+			{
+				FX_COLOURKEY& startKey	= pKeys[nCurrColour];
 
-			float tmDist = endKey.m_tmKey - startKey.m_tmKey;
+				// Use this and the previous key to compute the colour
 
-			//note that the distance should always be greater than 0
-			assert(tmDist > 0.0f);
-			
-			float ratio = (tmActual - startKey.m_tmKey) / tmDist;
+				float tmDist = endKey.m_tmKey - startKey.m_tmKey;
+
+				//note that the distance should always be greater than 0
+				assert(tmDist > 0.0f);
 				
-			pLTParticle->m_Color.x = (startKey.m_red + ((endKey.m_red - startKey.m_red) * ratio));
-			pLTParticle->m_Color.y = (startKey.m_green + ((endKey.m_green - startKey.m_green) * ratio));
-			pLTParticle->m_Color.z = (startKey.m_blue + ((endKey.m_blue - startKey.m_blue) * ratio));
-			pLTParticle->m_Alpha   = 1.0f - (startKey.m_alpha + (endKey.m_alpha - startKey.m_alpha) * ratio) / 255.0f;
+				float ratio = (tmActual - startKey.m_tmKey) / tmDist;
+					
+				arrays.m_pColorR[i]	= (startKey.m_red + ((endKey.m_red - startKey.m_red) * ratio));
+				arrays.m_pColorG[i]	= (startKey.m_green + ((endKey.m_green - startKey.m_green) * ratio));
+				arrays.m_pColorB[i]	= (startKey.m_blue + ((endKey.m_blue - startKey.m_blue) * ratio));
+				arrays.m_pAlpha[i]	= 1.0f - (startKey.m_alpha + (endKey.m_alpha - startKey.m_alpha) * ratio) / 255.0f;
 
-			//all done calculating colors, might as well bail
-			break;
+				//all done calculating colors, might as well bail
+				break;
+			}
 		}
-	}
 
-	//save this color keyframe for next time...
-	SetKeyOffset(pLTParticle->m_nUserData, nCurrColour, COLOR_KEY_OFFSET);
+		//save this color keyframe for next time...
+		SetKeyOffset(arrays.m_pUserData[i], nCurrColour, COLOR_KEY_OFFSET);
+	}
 }
 
 // ----------------------------------------------------------------------- //
 //
-//  ROUTINE:	CParticleSystemFX::CalcParticleScale
+//  ROUTINE:	CParticleSystemFX::UpdateParticleScales
 //
-//  Given a particle, it will calculate the scale for it based upon the
-//	scale keyframes
+//  Calculates the scale of every particle based upon the scale
+//	keyframes
 //
 // ----------------------------------------------------------------------- //
-void CParticleSystemFX::UpdateParticleScale(LTParticle* pLTParticle)
+void CParticleSystemFX::UpdateParticleScales(const LTParticleArrays& arrays)
 {
-	assert(pLTParticle);
-
-	float tmActual = (1.0f - pLTParticle->m_Lifetime / pLTParticle->m_TotalLifetime);
-
 	FX_SCALEKEY*	pKeys = GetProps()->m_pScaleKeys;
 	uint32			nNumKeys = GetProps()->m_nNumScaleKeys;
 
-	// Locate the keyframe
-	uint32 nCurrScaleKey = GetKeyOffset(pLTParticle->m_nUserData, SCALE_KEY_OFFSET);
-
-	for (; nCurrScaleKey + 1 < nNumKeys; nCurrScaleKey++)
+	for(uint32 i = 0; i < arrays.m_nParticles; i++)
 	{
-		FX_SCALEKEY& endKey		= pKeys[nCurrScaleKey + 1];
+		float tmActual = (1.0f - arrays.m_pLifetime[i] / arrays.m_pTotalLifetime[i]);
 
-		if (tmActual < endKey.m_tmKey)
+		// Locate the keyframe
+		uint32 nCurrScaleKey = GetKeyOffset(arrays.m_pUserData[i], SCALE_KEY_OFFSET);
+
+		for (; nCurrScaleKey + 1 < nNumKeys; nCurrScaleKey++)
 		{
-			FX_SCALEKEY& startKey	= pKeys[nCurrScaleKey];
+			FX_SCALEKEY& endKey		= pKeys[nCurrScaleKey + 1];
 
-			// Use this and the previous key to compute the colour
+			if (tmActual < endKey.m_tmKey)
+			{
+				FX_SCALEKEY& startKey	= pKeys[nCurrScaleKey];
 
-			float tmDist = endKey.m_tmKey - startKey.m_tmKey;
-			
-			assert(tmDist > 0.0f);
+				// Use this and the previous key to compute the colour
 
-			float ratio	 = (endKey.m_scale - startKey.m_scale) / tmDist;
-			pLTParticle->m_Size = startKey.m_scale + (ratio * (tmActual - startKey.m_tmKey));
-			
-			//got the scale, bail
-			break;
+				float tmDist = endKey.m_tmKey - startKey.m_tmKey;
+				
+				assert(tmDist > 0.0f);
+
+				float ratio	 = (endKey.m_scale - startKey.m_scale) / tmDist;
+				arrays.m_pSize[i] = startKey.m_scale + (ratio * (tmActual - startKey.m_tmKey));
+				
+				//got the scale, bail
+				break;
+			}
 		}
+		
+		//cache this scale for next time...
+		SetKeyOffset(arrays.m_pUserData[i], nCurrScaleKey, SCALE_KEY_OFFSET);
 	}
-	
-	//cache this scale for next time...
-	SetKeyOffset(pLTParticle->m_nUserData, nCurrScaleKey, SCALE_KEY_OFFSET);
 }
 
 
@@ -600,6 +606,17 @@ void CParticleSystemFX::AddParticles( )
 	LTRotation	rRot;
 	LTMatrix	mMat;
 
+	LTParticleArrays	arrays;
+	uint32				nNumToAdd = GetProps()->m_nParticlesPerEmission;
+
+	// Add all the new particles to the system at once, they're filled in below
+	if( !nNumToAdd || (m_pLTClient->AddParticleArrays( m_hObject, nNumToAdd, &arrays ) != LT_OK) )
+	{
+		return;
+	}
+
+	uint32	iFirst = arrays.m_nParticles - nNumToAdd;
+
 	
 	if( !GetProps()->m_bObjectSpace )
 	{
@@ -610,7 +627,7 @@ void CParticleSystemFX::AddParticles( )
 	}
 
 
-	for( uint32 i = 0; i < GetProps()->m_nParticlesPerEmission; i++ )
+	for( uint32 i = 0; i < nNumToAdd; i++ )
 	{
 		// What kind of emission do we have?
 		switch( GetProps()->m_eType )
@@ -735,16 +752,25 @@ void CParticleSystemFX::AddParticles( )
 
 		fTempLifeSpan = GetRandom( GetProps()->m_fMinLifeSpan, GetProps()->m_fMaxLifeSpan );
 
-		// Try and add the new particle to the system
-		LTParticle* pParticle = m_pLTClient->AddParticle( m_hObject, &vPos, &vVel, &vColor, fTempLifeSpan );
-		if( !pParticle )
-		{
-			return;
-		}
-
-		pParticle->m_nUserData	= 0;
-		pParticle->m_Alpha		= GetProps()->m_pColorKeys[0].m_alpha;
-		pParticle->m_Size		= GetProps()->m_pScaleKeys[m_nCurrScaleKey].m_scale;
+		// Fill in the new particle
+		uint32 iParticle = iFirst + i;
+
+		arrays.m_pPosX[iParticle]			= vPos.x;
+		arrays.m_pPosY[iParticle]			= vPos.y;
+		arrays.m_pPosZ[iParticle]			= vPos.z;
+		arrays.m_pVelX[iParticle]			= vVel.x;
+		arrays.m_pVelY[iParticle]			= vVel.y;
+		arrays.m_pVelZ[iParticle]			= vVel.z;
+		arrays.m_pColorR[iParticle]			= vColor.x;
+		arrays.m_pColorG[iParticle]			= vColor.y;
+		arrays.m_pColorB[iParticle]			= vColor.z;
+		arrays.m_pAlpha[iParticle]			= GetProps()->m_pColorKeys[0].m_alpha;
+		arrays.m_pSize[iParticle]			= GetProps()->m_pScaleKeys[m_nCurrScaleKey].m_scale;
+		arrays.m_pLifetime[iParticle]		= fTempLifeSpan;
+		arrays.m_pTotalLifetime[iParticle]	= fTempLifeSpan;
+
+		uint32& nUserData = arrays.m_pUserData[iParticle];
+		nUserData = 0;
 
 		//update our counts
 		m_nNumParticles++;
@@ -752,15 +778,15 @@ void CParticleSystemFX::AddParticles( )
 		// Randomize the angle information if needed
 		if(GetProps()->m_bRotate)
 		{
-			pParticle->m_fAngle				= GetRandom(0.0f, 2 * PI);
-			pParticle->m_fAngularVelocity	= GetRandom(GetProps()->m_fMinAngularVelocity, GetProps()->m_fMaxAngularVelocity);
+			arrays.m_pAngle[iParticle]				= GetRandom(0.0f, 2 * PI);
+			arrays.m_pAngularVelocity[iParticle]	= GetRandom(GetProps()->m_fMinAngularVelocity, GetProps()->m_fMaxAngularVelocity);
 		}
 
 		//determine if we want this particle to bounce
 		if((GetProps()->m_fPercentToBounce > 0.001f) && (GetRandom(0.0f, 100.0f) < GetProps()->m_fPercentToBounce))
 		{
 			//this particle should bounce
-			pParticle->m_nUserData |= BOUNCE_FLAG;
+			nUserData |= BOUNCE_FLAG;
 			m_nNumBounceParticles++;
 		}
 
@@ -768,33 +794,9 @@ void CParticleSystemFX::AddParticles( )
 		if(GetProps()->m_szSplatEffect[0] && (GetProps()->m_fPercentToSplat > 0.001f) && (GetRandom(0.0f, 100.0f) < GetProps()->m_fPercentToSplat))
 		{
 			//this particle should bounce
-			pParticle->m_nUserData |= SPLAT_FLAG;
+			nUserData |= SPLAT_FLAG;
 			m_nNumSplatParticles++;
 		}
-
-
-		// To change the rendering order, move the newly added particle from the tail to the head.
-
-		if( GetProps()->m_bFlipOrder )
-		{
-			LTParticle	*pHead = LTNULL;
-			LTParticle	*pTail = LTNULL;
-
-			if( m_pLTClient->GetParticles( m_hObject, &pHead, &pTail ) )
-			{
-				if( pHead != pParticle )
-				{
-					// Move the Cur particle to the head...
-
-					pParticle->m_pPrev->m_pNext	= pParticle->m_pNext;
-					pTail->m_pPrev				= pParticle->m_pPrev;
-					pParticle->m_pNext			= pHead->m_pNext;
-					pHead->m_pNext->m_pPrev		= pParticle;
-					pHead->m_pNext				= pParticle;
-					pParticle->m_pPrev			= pHead;
-				}
-			}
-		}
 	}
 }
 
@@ -803,25 +805,26 @@ void CParticleSystemFX::AddParticles( )
 //
 //  ROUTINE:	CParticleSystemFX::RemoveParticle
 //
-//  PURPOSE:	Removes the passed in particle from the system and maintains
-//				appropriate counts
+//  PURPOSE:	Marks the passed in particle for removal from the system and
+//				maintains appropriate counts. It goes away with the other
+//				expired particles on the next RemoveExpiredParticles
 //
 // ----------------------------------------------------------------------- //
 
-void CParticleSystemFX::RemoveParticle(LTParticle* pParticle)
+void CParticleSystemFX::RemoveParticle(const LTParticleArrays& arrays, uint32 iParticle)
 {
 	// Disable this particle
- 	m_pLTClient->RemoveParticle( m_hObject, pParticle );
+	arrays.m_pLifetime[iParticle] = 0.0f;
 
 	//update our counts
 	assert(m_nNumParticles > 0);
 	m_nNumParticles--;
 	
-	if(pParticle->m_nUserData & BOUNCE_FLAG)
+	if(arrays.m_pUserData[iParticle] & BOUNCE_FLAG)
 	{
 		m_nNumBounceParticles--;
 	}
-	if(pParticle->m_nUserData & SPLAT_FLAG)
+	if(arrays.m_pUserData[iParticle] & SPLAT_FLAG)
 	{
 		m_nNumSplatParticles--;
 	}
@@ -863,68 +866,60 @@ void CParticleSystemFX::UpdateParticles( LTFLOAT tmFrame )
 		vGravity = mInvObjSpace * vGravity;
 	}
 
-	LTParticle	*pHead = LTNULL;
-	LTParticle	*pTail = LTNULL;
+	LTParticleArrays arrays;
 
-	if( !m_pLTClient->GetParticles( m_hObject, &pHead, &pTail ) )
+	if( !m_pLTClient->GetParticleArrays( m_hObject, &arrays ) )
 		return;
 
-	LTParticle  *pLTParticle = pHead;
-	LTParticle  *pNext;
+	// Move every particle and apply gravity and friction to the velocities
+	lt_IntegrateParticles( arrays, tmFrame, vGravity, fFrictionCoef );
 
-	while(pLTParticle != pTail)
+	if( GetProps()->m_bObjectSpace && GetProps()->m_bSwarm )
 	{
-		//cache the next in case this particle is removed
-		pNext = pLTParticle->m_pNext;
+		lt_TransformParticles( arrays, m_matSwarm );
+	}
 
-		//update the lifetime
-		pLTParticle->m_Lifetime -= tmFrame;
-		
-		// Check for expiration
-		if( pLTParticle->m_Lifetime <= 0.0f )
+	// Check for expiration
+	bool bExpired = false;
+
+	for( uint32 iParticle = 0; iParticle < arrays.m_nParticles; iParticle++ )
+	{
+		float& fLifetime = arrays.m_pLifetime[iParticle];
+
+		if( fLifetime > 0.0f )
+			continue;
+
+		if(GetProps()->m_bInfiniteLife)
 		{
-			if(GetProps()->m_bInfiniteLife)
-			{
-				//this particle has died, but resurrect it since it lives forever
-				pLTParticle->m_Lifetime = pLTParticle->m_TotalLifetime - fmodf(-pLTParticle->m_Lifetime, pLTParticle->m_TotalLifetime); 				
+			//this particle has died, but resurrect it since it lives forever
+			float fTotalLifetime = arrays.m_pTotalLifetime[iParticle];
+			fLifetime = fTotalLifetime - fmodf(-fLifetime, fTotalLifetime);
 
-				//reset the color and scale keys so that they won't get messed up
-				SetKeyOffset(pLTParticle->m_nUserData, 0, COLOR_KEY_OFFSET);
-				SetKeyOffset(pLTParticle->m_nUserData, 0, SCALE_KEY_OFFSET);
-			}
-			else
-			{
-				RemoveParticle(pLTParticle);
-			}
+			//reset the color and scale keys so that they won't get messed up
+			SetKeyOffset(arrays.m_pUserData[iParticle], 0, COLOR_KEY_OFFSET);
+			SetKeyOffset(arrays.m_pUserData[iParticle], 0, SCALE_KEY_OFFSET);
 		}
 		else
 		{
-			// Give the particle an update
-
-			// Update the angle if appropriate
-			pLTParticle->m_fAngle	+= pLTParticle->m_fAngularVelocity * tmFrame;
-			pLTParticle->m_Pos		+= pLTParticle->m_Velocity * tmFrame;
-
-			// Move it
-			if( GetProps()->m_bObjectSpace && GetProps()->m_bSwarm)
-			{
-				pLTParticle->m_Pos = m_matSwarm * pLTParticle->m_Pos;
-			}
-
-			//update the velocity, applying gravity and friction
-			pLTParticle->m_Velocity.x = pLTParticle->m_Velocity.x * fFrictionCoef + vGravity.x;
-			pLTParticle->m_Velocity.y = pLTParticle->m_Velocity.y * fFrictionCoef + vGravity.y;
-			pLTParticle->m_Velocity.z = pLTParticle->m_Velocity.z * fFrictionCoef + vGravity.z;
-
-			// Color it and scale it
-			UpdateParticleColor(pLTParticle);
-			UpdateParticleScale(pLTParticle);
+			RemoveParticle(arrays, iParticle);
+			bExpired = true;
 		}
+	}
+
+	if( bExpired )
+	{
+		m_pLTClient->RemoveExpiredParticles( m_hObject );
 
-		pLTParticle = pNext;
+		//removing particles moves the rest down, so get the arrays again
+		if( !m_pLTClient->GetParticleArrays( m_hObject, &arrays ) )
+			return;
 	}
 
-	//bounce is broken out of the above loop since it was rarely used, so it was 
+	// Color it and scale it
+	UpdateParticleColors(arrays);
+	UpdateParticleScales(arrays);
+
+	//bounce is broken out of the above loops since it was rarely used, so it was 
 	//just adding an additional if per particle as well as adding a lot of code 
 	//to the inner loop
 	if( (m_nNumBounceParticles > 0) || (m_nNumSplatParticles > 0) )
@@ -932,10 +927,6 @@ void CParticleSystemFX::UpdateParticles( LTFLOAT tmFrame )
 		ClientIntersectQuery	iQuery;
 		ClientIntersectInfo		iInfo;
 
-		//we need to re-get the head and tail pointers (in case they were removed because of lifespan)
-		if( !m_pLTClient->GetParticles( m_hObject, &pHead, &pTail ) )
-			return;
-
 		//figure out our transform if we are in object space
 		LTMatrix mObjTransform;
 		if(GetProps()->m_bObjectSpace)
@@ -950,36 +941,41 @@ void CParticleSystemFX::UpdateParticles( LTFLOAT tmFrame )
 			// Setup the swarmming matrix
 			SetupRotationAroundPoint( mObjTransform, rObjRot, vObjPos ); 
 		}
-		
-		LTParticle* pNext = NULL;
-		for(pLTParticle = pHead; pLTParticle != pTail; pLTParticle = pNext)
-		{
-			//save the next particle in case it gets removed
-			pNext = pLTParticle->m_pNext;
 
+		bool bKilled = false;
+
+		for( uint32 iParticle = 0; iParticle < arrays.m_nParticles; iParticle++ )
+		{
 			//make sure that this particle is set to bounce
-			if(!(pLTParticle->m_nUserData & (BOUNCE_FLAG | SPLAT_FLAG)))
+			uint32 nUserData = arrays.m_pUserData[iParticle];
+			if(!(nUserData & (BOUNCE_FLAG | SPLAT_FLAG)))
 				continue;
 
+			//skip particles killed by a splat this frame
+			if(arrays.m_pLifetime[iParticle] <= 0.0f)
+				continue;
+
+			LTVector vParticlePos(arrays.m_pPosX[iParticle], arrays.m_pPosY[iParticle], arrays.m_pPosZ[iParticle]);
+			LTVector vVel(arrays.m_pVelX[iParticle], arrays.m_pVelY[iParticle], arrays.m_pVelZ[iParticle]);
+
 			//see if we need to convert our points into world space
 			if(GetProps()->m_bObjectSpace)
 			{
-				LTVector vPos	= m_vPos + pLTParticle->m_Pos;
+				LTVector vPos	= m_vPos + vParticlePos;
 				iQuery.m_From	= mObjTransform * vPos;
-				iQuery.m_To		= mObjTransform * (vPos + pLTParticle->m_Velocity * tmFrame);
+				iQuery.m_To		= mObjTransform * (vPos + vVel * tmFrame);
 			}
 			else
 			{
-				iQuery.m_From	= pLTParticle->m_Pos;
-				iQuery.m_To		= pLTParticle->m_Pos + pLTParticle->m_Velocity * tmFrame;
+				iQuery.m_From	= vParticlePos;
+				iQuery.m_To		= vParticlePos + vVel * tmFrame;
 			}
 
 			if( m_pLTClient->IntersectSegment( &iQuery, &iInfo ) )
 			{
 				//handle bounce
-				if(pLTParticle->m_nUserData & BOUNCE_FLAG)
+				if(nUserData & BOUNCE_FLAG)
 				{
-					LTVector& vVel			= pLTParticle->m_Velocity;
 					const LTVector& vNormal = iInfo.m_Plane.m_Normal;
 
 					//reflect the velocity over the normal
@@ -987,10 +983,14 @@ void CParticleSystemFX::UpdateParticles( LTFLOAT tmFrame )
 
 					//apply some hack coefficient of restitution
 					vVel *= 0.75f;
+
+					arrays.m_pVelX[iParticle] = vVel.x;
+					arrays.m_pVelY[iParticle] = vVel.y;
+					arrays.m_pVelZ[iParticle] = vVel.z;
 				}
 
 				//handle splat
-				if(pLTParticle->m_nUserData & SPLAT_FLAG)
+				if(nUserData & SPLAT_FLAG)
 				{
 					//alright, we now need to create a splat effect
 
@@ -1038,22 +1038,18 @@ void CParticleSystemFX::UpdateParticles( LTFLOAT tmFrame )
 					if(GetProps()->m_bKillOnSplat)
 					{
 						//we do....
-						RemoveParticle(pLTParticle);
+						RemoveParticle(arrays, iParticle);
+						bKilled = true;
 					}
 				}
-
-				//NOTE: Particle should not be used from this point or beyond since
-				//it can be removed above
 			}
 		}
-	}
 
-	if( ++m_nOptCount == PS_OPTIMIZE_COUNT )
-	{
-		m_pLTClient->OptimizeParticles( m_hObject );
-		m_nOptCount = 0;
+		if( bKilled )
+		{
+			m_pLTClient->RemoveExpiredParticles( m_hObject );
+		}
 	}
-
 }
 
 // ----------------------------------------------------------------------- //
@@ -24,7 +24,6 @@
 //
 
 	#define PS_DEFAULT_VISRADIUS	500
-	#define	PS_OPTIMIZE_COUNT		60		// How many updates before we optimize again
 
 	enum ePSType
 	{
@@ -97,8 +96,6 @@
 			LTMatrix			m_matSwarm;
 			LTVector			m_vRandomPoint;			// Random for the system not per particle
 						
-			uint8				m_nOptCount;			// we only want to optimize the system every so often...
-														// this keeps track of when.
 			uint32				m_nNumParticles;		// the number of currently outstanding particles
 			uint32				m_nNumBounceParticles;	// the number of currently outstanding particles that bounce
 			uint32				m_nNumSplatParticles;	// the number of currently outstanding particles that splat
@@ -124,10 +121,10 @@
 
 			const CParticleSystemProps*	GetProps()		{ return (const CParticleSystemProps*)m_pProps; }
 
-			void	RemoveParticle(LTParticle* pParticle);
+			void	RemoveParticle(const LTParticleArrays& arrays, uint32 iParticle);
 
-			void	UpdateParticleColor(LTParticle* pParticle);
-			void	UpdateParticleScale(LTParticle* pParticle);
+			void	UpdateParticleColors(const LTParticleArrays& arrays);
+			void	UpdateParticleScales(const LTParticleArrays& arrays);
 
 			void	ReadProps( CLinkList<FX_PROP> *pProps );
 			void	AddParticles( );
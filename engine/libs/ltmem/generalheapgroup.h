@@ -17,6 +17,8 @@
 #include "generalheap.h"
 #endif
 
+#include <atomic>
+
 class CGeneralHeapGroup 
 {
 public:
@@ -62,6 +64,8 @@ public:
 	inline bool Free(void* pFreeMem);
 
 	// check if this memory is in this heap
+	// this may be called while another thread is in Alloc since new heaps
+	// are only ever added to the front of the list
 	inline bool InHeap(void* pMem);
 
 	// get the size of a piece of allocated memory
@@ -188,9 +192,9 @@ inline bool CGeneralHeapGroup::AddHeap(
 	// initialize the general heap
 	pNewHeap->m_heap.Init((std::uintptr_t)pHeapMem, nHeapSize, nHeapAlign);
 
-	// add to heap list
+	// add to heap list, publishing it after it is set up so InHeap never sees it half built
 	pNewHeap->m_pNext = m_pHeapList;
-	m_pHeapList = pNewHeap;
+	std::atomic_ref<CGeneralHeapItem*>(m_pHeapList).store(pNewHeap, std::memory_order_release);
 
 	return true;
 }
@@ -268,7 +272,7 @@ inline bool CGeneralHeapGroup::InHeap(void* pMem)
 	ASSERT(m_bInitialized);
 
 	// current heap we are looking at
-	CGeneralHeapItem* pCurHeap = m_pHeapList;
+	CGeneralHeapItem* pCurHeap = std::atomic_ref<CGeneralHeapItem*>(m_pHeapList).load(std::memory_order_acquire);
 
 	// find which heap this memory belongs to
 	while (pCurHeap != NULL)
@@ -17,6 +17,8 @@
 #include "lilfixedheap.h"
 #endif
 
+#include <atomic>
+
 class CLilFixedHeapGroup 
 {
 public:
@@ -61,6 +63,8 @@ public:
 	inline bool Free(void* pFreeMem);
 
 	// check if this memory is in this heap
+	// this may be called while another thread is in Alloc since new heaps
+	// are only ever added to the front of the list
 	inline bool InHeap(void* pMem);
 
 	// memory allocations for this class will go though system malloc and free
@@ -192,7 +196,9 @@ inline void* CLilFixedHeapGroup::Alloc()
 		return NULL;
 	}
 	pMem = pCurHeap->m_heap.Alloc();
-	m_pHeapList = pCurHeap;
+
+	// publish the new heap after it is set up so InHeap never sees it half built
+	std::atomic_ref<CLilFixedHeapItem*>(m_pHeapList).store(pCurHeap, std::memory_order_release);
 
 	// return memory we allocated
 	return pMem;
@@ -233,7 +239,7 @@ inline bool CLilFixedHeapGroup::InHeap(void* pMem)
 	ASSERT(m_bInitialized);
 
 	// current heap we are looking at
-	CLilFixedHeapItem* pCurHeap = m_pHeapList;
+	CLilFixedHeapItem* pCurHeap = std::atomic_ref<CLilFixedHeapItem*>(m_pHeapList).load(std::memory_order_acquire);
 
 	// find which heap this memory belongs to
 	while (pCurHeap != NULL)
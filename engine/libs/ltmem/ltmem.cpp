@@ -20,6 +20,12 @@ bool g_bLTMemInitialized = false;
 // critical section to make heap thread safe
 CRITICAL_SECTION g_LTMemCriticalSection; 
 
+// the threaded heap does its own locking, so allocations only need the critical
+// section when tracking or debugging information has to be kept with them
+#if defined(LTMEMTHREADED) && !defined(LTMEMDEBUG) && !defined(LTMEMTRACK)
+#define LTMEMHEAPLOCKS
+#endif
+
 #endif
 ///////////////////////////////////////////////////////////////////////////////////////////
 // Initializer class for ltmem
@@ -119,8 +125,10 @@ void* LTMemAlloc(uint32 nSize)
 	// make sure memory system is initialize
 	if (g_bLTMemInitialized == false) LTMemInit();
 
+#ifndef LTMEMHEAPLOCKS
 	// Request ownership of the LTMem critical section.
 	EnterCriticalSection(&g_LTMemCriticalSection); 
+#endif
 
 #ifdef LTMEMDEBUG
 	pRet = LTMemDebugAlloc(nSize);
@@ -132,8 +140,10 @@ void* LTMemAlloc(uint32 nSize)
 #endif
 #endif
 
+#ifndef LTMEMHEAPLOCKS
     // Release ownership of the LTMem critical section.
     LeaveCriticalSection(&g_LTMemCriticalSection);
+#endif
 
 	return pRet;
 
@@ -147,8 +157,10 @@ void* LTMemAlloc(uint32 nSize)
 void LTMemFree(void* pMem)
 {
 #ifdef USELTMEM
+#ifndef LTMEMHEAPLOCKS
 	// Request ownership of the LTMem critical section.
 	EnterCriticalSection(&g_LTMemCriticalSection); 
+#endif
 
 #ifdef LTMEMDEBUG
 	LTMemDebugFree(pMem);
@@ -160,8 +172,10 @@ void LTMemFree(void* pMem)
 #endif
 #endif
 
+#ifndef LTMEMHEAPLOCKS
     // Release ownership of the LTMem critical section.
     LeaveCriticalSection(&g_LTMemCriticalSection);
+#endif
 
 #else
 	free(pMem);
@@ -175,8 +189,10 @@ void* LTMemReAlloc(void* pOldMem, uint32 nNewSize)
 #ifdef USELTMEM
 	void* pRet;
 
+#ifndef LTMEMHEAPLOCKS
 	// Request ownership of the LTMem critical section.
 	EnterCriticalSection(&g_LTMemCriticalSection); 
+#endif
 
 #ifdef LTMEMDEBUG
 	pRet = LTMemDebugReAlloc(pOldMem, nNewSize);
@@ -188,8 +204,10 @@ void* LTMemReAlloc(void* pOldMem, uint32 nNewSize)
 #endif
 #endif
 
+#ifndef LTMEMHEAPLOCKS
     // Release ownership of the LTMem critical section.
     LeaveCriticalSection(&g_LTMemCriticalSection);
+#endif
 
 	return pRet;
 
@@ -4,6 +4,11 @@
 #include "ltmemheap.h"
 #include "generalheapgroup.h"
 
+#ifdef LTMEMTHREADED
+#include <atomic>
+#include <mutex>
+#endif
+
 // define if we are using the simple heaps
 #define LTMEMUSESIMPLEHEAP
 
@@ -50,9 +55,298 @@ const uint32 g_nGeneralHeapGrowSize = 1024*1024*16;
 // alignment of the general heap
 const uint32 g_nGeneralHeapAlign = 16;
 
+#ifndef LTMEMTHREADED
+
 // general heap
 CGeneralHeapGroup g_GeneralHeap;
 
+#endif
+
+
+#ifdef LTMEMTHREADED
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// threaded heap
+///////////////////////////////////////////////////////////////////////////////////////////
+
+// number of general heaps large allocations are spread over
+#define LTMEMHEAPNUMGENERALSTRIPES 4
+
+// number of blocks moved between a thread cache and a simple heap at once
+#define LTMEMTHREADCACHEBATCH 32
+
+// most blocks a thread cache holds for one size before giving some back
+#define LTMEMTHREADCACHEMAX 128
+
+// locks for each of the simple heaps, only taken to move blocks to or from a thread cache
+std::mutex g_arySimpleHeapLocks[LTMEMHEAPNUMSIMPLEHEAPSIZES];
+
+// general heaps, each thread allocates from one of these picked when it first allocates
+CGeneralHeapGroup g_aryGeneralHeaps[LTMEMHEAPNUMGENERALSTRIPES];
+
+// locks for each of the general heaps
+std::mutex g_aryGeneralHeapLocks[LTMEMHEAPNUMGENERALSTRIPES];
+
+// general heap the next thread to allocate will use
+std::atomic<uint32> g_nNextGeneralHeapStripe(0);
+
+// free blocks from the simple heaps kept by a single thread
+struct CLTMemThreadCache
+{
+	~CLTMemThreadCache();
+
+	// free blocks for each simple heap size, linked through their first pointer
+	void* m_pFreeList[LTMEMHEAPNUMSIMPLEHEAPSIZES];
+
+	// number of blocks in each free list
+	uint32 m_nNumFree[LTMEMHEAPNUMSIMPLEHEAPSIZES];
+};
+
+thread_local CLTMemThreadCache t_LTMemThreadCache;
+
+
+// give blocks from a thread cache back to their simple heap
+static void LTMemHeapReturnBlocks(CLTMemThreadCache& cache, uint32 nHeap, uint32 nCount)
+{
+	std::lock_guard<std::mutex> lock(g_arySimpleHeapLocks[nHeap]);
+
+	while ((nCount > 0) && (cache.m_pFreeList[nHeap] != NULL))
+	{
+		void* pMem = cache.m_pFreeList[nHeap];
+		cache.m_pFreeList[nHeap] = *(void**)pMem;
+		cache.m_nNumFree[nHeap]--;
+		nCount--;
+
+		g_arySimpleHeaps[nHeap].Free(pMem);
+	}
+}
+
+
+// a thread that is going away gives its blocks back so other threads can use them
+CLTMemThreadCache::~CLTMemThreadCache()
+{
+	// if the heap is gone so is the memory in the cache
+	if (!g_bLTMemHeapInitialized) return;
+
+	for (uint32 n = 0; n < LTMEMHEAPNUMSIMPLEHEAPSIZES; n++)
+	{
+		LTMemHeapReturnBlocks(*this, n, m_nNumFree[n]);
+	}
+}
+
+
+// allocate a block from a simple heap through this thread's cache
+static void* LTMemHeapAllocSimple(uint32 nHeap)
+{
+	CLTMemThreadCache& cache = t_LTMemThreadCache;
+
+	// refill the cache from the simple heap if it is empty
+	if (cache.m_pFreeList[nHeap] == NULL)
+	{
+		std::lock_guard<std::mutex> lock(g_arySimpleHeapLocks[nHeap]);
+
+		for (uint32 n = 0; n < LTMEMTHREADCACHEBATCH; n++)
+		{
+			void* pMem = g_arySimpleHeaps[nHeap].Alloc();
+			if (pMem == NULL) break;
+
+			*(void**)pMem = cache.m_pFreeList[nHeap];
+			cache.m_pFreeList[nHeap] = pMem;
+			cache.m_nNumFree[nHeap]++;
+		}
+
+		if (cache.m_pFreeList[nHeap] == NULL) return NULL;
+	}
+
+	void* pMem = cache.m_pFreeList[nHeap];
+	cache.m_pFreeList[nHeap] = *(void**)pMem;
+	cache.m_nNumFree[nHeap]--;
+
+	return pMem;
+}
+
+
+// free a block to this thread's cache, whichever thread allocated it
+static void LTMemHeapFreeSimple(uint32 nHeap, void* pMem)
+{
+	CLTMemThreadCache& cache = t_LTMemThreadCache;
+
+	*(void**)pMem = cache.m_pFreeList[nHeap];
+	cache.m_pFreeList[nHeap] = pMem;
+	cache.m_nNumFree[nHeap]++;
+
+	// don't let a thread that frees more than it allocates hoard memory
+	if (cache.m_nNumFree[nHeap] > LTMEMTHREADCACHEMAX)
+	{
+		LTMemHeapReturnBlocks(cache, nHeap, LTMEMTHREADCACHEMAX / 2);
+	}
+}
+
+
+// find the simple heap this memory came from, or LTMEMHEAPNUMSIMPLEHEAPSIZES if none
+static uint32 LTMemHeapFindSimpleHeap(void* pMem)
+{
+	for (uint32 n = 0; n < LTMEMHEAPNUMSIMPLEHEAPSIZES; n++)
+	{
+		if (g_arySimpleHeaps[n].InHeap(pMem)) return n;
+	}
+	return LTMEMHEAPNUMSIMPLEHEAPSIZES;
+}
+
+
+// find the general heap this memory came from, or LTMEMHEAPNUMGENERALSTRIPES if none
+static uint32 LTMemHeapFindGeneralHeap(void* pMem)
+{
+	for (uint32 n = 0; n < LTMEMHEAPNUMGENERALSTRIPES; n++)
+	{
+		if (g_aryGeneralHeaps[n].InHeap(pMem)) return n;
+	}
+	return LTMEMHEAPNUMGENERALSTRIPES;
+}
+
+
+// get the general heap this thread allocates from
+static uint32 LTMemHeapGetThreadGeneralHeap()
+{
+	static thread_local uint32 t_nStripe = g_nNextGeneralHeapStripe.fetch_add(1) % LTMEMHEAPNUMGENERALSTRIPES;
+	return t_nStripe;
+}
+
+#endif
+
+
+#ifdef LTMEMTHREADED
+
+// Initialize the LTMemHeap
+void LTMemHeapInit()
+{
+	// set initialized flag
+	g_bLTMemHeapInitialized = true;
+
+	// initialize the simple heaps
+	{
+		for (uint32 n = 0; n < LTMEMHEAPNUMSIMPLEHEAPSIZES; n++)
+		{
+			g_arySimpleHeaps[n].Init(g_nSimpleHeapSizes[n],g_nSimpleHeapNumItems[n],g_nSimpleHeapGrowItems[n]);
+		}
+	}
+
+	// initialize the general heaps, splitting the initial size between them
+	{
+		for (uint32 n = 0; n < LTMEMHEAPNUMGENERALSTRIPES; n++)
+		{
+			g_aryGeneralHeaps[n].Init(g_nGeneralHeapSize / LTMEMHEAPNUMGENERALSTRIPES, g_nGeneralHeapGrowSize, g_nGeneralHeapAlign);
+		}
+	}
+}
+
+
+// Terminate the LTMemHeap
+void LTMemHeapTerm()
+{
+	// the blocks in this thread's cache are about to go away with the heaps
+	{
+		for (uint32 n = 0; n < LTMEMHEAPNUMSIMPLEHEAPSIZES; n++)
+		{
+			t_LTMemThreadCache.m_pFreeList[n] = NULL;
+			t_LTMemThreadCache.m_nNumFree[n] = 0;
+		}
+	}
+
+	// terminate the simple heaps
+	{
+		for (uint32 n = 0; n < LTMEMHEAPNUMSIMPLEHEAPSIZES; n++)
+		{
+			g_arySimpleHeaps[n].Term();
+		}
+	}
+
+	// terminate the general heaps
+	{
+		for (uint32 n = 0; n < LTMEMHEAPNUMGENERALSTRIPES; n++)
+		{
+			g_aryGeneralHeaps[n].Term();
+		}
+	}
+
+	// we are no longer initialized
+	g_bLTMemHeapInitialized = false;
+}
+
+
+// Allocate memory
+void* LTMemHeapAlloc(uint32 nSize)
+{
+	// see if this memory fits in a simple heap
+	{
+		for (uint32 n = 0; n < LTMEMHEAPNUMSIMPLEHEAPSIZES; n++)
+		{
+			if (nSize <= g_nSimpleHeapSizes[n])
+			{
+				return LTMemHeapAllocSimple(n);
+			}
+		}
+	}
+
+	// otherwise use this thread's general heap
+	uint32 nStripe = LTMemHeapGetThreadGeneralHeap();
+
+	std::lock_guard<std::mutex> lock(g_aryGeneralHeapLocks[nStripe]);
+	return g_aryGeneralHeaps[nStripe].Alloc(nSize);
+}
+
+
+// Free memory
+void LTMemHeapFree(void* pMem)
+{
+	// if memory is null don't free it
+	if (pMem == NULL) return;
+
+	// simple heap memory goes back to this thread's cache
+	uint32 nHeap = LTMemHeapFindSimpleHeap(pMem);
+	if (nHeap < LTMEMHEAPNUMSIMPLEHEAPSIZES)
+	{
+		LTMemHeapFreeSimple(nHeap, pMem);
+		return;
+	}
+
+	// general heap memory goes back to the heap it came from, which may
+	// belong to a different thread
+	uint32 nStripe = LTMemHeapFindGeneralHeap(pMem);
+	if (nStripe < LTMEMHEAPNUMGENERALSTRIPES)
+	{
+		std::lock_guard<std::mutex> lock(g_aryGeneralHeapLocks[nStripe]);
+		g_aryGeneralHeaps[nStripe].Free(pMem);
+		return;
+	}
+
+	// This memory is not from LTMemHeap !!!
+	ASSERT(false);
+}
+
+
+// get the size of this piece of memory
+uint32 LTMemHeapGetSize(void* pMem)
+{
+	uint32 nHeap = LTMemHeapFindSimpleHeap(pMem);
+	if (nHeap < LTMEMHEAPNUMSIMPLEHEAPSIZES)
+	{
+		return g_nSimpleHeapSizes[nHeap];
+	}
+
+	uint32 nStripe = LTMemHeapFindGeneralHeap(pMem);
+	if (nStripe < LTMEMHEAPNUMGENERALSTRIPES)
+	{
+		std::lock_guard<std::mutex> lock(g_aryGeneralHeapLocks[nStripe]);
+		return g_aryGeneralHeaps[nStripe].GetSize(pMem);
+	}
+
+	// This memory is not from LTMemHeap !!!
+	ASSERT(false);
+	return 0;
+}
+
+#else
 
 // Initialize the LTMemHeap
 void LTMemHeapInit()
@@ -163,29 +457,29 @@ void LTMemHeapFree(void* pMem)
 }
 
 
-// resize memory
-void* LTMemHeapReAlloc(void* pMem, uint32 nNewSize)
+// get the size of this piece of memory
+uint32 LTMemHeapGetSize(void* pMem)
 {
 	// get size of old memory
-	uint32 nOldSize = 0;
+	uint32 nSize = 0;
 	{
 		for (uint32 n = 0; n < LTMEMHEAPNUMSIMPLEHEAPSIZES; n++)
 		{
 			if (g_arySimpleHeaps[n].InHeap(pMem))
 			{
-				nOldSize = g_nSimpleHeapSizes[n];
+				nSize = g_nSimpleHeapSizes[n];
 
 				// done searching
 				break;
 			}
 		}
 	}
-	if (nOldSize == 0)
+	if (nSize == 0)
 	{
 		if (g_GeneralHeap.InHeap(pMem)) 
 		{
 			// get size from general heap
-			nOldSize = g_GeneralHeap.GetSize(pMem);
+			nSize = g_GeneralHeap.GetSize(pMem);
 		}
 		else
 		{
@@ -193,7 +487,22 @@ void* LTMemHeapReAlloc(void* pMem, uint32 nNewSize)
 			ASSERT(false);
 		}
 	}
-	
+
+	return nSize;
+}
+
+#endif
+
+
+// resize memory
+void* LTMemHeapReAlloc(void* pMem, uint32 nNewSize)
+{
+	// resizing nothing is the same as allocating
+	if (pMem == NULL) return LTMemHeapAlloc(nNewSize);
+
+	// get size of old memory
+	uint32 nOldSize = LTMemHeapGetSize(pMem);
+
 	// allocate new memory
 	void* pNewMem = LTMemHeapAlloc(nNewSize);
 	if (pNewMem == NULL) return NULL;
@@ -210,40 +519,5 @@ void* LTMemHeapReAlloc(void* pMem, uint32 nNewSize)
 	LTMemHeapFree(pMem);	
 
 	// return value
-	return pMem;
-}
-
-
-// get the size of this piece of memory
-uint32 LTMemHeapGetSize(void* pMem)
-{
-	// get size of old memory
-	uint32 nSize = 0;
-	{
-		for (uint32 n = 0; n < LTMEMHEAPNUMSIMPLEHEAPSIZES; n++)
-		{
-			if (g_arySimpleHeaps[n].InHeap(pMem))
-			{
-				nSize = g_nSimpleHeapSizes[n];
-
-				// done searching
-				break;
-			}
-		}
-	}
-	if (nSize == 0)
-	{
-		if (g_GeneralHeap.InHeap(pMem)) 
-		{
-			// get size from general heap
-			nSize = g_GeneralHeap.GetSize(pMem);
-		}
-		else
-		{
-			// This memory is not from LTMemHeap !!!
-			ASSERT(false);
-		}
-	}
-
-	return nSize;
+	return pNewMem;
 }
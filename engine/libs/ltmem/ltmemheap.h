@@ -14,6 +14,12 @@
 // if this is not defined then just standard malloc and free are available
 //#define USELTMEM
 
+// define this to make the LT mem heap safe to call from several threads at once
+// small allocations come from per thread caches and large ones from a set of
+// general heaps that each have their own lock, so LTMemAlloc and LTMemFree no
+// longer need the global critical section (unless LTMEMTRACK or LTMEMDEBUG is on)
+//#define LTMEMTHREADED
+
 // Init the LTMemHeap
 void LTMemHeapInit();
 
@@ -155,6 +155,7 @@ void LTMemTrackSetupMemTypesToStrings()
 	LTMemTrackAddTypeToString(LT_MEM_TYPE_OBJECTSHELL, "ObjectShell");
 	LTMemTrackAddTypeToString(LT_MEM_TYPE_CLIENTFX, "ClientFX");
 	LTMemTrackAddTypeToString(LT_MEM_TYPE_GAMECODE, "GameCode");
+	LTMemTrackAddTypeToString(LT_MEM_TYPE_FRAMEARENA, "frame arena");
 }
 
 
@@ -7,6 +7,13 @@
 #include "rezmgr.h"
 #include <string.h>
 #include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 // -----------------------------------------------------------------------------------------
 // CBaseRezFileList
@@ -44,6 +51,13 @@ CBaseRezFile::~CBaseRezFile() {
 void CBaseRezFile::VirtualFoo() {
 };
 
+
+// -----------------------------------------------------------------------------------------
+// Returns a read only pointer straight into the file data if this file supports it (NULL otherwise)
+const BYTE* CBaseRezFile::GetData(DWORD nItemPos, DWORD nItemOffset, DWORD nSize) {
+  return NULL;
+};
+
 // -----------------------------------------------------------------------------------------
 // CRezFile
 
@@ -53,6 +67,11 @@ CRezFile::CRezFile(CRezMgr* pRezMgr) : CBaseRezFile(pRezMgr) {
   m_pFile = NULL;
   m_sFileName = NULL;
   m_nLastSeekPos = 0xFFFFFFFF;
+  m_pMapData = NULL;
+  m_nMapSize = 0;
+#ifdef _WIN32
+  m_hMapFile = NULL;
+#endif
 };
 
 
@@ -73,6 +92,17 @@ DWORD CRezFile::Read(DWORD nItemPos, DWORD nItemOffset, DWORD nSize, void* pData
   if (nSize <= 0) return 0;
 
   DWORD nSeekPos = nItemPos+nItemOffset;
+
+  // if the file is mapped just copy the data, this keeps no seek state so it is safe from any thread
+  if (m_pMapData != NULL) {
+    if ((nSeekPos > m_nMapSize) || (nSize > m_nMapSize-nSeekPos)) {
+      ASSERT(FALSE); // Read past end of file!
+      return 0;
+    }
+    memcpy(pData, m_pMapData+nSeekPos, nSize);
+    return nSize;
+  }
+
   if (m_nLastSeekPos != nSeekPos)
   {
 		while (fseek(m_pFile, nSeekPos, SEEK_SET) != 0) {
@@ -157,15 +187,76 @@ BOOL CRezFile::Open(const char* sFileName, BOOL bReadOnly, BOOL bCreateNew) {
 	  LTStrCpy(m_sFileName,sFileName,nNewStrLen);
 
   m_nLastSeekPos = 0xFFFFFFFF;
+
+  // map read only files so reads don't have to go through the FILE (falls back to fread if it fails)
+  if (m_bReadOnly) MapFile();
+
+  return TRUE;
+};
+
+
+// -----------------------------------------------------------------------------------------
+BOOL CRezFile::MapFile() {
+  ASSERT(m_pFile != NULL);
+  UnmapFile();
+
+  struct stat Info;
+  if (fstat(fileno(m_pFile), &Info) != 0) return FALSE;
+  if ((Info.st_size <= 0) || ((unsigned long long)Info.st_size > 0xFFFFFFFFULL)) return FALSE;
+  DWORD nSize = (DWORD)Info.st_size;
+
+#ifdef _WIN32
+  HANDLE hFile = (HANDLE)_get_osfhandle(_fileno(m_pFile));
+  if (hFile == INVALID_HANDLE_VALUE) return FALSE;
+  HANDLE hMapFile = CreateFileMapping(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (hMapFile == NULL) return FALSE;
+  void* pView = MapViewOfFile(hMapFile, FILE_MAP_READ, 0, 0, 0);
+  if (pView == NULL) {
+    CloseHandle(hMapFile);
+    return FALSE;
+  }
+  m_hMapFile = hMapFile;
+#else
+  void* pView = mmap(NULL, nSize, PROT_READ, MAP_PRIVATE, fileno(m_pFile), 0);
+  if (pView == MAP_FAILED) return FALSE;
+#endif
+
+  m_pMapData = (const BYTE*)pView;
+  m_nMapSize = nSize;
   return TRUE;
 };
 
 
+// -----------------------------------------------------------------------------------------
+void CRezFile::UnmapFile() {
+  if (m_pMapData == NULL) return;
+#ifdef _WIN32
+  UnmapViewOfFile((LPCVOID)m_pMapData);
+  CloseHandle((HANDLE)m_hMapFile);
+  m_hMapFile = NULL;
+#else
+  munmap((void*)m_pMapData, m_nMapSize);
+#endif
+  m_pMapData = NULL;
+  m_nMapSize = 0;
+};
+
+
+// -----------------------------------------------------------------------------------------
+const BYTE* CRezFile::GetData(DWORD nItemPos, DWORD nItemOffset, DWORD nSize) {
+  if (m_pMapData == NULL) return NULL;
+  DWORD nPos = nItemPos+nItemOffset;
+  if ((nPos > m_nMapSize) || (nSize > m_nMapSize-nPos)) return NULL;
+  return m_pMapData+nPos;
+};
+
+
 // -----------------------------------------------------------------------------------------
 BOOL CRezFile::Close() {
   ASSERT(m_pRezMgr != NULL);
   BOOL bRetVal;
   int nCheck;
+  UnmapFile();
   if (m_pFile != NULL) {
 	do 
 	{
@@ -220,6 +311,9 @@ BOOL CRezFile::VerifyFileOpen() {
   // check if the files is even supposed to be open
   if (m_pFile == NULL) return FALSE;
 
+  // a mapped file stays valid until it is closed
+  if (m_pMapData != NULL) return TRUE;
+
   // test to see if the file is open
   if (ftell(m_pFile) != -1L) return TRUE;
   else {
@@ -59,6 +59,7 @@ public:
   virtual BOOL Flush() = 0;
   virtual BOOL VerifyFileOpen() = 0;
   virtual char* GetFileName() = 0;
+  virtual const BYTE* GetData(DWORD nItemPos, DWORD nItemOffset, DWORD nSize);
   CBaseRezFile* Next() { return (CBaseRezFile*)CVirtBaseListItem::Next(); };
   void VirtualFoo();
 protected:
@@ -80,12 +81,20 @@ public:
   virtual BOOL Flush();
   virtual BOOL VerifyFileOpen();
   virtual char* GetFileName();
+  virtual const BYTE* GetData(DWORD nItemPos, DWORD nItemOffset, DWORD nSize);
 private:
+  BOOL MapFile();
+  void UnmapFile();
   FILE* m_pFile;
   char* m_sFileName;
   BOOL m_bReadOnly;
   BOOL m_bCreateNew;
   DWORD m_nLastSeekPos;
+  const BYTE* m_pMapData;  // read only files are mapped into memory and read without seeking (NULL if not mapped)
+  DWORD m_nMapSize;
+#ifdef _WIN32
+  void* m_hMapFile;
+#endif
 };
 
 // -----------------------------------------------------------------------------------------
@@ -527,6 +527,13 @@ BOOL CRezItm::IsLoaded() {
   else return (m_pData != NULL); 
 }; 
 
+//---------------------------------------------------------------------------------------------------
+const BYTE* CRezItm::GetMappedData() {
+  ASSERT(m_pRezFile != NULL);
+  if (m_nSize == 0) return NULL;
+  return m_pRezFile->GetData(m_nFilePos,0,m_nSize);
+};
+
 //---------------------------------------------------------------------------------------------------
 BOOL CRezItm::Get(BYTE* pBytes) {
   return (Get(pBytes,0,m_nSize));
@@ -113,6 +113,7 @@ public:
 	BYTE*		Load();                                                                 // Returns a pointer to the data for this item (loads from disk if not already in memory)
 	BOOL		UnLoad();                                                               // Frees the memory for this item
 	BOOL		IsLoaded();                                                             // Returns TRUE if this item is currently in memory
+	const BYTE*	GetMappedData();                                                        // Returns a read only pointer to this item's data if its rez file is memory mapped (NULL otherwise), valid until the rez file is closed
 
 	DWORD		GetSeekPos() { return m_nCurPos; };                                     // Get the current position inside this resource
 	BOOL		Seek(DWORD offset);                                                     // Set the current position inside this resource
@@ -9,6 +9,7 @@
 #include "client_filemgr.h"
 
 #include "impl_common.h"
+#include "ltresourceloader.h"
 
 
 typedef void* HLTFileTree; //class HLTFileTree;
@@ -72,6 +73,8 @@ public:
     LTRESULT CopyFile(const char *pSrc, const char *pDest);
     int OnNewFile(FTClient *hClient, const char *pFilename, uint32 size, uint32 fileID);
 	FTClient* GetFTClient();
+    void PrefetchFiles(FileIdentifier **ppFiles, uint32 nFiles, int32 priority);
+    void FlushPrefetchedFiles();
     //
     //Client File Mgr data.
     //
@@ -96,6 +99,9 @@ public:
     // of server files from this and directs it where to transfer files to.
     FTClient    *m_hFTClient;
 
+    // Files read in by PrefetchFiles that haven't been opened yet.
+    CLTFilePrefetcher   m_Prefetcher;
+
     //
     //Private functions, used to be statics in this file.
     //
@@ -255,6 +261,9 @@ void CClientFileMgr::OnDisconnect() {
     LTLink *pCur, *pNext;
     ServerFile *pFile;
 
+    // The server files' identifiers are about to go away.
+    FlushPrefetchedFiles();
+
     if (m_hCacheTree) {
         df_CloseTree(m_hCacheTree);
         m_hCacheTree = LTNULL;
@@ -503,10 +512,40 @@ FileIdentifier* CClientFileMgr::GetFileIdentifier(FileRef *pDesc, uint8 typeCode
 ILTStream *CClientFileMgr::OpenFileIdentifier(FileIdentifier *pFile) {
     if (pFile == LTNULL) return LTNULL;
 
+#if !defined(LTJS_DEDIT2_FILEMGR)
+    ILTStream *pPrefetched = m_Prefetcher.Open(pFile);
+    if (pPrefetched)
+        return pPrefetched;
+#endif
+
     return df_Open(pFile->m_hFileTree, pFile->m_Filename, 0);
 }
 
 
+void CClientFileMgr::PrefetchFiles(FileIdentifier **ppFiles, uint32 nFiles, int32 priority) {
+#if defined(LTJS_DEDIT2_FILEMGR)
+    (void)ppFiles;
+    (void)nFiles;
+    (void)priority;
+#else
+    uint32 i;
+
+    for (i=0; i < nFiles; i++) {
+        if (ppFiles[i]) {
+            m_Prefetcher.Prefetch(ppFiles[i], df_Open(ppFiles[i]->m_hFileTree, ppFiles[i]->m_Filename, 0), priority);
+        }
+    }
+#endif
+}
+
+
+void CClientFileMgr::FlushPrefetchedFiles() {
+#if !defined(LTJS_DEDIT2_FILEMGR)
+    m_Prefetcher.Flush();
+#endif
+}
+
+
 ILTStream *CClientFileMgr::OpenFile(FileRef *pDesc) {
     ServerFile *pFile;
     ClientFileTree *pTree;
@@ -119,6 +119,15 @@ public:
     virtual ILTStream* OpenFile(FileRef *pDesc) = 0;
 	virtual FileIdentifier* FindFileIdentifier( const char *pFilename , uint8 typeCode )=0;
 
+    // Reads a batch of files into memory on the resource loader's threads,
+    // highest priority first, so loading them doesn't wait on the disk one
+    // file at a time.  The next OpenFileIdentifier on each file returns a
+    // stream over its memory copy (waiting for it if it's still loading).
+    virtual void PrefetchFiles(FileIdentifier **ppFiles, uint32 nFiles, int32 priority) = 0;
+
+    // Throws away anything prefetched that hasn't been opened yet.
+    virtual void FlushPrefetchedFiles() = 0;
+
     // Copy a file.  Returns LT_OK, LT_ERROR, or LT_NOTFOUND.
     virtual LTRESULT CopyFile(const char *pSrc, const char *pDest) = 0;
 
@@ -38,6 +38,7 @@
 
 #include "ltrendererstats.h"
 #include "rendererframestats.h"
+#include "fullintersectline.h"
 
 #ifdef LTJS_SDL_BACKEND
 #include "ltjs_shared_data_mgr.h"
@@ -634,7 +635,7 @@ LTParticle *CLTClient::AddParticle(HLOCALOBJ hObj, const LTVector *pPos, const L
 {
 	LTParticleSystem *pSystem = (LTParticleSystem*)hObj;
 
-	if (pSystem && pSystem->m_ObjectType == OT_PARTICLESYSTEM)
+	if (pSystem && pSystem->m_ObjectType == OT_PARTICLESYSTEM && !(pSystem->m_psFlags & PS_ARRAYS))
 	{
 		return (LTParticle*)ps_AddParticle(pSystem, pPos, pColor, pVelocity, lifeTime);
 	}
@@ -2863,6 +2864,11 @@ LTRESULT ci_SetupParticleSystem(HLOCALOBJ hObj, const char *pTextureName, float
 		RETURN_ERROR(1, SetupParticleSystem, LT_INVALIDPARAMS);
 
 	LTParticleSystem *pSystem = (LTParticleSystem*)pObject;
+
+	// The particles can't be moved between the list and the arrays.
+	if (((pSystem->m_psFlags ^ flags) & PS_ARRAYS) && (pSystem->m_nParticles > 0))
+		RETURN_ERROR(1, SetupParticleSystem, LT_INVALIDPARAMS);
+
 	pSystem->m_GravityAccel = gravityAccel;
 	pSystem->m_psFlags = flags;
 	pSystem->m_ParticleRadius = particleRadius;
@@ -2896,7 +2902,7 @@ bool ci_GetParticles(HLOCALOBJ hObj, LTParticle **pHead, LTParticle **pTail)
 {
 	LTParticleSystem *pSystem = (LTParticleSystem*)hObj;
 
-	if (pSystem && pSystem->m_ObjectType != OT_PARTICLESYSTEM)
+	if (!pSystem || pSystem->m_ObjectType != OT_PARTICLESYSTEM || (pSystem->m_psFlags & PS_ARRAYS))
 	{
 		return false;
 	}
@@ -2912,12 +2918,55 @@ void ci_RemoveParticle(HLOCALOBJ hSystem, LTParticle *pParticle)
 		return;
 
 	LTParticleSystem *pSystem = (LTParticleSystem*)hSystem;
-	if (pSystem->m_ObjectType != OT_PARTICLESYSTEM)
+	if (pSystem->m_ObjectType != OT_PARTICLESYSTEM || (pSystem->m_psFlags & PS_ARRAYS))
 		return;
 
 	ps_RemoveParticle(pSystem, (PSParticle*)pParticle);
 }
 
+bool ci_GetParticleArrays(HLOCALOBJ hObj, LTParticleArrays *pArrays)
+{
+	LTParticleSystem *pSystem = (LTParticleSystem*)hObj;
+
+	if (!pSystem || !pArrays || pSystem->m_ObjectType != OT_PARTICLESYSTEM || !(pSystem->m_psFlags & PS_ARRAYS))
+	{
+		return false;
+	}
+
+	*pArrays = pSystem->m_ParticleArrays;
+	return true;
+}
+
+LTRESULT ci_AddParticleArrays(HLOCALOBJ hObj, uint32 nParticles, LTParticleArrays *pArrays)
+{
+	LTParticleSystem *pSystem = (LTParticleSystem*)hObj;
+
+	if (!pSystem || !pArrays || pSystem->m_ObjectType != OT_PARTICLESYSTEM || !(pSystem->m_psFlags & PS_ARRAYS))
+	{
+		RETURN_ERROR(1, CLTClient::AddParticleArrays, LT_INVALIDPARAMS);
+	}
+
+	if (!ps_AddParticleArrays(pSystem, nParticles))
+	{
+		RETURN_ERROR(1, CLTClient::AddParticleArrays, LT_OUTOFMEMORY);
+	}
+
+	*pArrays = pSystem->m_ParticleArrays;
+	return LT_OK;
+}
+
+uint32 ci_RemoveExpiredParticles(HLOCALOBJ hSystem)
+{
+	LTParticleSystem *pSystem = (LTParticleSystem*)hSystem;
+
+	if (!pSystem || pSystem->m_ObjectType != OT_PARTICLESYSTEM || !(pSystem->m_psFlags & PS_ARRAYS))
+	{
+		return 0;
+	}
+
+	return ps_RemoveExpiredParticles(pSystem);
+}
+
 
 LTRESULT ci_OptimizeParticles(HLOCALOBJ hSystem)
 {
@@ -3354,6 +3403,11 @@ bool ci_IntersectSegment(IntersectQuery *pQuery, ClientIntersectInfo *pInfo)
 	return world_bsp_client->IntersectSegment(pQuery, pInfo);
 }
 
+uint32 ci_IntersectSegmentBatch(ClientIntersectQuery *pQueries, ClientIntersectInfo *pInfos, uint32 nQueries, uint32 batchFlags)
+{
+	return i_IntersectSegmentBatch(pQueries, pInfos, nQueries, batchFlags, world_bsp_client->ClientTree());
+}
+
 bool ci_IntersectSweptSphere(const LTVector& vStart, const LTVector& vEnd, float fRadius, LTVector& vPos, LTVector& vNormal)
 {
 	return world_bsp_client->IntersectSweptSphere(vStart, vEnd, fRadius, vPos, vNormal);
@@ -3471,6 +3525,7 @@ void CLTClient::InitFunctionPointers()
 	CreateObject = ci_CreateObject;
 
 	IntersectSegment = ci_IntersectSegment;
+	IntersectSegmentBatch = ci_IntersectSegmentBatch;
 	IntersectSweptSphere = ci_IntersectSweptSphere;
 	CastRay = ci_CastRay;
 
@@ -3502,6 +3557,9 @@ void CLTClient::InitFunctionPointers()
 	SortParticles = ci_SortParticles;
 	GetParticles = ci_GetParticles;
 	RemoveParticle = ci_RemoveParticle;
+	GetParticleArrays = ci_GetParticleArrays;
+	AddParticleArrays = ci_AddParticleArrays;
+	RemoveExpiredParticles = ci_RemoveExpiredParticles;
 	OptimizeParticles = ci_OptimizeParticles;
 	SetParticleSystemEffectShaderID = ci_SetParticleSystemEffectShaderID;
 
@@ -68,6 +68,9 @@
 #include "iltdrawprim.h"
 
 #include "dtxmgr.h"
+#include "ltjobpool.h"
+#include "ltresourceloader.h"
+#include "ltframearena.h"
 
 //------------------------------------------------------------------
 //------------------------------------------------------------------
@@ -372,6 +375,7 @@ extern LTBOOL g_bMusicEnable;
 extern LTBOOL g_bSoundEnable;
 extern uint32 g_nSoundDebugLevel;
 extern LTBOOL g_bSoundShowCounts;
+extern int32 g_CV_SoundCacheStats;
 extern LTBOOL g_bNullRender;
 extern LTBOOL g_bHWTnLDisabled;
 
@@ -915,6 +919,7 @@ void CClientMgr::UnbindClientShellWorlds()
 void CClientMgr::BindSharedTextures()
 {
     LTLink *pCur, *pListHead;
+    std::vector<SharedTexture*> textures;
 
     // Read in the latest console variables..
     if (g_Render.m_bInitted && g_Render.ReadConsoleVariables)
@@ -923,7 +928,33 @@ void CClientMgr::BindSharedTextures()
     pListHead = &m_SharedTextures.m_Head;
     for (pCur=pListHead->m_pNext; pCur != pListHead; pCur=pCur->m_pNext)
     {
-        r_BindTexture((SharedTexture*)pCur->m_pData, false);
+        textures.push_back((SharedTexture*)pCur->m_pData);
+    }
+
+    if (!textures.empty())
+        BindTextureList(&textures[0], (uint32)textures.size());
+}
+
+
+void CClientMgr::BindTextureList(SharedTexture **ppTextures, uint32 nTextures)
+{
+    // Load the texture files a chunk at a time in parallel, then bind that chunk, so
+    // we're not holding every texture's system memory copy at once.
+    static const uint32 knPreloadChunk = 64;
+
+    if (!g_Render.m_bInitted)
+        return;
+
+    for (uint32 iFirst=0; iFirst < nTextures; iFirst += knPreloadChunk)
+    {
+        uint32 nChunk = LTMIN(knPreloadChunk, nTextures - iFirst);
+
+        r_PreloadSystemTextures(&ppTextures[iFirst], nChunk);
+
+        for (uint32 i=0; i < nChunk; i++)
+        {
+            r_BindTexture(ppTextures[iFirst + i], false);
+        }
     }
 }
 
@@ -988,6 +1019,9 @@ LTRESULT CClientMgr::Update()
     LTRESULT dResult;
     static LTRect rFPS (480,10,630,80);
 
+    // Scratch memory handed out during the frame is released when it ends.
+    CLTFrameArenaScope cFrameScope(lt_GetFrameArena());
+
 #ifndef _FINAL
     uint32 frameTicks;
 
@@ -1025,6 +1059,9 @@ LTRESULT CClientMgr::Update()
     // all the processor time.
     dsi_ClientSleep(g_ClientSleepMS);
 
+    // Hand over anything the resource loader has finished with.
+    lt_GetResourceLoader().Update();
+
     // Puase music if disabled...
     if (GetMusicMgr()->m_bValid)
 	{
@@ -1309,6 +1346,43 @@ LTRESULT CClientMgr::PlaySound(PlaySoundInfo *pPlaySoundInfo, FileRef *pFile, fl
 }
 
 
+// Copies the decode cache's counters into console variables.  Every distinct
+// value a variable takes is kept by the console, so it's only done once a second.
+static void PublishSoundCacheStats()
+{
+    static uint32 s_nLastPublishMS = 0;
+
+    uint32 nCurTimeMS = time_GetMSTime();
+    if ((nCurTimeMS - s_nLastPublishMS) < 1000)
+        return;
+
+    s_nLastPublishMS = nCurTimeMS;
+
+    const CSoundDecodeCache &decodeCache = GetClientILTSoundMgrImpl()->GetDecodeCache();
+
+    struct SoundCacheStat
+    {
+        const char  *m_pName;
+        uint32      m_nValue;
+    };
+
+    SoundCacheStat stats[] =
+    {
+        { "SoundCacheHits", decodeCache.GetNumHits() },
+        { "SoundCacheMisses", decodeCache.GetNumMisses() },
+        { "SoundCacheEvictions", decodeCache.GetNumEvictions() },
+        { "SoundCacheKB", decodeCache.GetBytesUsed() / 1024 },
+    };
+
+    char szValue[32];
+    for (uint32 i = 0; i < sizeof(stats) / sizeof(stats[0]); ++i)
+    {
+        LTSNPrintF(szValue, sizeof(szValue), "%u", stats[i].m_nValue);
+        cc_SetConsoleVariable(&g_ClientConsoleState, stats[i].m_pName, szValue);
+    }
+}
+
+
 void CClientMgr::UpdateAllSounds()
 {
 	CountAdder cntAdd(&g_Ticks_Sound);
@@ -1329,6 +1403,9 @@ void CClientMgr::UpdateAllSounds()
         con_Printf(CONRGB(255,0,0), 0, "Sounds: playing:%d, heard:%d", GetClientILTSoundMgrImpl()->GetNumSoundsPlaying(),
             GetClientILTSoundMgrImpl()->GetNumSoundsHeard());
     }
+
+    if (g_CV_SoundCacheStats)
+        PublishSoundCacheStats();
 }
 
 
@@ -1416,6 +1493,10 @@ void cm_Init()
 
     VEC_SET(g_pClientMgr->m_GlobalLightScale, 1.0f, 1.0f, 1.0f);
 
+    // Start the worker threads before anything can hand them work.
+    lt_InitJobPool();
+    lt_InitResourceLoader();
+
     //initialize the client file mgr.
     client_file_mgr->Init();
 
@@ -1554,6 +1635,9 @@ void CClientMgr::Term()
     // Kill the file manager.
     client_file_mgr->Term();
 
+    lt_TermResourceLoader();
+    lt_TermJobPool();
+
     // terminate the font manager
     font_manager->Term();
 
@@ -168,6 +168,7 @@ class CClientMgr {
         void                    UnbindClientShellWorlds();
 
         void                    BindSharedTextures();
+        void                    BindTextureList(SharedTexture **ppTextures, uint32 nTextures);
         void                    UnbindSharedTextures(bool bUnLoad_EngineData);
 
         void                    InitConsole();
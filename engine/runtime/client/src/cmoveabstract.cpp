@@ -19,6 +19,11 @@ define_holder(ILTClient, ilt_client);
 static IClientShell *i_client_shell;
 define_holder(IClientShell, i_client_shell);
 
+//the client collision manager, NULL when the physics module isn't linked in
+#include "collision_mgr.h"
+static ILTCollisionMgr *client_collision_mgr;
+define_holder_to_instance(ILTCollisionMgr, client_collision_mgr, Client);
+
 
 
 
@@ -28,6 +33,10 @@ ILTPhysics *CMoveAbstract::GetPhysics() {
     return ilt_client->Physics(); 
 }
 
+ILTCollisionMgr *CMoveAbstract::GetCollisionMgr() {
+    return client_collision_mgr;
+}
+
 void CMoveAbstract::SetObjectChangeFlags(LTObject *pObj, uint32 flags) {
 
 }
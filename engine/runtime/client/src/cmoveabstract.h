@@ -31,6 +31,7 @@ public:
 	LTBOOL			CanOptimizeObject(LTObject *pObj);
 	const char*		GetObjectClassName(LTObject *pObject);
 	ILTPhysics *	GetPhysics();
+	ILTCollisionMgr *GetCollisionMgr();
 };
 
 #endif  // __CMOVEABSTRACT_H__
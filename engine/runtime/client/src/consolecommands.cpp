@@ -22,9 +22,20 @@
 #include "iltinfo.h"
 #include "dhashtable.h"
 #include "render.h"
+#include "dtxmgr.h"
+#include "impl_common.h"
+#include "ltjobpool.h"
+#include "particlesystem.h"
 
 #include "client_ticks.h"
 
+#include "ltjs_audio_decoder.h"
+#include "bibendovsky_spul_memory_stream.h"
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
 //------------------------------------------------------------------
 //------------------------------------------------------------------
 // Holders and their headers.
@@ -490,6 +501,313 @@ static void con_LogTextureInfo(int argc, const char *argv[])
 	}
 }
 
+//------------------------------------------------------------------
+// Times loading every DTX in a directory one at a time and then as a batch on the job pool.
+static void con_DtxBench(int argc, const char *argv[])
+{
+	if(argc < 1)
+	{
+		dsi_ConsolePrint("Usage: DtxBench <directory> [iterations]");
+		return;
+	}
+
+	uint32 nIterations = (argc >= 2) ? (uint32)LTMAX(atoi(argv[1]), 1) : 1;
+
+	// Gather the textures in the directory.
+	std::vector<std::string> files;
+	FileEntry *pList = client_file_mgr->GetFileList(argv[0]);
+	for(FileEntry *pEntry=pList; pEntry; pEntry=pEntry->m_pNext)
+	{
+		if(pEntry->m_Type != TYPE_FILE)
+			continue;
+
+		const char *pExt = strrchr(pEntry->m_pBaseFilename, '.');
+		if(pExt && stricmp(pExt, ".dtx") == 0)
+		{
+			files.push_back(pEntry->m_pFullFilename);
+		}
+	}
+	ic_FreeFileList(pList);
+
+	if(files.empty())
+	{
+		dsi_ConsolePrint("DtxBench: no textures in %s", argv[0]);
+		return;
+	}
+
+	std::vector<DtxLoadRequest> requests(files.size());
+	uint32 nBytes = 0;
+	uint32 nFailed = 0;
+	float fSerialMS = 0.0f;
+	float fBatchMS = 0.0f;
+
+	for(uint32 iIteration=0; iIteration < nIterations; iIteration++)
+	{
+		// Opening the streams is part of both timings since a real load has to do it too.
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for(uint32 i=0; i < files.size(); i++)
+		{
+			FileRef ref;
+			ref.m_FileType = FILE_ANYFILE;
+			ref.m_pFilename = files[i].c_str();
+
+			ILTStream *pStream = client_file_mgr->OpenFile(&ref);
+			if(!pStream)
+				continue;
+
+			TextureData *pTexture = LTNULL;
+			uint32 nBaseWidth, nBaseHeight;
+			if(dtx_Create(pStream, &pTexture, nBaseWidth, nBaseHeight) == LT_OK)
+			{
+				if(iIteration == 0)
+					nBytes += pTexture->m_bufSize;
+				dtx_Destroy(pTexture);
+			}
+			pStream->Release();
+		}
+		fSerialMS += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		start = std::chrono::steady_clock::now();
+		for(uint32 i=0; i < files.size(); i++)
+		{
+			FileRef ref;
+			ref.m_FileType = FILE_ANYFILE;
+			ref.m_pFilename = files[i].c_str();
+			requests[i].m_pStream = client_file_mgr->OpenFile(&ref);
+		}
+
+		dtx_CreateBatch(&requests[0], (uint32)requests.size());
+
+		for(uint32 i=0; i < requests.size(); i++)
+		{
+			if(requests[i].m_Result == LT_OK)
+				dtx_Destroy(requests[i].m_pTexture);
+			else if(iIteration == 0)
+				nFailed++;
+
+			if(requests[i].m_pStream)
+				requests[i].m_pStream->Release();
+		}
+		fBatchMS += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	fSerialMS /= nIterations;
+	fBatchMS /= nIterations;
+
+	dsi_ConsolePrint("DtxBench: %d textures (%d failed), %.2f MB, %d worker threads", 
+		(int)files.size(), nFailed, nBytes / (1024.0f * 1024.0f), lt_GetJobPool().GetNumThreads());
+	dsi_ConsolePrint("  serial  %8.2f ms", fSerialMS);
+	dsi_ConsolePrint("  batched %8.2f ms (%.2fx)", fBatchMS, (fBatchMS > 0.0f) ? (fSerialMS / fBatchMS) : 0.0f);
+}
+
+// Builds a PCM wave file in memory holding a sweep from 100 Hz to 10 kHz.
+static void AudioBenchMakeWave(std::vector<uint8> &wave, int nChannels, int nBitDepth, int nSampleRate, int nSeconds)
+{
+	const int nFrames = nSampleRate * nSeconds;
+	const int nBlockAlign = nChannels * (nBitDepth / 8);
+	const int nDataSize = nFrames * nBlockAlign;
+
+	wave.clear();
+	wave.reserve(44 + nDataSize);
+
+	const auto put = [&wave](uint32 nValue, int nBytes)
+	{
+		for(int i=0; i < nBytes; i++)
+			wave.push_back((uint8)(nValue >> (i * 8)));
+	};
+
+	put('R' | ('I' << 8) | ('F' << 16) | ('F' << 24), 4);
+	put(36 + nDataSize, 4);
+	put('W' | ('A' << 8) | ('V' << 16) | ('E' << 24), 4);
+	put('f' | ('m' << 8) | ('t' << 16) | (' ' << 24), 4);
+	put(16, 4);
+	put(1, 2);
+	put(nChannels, 2);
+	put(nSampleRate, 4);
+	put(nSampleRate * nBlockAlign, 4);
+	put(nBlockAlign, 2);
+	put(nBitDepth, 2);
+	put('d' | ('a' << 8) | ('t' << 16) | ('a' << 24), 4);
+	put(nDataSize, 4);
+
+	double fPhase = 0.0;
+	for(int iFrame=0; iFrame < nFrames; iFrame++)
+	{
+		const double fFrequency = 100.0 * pow(100.0, (double)iFrame / nFrames);
+		fPhase += 2.0 * MATH_PI * fFrequency / nSampleRate;
+
+		const int nSample = (int)(sin(fPhase) * 24000.0);
+		for(int iChannel=0; iChannel < nChannels; iChannel++)
+		{
+			if(nBitDepth == 8)
+				put((uint32)((nSample + 32768) >> 8), 1);
+			else
+				put((uint32)(uint16)(int16)nSample, 2);
+		}
+	}
+}
+
+// Times decoding and converting wave data the way the sound code streams it,
+// for every source format and each resampling quality.
+static void con_AudioBench(int argc, const char *argv[])
+{
+	namespace ul = bibendovsky::spul;
+
+	const int nSeconds = 10;
+	const int nSrcSampleRate = 22050;
+	uint32 nIterations = (argc >= 1) ? (uint32)LTMAX(atoi(argv[0]), 1) : 5;
+
+	struct Format
+	{
+		int		m_nChannels;
+		int		m_nBitDepth;
+	};
+
+	static const Format formats[] = {{1, 8}, {1, 16}, {2, 8}, {2, 16}};
+
+	struct Conversion
+	{
+		int									m_nSampleRate;
+		ltjs::AudioDecoder::ResampleQuality	m_Quality;
+		const char							*m_pName;
+	};
+
+	static const Conversion conversions[] =
+	{
+		{nSrcSampleRate, ltjs::AudioDecoder::ResampleQuality::linear, "format only"},
+		{44100, ltjs::AudioDecoder::ResampleQuality::nearest, "nearest"},
+		{44100, ltjs::AudioDecoder::ResampleQuality::linear, "linear"},
+		{44100, ltjs::AudioDecoder::ResampleQuality::polyphase, "polyphase"},
+		{11025, ltjs::AudioDecoder::ResampleQuality::polyphase, "polyphase down"},
+	};
+
+	dsi_ConsolePrint("AudioBench: %d seconds at %d Hz to 16-bit stereo, %d passes", nSeconds, nSrcSampleRate, nIterations);
+
+	std::vector<uint8> wave;
+	std::vector<uint8> buffer(4096);
+	ltjs::AudioDecoder decoder;
+
+	for(const Format &format : formats)
+	{
+		AudioBenchMakeWave(wave, format.m_nChannels, format.m_nBitDepth, nSrcSampleRate, nSeconds);
+
+		for(const Conversion &conversion : conversions)
+		{
+			int nDecodedSize = 0;
+			float fTotalMS = 0.0f;
+
+			for(uint32 iIteration=0; iIteration < nIterations; iIteration++)
+			{
+				ul::MemoryStream stream(wave.data(), (int)wave.size(), ul::Stream::OpenMode::read);
+
+				ltjs::AudioDecoder::OpenParam param = ltjs::AudioDecoder::OpenParam{};
+				param.dst_channel_count_ = 2;
+				param.dst_bit_depth_ = 16;
+				param.dst_sample_rate_ = conversion.m_nSampleRate;
+				param.resample_quality_ = conversion.m_Quality;
+				param.stream_ptr_ = &stream;
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				if(!decoder.open(param))
+				{
+					dsi_ConsolePrint("AudioBench: failed to open the decoder");
+					return;
+				}
+
+				nDecodedSize = 0;
+				int nSize;
+				while((nSize = decoder.decode(buffer.data(), (int)buffer.size())) > 0)
+					nDecodedSize += nSize;
+
+				fTotalMS += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+				decoder.close();
+			}
+
+			const float fMS = fTotalMS / nIterations;
+			dsi_ConsolePrint("  %d ch %2d-bit  %-14s %8.3f ms/s of audio  %7.0fx realtime  %d bytes",
+				format.m_nChannels, format.m_nBitDepth, conversion.m_pName, fMS / nSeconds,
+				(fMS > 0.0f) ? (nSeconds * 1000.0f / fMS) : 0.0f, nDecodedSize);
+		}
+	}
+}
+
+static void con_ParticleBench(int argc, const char *argv[])
+{
+	uint32 nParticles = (argc >= 1) ? (uint32)LTMAX(atoi(argv[0]), 1) : 20000;
+	uint32 nFrames = (argc >= 2) ? (uint32)LTMAX(atoi(argv[1]), 1) : 300;
+
+	const float fFrameTime = 1.0f / 60.0f;
+	const LTVector vMinOffset(-50.0f, -50.0f, -50.0f), vMaxOffset(50.0f, 50.0f, 50.0f);
+	const LTVector vMinVel(-100.0f, 0.0f, -100.0f), vMaxVel(100.0f, 400.0f, 100.0f);
+	const LTVector vColor(255.0f, 255.0f, 255.0f);
+
+	dsi_ConsolePrint("ParticleBench: %d particles, %d frames", nParticles, nFrames);
+
+	// The list systems allocate their particles from a bank, which normally
+	// belongs to the object manager.
+	StructBank particleBank;
+	sb_Init(&particleBank, sizeof(PSParticle), 1024);
+
+	struct Layout
+	{
+		uint32		m_Flags;
+		const char	*m_pName;
+	};
+
+	static const Layout layouts[] = {{0, "list"}, {PS_ARRAYS, "arrays"}};
+
+	for(const Layout &layout : layouts)
+	{
+		LTParticleSystem *pSystem;
+		LT_MEM_TRACK_ALLOC(pSystem = new LTParticleSystem, LT_MEM_TYPE_OBJECT);
+		pSystem->m_pParticleBank = &particleBank;
+		pSystem->m_psFlags = layout.m_Flags | PS_WORLDSPACE;
+		pSystem->m_ParticleRadius = 4.0f;
+
+		srand(1);
+		uint32 nSpawned = 0;
+		float fTotalMS = 0.0f;
+
+		for(uint32 iFrame=0; iFrame < nFrames; iFrame++)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			// Keep the emitter full, the way an effect replaces its dead particles.
+			if(pSystem->m_nParticles < nParticles)
+			{
+				uint32 nToAdd = nParticles - pSystem->m_nParticles;
+				ps_AddParticles(pSystem, nToAdd, &vMinOffset, &vMaxOffset, &vMinVel, &vMaxVel,
+					&vColor, &vColor, 0.5f, 2.0f);
+				nSpawned += nToAdd;
+			}
+
+			ps_UpdateParticles(pSystem, fFrameTime);
+			ps_OptimizeParticles(pSystem);
+
+			fTotalMS += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		dsi_ConsolePrint("  %-8s %8.3f ms/frame  %d spawned  box (%.0f %.0f %.0f) - (%.0f %.0f %.0f)",
+			layout.m_pName, fTotalMS / nFrames, nSpawned,
+			pSystem->m_MinPos.x, pSystem->m_MinPos.y, pSystem->m_MinPos.z,
+			pSystem->m_MaxPos.x, pSystem->m_MaxPos.y, pSystem->m_MaxPos.z);
+
+		// Without an object manager the system doesn't give its particles back.
+		PSParticle *pCur = pSystem->m_ParticleHead.m_pNext;
+		while(pCur != &pSystem->m_ParticleHead)
+		{
+			PSParticle *pNext = pCur->m_pNext;
+			sb_Free(&particleBank, pCur);
+			pCur = pNext;
+		}
+		pSystem->m_ParticleHead.m_pNext = pSystem->m_ParticleHead.m_pPrev = &pSystem->m_ParticleHead;
+
+		delete pSystem;
+	}
+
+	sb_Term(&particleBank);
+}
+
 #ifndef __XBOX
 void dm_HeapCompact();
 #endif
@@ -862,6 +1180,9 @@ static LTCommandStruct g_LTCommandStructs[] =
 	"ResizeScreen", con_ResizeScreen, 0,
 	"RebindTextures", con_RebindTextures, 0,
 	"LogTextureInfo", con_LogTextureInfo, 0,
+	"DtxBench", con_DtxBench, 0,
+	"AudioBench", con_AudioBench, 0,
+	"ParticleBench", con_ParticleBench, 0,
 	"HeapCompact", con_HeapCompact, 0,
 	"ConsoleHistory", con_ConsoleHistory, 0,
 	"ClearHistory", con_ClearHistory, 0,
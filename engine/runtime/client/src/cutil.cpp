@@ -21,6 +21,8 @@
 #include "render.h"
 #include "sprite.h"
 
+#include <vector>
+
 
 //------------------------------------------------------------------
 //------------------------------------------------------------------
@@ -518,6 +520,7 @@ void CClientMgr::TagAndFreeSprites()
 void CClientMgr::BindUnboundTextures() {
     LTLink *pCur;
     SharedTexture *pTexture;
+    std::vector<SharedTexture*> textures;
 
     for (pCur = m_SharedTextures.m_Head.m_pNext; pCur != &m_SharedTextures.m_Head; pCur=pCur->m_pNext)
     {
@@ -525,9 +528,12 @@ void CClientMgr::BindUnboundTextures() {
 
         if (!pTexture->m_pRenderData)
         {
-            r_BindTexture(pTexture, LTFALSE);
+            textures.push_back(pTexture);
         }
     }
+
+    if (!textures.empty())
+        BindTextureList(&textures[0], (uint32)textures.size());
 }
 
 
@@ -736,7 +742,7 @@ void CClientMgr::UpdateModelDims( ModelInstance *pInstance )
 
 void CClientMgr::MoveObject(LTObject *pObject, const LTVector *pNewPos, bool bForce)
 {
-    LTVector vDiff;
+    LTVector vDiff, vOldPos;
 
     if (!bForce)
     {
@@ -745,6 +751,7 @@ void CClientMgr::MoveObject(LTObject *pObject, const LTVector *pNewPos, bool bFo
             return;
     }
 
+    vOldPos = pObject->GetPos();
     pObject->SetPos(*pNewPos);
 
     // Do special stuff if it's a WorldModel.
@@ -754,6 +761,7 @@ void CClientMgr::MoveObject(LTObject *pObject, const LTVector *pNewPos, bool bFo
     }
 
     world_bsp_client->ClientTree()->InsertObject(pObject);
+    UpdateCollisionObject(m_MoveAbstract->GetCollisionMgr(), pObject, vOldPos);
 }
 
 
@@ -95,6 +95,12 @@ void ps_AddParticles(LTParticleSystem *pSystem, uint32 nParticles,
 	LTVector	offset, vel, color;
 	LTFLOAT		lifeTime;
 
+	LTParticleArrays &arrays = pSystem->m_ParticleArrays;
+	uint32 iFirst = arrays.m_nParticles;
+
+	if((pSystem->m_psFlags & PS_ARRAYS) && !ps_AddParticleArrays(pSystem, nParticles))
+		return;
+
 	for(i=0; i < nParticles; i++)
 	{
 		t[0] = (LTFLOAT)rand() / RAND_MAX;
@@ -115,7 +121,121 @@ void ps_AddParticles(LTParticleSystem *pSystem, uint32 nParticles,
 			offset += pSystem->GetPos();
 		}
 
-		ps_AddParticle(pSystem, &offset, &color, &vel, lifeTime);
+		if(pSystem->m_psFlags & PS_ARRAYS)
+		{
+			uint32 iParticle = iFirst + i;
+
+			arrays.m_pPosX[iParticle]			= offset.x;
+			arrays.m_pPosY[iParticle]			= offset.y;
+			arrays.m_pPosZ[iParticle]			= offset.z;
+			arrays.m_pVelX[iParticle]			= vel.x;
+			arrays.m_pVelY[iParticle]			= vel.y;
+			arrays.m_pVelZ[iParticle]			= vel.z;
+			arrays.m_pColorR[iParticle]			= color.x;
+			arrays.m_pColorG[iParticle]			= color.y;
+			arrays.m_pColorB[iParticle]			= color.z;
+			arrays.m_pLifetime[iParticle]		= lifeTime;
+			arrays.m_pTotalLifetime[iParticle]	= lifeTime;
+
+			ps_UpdateBox(pSystem, offset, arrays.m_pSize[iParticle]);
+		}
+		else
+		{
+			ps_AddParticle(pSystem, &offset, &color, &vel, lifeTime);
+		}
+	}
+}
+
+
+bool ps_AddParticleArrays(LTParticleSystem *pSystem, uint32 nParticles)
+{
+	LTParticleArrays &arrays = pSystem->m_ParticleArrays;
+
+	if(!pSystem->ReserveParticleArrays(arrays.m_nParticles + nParticles))
+		return false;
+
+	for(uint32 i = arrays.m_nParticles; i < arrays.m_nParticles + nParticles; i++)
+	{
+		arrays.m_pPosX[i]				= 0.0f;
+		arrays.m_pPosY[i]				= 0.0f;
+		arrays.m_pPosZ[i]				= 0.0f;
+		arrays.m_pVelX[i]				= 0.0f;
+		arrays.m_pVelY[i]				= 0.0f;
+		arrays.m_pVelZ[i]				= 0.0f;
+		arrays.m_pSize[i]				= pSystem->m_ParticleRadius;
+		arrays.m_pColorR[i]				= 255.0f;
+		arrays.m_pColorG[i]				= 255.0f;
+		arrays.m_pColorB[i]				= 255.0f;
+		arrays.m_pAlpha[i]				= 1.0f;
+		arrays.m_pAngle[i]				= 0.0f;
+		arrays.m_pAngularVelocity[i]	= 0.0f;
+		arrays.m_pLifetime[i]			= 0.0f;
+		arrays.m_pTotalLifetime[i]		= 0.0f;
+		arrays.m_pUserData[i]			= 0;
+	}
+
+	arrays.m_nParticles += nParticles;
+
+	pSystem->m_nParticles += nParticles;
+	pSystem->m_nChangedParticles += nParticles;
+
+	return true;
+}
+
+
+uint32 ps_RemoveExpiredParticles(LTParticleSystem *pSystem)
+{
+	LTParticleArrays &arrays = pSystem->m_ParticleArrays;
+
+	uint32 nKept = lt_CompactParticles(arrays);
+	uint32 nRemoved = arrays.m_nParticles - nKept;
+
+	arrays.m_nParticles = nKept;
+	pSystem->m_nParticles = nKept;
+
+	return nRemoved;
+}
+
+
+// Fits the box of a PS_ARRAYS system to its particles.  Going over the arrays
+// is cheap enough to do on every update, so unlike the list the box shrinks
+// as well as grows.
+static void ps_FitBoxToArrays(LTParticleSystem *pSystem)
+{
+	//see ps_UpdateBox for the rotation
+	float fSizeScale = (pSystem->m_psFlags & PS_USEROTATION) ? 1.41421356237309504f : 1.0f;
+
+	if(!lt_GetParticleBounds(pSystem->m_ParticleArrays, fSizeScale, pSystem->m_MinPos, pSystem->m_MaxPos))
+	{
+		pSystem->m_MinPos.Init();
+		pSystem->m_MaxPos.Init();
+	}
+}
+
+//turns a particle inside of a blocking object so that it flows around it
+static inline void ps_DeflectParticle(const LTVector& vToParticle, float fDistToPartSqr,
+									  const LTObject *pObject, float fObjRad, LTVector& vVelocity)
+{
+	//we need to update the velocity so that it moves perpindicular
+	//to the sphere
+	
+	if(vToParticle.Dot(pObject->m_Velocity) > 0.1f)
+	{
+		vVelocity += vToParticle * (fObjRad / (float)sqrt(fDistToPartSqr) - 1.0f);
+	}
+	if(vToParticle.Dot(vVelocity) < 0.0f)
+	{
+		//now find the normal of the incoming and outgoing vector
+		LTVector vIncomingNormal = vVelocity.Cross(vToParticle);
+
+		//and get the final velocity
+		vVelocity = vToParticle.Cross(vIncomingNormal);
+
+		//now here is a neat little trick. Since A cross B has mag |A||B|
+		//incoming normal has mag |V||T|, then the new velocity has mag
+		//|V||T||T|, so we can just divide by the distance squared (|T|), saving
+		//us a sqrt
+		vVelocity /= fDistToPartSqr;
 	}
 }
 
@@ -148,7 +268,6 @@ static void ps_HandleParticleCollisions(LTParticleSystem *pSystem, LTFLOAT t)
 	//values for updating intersecting particles
 	LTVector vToParticle;
 	float	 fDistToPartSqr;
-	LTVector vIncomingNormal;
 
 	//the transformation matrix for the world to particle system
 	bool	 bMatValid = false;
@@ -157,6 +276,8 @@ static void ps_HandleParticleCollisions(LTParticleSystem *pSystem, LTFLOAT t)
 	LTVector vObjPos;
 	LTVector vPartVel;
 
+	const LTParticleArrays &arrays = pSystem->m_ParticleArrays;
+
 	//search through all objects that could possibly block them...
 	for(uint32 nCurrType = 0; nCurrType < nNumObjectTypes; nCurrType++)
 	{
@@ -190,6 +311,27 @@ static void ps_HandleParticleCollisions(LTParticleSystem *pSystem, LTFLOAT t)
 
 
 			//run through the particles
+			if(pSystem->m_psFlags & PS_ARRAYS)
+			{
+				for(uint32 i=0; i < arrays.m_nParticles; i++)
+				{
+					//see if it intersects with the blocker
+					vToParticle.Init(arrays.m_pPosX[i] - vObjPos.x, arrays.m_pPosY[i] - vObjPos.y, arrays.m_pPosZ[i] - vObjPos.z);
+					fDistToPartSqr = vToParticle.MagSqr();
+
+					if(fDistToPartSqr < fObjRadSqr)
+					{
+						vPartVel.Init(arrays.m_pVelX[i], arrays.m_pVelY[i], arrays.m_pVelZ[i]);
+						ps_DeflectParticle(vToParticle, fDistToPartSqr, pObject, fObjRad, vPartVel);
+
+						arrays.m_pVelX[i] = vPartVel.x;
+						arrays.m_pVelY[i] = vPartVel.y;
+						arrays.m_pVelZ[i] = vPartVel.z;
+					}
+				}
+				continue;
+			}
+
 			pParticle	= pSystem->m_ParticleHead.m_pNext;
 			pEnd		= &pSystem->m_ParticleHead;
 
@@ -201,28 +343,7 @@ static void ps_HandleParticleCollisions(LTParticleSystem *pSystem, LTFLOAT t)
 
 				if(fDistToPartSqr < fObjRadSqr)
 				{
-					//we need to update the velocity so that it moves perpindicular
-					//to the sphere
-					
-					if(vToParticle.Dot(pObject->m_Velocity) > 0.1f)
-					{
-						vPartVel = vToParticle * (fObjRad / (float)sqrt(fDistToPartSqr) - 1.0f); 
-						pParticle->m_Velocity += vPartVel;
-					}
-					if(vToParticle.Dot(pParticle->m_Velocity) < 0.0f)
-					{
-						//now find the normal of the incoming and outgoing vector
-						vIncomingNormal = pParticle->m_Velocity.Cross(vToParticle);
-
-						//and get the final velocity
-						pParticle->m_Velocity = vToParticle.Cross(vIncomingNormal);
-
-						//now here is a neat little trick. Since A cross B has mag |A||B|
-						//incoming normal has mag |V||T|, then the new velocity has mag
-						//|V||T||T|, so we can just divide by the distance squared (|T|), saving
-						//us a sqrt
-						pParticle->m_Velocity /= fDistToPartSqr;
-					}
+					ps_DeflectParticle(vToParticle, fDistToPartSqr, pObject, fObjRad, pParticle->m_Velocity);
 				}
 
 				pParticle = pParticle->m_pNext;
@@ -232,9 +353,68 @@ static void ps_HandleParticleCollisions(LTParticleSystem *pSystem, LTFLOAT t)
 }
 
 
-void ps_UpdateParticles(LTParticleSystem *pSystem, LTFLOAT t)
+//finds the height of the floor under a PS_BOUNCE system, in the space of its particles
+static bool ps_GetBounceHeight(LTParticleSystem *pSystem, float& yCoord)
 {
 	LTVector basePos = pSystem->GetPos();
+
+	ClientIntersectQuery iQuery;
+	ClientIntersectInfo iInfo;
+
+	VEC_COPY(iQuery.m_From, basePos);
+	VEC_COPY(iQuery.m_To, iQuery.m_From);
+	iQuery.m_To.y -= 400.0f;
+
+	if (!world_bsp_client->IntersectSegment(&iQuery, &iInfo))
+		return false;
+
+	//The original equation used to update the particle position
+	//was yCoord = iInfo.m_Plane.m_Normal.y * iInfo.m_Plane.m_Dist;
+	//but this was causing issues on sloped surfaces. So this
+	//has been replaced with simply the point of collision -JohnO
+	yCoord = iInfo.m_Point.y;
+	
+	if(!(pSystem->m_psFlags & PS_WORLDSPACE))
+		yCoord -= basePos.y;
+
+	return true;
+}
+
+
+static void ps_UpdateParticleArrays(LTParticleSystem *pSystem, LTFLOAT t)
+{
+	const LTParticleArrays &arrays = pSystem->m_ParticleArrays;
+	uint32 flags = pSystem->m_psFlags;
+
+	if(!(flags & PS_DUMB))
+	{
+		lt_IntegrateParticles(arrays, t, LTVector(0.0f, pSystem->m_GravityAccel * t, 0.0f), 1.0f);
+
+		if(!(flags & PS_NEVERDIE))
+		{
+			ps_RemoveExpiredParticles(pSystem);
+		}
+
+		float yCoord;
+		if((flags & PS_BOUNCE) && ps_GetBounceHeight(pSystem, yCoord))
+		{
+			for(uint32 i=0; i < arrays.m_nParticles; i++)
+			{
+				if((arrays.m_pVelY[i] < 0.0f) && (arrays.m_pPosY[i] < yCoord))
+				{
+					arrays.m_pPosY[i] = yCoord;
+					arrays.m_pVelY[i] = -arrays.m_pVelY[i] * 0.5f;
+				}
+			}
+		}
+	}
+
+	ps_FitBoxToArrays(pSystem);
+}
+
+
+void ps_UpdateParticles(LTParticleSystem *pSystem, LTFLOAT t)
+{
 	uint32 flags = pSystem->m_psFlags;
 
 	//see if we need to handle intersections with other objects
@@ -243,6 +423,12 @@ void ps_UpdateParticles(LTParticleSystem *pSystem, LTFLOAT t)
 		ps_HandleParticleCollisions(pSystem, t);
 	}
 
+	if(flags & PS_ARRAYS)
+	{
+		ps_UpdateParticleArrays(pSystem, t);
+		return;
+	}
+
 	//see if this is a dumb particle system. If it is, bail
 	if(flags & PS_DUMB)
 		return;
@@ -294,41 +480,23 @@ void ps_UpdateParticles(LTParticleSystem *pSystem, LTFLOAT t)
 
 
 	// Bounce the particles.
-	if(flags & PS_BOUNCE)
+	float yCoord;
+	if((flags & PS_BOUNCE) && ps_GetBounceHeight(pSystem, yCoord))
 	{
-		ClientIntersectQuery iQuery;
-		ClientIntersectInfo iInfo;
-
-		VEC_COPY(iQuery.m_From, basePos);
-		VEC_COPY(iQuery.m_To, iQuery.m_From);
-		iQuery.m_To.y -= 400.0f;
-
-		if (world_bsp_client->IntersectSegment(&iQuery, &iInfo))
+		pParticle = pSystem->m_ParticleHead.m_pNext;
+		pEnd = &pSystem->m_ParticleHead;
+		while(pParticle != pEnd)
 		{
-			//The original equation used to update the particle position
-			//was yCoord = iInfo.m_Plane.m_Normal.y * iInfo.m_Plane.m_Dist;
-			//but this was causing issues on sloped surfaces. So this
-			//has been replaced with simply the point of collision -JohnO
-			float yCoord = iInfo.m_Point.y;
-			
-			if(!(pSystem->m_psFlags & PS_WORLDSPACE))
-				yCoord -= basePos.y;
-
-			pParticle = pSystem->m_ParticleHead.m_pNext;
-			pEnd = &pSystem->m_ParticleHead;
-			while(pParticle != pEnd)
+			if(pParticle->m_Velocity.y < 0.0f)
 			{
-				if(pParticle->m_Velocity.y < 0.0f)
+				if(pParticle->m_Pos.y < yCoord)
 				{
-					if(pParticle->m_Pos.y < yCoord)
-					{
-						pParticle->m_Pos.y = yCoord;
-						pParticle->m_Velocity.y = -pParticle->m_Velocity.y * 0.5f;
-					}
+					pParticle->m_Pos.y = yCoord;
+					pParticle->m_Velocity.y = -pParticle->m_Velocity.y * 0.5f;
 				}
-
-				pParticle = pParticle->m_pNext;
 			}
+
+			pParticle = pParticle->m_pNext;
 		}
 	}
 }
@@ -403,6 +571,28 @@ void ps_SortParticles(LTParticleSystem *pSystem, const LTVector& vDir, uint32 nN
 	float fCurrDot;
 	float fNextDot;
 
+	if(pSystem->m_psFlags & PS_ARRAYS)
+	{
+		const LTParticleArrays &arrays = pSystem->m_ParticleArrays;
+
+		for(uint32 nCurrIter = 0; nCurrIter < nNumIters; nCurrIter++)
+		{
+			fCurrDot = arrays.m_pPosX[0] * vActualDir.x + arrays.m_pPosY[0] * vActualDir.y + arrays.m_pPosZ[0] * vActualDir.z;
+
+			for(uint32 i = 1; i < arrays.m_nParticles; i++)
+			{
+				fNextDot = arrays.m_pPosX[i] * vActualDir.x + arrays.m_pPosY[i] * vActualDir.y + arrays.m_pPosZ[i] * vActualDir.z;
+
+				//carry the current particle along until it reaches a farther one
+				if(fNextDot < fCurrDot)
+					lt_SwapParticles(arrays, i - 1, i);
+				else
+					fCurrDot = fNextDot;
+			}
+		}
+		return;
+	}
+
 	//run through the specified number of times
 	for(uint32 nCurrIter = 0; nCurrIter < nNumIters; nCurrIter++)
 	{
@@ -455,13 +645,22 @@ void ps_OptimizeParticles(LTParticleSystem *pSystem)
 {
 	PSParticle *pCur;
 
-	if(pSystem->m_ParticleHead.m_pNext == &pSystem->m_ParticleHead)
+	if(pSystem->m_psFlags & PS_ARRAYS)
+	{
+		ps_FitBoxToArrays(pSystem);
+	}
+
+	if(pSystem->m_nParticles == 0)
 	{
 		pSystem->m_MinPos.Init();
 		pSystem->m_MaxPos.Init();
 		pSystem->m_SystemCenter.Init();
 		pSystem->m_SystemRadius = 1.0f;
 	}
+	else if(pSystem->m_psFlags & PS_ARRAYS)
+	{
+		ps_UpdateParticleBoundingBox(pSystem);
+	}
 	else
 	{
 		pSystem->m_MinPos.Init(100000.0f, 100000.0f, 100000.0f);
@@ -105,6 +105,13 @@ inline PSParticle* ps_AddParticle(LTParticleSystem *pSystem, const LTVector *pPo
     return pParticle;
 }
 
+// Adds particles to a PS_ARRAYS system, at the end of its arrays.
+bool ps_AddParticleArrays(LTParticleSystem *pSystem, uint32 nParticles);
+
+// Removes the particles of a PS_ARRAYS system whose lifetime has run out.
+// Returns how many were removed.
+uint32 ps_RemoveExpiredParticles(LTParticleSystem *pSystem);
+
 // Call before and after updating particle positions.  Updates the
 // bounding sphere info.  EndUpdatingPositions returns LTTRUE if the
 // system grew.
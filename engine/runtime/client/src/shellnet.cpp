@@ -34,6 +34,9 @@
 
 #include "misctools.h"
 #include "soundmgr.h"
+#include "ltresourceloader.h"
+
+#include <vector>
 
 //------------------------------------------------------------------
 //------------------------------------------------------------------
@@ -1446,6 +1449,34 @@ static LTRESULT OnClientObjectID(CClientShell *pShell, CPacket_Read &cPacket)
     return LT_OK;
 }
 
+// Starts reading in all the files in a preload packet on the resource loader
+// so loading them one at a time doesn't wait on the disk for each.  Files
+// that are already loaded are skipped.
+static void PrefetchPreloadFiles(const CPacket_Read &cPacket, uint8 typeCode)
+{
+    CPacket_Read cFiles(cPacket);
+    FileRef ref;
+    FileIdentifier *pFileIdent;
+    std::vector<FileIdentifier*> files;
+
+    ref.m_FileType = FILE_SERVERFILE;
+
+    while (!cFiles.EOP())
+    {
+        ref.m_FileID = cFiles.Readuint16();
+        pFileIdent = client_file_mgr->GetFileIdentifier(&ref, typeCode);
+        if (pFileIdent && !pFileIdent->m_pData)
+        {
+            files.push_back(pFileIdent);
+        }
+    }
+
+    if (!files.empty())
+    {
+        client_file_mgr->PrefetchFiles(&files[0], (uint32)files.size(), LTRESOURCE_PRIORITY_NORMAL);
+    }
+}
+
 static LTRESULT OnPreloadListPacket(CClientShell *pShell, CPacket_Read &cPacket) 
 {
     uint8 type;
@@ -1475,6 +1506,9 @@ static LTRESULT OnPreloadListPacket(CClientShell *pShell, CPacket_Read &cPacket)
             // Get rid of sounds we don't need.
             GetClientILTSoundMgrImpl()->RemoveAllUntaggedSoundBuffers();
 
+            // And anything that was read ahead but never opened.
+            client_file_mgr->FlushPrefetchedFiles();
+
        		// Tell the server we're ready.
 			CPacket_Write cResponse;
 			cResponse.Writeuint8(CMSG_CONNECTSTAGE);
@@ -1485,6 +1519,8 @@ static LTRESULT OnPreloadListPacket(CClientShell *pShell, CPacket_Read &cPacket)
 
         case PRELOADTYPE_MODEL:
         {
+            PrefetchPreloadFiles(cPacket, TYPECODE_MODEL);
+
             while (!cPacket.EOP()) 
 			{
 				ref.m_FileID = cPacket.Readuint16();
@@ -1503,6 +1539,8 @@ static LTRESULT OnPreloadListPacket(CClientShell *pShell, CPacket_Read &cPacket)
 
 		case PRELOADTYPE_MODEL_CACHED :
 		{
+			PrefetchPreloadFiles(cPacket, TYPECODE_MODEL);
+
 			while (!cPacket.EOP())
 			{
 				ref.m_FileID = cPacket.Readuint16();
@@ -1520,6 +1558,8 @@ static LTRESULT OnPreloadListPacket(CClientShell *pShell, CPacket_Read &cPacket)
 		break ;
         case PRELOADTYPE_TEXTURE:
         {
+            PrefetchPreloadFiles(cPacket, TYPECODE_TEXTURE);
+
             while (!cPacket.EOP()) 
 			{
                 ref.m_FileID = cPacket.Readuint16();
@@ -1534,6 +1574,8 @@ static LTRESULT OnPreloadListPacket(CClientShell *pShell, CPacket_Read &cPacket)
 
         case PRELOADTYPE_SPRITE:
         {
+            PrefetchPreloadFiles(cPacket, TYPECODE_SPRITE);
+
             while (!cPacket.EOP())
 			{
                 ref.m_FileID = cPacket.Readuint16();
@@ -1545,13 +1587,22 @@ static LTRESULT OnPreloadListPacket(CClientShell *pShell, CPacket_Read &cPacket)
  
         case PRELOADTYPE_SOUND:
         {
+            PrefetchPreloadFiles(cPacket, TYPECODE_SOUND);
+
             while (!cPacket.EOP()) 
 			{
                 ref.m_FileID = cPacket.Readuint16();
                 pFileIdent = client_file_mgr->GetFileIdentifier(&ref, TYPECODE_SOUND);
                 if (pFileIdent) 
 				{
-                    GetClientILTSoundMgrImpl()->CreateBuffer(*pFileIdent);
+                    CSoundBuffer *pSoundBuffer = GetClientILTSoundMgrImpl()->CreateBuffer(*pFileIdent);
+
+                    // Have compressed sounds decoded in the background so they're
+                    // ready the first time they play.
+                    if (pSoundBuffer)
+                    {
+                        GetClientILTSoundMgrImpl()->GetDecodeCache().DecodeAhead(*pSoundBuffer);
+                    }
                 }
             }
         }
@@ -42,8 +42,6 @@ typedef struct FileTree_t
 #ifdef LT_FILE_THREADSAFE
 	LCriticalSection m_CriticalSection;
 #endif
-	CRezItm*	m_pLastRezItm;
-	uint32		m_nLastRezPos;
 	char		m_BaseName[1];
 } FileTree;
 
@@ -172,7 +170,8 @@ class RezFileStream : public BaseFileStream
 {
 public:
 	RezFileStream() :
-		m_pRezItm(LTNULL)
+		m_pRezItm(LTNULL),
+		m_pMappedData(LTNULL)
 	{
 	}
 
@@ -186,6 +185,13 @@ public:
 
 	LTRESULT SeekTo(uint32 offset)
 	{
+		// Mapped streams keep their own position so they never touch the shared CRezItm.
+		if (m_pMappedData)
+		{
+			m_SeekOffset = offset;
+			return LT_OK;
+		}
+
 		if (m_pRezItm->Seek(offset))
 		{
 			m_SeekOffset = offset;
@@ -204,22 +210,29 @@ public:
 
 		if (size != 0)
 		{
+			// Memory mapped rez files are read straight out of the mapping with no lock,
+			// so any number of streams can read at once.
+			if (m_pMappedData)
+			{
+				if ((m_SeekOffset > m_FileLen) || (size > m_FileLen - m_SeekOffset))
+				{
+					memset(pData, 0, size);
+					m_ErrorStatus = 1;
+					return LT_ERROR;
+				}
+
+				memcpy(pData, m_pMappedData + m_SeekOffset, size);
+				m_SeekOffset += size;
+				return LT_OK;
+			}
+
 #ifdef LT_FILE_THREADSAFE
 			CSAccess access(&m_pTree->m_CriticalSection);
 #endif
 
-			if ((m_pTree->m_pLastRezItm == m_pRezItm) && (m_pTree->m_nLastRezPos == m_SeekOffset))
-			{
-				sizeRead = m_pRezItm->Read(pData, size);
-			}
-			else
-			{
-				sizeRead = m_pRezItm->Read(pData, size, m_SeekOffset);
-			}
+			sizeRead = m_pRezItm->Read(pData, size, m_SeekOffset);
 
 			m_SeekOffset += sizeRead;
-			m_pTree->m_pLastRezItm = m_pRezItm;
-			m_pTree->m_nLastRezPos = m_SeekOffset;
 			if (sizeRead != size)
 			{
 				memset(pData, 0, size);
@@ -231,6 +244,7 @@ public:
 	}
 
 	CRezItm* m_pRezItm;
+	const uint8* m_pMappedData;	// The resource's bytes if its rez file is memory mapped.
 };
 
 static ObjectBank<UnixFileStream> g_UnixFileStreamBank(8, 8);
@@ -318,15 +332,11 @@ int df_OpenTree(const char *pName, HLTFileTree *&pTreePointer)
 		pTree = (FileTree*)dalloc_z(allocSize);
 		pTree->m_TreeType = UnixTree;
 		pTree->m_pRezMgr = LTNULL;
-		pTree->m_pLastRezItm = LTNULL;
-		pTree->m_nLastRezPos = 0;
 	}
 	else
 	{
 		LT_MEM_TRACK_ALLOC(pTree = (FileTree*)dalloc_z(allocSize),LT_MEM_TYPE_FILE);
 		pTree->m_TreeType = RezFileTree;
-		pTree->m_pLastRezItm = LTNULL;
-		pTree->m_nLastRezPos = 0;
 
 		LT_MEM_TRACK_ALLOC(pTree->m_pRezMgr = new CRezMgr,LT_MEM_TYPE_FILE);
 		if (pTree->m_pRezMgr == LTNULL)
@@ -571,6 +581,7 @@ ILTStream* df_Open(HLTFileTree* hTree, const char *pName, int openMode)
 
 		RezFileStream *pRezStream = g_RezFileStreamBank.Allocate();
 		pRezStream->m_pRezItm = pRezItm;
+		pRezStream->m_pMappedData = pRezItm->GetMappedData();
 		pRezStream->m_pTree = pTree;
 		pRezStream->m_FileLen = pRezItm->GetSize();
 		pRezStream->m_SeekOffset = 0;
@@ -74,10 +74,6 @@ uint32 g_PD_FOpen=0;
 // Structures and defines.
 // ------------------------------------------------------------------ //
 
-CRezItm* g_pDeFileLastRezItm;
-uint32 g_nDeFileLastRezPos;
-
-
 struct FileTree
 {
 	TreeType	m_TreeType;
@@ -188,7 +184,8 @@ class RezFileStream : public BaseFileStream
 public:
 
 	RezFileStream() :
-	  m_SeekOffset(0)
+	  m_SeekOffset(0),
+	  m_pMappedData(LTNULL)
 	{
 	}
 
@@ -202,6 +199,13 @@ public:
 
 	LTRESULT	SeekTo(uint32 offset)
 	{
+		// Mapped streams keep their own position so they never touch the shared CRezItm.
+		if(m_pMappedData)
+		{
+			m_SeekOffset = offset;
+			return LT_OK;
+		}
+
 		if(m_pRezItm->Seek(offset))
 		{
 			m_SeekOffset = offset;
@@ -220,26 +224,33 @@ public:
 
 		if(size != 0)
 		{
+			// Memory mapped rez files are read straight out of the mapping with no lock,
+			// so any number of streams can read at once.
+			if(m_pMappedData)
+			{
+				if((m_SeekOffset > m_FileLen) || (size > m_FileLen - m_SeekOffset))
+				{
+					memset(pData, 0, size);
+					m_ErrorStatus = 1;
+					return LT_ERROR;
+				}
+
+				memcpy(pData, m_pMappedData + m_SeekOffset, size);
+				m_SeekOffset += size;
+				return LT_OK;
+			}
+
 			#ifdef LT_FILE_THREADSAFE
 			EnterCriticalSection(&m_pTree->m_CriticalSection);
 			#endif
 			
-			if ((g_pDeFileLastRezItm == m_pRezItm) && (g_nDeFileLastRezPos == m_SeekOffset))
-			{
-				sizeRead = m_pRezItm->Read(pData, size);
-			}
-			else
-			{
-				sizeRead = m_pRezItm->Read(pData, size, m_SeekOffset);
-			}
+			sizeRead = m_pRezItm->Read(pData, size, m_SeekOffset);
 			
 			#ifdef LT_FILE_THREADSAFE
 			LeaveCriticalSection(&m_pTree->m_CriticalSection);
 			#endif
 			
 			m_SeekOffset += sizeRead;
-			g_pDeFileLastRezItm = m_pRezItm;
-			g_nDeFileLastRezPos = m_SeekOffset;
 			if(sizeRead != size)
 			{
 				memset(pData, 0, size);
@@ -259,6 +270,7 @@ public:
 	}
 
 	uint32		m_SeekOffset;	// Seek offset (used in rezfiles) (NOTE: in a rezmgr rez file this is the current position inside the resource).
+	const uint8	*m_pMappedData;	// The resource's bytes if its rez file is memory mapped.
 
 };
 
@@ -300,8 +312,6 @@ struct LTFindData
 
 void df_Init()
 {
-	g_pDeFileLastRezItm = LTNULL;
-	g_nDeFileLastRezPos = 0;
 }
 
 void df_Term()
@@ -352,8 +362,6 @@ int df_OpenTree(const char *pName, HLTFileTree *&pTreePointer)
 		}
 
 		pTree->m_pRezMgr->SetDirSeparators("\\/");
-		g_pDeFileLastRezItm = LTNULL;
-		g_nDeFileLastRezPos = 0;
 
 #ifdef LT_FILE_THREADSAFE
 		InitializeCriticalSection(&pTree->m_CriticalSection);
@@ -383,8 +391,6 @@ void df_CloseTree(HLTFileTree *hTree)
 		DeleteCriticalSection(&pTree->m_CriticalSection);
 #endif
 	}
-	g_pDeFileLastRezItm = LTNULL;
-	g_nDeFileLastRezPos = 0;
 
 	dfree(pTree);
 }
@@ -562,6 +568,7 @@ ILTStream* df_Open(HLTFileTree *hTree, const char *pName, int openMode)
 		// Use fp to setup the stream.
 		RezFileStream *pRezStream = g_RezFileStreamBank.Allocate();
 		pRezStream->m_pRezItm = pRezItm;
+		pRezStream->m_pMappedData = pRezItm->GetMappedData();
 		pRezStream->m_pTree = pTree;
 		pRezStream->m_FileLen = pRezItm->GetSize();
 		pRezStream->m_SeekOffset = 0;
@@ -3,6 +3,8 @@
 #include "packet.h"
 #include "syslthread.h"
 
+#include <mutex>
+
 
 // special interlock for LINUX
 #ifdef __LINUX
@@ -60,126 +62,324 @@ uint32 CountSetBits(uint32 nValue)
 
 //////////////////////////////////////////////////////////////////////////////
 // Packet data allocation handling
+//
+// Dead chunks and packet data go into a small per-thread cache, so the usual
+// allocate/free path doesn't touch anything shared.  When a thread's cache
+// gets too big it hands a batch over to a shared list, and a thread that runs
+// dry takes the whole shared list at once.  The shared lists are only ever
+// pushed onto or emptied in one go, which keeps them lock-free without the
+// ABA problem a one-node-at-a-time pop would have.
+
+static std::atomic<uint32> s_nAllocatedChunks(0);
+static std::atomic<uint32> s_nActiveChunks(0);
+static std::atomic<uint32> s_nAllocatedPackets(0);
+static std::atomic<uint32> s_nActivePackets(0);
+
+// Set once this thread's cache has been destroyed, so anything freed during
+// thread shutdown goes straight to the shared lists.
+static thread_local bool s_bThreadCacheGone = false;
+
+struct CPacket_Data::SThreadCache
+{
+	enum {
+		// How many dead chunks a thread holds on to (64k worth)
+		k_nMaxChunks = 256,
+		// How many it hands back when it goes over
+		k_nChunkReleaseBatch = k_nMaxChunks / 2,
+		k_nMaxData = 64,
+		k_nDataReleaseBatch = k_nMaxData / 2
+	};
+
+	SThreadCache();
+	~SThreadCache();
+
+	// Returns 0 if there's nothing to re-use
+	SChunk *Allocate_Chunk();
+	void Free_Chunks(SChunk *pHead, SChunk *pTail, uint32 nCount);
+	CPacket_Data *Allocate_Data();
+	void Free_Data(CPacket_Data *pData);
+
+	// Links between dead items
+	static SChunk *GetNext(SChunk *pChunk) { return pChunk->m_pNext; }
+	static void SetNext(SChunk *pChunk, SChunk *pNext) { pChunk->m_pNext = pNext; }
+	static CPacket_Data *GetNext(CPacket_Data *pData) { return (CPacket_Data*)pData->m_pFirstChunk; }
+	static void SetNext(CPacket_Data *pData, CPacket_Data *pNext) { pData->m_pFirstChunk = (SChunk*)pNext; }
+
+	// Walks nCount - 1 links from pHead
+	template <class T>
+	static T *FindTail(T *pHead, uint32 nCount)
+	{
+		T *pTail = pHead;
+		while (--nCount)
+			pTail = GetNext(pTail);
+		return pTail;
+	}
 
-CSysSerialVar g_cPacket_CS_Trash;
-CPacket_Data *CPacket_Data::s_pTrash_Data = 0;
+	// Lock-free list of dead items shared between threads
+	template <class T>
+	class CSharedList
+	{
+	public:
+		CSharedList() : m_pHead(0), m_nCount(0) {}
 
-CPacket_Data CPacket_Data::s_cTrash_Chunk;
+		void Push(T *pHead, T *pTail, uint32 nCount)
+		{
+			// Count them first so the count never goes below what's in the list
+			m_nCount.fetch_add(nCount, std::memory_order_relaxed);
+			T *pOldHead = m_pHead.load(std::memory_order_relaxed);
+			do
+			{
+				SetNext(pTail, pOldHead);
+			} while (!m_pHead.compare_exchange_weak(pOldHead, pHead, std::memory_order_release, std::memory_order_relaxed));
+		}
 
-CSysSerialVar g_cPacket_CS_Tracking;
+		// Takes the whole list, returning how many were in it in nCount
+		T *TakeAll(uint32 *pCount)
+		{
+			T *pHead = m_pHead.exchange(0, std::memory_order_acquire);
+			uint32 nCount = 0;
+			for (T *pCur = pHead; pCur; pCur = GetNext(pCur))
+				++nCount;
+			m_nCount.fetch_sub(nCount, std::memory_order_relaxed);
+			*pCount = nCount;
+			return pHead;
+		}
 
-uint32 s_nAllocatedChunks = 0;
-uint32 s_nActiveChunks = 0;
-uint32 s_nAllocatedPackets = 0;
-uint32 s_nActivePackets = 0;
+		uint32 GetCount() const { return m_nCount.load(std::memory_order_relaxed); }
 
-// Gimmie some chunk, baby...
-CPacket_Data::SChunk *CPacket_Data::Allocate_Chunk(uint32 nOffset)
+	private:
+		std::atomic<T*> m_pHead;
+		std::atomic<uint32> m_nCount;
+	};
+
+	// Dead chunks owned by this thread
+	SChunk *m_pChunks;
+	// Only written by the owning thread, but GetAllocStats reads it
+	std::atomic<uint32> m_nChunks;
+	// Dead data owned by this thread
+	CPacket_Data *m_pData;
+	uint32 m_nData;
+
+	// Links in the list of live caches
+	SThreadCache *m_pPrevCache, *m_pNextCache;
+
+	static CSharedList<SChunk> s_cSharedChunks;
+	static CSharedList<CPacket_Data> s_cSharedData;
+
+	// List of live caches, for the stats
+	static std::mutex s_cCacheListMutex;
+	static SThreadCache *s_pCacheList;
+};
+
+CPacket_Data::SThreadCache::CSharedList<CPacket_Data::SChunk> CPacket_Data::SThreadCache::s_cSharedChunks;
+CPacket_Data::SThreadCache::CSharedList<CPacket_Data> CPacket_Data::SThreadCache::s_cSharedData;
+std::mutex CPacket_Data::SThreadCache::s_cCacheListMutex;
+CPacket_Data::SThreadCache *CPacket_Data::SThreadCache::s_pCacheList = 0;
+
+CPacket_Data::SThreadCache::SThreadCache() :
+	m_pChunks(0),
+	m_nChunks(0),
+	m_pData(0),
+	m_nData(0),
+	m_pPrevCache(0)
 {
-	g_cPacket_CS_Trash.Lock();
-	
-	g_cPacket_CS_Tracking.Lock();
-	++s_nActiveChunks;
-	g_cPacket_CS_Tracking.Unlock();
+	std::lock_guard<std::mutex> cLock(s_cCacheListMutex);
+	m_pNextCache = s_pCacheList;
+	if (m_pNextCache)
+		m_pNextCache->m_pPrevCache = this;
+	s_pCacheList = this;
+}
 
-	if (s_cTrash_Chunk.m_pFirstChunk)
+CPacket_Data::SThreadCache::~SThreadCache()
+{
+	// Give everything back for the other threads to use
+	uint32 nChunks = m_nChunks.load(std::memory_order_relaxed);
+	if (nChunks)
+		s_cSharedChunks.Push(m_pChunks, FindTail(m_pChunks, nChunks), nChunks);
+	if (m_nData)
+		s_cSharedData.Push(m_pData, FindTail(m_pData, m_nData), m_nData);
+
+	std::lock_guard<std::mutex> cLock(s_cCacheListMutex);
+	if (m_pPrevCache)
+		m_pPrevCache->m_pNextCache = m_pNextCache;
+	else
+		s_pCacheList = m_pNextCache;
+	if (m_pNextCache)
+		m_pNextCache->m_pPrevCache = m_pPrevCache;
+
+	s_bThreadCacheGone = true;
+}
+
+CPacket_Data::SChunk *CPacket_Data::SThreadCache::Allocate_Chunk()
+{
+	uint32 nChunks = m_nChunks.load(std::memory_order_relaxed);
+	if (!nChunks)
 	{
-		SChunk *pResult = s_cTrash_Chunk.m_pFirstChunk;
-		s_cTrash_Chunk.m_pFirstChunk = s_cTrash_Chunk.m_pFirstChunk->m_pNext;
-		
-		g_cPacket_CS_Trash.Unlock();
+		m_pChunks = s_cSharedChunks.TakeAll(&nChunks);
+		if (!nChunks)
+			return 0;
+	}
 
-		pResult->Init(nOffset);
-	
-		return pResult;
+	SChunk *pResult = m_pChunks;
+	m_pChunks = pResult->m_pNext;
+	m_nChunks.store(nChunks - 1, std::memory_order_relaxed);
+	return pResult;
+}
+
+void CPacket_Data::SThreadCache::Free_Chunks(SChunk *pHead, SChunk *pTail, uint32 nCount)
+{
+	pTail->m_pNext = m_pChunks;
+	m_pChunks = pHead;
+	uint32 nChunks = m_nChunks.load(std::memory_order_relaxed) + nCount;
+
+	// Hand the extras over in batches
+	while (nChunks > k_nMaxChunks)
+	{
+		SChunk *pBatchTail = FindTail(m_pChunks, k_nChunkReleaseBatch);
+		SChunk *pRemaining = pBatchTail->m_pNext;
+		s_cSharedChunks.Push(m_pChunks, pBatchTail, k_nChunkReleaseBatch);
+		m_pChunks = pRemaining;
+		nChunks -= k_nChunkReleaseBatch;
 	}
-	else
+
+	m_nChunks.store(nChunks, std::memory_order_relaxed);
+}
+
+CPacket_Data *CPacket_Data::SThreadCache::Allocate_Data()
+{
+	if (!m_nData)
 	{
-		g_cPacket_CS_Tracking.Lock();
-		++s_nAllocatedChunks;
-		g_cPacket_CS_Tracking.Unlock();
-		
-		g_cPacket_CS_Trash.Unlock();
-
-		SChunk* pNewChunk;
-		LT_MEM_TRACK_ALLOC(pNewChunk = new SChunk(nOffset), LT_MEM_TYPE_NETWORKING);
-		return pNewChunk;
+		m_pData = s_cSharedData.TakeAll(&m_nData);
+		if (!m_nData)
+			return 0;
 	}
+
+	CPacket_Data *pResult = m_pData;
+	m_pData = GetNext(pResult);
+	--m_nData;
+	return pResult;
 }
 
-// Dump the chunk onto the free chunk list
-void CPacket_Data::Free_Chunk(SChunk *pChunk)
+void CPacket_Data::SThreadCache::Free_Data(CPacket_Data *pData)
 {
-	g_cPacket_CS_Trash.Lock();
+	SetNext(pData, m_pData);
+	m_pData = pData;
+	++m_nData;
 
-	g_cPacket_CS_Tracking.Lock();
-	ASSERT(s_nActiveChunks);
-	--s_nActiveChunks;
-	g_cPacket_CS_Tracking.Unlock();
+	if (m_nData > k_nMaxData)
+	{
+		CPacket_Data *pBatchTail = FindTail(m_pData, k_nDataReleaseBatch);
+		CPacket_Data *pRemaining = GetNext(pBatchTail);
+		s_cSharedData.Push(m_pData, pBatchTail, k_nDataReleaseBatch);
+		m_pData = pRemaining;
+		m_nData -= k_nDataReleaseBatch;
+	}
+}
 
-	pChunk->m_pNext = s_cTrash_Chunk.m_pFirstChunk;
-	s_cTrash_Chunk.m_pFirstChunk = pChunk;
+CPacket_Data::SThreadCache *CPacket_Data::GetThreadCache()
+{
+	if (s_bThreadCacheGone)
+		return 0;
 
-	g_cPacket_CS_Trash.Unlock();
+	static thread_local SThreadCache s_cCache;
+	return &s_cCache;
 }
 
-CPacket_Data* CPacket_Data::Allocate()
+// Gimmie some chunk, baby...
+CPacket_Data::SChunk *CPacket_Data::Allocate_Chunk(uint32 nOffset)
 {
-	// Insert packet tracking here
-	// NYI
-	g_cPacket_CS_Tracking.Lock();
-	++s_nActivePackets;
-	g_cPacket_CS_Tracking.Unlock();
+	s_nActiveChunks.fetch_add(1, std::memory_order_relaxed);
 
-	g_cPacket_CS_Trash.Lock();
+	SThreadCache *pCache = GetThreadCache();
+	SChunk *pResult = pCache ? pCache->Allocate_Chunk() : 0;
+	if (pResult)
+	{
+		pResult->Init(nOffset);
+		return pResult;
+	}
+
+	s_nAllocatedChunks.fetch_add(1, std::memory_order_relaxed);
+
+	LT_MEM_TRACK_ALLOC(pResult = new SChunk(nOffset), LT_MEM_TYPE_NETWORKING);
+	return pResult;
+}
 
-	CPacket_Data *pResult;
-	if (s_pTrash_Data)
+// Dump the chunks onto the free chunk list
+void CPacket_Data::Free_Chunks(SChunk *pHead)
+{
+	uint32 nCount = 1;
+	SChunk *pTail = pHead;
+	while (pTail->m_pNext)
 	{
-		pResult = s_pTrash_Data;
-		s_pTrash_Data = (CPacket_Data*)s_pTrash_Data->m_pFirstChunk;
-	    pResult->Init();
+		pTail = pTail->m_pNext;
+		++nCount;
 	}
+
+	ASSERT(s_nActiveChunks.load(std::memory_order_relaxed) >= nCount);
+	s_nActiveChunks.fetch_sub(nCount, std::memory_order_relaxed);
+
+	SThreadCache *pCache = GetThreadCache();
+	if (pCache)
+		pCache->Free_Chunks(pHead, pTail, nCount);
 	else
-	{
-		g_cPacket_CS_Tracking.Lock();
-		++s_nAllocatedPackets;
-		g_cPacket_CS_Tracking.Unlock();
+		SThreadCache::s_cSharedChunks.Push(pHead, pTail, nCount);
+}
 
-		LT_MEM_TRACK_ALLOC(pResult = new CPacket_Data, LT_MEM_TYPE_NETWORKING);
+CPacket_Data* CPacket_Data::Allocate()
+{
+	s_nActivePackets.fetch_add(1, std::memory_order_relaxed);
+
+	SThreadCache *pCache = GetThreadCache();
+	CPacket_Data *pResult = pCache ? pCache->Allocate_Data() : 0;
+	if (pResult)
+	{
+		pResult->Init();
+		return pResult;
 	}
 
-	g_cPacket_CS_Trash.Unlock();
+	s_nAllocatedPackets.fetch_add(1, std::memory_order_relaxed);
 
+	LT_MEM_TRACK_ALLOC(pResult = new CPacket_Data, LT_MEM_TYPE_NETWORKING);
 	return pResult;
 }
 
 void CPacket_Data::Free()
 {
-	g_cPacket_CS_Tracking.Lock();
+	ASSERT(s_nActivePackets.load(std::memory_order_relaxed));
+	s_nActivePackets.fetch_sub(1, std::memory_order_relaxed);
 
-	// Insert packet tracking here
-	// NYI
-	ASSERT(s_nActivePackets);
-	--s_nActivePackets;
+	// Dump our chunks, all at once
+	if (m_pFirstChunk)
+		Free_Chunks(m_pFirstChunk);
 
-	g_cPacket_CS_Tracking.Unlock();
+	// Put ourselves in the trash list
+	SThreadCache *pCache = GetThreadCache();
+	if (pCache)
+		pCache->Free_Data(this);
+	else
+		SThreadCache::s_cSharedData.Push(this, this, 1);
+}
 
-	// Dump our chunks
-	while (m_pFirstChunk)
+void CPacket_Data::GetAllocStats(SAllocStats *pStats)
+{
+	pStats->m_nAllocatedChunks = s_nAllocatedChunks.load(std::memory_order_relaxed);
+	pStats->m_nActiveChunks = s_nActiveChunks.load(std::memory_order_relaxed);
+	pStats->m_nAllocatedPackets = s_nAllocatedPackets.load(std::memory_order_relaxed);
+	pStats->m_nActivePackets = s_nActivePackets.load(std::memory_order_relaxed);
+	pStats->m_nSharedChunks = SThreadCache::s_cSharedChunks.GetCount();
+
+	pStats->m_nThreadCaches = 0;
+	pStats->m_nThreadCachedChunks = 0;
+	pStats->m_nMaxThreadCachedChunks = 0;
+
+	std::lock_guard<std::mutex> cLock(SThreadCache::s_cCacheListMutex);
+	for (SThreadCache *pCur = SThreadCache::s_pCacheList; pCur; pCur = pCur->m_pNextCache)
 	{
-		SChunk *pTemp = m_pFirstChunk;
-		m_pFirstChunk = m_pFirstChunk->m_pNext;
-		Free_Chunk(pTemp);
+		uint32 nChunks = pCur->m_nChunks.load(std::memory_order_relaxed);
+		++pStats->m_nThreadCaches;
+		pStats->m_nThreadCachedChunks += nChunks;
+		pStats->m_nMaxThreadCachedChunks = LTMAX(pStats->m_nMaxThreadCachedChunks, nChunks);
 	}
-
-	g_cPacket_CS_Trash.Lock();
-
-	// Put ourselves in the trash list
-	m_pFirstChunk = (SChunk*)s_pTrash_Data;
-	s_pTrash_Data = this;
-
-	g_cPacket_CS_Trash.Unlock();
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -4,6 +4,8 @@
 
 #include "ltbasetypes.h"
 
+#include <atomic>
+
 // forward declarations
 class CPacket_Read;
 class CPacket_Write;
@@ -52,9 +54,21 @@ public:
 	static CPacket_Data *Allocate();
 
 	// Reference counting...
-	void IncRef() const { InterlockedIncrement(( long* )&m_nRefCount ); }
-	void DecRef() const { if (!InterlockedDecrement(( long* )&m_nRefCount )) const_cast<CPacket_Data*>(this)->Free(); }
-	uint32 GetRefCount() const { return m_nRefCount; }
+	void IncRef() const { m_nRefCount.fetch_add(1, std::memory_order_relaxed); }
+	void DecRef() const { if (m_nRefCount.fetch_sub(1, std::memory_order_acq_rel) == 1) const_cast<CPacket_Data*>(this)->Free(); }
+	uint32 GetRefCount() const { return m_nRefCount.load(std::memory_order_relaxed); }
+
+	// Allocation statistics
+	struct SAllocStats
+	{
+		uint32 m_nAllocatedChunks, m_nActiveChunks;
+		uint32 m_nAllocatedPackets, m_nActivePackets;
+		// Free chunks sitting in the shared list
+		uint32 m_nSharedChunks;
+		// Free chunks held by the per-thread caches
+		uint32 m_nThreadCaches, m_nThreadCachedChunks, m_nMaxThreadCachedChunks;
+	};
+	static void GetAllocStats(SAllocStats *pStats);
 
 	bool Append(uint32 nData, uint32 nBits) {
 		// We're never supposed to append after an unaligned append
@@ -296,18 +310,20 @@ private:
 	SChunk *m_pFirstChunk, *m_pLastChunk;
 
 	// How many people know about me?
-	mutable uint32 m_nRefCount;
+	mutable std::atomic<uint32> m_nRefCount;
 	// Size of the data
 	uint32 m_nSize;
 
 	// Allocate a new chunk
 	static SChunk *Allocate_Chunk(uint32 nOffset = 0);
-	// Free a chunk
-	static void Free_Chunk(SChunk *pChunk);
-	// Static storage for dead chunks
-	static CPacket_Data s_cTrash_Chunk;
-	// Static storage for dead data
-	static CPacket_Data *s_pTrash_Data;
+	// Free a list of chunks
+	static void Free_Chunks(SChunk *pHead);
+
+	// Per-thread storage for dead chunks and data
+	struct SThreadCache;
+	friend struct SThreadCache;
+	// Returns 0 once the thread is shutting down
+	static SThreadCache *GetThreadCache();
 };
 
 
@@ -0,0 +1,306 @@
+// *********************************************************************** //
+//
+// MODULE  : udpbatch.cpp
+//
+// PURPOSE : Batched socket I/O for the UDP driver on Linux.
+//
+// *********************************************************************** //
+
+#include "bdefs.h"
+#include "udpbatch.h"
+
+#ifdef UDP_BATCHED_IO
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+extern int32 g_CV_UDPDebug;
+
+
+//////////////////////////////////////////////////////////////////////////////
+// CUDPRecvBatch implementation
+
+CUDPRecvBatch::CUDPRecvBatch() :
+	m_hSocket(INVALID_SOCKET),
+	m_hEpoll(-1),
+	m_hWakeEvent(-1),
+	m_pBuffers(LTNULL)
+{
+}
+
+CUDPRecvBatch::~CUDPRecvBatch()
+{
+	Term();
+}
+
+bool CUDPRecvBatch::Init(SOCKET hSocket)
+{
+	Term();
+
+	m_hEpoll = ::epoll_create1(EPOLL_CLOEXEC);
+	m_hWakeEvent = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if ((m_hEpoll == -1) || (m_hWakeEvent == -1))
+	{
+		dsi_ConsolePrint("UDP: Unable to create epoll set (error %d)", errno);
+		Term();
+		return false;
+	}
+
+	epoll_event cEvent;
+	cEvent.events = EPOLLIN;
+	cEvent.data.fd = hSocket;
+	if (::epoll_ctl(m_hEpoll, EPOLL_CTL_ADD, hSocket, &cEvent) != 0)
+	{
+		dsi_ConsolePrint("UDP: Unable to add socket to epoll set (error %d)", errno);
+		Term();
+		return false;
+	}
+
+	cEvent.events = EPOLLIN;
+	cEvent.data.fd = m_hWakeEvent;
+	::epoll_ctl(m_hEpoll, EPOLL_CTL_ADD, m_hWakeEvent, &cEvent);
+
+	m_hSocket = hSocket;
+
+	if (!m_pBuffers)
+	{
+		LT_MEM_TRACK_ALLOC(m_pBuffers = new uint8[k_nMaxPackets * k_nMaxPacketSize + sizeof(uint32)], LT_MEM_TYPE_NETWORKING);
+	}
+
+	return true;
+}
+
+void CUDPRecvBatch::Term()
+{
+	if (m_hEpoll != -1)
+	{
+		::close(m_hEpoll);
+		m_hEpoll = -1;
+	}
+
+	if (m_hWakeEvent != -1)
+	{
+		::close(m_hWakeEvent);
+		m_hWakeEvent = -1;
+	}
+
+	delete [] m_pBuffers;
+	m_pBuffers = LTNULL;
+
+	m_hSocket = INVALID_SOCKET;
+}
+
+int CUDPRecvBatch::Wait(uint32 nTimeoutMS)
+{
+	epoll_event aEvents[2];
+	int nEvents = ::epoll_wait(m_hEpoll, aEvents, 2, (int)nTimeoutMS);
+	if (nEvents < 0)
+	{
+		// A signal isn't an error, just an early wakeup
+		return (errno == EINTR) ? 0 : SOCKET_ERROR;
+	}
+
+	int nResult = 0;
+	for (int nCurEvent = 0; nCurEvent < nEvents; ++nCurEvent)
+	{
+		if (aEvents[nCurEvent].data.fd == m_hWakeEvent)
+		{
+			uint64_t nValue;
+			ssize_t nRead = ::read(m_hWakeEvent, &nValue, sizeof(nValue));
+			(void)nRead;
+		}
+		else
+		{
+			nResult = 1;
+		}
+	}
+
+	return nResult;
+}
+
+void CUDPRecvBatch::Wake()
+{
+	if (m_hWakeEvent == -1)
+		return;
+
+	uint64_t nValue = 1;
+	ssize_t nWritten = ::write(m_hWakeEvent, &nValue, sizeof(nValue));
+	(void)nWritten;
+}
+
+int CUDPRecvBatch::Recv()
+{
+	for (uint32 nCurMsg = 0; nCurMsg < k_nMaxPackets; ++nCurMsg)
+	{
+		m_aIOVecs[nCurMsg].iov_base = &m_pBuffers[nCurMsg * k_nMaxPacketSize];
+		m_aIOVecs[nCurMsg].iov_len = k_nMaxPacketSize;
+
+		msghdr &cHeader = m_aMsgs[nCurMsg].msg_hdr;
+		cHeader.msg_name = &m_aSenders[nCurMsg];
+		cHeader.msg_namelen = sizeof(sockaddr_in);
+		cHeader.msg_iov = &m_aIOVecs[nCurMsg];
+		cHeader.msg_iovlen = 1;
+		cHeader.msg_control = LTNULL;
+		cHeader.msg_controllen = 0;
+		cHeader.msg_flags = 0;
+		m_aMsgs[nCurMsg].msg_len = 0;
+	}
+
+	int nResult = ::recvmmsg(m_hSocket, m_aMsgs, k_nMaxPackets, MSG_DONTWAIT, LTNULL);
+	if ((nResult == SOCKET_ERROR) && (errno != EWOULDBLOCK) && (g_CV_UDPDebug > 1))
+	{
+		dsi_ConsolePrint("UDP: recvmmsg returned error %d", errno);
+	}
+
+	return nResult;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// Send batching
+
+namespace
+{
+	// One thread's queue of outgoing datagrams
+	struct CUDPSendQueue
+	{
+		enum {
+			k_nMaxPackets = 64,
+			// Bigger than any frame the connections build, padded for
+			// CPacket_Read::ReadDataRaw rounding up to a whole uint32
+			k_nMaxPacketSize = 2048
+		};
+
+		CUDPSendQueue() :
+			m_nDepth(0),
+			m_nCount(0),
+			m_hSocket(INVALID_SOCKET),
+			m_pBuffers(LTNULL)
+		{
+		}
+
+		~CUDPSendQueue()
+		{
+			delete [] m_pBuffers;
+		}
+
+		void Flush();
+
+		uint32 m_nDepth;
+		uint32 m_nCount;
+		SOCKET m_hSocket;
+		uint8 *m_pBuffers;
+		mmsghdr m_aMsgs[k_nMaxPackets];
+		iovec m_aIOVecs[k_nMaxPackets];
+		sockaddr_in m_aDests[k_nMaxPackets];
+	};
+
+	thread_local CUDPSendQueue g_cSendQueue;
+}
+
+void CUDPSendQueue::Flush()
+{
+	uint32 nSent = 0;
+	while (nSent < m_nCount)
+	{
+		int nResult = ::sendmmsg(m_hSocket, &m_aMsgs[nSent], m_nCount - nSent, 0);
+		if (nResult == SOCKET_ERROR)
+		{
+			if (errno == EINTR)
+				continue;
+
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == ENOBUFS))
+			{
+				// The socket's backed up.  It's UDP, so whatever is left
+				// gets dropped like it would have been by sendto.
+				if (g_CV_UDPDebug > 1)
+				{
+					dsi_ConsolePrint("UDP: sendmmsg returned error %d (%d packets dropped)", errno, m_nCount - nSent);
+				}
+				break;
+			}
+
+			// sendmmsg only fails outright on the first datagram, and anything
+			// else (refused, unreachable, bad address) is down to where that
+			// one was going.  Drop it and carry on with the rest, which may be
+			// for other clients.
+			if (g_CV_UDPDebug > 1)
+			{
+				dsi_ConsolePrint("UDP: sendmmsg returned error %d (1 packet dropped)", errno);
+			}
+			++nSent;
+			continue;
+		}
+
+		nSent += (uint32)nResult;
+	}
+
+	m_nCount = 0;
+}
+
+void udp_BeginSendBatch()
+{
+	++g_cSendQueue.m_nDepth;
+}
+
+void udp_EndSendBatch()
+{
+	ASSERT(g_cSendQueue.m_nDepth);
+	if (--g_cSendQueue.m_nDepth == 0)
+	{
+		udp_FlushSendBatch();
+	}
+}
+
+void udp_FlushSendBatch()
+{
+	if (g_cSendQueue.m_nCount)
+	{
+		g_cSendQueue.Flush();
+	}
+}
+
+uint8 *udp_QueueSend(SOCKET theSocket, uint32 nDataLen, const sockaddr_in *pSendTo)
+{
+	CUDPSendQueue &cQueue = g_cSendQueue;
+
+	if (!cQueue.m_nDepth || (((nDataLen + 3) & ~3) > CUDPSendQueue::k_nMaxPacketSize))
+	{
+		// Keep things in order if this one's going out on its own
+		udp_FlushSendBatch();
+		return LTNULL;
+	}
+
+	if ((cQueue.m_nCount == CUDPSendQueue::k_nMaxPackets) || (cQueue.m_nCount && (cQueue.m_hSocket != theSocket)))
+	{
+		cQueue.Flush();
+	}
+
+	if (!cQueue.m_pBuffers)
+	{
+		LT_MEM_TRACK_ALLOC(cQueue.m_pBuffers = new uint8[CUDPSendQueue::k_nMaxPackets * CUDPSendQueue::k_nMaxPacketSize], LT_MEM_TYPE_NETWORKING);
+	}
+
+	uint32 nIndex = cQueue.m_nCount++;
+	uint8 *pBuffer = &cQueue.m_pBuffers[nIndex * CUDPSendQueue::k_nMaxPacketSize];
+
+	cQueue.m_hSocket = theSocket;
+	cQueue.m_aDests[nIndex] = *pSendTo;
+	cQueue.m_aIOVecs[nIndex].iov_base = pBuffer;
+	cQueue.m_aIOVecs[nIndex].iov_len = nDataLen;
+
+	msghdr &cHeader = cQueue.m_aMsgs[nIndex].msg_hdr;
+	cHeader.msg_name = &cQueue.m_aDests[nIndex];
+	cHeader.msg_namelen = sizeof(sockaddr_in);
+	cHeader.msg_iov = &cQueue.m_aIOVecs[nIndex];
+	cHeader.msg_iovlen = 1;
+	cHeader.msg_control = LTNULL;
+	cHeader.msg_controllen = 0;
+	cHeader.msg_flags = 0;
+	cQueue.m_aMsgs[nIndex].msg_len = 0;
+
+	return pBuffer;
+}
+
+#endif // UDP_BATCHED_IO
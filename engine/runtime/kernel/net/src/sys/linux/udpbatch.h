@@ -0,0 +1,110 @@
+// *********************************************************************** //
+//
+// MODULE  : udpbatch.h
+//
+// PURPOSE : Batched socket I/O for the UDP driver on Linux.
+//
+// *********************************************************************** //
+
+// On Linux the UDP driver's listen thread waits on its socket with epoll and
+// pulls everything that's waiting off the socket with a single recvmmsg.
+// Datagrams sent from a thread while it has a send batch open are queued up
+// and go out together through sendmmsg when the batch is closed.
+//
+// Everywhere else (Windows, macOS) the batch calls compile away and the
+// driver does one recvfrom/sendto per datagram.
+
+#ifndef __UDPBATCH_H__
+#define __UDPBATCH_H__
+
+#ifndef __LTBASETYPES_H__
+#include "ltbasetypes.h"
+#endif
+
+#ifndef __SYSSOCKET_H__
+#include "syssocket.h"
+#endif
+
+#if defined(__linux__)
+#define UDP_BATCHED_IO
+#endif
+
+
+#ifdef UDP_BATCHED_IO
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+class CUDPRecvBatch
+{
+public:
+	enum {
+		k_nMaxPackets = 64,
+		k_nMaxPacketSize = 8192
+	};
+
+	CUDPRecvBatch();
+	~CUDPRecvBatch();
+
+	// Set up the epoll set for the socket
+	bool Init(SOCKET hSocket);
+	void Term();
+	bool IsInitted() const { return m_hEpoll != -1; }
+
+	// Wait for the socket to become readable.  Returns 1 if it's readable, 0 on
+	// a timeout or a call to Wake, and SOCKET_ERROR if something went wrong.
+	int Wait(uint32 nTimeoutMS);
+
+	// Release a thread blocked in Wait.  Can be called from any thread.
+	void Wake();
+
+	// Read everything that's waiting, up to k_nMaxPackets datagrams.  Returns
+	// the number read, or SOCKET_ERROR with the error in errno (EWOULDBLOCK if
+	// there was nothing to read).
+	int Recv();
+
+	const uint8 *GetData(uint32 nIndex) const { return &m_pBuffers[nIndex * k_nMaxPacketSize]; }
+	uint32 GetSize(uint32 nIndex) const { return m_aMsgs[nIndex].msg_len; }
+	sockaddr_in *GetSender(uint32 nIndex) { return &m_aSenders[nIndex]; }
+
+private:
+	SOCKET m_hSocket;
+	int m_hEpoll;
+	int m_hWakeEvent;
+
+	uint8 *m_pBuffers;
+	mmsghdr m_aMsgs[k_nMaxPackets];
+	iovec m_aIOVecs[k_nMaxPackets];
+	sockaddr_in m_aSenders[k_nMaxPackets];
+};
+
+// Open a send batch on this thread.  Batches nest, and only the outermost
+// udp_EndSendBatch sends what was queued.
+void udp_BeginSendBatch();
+void udp_EndSendBatch();
+
+// Send anything queued on this thread now, leaving the batch open.
+void udp_FlushSendBatch();
+
+// Returns a buffer to write the datagram into if the thread has a send batch
+// open and there's room for it, or LTNULL if it should be sent directly.
+uint8 *udp_QueueSend(SOCKET theSocket, uint32 nDataLen, const sockaddr_in *pSendTo);
+
+#else
+
+inline void udp_BeginSendBatch() {}
+inline void udp_EndSendBatch() {}
+inline void udp_FlushSendBatch() {}
+
+#endif // UDP_BATCHED_IO
+
+
+// Keeps a send batch open for the life of the object.
+class CUDPAutoSendBatch
+{
+public:
+	CUDPAutoSendBatch() { udp_BeginSendBatch(); }
+	~CUDPAutoSendBatch() { udp_EndSendBatch(); }
+};
+
+#endif // __UDPBATCH_H__
@@ -56,9 +56,9 @@ extern int32 g_CV_BandwidthTargetClient;
 //////////////////////////////////////////////////////////////////////////////
 // CUDPConn implementation
 
-CUDPConn::CPacketQueue CUDPConn::s_cPacketTrash;
-CUDPConn::CTimeQueue CUDPConn::s_cTimeTrash;
-CUDPConn::CFrameQueue CUDPConn::s_cFrameTrash;
+thread_local CUDPConn::CPacketQueue CUDPConn::s_cPacketTrash;
+thread_local CUDPConn::CTimeQueue CUDPConn::s_cTimeTrash;
+thread_local CUDPConn::CFrameQueue CUDPConn::s_cFrameTrash;
 
 CUDPConn::CUDPConn() :
 	m_Socket(INVALID_SOCKET),
@@ -1085,6 +1085,9 @@ void CUDPConn::SendDisconnectMessage( EDisconnectReason eDisconnectReason )
 		// Make sure they don't get blocked...
 		if (i != 0)
 		{
+			// Don't let the sleep get batched up with the sends
+			udp_FlushSendBatch();
+
 #ifdef __LINUX
 			::usleep(k_nDisconnectSleep * 1000);
 
@@ -1922,6 +1925,7 @@ void CUDPDriver::Term2(bool bFullShutdown, bool bShutdownSocket )
 	// Close down any connections.
 	m_cCS_Connections.Enter();
 	MDeleteAndRemoveElements(m_Connections);
+	m_cConnectionsByAddr.clear();
 	m_cCS_Connections.Leave();
 
 	if ( bShutdownSocket )
@@ -1986,7 +1990,14 @@ bool CUDPDriver::SendTo(SOCKET theSocket, const CPacket_Read &cPacket, sockaddr_
 	CPacket_Read cReadPacket(cPacket);
 	cReadPacket.SeekTo(0);
 	int nDataLen = (cReadPacket.Size() + 7) / 8;
-	uint8 *aSendBuffer = (uint8 *)alloca(nDataLen);
+	uint8 *aSendBuffer = LTNULL;
+#ifdef UDP_BATCHED_IO
+	// Write it straight into this thread's send batch if it has one
+	aSendBuffer = udp_QueueSend(theSocket, nDataLen, pSendTo);
+	bool bQueued = (aSendBuffer != LTNULL);
+	if (!bQueued)
+#endif
+	aSendBuffer = (uint8 *)alloca((nDataLen + 3) & ~3);
 //	cReadPacket.ReadData(aSendBuffer, nDataLen * 8);
 	cReadPacket.ReadDataRaw( aSendBuffer, nDataLen );
 
@@ -2003,6 +2014,11 @@ bool CUDPDriver::SendTo(SOCKET theSocket, const CPacket_Read &cPacket, sockaddr_
 		}
 	}
 
+#ifdef UDP_BATCHED_IO
+	if (bQueued)
+		return true;
+#endif
+
 	status = sendto(theSocket, (char*)aSendBuffer, nDataLen,
 		0, (sockaddr*)pSendTo, sizeof(*pSendTo));
 
@@ -2014,20 +2030,46 @@ CUDPConn* CUDPDriver::FindConnByAddr(sockaddr_in *pAddr)
 {
 	CSAccess cConnProtect(&m_cCS_Connections);
 
-	MPOS pos;
-	CUDPConn *pConn;
+	TConnAddrMap::const_iterator iConn = m_cConnectionsByAddr.find(GetConnAddrKey(*pAddr));
+	if (iConn == m_cConnectionsByAddr.end())
+		return LTNULL;
 
-	for(pos=m_Connections; pos; )
+	return iConn->second;
+}
+
+
+void CUDPDriver::AddConnection(CUDPConn *pConn)
+{
+	m_Connections.AddHead(pConn, &pConn->m_Node);
+	LT_MEM_TRACK_ALLOC(m_cConnectionsByAddr[GetConnAddrKey(pConn->m_RemoteAddr)] = pConn, LT_MEM_TYPE_NETWORKING);
+}
+
+
+void CUDPDriver::RemoveConnection(CUDPConn *pConn)
+{
+	m_Connections.RemoveAt(&pConn->m_Node);
+
+	// Leave the index alone if it's pointing at another connection from the
+	// same address
+	uint64 nKey = GetConnAddrKey(pConn->m_RemoteAddr);
+	TConnAddrMap::iterator iConn = m_cConnectionsByAddr.find(nKey);
+	if ((iConn == m_cConnectionsByAddr.end()) || (iConn->second != pConn))
+		return;
+
+	// Hand the entry on to the newest remaining connection from the address,
+	// which is the one a walk of the list would have found, or drop it
+	MPOS pCurPos = m_Connections.GetHeadPosition();
+	while (pCurPos)
 	{
-		pConn = m_Connections.GetNext(pos);
-		
-		if(pConn->m_RemoteAddr.sin_port == pAddr->sin_port &&
-			pConn->m_RemoteAddr.sin_addr.s_addr == pAddr->sin_addr.s_addr)
+		CUDPConn *pCurConn = m_Connections.GetNext(pCurPos);
+		if (GetConnAddrKey(pCurConn->m_RemoteAddr) == nKey)
 		{
-			return pConn;
+			iConn->second = pCurConn;
+			return;
 		}
 	}
-	return LTNULL;
+
+	m_cConnectionsByAddr.erase(iConn);
 }
 
 LTRESULT CUDPDriver::GetServiceList(NetService* &pListHead)
@@ -2504,6 +2546,9 @@ void CUDPDriver::Update()
 {
 	CSAccess cConnProtect(&m_cCS_Connections);
 
+	// Everything the connections flush goes out together
+	CUDPAutoSendBatch cSendBatch;
+
 	FlushInternalQueues();
 
 	// Update the connections
@@ -2542,7 +2587,7 @@ void CUDPDriver::Disconnect(CBaseConn *id, EDisconnectReason reason, bool bSendM
 	if (bSendMessage)
 		pConn->SendDisconnectMessage( reason );
 
-	m_Connections.RemoveAt(&pConn->m_Node);
+	RemoveConnection(pConn);
 	delete pConn;
 }
 
@@ -2719,7 +2764,7 @@ void CUDPDriver::HandleUnconnectedData(CPacket_Read &cPacket, sockaddr_in *pSend
 				
 				// Add them to our connection list
 				m_cCS_Connections.Enter();
-				m_Connections.AddHead(pConn, &pConn->m_Node);
+				AddConnection(pConn);
 				m_cCS_Connections.Leave();
 
 				// Add it to the connection queue
@@ -3099,7 +3144,7 @@ bool CUDPDriver::GetLocalIpAddress(char* sBuffer, uint32 dwBufferSize, uint16 &h
 		
 		if(m_pNetMgr->NewConnectionNotify(pConn))
 		{
-			m_Connections.AddHead(pConn, &pConn->m_Node);
+			AddConnection(pConn);
 			m_Socket = theSocket;
 			StartThread_Listen();
 
@@ -3158,6 +3203,9 @@ LTRESULT CUDPDriver::ReallyJoinSession( bool bOpenNewSocket, sockaddr_in *addr )
 
 	// Tell the listen thread to pause.
 	m_hEvent_Thread_Listen_Pause.Set( );
+#ifdef UDP_BATCHED_IO
+	m_cRecvBatch.Wake();
+#endif
 	
 // temporarily compiled out of all but Win32 builds (this will change soon)
 //#ifdef _WIN32
@@ -3289,7 +3337,9 @@ LTRESULT CUDPDriver::ReallyJoinSession( bool bOpenNewSocket, sockaddr_in *addr )
 		
 		if(m_pNetMgr->NewConnectionNotify(pConn))
 		{
-			m_Connections.AddHead(pConn, &pConn->m_Node);
+			m_cCS_Connections.Enter();
+			AddConnection(pConn);
+			m_cCS_Connections.Leave();
 
 			if(g_CV_UDPDebug)
 			{
@@ -3707,6 +3757,11 @@ void CUDPDriver::StartThread_Listen()
 
 	ASSERT(m_Socket != INVALID_SOCKET);
 
+#ifdef UDP_BATCHED_IO
+	// Falls back to the select loop if epoll isn't available
+	m_cRecvBatch.Init(m_Socket);
+#endif
+
 	m_cListenThread.Create(&ThreadBootstrap_Listen, (void*) this);
 	m_cEvent_Thread_Listen_Ready.Block();
 }
@@ -3716,6 +3771,11 @@ void CUDPDriver::StopThread_Listen()
 	// Signal the shutdown
 	m_hEvent_Thread_Listen_Shutdown.Set();
 
+#ifdef UDP_BATCHED_IO
+	// Closing the socket doesn't release epoll_wait
+	m_cRecvBatch.Wake();
+#endif
+
 	// Closing the socket is the only way to release the thread...  :(
 	if( m_Socket != INVALID_SOCKET )
 	{
@@ -3732,6 +3792,10 @@ void CUDPDriver::StopThread_Listen()
 	{	
 		m_cListenThread.WaitForExit();
 	}
+
+#ifdef UDP_BATCHED_IO
+	m_cRecvBatch.Term();
+#endif
 	
 	// Clean up
 	m_hEvent_Thread_Listen_Shutdown.Clear();
@@ -3746,8 +3810,111 @@ uint32 CUDPDriver::ThreadBootstrap_Listen(void *pUserData)
 	return (unsigned long)pDriver->Thread_Listen();
 }
 
+bool CUDPDriver::Thread_Listen_Pause()
+{
+	// Clear the pause event.
+	m_hEvent_Thread_Listen_Pause.Clear( );
+
+	// Tell main thread we're paused.
+	m_hEvent_Thread_Listen_Paused.Set( );
+
+// temporarily compiled out of all but Win32 builds (this will change soon)
+//#ifdef _WIN32
+//	// Stop here until we're told to shutdown or resume.
+//	HANDLE aEvents[] = { m_hEvent_Thread_Listen_Shutdown.GetEvent( ), m_hEvent_Thread_Listen_Pause.GetEvent( )};
+//	if( WaitForMultipleObjects( 2, aEvents, FALSE, INFINITE ) == WAIT_OBJECT_0 )
+//	{
+		// Break out of the loop if told to shutdown.
+//		break;
+//	}
+//#endif
+
+	// Stop here until we need to shutdown or resume
+	while ( 1 )
+	{
+		// listen thread shutdown 
+		if ( m_hEvent_Thread_Listen_Shutdown.IsSet() )
+		{
+			return false;
+		}
+
+		// thread is paused 
+		if ( m_hEvent_Thread_Listen_Pause.IsSet() )
+		{
+			break; 
+		}
+
+		// give others threads a break
+#ifdef __LINUX
+		::sched_yield();
+#else
+		Sleep(10);
+#endif
+	}
+
+	// Done with the pause.
+	m_hEvent_Thread_Listen_Paused.Clear( );
+	m_hEvent_Thread_Listen_Pause.Clear( );
+
+	return true;
+}
+
+void CUDPDriver::Thread_Listen_HandlePacket(CPacket_Read &cIncomingPacket, sockaddr_in *pSender)
+{
+	if (cIncomingPacket.Peekuint32() == UNCONNECTED_DATA_TOKEN)
+	{
+		// Parse the unconnected data packet
+		HandleUnconnectedData(cIncomingPacket, pSender);
+	}
+	else 
+	{
+		CSAccess cConnProtect(&m_cCS_Connections);
+
+		// Look up the sender
+		CUDPConn *pConn = FindConnByAddr(pSender);
+
+		if (pConn)
+		{
+			// Handle the packet
+			CUDPConn::EIncomingPacketResult eResult;
+			eResult = pConn->HandleIncomingPacket(cIncomingPacket);
+			if (eResult == CUDPConn::eIPR_Disconnect)
+			{
+				// Handle a disconnection the next time we update
+				CDisconnectRequest cRequest;
+				cRequest.m_pConnection = pConn;
+				cRequest.m_eReason = pConn->GetLastDisconnectReason( );
+
+				CSAccess cDisconnectProtect(&m_cCS_DisconnectQueue);
+				LT_MEM_TRACK_ALLOC(m_cDisconnectQueue.push_back(cRequest), LT_MEM_TYPE_NETWORKING);
+			}
+			else
+			{
+				// Give them an update, just to keep things running as smoothly as possible
+				pConn->Update(false);
+			}
+		}
+		else
+		{
+			CUnknownMessage cMsg;
+			cMsg.m_cPacket = cIncomingPacket;
+			cMsg.m_cSender = *pSender;
+			// Handle an unknown message the next time we update
+			CSAccess cUnknownMessageProtect(&m_cCS_UnknownMessages);
+			LT_MEM_TRACK_ALLOC(m_cUnknownMessages.push_back(cMsg), LT_MEM_TYPE_NETWORKING);
+		}
+	}
+}
+
 uint32 CUDPDriver::Thread_Listen()
 {
+#ifdef UDP_BATCHED_IO
+	if (m_cRecvBatch.IsInitted())
+	{
+		return Thread_Listen_Batched();
+	}
+#endif
+
 	uint32 nResult = 0;
 
 	timeval cTimeout;
@@ -3774,58 +3941,9 @@ uint32 CUDPDriver::Thread_Listen()
 			// Check if we need to pause.
 			else if (m_hEvent_Thread_Listen_Pause.IsSet())
 			{
-				// Clear the pause event.
-				m_hEvent_Thread_Listen_Pause.Clear( );
-
-				// Tell main thread we're paused.
-				m_hEvent_Thread_Listen_Paused.Set( );
-
-// temporarily compiled out of all but Win32 builds (this will change soon)
-//#ifdef _WIN32
-//				// Stop here until we're told to shutdown or resume.
-//				HANDLE aEvents[] = { m_hEvent_Thread_Listen_Shutdown.GetEvent( ), m_hEvent_Thread_Listen_Pause.GetEvent( )};
-//				if( WaitForMultipleObjects( 2, aEvents, FALSE, INFINITE ) == WAIT_OBJECT_0 )
-//				{
-					// Break out of the loop if told to shutdown.
-//					break;
-//				}
-//#endif
-				bool bShutdown = false;
-
-				// Stop here until we need to shutdown or resume
-				while ( 1 )
-				{
-					// listen thread shutdown 
-					if ( m_hEvent_Thread_Listen_Shutdown.IsSet() )
-					{
-						bShutdown = true;
-						break; 
-					}
-
-					// thread is paused 
-					if ( m_hEvent_Thread_Listen_Pause.IsSet() )
-					{
-						break; 
-					}
-
-					// give others threads a break
-#ifdef __LINUX
-									::sched_yield();
-#else
-									Sleep(10);
-#endif
-				}
-
 				// we were signaled to shutdown 
-				if ( bShutdown )
+				if (!Thread_Listen_Pause())
 					break;
-
-
-				// Done with the pause.
-				m_hEvent_Thread_Listen_Paused.Clear( );
-				m_hEvent_Thread_Listen_Pause.Clear( );
-
-
 			}
 			// Go to sleep if there's nothing waiting on the line
 			else if (nRecvStatus == EWOULDBLOCK)
@@ -3890,51 +4008,126 @@ uint32 CUDPDriver::Thread_Listen()
 			continue;
 		}
 
-		if (cIncomingPacket.Peekuint32() == UNCONNECTED_DATA_TOKEN)
+		Thread_Listen_HandlePacket(cIncomingPacket, &senderAddr);
+	}
+
+	return nResult;
+}
+
+#ifdef UDP_BATCHED_IO
+
+// Same as Thread_Listen, but waits with epoll and reads everything that's
+// waiting on the socket at once.  Anything sent while handling a batch of
+// incoming packets (acks, mostly) goes out in one batch too.
+uint32 CUDPDriver::Thread_Listen_Batched()
+{
+	uint32 nResult = 0;
+
+	// Ok, we're starting now...
+	m_cEvent_Thread_Listen_Ready.Set();
+
+	// Semi-infinite loop...
+	while (1)
+	{
+		// Jump out if the socket's being shut down
+		if (m_hEvent_Thread_Listen_Shutdown.IsSet())
 		{
-			// Parse the unconnected data packet
-			HandleUnconnectedData(cIncomingPacket, &senderAddr);
+			break;
 		}
-		else 
+
+		// Check if we need to pause.
+		if (m_hEvent_Thread_Listen_Pause.IsSet())
 		{
-			CSAccess cConnProtect(&m_cCS_Connections);
+			// we were signaled to shutdown 
+			if (!Thread_Listen_Pause())
+				break;
+			continue;
+		}
 
-			// Look up the sender
-			CUDPConn *pConn = FindConnByAddr(&senderAddr);
+		// Read whatever's there
+		int nNumPackets = m_cRecvBatch.Recv();
+		if (nNumPackets > 0)
+		{
+			CUDPAutoSendBatch cSendBatch;
 
-			if (pConn)
+			for (int nCurPacket = 0; nCurPacket < nNumPackets; ++nCurPacket)
 			{
-				// Handle the packet
-				CUDPConn::EIncomingPacketResult eResult;
-				eResult = pConn->HandleIncomingPacket(cIncomingPacket);
-				if (eResult == CUDPConn::eIPR_Disconnect)
-				{
-					// Handle a disconnection the next time we update
-					CDisconnectRequest cRequest;
-					cRequest.m_pConnection = pConn;
-					cRequest.m_eReason = pConn->GetLastDisconnectReason( );
-
-					CSAccess cDisconnectProtect(&m_cCS_DisconnectQueue);
-					LT_MEM_TRACK_ALLOC(m_cDisconnectQueue.push_back(cRequest), LT_MEM_TYPE_NETWORKING);
-				}
-				else
+				uint32 nSize = m_cRecvBatch.GetSize(nCurPacket);
+				if (!nSize)
 				{
-					// Give them an update, just to keep things running as smoothly as possible
-					pConn->Update(false);
+					if (g_CV_UDPDebug > 1)
+					{
+						dsi_ConsolePrint("UDP: recvmmsg received a zero-length message");
+					}
+					continue;
 				}
+
+				// Dump it into a packet
+				CPacket_Write cIncomingPacket;
+				cIncomingPacket.WriteDataRaw((void*)m_cRecvBatch.GetData(nCurPacket), nSize);
+				CPacket_Read cIncomingRead(cIncomingPacket);
+
+				Thread_Listen_HandlePacket(cIncomingRead, m_cRecvBatch.GetSender(nCurPacket));
 			}
-			else
+			continue;
+		}
+
+		if (nNumPackets == SOCKET_ERROR)
+		{
+			int nRecvStatus = errno;
+			if (m_hEvent_Thread_Listen_Shutdown.IsSet())
 			{
-				CUnknownMessage cMsg;
-				cMsg.m_cPacket = cIncomingPacket;
-				cMsg.m_cSender = senderAddr;
-				// Handle an unknown message the next time we update
-				CSAccess cUnknownMessageProtect(&m_cCS_UnknownMessages);
-				LT_MEM_TRACK_ALLOC(m_cUnknownMessages.push_back(cMsg), LT_MEM_TYPE_NETWORKING);
+				break;
+			}
+			// Same errors the single packet loop shrugs off
+			if ((nRecvStatus == ECONNRESET) || (nRecvStatus == EMSGSIZE) || (nRecvStatus == EINTR))
+			{
+				continue;
+			}
+			if (nRecvStatus != EWOULDBLOCK)
+			{
+				// Return a non-zero result if there was an error
+				nResult = 1;
+				break;
 			}
 		}
+
+		// Go to sleep until there's something waiting on the line
+		int status = m_cRecvBatch.Wait(k_nListenThread_Timeout);
+		// Did we time out (or get woken up)?
+		if (status == 0)
+		{
+			// Jump out if we're supposed to shut down...
+			if (m_hEvent_Thread_Listen_Shutdown.IsSet())
+				break;
+			// Don't touch the connections if we were woken up to pause
+			if (m_hEvent_Thread_Listen_Pause.IsSet())
+				continue;
+			// Update the connections so they stay alive
+			// Note : This can't use the standard update, because we don't want
+			// to flush anything, and we don't want to disconnect any dead connections.
+			CUDPAutoSendBatch cSendBatch;
+			CSAccess cConnProtection(&m_cCS_Connections);
+			MPOS pCurPos = m_Connections.GetHeadPosition();
+			while (pCurPos)
+			{
+				CUDPConn *pCurConn = m_Connections.GetNext(pCurPos);
+				pCurConn->Update(false);
+			}
+		}
+		// Was there an error?
+		else if (status == SOCKET_ERROR)
+		{
+			if (!m_hEvent_Thread_Listen_Shutdown.IsSet())
+			{
+				dsi_ConsolePrint("UDP Socket error %s!  Shutting down listen thread..", udp_GetLastError());
+				nResult = 1;
+			}
+			break;
+		}
 	}
 
 	return nResult;
 }
 
+#endif // UDP_BATCHED_IO
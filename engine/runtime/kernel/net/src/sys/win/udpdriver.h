@@ -20,11 +20,13 @@
 
 #include "syslthread.h"
 #include "sysudpthread.h"
+#include "sys/linux/udpbatch.h"
 
 #include "listqueue.h"
 #include "staticfifo.h"
 #include <deque>
 #include <map>
+#include <unordered_map>
 
 #define MAX_UDP_QUERY_TIMES 32
 #define BROADCAST_QUERYNUM  0xFF
@@ -289,12 +291,13 @@ private:
 	// Calculate a fingerprint for a packet
 	static uint32 GetPacketFingerprint(const CPacket_Read &cPacket);
 
-	// Incoming packet queuing
-	static CPacketQueue s_cPacketTrash;
+	// Dead list entries, kept per thread since the listen thread and the
+	// main thread work on different connections at the same time
+	static thread_local CPacketQueue s_cPacketTrash;
 
 	// Time queues
 	typedef CListQueue<uint32> CTimeQueue;
-	static CTimeQueue s_cTimeTrash;
+	static thread_local CTimeQueue s_cTimeTrash;
 
 	CPacketQueue m_cIncomingQueue;
 
@@ -327,7 +330,7 @@ private:
 			t_Parent::pop_front(cPool);
 		}
 	};
-	static CFrameQueue s_cFrameTrash;
+	static thread_local CFrameQueue s_cFrameTrash;
 	CFrameQueue m_cFrameHistory;
 
 	uint32 m_aPingHistory[k_nPingHistorySize];
@@ -627,6 +630,14 @@ private:
 	void StopThread_Listen();
 	static uint32 ThreadBootstrap_Listen(void* pUserData);
 	uint32 Thread_Listen();
+	// Returns false if the thread should shut down instead of resuming
+	bool Thread_Listen_Pause();
+	// Hand an incoming packet off to its connection
+	void Thread_Listen_HandlePacket(CPacket_Read &cIncomingPacket, sockaddr_in *pSender);
+#ifdef UDP_BATCHED_IO
+	uint32 Thread_Listen_Batched();
+	CUDPRecvBatch m_cRecvBatch;
+#endif
 	CLTThread m_cListenThread;
 	CLTThreadEvent m_cEvent_Thread_Listen_Ready;
 	CLTThreadEvent m_hEvent_Thread_Listen_Shutdown;
@@ -746,6 +757,20 @@ public:
 	LCriticalSection m_cCS_Connections;
     CMultiLinkList<CUDPConn*> m_Connections;
 
+	// m_Connections indexed by remote address, for FindConnByAddr
+	typedef std::unordered_map<uint64, CUDPConn*> TConnAddrMap;
+	TConnAddrMap m_cConnectionsByAddr;
+
+	static uint64 GetConnAddrKey(const sockaddr_in &cAddr)
+	{
+		return ((uint64)cAddr.sin_addr.s_addr << 16) | (uint64)cAddr.sin_port;
+	}
+
+	// Add/remove a connection from m_Connections and the address index.
+	// m_cCS_Connections must be held.
+	void AddConnection(CUDPConn *pConn);
+	void RemoveConnection(CUDPConn *pConn);
+
     bool m_bWSAInitted;
     BaseService m_DummyService;
 };
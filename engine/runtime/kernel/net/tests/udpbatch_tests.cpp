@@ -0,0 +1,242 @@
+#include "bdefs.h"
+#include "udpbatch.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdarg>
+#include <cstring>
+#include <vector>
+
+// The batch code logs through the console; the tests just drop it.
+int32 g_CV_UDPDebug = 0;
+void dsi_PrintToConsole(const char *, ...) {}
+
+#ifdef UDP_BATCHED_IO
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+namespace {
+
+// A pair of non-blocking UDP sockets on the loopback interface.
+class UDPBatchLoopback : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    m_hRecvSocket = OpenSocket();
+    m_hSendSocket = OpenSocket();
+    ASSERT_NE(m_hRecvSocket, INVALID_SOCKET);
+    ASSERT_NE(m_hSendSocket, INVALID_SOCKET);
+
+    // Room for a whole round of datagrams so nothing is dropped by the kernel.
+    int nBufferSize = 4 * 1024 * 1024;
+    setsockopt(m_hRecvSocket, SOL_SOCKET, SO_RCVBUF, &nBufferSize, sizeof(nBufferSize));
+
+    socklen_t nAddrLen = sizeof(m_RecvAddr);
+    ASSERT_EQ(getsockname(m_hRecvSocket, (sockaddr*)&m_RecvAddr, &nAddrLen), 0);
+
+    ASSERT_TRUE(m_RecvBatch.Init(m_hRecvSocket));
+  }
+
+  void TearDown() override {
+    m_RecvBatch.Term();
+    if (m_hRecvSocket != INVALID_SOCKET) close(m_hRecvSocket);
+    if (m_hSendSocket != INVALID_SOCKET) close(m_hSendSocket);
+  }
+
+  static SOCKET OpenSocket() {
+    SOCKET hSocket = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (hSocket == INVALID_SOCKET) return INVALID_SOCKET;
+
+    sockaddr_in cAddr = {};
+    cAddr.sin_family = AF_INET;
+    cAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    cAddr.sin_port = 0;
+    if (bind(hSocket, (sockaddr*)&cAddr, sizeof(cAddr)) != 0) {
+      close(hSocket);
+      return INVALID_SOCKET;
+    }
+    return hSocket;
+  }
+
+  // Queues a datagram holding its sequence number followed by a pattern
+  // derived from it.
+  void QueueDatagram(uint32 nSequence, uint32 nSize, const sockaddr_in &cDest) {
+    uint8 *pBuffer = udp_QueueSend(m_hSendSocket, nSize, &cDest);
+    ASSERT_NE(pBuffer, nullptr);
+    FillDatagram(pBuffer, nSequence, nSize);
+  }
+
+  static void FillDatagram(uint8 *pBuffer, uint32 nSequence, uint32 nSize) {
+    memcpy(pBuffer, &nSequence, sizeof(nSequence));
+    for (uint32 i = sizeof(nSequence); i < nSize; ++i) {
+      pBuffer[i] = (uint8)(nSequence * 31 + i);
+    }
+  }
+
+  // Size of the datagram with a given sequence number.
+  static uint32 DatagramSize(uint32 nSequence) {
+    return sizeof(uint32) + (nSequence * 97) % 1400;
+  }
+
+  // Receives datagrams until nCount have arrived or the socket goes quiet.
+  std::vector<std::vector<uint8>> Receive(uint32 nCount) {
+    std::vector<std::vector<uint8>> received;
+    while (received.size() < nCount) {
+      int nRead = m_RecvBatch.Recv();
+      if (nRead == SOCKET_ERROR) {
+        if (errno != EWOULDBLOCK) break;
+        if (m_RecvBatch.Wait(1000) != 1) break;
+        continue;
+      }
+
+      for (int i = 0; i < nRead; ++i) {
+        const uint8 *pData = m_RecvBatch.GetData(i);
+        received.emplace_back(pData, pData + m_RecvBatch.GetSize(i));
+      }
+    }
+    return received;
+  }
+
+  bool IsQuiet() {
+    return (m_RecvBatch.Recv() == SOCKET_ERROR) && (errno == EWOULDBLOCK);
+  }
+
+  SOCKET m_hRecvSocket = INVALID_SOCKET;
+  SOCKET m_hSendSocket = INVALID_SOCKET;
+  sockaddr_in m_RecvAddr = {};
+  CUDPRecvBatch m_RecvBatch;
+};
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+// Batching
+// -----------------------------------------------------------------------------
+
+TEST_F(UDPBatchLoopback, QueueSend_OnlyQueuesInsideABatch) {
+  EXPECT_EQ(udp_QueueSend(m_hSendSocket, 16, &m_RecvAddr), nullptr);
+
+  udp_BeginSendBatch();
+  EXPECT_NE(udp_QueueSend(m_hSendSocket, 16, &m_RecvAddr), nullptr);
+  udp_EndSendBatch();
+
+  EXPECT_EQ(Receive(1).size(), 1u);
+}
+
+TEST_F(UDPBatchLoopback, QueueSend_RefusesOversizedDatagrams) {
+  CUDPAutoSendBatch cBatch;
+  EXPECT_EQ(udp_QueueSend(m_hSendSocket, 64 * 1024, &m_RecvAddr), nullptr);
+}
+
+TEST_F(UDPBatchLoopback, NestedBatches_SendOnOutermostEnd) {
+  udp_BeginSendBatch();
+  udp_BeginSendBatch();
+  QueueDatagram(1, 32, m_RecvAddr);
+  udp_EndSendBatch();
+
+  // Still queued until the outer batch closes.
+  EXPECT_TRUE(IsQuiet());
+
+  udp_EndSendBatch();
+  EXPECT_EQ(Receive(1).size(), 1u);
+}
+
+TEST_F(UDPBatchLoopback, Flush_SendsButKeepsBatchOpen) {
+  CUDPAutoSendBatch cBatch;
+  QueueDatagram(1, 32, m_RecvAddr);
+  udp_FlushSendBatch();
+  EXPECT_EQ(Receive(1).size(), 1u);
+
+  EXPECT_NE(udp_QueueSend(m_hSendSocket, 32, &m_RecvAddr), nullptr);
+}
+
+// -----------------------------------------------------------------------------
+// Errors
+// -----------------------------------------------------------------------------
+
+TEST_F(UDPBatchLoopback, Flush_FailedDestinationOnlyDropsItsDatagram) {
+  // Sending to the broadcast address without SO_BROADCAST fails with EACCES,
+  // which only concerns that one datagram.
+  sockaddr_in cBroadcast = m_RecvAddr;
+  cBroadcast.sin_addr.s_addr = htonl(INADDR_BROADCAST);
+
+  {
+    CUDPAutoSendBatch cBatch;
+    QueueDatagram(0, 32, m_RecvAddr);
+    QueueDatagram(1, 32, cBroadcast);
+    QueueDatagram(2, 32, m_RecvAddr);
+    QueueDatagram(3, 32, cBroadcast);
+    QueueDatagram(4, 32, m_RecvAddr);
+  }
+
+  std::vector<std::vector<uint8>> received = Receive(3);
+  ASSERT_EQ(received.size(), 3u);
+
+  const uint32 aExpected[] = {0, 2, 4};
+  for (uint32 i = 0; i < 3; ++i) {
+    uint32 nSequence;
+    memcpy(&nSequence, received[i].data(), sizeof(nSequence));
+    EXPECT_EQ(nSequence, aExpected[i]);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Soak
+// -----------------------------------------------------------------------------
+
+TEST_F(UDPBatchLoopback, Soak_EveryDatagramArrivesIntact) {
+  const uint32 nRounds = 200;
+  const uint32 nPerRound = 150;  // more than one sendmmsg worth
+
+  uint32 nSequence = 0;
+  uint32 nReceived = 0;
+  std::vector<uint8> expected;
+
+  for (uint32 nRound = 0; nRound < nRounds; ++nRound) {
+    uint32 nFirst = nSequence;
+    {
+      CUDPAutoSendBatch cBatch;
+      for (uint32 i = 0; i < nPerRound; ++i, ++nSequence) {
+        QueueDatagram(nSequence, DatagramSize(nSequence), m_RecvAddr);
+      }
+    }
+
+    std::vector<std::vector<uint8>> received = Receive(nPerRound);
+    ASSERT_EQ(received.size(), nPerRound) << "round " << nRound;
+
+    // Loopback keeps them in order.
+    for (uint32 i = 0; i < nPerRound; ++i) {
+      uint32 nExpected = nFirst + i;
+      expected.resize(DatagramSize(nExpected));
+      FillDatagram(expected.data(), nExpected, (uint32)expected.size());
+      ASSERT_EQ(received[i], expected) << "datagram " << nExpected;
+    }
+    nReceived += (uint32)received.size();
+  }
+
+  EXPECT_EQ(nReceived, nRounds * nPerRound);
+  EXPECT_TRUE(IsQuiet());
+}
+
+// -----------------------------------------------------------------------------
+// Waiting
+// -----------------------------------------------------------------------------
+
+TEST_F(UDPBatchLoopback, Wait_TimesOutWhenQuiet) {
+  EXPECT_EQ(m_RecvBatch.Wait(10), 0);
+}
+
+TEST_F(UDPBatchLoopback, Wait_ReturnsEarlyOnWake) {
+  m_RecvBatch.Wake();
+  EXPECT_EQ(m_RecvBatch.Wait(5000), 0);
+}
+
+#else
+
+TEST(UDPBatch, NotAvailable) {
+  GTEST_SKIP() << "Batched UDP I/O is only built on Linux";
+}
+
+#endif  // UDP_BATCHED_IO
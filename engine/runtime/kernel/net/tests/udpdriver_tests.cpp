@@ -0,0 +1,330 @@
+#include "bdefs.h"
+#include "netmgr.h"
+#include "sysudpdriver.h"
+#include "systimer.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+// What the driver and the net manager pull in from the rest of the engine,
+// with the engine's defaults for the console variables.
+int32 g_CV_UDPDebug = 0;
+int32 g_CV_UDPSimulatePacketLoss = 0;
+int32 g_CV_UDPSimulateCorruption = 0;
+int32 g_CV_IPClientPort = 0;
+int32 g_CV_IPClientPortRange = 1;
+int32 g_CV_IPClientPortMRU = 0;
+int32 g_CV_BandwidthTargetClient = 256000;
+char *g_CV_IP = LTNULL;
+char *g_CV_BindIP = LTNULL;
+int32 g_CV_ShowConnStats = 0;
+float g_CV_LatencySim = 0.0f;
+float g_CV_DropRate = 0.0f;
+int32 g_CV_ParseNet = 0;
+int32 g_CV_ParseNet_Incoming = 0;
+int32 g_CV_ParseNet_Outgoing = 0;
+int32 g_TransportDebug = 0;
+int32 g_bForceRemote = 0;
+int32 g_bLocalDebug = 0;
+int32 g_DebugLevel = 0;
+const char *g_ReturnErrString = "LT ERROR: %s returned %s (%s)";
+
+void* DefStdlithAlloc(uint32 size) { return malloc(size); }
+void DefStdlithFree(void *ptr) { free(ptr); }
+void DebugOut(const char *, ...) {}
+void dsi_PrintToConsole(const char *, ...) {}
+void dsi_OnReturnError(int) {}
+void dsi_Sleep(uint32 ms) { usleep(ms * 1000); }
+
+namespace {
+
+enum {
+  k_nMsg_Guaranteed = 1,
+  k_nMsg_Unguaranteed = 2,
+  k_nMsg_Echo = 3,
+};
+
+// Accepts everyone and keeps track of who's connected.
+class CTestNetHandler : public CNetHandler {
+ public:
+  bool NewConnectionNotify(CBaseConn *pConn, bool) override {
+    m_Connections.push_back(pConn);
+    return true;
+  }
+
+  void DisconnectNotify(CBaseConn *pConn, EDisconnectReason) override {
+    m_Connections.erase(std::remove(m_Connections.begin(), m_Connections.end(), pConn),
+                        m_Connections.end());
+  }
+
+  void HandleUnknownPacket(const CPacket_Read &, uint8[4], uint16) override {}
+
+  std::vector<CBaseConn*> m_Connections;
+};
+
+// A net manager with a UDP driver, as the client and the server each have.
+struct SEndpoint {
+  SEndpoint() {
+    m_NetMgr.Init("test");
+    m_NetMgr.SetNetHandler(&m_Handler);
+    m_pDriver = m_NetMgr.AddDriver("internet");
+  }
+
+  ~SEndpoint() { m_NetMgr.Term(); }
+
+  CTestNetHandler m_Handler;
+  CNetMgr m_NetMgr;
+  CBaseDriver *m_pDriver = LTNULL;
+};
+
+// What one connection has sent us.
+struct SReceived {
+  uint32 m_nClient = 0xFFFFFFFF;
+  std::vector<uint32> m_Guaranteed;
+  std::vector<uint32> m_Unguaranteed;
+};
+
+CPacket_Read MakeMessage(uint32 nType, uint32 nClient, uint32 nSequence) {
+  CPacket_Write cPacket;
+  cPacket.Writeuint8((uint8)nType);
+  cPacket.Writeuint32(nClient);
+  cPacket.Writeuint32(nSequence);
+  return CPacket_Read(cPacket);
+}
+
+// A host with a crowd of clients joined to it over the loopback interface.
+class UDPDriverLoopback : public ::testing::Test {
+ protected:
+  static constexpr uint32 k_nNumClients = 48;
+
+  void SetUp() override {
+    m_pHost.reset(new SEndpoint);
+    ASSERT_NE(m_pHost->m_pDriver, nullptr);
+
+    uint16 nPort = FindFreePort();
+    ASSERT_NE(nPort, 0);
+
+    NetHost cHost = {};
+    cHost.m_Port = nPort;
+    cHost.m_dwMaxConnections = k_nNumClients;
+    LTStrCpy(cHost.m_sName, "loopback", sizeof(cHost.m_sName));
+    ASSERT_EQ(m_pHost->m_pDriver->HostSession(&cHost), LT_OK);
+
+    char sAddress[32];
+    LTSNPrintF(sAddress, sizeof(sAddress), "127.0.0.1:%d", (int)nPort);
+
+    for (uint32 i = 0; i < k_nNumClients; ++i) {
+      m_Clients.emplace_back(new SEndpoint);
+      SEndpoint &cClient = *m_Clients.back();
+      ASSERT_NE(cClient.m_pDriver, nullptr);
+      ASSERT_EQ(cClient.m_pDriver->ConnectTCP(sAddress), LT_OK) << "client " << i;
+      ASSERT_EQ(cClient.m_Handler.m_Connections.size(), 1u) << "client " << i;
+    }
+
+    // The host hears about them on its next update.
+    PumpUntil([&]() { return m_pHost->m_Handler.m_Connections.size() == k_nNumClients; });
+    ASSERT_EQ(m_pHost->m_Handler.m_Connections.size(), k_nNumClients);
+  }
+
+  void TearDown() override {
+    // Each one sleeps between its disconnect messages, so they all leave at
+    // once.
+    std::vector<std::thread> leaving;
+    for (std::unique_ptr<SEndpoint> &pClient : m_Clients) {
+      leaving.emplace_back([&pClient]() { pClient.reset(); });
+    }
+    for (std::thread &cThread : leaving) cThread.join();
+    m_Clients.clear();
+    m_pHost.reset();
+  }
+
+  static uint16 FindFreePort() {
+    SOCKET hSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (hSocket == INVALID_SOCKET) return 0;
+
+    sockaddr_in cAddr = {};
+    cAddr.sin_family = AF_INET;
+    cAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+    socklen_t nAddrLen = sizeof(cAddr);
+    uint16 nPort = 0;
+    if ((bind(hSocket, (sockaddr*)&cAddr, sizeof(cAddr)) == 0) &&
+        (getsockname(hSocket, (sockaddr*)&cAddr, &nAddrLen) == 0)) {
+      nPort = ntohs(cAddr.sin_port);
+    }
+    close(hSocket);
+    return nPort;
+  }
+
+  CBaseConn *GetServerConn(SEndpoint &cClient) { return cClient.m_Handler.m_Connections.front(); }
+
+  // Updates one endpoint and reads everything it has been sent.
+  void Update(SEndpoint &cEndpoint) {
+    cEndpoint.m_NetMgr.Update("", time_GetTime());
+
+    CPacket_Read cPacket;
+    CBaseConn *pSender;
+    while (cEndpoint.m_NetMgr.GetPacket(NETMGR_TRAVELDIR_UNKNOWN, &cPacket, &pSender)) {
+      uint32 nType = cPacket.Readuint8();
+      uint32 nClient = cPacket.Readuint32();
+      uint32 nSequence = cPacket.Readuint32();
+      HandleMessage(cEndpoint, pSender, nType, nClient, nSequence);
+    }
+  }
+
+  void HandleMessage(SEndpoint &cEndpoint, CBaseConn *pSender, uint32 nType, uint32 nClient,
+                     uint32 nSequence) {
+    if (&cEndpoint == m_pHost.get()) {
+      SReceived &cReceived = m_HostReceived[pSender];
+      if (cReceived.m_nClient == 0xFFFFFFFF) cReceived.m_nClient = nClient;
+      EXPECT_EQ(cReceived.m_nClient, nClient) << "messages from two clients on one connection";
+
+      if (nType == k_nMsg_Guaranteed) {
+        cReceived.m_Guaranteed.push_back(nSequence);
+        m_pHost->m_NetMgr.SendPacket(MakeMessage(k_nMsg_Echo, nClient, nSequence), pSender,
+                                     MESSAGE_GUARANTEED);
+      } else {
+        EXPECT_EQ(nType, (uint32)k_nMsg_Unguaranteed);
+        cReceived.m_Unguaranteed.push_back(nSequence);
+      }
+    } else {
+      EXPECT_EQ(nType, (uint32)k_nMsg_Echo);
+      m_ClientEchoes[&cEndpoint].push_back(nClient);
+      m_ClientEchoSequences[&cEndpoint].push_back(nSequence);
+    }
+  }
+
+  void UpdateAll() {
+    // The host both first and last, so replies go out in the same round.
+    Update(*m_pHost);
+    for (std::unique_ptr<SEndpoint> &pClient : m_Clients) Update(*pClient);
+    Update(*m_pHost);
+  }
+
+  template <class Done>
+  void PumpUntil(Done fnDone, uint32 nTimeoutMS = 20000) {
+    uint32 nStart = timeGetTime();
+    while (!fnDone() && ((timeGetTime() - nStart) < nTimeoutMS)) {
+      UpdateAll();
+      usleep(1000);
+    }
+  }
+
+  std::unique_ptr<SEndpoint> m_pHost;
+  std::vector<std::unique_ptr<SEndpoint>> m_Clients;
+
+  std::map<CBaseConn*, SReceived> m_HostReceived;
+  std::map<SEndpoint*, std::vector<uint32>> m_ClientEchoes;
+  std::map<SEndpoint*, std::vector<uint32>> m_ClientEchoSequences;
+};
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+// Connecting
+// -----------------------------------------------------------------------------
+
+TEST_F(UDPDriverLoopback, Join_EveryClientGetsItsOwnConnection) {
+  std::vector<CBaseConn*> hostConns = m_pHost->m_Handler.m_Connections;
+  std::sort(hostConns.begin(), hostConns.end());
+  EXPECT_EQ(std::unique(hostConns.begin(), hostConns.end()), hostConns.end());
+
+  // Each one's address is a different client socket.
+  std::vector<uint16> ports;
+  for (CBaseConn *pConn : hostConns) {
+    uint8 aAddr[4];
+    uint16 nPort;
+    ASSERT_TRUE(pConn->GetIPAddress(aAddr, &nPort));
+    EXPECT_EQ(aAddr[0], 127);
+    ports.push_back(nPort);
+  }
+  std::sort(ports.begin(), ports.end());
+  EXPECT_EQ(std::unique(ports.begin(), ports.end()), ports.end());
+}
+
+// -----------------------------------------------------------------------------
+// Soak
+// -----------------------------------------------------------------------------
+
+TEST_F(UDPDriverLoopback, Soak_GuaranteedArriveInOrderAndEchoBack) {
+  const uint32 nRounds = 100;
+  const uint32 nPerRound = 3;
+  const uint32 nPerClient = nRounds * nPerRound;
+
+  uint32 nSequence[k_nNumClients] = {};
+  for (uint32 nRound = 0; nRound < nRounds; ++nRound) {
+    for (uint32 i = 0; i < k_nNumClients; ++i) {
+      SEndpoint &cClient = *m_Clients[i];
+      for (uint32 j = 0; j < nPerRound; ++j, ++nSequence[i]) {
+        ASSERT_TRUE(cClient.m_NetMgr.SendPacket(MakeMessage(k_nMsg_Guaranteed, i, nSequence[i]),
+                                                GetServerConn(cClient), MESSAGE_GUARANTEED));
+      }
+      cClient.m_NetMgr.SendPacket(MakeMessage(k_nMsg_Unguaranteed, i, nRound),
+                                  GetServerConn(cClient), 0);
+    }
+    UpdateAll();
+  }
+
+  PumpUntil([&]() {
+    if (m_HostReceived.size() != k_nNumClients) return false;
+    for (std::unique_ptr<SEndpoint> &pClient : m_Clients) {
+      if (m_ClientEchoSequences[pClient.get()].size() < nPerClient) return false;
+    }
+    return true;
+  });
+
+  // Every client was heard from, on its own connection, with nothing lost,
+  // repeated or reordered.
+  ASSERT_EQ(m_HostReceived.size(), k_nNumClients);
+  std::vector<uint32> clients;
+  for (std::pair<CBaseConn* const, SReceived> &cEntry : m_HostReceived) {
+    const SReceived &cReceived = cEntry.second;
+    clients.push_back(cReceived.m_nClient);
+
+    ASSERT_EQ(cReceived.m_Guaranteed.size(), nPerClient) << "client " << cReceived.m_nClient;
+    for (uint32 i = 0; i < nPerClient; ++i) {
+      ASSERT_EQ(cReceived.m_Guaranteed[i], i) << "client " << cReceived.m_nClient;
+    }
+
+    // Unguaranteed ones may be dropped, but never repeated or made up.
+    std::vector<uint32> unguaranteed = cReceived.m_Unguaranteed;
+    std::sort(unguaranteed.begin(), unguaranteed.end());
+    EXPECT_EQ(std::unique(unguaranteed.begin(), unguaranteed.end()), unguaranteed.end());
+    for (uint32 nRound : unguaranteed) EXPECT_LT(nRound, nRounds);
+  }
+  std::sort(clients.begin(), clients.end());
+  for (uint32 i = 0; i < k_nNumClients; ++i) EXPECT_EQ(clients[i], i);
+
+  // And the replies made it back to the right clients in order.
+  for (uint32 i = 0; i < k_nNumClients; ++i) {
+    SEndpoint *pClient = m_Clients[i].get();
+    const std::vector<uint32> &echoes = m_ClientEchoes[pClient];
+    const std::vector<uint32> &sequences = m_ClientEchoSequences[pClient];
+    ASSERT_EQ(sequences.size(), nPerClient) << "client " << i;
+    for (uint32 j = 0; j < nPerClient; ++j) {
+      ASSERT_EQ(echoes[j], i);
+      ASSERT_EQ(sequences[j], j) << "client " << i;
+    }
+  }
+}
+
+TEST_F(UDPDriverLoopback, Disconnect_HostSeesTheClientLeave) {
+  SEndpoint &cClient = *m_Clients.front();
+  cClient.m_NetMgr.Disconnect(GetServerConn(cClient), DISCONNECTREASON_VOLUNTARY_CLIENTSIDE);
+  EXPECT_TRUE(cClient.m_Handler.m_Connections.empty());
+
+  PumpUntil([&]() { return m_pHost->m_Handler.m_Connections.size() == k_nNumClients - 1; });
+  EXPECT_EQ(m_pHost->m_Handler.m_Connections.size(), k_nNumClients - 1);
+}
+
@@ -91,6 +91,11 @@ void r_TerminateAllRecreatableTextureData();
 //be freed
 LTRESULT r_LoadSystemTexture(SharedTexture *pSharedTexture);
 
+//loads the data for any of these textures that don't have it yet, decoding the files in parallel on
+//the resource loader. Textures that fail to load are skipped, so r_LoadSystemTexture will try them
+//again on demand
+void r_PreloadSystemTextures(SharedTexture **ppTextures, uint32 nTextures);
+
 //frees the associated texture data and cleans up references to it
 void r_UnloadSystemTexture(TextureData *pTexture);
 
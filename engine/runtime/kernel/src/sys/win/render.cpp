@@ -10,6 +10,9 @@
 #include "videomgr.h"
 #include "sysconsole_impl.h"
 #include "dtxmgr.h"
+#include "ltresourceloader.h"
+
+#include <vector>
 
 #ifdef LTJS_SDL_BACKEND
 #include "SDL3/SDL_video.h"
@@ -78,37 +81,11 @@ void r_UnloadSystemTexture(TextureData *pTexture)
 	delete pTexture;
 }
 
-// Loads the texture and installs it.
-LTRESULT r_LoadSystemTexture(SharedTexture *pSharedTexture)
+// Hooks up freshly loaded texture data to its shared texture and loads any linked textures.
+static LTRESULT r_InstallSystemTexture(SharedTexture *pSharedTexture, TextureData *pTextureData, uint32 nBaseWidth, uint32 nBaseHeight)
 {
-	LTRESULT dResult;
 	FileRef ref;
 
-	FileIdentifier *pIdent = pSharedTexture->m_pFile;
-
-	if (!pIdent) 
-		return LT_NOTINITIALIZED;
-
-	uint32 nBaseWidth;
-	uint32 nBaseHeight;
-
-	//the texture data that is associated with the texture
-	TextureData* pTextureData = NULL;
-
-	ILTStream *pStream = client_file_mgr->OpenFileIdentifier(pIdent);
-	if (pStream) 
-	{
-		dResult = dtx_Create(pStream, &pTextureData, nBaseWidth, nBaseHeight);
-		pStream->Release();
-
-		if (dResult != LT_OK) 
-			return dResult; 
-	}
-	else 
-	{
-		RETURN_ERROR_PARAM(1, r_LoadSystemTexture, LT_MISSINGFILE, pIdent->m_Filename); 
-	}
-
 	//make sure to setup the texture information
 	pSharedTexture->SetTextureInfo(nBaseWidth, nBaseHeight, pTextureData->m_PFormat);
 
@@ -350,6 +327,100 @@ LTRESULT r_LoadSystemTexture(SharedTexture *pSharedTexture)
 	return LT_OK;
 }
 
+// Loads the texture and installs it.
+LTRESULT r_LoadSystemTexture(SharedTexture *pSharedTexture)
+{
+	LTRESULT dResult;
+
+	FileIdentifier *pIdent = pSharedTexture->m_pFile;
+
+	if (!pIdent) 
+		return LT_NOTINITIALIZED;
+
+	uint32 nBaseWidth;
+	uint32 nBaseHeight;
+
+	//the texture data that is associated with the texture
+	TextureData* pTextureData = NULL;
+
+	ILTStream *pStream = client_file_mgr->OpenFileIdentifier(pIdent);
+	if (pStream) 
+	{
+		dResult = dtx_Create(pStream, &pTextureData, nBaseWidth, nBaseHeight);
+		pStream->Release();
+
+		if (dResult != LT_OK) 
+			return dResult; 
+	}
+	else 
+	{
+		RETURN_ERROR_PARAM(1, r_LoadSystemTexture, LT_MISSINGFILE, pIdent->m_Filename); 
+	}
+
+	return r_InstallSystemTexture(pSharedTexture, pTextureData, nBaseWidth, nBaseHeight);
+}
+
+//runs on a resource loader thread.  Decoding a DTX only touches the stream and the new
+//texture data, so it doesn't need the file manager or the renderer
+static LTRESULT r_LoadTextureResource(LTResourceRequest *pRequest)
+{
+	DtxLoadRequest *pLoad = (DtxLoadRequest*)pRequest->m_pUser;
+	return dtx_Create(pRequest->m_pStream, &pLoad->m_pTexture, pLoad->m_nBaseWidth, pLoad->m_nBaseHeight);
+}
+
+static void r_OnTextureResourceLoaded(LTResourceRequest *pRequest)
+{
+	DtxLoadRequest *pLoad = (DtxLoadRequest*)pRequest->m_pUser;
+	SharedTexture *pTexture = (SharedTexture*)pRequest->m_pKey;
+
+	//anything that failed is left for r_LoadSystemTexture to retry and report
+	if (pRequest->m_Result != LT_OK)
+		return;
+
+	//installing a texture can load linked textures, which may be in this batch too
+	if (pTexture->m_pEngineData)
+	{
+		dtx_Destroy(pLoad->m_pTexture);
+		return;
+	}
+
+	r_InstallSystemTexture(pTexture, pLoad->m_pTexture, pLoad->m_nBaseWidth, pLoad->m_nBaseHeight);
+}
+
+void r_PreloadSystemTextures(SharedTexture **ppTextures, uint32 nTextures)
+{
+	//find the textures that still need their data loaded and open them all up front, since
+	//the file manager isn't thread safe
+	std::vector<DtxLoadRequest> loads(nTextures);
+	std::vector<HLTRESOURCE> handles;
+	handles.reserve(nTextures);
+
+	for (uint32 i = 0; i < nTextures; i++)
+	{
+		SharedTexture *pTexture = ppTextures[i];
+		if (!pTexture || pTexture->m_pEngineData || !pTexture->m_pFile)
+			continue;
+
+		LTResourceRequest request;
+		request.m_pKey = pTexture;
+		request.m_pStream = client_file_mgr->OpenFileIdentifier(pTexture->m_pFile);
+		request.m_LoadFn = r_LoadTextureResource;
+		request.m_DoneFn = r_OnTextureResourceLoaded;
+		request.m_pUser = &loads[i];
+
+		HLTRESOURCE hRequest = lt_GetResourceLoader().Queue(request);
+		if (hRequest)
+			handles.push_back(hRequest);
+	}
+
+	//the loader decodes them in parallel, and waiting on them in order installs them back on
+	//this thread in the same order they would have loaded in
+	for (uint32 i = 0; i < handles.size(); i++)
+	{
+		lt_GetResourceLoader().Wait(handles[i]);
+	}
+}
+
 
 // ------------------------------------------------------------ //
 // RenderStruct function implementations.
@@ -324,6 +324,8 @@ ModelAnim::ModelAnim(Model *pModel)
 	m_pName = "";
 	m_pAnimNodes = NULL;
 	m_InterpolationMS = 200;
+	m_pSoAKeys = NULL;
+	m_nSoAStride = 0;
 }
 
 
@@ -341,6 +343,9 @@ void ModelAnim::Term()
 		m_pAnimNodes = NULL;
 	}
 
+	delete [] m_pSoAKeys.exchange(NULL);
+	m_nSoAStride = 0;
+
 	m_KeyFrames.Term(GetAlloc());
 }
 
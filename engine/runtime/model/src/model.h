@@ -27,6 +27,7 @@
 #endif
 
 #include <set>
+#include <atomic>
 
 class AnimTimeRef;
 class LAlloc;
@@ -449,6 +450,21 @@ public:
 
 };
 
+// ------------------------------------------------------------------------
+// Channel order of ModelAnim's structure-of-arrays keyframes.
+// ------------------------------------------------------------------------
+enum
+{
+	ANIMSOA_POSX = 0,
+	ANIMSOA_POSY,
+	ANIMSOA_POSZ,
+	ANIMSOA_ROTX,
+	ANIMSOA_ROTY,
+	ANIMSOA_ROTZ,
+	ANIMSOA_ROTW,
+	ANIMSOA_NUMCHANNELS
+};
+
 // ------------------------------------------------------------------------
 // ModelAnim
 // Collection of animations associated with a model.
@@ -476,6 +492,22 @@ public:
 	// Returns how long (in milliseconds) the animation is.
 	uint32			GetAnimTime() const;
 
+	// Decodes the keys for the batched evaluator the first time it's called.
+	// Returns false if the animation has none.  Safe to call from several
+	// threads at once.
+	bool			PrepareSoAKeys();
+
+	// The decoded keys of every node for a frame, ANIMSOA_NUMCHANNELS runs
+	// of GetSoAStride() floats each.  NULL if they haven't been built.
+	const float*	GetSoAFrame(uint32 iFrame) const
+	{
+		const float *pKeys = m_pSoAKeys.load(std::memory_order_acquire);
+		return pKeys ? &pKeys[iFrame * ANIMSOA_NUMCHANNELS * m_nSoAStride] : NULL;
+	}
+
+	// Node count rounded up to a multiple of 4.
+	uint32			GetSoAStride() const			{return m_nSoAStride;}
+
 public:
 
 	bool			Load(ILTStream &file, uint8*& pAnimData);
@@ -505,6 +537,11 @@ private:
 	Model			*m_pModel;
 
 	const char		*m_pName;
+
+	// Keys for the batched evaluator in TransformMaker, laid out by frame,
+	// then channel, then node.  Built by PrepareSoAKeys.
+	std::atomic<float*>	m_pSoAKeys;
+	uint32			m_nSoAStride;
 };
 
 
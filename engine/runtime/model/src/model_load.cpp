@@ -16,6 +16,8 @@
 #include "syscounter.h"
 #include "systimer.h"
 
+#include <mutex>
+
 #define LTB_D3D_VERSION 2;
 
 extern uint32 g_ModelMemory;
@@ -437,6 +439,74 @@ bool ModelAnim::Load(ILTStream &file, uint8*& pAnimData)
 	return true;
 }
 
+// ------------------------------------------------------------------------
+// Decodes every node's pos/rot channels into one float block, frame by
+// frame, with each channel stored as a run over all the nodes.  This costs
+// more memory than the compressed channels, but lets the TransformMaker
+// sample a whole skeleton with straight loops instead of two virtual calls
+// per node.  It's done the first time the batched evaluator plays the
+// animation, so animations that never get there don't pay for it.
+// ------------------------------------------------------------------------
+static std::mutex s_SoAKeysMutex;
+
+bool ModelAnim::PrepareSoAKeys()
+{
+	if(m_pSoAKeys.load(std::memory_order_acquire))
+		return true;
+
+	uint32 nNodes = m_pModel->NumNodes();
+	uint32 nFrames = NumKeyFrames();
+
+	if(nNodes == 0 || nFrames == 0 || !m_pAnimNodes)
+		return false;
+
+	std::lock_guard<std::mutex> cLock(s_SoAKeysMutex);
+
+	// Someone else may have built them while we waited.
+	if(m_pSoAKeys.load(std::memory_order_relaxed))
+		return true;
+
+	uint32 nStride = (nNodes + 3) & ~3;
+	uint32 nFrameSize = ANIMSOA_NUMCHANNELS * nStride;
+
+	float *pKeys;
+	LT_MEM_TRACK_ALLOC(pKeys = new float[nFrames * nFrameSize], LT_MEM_TYPE_MODEL);
+
+	LTVector vPos;
+	LTRotation rRot;
+	for(uint32 iFrame=0; iFrame < nFrames; iFrame++)
+	{
+		float *pFrame = &pKeys[iFrame * nFrameSize];
+
+		for(uint32 iNode=0; iNode < nStride; iNode++)
+		{
+			// The padding past the last node is left at the identity.
+			if(iNode < nNodes)
+			{
+				m_pAnimNodes[iNode].GetData(iFrame, vPos, rRot);
+			}
+			else
+			{
+				vPos.Init();
+				rRot.Init();
+			}
+
+			pFrame[ANIMSOA_POSX * nStride + iNode] = vPos.x;
+			pFrame[ANIMSOA_POSY * nStride + iNode] = vPos.y;
+			pFrame[ANIMSOA_POSZ * nStride + iNode] = vPos.z;
+			pFrame[ANIMSOA_ROTX * nStride + iNode] = rRot.m_Quat[QUAT_X];
+			pFrame[ANIMSOA_ROTY * nStride + iNode] = rRot.m_Quat[QUAT_Y];
+			pFrame[ANIMSOA_ROTZ * nStride + iNode] = rRot.m_Quat[QUAT_Z];
+			pFrame[ANIMSOA_ROTW * nStride + iNode] = rRot.m_Quat[QUAT_W];
+		}
+	}
+
+	// The stride has to be visible before the keys are.
+	m_nSoAStride = nStride;
+	m_pSoAKeys.store(pKeys, std::memory_order_release);
+	return true;
+}
+
 bool ModelNode::Load(ILTStream &file, const LTMatrix& mInvParentMat)
 {
 	uint32 i, j, nChildren;
@@ -5,8 +5,24 @@
 #include "transformmaker.h"
 #include "de_objects.h"
 
+#include <chrono>
+#include <math.h>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORMMAKER_SSE
+#include <emmintrin.h>
+#endif
+
 #define MAX_MODELPATH_LEN	64
 
+// Scratch space for EvaluateBatched.  It's per thread since models get evaluated
+// from object updates on the job pool, and a node control function that calls
+// back into the model while it's in use gets the recursive evaluator instead.
+static thread_local std::vector<float>	s_BatchKeys;
+static thread_local std::vector<uint8>	s_BatchOnPath;
+static thread_local bool				s_bBatchInUse = false;
+
 
 bool TransformMaker::IsValid() 
 {
@@ -46,7 +62,11 @@ bool TransformMaker::SetupTransforms()
 	if(!SetupCall()) 
 		return false;
 
-	Recurse(m_pModel->GetRootNode()->GetNodeIndex(), m_pStartMat);
+	if(CanBatch())
+		EvaluateBatched(false);
+	else
+		Recurse(m_pModel->GetRootNode()->GetNodeIndex(), m_pStartMat);
+
 	return true;
 }
 
@@ -61,7 +81,10 @@ bool TransformMaker::SetupTransformsWithPath()
 	if(!SetupCall()) 
 		return false ;
 
-	RecurseWithPath( iRootNode, m_pStartMat);
+	if( CanBatch() && ShouldBatchPath() )
+		EvaluateBatched(true);
+	else
+		RecurseWithPath( iRootNode, m_pStartMat);
 
 	return true;
 }
@@ -421,3 +444,548 @@ void TransformMaker::RecurseWithPath(uint32 iNode, LTMatrix *pParentT)
 	}
 }
 
+
+// ------------------------------------------------------------------------
+// Batched evaluation.
+// ------------------------------------------------------------------------
+
+static inline void LoadKey(const float *pKeys, uint32 nStride, uint32 iNode, LTRotation &rRot, LTVector &vPos)
+{
+	vPos.x = pKeys[ANIMSOA_POSX * nStride + iNode];
+	vPos.y = pKeys[ANIMSOA_POSY * nStride + iNode];
+	vPos.z = pKeys[ANIMSOA_POSZ * nStride + iNode];
+	rRot.m_Quat[QUAT_X] = pKeys[ANIMSOA_ROTX * nStride + iNode];
+	rRot.m_Quat[QUAT_Y] = pKeys[ANIMSOA_ROTY * nStride + iNode];
+	rRot.m_Quat[QUAT_Z] = pKeys[ANIMSOA_ROTZ * nStride + iNode];
+	rRot.m_Quat[QUAT_W] = pKeys[ANIMSOA_ROTW * nStride + iNode];
+}
+
+static inline void StoreKey(float *pKeys, uint32 nStride, uint32 iNode, const LTRotation &rRot, const LTVector &vPos)
+{
+	pKeys[ANIMSOA_POSX * nStride + iNode] = vPos.x;
+	pKeys[ANIMSOA_POSY * nStride + iNode] = vPos.y;
+	pKeys[ANIMSOA_POSZ * nStride + iNode] = vPos.z;
+	pKeys[ANIMSOA_ROTX * nStride + iNode] = rRot.m_Quat[QUAT_X];
+	pKeys[ANIMSOA_ROTY * nStride + iNode] = rRot.m_Quat[QUAT_Y];
+	pKeys[ANIMSOA_ROTZ * nStride + iNode] = rRot.m_Quat[QUAT_Z];
+	pKeys[ANIMSOA_ROTW * nStride + iNode] = rRot.m_Quat[QUAT_W];
+}
+
+// ------------------------------------------------------------------------
+// Polynomial stand-ins for acosf and sinf so SlerpSoA can run four
+// quaternions at a time.  The slerped quaternions come out within about
+// 5e-7 of quat_Slerp's, so the batched evaluator matches the recursive one
+// to float tolerance rather than bit for bit.
+// ------------------------------------------------------------------------
+
+// acos(x) for x in [0, 1] (Abramowitz & Stegun 4.4.46, error < 2e-8).
+#define SLERP_ACOS_C0	 1.5707963050f
+#define SLERP_ACOS_C1	-0.2145988016f
+#define SLERP_ACOS_C2	 0.0889789874f
+#define SLERP_ACOS_C3	-0.0501743046f
+#define SLERP_ACOS_C4	 0.0308918810f
+#define SLERP_ACOS_C5	-0.0170881256f
+#define SLERP_ACOS_C6	 0.0066700901f
+#define SLERP_ACOS_C7	-0.0012624911f
+
+// sin(x) for x in [-pi/2, pi/2] (Taylor series to x^11).
+#define SLERP_SIN_C3	(-1.0f / 6.0f)
+#define SLERP_SIN_C5	(1.0f / 120.0f)
+#define SLERP_SIN_C7	(-1.0f / 5040.0f)
+#define SLERP_SIN_C9	(1.0f / 362880.0f)
+#define SLERP_SIN_C11	(-1.0f / 39916800.0f)
+
+static inline float SlerpAcos(float x)
+{
+	float p = SLERP_ACOS_C7;
+	p = p * x + SLERP_ACOS_C6;
+	p = p * x + SLERP_ACOS_C5;
+	p = p * x + SLERP_ACOS_C4;
+	p = p * x + SLERP_ACOS_C3;
+	p = p * x + SLERP_ACOS_C2;
+	p = p * x + SLERP_ACOS_C1;
+	p = p * x + SLERP_ACOS_C0;
+	return sqrtf(1.0f - x) * p;
+}
+
+// sin(x) for x in [-pi, pi].
+static inline float SlerpSin(float x)
+{
+	// Fold into [0, pi/2] and put the sign back at the end.
+	float a = fabsf(x);
+	a = LTMIN(a, MATH_PI - a);
+
+	float a2 = a * a;
+	float p = SLERP_SIN_C11;
+	p = p * a2 + SLERP_SIN_C9;
+	p = p * a2 + SLERP_SIN_C7;
+	p = p * a2 + SLERP_SIN_C5;
+	p = p * a2 + SLERP_SIN_C3;
+	p = p * a2 * a + a;
+
+	return (x < 0.0f) ? -p : p;
+}
+
+#ifdef TRANSFORMMAKER_SSE
+
+static inline __m128 SlerpAcos4(__m128 x)
+{
+	__m128 p = _mm_set1_ps(SLERP_ACOS_C7);
+	p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(SLERP_ACOS_C6));
+	p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(SLERP_ACOS_C5));
+	p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(SLERP_ACOS_C4));
+	p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(SLERP_ACOS_C3));
+	p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(SLERP_ACOS_C2));
+	p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(SLERP_ACOS_C1));
+	p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(SLERP_ACOS_C0));
+	return _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), x)), p);
+}
+
+static inline __m128 SlerpSin4(__m128 x)
+{
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+
+	__m128 sign = _mm_and_ps(x, signMask);
+	__m128 a = _mm_andnot_ps(signMask, x);
+	a = _mm_min_ps(a, _mm_sub_ps(_mm_set1_ps(MATH_PI), a));
+
+	__m128 a2 = _mm_mul_ps(a, a);
+	__m128 p = _mm_set1_ps(SLERP_SIN_C11);
+	p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(SLERP_SIN_C9));
+	p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(SLERP_SIN_C7));
+	p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(SLERP_SIN_C5));
+	p = _mm_add_ps(_mm_mul_ps(p, a2), _mm_set1_ps(SLERP_SIN_C3));
+	p = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(p, a2), a), a);
+
+	return _mm_or_ps(p, sign);
+}
+
+// where mask ? a : b
+static inline __m128 SlerpSelect4(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+#endif // TRANSFORMMAKER_SSE
+
+// ------------------------------------------------------------------------
+// SlerpSoA
+// quat_Slerp over nCount quaternions stored as runs of X, Y, Z and W nStride
+// floats apart, four at a time with SSE and one at a time for the rest.
+// pT gives a parameter per quaternion, or fT is used for all of them if it's
+// NULL.  pDest may be either of the inputs.  sin(omega) is worked out as
+// sqrt((1 - cosom) * (1 + cosom)), since 1 - cosom*cosom loses most of its
+// precision when the quaternions are close together.
+// ------------------------------------------------------------------------
+static void SlerpSoA(float *pDest, const float *pQ1, const float *pQ2,
+	uint32 nStride, uint32 nCount, float fT, const float *pT)
+{
+	uint32 i = 0;
+
+#ifdef TRANSFORMMAKER_SSE
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 epsilon = _mm_set1_ps(0.0001f);
+
+	for(; i + 4 <= nCount; i += 4)
+	{
+		__m128 t = pT ? _mm_loadu_ps(&pT[i]) : _mm_set1_ps(fT);
+
+		__m128 x1 = _mm_loadu_ps(&pQ1[i]);
+		__m128 y1 = _mm_loadu_ps(&pQ1[nStride + i]);
+		__m128 z1 = _mm_loadu_ps(&pQ1[nStride*2 + i]);
+		__m128 w1 = _mm_loadu_ps(&pQ1[nStride*3 + i]);
+
+		__m128 x2 = _mm_loadu_ps(&pQ2[i]);
+		__m128 y2 = _mm_loadu_ps(&pQ2[nStride + i]);
+		__m128 z2 = _mm_loadu_ps(&pQ2[nStride*2 + i]);
+		__m128 w2 = _mm_loadu_ps(&pQ2[nStride*3 + i]);
+
+		__m128 cosom = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x1, x2), _mm_mul_ps(y1, y2)),
+			_mm_add_ps(_mm_mul_ps(z1, z2), _mm_mul_ps(w1, w2)));
+
+		// Take the short way around.
+		__m128 flip = _mm_and_ps(cosom, signMask);
+		cosom = _mm_andnot_ps(signMask, cosom);
+
+		// Lanes that are too close together to slerp get a lerp instead.
+		// The slerp is worked out for them too and thrown away.
+		__m128 bSlerp = _mm_cmpgt_ps(_mm_sub_ps(one, cosom), epsilon);
+
+		__m128 omega = SlerpAcos4(cosom);
+		__m128 oosinom = _mm_div_ps(one, _mm_sqrt_ps(_mm_mul_ps(_mm_sub_ps(one, cosom), _mm_add_ps(one, cosom))));
+		__m128 scalerot0 = _mm_mul_ps(SlerpSin4(_mm_mul_ps(_mm_sub_ps(one, t), omega)), oosinom);
+		__m128 scalerot1 = _mm_mul_ps(SlerpSin4(_mm_mul_ps(t, omega)), oosinom);
+
+		scalerot0 = SlerpSelect4(bSlerp, scalerot0, _mm_sub_ps(one, t));
+		scalerot1 = _mm_xor_ps(SlerpSelect4(bSlerp, scalerot1, t), flip);
+
+		_mm_storeu_ps(&pDest[i],			_mm_add_ps(_mm_mul_ps(scalerot0, x1), _mm_mul_ps(scalerot1, x2)));
+		_mm_storeu_ps(&pDest[nStride + i],	_mm_add_ps(_mm_mul_ps(scalerot0, y1), _mm_mul_ps(scalerot1, y2)));
+		_mm_storeu_ps(&pDest[nStride*2 + i],	_mm_add_ps(_mm_mul_ps(scalerot0, z1), _mm_mul_ps(scalerot1, z2)));
+		_mm_storeu_ps(&pDest[nStride*3 + i],	_mm_add_ps(_mm_mul_ps(scalerot0, w1), _mm_mul_ps(scalerot1, w2)));
+	}
+#endif // TRANSFORMMAKER_SSE
+
+	float x1, y1, z1, w1, x2, y2, z2, w2;
+	float t, cosom, omega, oosinom, scalerot0, scalerot1;
+
+	for(; i < nCount; i++)
+	{
+		t = pT ? pT[i] : fT;
+
+		x1 = pQ1[i];
+		y1 = pQ1[nStride + i];
+		z1 = pQ1[nStride*2 + i];
+		w1 = pQ1[nStride*3 + i];
+
+		x2 = pQ2[i];
+		y2 = pQ2[nStride + i];
+		z2 = pQ2[nStride*2 + i];
+		w2 = pQ2[nStride*3 + i];
+
+		cosom = x1*x2 + y1*y2 + z1*z2 + w1*w2;
+
+		// Take the short way around.
+		bool bFlip = cosom < 0.0f;
+		if(bFlip)
+			cosom = -cosom;
+
+		if((1.0f - cosom) > 0.0001f)
+		{
+			omega   = SlerpAcos(cosom);
+			oosinom = 1.0f / sqrtf((1.0f - cosom) * (1.0f + cosom));
+			scalerot0 = SlerpSin((1.f - t) * omega) * oosinom;
+			scalerot1 = SlerpSin(t * omega) * oosinom;
+		}
+		else
+		{
+			scalerot0 = 1.0f - t;
+			scalerot1 = t;
+		}
+
+		if(bFlip)
+			scalerot1 = -scalerot1;
+
+		pDest[i]				= scalerot0 * x1 + scalerot1 * x2;
+		pDest[nStride + i]		= scalerot0 * y1 + scalerot1 * y2;
+		pDest[nStride*2 + i]	= scalerot0 * z1 + scalerot1 * z2;
+		pDest[nStride*3 + i]	= scalerot0 * w1 + scalerot1 * w2;
+	}
+}
+
+// ------------------------------------------------------------------------
+// CanBatch()
+// The batched evaluator needs SoA keys for every animation involved, laid
+// out for this model's node count (child model anims should always match).
+// They're built here the first time an animation is batched.
+// ------------------------------------------------------------------------
+bool TransformMaker::CanBatch()
+{
+	if(!m_bAllowBatch || s_bBatchInUse || m_pRecursePath)
+		return false;
+
+	uint32 nStride = (m_pModel->NumNodes() + 3) & ~3;
+
+	for(uint32 i=0; i < m_nAnims; i++)
+	{
+		if(!m_pAnimPrev[i]->PrepareSoAKeys() || m_pAnimPrev[i]->GetSoAStride() != nStride)
+			return false;
+
+		if(!m_pAnimCur[i]->PrepareSoAKeys() || m_pAnimCur[i]->GetSoAStride() != nStride)
+			return false;
+	}
+
+	return true;
+}
+
+// ------------------------------------------------------------------------
+// ShouldBatchPath()
+// Sampling every node only pays off if most of them need evaluating.  A
+// socket or single node lookup is cheaper walking down its path.
+// ------------------------------------------------------------------------
+bool TransformMaker::ShouldBatchPath()
+{
+	uint32 nNodes = m_pModel->NumNodes();
+	uint32 nNeeded = 0;
+
+	for(uint32 iNode=0; iNode < nNodes; iNode++)
+	{
+		if(m_pInstance->ShouldEvaluateNode(iNode) && !m_pInstance->IsNodeEvaluated(iNode))
+			nNeeded++;
+	}
+
+	return nNeeded * 2 >= nNodes;
+}
+
+// ------------------------------------------------------------------------
+// SampleAnimSoA( anim, output keys )
+// Does what InitTransform does, for every node at once.
+// ------------------------------------------------------------------------
+void TransformMaker::SampleAnimSoA(uint32 iAnim, float *pOut)
+{
+	AnimTimeRef *pTimeRef = &m_Anims[iAnim];
+	uint32 nStride = m_pAnimCur[iAnim]->GetSoAStride();
+	float t = pTimeRef->m_Percent;
+
+	const float *pPrev = m_pAnimPrev[iAnim]->GetSoAFrame(pTimeRef->m_Prev.m_iFrame);
+	const float *pCur = m_pAnimCur[iAnim]->GetSoAFrame(pTimeRef->m_Cur.m_iFrame);
+
+	for(uint32 iChannel=ANIMSOA_POSX; iChannel <= ANIMSOA_POSZ; iChannel++)
+	{
+		const float *p1 = &pPrev[iChannel * nStride];
+		const float *p2 = &pCur[iChannel * nStride];
+		float *pDest = &pOut[iChannel * nStride];
+
+		for(uint32 i=0; i < nStride; i++)
+		{
+			pDest[i] = p1[i] + (p2[i] - p1[i]) * t;
+		}
+	}
+
+	SlerpSoA(&pOut[ANIMSOA_ROTX * nStride], &pPrev[ANIMSOA_ROTX * nStride], &pCur[ANIMSOA_ROTX * nStride],
+		nStride, nStride, t, LTNULL);
+
+	// Apply the per-animation translation.
+	uint32 iRoot = m_pModel->GetRootNode()->GetNodeIndex();
+	LTVector *pTrans1 = &m_pModel->GetAnimInfo(pTimeRef->m_Prev.m_iAnim)->m_vTranslation;
+	LTVector *pTrans2 = &m_pModel->GetAnimInfo(pTimeRef->m_Cur.m_iAnim)->m_vTranslation;
+	LTVector vOffset = *pTrans1 + (*pTrans2 - *pTrans1) * t;
+
+	pOut[ANIMSOA_POSX * nStride + iRoot] += vOffset.x;
+	pOut[ANIMSOA_POSY * nStride + iRoot] += vOffset.y;
+	pOut[ANIMSOA_POSZ * nStride + iRoot] += vOffset.z;
+
+	// The movement node doesn't interpolate between different anims.
+	if(m_iMoveHintNode < m_pModel->NumNodes() && pTimeRef->m_Prev.m_iAnim != pTimeRef->m_Cur.m_iAnim)
+	{
+		LTRotation rRot;
+		LTVector vPos;
+
+		InitTransform(iAnim, m_iMoveHintNode, rRot, vPos);
+		StoreKey(pOut, nStride, m_iMoveHintNode, rRot, vPos);
+	}
+}
+
+// ------------------------------------------------------------------------
+// BlendAnimSoA( anim, blended keys, scratch keys )
+// Does what BlendTransform does, for every node at once.
+// ------------------------------------------------------------------------
+void TransformMaker::BlendAnimSoA(uint32 iAnim, float *pBlend, float *pSample)
+{
+	uint32 nNodes = m_pModel->NumNodes();
+	uint32 nStride = m_pAnimCur[iAnim]->GetSoAStride();
+	const float *pWeights = m_WeightSets[iAnim]->m_Weights.GetArray();
+
+	SampleAnimSoA(iAnim, pSample);
+
+	// Slerp from what's been blended so far towards this anim by each node's
+	// weight.  The zero and additive weights are thrown away below.
+	SlerpSoA(&pSample[ANIMSOA_ROTX * nStride], &pBlend[ANIMSOA_ROTX * nStride], &pSample[ANIMSOA_ROTX * nStride],
+		nStride, nNodes, 0.0f, pWeights);
+
+	for(uint32 iNode=0; iNode < nNodes; iNode++)
+	{
+		float fPercent = pWeights[iNode];
+
+		// skip this blend if the weight for this anim is zero.
+		if(fPercent == 0.0f)
+			continue;
+
+		if(fPercent == 2.0f)
+		{
+			// Add the animation.
+			LTRotation qBlend, qTransform;
+			LTVector vBlend, vTransform;
+
+			LoadKey(pBlend, nStride, iNode, qBlend, vBlend);
+			InitTransformAdditive(iAnim, iNode, qTransform, vTransform);
+			StoreKey(pBlend, nStride, iNode, qBlend * qTransform, vBlend + vTransform);
+		}
+		else
+		{
+			for(uint32 iChannel=ANIMSOA_POSX; iChannel <= ANIMSOA_POSZ; iChannel++)
+			{
+				float &fBlend = pBlend[iChannel * nStride + iNode];
+				fBlend = fBlend + (pSample[iChannel * nStride + iNode] - fBlend) * fPercent;
+			}
+
+			for(uint32 iChannel=ANIMSOA_ROTX; iChannel <= ANIMSOA_ROTW; iChannel++)
+			{
+				pBlend[iChannel * nStride + iNode] = pSample[iChannel * nStride + iNode];
+			}
+		}
+	}
+}
+
+// ------------------------------------------------------------------------
+// EvaluateBatched( only-nodes-on-the-path )
+// Samples and blends every animation for all the nodes, then builds the
+// global transforms in node index order.  The node list comes from a
+// preorder walk, so parents are done before their children and the nodes
+// (and their node control functions) go in the same order as Recurse().
+// With bWithPath it follows the same rules as RecurseWithPath().
+// ------------------------------------------------------------------------
+void TransformMaker::EvaluateBatched(bool bWithPath)
+{
+	uint32 iNode, i;
+	uint32 nNodes = m_pModel->NumNodes();
+	uint32 nStride = m_pAnimCur[0]->GetSoAStride();
+	uint32 nKeys = ANIMSOA_NUMCHANNELS * nStride;
+
+	s_bBatchInUse = true;
+
+	if(s_BatchKeys.size() < nKeys * 2)
+		s_BatchKeys.resize(nKeys * 2);
+
+	float *pBlend = &s_BatchKeys[0];
+	float *pSample = &s_BatchKeys[nKeys];
+
+	// Apply animation data (first one inits, the rest are blended in).
+	SampleAnimSoA(0, pBlend);
+	for(i=1; i < m_nAnims; i++)
+	{
+		BlendAnimSoA(i, pBlend, pSample);
+	}
+
+	if(bWithPath && s_BatchOnPath.size() < nNodes)
+		s_BatchOnPath.resize(nNodes);
+
+	LTRotation rRot;
+	LTVector vPos;
+
+	for(iNode=0; iNode < nNodes; iNode++)
+	{
+		ModelNode *pNode = m_pModel->GetNode(iNode);
+		uint32 iParent = pNode->GetParentNodeIndex();
+		LTMatrix *pParentT = (iParent == NODEPARENT_NONE) ? m_pStartMat : &m_pOutput[iParent];
+		LTMatrix *pMyGlobal = &m_pOutput[iNode];
+
+		if(bWithPath)
+		{
+			// The root was checked by SetupTransformsWithPath, everything else
+			// has to be flagged and have its parent on the path.
+			bool bOnPath = (iParent == NODEPARENT_NONE) ||
+				(s_BatchOnPath[iParent] && m_pInstance->ShouldEvaluateNode(iNode));
+
+			s_BatchOnPath[iNode] = bOnPath;
+
+			if(!bOnPath || m_pInstance->IsNodeEvaluated(iNode))
+				continue;
+		}
+
+		LoadKey(pBlend, nStride, iNode, rRot, vPos);
+
+		// Update the global matrix.
+		rRot.ConvertToMatrix(m_mTemp);
+
+		// Use the offset from the parent if this node only uses rotation data
+		// from the animation.
+		if(pNode->m_Flags & MNODE_ROTATIONONLY)
+		{
+			m_mTemp.SetTranslation(pNode->m_vOffsetFromParent);
+		}
+		else
+		{
+			m_mTemp.SetTranslation(vPos);
+		}
+
+		MatMul(pMyGlobal, pParentT, &m_mTemp);
+
+		// Mark it done before the node control function, see RecurseWithPath.
+		if(bWithPath)
+			m_pInstance->SetNodeEvaluated(iNode, true);
+
+		if(m_pInstance && m_pInstance->HasNodeControlFn(iNode))
+		{
+			//setup the node control data
+			NodeControlData Data;
+			Data.m_hModel					= (HOBJECT)m_pInstance;
+			Data.m_hNode					= iNode;
+			Data.m_pFromParentTransform		= &pNode->GetFromParentTransform();
+			Data.m_pNodeTransform			= pMyGlobal;
+			Data.m_pParentTransform			= pParentT;
+
+			m_pInstance->ApplyNodeControl(Data);
+		}
+	}
+
+	// erase the path (RecurseWithPath does it as it goes along).
+	if(bWithPath)
+	{
+		for(iNode=0; iNode < nNodes; iNode++)
+		{
+			if(s_BatchOnPath[iNode] && m_pModel->GetNode(iNode)->GetParentNodeIndex() != NODEPARENT_NONE)
+				m_pInstance->SetShouldEvaluateNode(iNode, false);
+		}
+	}
+
+	s_bBatchInUse = false;
+}
+
+// ------------------------------------------------------------------------
+// Benchmark( instance, iterations, recursive-ms, batched-ms, max-error )
+// ------------------------------------------------------------------------
+bool TransformMaker::Benchmark(ModelInstance *pInstance, uint32 nIterations,
+	float &fRecurseMS, float &fBatchedMS, float &fMaxError)
+{
+	TransformMaker tMaker;
+	LTAnimTracker *pCur;
+	LTMatrix mStart;
+	uint32 i, iNode;
+
+	fRecurseMS = fBatchedMS = fMaxError = 0.0f;
+
+	if(!pInstance || !pInstance->m_AnimTrackers || !pInstance->GetModelDB() || !nIterations)
+		return false;
+
+	pInstance->SetupTransform(mStart);
+
+	for(pCur = pInstance->m_AnimTrackers; pCur; pCur = (LTAnimTracker*)pCur->m_Link.m_pNext)
+	{
+		if(tMaker.m_nAnims >= MAX_GVP_ANIMS)
+			return false;
+
+		tMaker.m_Anims[tMaker.m_nAnims] = pCur->m_TimeRef;
+		tMaker.m_nAnims++;
+	}
+
+	// No instance, so node control functions are left alone.
+	tMaker.m_iMoveHintNode = pInstance->m_AnimTrackers->m_hHintNode;
+	tMaker.m_pStartMat = &mStart;
+
+	uint32 nNodes = pInstance->GetModelDB()->NumNodes();
+	std::vector<LTMatrix> recursed(nNodes), batched(nNodes);
+
+	tMaker.m_pOutput = &batched[0];
+	if(!tMaker.SetupCall() || !tMaker.CanBatch())
+		return false;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for(i=0; i < nIterations; i++)
+	{
+		tMaker.SetupTransforms();
+	}
+	fBatchedMS = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	tMaker.m_bAllowBatch = false;
+	tMaker.m_pOutput = &recursed[0];
+
+	start = std::chrono::steady_clock::now();
+	for(i=0; i < nIterations; i++)
+	{
+		tMaker.SetupTransforms();
+	}
+	fRecurseMS = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	for(iNode=0; iNode < nNodes; iNode++)
+	{
+		for(i=0; i < 16; i++)
+		{
+			float fError = (float)fabs(recursed[iNode].m[i / 4][i % 4] - batched[iNode].m[i / 4][i % 4]);
+			fMaxError = LTMAX(fMaxError, fError);
+		}
+	}
+
+	return true;
+}
@@ -29,6 +29,7 @@ private:
 						m_pInstance = LTNULL;
 						m_nAnims	= 0;
 						m_iMoveHintNode = 0xFFFFFFFF;
+						m_bAllowBatch = true;
 					}
 
 	// Copies m_Anims, m_nAnims, and sets m_pStarbtMat to GVPStruct::m_BaseTransform.
@@ -59,6 +60,25 @@ private:
 	void			Recurse(uint32 iNode, LTMatrix *pParentT);
 
 	void			RecurseWithPath(uint32 iNode, LTMatrix *pParentT);
+
+	// Batched evaluation.  All the animations are sampled for every node at
+	// once from ModelAnim's SoA keys, then the hierarchy is resolved in node
+	// order (which is a preorder walk, so parents always come first).
+	bool			CanBatch();
+	bool			ShouldBatchPath();
+	void			SampleAnimSoA(uint32 iAnim, float *pOut);
+	void			BlendAnimSoA(uint32 iAnim, float *pBlend, float *pSample);
+	void			EvaluateBatched(bool bWithPath);
+
+public:
+
+	// Times Recurse() against the batched evaluator on an instance's current
+	// animation state, and returns the biggest difference between the
+	// matrices they produce.  Node control functions aren't called.
+	static bool		Benchmark(ModelInstance *pInstance, uint32 nIterations,
+						float &fRecurseMS, float &fBatchedMS, float &fMaxError);
+
+private:
 	
 
 	// All the animations.
@@ -77,6 +97,9 @@ private:
 
 	uint32			m_iMoveHintNode ; 
 
+	// Cleared to force the recursive evaluators.
+	bool			m_bAllowBatch;
+
 	LTMatrix		m_mTemp;
 
 	LTRotation		m_Quat;
@@ -15,6 +15,146 @@ instantiate_interface( LTCollisionMgr, ILTCollisionMgr, Server );
 #endif
 
 
+//---------------------------------------------------------------------------//
+//'b' is 'a' itself, or another proxy for the same LTObject
+static inline bool is_self( const ILTCollisionObject& a, const ILTCollisionObject& b )
+{
+	return &a == &b || (a.m_hObj && a.m_hObj == b.m_hObj);
+}
+
+
+//---------------------------------------------------------------------------//
+//broadphase callback for Collide(), keeps the earliest contact
+struct CollideQuery
+{
+	LTContactInfo&						ci;
+	const ILTCollisionObject&			a;
+	const ILTCollisionObject::Filter&	of;
+	const LTContactInfo::Filter&		cif;
+
+	CollideQuery
+	(
+		LTContactInfo&						ci,
+		const ILTCollisionObject&			a,
+		const ILTCollisionObject::Filter&	of,
+		const LTContactInfo::Filter&		cif
+	)
+		:	ci(ci), a(a), of(of), cif(cif)
+	{}
+
+	bool operator () ( const ILTCollisionObject* b )
+	{
+		//filter objects before expensive test
+		if( !is_self( a, *b ) && of.Condition( *b ) )
+		{
+			LTContactInfo info;
+
+			//check for collision
+			if( a.Hit( info, *b, cif ) )
+			{
+				//if this collision occurred before
+				//the previous one, replace 'ci'
+				if( info.m_U < ci.m_U )
+					ci = info;
+			}
+		}
+
+		return true;
+	}
+};
+
+
+//---------------------------------------------------------------------------//
+//broadphase callback for Intersect(), stops when the array is full
+struct IntersectQuery
+{
+	LTIntersectInfo*					ii;
+	int32&								n;
+	const int32							N;
+	const ILTCollisionObject&			a;
+	const ILTCollisionObject::Filter&	of;
+	const LTIntersectInfo::Filter&		iif;
+
+	IntersectQuery
+	(
+		LTIntersectInfo*					ii,
+		int32&								n,
+		const int32							N,
+		const ILTCollisionObject&			a,
+		const ILTCollisionObject::Filter&	of,
+		const LTIntersectInfo::Filter&		iif
+	)
+		:	ii(ii), n(n), N(N), a(a), of(of), iif(iif)
+	{}
+
+	bool operator () ( const ILTCollisionObject* b )
+	{
+		LTIntersectInfo info;
+
+		//filter objects before expensive test
+		if( !is_self( a, *b ) && of.Condition( *b ) )
+		{
+			//check for intersection
+			if( a.Intersect( info, *b, iif ) )
+			{
+				//add to array
+				ii[n++] = info;
+
+				//don't exceed array
+				if( N==n )
+					return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+
+//---------------------------------------------------------------------------//
+//broadphase callback for IntersectSegment()
+struct SegmentQuery
+{
+	LTIntersectInfo*					ii;
+	int32&								n;
+	const int32							sz;
+	const LTVector3f&					p0;
+	const LTVector3f&					p1;
+	const ILTCollisionObject::Filter&	of;
+	const LTIntersectInfo::Filter&		iif;
+	bool								bIntersect;
+
+	SegmentQuery
+	(
+		LTIntersectInfo*					ii,
+		int32&								n,
+		const int32							sz,
+		const LTVector3f&					p0,
+		const LTVector3f&					p1,
+		const ILTCollisionObject::Filter&	of,
+		const LTIntersectInfo::Filter&		iif
+	)
+		:	ii(ii), n(n), sz(sz), p0(p0), p1(p1), of(of), iif(iif), bIntersect(false)
+	{}
+
+	bool operator () ( const ILTCollisionObject* o )
+	{
+		//filter objects before expensive test
+		if( of.Condition( *o ) )
+		{
+			//find segment intersections
+			if( o->IntersectSegment( ii, n, sz, p0, p1, iif ) )
+			{
+				//set flag
+				bIntersect = true;
+			}
+		}
+
+		return true;
+	}
+};
+
+
 //---------------------------------------------------------------------------//
 LTCollisionMgr::~LTCollisionMgr()
 {
@@ -31,6 +171,9 @@ LTCollisionMgr::~LTCollisionMgr()
 		i = m_Objects.erase(i);
 	}
 
+	m_Tree.Clear();
+	m_Proxies.clear();
+
 	//NOTE:  Collision objects allocated in an application DLL should
 	//have been deleted before that DLL goes out of scope, otherwise
 	//their v-tables are gone by the time this destructor is called.
@@ -53,6 +196,9 @@ void LTCollisionMgr::Term()
 		i = m_Objects.erase(i);
 	}
 
+	m_Tree.Clear();
+	m_Proxies.clear();
+
 	//NOTE:  Collision objects allocated in an application DLL should
 	//have been deleted before that DLL goes out of scope, otherwise
 	//their v-tables are gone by the time this destructor is called.
@@ -68,44 +214,16 @@ bool LTCollisionMgr::Collide
 	const LTContactInfo::Filter&		cif
 ) const
 {
-	//remove 'a' to prevent self-collision
-	ILTCollisionObject* pobj = NULL;
-
-	if( a.m_hObj )//don't remove static geometry
-		pobj = const_cast<LTCollisionMgr*>(this)->Remove( a.m_hObj );
-
 	//report the first collision that occurred (min u)
 	ci.m_U = 2;//ensure replacement
 
-	ObjectList::const_iterator i;
-
-	//check 'a' against every object in the collision DB
-	for( i = m_Objects.begin() ; i != m_Objects.end() ; i++ )
-	{
-		const ILTCollisionObject* b = *i;
-
-		//filter objects before expensive test
-		if( of.Condition( *b ) )
-		{
-			LTContactInfo info;
-
-			//check for collision
-			if( a.Hit( info, *b, cif ) )
-			{
-				//if this collision occurred before
-				//the previous one, replace 'ci'
-				if( info.m_U < ci.m_U )
-					ci = info;
-			}
-		}
-	}
+	//only check 'a' against objects whose bounds overlap
+	//its sweep, skipping 'a' itself
+	LTAABB box;
+	LTCollisionTree::ComputeBounds( box, a );
 
-	//put 'a' back into the list (pobj will
-	//be NULL if it wasn't in there before)
-	if( pobj )
-	{
-		const_cast<LTCollisionMgr*>(this)->Add( pobj );
-	}
+	CollideQuery q( ci, a, of, cif );
+	m_Tree.Query( box, q );
 
 	return (ci.m_U <= 1);//true if a collision occurred
 }
@@ -139,51 +257,17 @@ bool LTCollisionMgr::Intersect
 	const LTIntersectInfo::Filter&		iif
 ) const
 {
-	//remove 'a' to prevent self-collision
-	ILTCollisionObject* pobj = NULL;
-
-	if( a.m_hObj )//don't remove static geometry
-		pobj = const_cast<LTCollisionMgr*>(this)->Remove( a.m_hObj );
-
-	ObjectList::const_iterator i;
-	bool bIntersect = false;//did any intersections occur
-	LTIntersectInfo info;
-
 	n=0;//init count
 
-	//report all intersections between 'o'
-	//and every other object in the DB
-	for( i = m_Objects.begin() ; i != m_Objects.end() ; i++ )
-	{
-		const ILTCollisionObject* b = *i;
-
-		//filter objects before expensive test
-		if( of.Condition( *b ) )
-		{
-			//check for intersection
-			if( a.Intersect( info, *b, iif ) )
-			{
-				//set flag
-				bIntersect = true;
-
-				//add to array
-				ii[n++] = info;
+	//report all intersections between 'a' and every
+	//other object in the DB whose bounds overlap it
+	LTAABB box;
+	LTCollisionTree::ComputeBounds( box, a );
 
-				//don't exceed array
-				if( N==n )
-					break;
-			}
-		}
-	}
+	IntersectQuery q( ii, n, N, a, of, iif );
+	m_Tree.Query( box, q );
 
-	//put 'a' back into the list (pobj will
-	//be NULL if it wasn't in there before)
-	if( pobj )
-	{
-		const_cast<LTCollisionMgr*>(this)->Add( pobj );
-	}
-
-	return bIntersect;
+	return n > 0;
 }
 
 //---------------------------------------------------------------------------//
@@ -198,30 +282,14 @@ bool LTCollisionMgr::IntersectSegment
 	const LTIntersectInfo::Filter&		iif
 ) const
 {
-	bool bIntersect = false;
-	ObjectList::const_iterator i;
-
 	n=0;//init count
 
-	//report all intersections between the
-	//line segment and objects in the DB
-	for( i = m_Objects.begin() ; i != m_Objects.end() ; i++ )
-	{
-		const ILTCollisionObject* o = *i;
+	//report all intersections between the line segment
+	//and objects in the DB whose bounds it passes through
+	SegmentQuery q( ii, n, sz, p0, p1, of, iif );
+	m_Tree.QuerySegment( p0, p1, q );
 
-		//filter objects before expensive test
-		if( of.Condition( *o ) )
-		{
-			//find segment intersections
-			if( o->IntersectSegment( ii, n, sz, p0, p1, iif ) )
-			{
-				//set flag
-				bIntersect = true;
-			}
-		}
-	}
-
-	return bIntersect;
+	return q.bIntersect;
 }
 
 
@@ -233,6 +301,7 @@ void LTCollisionMgr::Add( ILTCollisionObject* o )
 #endif
 
 	m_Objects.push_back( o );
+	m_Proxies[o] = m_Tree.Insert( o );
 }
 
 
@@ -243,10 +312,46 @@ void LTCollisionMgr::Remove( ILTCollisionObject* o )
 	assert( o );
 #endif
 
+	ProxyMap::iterator p = m_Proxies.find( o );
+
+	if( p != m_Proxies.end() )
+	{
+		m_Tree.Remove( p->second );
+		m_Proxies.erase( p );
+	}
+
 	m_Objects.remove( o );
 }
 
 
+//---------------------------------------------------------------------------//
+void LTCollisionMgr::Update( ILTCollisionObject* o )
+{
+#ifndef __NO_INTERFACE_DB__
+	assert( o );
+#endif
+
+	ProxyMap::const_iterator p = m_Proxies.find( o );
+
+	if( p != m_Proxies.end() )
+		m_Tree.Update( p->second );
+}
+
+
+//---------------------------------------------------------------------------//
+void LTCollisionMgr::Move( ILTCollisionObject* o, const LTVector3f& p0, const LTVector3f& p1 )
+{
+#ifndef __NO_INTERFACE_DB__
+	assert( o );
+#endif
+
+	ProxyMap::const_iterator p = m_Proxies.find( o );
+
+	if( p != m_Proxies.end() )
+		m_Tree.Move( p->second, p0, p1 );
+}
+
+
 //---------------------------------------------------------------------------//
 ILTCollisionObject* LTCollisionMgr::Remove( const HOBJECT h )
 {
@@ -259,7 +364,7 @@ ILTCollisionObject* LTCollisionMgr::Remove( const HOBJECT h )
 
 		if( h == o->m_hObj )
 		{
-			m_Objects.remove(o);
+			this->Remove( o );
 			return o;
 		}
 	}
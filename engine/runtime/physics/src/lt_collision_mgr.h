@@ -5,11 +5,20 @@
 #include "collision_mgr.h"
 #endif
 
+#ifndef __LT_COLLISION_TREE_H__
+#include "lt_collision_tree.h"
+#endif
+
 #ifndef __LIST__
 #include <list>
 #define __LIST__
 #endif
 
+#ifndef __MAP__
+#include <map>
+#define __MAP__
+#endif
+
 
 //
 // Lithtech's ILTCollisionMgr Implementation
@@ -28,9 +37,17 @@ public:
     declare_interface(LTCollisionMgr);
 #endif
 
+    //ILTCollisionObject -> broadphase proxy id
+    typedef std::map<const ILTCollisionObject*,int32> ProxyMap;
+
     //A list of abstract collision objects
     ObjectList m_Objects;
 
+    //broadphase over m_Objects, queries only narrowphase
+    //against objects whose bounds overlap
+    LTCollisionTree m_Tree;
+    ProxyMap m_Proxies;
+
 public:
 
     LTCollisionMgr()
@@ -89,6 +106,12 @@ public:
 	//remove the collision object from the database
 	virtual void Remove( ILTCollisionObject* o );
 
+	//refresh the object's bounds after it moved
+	virtual void Update( ILTCollisionObject* o );
+
+	//refresh the object's bounds after the engine moved it from p0 to p1
+	virtual void Move( ILTCollisionObject* o, const LTVector3f& p0, const LTVector3f& p1 );
+
 
     //remove the collision object representing the LTObject
     virtual ILTCollisionObject* Remove(const HOBJECT h);
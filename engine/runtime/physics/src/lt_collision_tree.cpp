@@ -0,0 +1,490 @@
+#include "lt_collision_tree.h"
+
+
+//---------------------------------------------------------------------------//
+//fat boxes are padded by a fixed amount plus a fraction of their extent
+static const float s_FatMargin = 4.f;
+static const float s_FatScale = 0.1f;
+
+
+//---------------------------------------------------------------------------//
+//half the surface area of 'b' (the constant doesn't affect the heuristic)
+static inline float half_area( const LTAABB& b )
+{
+	const float dx = b.Max.x - b.Min.x;
+	const float dy = b.Max.y - b.Min.y;
+	const float dz = b.Max.z - b.Min.z;
+
+	return dx*dy + dy*dz + dz*dx;
+}
+
+
+//---------------------------------------------------------------------------//
+//true if 'outer' completely contains 'inner'
+static inline bool contains( const LTAABB& outer, const LTAABB& inner )
+{
+	return	outer.Min.x <= inner.Min.x && outer.Min.y <= inner.Min.y && outer.Min.z <= inner.Min.z
+		&&	inner.Max.x <= outer.Max.x && inner.Max.y <= outer.Max.y && inner.Max.z <= outer.Max.z;
+}
+
+
+//---------------------------------------------------------------------------//
+//pad a tight box out to a fat one
+static inline void fatten( LTAABB& fat, const LTAABB& tight )
+{
+	const LTVector3f m
+	(
+		s_FatMargin + s_FatScale * (tight.Max.x - tight.Min.x),
+		s_FatMargin + s_FatScale * (tight.Max.y - tight.Min.y),
+		s_FatMargin + s_FatScale * (tight.Max.z - tight.Min.z)
+	);
+
+	fat.Min = tight.Min - m;
+	fat.Max = tight.Max + m;
+}
+
+
+//---------------------------------------------------------------------------//
+LTCollisionTree::LTCollisionTree()
+	:	m_Root( NULL_NODE ), m_FreeList( NULL_NODE )
+{}
+
+
+//---------------------------------------------------------------------------//
+void LTCollisionTree::ComputeBounds( LTAABB& box, const ILTCollisionObject& o )
+{
+	//Use a bounding radius that doesn't depend on orientation, so that
+	//R0->R1 doesn't have to be swept.
+	const float r = ComputeRadius( o );
+	const LTVector3f e( r, r, r );
+
+	Union( box, LTAABB( o.m_P0 - e, o.m_P0 + e ), LTAABB( o.m_P1 - e, o.m_P1 + e ) );
+}
+
+
+//---------------------------------------------------------------------------//
+float LTCollisionTree::ComputeRadius( const ILTCollisionObject& o )
+{
+	//includes an offset for shapes that aren't centered on P
+	float r = 0;
+
+	switch( o.m_Type )
+	{
+		case COT_SPHERE:
+			r = static_cast<const LTCollisionSphere&>(o).m_Radius;
+			break;
+
+		case COT_BOX:
+			r = static_cast<const LTCollisionBox&>(o).m_Dim.Length();
+			break;
+
+		case COT_CYLINDER:
+		{
+			const LTCollisionCylinder& c = static_cast<const LTCollisionCylinder&>(o);
+
+			r = sqrtf( c.m_Radius*c.m_Radius + c.m_HHeight*c.m_HHeight );
+		}
+		break;
+
+		case COT_MESH:
+		{
+			const LTCollisionData* d = static_cast<const LTCollisionMesh&>(o).m_pData;
+
+			if( d )
+			{
+				//local bounds, so rotate about P
+				const LTVector3f c = 0.5f * (d->m_Min + d->m_Max);
+				const LTVector3f h = 0.5f * (d->m_Max - d->m_Min);
+
+				r = c.Length() + h.Length();
+			}
+		}
+		break;
+
+		default:
+			assert( !"LTCollisionTree::ComputeRadius():  unknown type" );
+			break;
+	}
+
+	return r;
+}
+
+
+//---------------------------------------------------------------------------//
+int32 LTCollisionTree::Insert( ILTCollisionObject* o )
+{
+	assert( o );
+
+	const int32 id = AllocateNode();
+	Node& nd = m_Nodes[id];
+
+	nd.pObj = o;
+	nd.P0 = o->m_P0;
+	nd.P1 = o->m_P1;
+	nd.Height = 0;
+
+	LTAABB tight;
+	LeafBounds( tight, id );
+	fatten( nd.Box, tight );
+
+	InsertLeaf( id );
+
+	return id;
+}
+
+
+//---------------------------------------------------------------------------//
+void LTCollisionTree::Remove( const int32 id )
+{
+	assert( 0 <= id && id < (int32)m_Nodes.size() );
+	assert( m_Nodes[id].IsLeaf() );
+
+	RemoveLeaf( id );
+	FreeNode( id );
+}
+
+
+//---------------------------------------------------------------------------//
+bool LTCollisionTree::Update( const int32 id )
+{
+	assert( 0 <= id && id < (int32)m_Nodes.size() );
+	assert( m_Nodes[id].IsLeaf() );
+
+	LTAABB tight;
+	LeafBounds( tight, id );
+
+	return Reinsert( id, tight );
+}
+
+
+//---------------------------------------------------------------------------//
+bool LTCollisionTree::Move( const int32 id, const LTVector3f& p0, const LTVector3f& p1 )
+{
+	assert( 0 <= id && id < (int32)m_Nodes.size() );
+	assert( m_Nodes[id].IsLeaf() );
+
+	m_Nodes[id].P0 = p0;
+	m_Nodes[id].P1 = p1;
+
+	LTAABB tight;
+	LeafBounds( tight, id );
+
+	return Reinsert( id, tight );
+}
+
+
+//---------------------------------------------------------------------------//
+void LTCollisionTree::LeafBounds( LTAABB& box, const int32 id ) const
+{
+	const Node& nd = m_Nodes[id];
+
+	//the game may not keep P0 and P1 up to date, and queries test against
+	//them, so cover where the engine last moved it too
+	LTAABB swept;
+	ComputeBounds( swept, *nd.pObj );
+
+	const float r = ComputeRadius( *nd.pObj );
+	const LTVector3f e( r, r, r );
+
+	LTAABB moved;
+	Union( moved, LTAABB( nd.P0 - e, nd.P0 + e ), LTAABB( nd.P1 - e, nd.P1 + e ) );
+
+	Union( box, swept, moved );
+}
+
+
+//---------------------------------------------------------------------------//
+bool LTCollisionTree::Reinsert( const int32 id, const LTAABB& tight )
+{
+	//still inside its fat box, nothing to do
+	if( contains( m_Nodes[id].Box, tight ) )
+		return false;
+
+	RemoveLeaf( id );
+	fatten( m_Nodes[id].Box, tight );
+	InsertLeaf( id );
+
+	return true;
+}
+
+
+//---------------------------------------------------------------------------//
+void LTCollisionTree::Clear()
+{
+	m_Nodes.clear();
+	m_Root = NULL_NODE;
+	m_FreeList = NULL_NODE;
+}
+
+
+//---------------------------------------------------------------------------//
+int32 LTCollisionTree::AllocateNode()
+{
+	int32 id;
+
+	if( m_FreeList != NULL_NODE )
+	{
+		id = m_FreeList;
+		m_FreeList = m_Nodes[id].Parent;
+	}
+	else
+	{
+		id = (int32)m_Nodes.size();
+		m_Nodes.push_back( Node() );
+	}
+
+	Node& nd = m_Nodes[id];
+
+	nd.pObj = NULL;
+	nd.Parent = NULL_NODE;
+	nd.Child1 = NULL_NODE;
+	nd.Child2 = NULL_NODE;
+	nd.Height = 0;
+
+	return id;
+}
+
+
+//---------------------------------------------------------------------------//
+void LTCollisionTree::FreeNode( const int32 id )
+{
+	Node& nd = m_Nodes[id];
+
+	nd.pObj = NULL;
+	nd.Parent = m_FreeList;
+	nd.Height = -1;
+
+	m_FreeList = id;
+}
+
+
+//---------------------------------------------------------------------------//
+void LTCollisionTree::InsertLeaf( const int32 leaf )
+{
+	if( m_Root == NULL_NODE )
+	{
+		m_Root = leaf;
+		m_Nodes[leaf].Parent = NULL_NODE;
+		return;
+	}
+
+	//find the best sibling by walking down the tree, picking the
+	//child that costs the least surface area to grow
+	const LTAABB leaf_box = m_Nodes[leaf].Box;
+	int32 index = m_Root;
+
+	while( !m_Nodes[index].IsLeaf() )
+	{
+		const Node& nd = m_Nodes[index];
+		const float area = half_area( nd.Box );
+
+		LTAABB combined;
+		Union( combined, nd.Box, leaf_box );
+		const float combined_area = half_area( combined );
+
+		//cost of pairing the leaf with this node
+		const float cost = 2 * combined_area;
+
+		//minimum cost of pushing the leaf further down
+		const float inherit = 2 * (combined_area - area);
+
+		float cost1, cost2;
+		const int32 child[2] = { nd.Child1, nd.Child2 };
+		float* child_cost[2] = { &cost1, &cost2 };
+
+		for( int32 i=0 ; i<2 ; i++ )
+		{
+			const Node& c = m_Nodes[ child[i] ];
+
+			Union( combined, c.Box, leaf_box );
+
+			if( c.IsLeaf() )
+				*child_cost[i] = half_area( combined ) + inherit;
+			else
+				*child_cost[i] = half_area( combined ) - half_area( c.Box ) + inherit;
+		}
+
+		//cheaper to make a new parent here
+		if( cost < cost1 && cost < cost2 )
+			break;
+
+		index = cost1 < cost2 ? nd.Child1 : nd.Child2;
+	}
+
+	const int32 sibling = index;
+
+	//make a new parent for the leaf and its sibling
+	const int32 old_parent = m_Nodes[sibling].Parent;
+	const int32 new_parent = AllocateNode();
+	{
+		Node& np = m_Nodes[new_parent];
+
+		np.Parent = old_parent;
+		Union( np.Box, leaf_box, m_Nodes[sibling].Box );
+		np.Height = m_Nodes[sibling].Height + 1;
+		np.Child1 = sibling;
+		np.Child2 = leaf;
+	}
+
+	if( old_parent != NULL_NODE )
+	{
+		if( m_Nodes[old_parent].Child1 == sibling )
+			m_Nodes[old_parent].Child1 = new_parent;
+		else
+			m_Nodes[old_parent].Child2 = new_parent;
+	}
+	else
+	{
+		m_Root = new_parent;
+	}
+
+	m_Nodes[sibling].Parent = new_parent;
+	m_Nodes[leaf].Parent = new_parent;
+
+	Refit( m_Nodes[leaf].Parent );
+}
+
+
+//---------------------------------------------------------------------------//
+void LTCollisionTree::RemoveLeaf( const int32 leaf )
+{
+	if( leaf == m_Root )
+	{
+		m_Root = NULL_NODE;
+		return;
+	}
+
+	const int32 parent = m_Nodes[leaf].Parent;
+	const int32 grand_parent = m_Nodes[parent].Parent;
+	const int32 sibling = m_Nodes[parent].Child1 == leaf ? m_Nodes[parent].Child2 : m_Nodes[parent].Child1;
+
+	if( grand_parent != NULL_NODE )
+	{
+		//replace the parent with the sibling
+		if( m_Nodes[grand_parent].Child1 == parent )
+			m_Nodes[grand_parent].Child1 = sibling;
+		else
+			m_Nodes[grand_parent].Child2 = sibling;
+
+		m_Nodes[sibling].Parent = grand_parent;
+		FreeNode( parent );
+
+		Refit( grand_parent );
+	}
+	else
+	{
+		m_Root = sibling;
+		m_Nodes[sibling].Parent = NULL_NODE;
+		FreeNode( parent );
+	}
+}
+
+
+//---------------------------------------------------------------------------//
+void LTCollisionTree::Refit( int32 id )
+{
+	while( id != NULL_NODE )
+	{
+		id = Balance( id );
+
+		Node& nd = m_Nodes[id];
+		const Node& c1 = m_Nodes[nd.Child1];
+		const Node& c2 = m_Nodes[nd.Child2];
+
+		nd.Height = 1 + Max( c1.Height, c2.Height );
+		Union( nd.Box, c1.Box, c2.Box );
+
+		id = nd.Parent;
+	}
+}
+
+
+//---------------------------------------------------------------------------//
+int32 LTCollisionTree::Balance( const int32 a )
+{
+	//      a
+	//    /   \
+	//   b     c
+	//        / \
+	//       f   g
+	//
+	//If 'c' is too tall, rotate it up into a's place (and the
+	//mirror image if 'b' is).
+	Node& A = m_Nodes[a];
+
+	if( A.IsLeaf() || A.Height < 2 )
+		return a;
+
+	const int32 b = A.Child1;
+	const int32 c = A.Child2;
+	const int32 balance = m_Nodes[c].Height - m_Nodes[b].Height;
+
+	//pick the tall child and the short one
+	int32 up, other;
+
+	if( balance > 1 )
+	{
+		up = c; other = b;
+	}
+	else if( balance < -1 )
+	{
+		up = b; other = c;
+	}
+	else
+	{
+		return a;
+	}
+
+	Node& U = m_Nodes[up];
+	const int32 f = U.Child1;
+	const int32 g = U.Child2;
+
+	//'up' takes a's place
+	U.Child1 = a;
+	U.Parent = A.Parent;
+	A.Parent = up;
+
+	if( U.Parent != NULL_NODE )
+	{
+		if( m_Nodes[U.Parent].Child1 == a )
+			m_Nodes[U.Parent].Child1 = up;
+		else
+			m_Nodes[U.Parent].Child2 = up;
+	}
+	else
+	{
+		m_Root = up;
+	}
+
+	//keep the taller grandchild under 'up', give the other to 'a'
+	int32 keep, give;
+
+	if( m_Nodes[f].Height > m_Nodes[g].Height )
+	{
+		keep = f; give = g;
+	}
+	else
+	{
+		keep = g; give = f;
+	}
+
+	U.Child2 = keep;
+
+	if( up == c )
+		A.Child2 = give;
+	else
+		A.Child1 = give;
+
+	m_Nodes[give].Parent = a;
+
+	Union( A.Box, m_Nodes[other].Box, m_Nodes[give].Box );
+	A.Height = 1 + Max( m_Nodes[other].Height, m_Nodes[give].Height );
+
+	Union( U.Box, A.Box, m_Nodes[keep].Box );
+	U.Height = 1 + Max( A.Height, m_Nodes[keep].Height );
+
+	return up;
+}
+
+
+//EOF
@@ -0,0 +1,222 @@
+#ifndef __LT_COLLISION_TREE_H__
+#define __LT_COLLISION_TREE_H__
+
+#ifndef __COLLISION_OBJECT_H__
+#include "collision_object.h"
+#endif
+
+#ifndef _AABB_H_
+#include "aabb.h"
+#endif
+
+#include <assert.h>
+
+#ifndef __VECTOR__
+#include <vector>
+#define __VECTOR__
+#endif
+
+
+//---------------------------------------------------------------------------//
+//
+// Broadphase for LTCollisionMgr:  a dynamic AABB tree over the swept bounds
+// of every collision object.  Leaves hold "fat" boxes that are a little
+// bigger than the object, so an object that moves a small amount doesn't
+// have to be re-inserted.  The tree is kept balanced with AVL-style
+// rotations as leaves are inserted and removed.
+//
+class LTCollisionTree
+{
+public:
+
+	//returned for "no node"
+	enum { NULL_NODE = -1 };
+
+	LTCollisionTree();
+
+	//insert 'o', returning its proxy id
+	int32 Insert( ILTCollisionObject* o );
+
+	//remove the proxy
+	void Remove( const int32 id );
+
+	//re-fit the proxy after its object moved, returns true if it was re-inserted
+	bool Update( const int32 id );
+
+	//record that the engine moved the proxy's object from p0 to p1, and
+	//re-fit it; returns true if it was re-inserted
+	bool Move( const int32 id, const LTVector3f& p0, const LTVector3f& p1 );
+
+	//remove everything
+	void Clear();
+
+	ILTCollisionObject* GetObject( const int32 id ) const
+	{
+		return m_Nodes[id].pObj;
+	}
+
+	//Call cb( ILTCollisionObject* ) for every object whose fat box overlaps
+	//'box'.  Stop early if cb returns false.
+	template< class CB >
+	void Query( const LTAABB& box, CB& cb ) const
+	{
+		BoxTest test( box );
+		Traverse( test, cb );
+	}
+
+	//Same as Query(), but for the line segment p0->p1.
+	template< class CB >
+	void QuerySegment( const LTVector3f& p0, const LTVector3f& p1, CB& cb ) const
+	{
+		SegmentTest test( p0, p1 );
+		Traverse( test, cb );
+	}
+
+	//The swept bounds of 'o' from p0 to p1.
+	static void ComputeBounds( LTAABB& box, const ILTCollisionObject& o );
+
+	//A bounding radius for 'o' about P that doesn't depend on orientation.
+	static float ComputeRadius( const ILTCollisionObject& o );
+
+	//box = a U b
+	static void Union( LTAABB& box, const LTAABB& a, const LTAABB& b )
+	{
+		box.Min.Init( Min( a.Min.x, b.Min.x ), Min( a.Min.y, b.Min.y ), Min( a.Min.z, b.Min.z ) );
+		box.Max.Init( Max( a.Max.x, b.Max.x ), Max( a.Max.y, b.Max.y ), Max( a.Max.z, b.Max.z ) );
+	}
+
+private:
+
+	//traversals that fit in this many pending nodes don't touch the heap
+	enum { k_StackSize = 64 };
+
+	struct BoxTest
+	{
+		const LTAABB& Box;
+
+		BoxTest( const LTAABB& box )
+			:	Box( box )
+		{}
+
+		bool operator()( const LTAABB& b ) const
+		{
+			return b.Intersects( Box );
+		}
+	};
+
+	struct SegmentTest
+	{
+		const LTVector3f& P0;
+		const LTVector3f& P1;
+		LTAABB SegBox;
+
+		SegmentTest( const LTVector3f& p0, const LTVector3f& p1 )
+			:	P0( p0 ), P1( p1 )
+		{
+			//cull with the segment's box before the exact segment test
+			Union( SegBox, LTAABB( p0, p0 ), LTAABB( p1, p1 ) );
+		}
+
+		bool operator()( const LTAABB& b ) const
+		{
+			return b.Intersects( SegBox ) && b.Intersects( P0, P1 );
+		}
+	};
+
+	//Depth first walk calling cb() on the leaves that pass test().  Each
+	//level leaves at most one sibling pending, so the stack never holds
+	//more than the root's height + 1 nodes.
+	template< class TEST, class CB >
+	void Traverse( const TEST& test, CB& cb ) const
+	{
+		if( m_Root == NULL_NODE )
+			return;
+
+		const int32 depth = m_Nodes[m_Root].Height + 1;
+
+		int32 local[k_StackSize];
+		std::vector<int32> heap;
+		int32* stack = local;
+
+		if( depth > k_StackSize )
+		{
+			heap.resize( depth );
+			stack = &heap[0];
+		}
+
+		int32 top = 0;
+		stack[top++] = m_Root;
+
+		while( top )
+		{
+			const Node& nd = m_Nodes[ stack[--top] ];
+
+			if( !test( nd.Box ) )
+				continue;
+
+			if( nd.IsLeaf() )
+			{
+				if( !cb( nd.pObj ) )
+					return;
+			}
+			else
+			{
+				assert( top + 2 <= depth );
+				stack[top++] = nd.Child1;
+				stack[top++] = nd.Child2;
+			}
+		}
+	}
+
+	struct Node
+	{
+		//fat box for leaves, union of the children otherwise
+		LTAABB Box;
+
+		//the object, NULL for internal nodes
+		ILTCollisionObject* pObj;
+
+		//the engine's record of the object's last move, kept apart from
+		//the object's own P0 and P1, which belong to the game
+		LTVector3f P0, P1;
+
+		//parent node, or the next free node when on the free list
+		int32 Parent;
+		int32 Child1, Child2;
+
+		//leaves are 0, free nodes are -1
+		int32 Height;
+
+		bool IsLeaf() const
+		{
+			return Child1 == NULL_NODE;
+		}
+	};
+
+	//the tight box for a leaf, covering both its object's sweep and the
+	//engine's record of its last move
+	void LeafBounds( LTAABB& box, const int32 id ) const;
+
+	//re-insert the leaf if it has left its fat box
+	bool Reinsert( const int32 id, const LTAABB& tight );
+
+	int32 AllocateNode();
+	void FreeNode( const int32 id );
+
+	void InsertLeaf( const int32 leaf );
+	void RemoveLeaf( const int32 leaf );
+
+	//rotate around 'a' if it's out of balance, returns the new subtree root
+	int32 Balance( const int32 a );
+
+	//walk up from 'id' fixing boxes and heights
+	void Refit( int32 id );
+
+	std::vector<Node> m_Nodes;
+	int32 m_Root;
+	int32 m_FreeList;
+};
+
+
+#endif
+//EOF
@@ -760,6 +760,9 @@ void DiligentSkelMesh::Reset()
 	m_indices_ref = {};
 	m_dynamic_streams.fill(false);
 	m_bone_transforms.clear();
+	m_skin_soa.Clear();
+	m_skin_palette.clear();
+	m_skin_bone_limit = 0;
 	for (uint32 i = 0; i < 4; ++i)
 	{
 		m_vert_stream_flags[i] = 0;
@@ -893,6 +896,7 @@ bool DiligentSkelMesh::Load(ILTStream& file, LTB_Header& header)
 	}
 
 	UpdateLayoutRefs();
+	BuildSkinSoA();
 	ReCreateObject();
 	return true;
 }
@@ -1024,236 +1028,184 @@ bool diligent_get_model_transform_raw(ModelInstance* instance, uint32 bone_index
 	return true;
 }
 
-bool diligent_get_model_transform_render(ModelInstance* instance, uint32 bone_index, LTMatrix& transform)
+void DiligentSkelMesh::BuildSkinSoA()
 {
-	if (!diligent_get_model_transform_raw(instance, bone_index, transform))
-	{
-		return false;
-	}
+	m_skin_soa.Clear();
+	m_skin_palette.clear();
+	m_skin_bone_limit = 0;
 
-	Model* model = instance->GetModelDB();
-	if (!model)
+	const uint32 weight_count = diligent_get_blend_weight_count(m_vert_type);
+	if (!m_position_ref.valid || !m_weights_ref.valid || weight_count == 0)
 	{
-		transform.Identity();
-		return false;
+		return;
 	}
 
-	// Match engine rendering transforms: remove bind-pose global transform.
-	transform = transform * model->GetNode(bone_index)->GetInvGlobalTransform();
-	return true;
-}
+	const bool has_normals = m_normal_ref.valid;
+	const uint32 influence_count = LTMIN(weight_count + 1, kDiligentMaxSkinInfluences);
+	m_skin_soa.Resize(m_vertex_count, influence_count, has_normals);
 
-bool DiligentSkelMesh::UpdateSkinnedVertices(ModelInstance* instance)
-{
-	if (!instance)
-	{
-		return false;
-	}
+	const uint8* positions = m_vertex_data[m_position_ref.stream_index].data() + m_position_ref.offset;
+	const uint8* weights = m_vertex_data[m_weights_ref.stream_index].data() + m_weights_ref.offset;
+	const uint8* indices = m_indices_ref.valid ? m_vertex_data[m_indices_ref.stream_index].data() + m_indices_ref.offset : nullptr;
+	const uint8* normals = has_normals ? m_vertex_data[m_normal_ref.stream_index].data() + m_normal_ref.offset : nullptr;
 
-	Model* model = instance->GetModelDB();
-	if (!model)
+	for (uint32 vert = 0; vert < m_vertex_count; ++vert)
 	{
-		return false;
-	}
+		const float* position = reinterpret_cast<const float*>(positions + m_position_ref.stride * vert);
+		m_skin_soa.position_x[vert] = position[0];
+		m_skin_soa.position_y[vert] = position[1];
+		m_skin_soa.position_z[vert] = position[2];
 
-	if (m_render_method == kRenderDirect)
-	{
-		if (!m_bone_transforms.empty())
+		if (normals)
 		{
-			return UpdateSkinnedVerticesDirect(m_bone_transforms);
+			const float* normal = reinterpret_cast<const float*>(normals + m_normal_ref.stride * vert);
+			m_skin_soa.normal_x[vert] = normal[0];
+			m_skin_soa.normal_y[vert] = normal[1];
+			m_skin_soa.normal_z[vert] = normal[2];
 		}
 
-		return false;
-	}
-
-	const uint32 bone_count = model->NumNodes();
-	if (bone_count == 0)
-	{
-		return false;
+		// The last weight isn't stored, it's whatever's left over.
+		const float* vert_weights = reinterpret_cast<const float*>(weights + m_weights_ref.stride * vert);
+		float remaining = 1.0f;
+		for (uint32 influence = 0; influence < influence_count; ++influence)
+		{
+			const float weight = influence < weight_count ? vert_weights[influence] : LTMAX(remaining, 0.0f);
+			m_skin_soa.weights[influence][vert] = weight;
+			m_skin_soa.bones[influence][vert] = indices ? indices[m_indices_ref.stride * vert + influence] : influence;
+			remaining -= weight;
+		}
 	}
 
-	if (m_bone_transforms.size() != bone_count)
+	if (m_render_method != kRenderMatrixPalettes)
 	{
-		m_bone_transforms.resize(bone_count);
+		UpdateSkinBoneLimit();
+		return;
 	}
 
-	for (uint32 bone_index = 0; bone_index < bone_count; ++bone_index)
+	// Resolve the per-vertex bone set slots to model node indices.
+	for (const DiligentBoneSet& bone_set : m_bone_sets)
 	{
-		LTMatrix transform;
-		if (!diligent_get_model_transform_render(instance, bone_index, transform))
+		const uint32 vert_end = LTMIN(static_cast<uint32>(bone_set.first_vert_index) + bone_set.vert_count, m_vertex_count);
+		for (uint32 vert = bone_set.first_vert_index; vert < vert_end; ++vert)
 		{
-			return false;
+			for (uint32 influence = 0; influence < influence_count; ++influence)
+			{
+				uint32& bone = m_skin_soa.bones[influence][vert];
+				if (bone < 4)
+				{
+					bone = bone_set.bone_set[bone];
+				}
+				else
+				{
+					bone = 0;
+					m_skin_soa.weights[influence][vert] = 0.0f;
+				}
+			}
 		}
-		m_bone_transforms[bone_index] = transform;
 	}
 
-	return UpdateSkinnedVerticesIndexed(m_bone_transforms);
+	UpdateSkinBoneLimit();
 }
 
-bool DiligentSkelMesh::UpdateSkinnedVerticesDirect(const std::vector<LTMatrix>& bone_transforms)
+void DiligentSkelMesh::UpdateSkinBoneLimit()
 {
-	if (!g_diligent_state.immediate_context)
+	m_skin_bone_limit = 0;
+	for (uint32 influence = 0; influence < m_skin_soa.influence_count; ++influence)
 	{
-		return false;
+		for (uint32 vert = 0; vert < m_skin_soa.vertex_count; ++vert)
+		{
+			m_skin_bone_limit = LTMAX(m_skin_bone_limit, m_skin_soa.bones[influence][vert] + 1);
+		}
 	}
+}
 
-	if (!m_position_ref.valid)
+bool DiligentSkelMesh::UpdateSkinnedVertices(ModelInstance* instance)
+{
+	if (!instance || !g_diligent_state.immediate_context)
 	{
 		return false;
 	}
 
-	const uint32 position_stream = m_position_ref.stream_index;
-	if (!m_vertex_buffers[position_stream] || m_vertex_data[position_stream].empty())
+	if (m_skin_soa.vertex_count == 0 || m_skin_soa.vertex_count != m_vertex_count)
 	{
 		return false;
 	}
 
-	const uint32 vertex_count = m_vertex_count;
-	const uint32 weight_count = diligent_get_blend_weight_count(m_vert_type);
-	if (weight_count == 0)
+	if (m_render_method == kRenderDirect)
 	{
-		return false;
-	}
+		if (m_bone_transforms.empty())
+		{
+			return false;
+		}
 
-	const uint32 weights_stream = m_weights_ref.stream_index;
-	const uint32 indices_stream = m_indices_ref.stream_index;
-	if (!m_vertex_buffers[weights_stream] || !m_vertex_buffers[indices_stream])
+		m_skin_palette.resize(m_bone_transforms.size());
+		for (uint32 bone_index = 0; bone_index < m_bone_transforms.size(); ++bone_index)
+		{
+			diligent_skin_matrix_from_ltmatrix(m_bone_transforms[bone_index], m_skin_palette[bone_index]);
+		}
+	}
+	else if (!diligent_get_model_skin_palette(instance, m_skin_palette))
 	{
 		return false;
 	}
 
-	void* mapped_position = nullptr;
-	g_diligent_state.immediate_context->MapBuffer(m_vertex_buffers[position_stream], Diligent::MAP_WRITE, Diligent::MAP_FLAG_DISCARD, mapped_position);
-	if (!mapped_position)
+	// Bones past the end of this palette get zero matrices, so their influences drop out of
+	// this frame's blend without touching the stored weights.
+	if (m_skin_palette.size() < m_skin_bone_limit)
 	{
-		return false;
+		m_skin_palette.resize(m_skin_bone_limit, DiligentSkinMatrix{});
 	}
 
-	const uint8* weights = m_vertex_data[weights_stream].data();
-	const uint8* indices = m_vertex_data[indices_stream].data();
-
-	const uint32 position_stride = m_position_ref.stride;
-	const uint32 weights_stride = m_weights_ref.stride;
-	const uint32 indices_stride = m_indices_ref.stride;
-
-	for (uint32 vert = 0; vert < vertex_count; ++vert)
+	// Dynamic buffers are discarded on map, so every dynamic stream gets its bind pose data
+	// copied back in and the skinned positions and normals written over the top.
+	std::array<uint8*, 4> mapped{};
+	bool mapped_all = true;
+	for (uint32 i = 0; i < 4; ++i)
 	{
-		const uint8* weights_ptr = weights + weights_stride * vert + m_weights_ref.offset;
-		const uint8* indices_ptr = indices + indices_stride * vert + m_indices_ref.offset;
-		float* out_position = reinterpret_cast<float*>(static_cast<uint8*>(mapped_position) + position_stride * vert + m_position_ref.offset);
-
-		LTVector final_pos(0.0f, 0.0f, 0.0f);
-		for (uint32 weight_index = 0; weight_index < weight_count; ++weight_index)
+		if (!m_dynamic_streams[i] || !m_vertex_buffers[i] || m_vertex_data[i].empty())
 		{
-			const uint8 bone_index = indices_ptr[weight_index];
-			if (bone_index >= bone_transforms.size())
-			{
-				continue;
-			}
-
-			const float weight = weights_ptr[weight_index] / 255.0f;
-			const LTMatrix& transform = bone_transforms[bone_index];
-			const LTVector position(out_position[0], out_position[1], out_position[2]);
-			LTVector transformed = diligent_transform_point(transform, position);
-			final_pos += transformed * weight;
+			continue;
 		}
 
-		out_position[0] = final_pos.x;
-		out_position[1] = final_pos.y;
-		out_position[2] = final_pos.z;
-	}
-
-	g_diligent_state.immediate_context->UnmapBuffer(m_vertex_buffers[position_stream], Diligent::MAP_WRITE);
-	return true;
-}
-
-bool DiligentSkelMesh::UpdateSkinnedVerticesIndexed(const std::vector<LTMatrix>& bone_transforms)
-{
-	if (!g_diligent_state.immediate_context)
-	{
-		return false;
-	}
-
-	if (!m_position_ref.valid)
-	{
-		return false;
-	}
+		void* data = nullptr;
+		g_diligent_state.immediate_context->MapBuffer(m_vertex_buffers[i], Diligent::MAP_WRITE, Diligent::MAP_FLAG_DISCARD, data);
+		if (!data)
+		{
+			mapped_all = false;
+			break;
+		}
 
-	const uint32 position_stream = m_position_ref.stream_index;
-	if (!m_vertex_buffers[position_stream] || m_vertex_data[position_stream].empty())
-	{
-		return false;
+		mapped[i] = static_cast<uint8*>(data);
+		std::memcpy(mapped[i], m_vertex_data[i].data(), m_vertex_data[i].size());
 	}
 
-	const uint32 vertex_count = m_vertex_count;
-	const uint32 weight_count = diligent_get_blend_weight_count(m_vert_type);
-	if (weight_count == 0)
+	if (mapped_all && mapped[m_position_ref.stream_index])
 	{
-		return false;
-	}
+		DiligentSkinOutput output;
+		output.position = mapped[m_position_ref.stream_index] + m_position_ref.offset;
+		output.position_stride = m_position_ref.stride;
+		if (m_skin_soa.HasNormals() && mapped[m_normal_ref.stream_index])
+		{
+			output.normal = mapped[m_normal_ref.stream_index] + m_normal_ref.offset;
+			output.normal_stride = m_normal_ref.stride;
+		}
 
-	const uint32 weights_stream = m_weights_ref.stream_index;
-	const uint32 indices_stream = m_indices_ref.stream_index;
-	if (!m_vertex_buffers[weights_stream] || !m_vertex_buffers[indices_stream])
-	{
-		return false;
+		diligent_skin_vertices(m_skin_soa, m_skin_palette.data(), output);
 	}
-
-	void* mapped_position = nullptr;
-	g_diligent_state.immediate_context->MapBuffer(m_vertex_buffers[position_stream], Diligent::MAP_WRITE, Diligent::MAP_FLAG_DISCARD, mapped_position);
-	if (!mapped_position)
+	else
 	{
-		return false;
+		mapped_all = false;
 	}
 
-	const uint8* weights = m_vertex_data[weights_stream].data();
-	const uint8* indices = m_vertex_data[indices_stream].data();
-
-	const uint32 position_stride = m_position_ref.stride;
-	const uint32 weights_stride = m_weights_ref.stride;
-	const uint32 indices_stride = m_indices_ref.stride;
-
-	for (uint32 set_index = 0; set_index < m_bone_sets.size(); ++set_index)
+	for (uint32 i = 0; i < 4; ++i)
 	{
-		const DiligentBoneSet& bone_set = m_bone_sets[set_index];
-		const uint32 vert_end = bone_set.first_vert_index + bone_set.vert_count;
-
-		for (uint32 vert = bone_set.first_vert_index; vert < vert_end && vert < vertex_count; ++vert)
+		if (mapped[i])
 		{
-			const uint8* weights_ptr = weights + weights_stride * vert + m_weights_ref.offset;
-			const uint8* indices_ptr = indices + indices_stride * vert + m_indices_ref.offset;
-			float* out_position = reinterpret_cast<float*>(static_cast<uint8*>(mapped_position) + position_stride * vert + m_position_ref.offset);
-
-			LTVector final_pos(0.0f, 0.0f, 0.0f);
-			for (uint32 weight_index = 0; weight_index < weight_count; ++weight_index)
-			{
-				const uint8 index = indices_ptr[weight_index];
-				if (index >= 4)
-				{
-					continue;
-				}
-
-				const uint8 bone_index = bone_set.bone_set[index];
-				if (bone_index >= bone_transforms.size())
-				{
-					continue;
-				}
-
-				const float weight = weights_ptr[weight_index] / 255.0f;
-				const LTMatrix& transform = bone_transforms[bone_index];
-				const LTVector position(out_position[0], out_position[1], out_position[2]);
-				LTVector transformed = diligent_transform_point(transform, position);
-				final_pos += transformed * weight;
-			}
-
-			out_position[0] = final_pos.x;
-			out_position[1] = final_pos.y;
-			out_position[2] = final_pos.z;
+			g_diligent_state.immediate_context->UnmapBuffer(m_vertex_buffers[i], Diligent::MAP_WRITE);
 		}
 	}
 
-	g_diligent_state.immediate_context->UnmapBuffer(m_vertex_buffers[position_stream], Diligent::MAP_WRITE);
-	return true;
+	return mapped_all;
 }
 
 DiligentVAMesh::DiligentVAMesh()
@@ -11,6 +11,7 @@
 
 #include "diligent_mesh_layout.h"
 #include "diligent_pipeline_cache.h"
+#include "diligent_skinning.h"
 
 #include "Common/interface/RefCntAutoPtr.hpp"
 #include "Graphics/GraphicsEngine/interface/Buffer.h"
@@ -116,8 +117,8 @@ private:
 	void Reset();
 	void FreeAll();
 	void UpdateLayoutRefs();
-	bool UpdateSkinnedVerticesDirect(const std::vector<LTMatrix>& bone_transforms);
-	bool UpdateSkinnedVerticesIndexed(const std::vector<LTMatrix>& bone_transforms);
+	void BuildSkinSoA();
+	void UpdateSkinBoneLimit();
 
 	RenderMethod m_render_method = kRenderDirect;
 	uint32 m_vertex_count = 0;
@@ -144,6 +145,9 @@ private:
 	DiligentVertexElementRef m_indices_ref;
 	std::array<bool, 4> m_dynamic_streams{};
 	std::vector<LTMatrix> m_bone_transforms;
+	DiligentSkinSoA m_skin_soa;
+	std::vector<DiligentSkinMatrix> m_skin_palette;
+	uint32 m_skin_bone_limit = 0;
 };
 
 /// Vertex-animated mesh implementation backed by Diligent buffers.
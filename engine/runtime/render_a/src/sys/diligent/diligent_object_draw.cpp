@@ -3,6 +3,7 @@
 #include "diligent_debug_draw.h"
 #include "diligent_internal.h"
 #include "diligent_device.h"
+#include "diligent_scene_collect.h"
 #include "diligent_texture_cache.h"
 #include "diligent_utils.h"
 #include "diligent_world_data.h"
@@ -21,6 +22,7 @@
 #include "world_client_bsp.h"
 #include "world_shared_bsp.h"
 #include "world_tree.h"
+#include "ltframearena.h"
 
 #include "../rendererconsolevars.h"
 
@@ -29,6 +31,7 @@
 #include <cfloat>
 #include <cmath>
 #include <cstring>
+#include <span>
 #include <vector>
 
 #include "Graphics/GraphicsEngine/interface/DeviceContext.h"
@@ -77,51 +80,6 @@ static uint32 diligent_pack_line_color(const LSLinePoint& point, float alpha_sca
 		static_cast<uint32>(b);
 }
 
-static float diligent_calc_draw_distance(const LTObject* object, const ViewParams& params)
-{
-	if (!object)
-	{
-		return 0.0f;
-	}
-
-	if ((object->m_Flags & FLAG_REALLYCLOSE) == 0)
-	{
-		return (object->GetPos() - params.m_Pos).MagSqr();
-	}
-
-	return object->GetPos().MagSqr();
-}
-
-template <typename TObject>
-static void diligent_sort_translucent_list(std::vector<TObject*>& objects, const ViewParams& params)
-{
-	if (!g_CV_DrawSorted.m_Val || objects.size() < 2)
-	{
-		return;
-	}
-
-	std::sort(objects.begin(), objects.end(), [&params](const TObject* a, const TObject* b)
-	{
-		if (!a || !b)
-		{
-			return a != nullptr;
-		}
-
-		const auto* obj_a = static_cast<const LTObject*>(a);
-		const auto* obj_b = static_cast<const LTObject*>(b);
-		const bool a_close = (obj_a->m_Flags & FLAG_REALLYCLOSE) != 0;
-		const bool b_close = (obj_b->m_Flags & FLAG_REALLYCLOSE) != 0;
-		if (a_close != b_close)
-		{
-			return !a_close && b_close;
-		}
-
-		const float dist_a = diligent_calc_draw_distance(obj_a, params);
-		const float dist_b = diligent_calc_draw_distance(obj_b, params);
-		return dist_a > dist_b;
-	});
-}
-
 DiligentWorldBlendMode diligent_get_object_blend_mode(const LTObject* object)
 {
 	if (!object)
@@ -665,16 +623,16 @@ bool diligent_draw_sprite_list(
 	float fog_far,
 	DiligentWorldDepthMode depth_mode)
 {
-	const std::vector<SpriteInstance*>* draw_list = &sprites;
-	std::vector<SpriteInstance*> sorted;
+	std::span<SpriteInstance* const> draw_list = sprites;
+	LTFrameVector<SpriteInstance*> sorted;
 	if (depth_mode == kWorldDepthEnabled && g_CV_DrawSorted.m_Val && sprites.size() > 1)
 	{
-		sorted = sprites;
+		sorted.assign(sprites.begin(), sprites.end());
 		diligent_sort_translucent_list(sorted, params);
-		draw_list = &sorted;
+		draw_list = sorted;
 	}
 
-	for (auto* sprite : *draw_list)
+	for (auto* sprite : draw_list)
 	{
 		if (!diligent_draw_sprite_instance(params, sprite, fog_near, fog_far, depth_mode))
 		{
@@ -685,6 +643,33 @@ bool diligent_draw_sprite_list(
 	return true;
 }
 
+// Packs particle colors for a batch straight from the arrays of a PS_ARRAYS
+// system.  Same as diligent_pack_particle_color.
+static void diligent_pack_particle_array_colors(
+	const LTParticleArrays& arrays,
+	const LTParticleSystem* system,
+	const uint32* particle_indices,
+	uint32 count,
+	uint32* colors)
+{
+	const float color_scale = 1.0f / 255.0f;
+	const float scale_r = static_cast<float>(system->m_ColorR) * color_scale;
+	const float scale_g = static_cast<float>(system->m_ColorG) * color_scale;
+	const float scale_b = static_cast<float>(system->m_ColorB) * color_scale;
+	const float alpha_scale = static_cast<float>(system->m_ColorA);
+
+	for (uint32 i = 0; i < count; ++i)
+	{
+		const uint32 index = particle_indices[i];
+		const uint32 r = static_cast<uint32>(LTCLAMP(arrays.m_pColorR[index] * scale_r, 0.0f, 255.0f));
+		const uint32 g = static_cast<uint32>(LTCLAMP(arrays.m_pColorG[index] * scale_g, 0.0f, 255.0f));
+		const uint32 b = static_cast<uint32>(LTCLAMP(arrays.m_pColorB[index] * scale_b, 0.0f, 255.0f));
+		const uint32 a = static_cast<uint32>(LTCLAMP(arrays.m_pAlpha[index] * alpha_scale, 0.0f, 255.0f));
+
+		colors[i] = (a << 24) | (r << 16) | (g << 8) | b;
+	}
+}
+
 uint32 diligent_pack_particle_color(const PSParticle* particle, const LTParticleSystem* system)
 {
 	if (!particle || !system)
@@ -736,6 +721,49 @@ const uint16* diligent_get_particle_indices()
 	return indices;
 }
 
+// Fills the four corners of a particle's quad.
+static void diligent_set_particle_quad(
+	DiligentWorldVertex* quad,
+	const LTVector& pos,
+	float size,
+	float angle,
+	uint32 color,
+	const LTVector& up,
+	const LTVector& right,
+	const LTVector& normal,
+	bool use_rotation)
+{
+	LTVector basis_up = up;
+	LTVector basis_right = right;
+	if (use_rotation)
+	{
+		basis_up = std::cos(angle) * up + std::sin(angle) * right;
+		basis_right = basis_up.Cross(normal);
+	}
+
+	const LTVector offsets[4] =
+	{
+		basis_up - basis_right,
+		basis_up + basis_right,
+		-basis_up + basis_right,
+		-basis_up - basis_right
+	};
+
+	static const float uvs[4][2] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+
+	for (int corner = 0; corner < 4; ++corner)
+	{
+		auto& v = quad[corner];
+		v.position[0] = pos.x + offsets[corner].x * size;
+		v.position[1] = pos.y + offsets[corner].y * size;
+		v.position[2] = pos.z + offsets[corner].z * size;
+		diligent_set_world_vertex_color(v, color);
+		v.uv0[0] = uvs[corner][0];
+		v.uv0[1] = uvs[corner][1];
+		diligent_set_world_vertex_normal(v, normal);
+	}
+}
+
 bool diligent_draw_particle_system_instance(
 	const ViewParams& params,
 	LTParticleSystem* system,
@@ -800,75 +828,70 @@ bool diligent_draw_particle_system_instance(
 	constexpr uint32 kParticleBatchSize = 64;
 	const uint16* indices = diligent_get_particle_indices();
 
+	// PS_ARRAYS systems are drawn straight from their arrays, in order or
+	// newest first.
+	const LTParticleArrays& arrays = system->m_ParticleArrays;
+	const bool use_arrays = (system->m_psFlags & PS_ARRAYS) != 0;
+	const bool reversed = (system->m_psFlags & PS_DRAWREVERSED) != 0;
+	uint32 array_index = 0;
+
 	PSParticle* particle = system->m_ParticleHead.m_pNext;
 	int remaining = system->m_nParticles;
-	while (remaining > 0 && particle != &system->m_ParticleHead)
+	while (remaining > 0 && (use_arrays || particle != &system->m_ParticleHead))
 	{
 		const int batch_count = LTMIN(remaining, static_cast<int>(kParticleBatchSize));
 		std::array<DiligentWorldVertex, kParticleBatchSize * 4> vertices{};
 
-		for (int i = 0; i < batch_count; ++i)
+		if (use_arrays)
 		{
-			const uint32 color = diligent_pack_particle_color(particle, system);
+			std::array<uint32, kParticleBatchSize> particle_indices;
+			std::array<uint32, kParticleBatchSize> colors;
 
-			LTVector basis_up = up;
-			LTVector basis_right = right;
-			if (use_rotation)
+			for (int i = 0; i < batch_count; ++i, ++array_index)
 			{
-				const float angle = particle->m_fAngle;
-				basis_up = std::cos(angle) * up + std::sin(angle) * right;
-				basis_right = basis_up.Cross(normal);
+				particle_indices[i] = reversed ? (arrays.m_nParticles - 1 - array_index) : array_index;
 			}
 
-			const LTVector offset_ul = basis_up - basis_right;
-			const LTVector offset_ur = basis_up + basis_right;
-			const LTVector offset_bl = -basis_up - basis_right;
-			const LTVector offset_br = -basis_up + basis_right;
-
-			const float size = particle->m_Size;
-			const LTVector& pos = particle->m_Pos;
-
-			auto& v0 = vertices[i * 4 + 0];
-			v0.position[0] = pos.x + offset_ul.x * size;
-			v0.position[1] = pos.y + offset_ul.y * size;
-			v0.position[2] = pos.z + offset_ul.z * size;
-			diligent_set_world_vertex_color(v0, color);
-			v0.uv0[0] = 0.0f;
-			v0.uv0[1] = 0.0f;
-			diligent_set_world_vertex_normal(v0, normal);
-
-			auto& v1 = vertices[i * 4 + 1];
-			v1.position[0] = pos.x + offset_ur.x * size;
-			v1.position[1] = pos.y + offset_ur.y * size;
-			v1.position[2] = pos.z + offset_ur.z * size;
-			diligent_set_world_vertex_color(v1, color);
-			v1.uv0[0] = 1.0f;
-			v1.uv0[1] = 0.0f;
-			diligent_set_world_vertex_normal(v1, normal);
-
-			auto& v2 = vertices[i * 4 + 2];
-			v2.position[0] = pos.x + offset_br.x * size;
-			v2.position[1] = pos.y + offset_br.y * size;
-			v2.position[2] = pos.z + offset_br.z * size;
-			diligent_set_world_vertex_color(v2, color);
-			v2.uv0[0] = 1.0f;
-			v2.uv0[1] = 1.0f;
-			diligent_set_world_vertex_normal(v2, normal);
-
-			auto& v3 = vertices[i * 4 + 3];
-			v3.position[0] = pos.x + offset_bl.x * size;
-			v3.position[1] = pos.y + offset_bl.y * size;
-			v3.position[2] = pos.z + offset_bl.z * size;
-			diligent_set_world_vertex_color(v3, color);
-			v3.uv0[0] = 0.0f;
-			v3.uv0[1] = 1.0f;
-			diligent_set_world_vertex_normal(v3, normal);
-
-			particle = particle->m_pNext;
-			--remaining;
-			if (particle == &system->m_ParticleHead)
+			diligent_pack_particle_array_colors(arrays, system, particle_indices.data(), batch_count, colors.data());
+
+			for (int i = 0; i < batch_count; ++i)
 			{
-				break;
+				const uint32 index = particle_indices[i];
+				diligent_set_particle_quad(
+					&vertices[i * 4],
+					LTVector(arrays.m_pPosX[index], arrays.m_pPosY[index], arrays.m_pPosZ[index]),
+					arrays.m_pSize[index],
+					arrays.m_pAngle[index],
+					colors[i],
+					up,
+					right,
+					normal,
+					use_rotation);
+			}
+
+			remaining -= batch_count;
+		}
+		else
+		{
+			for (int i = 0; i < batch_count; ++i)
+			{
+				diligent_set_particle_quad(
+					&vertices[i * 4],
+					particle->m_Pos,
+					particle->m_Size,
+					particle->m_fAngle,
+					diligent_pack_particle_color(particle, system),
+					up,
+					right,
+					normal,
+					use_rotation);
+
+				particle = particle->m_pNext;
+				--remaining;
+				if (particle == &system->m_ParticleHead)
+				{
+					break;
+				}
 			}
 		}
 
@@ -900,16 +923,16 @@ bool diligent_draw_particle_system_list(
 	float fog_far,
 	DiligentWorldDepthMode depth_mode)
 {
-	const std::vector<LTParticleSystem*>* draw_list = &systems;
-	std::vector<LTParticleSystem*> sorted_systems;
+	std::span<LTParticleSystem* const> draw_list = systems;
+	LTFrameVector<LTParticleSystem*> sorted_systems;
 	if (g_CV_DrawSorted.m_Val && systems.size() > 1)
 	{
-		sorted_systems = systems;
+		sorted_systems.assign(systems.begin(), systems.end());
 		diligent_sort_translucent_list(sorted_systems, params);
-		draw_list = &sorted_systems;
+		draw_list = sorted_systems;
 	}
 
-	for (auto* system : *draw_list)
+	for (auto* system : draw_list)
 	{
 		if (!diligent_draw_particle_system_instance(params, system, fog_near, fog_far, depth_mode))
 		{
@@ -1402,16 +1425,16 @@ bool diligent_draw_volume_effect_list(
 	DiligentWorldDepthMode depth_mode,
 	bool sort)
 {
-	const std::vector<LTVolumeEffect*>* draw_list = &effects;
-	std::vector<LTVolumeEffect*> sorted;
+	std::span<LTVolumeEffect* const> draw_list = effects;
+	LTFrameVector<LTVolumeEffect*> sorted;
 	if (sort && g_CV_DrawSorted.m_Val && effects.size() > 1)
 	{
-		sorted = effects;
+		sorted.assign(effects.begin(), effects.end());
 		diligent_sort_translucent_list(sorted, params);
-		draw_list = &sorted;
+		draw_list = sorted;
 	}
 
-	for (auto* effect : *draw_list)
+	for (auto* effect : draw_list)
 	{
 		if (!diligent_draw_volume_effect_instance(params, effect, fog_near, fog_far, depth_mode))
 		{
@@ -1440,8 +1463,17 @@ bool diligent_draw_line_system_instance(
 		return true;
 	}
 
+	// Size the vertex list up front so it's a single frame arena allocation,
+	// which is handed straight back when it goes out of scope.
+	size_t line_count = 0;
+	for (LSLine* counted = line; counted != &system->m_LineHead; counted = counted->m_pNext)
+	{
+		++line_count;
+	}
+
 	const float alpha_scale = static_cast<float>(system->m_ColorA);
-	std::vector<DiligentWorldVertex> vertices;
+	LTFrameVector<DiligentWorldVertex> vertices;
+	vertices.reserve(line_count * 2);
 	while (line != &system->m_LineHead)
 	{
 		for (uint32 i = 0; i < 2; ++i)
@@ -1488,16 +1520,16 @@ bool diligent_draw_line_system_list(
 	float fog_far,
 	DiligentWorldDepthMode depth_mode)
 {
-	const std::vector<LineSystem*>* draw_list = &systems;
-	std::vector<LineSystem*> sorted_systems;
+	std::span<LineSystem* const> draw_list = systems;
+	LTFrameVector<LineSystem*> sorted_systems;
 	if (g_CV_DrawSorted.m_Val && systems.size() > 1)
 	{
-		sorted_systems = systems;
+		sorted_systems.assign(systems.begin(), systems.end());
 		diligent_sort_translucent_list(sorted_systems, params);
-		draw_list = &sorted_systems;
+		draw_list = sorted_systems;
 	}
 
-	for (auto* system : *draw_list)
+	for (auto* system : draw_list)
 	{
 		if (!diligent_draw_line_system_instance(params, system, fog_near, fog_far, depth_mode))
 		{
@@ -1666,7 +1698,7 @@ bool diligent_draw_polygrid_instance(
 	const float v_inc = z_inc * z_scale * uv_scale;
 
 	LTMatrix world_matrix = diligent_build_transform(grid->GetPos(), grid->m_Rotation, LTVector(1.0f, 1.0f, 1.0f));
-	std::vector<DiligentWorldVertex> vertices;
+	LTFrameVector<DiligentWorldVertex> vertices;
 	vertices.reserve(static_cast<size_t>(grid->m_Width) * grid->m_Height);
 
 	int32 x_index = 0;
@@ -1813,16 +1845,16 @@ bool diligent_draw_polygrid_list(
 	DiligentWorldDepthMode depth_mode,
 	bool sort)
 {
-	const std::vector<LTPolyGrid*>* draw_list = &grids;
-	std::vector<LTPolyGrid*> sorted_grids;
+	std::span<LTPolyGrid* const> draw_list = grids;
+	LTFrameVector<LTPolyGrid*> sorted_grids;
 	if (sort)
 	{
-		sorted_grids = grids;
+		sorted_grids.assign(grids.begin(), grids.end());
 		diligent_sort_translucent_list(sorted_grids, params);
-		draw_list = &sorted_grids;
+		draw_list = sorted_grids;
 	}
 
-	for (auto* grid : *draw_list)
+	for (auto* grid : draw_list)
 	{
 		if (!diligent_draw_polygrid_instance(params, grid, fog_near, fog_far, depth_mode))
 		{
@@ -2934,16 +2966,16 @@ bool diligent_draw_solid_canvases_glow(SceneDesc* desc)
 
 bool diligent_draw_canvas_list(const std::vector<Canvas*>& canvases, bool sort, const ViewParams& params)
 {
-	const std::vector<Canvas*>* draw_list = &canvases;
-	std::vector<Canvas*> sorted_canvases;
+	std::span<Canvas* const> draw_list = canvases;
+	LTFrameVector<Canvas*> sorted_canvases;
 	if (sort && g_CV_DrawSorted.m_Val && canvases.size() > 1)
 	{
-		sorted_canvases = canvases;
+		sorted_canvases.assign(canvases.begin(), canvases.end());
 		diligent_sort_translucent_list(sorted_canvases, params);
-		draw_list = &sorted_canvases;
+		draw_list = sorted_canvases;
 	}
 
-	for (auto* canvas : *draw_list)
+	for (auto* canvas : draw_list)
 	{
 		if (canvas && canvas->m_Fn)
 		{
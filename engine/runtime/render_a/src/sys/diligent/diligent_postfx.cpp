@@ -2828,7 +2828,9 @@ bool diligent_render_screen_glow(SceneDesc* desc)
 	}
 
 	ViewParams saved_view = g_diligent_state.view_params;
-	std::vector<DiligentRenderBlock*> saved_blocks = g_visible_render_blocks;
+	// Kept between frames so saving the main view's blocks doesn't allocate.
+	static std::vector<DiligentRenderBlock*> saved_blocks;
+	saved_blocks.assign(g_visible_render_blocks.begin(), g_visible_render_blocks.end());
 
 	constexpr float kGlowNearZ = 7.0f;
 	float glow_far_z = g_CV_ScreenGlowFogEnable.m_Val ? g_CV_ScreenGlowFogFarZ.m_Val : g_CV_FarZ.m_Val;
@@ -2858,23 +2860,7 @@ bool diligent_render_screen_glow(SceneDesc* desc)
 	}
 
 	g_diligent_state.view_params = glow_params;
-	g_visible_render_blocks.clear();
-	if (g_render_world)
-	{
-		g_visible_render_blocks.reserve(g_render_world->render_blocks.size());
-		for (const auto& block : g_render_world->render_blocks)
-		{
-			if (!block)
-			{
-				continue;
-			}
-
-			if (g_diligent_state.view_params.ViewAABBIntersect(block->bounds_min, block->bounds_max))
-			{
-				g_visible_render_blocks.push_back(block.get());
-			}
-		}
-	}
+	diligent_collect_visible_render_blocks(g_diligent_state.view_params);
 
 	DiligentWorldConstants glow_constants;
 	LTMatrix glow_world;
@@ -4,6 +4,8 @@
 #include "diligent_device.h"
 #include "diligent_postfx.h"
 #include "diligent_render.h"
+#include "diligent_scene_collect.h"
+#include "diligent_skinning.h"
 #include "diligent_state.h"
 #include "diligent_model_draw.h"
 #include "diligent_texture_cache.h"
@@ -15,6 +17,7 @@
 #include "Graphics/GraphicsEngine/interface/GraphicsTypes.h"
 #include "Graphics/GraphicsEngine/interface/SwapChain.h"
 
+#include <cstdlib>
 #include <cstring>
 
 namespace
@@ -103,8 +106,32 @@ bool diligent_IsIn3D()
 	return g_diligent_state.is_in_3d;
 }
 
-void diligent_RenderCommand(int, const char**)
+void diligent_RenderCommand(int argc, const char** argv)
 {
+	if (argc < 1 || !argv || !argv[0])
+	{
+		return;
+	}
+
+	// SkinBench [vertex count] [bone count] [iterations]
+	if (stricmp(argv[0], "SkinBench") == 0)
+	{
+		const uint32 vertex_count = argc > 1 ? static_cast<uint32>(std::atoi(argv[1])) : 20000;
+		const uint32 bone_count = argc > 2 ? static_cast<uint32>(std::atoi(argv[2])) : 64;
+		const uint32 iterations = argc > 3 ? static_cast<uint32>(std::atoi(argv[3])) : 100;
+		diligent_skinning_benchmark(vertex_count, bone_count, iterations);
+		return;
+	}
+
+	// SceneBench [iterations]
+	if (stricmp(argv[0], "SceneBench") == 0)
+	{
+		const uint32 iterations = argc > 1 ? static_cast<uint32>(std::atoi(argv[1])) : 100;
+		diligent_scene_collect_benchmark(iterations);
+		return;
+	}
+
+	dsi_ConsolePrint("Diligent: unknown render command '%s'.", argv[0]);
 }
 
 void diligent_SwapBuffers(uint32)
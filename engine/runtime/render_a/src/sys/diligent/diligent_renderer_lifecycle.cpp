@@ -8,6 +8,7 @@
 #include "diligent_pipeline_cache.h"
 #include "diligent_postfx.h"
 #include "diligent_render_api.h"
+#include "diligent_scene_collect.h"
 #include "diligent_shadow_draw.h"
 #include "diligent_texture_cache.h"
 #include "diligent_world_data.h"
@@ -58,6 +59,7 @@ void diligent_Term(bool)
 	g_srb_cache.Reset();
 	g_render_world.reset();
 	g_visible_render_blocks.clear();
+	diligent_reset_scene_collect();
 	diligent_release_shadow_textures();
 	diligent_postfx_term();
 	diligent_render_api_term();
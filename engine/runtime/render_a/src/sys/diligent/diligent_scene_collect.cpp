@@ -17,6 +17,8 @@
 #include "../rendererconsolevars.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <vector>
 
 namespace
@@ -25,49 +27,147 @@ namespace
 std::vector<ModelInstance*> g_diligent_translucent_models;
 bool g_diligent_collect_translucent_models = false;
 
-float diligent_calc_draw_distance(const LTObject* object, const ViewParams& params)
+std::vector<DiligentSortEntry> g_diligent_sort_entries;
+std::vector<DiligentSortEntry> g_diligent_radix_scratch;
+
+// Node stack for the world tree walks.  A walk only touches the part above
+// where it started, so one can be started from inside another's visitor.
+std::vector<WorldTreeNode*> g_diligent_node_stack;
+
+// Render block bounds copied out of the blocks so culling runs over one flat
+// array.  Rebuilt when the render world changes.
+struct DiligentRenderBlockBounds
 {
-	if (!object)
+	LTVector min;
+	LTVector max;
+	DiligentRenderBlock* block;
+};
+
+std::vector<DiligentRenderBlockBounds> g_diligent_render_block_bounds;
+const DiligentRenderWorld* g_diligent_render_block_bounds_world = nullptr;
+
+// Lists below this size are insertion sorted; the radix passes cost more than
+// they save.
+constexpr uint32 kDiligentRadixSortMinCount = 32;
+
+void diligent_next_object_frame_code()
+{
+	if (g_diligent_state.render_struct && g_diligent_state.render_struct->IncObjectFrameCode)
 	{
-		return 0.0f;
+		g_diligent_state.object_frame_code = g_diligent_state.render_struct->IncObjectFrameCode();
 	}
-
-	if ((object->m_Flags & FLAG_REALLYCLOSE) == 0)
+	else
 	{
-		return (object->GetPos() - params.m_Pos).MagSqr();
+		++g_diligent_state.object_frame_code;
 	}
-
-	return object->GetPos().MagSqr();
 }
 
-template <typename TObject>
-void diligent_sort_translucent_list(std::vector<TObject*>& objects, const ViewParams& params)
+// Walks the nodes of a world tree that the view can see, in the same order as
+// a recursive walk, and calls visit on each object that passes filter and
+// whose box is in view.  filter is checked first since it's cheaper than the
+// box test.
+template <typename TFilter, typename TVisit>
+void diligent_walk_world_tree(const ViewParams& params, WorldTreeNode* root, TFilter&& filter, TVisit&& visit)
 {
-	if (!g_CV_DrawSorted.m_Val || objects.size() < 2)
+	if (!root)
 	{
 		return;
 	}
 
-	std::sort(objects.begin(), objects.end(), [&params](const TObject* a, const TObject* b)
+	const size_t stack_base = g_diligent_node_stack.size();
+	g_diligent_node_stack.push_back(root);
+	while (g_diligent_node_stack.size() > stack_base)
 	{
-		if (!a || !b)
+		WorldTreeNode* node = g_diligent_node_stack.back();
+		g_diligent_node_stack.pop_back();
+
+		WorldTreeObj* const* node_objects = node->GetObjects(NOA_Objects);
+		const uint32 node_object_count = node->GetNumObjects(NOA_Objects);
+		for (uint32 object_index = 0; object_index < node_object_count; ++object_index)
 		{
-			return a != nullptr;
+			auto* object = static_cast<LTObject*>(node_objects[object_index]);
+			if (!object || !filter(object))
+			{
+				continue;
+			}
+
+			const LTVector min = object->m_Pos - object->m_Dims;
+			const LTVector max = object->m_Pos + object->m_Dims;
+			if (!params.ViewAABBIntersect(min, max))
+			{
+				continue;
+			}
+
+			visit(object);
 		}
 
-		const auto* obj_a = static_cast<const LTObject*>(a);
-		const auto* obj_b = static_cast<const LTObject*>(b);
-		const bool a_close = (obj_a->m_Flags & FLAG_REALLYCLOSE) != 0;
-		const bool b_close = (obj_b->m_Flags & FLAG_REALLYCLOSE) != 0;
-		if (a_close != b_close)
+		if (!node->HasChildren())
 		{
-			return !a_close && b_close;
+			continue;
 		}
 
-		const float dist_a = diligent_calc_draw_distance(obj_a, params);
-		const float dist_b = diligent_calc_draw_distance(obj_b, params);
-		return dist_a > dist_b;
-	});
+		// Last child first, so the first child comes off the stack next.
+		for (uint32 child_index = MAX_WTNODE_CHILDREN; child_index-- > 0;)
+		{
+			WorldTreeNode* child = node->GetChild(child_index);
+			if (!child || child->GetNumObjectsOnOrBelow() == 0)
+			{
+				continue;
+			}
+
+			if (!params.ViewAABBIntersect(child->GetBBoxMin(), child->GetBBoxMax()))
+			{
+				continue;
+			}
+
+			g_diligent_node_stack.push_back(child);
+		}
+	}
+}
+
+template <typename TVisit>
+void diligent_visit_always_visible_objects(WorldTree* tree, TVisit&& visit)
+{
+	auto* list_head = tree->m_AlwaysVisObjects.AsDLink();
+	for (LTLink* current = list_head->m_pNext; current != list_head; current = current->m_pNext)
+	{
+		auto* object = static_cast<LTObject*>(current->m_pData);
+		if (object)
+		{
+			visit(object);
+		}
+	}
+}
+
+WorldTree* diligent_get_client_tree()
+{
+	auto* bsp_client = diligent_get_world_bsp_client();
+	return bsp_client ? bsp_client->ClientTree() : nullptr;
+}
+
+void diligent_update_render_block_bounds()
+{
+	const DiligentRenderWorld* world = g_render_world.get();
+	if (world == g_diligent_render_block_bounds_world)
+	{
+		return;
+	}
+
+	g_diligent_render_block_bounds.clear();
+	g_diligent_render_block_bounds_world = world;
+	if (!world)
+	{
+		return;
+	}
+
+	g_diligent_render_block_bounds.reserve(world->render_blocks.size());
+	for (const auto& block : world->render_blocks)
+	{
+		if (block)
+		{
+			g_diligent_render_block_bounds.push_back({block->bounds_min, block->bounds_max, block.get()});
+		}
+	}
 }
 
 void diligent_process_model_attachments(LTObject* object, uint32 depth)
@@ -220,148 +320,19 @@ void diligent_process_light_object(LTObject* object)
 	g_diligent_world_dynamic_lights[g_diligent_num_world_dynamic_lights++] = light;
 }
 
-void diligent_collect_world_dynamic_lights(const ViewParams& params, WorldTreeNode* node)
+bool diligent_is_light_object(const LTObject* object)
 {
-	if (!node)
-	{
-		return;
-	}
-
-	auto* list_head = node->m_Objects[NOA_Objects].AsDLink();
-	for (LTLink* current = list_head->m_pNext; current != list_head; current = current->m_pNext)
-	{
-		auto* object = static_cast<LTObject*>(current->m_pData);
-		if (!object || object->m_ObjectType != OT_LIGHT)
-		{
-			continue;
-		}
-
-		const LTVector min = object->m_Pos - object->m_Dims;
-		const LTVector max = object->m_Pos + object->m_Dims;
-		if (!params.ViewAABBIntersect(min, max))
-		{
-			continue;
-		}
-
-		diligent_process_light_object(object);
-	}
-
-	if (!node->HasChildren())
-	{
-		return;
-	}
-
-	for (uint32 child_index = 0; child_index < MAX_WTNODE_CHILDREN; ++child_index)
-	{
-		WorldTreeNode* child = node->GetChild(child_index);
-		if (!child || child->GetNumObjectsOnOrBelow() == 0)
-		{
-			continue;
-		}
-
-		if (!params.ViewAABBIntersect(child->GetBBoxMin(), child->GetBBoxMax()))
-		{
-			continue;
-		}
-
-		diligent_collect_world_dynamic_lights(params, child);
-	}
+	return object->m_ObjectType == OT_LIGHT;
 }
 
-void diligent_filter_world_node_for_models(const ViewParams& params, WorldTreeNode* node)
+bool diligent_is_any_object(const LTObject*)
 {
-	if (!node)
-	{
-		return;
-	}
-
-	auto* list_head = node->m_Objects[NOA_Objects].AsDLink();
-	for (LTLink* current = list_head->m_pNext; current != list_head; current = current->m_pNext)
-	{
-		auto* object = static_cast<LTObject*>(current->m_pData);
-		if (!object)
-		{
-			continue;
-		}
-
-		const LTVector min = object->m_Pos - object->m_Dims;
-		const LTVector max = object->m_Pos + object->m_Dims;
-		if (!params.ViewAABBIntersect(min, max))
-		{
-			continue;
-		}
-
-		diligent_process_model_object(object);
-	}
-
-	if (!node->HasChildren())
-	{
-		return;
-	}
-
-	for (uint32 child_index = 0; child_index < MAX_WTNODE_CHILDREN; ++child_index)
-	{
-		WorldTreeNode* child = node->GetChild(child_index);
-		if (!child || child->GetNumObjectsOnOrBelow() == 0)
-		{
-			continue;
-		}
-
-		if (!params.ViewAABBIntersect(child->GetBBoxMin(), child->GetBBoxMax()))
-		{
-			continue;
-		}
-
-		diligent_filter_world_node_for_models(params, child);
-	}
+	return true;
 }
 
-void diligent_filter_world_node_for_world_models(const ViewParams& params, WorldTreeNode* node)
+bool diligent_has_world_model(const LTObject* object)
 {
-	if (!node)
-	{
-		return;
-	}
-
-	auto* list_head = node->m_Objects[NOA_Objects].AsDLink();
-	for (LTLink* current = list_head->m_pNext; current != list_head; current = current->m_pNext)
-	{
-		auto* object = static_cast<LTObject*>(current->m_pData);
-		if (!object || !object->HasWorldModel())
-		{
-			continue;
-		}
-
-		const LTVector min = object->m_Pos - object->m_Dims;
-		const LTVector max = object->m_Pos + object->m_Dims;
-		if (!params.ViewAABBIntersect(min, max))
-		{
-			continue;
-		}
-
-		diligent_process_world_model_object(object);
-	}
-
-	if (!node->HasChildren())
-	{
-		return;
-	}
-
-	for (uint32 child_index = 0; child_index < MAX_WTNODE_CHILDREN; ++child_index)
-	{
-		WorldTreeNode* child = node->GetChild(child_index);
-		if (!child || child->GetNumObjectsOnOrBelow() == 0)
-		{
-			continue;
-		}
-
-		if (!params.ViewAABBIntersect(child->GetBBoxMin(), child->GetBBoxMax()))
-		{
-			continue;
-		}
-
-		diligent_filter_world_node_for_world_models(params, child);
-	}
+	return object->HasWorldModel();
 }
 
 } // namespace
@@ -447,14 +418,7 @@ bool diligent_draw_models(SceneDesc* desc)
 			return true;
 		}
 
-		if (g_diligent_state.render_struct && g_diligent_state.render_struct->IncObjectFrameCode)
-		{
-			g_diligent_state.object_frame_code = g_diligent_state.render_struct->IncObjectFrameCode();
-		}
-		else
-		{
-			++g_diligent_state.object_frame_code;
-		}
+		diligent_next_object_frame_code();
 
 		for (int i = 0; i < desc->m_ObjectListSize; ++i)
 		{
@@ -469,48 +433,17 @@ bool diligent_draw_models(SceneDesc* desc)
 	}
 	else
 	{
-		if (desc->m_DrawMode != DRAWMODE_NORMAL)
-		{
-			g_diligent_collect_translucent_models = false;
-			return true;
-		}
-
-		auto* bsp_client = diligent_get_world_bsp_client();
-		if (!bsp_client)
-		{
-			g_diligent_collect_translucent_models = false;
-			return true;
-		}
-
-		WorldTree* tree = bsp_client->ClientTree();
+		WorldTree* tree = desc->m_DrawMode == DRAWMODE_NORMAL ? diligent_get_client_tree() : nullptr;
 		if (!tree)
 		{
 			g_diligent_collect_translucent_models = false;
 			return true;
 		}
 
-		if (g_diligent_state.render_struct && g_diligent_state.render_struct->IncObjectFrameCode)
-		{
-			g_diligent_state.object_frame_code = g_diligent_state.render_struct->IncObjectFrameCode();
-		}
-		else
-		{
-			++g_diligent_state.object_frame_code;
-		}
-
-		diligent_filter_world_node_for_models(g_diligent_state.view_params, tree->GetRootNode());
-
-		auto* list_head = tree->m_AlwaysVisObjects.AsDLink();
-		for (LTLink* current = list_head->m_pNext; current != list_head; current = current->m_pNext)
-		{
-			auto* object = static_cast<LTObject*>(current->m_pData);
-			if (!object)
-			{
-				continue;
-			}
+		diligent_next_object_frame_code();
 
-			diligent_process_model_object(object);
-		}
+		diligent_walk_world_tree(g_diligent_state.view_params, tree->GetRootNode(), diligent_is_any_object, diligent_process_model_object);
+		diligent_visit_always_visible_objects(tree, diligent_process_model_object);
 	}
 
 	g_diligent_collect_translucent_models = false;
@@ -546,14 +479,7 @@ void diligent_collect_world_models(SceneDesc* desc)
 		return;
 	}
 
-	if (g_diligent_state.render_struct && g_diligent_state.render_struct->IncObjectFrameCode)
-	{
-		g_diligent_state.object_frame_code = g_diligent_state.render_struct->IncObjectFrameCode();
-	}
-	else
-	{
-		++g_diligent_state.object_frame_code;
-	}
+	diligent_next_object_frame_code();
 
 	if (desc->m_DrawMode == DRAWMODE_OBJECTLIST)
 	{
@@ -576,57 +502,27 @@ void diligent_collect_world_models(SceneDesc* desc)
 		return;
 	}
 
-	if (desc->m_DrawMode != DRAWMODE_NORMAL)
-	{
-		return;
-	}
-
-	auto* bsp_client = diligent_get_world_bsp_client();
-	if (!bsp_client)
-	{
-		return;
-	}
-
-	WorldTree* tree = bsp_client->ClientTree();
+	WorldTree* tree = desc->m_DrawMode == DRAWMODE_NORMAL ? diligent_get_client_tree() : nullptr;
 	if (!tree)
 	{
 		return;
 	}
 
-	diligent_filter_world_node_for_world_models(g_diligent_state.view_params, tree->GetRootNode());
-
-	auto* list_head = tree->m_AlwaysVisObjects.AsDLink();
-	for (LTLink* current = list_head->m_pNext; current != list_head; current = current->m_pNext)
-	{
-		auto* object = static_cast<LTObject*>(current->m_pData);
-		if (!object)
-		{
-			continue;
-		}
-
-		diligent_process_world_model_object(object);
-	}
+	diligent_walk_world_tree(g_diligent_state.view_params, tree->GetRootNode(), diligent_has_world_model, diligent_process_world_model_object);
+	diligent_visit_always_visible_objects(tree, diligent_process_world_model_object);
 }
 
 void diligent_collect_visible_render_blocks(const ViewParams& params)
 {
 	g_visible_render_blocks.clear();
-	if (!g_render_world)
-	{
-		return;
-	}
+	diligent_update_render_block_bounds();
 
-	g_visible_render_blocks.reserve(g_render_world->render_blocks.size());
-	for (const auto& block : g_render_world->render_blocks)
+	g_visible_render_blocks.reserve(g_diligent_render_block_bounds.size());
+	for (const auto& bounds : g_diligent_render_block_bounds)
 	{
-		if (!block)
+		if (params.ViewAABBIntersect(bounds.min, bounds.max))
 		{
-			continue;
-		}
-
-		if (params.ViewAABBIntersect(block->bounds_min, block->bounds_max))
-		{
-			g_visible_render_blocks.push_back(block.get());
+			g_visible_render_blocks.push_back(bounds.block);
 		}
 	}
 }
@@ -657,30 +553,256 @@ void diligent_collect_scene_dynamic_lights(SceneDesc* desc, const ViewParams& pa
 	}
 	else if (desc->m_DrawMode == DRAWMODE_NORMAL)
 	{
-		auto* bsp_client = diligent_get_world_bsp_client();
-		if (!bsp_client)
-		{
-			return;
-		}
-
-		WorldTree* tree = bsp_client->ClientTree();
+		WorldTree* tree = diligent_get_client_tree();
 		if (!tree)
 		{
 			return;
 		}
 
-		diligent_collect_world_dynamic_lights(params, tree->GetRootNode());
+		diligent_walk_world_tree(params, tree->GetRootNode(), diligent_is_light_object, diligent_process_light_object);
+		diligent_visit_always_visible_objects(tree, diligent_process_light_object);
+	}
+}
 
-		auto* list_head = tree->m_AlwaysVisObjects.AsDLink();
-		for (LTLink* current = list_head->m_pNext; current != list_head; current = current->m_pNext)
+void diligent_reset_scene_collect()
+{
+	g_diligent_render_block_bounds.clear();
+	g_diligent_render_block_bounds_world = nullptr;
+	g_diligent_translucent_models.clear();
+}
+
+uint32 diligent_calc_translucent_sort_key(const LTObject* object, const ViewParams& params)
+{
+	if (!object)
+	{
+		return 0xFFFFFFFFu;
+	}
+
+	const bool close = (object->m_Flags & FLAG_REALLYCLOSE) != 0;
+	const float distance = close ? object->GetPos().MagSqr() : (object->GetPos() - params.m_Pos).MagSqr();
+
+	// The bits of a non-negative float order the same way as its value, so
+	// subtracting them from infinity's gives a key that's smallest for the
+	// farthest objects.  Anything past infinity (NaNs) is clamped to it.
+	uint32 distance_bits = 0;
+	std::memcpy(&distance_bits, &distance, sizeof(distance_bits));
+	distance_bits = LTMIN(distance_bits, 0x7F800000u);
+
+	return (close ? 0x80000000u : 0u) | (0x7F800000u - distance_bits);
+}
+
+void diligent_radix_sort(DiligentSortEntry* entries, uint32 count)
+{
+	if (count < 2)
+	{
+		return;
+	}
+
+	if (count < kDiligentRadixSortMinCount)
+	{
+		for (uint32 i = 1; i < count; ++i)
 		{
-			auto* object = static_cast<LTObject*>(current->m_pData);
-			if (!object)
+			const DiligentSortEntry entry = entries[i];
+			uint32 j = i;
+			for (; j > 0 && entries[j - 1].key > entry.key; --j)
 			{
-				continue;
+				entries[j] = entries[j - 1];
 			}
+			entries[j] = entry;
+		}
+		return;
+	}
+
+	// One pass over the keys fills in the histograms for all four digits.
+	uint32 histograms[4][256] = {};
+	for (uint32 i = 0; i < count; ++i)
+	{
+		const uint32 key = entries[i].key;
+		++histograms[0][key & 0xFF];
+		++histograms[1][(key >> 8) & 0xFF];
+		++histograms[2][(key >> 16) & 0xFF];
+		++histograms[3][key >> 24];
+	}
+
+	if (g_diligent_radix_scratch.size() < count)
+	{
+		g_diligent_radix_scratch.resize(count);
+	}
+
+	DiligentSortEntry* source = entries;
+	DiligentSortEntry* dest = g_diligent_radix_scratch.data();
+	for (uint32 digit = 0; digit < 4; ++digit)
+	{
+		const uint32 shift = digit * 8;
+		uint32* histogram = histograms[digit];
+
+		// Every key has the same digit here, so the pass wouldn't move anything.
+		if (histogram[(source[0].key >> shift) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		uint32 offset = 0;
+		for (uint32 bucket = 0; bucket < 256; ++bucket)
+		{
+			const uint32 bucket_count = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucket_count;
+		}
+
+		for (uint32 i = 0; i < count; ++i)
+		{
+			dest[histogram[(source[i].key >> shift) & 0xFF]++] = source[i];
+		}
+
+		std::swap(source, dest);
+	}
+
+	if (source != entries)
+	{
+		std::memcpy(entries, source, count * sizeof(DiligentSortEntry));
+	}
+}
+
+bool diligent_translucent_sort_enabled()
+{
+	return g_CV_DrawSorted.m_Val != 0;
+}
+
+std::vector<DiligentSortEntry>& diligent_get_sort_entries()
+{
+	return g_diligent_sort_entries;
+}
+
+void diligent_scene_collect_benchmark(uint32 iterations)
+{
+	iterations = LTMAX(iterations, 1u);
+
+	WorldTree* tree = diligent_get_client_tree();
+	if (!tree)
+	{
+		dsi_ConsolePrint("SceneBench: no world loaded");
+		return;
+	}
 
-			diligent_process_light_object(object);
+	// The captured scene is the last frame's view over the client tree as it
+	// stands.  Nothing is drawn and the renderer's own lists are left alone.
+	const ViewParams params = g_diligent_state.view_params;
+
+	std::vector<LTObject*> models;
+	std::vector<LTObject*> world_models;
+	const auto collect_model = [&models](LTObject* object)
+	{
+		if (diligent_should_process_model(object))
+		{
+			object->m_WTFrameCode = g_diligent_state.object_frame_code;
+			models.push_back(object);
+		}
+	};
+	const auto collect_world_model = [&world_models](LTObject* object)
+	{
+		if (diligent_should_process_world_model(object))
+		{
+			object->m_WTFrameCode = g_diligent_state.object_frame_code;
+			world_models.push_back(object);
 		}
+	};
+
+	auto start = std::chrono::steady_clock::now();
+	for (uint32 iteration = 0; iteration < iterations; ++iteration)
+	{
+		models.clear();
+		world_models.clear();
+
+		diligent_next_object_frame_code();
+		diligent_walk_world_tree(params, tree->GetRootNode(), diligent_is_any_object, collect_model);
+		diligent_visit_always_visible_objects(tree, collect_model);
+
+		diligent_next_object_frame_code();
+		diligent_walk_world_tree(params, tree->GetRootNode(), diligent_has_world_model, collect_world_model);
+		diligent_visit_always_visible_objects(tree, collect_world_model);
 	}
+	auto stop = std::chrono::steady_clock::now();
+	const double walk_ms = std::chrono::duration<double, std::milli>(stop - start).count() / iterations;
+
+	const std::vector<DiligentRenderBlock*> saved_blocks = g_visible_render_blocks;
+	start = std::chrono::steady_clock::now();
+	for (uint32 iteration = 0; iteration < iterations; ++iteration)
+	{
+		diligent_collect_visible_render_blocks(params);
+	}
+	stop = std::chrono::steady_clock::now();
+	const double cull_ms = std::chrono::duration<double, std::milli>(stop - start).count() / iterations;
+	const size_t visible_block_count = g_visible_render_blocks.size();
+	g_visible_render_blocks = saved_blocks;
+
+	// Sort every visible object as if it were translucent, so there's enough
+	// to measure.
+	std::vector<LTObject*> objects = models;
+	objects.insert(objects.end(), world_models.begin(), world_models.end());
+
+	// The comparator sort the lists used to get, distances worked out inside
+	// the comparator.
+	const auto comparator_less = [&params](const LTObject* a, const LTObject* b)
+	{
+		if (!a || !b)
+		{
+			return a != nullptr;
+		}
+
+		const bool a_close = (a->m_Flags & FLAG_REALLYCLOSE) != 0;
+		const bool b_close = (b->m_Flags & FLAG_REALLYCLOSE) != 0;
+		if (a_close != b_close)
+		{
+			return !a_close && b_close;
+		}
+
+		const float dist_a = a_close ? a->GetPos().MagSqr() : (a->GetPos() - params.m_Pos).MagSqr();
+		const float dist_b = b_close ? b->GetPos().MagSqr() : (b->GetPos() - params.m_Pos).MagSqr();
+		return dist_a > dist_b;
+	};
+
+	std::vector<LTObject*> comparator_sorted;
+	start = std::chrono::steady_clock::now();
+	for (uint32 iteration = 0; iteration < iterations; ++iteration)
+	{
+		comparator_sorted.assign(objects.begin(), objects.end());
+		std::stable_sort(comparator_sorted.begin(), comparator_sorted.end(), comparator_less);
+	}
+	stop = std::chrono::steady_clock::now();
+	const double comparator_ms = std::chrono::duration<double, std::milli>(stop - start).count() / iterations;
+
+	std::vector<DiligentSortEntry> entries;
+	start = std::chrono::steady_clock::now();
+	for (uint32 iteration = 0; iteration < iterations; ++iteration)
+	{
+		entries.resize(objects.size());
+		for (size_t i = 0; i < objects.size(); ++i)
+		{
+			entries[i].key = diligent_calc_translucent_sort_key(objects[i], params);
+			entries[i].object = objects[i];
+		}
+		diligent_radix_sort(entries.data(), static_cast<uint32>(entries.size()));
+	}
+	stop = std::chrono::steady_clock::now();
+	const double radix_ms = std::chrono::duration<double, std::milli>(stop - start).count() / iterations;
+
+	// Both sorts are stable, so they should agree exactly.
+	uint32 mismatches = 0;
+	for (size_t i = 0; i < objects.size(); ++i)
+	{
+		if (entries[i].object != comparator_sorted[i])
+		{
+			++mismatches;
+		}
+	}
+
+	dsi_ConsolePrint("SceneBench: %u passes, %u models, %u world models, %u/%u render blocks visible",
+		iterations, static_cast<uint32>(models.size()), static_cast<uint32>(world_models.size()),
+		static_cast<uint32>(visible_block_count), static_cast<uint32>(g_diligent_render_block_bounds.size()));
+	dsi_ConsolePrint("SceneBench: object walk  %8.3f ms/pass", walk_ms);
+	dsi_ConsolePrint("SceneBench: block cull   %8.3f ms/pass", cull_ms);
+	dsi_ConsolePrint("SceneBench: sort (old)   %8.3f ms/pass", comparator_ms);
+	dsi_ConsolePrint("SceneBench: sort (radix) %8.3f ms/pass  %5.2fx  %u mismatches",
+		radix_ms, radix_ms > 0.0 ? comparator_ms / radix_ms : 0.0, mismatches);
 }
@@ -9,6 +9,10 @@
 #ifndef LTJS_DILIGENT_SCENE_COLLECT_H
 #define LTJS_DILIGENT_SCENE_COLLECT_H
 
+#include "ltbasetypes.h"
+
+#include <vector>
+
 struct DiligentRenderWorld;
 struct SceneDesc;
 struct ViewParams;
@@ -33,5 +37,59 @@ void diligent_collect_world_models(SceneDesc* desc);
 void diligent_collect_visible_render_blocks(const ViewParams& params);
 /// Collects dynamic lights affecting the scene for the current view.
 void diligent_collect_scene_dynamic_lights(SceneDesc* desc, const ViewParams& params);
+/// Drops the render block bounds cached from g_render_world; call whenever it's replaced.
+void diligent_reset_scene_collect();
+
+/// One object in a depth sort, with its key worked out up front.
+struct DiligentSortEntry
+{
+	uint32 key;
+	void* object;
+};
+
+/// \brief Returns an object's translucent sort key; ascending keys give the draw order.
+/// \details Objects drawn far to near, with REALLYCLOSE objects after all the others.
+uint32 diligent_calc_translucent_sort_key(const LTObject* object, const ViewParams& params);
+/// Stable radix sort of entries by ascending key.
+void diligent_radix_sort(DiligentSortEntry* entries, uint32 count);
+/// Returns true if translucent lists should be depth sorted (the DrawSorted console var).
+bool diligent_translucent_sort_enabled();
+/// Scratch entries for diligent_sort_translucent_list, kept so sorts don't allocate.
+std::vector<DiligentSortEntry>& diligent_get_sort_entries();
+
+/// \brief Sorts a list of translucent objects back to front for the given view.
+/// \details Null entries end up last. Does nothing if sorting is turned off.
+/// \code
+/// diligent_sort_translucent_list(sprites, params);
+/// \endcode
+template <typename TObject, typename TAllocator>
+void diligent_sort_translucent_list(std::vector<TObject*, TAllocator>& objects, const ViewParams& params)
+{
+	if (objects.size() < 2 || !diligent_translucent_sort_enabled())
+	{
+		return;
+	}
+
+	std::vector<DiligentSortEntry>& entries = diligent_get_sort_entries();
+	entries.resize(objects.size());
+	for (size_t i = 0; i < objects.size(); ++i)
+	{
+		entries[i].key = diligent_calc_translucent_sort_key(objects[i], params);
+		entries[i].object = objects[i];
+	}
+
+	diligent_radix_sort(entries.data(), static_cast<uint32>(entries.size()));
+
+	for (size_t i = 0; i < objects.size(); ++i)
+	{
+		objects[i] = static_cast<TObject*>(entries[i].object);
+	}
+}
+
+/// \brief CPU-only benchmark of scene collection, replaying the current view.
+/// \details Captures the last view and the client world tree, then times the object walks,
+/// render block culling and translucent sorting with nothing drawn, and compares the sort
+/// against the old comparator sort. Run with "RCom SceneBench".
+void diligent_scene_collect_benchmark(uint32 iterations);
 
 #endif
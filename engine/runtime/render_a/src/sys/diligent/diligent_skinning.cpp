@@ -0,0 +1,644 @@
+#include "diligent_skinning.h"
+
+#include "bdefs.h"
+#include "de_objects.h"
+#include "ltjobpool.h"
+#include "ltmatrix.h"
+#include "model.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define LTJS_DILIGENT_SKIN_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(LTJS_DILIGENT_SKIN_X86) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define LTJS_DILIGENT_SKIN_SSE 1
+#endif
+
+// The AVX2 kernel is compiled for its own target so the rest of the renderer doesn't need
+// AVX2 code generation, and only runs once the CPU has been checked for it.
+#if defined(LTJS_DILIGENT_SKIN_X86) && defined(_MSC_VER) && !defined(__clang__)
+#define LTJS_DILIGENT_SKIN_AVX2 1
+#define LTJS_DILIGENT_SKIN_AVX2_TARGET
+#elif defined(LTJS_DILIGENT_SKIN_X86) && (defined(__GNUC__) || defined(__clang__))
+#define LTJS_DILIGENT_SKIN_AVX2 1
+#define LTJS_DILIGENT_SKIN_AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+
+namespace
+{
+
+// Meshes with at least this many vertices are split across the job pool.
+constexpr uint32 kSkinParallelVertexCount = 4096;
+constexpr uint32 kSkinJobVertexCount = 1024;
+
+void diligent_store_vec3(uint8* base, uint32 stride, uint32 index, float x, float y, float z)
+{
+	float* out = reinterpret_cast<float*>(base + stride * index);
+	out[0] = x;
+	out[1] = y;
+	out[2] = z;
+}
+
+void diligent_skin_range_scalar(
+	const DiligentSkinSoA& soa,
+	const DiligentSkinMatrix* palette,
+	uint32 first,
+	uint32 end,
+	const DiligentSkinOutput& output)
+{
+	const bool has_normals = soa.HasNormals() && output.normal;
+
+	for (uint32 vert = first; vert < end; ++vert)
+	{
+		const float px = soa.position_x[vert];
+		const float py = soa.position_y[vert];
+		const float pz = soa.position_z[vert];
+
+		float out_p[3] = {0.0f, 0.0f, 0.0f};
+		float out_n[3] = {0.0f, 0.0f, 0.0f};
+		for (uint32 influence = 0; influence < soa.influence_count; ++influence)
+		{
+			const float weight = soa.weights[influence][vert];
+			if (weight == 0.0f)
+			{
+				continue;
+			}
+
+			const DiligentSkinMatrix& bone = palette[soa.bones[influence][vert]];
+			for (uint32 row = 0; row < 3; ++row)
+			{
+				out_p[row] += weight * (bone.m[row][0] * px + bone.m[row][1] * py + bone.m[row][2] * pz + bone.m[row][3]);
+			}
+
+			if (has_normals)
+			{
+				const float nx = soa.normal_x[vert];
+				const float ny = soa.normal_y[vert];
+				const float nz = soa.normal_z[vert];
+				for (uint32 row = 0; row < 3; ++row)
+				{
+					out_n[row] += weight * (bone.m[row][0] * nx + bone.m[row][1] * ny + bone.m[row][2] * nz);
+				}
+			}
+		}
+
+		diligent_store_vec3(output.position, output.position_stride, vert, out_p[0], out_p[1], out_p[2]);
+		if (has_normals)
+		{
+			diligent_store_vec3(output.normal, output.normal_stride, vert, out_n[0], out_n[1], out_n[2]);
+		}
+	}
+}
+
+#if defined(LTJS_DILIGENT_SKIN_SSE)
+
+// Four vertices at a time: blend each vertex's bone matrices a row per register, then
+// transpose so the point transform runs across the four vertices at once.
+void diligent_skin_range_sse(
+	const DiligentSkinSoA& soa,
+	const DiligentSkinMatrix* palette,
+	uint32 first,
+	uint32 end,
+	const DiligentSkinOutput& output)
+{
+	const bool has_normals = soa.HasNormals() && output.normal;
+	const uint32 simd_end = first + ((end - first) & ~3u);
+
+	uint32 vert = first;
+	for (; vert < simd_end; vert += 4)
+	{
+		__m128 rows[3][4];
+		for (uint32 lane = 0; lane < 4; ++lane)
+		{
+			const uint32 lane_vert = vert + lane;
+			__m128 row0 = _mm_setzero_ps();
+			__m128 row1 = _mm_setzero_ps();
+			__m128 row2 = _mm_setzero_ps();
+			for (uint32 influence = 0; influence < soa.influence_count; ++influence)
+			{
+				const float weight = soa.weights[influence][lane_vert];
+				if (weight == 0.0f)
+				{
+					continue;
+				}
+
+				const __m128 w = _mm_set1_ps(weight);
+				const float* bone = palette[soa.bones[influence][lane_vert]].m[0];
+				row0 = _mm_add_ps(row0, _mm_mul_ps(w, _mm_loadu_ps(bone)));
+				row1 = _mm_add_ps(row1, _mm_mul_ps(w, _mm_loadu_ps(bone + 4)));
+				row2 = _mm_add_ps(row2, _mm_mul_ps(w, _mm_loadu_ps(bone + 8)));
+			}
+
+			rows[0][lane] = row0;
+			rows[1][lane] = row1;
+			rows[2][lane] = row2;
+		}
+
+		// rows[r][0..3] now hold m[r][0], m[r][1], m[r][2], m[r][3] for each of the four vertices.
+		for (uint32 row = 0; row < 3; ++row)
+		{
+			_MM_TRANSPOSE4_PS(rows[row][0], rows[row][1], rows[row][2], rows[row][3]);
+		}
+
+		const __m128 px = _mm_loadu_ps(&soa.position_x[vert]);
+		const __m128 py = _mm_loadu_ps(&soa.position_y[vert]);
+		const __m128 pz = _mm_loadu_ps(&soa.position_z[vert]);
+
+		alignas(16) float out_p[3][4];
+		for (uint32 row = 0; row < 3; ++row)
+		{
+			__m128 value = _mm_mul_ps(rows[row][0], px);
+			value = _mm_add_ps(value, _mm_mul_ps(rows[row][1], py));
+			value = _mm_add_ps(value, _mm_mul_ps(rows[row][2], pz));
+			value = _mm_add_ps(value, rows[row][3]);
+			_mm_store_ps(out_p[row], value);
+		}
+
+		for (uint32 lane = 0; lane < 4; ++lane)
+		{
+			diligent_store_vec3(output.position, output.position_stride, vert + lane, out_p[0][lane], out_p[1][lane], out_p[2][lane]);
+		}
+
+		if (has_normals)
+		{
+			const __m128 nx = _mm_loadu_ps(&soa.normal_x[vert]);
+			const __m128 ny = _mm_loadu_ps(&soa.normal_y[vert]);
+			const __m128 nz = _mm_loadu_ps(&soa.normal_z[vert]);
+
+			alignas(16) float out_n[3][4];
+			for (uint32 row = 0; row < 3; ++row)
+			{
+				__m128 value = _mm_mul_ps(rows[row][0], nx);
+				value = _mm_add_ps(value, _mm_mul_ps(rows[row][1], ny));
+				value = _mm_add_ps(value, _mm_mul_ps(rows[row][2], nz));
+				_mm_store_ps(out_n[row], value);
+			}
+
+			for (uint32 lane = 0; lane < 4; ++lane)
+			{
+				diligent_store_vec3(output.normal, output.normal_stride, vert + lane, out_n[0][lane], out_n[1][lane], out_n[2][lane]);
+			}
+		}
+	}
+
+	if (vert < end)
+	{
+		diligent_skin_range_scalar(soa, palette, vert, end, output);
+	}
+}
+
+#endif
+
+#if defined(LTJS_DILIGENT_SKIN_AVX2)
+
+// Eight vertices at a time: gather each of the twelve matrix elements for every influence
+// straight out of the palette and accumulate the blended matrices across the lanes.
+LTJS_DILIGENT_SKIN_AVX2_TARGET
+void diligent_skin_range_avx2(
+	const DiligentSkinSoA& soa,
+	const DiligentSkinMatrix* palette,
+	uint32 first,
+	uint32 end,
+	const DiligentSkinOutput& output)
+{
+	const bool has_normals = soa.HasNormals() && output.normal;
+	const uint32 simd_end = first + ((end - first) & ~7u);
+	const float* palette_base = palette[0].m[0];
+	const __m256i matrix_floats = _mm256_set1_epi32(12);
+
+	uint32 vert = first;
+	for (; vert < simd_end; vert += 8)
+	{
+		__m256 m[12];
+		for (uint32 element = 0; element < 12; ++element)
+		{
+			m[element] = _mm256_setzero_ps();
+		}
+
+		for (uint32 influence = 0; influence < soa.influence_count; ++influence)
+		{
+			const __m256 w = _mm256_loadu_ps(&soa.weights[influence][vert]);
+			const __m256i bone = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&soa.bones[influence][vert]));
+			const __m256i offset = _mm256_mullo_epi32(bone, matrix_floats);
+			for (uint32 element = 0; element < 12; ++element)
+			{
+				m[element] = _mm256_fmadd_ps(w, _mm256_i32gather_ps(palette_base + element, offset, 4), m[element]);
+			}
+		}
+
+		const __m256 px = _mm256_loadu_ps(&soa.position_x[vert]);
+		const __m256 py = _mm256_loadu_ps(&soa.position_y[vert]);
+		const __m256 pz = _mm256_loadu_ps(&soa.position_z[vert]);
+
+		alignas(32) float out_p[3][8];
+		for (uint32 row = 0; row < 3; ++row)
+		{
+			const __m256* r = &m[row * 4];
+			__m256 value = _mm256_fmadd_ps(r[0], px, r[3]);
+			value = _mm256_fmadd_ps(r[1], py, value);
+			value = _mm256_fmadd_ps(r[2], pz, value);
+			_mm256_store_ps(out_p[row], value);
+		}
+
+		for (uint32 lane = 0; lane < 8; ++lane)
+		{
+			diligent_store_vec3(output.position, output.position_stride, vert + lane, out_p[0][lane], out_p[1][lane], out_p[2][lane]);
+		}
+
+		if (has_normals)
+		{
+			const __m256 nx = _mm256_loadu_ps(&soa.normal_x[vert]);
+			const __m256 ny = _mm256_loadu_ps(&soa.normal_y[vert]);
+			const __m256 nz = _mm256_loadu_ps(&soa.normal_z[vert]);
+
+			alignas(32) float out_n[3][8];
+			for (uint32 row = 0; row < 3; ++row)
+			{
+				const __m256* r = &m[row * 4];
+				__m256 value = _mm256_mul_ps(r[0], nx);
+				value = _mm256_fmadd_ps(r[1], ny, value);
+				value = _mm256_fmadd_ps(r[2], nz, value);
+				_mm256_store_ps(out_n[row], value);
+			}
+
+			for (uint32 lane = 0; lane < 8; ++lane)
+			{
+				diligent_store_vec3(output.normal, output.normal_stride, vert + lane, out_n[0][lane], out_n[1][lane], out_n[2][lane]);
+			}
+		}
+	}
+
+	if (vert < end)
+	{
+		diligent_skin_range_scalar(soa, palette, vert, end, output);
+	}
+}
+
+bool diligent_cpu_has_avx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4] = {};
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		return false;
+	}
+
+	__cpuid(info, 1);
+	const bool has_fma = (info[2] & (1 << 12)) != 0;
+	const bool has_osxsave = (info[2] & (1 << 27)) != 0;
+	const bool has_avx = (info[2] & (1 << 28)) != 0;
+	if (!has_fma || !has_osxsave || !has_avx)
+	{
+		return false;
+	}
+
+	// The OS has to be saving the YMM registers.
+	if ((_xgetbv(0) & 0x6) != 0x6)
+	{
+		return false;
+	}
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+#endif
+
+bool diligent_skin_path_available(DiligentSkinPath path)
+{
+	switch (path)
+	{
+		case kDiligentSkinPathScalar:
+			return true;
+		case kDiligentSkinPathSSE:
+#if defined(LTJS_DILIGENT_SKIN_SSE)
+			return true;
+#else
+			return false;
+#endif
+		case kDiligentSkinPathAVX2:
+#if defined(LTJS_DILIGENT_SKIN_AVX2)
+		{
+			static const bool has_avx2 = diligent_cpu_has_avx2();
+			return has_avx2;
+		}
+#else
+			return false;
+#endif
+		default:
+			return false;
+	}
+}
+
+struct DiligentSkinJob
+{
+	DiligentSkinPath path;
+	const DiligentSkinSoA* soa;
+	const DiligentSkinMatrix* palette;
+	const DiligentSkinOutput* output;
+};
+
+void diligent_skin_job(uint32 job_index, void* user)
+{
+	const DiligentSkinJob* job = static_cast<const DiligentSkinJob*>(user);
+	const uint32 first = job_index * kSkinJobVertexCount;
+	const uint32 end = LTMIN(first + kSkinJobVertexCount, job->soa->vertex_count);
+	static_cast<void>(diligent_skin_vertices_range(job->path, *job->soa, job->palette, first, end, *job->output));
+}
+
+} // namespace
+
+void DiligentSkinSoA::Resize(uint32 count, uint32 influences, bool has_normals)
+{
+	vertex_count = count;
+	influence_count = LTMIN(influences, kDiligentMaxSkinInfluences);
+	position_x.assign(count, 0.0f);
+	position_y.assign(count, 0.0f);
+	position_z.assign(count, 0.0f);
+
+	const uint32 normal_count = has_normals ? count : 0;
+	normal_x.assign(normal_count, 0.0f);
+	normal_y.assign(normal_count, 0.0f);
+	normal_z.assign(normal_count, 0.0f);
+
+	for (uint32 influence = 0; influence < kDiligentMaxSkinInfluences; ++influence)
+	{
+		const uint32 influence_size = influence < influence_count ? count : 0;
+		weights[influence].assign(influence_size, 0.0f);
+		bones[influence].assign(influence_size, 0);
+	}
+}
+
+void DiligentSkinSoA::Clear()
+{
+	Resize(0, 0, false);
+}
+
+void diligent_skin_matrix_from_ltmatrix(const LTMatrix& matrix, DiligentSkinMatrix& out)
+{
+	for (uint32 row = 0; row < 3; ++row)
+	{
+		for (uint32 column = 0; column < 4; ++column)
+		{
+			out.m[row][column] = matrix.m[row][column];
+		}
+	}
+}
+
+bool diligent_get_model_skin_palette(ModelInstance* instance, std::vector<DiligentSkinMatrix>& palette)
+{
+	if (!instance)
+	{
+		return false;
+	}
+
+	Model* model = instance->GetModelDB();
+	if (!model)
+	{
+		return false;
+	}
+
+	const uint32 bone_count = model->NumNodes();
+	if (bone_count == 0)
+	{
+		return false;
+	}
+
+	// Evaluate everything that's missing in one go.
+	bool needs_update = false;
+	for (uint32 bone_index = 0; bone_index < bone_count; ++bone_index)
+	{
+		if (!instance->IsNodeEvaluated(bone_index))
+		{
+			instance->SetupNodePath(bone_index);
+			needs_update = true;
+		}
+	}
+
+	if (needs_update)
+	{
+		instance->UpdateCachedTransformsWithPath();
+	}
+
+	palette.resize(bone_count);
+	for (uint32 bone_index = 0; bone_index < bone_count; ++bone_index)
+	{
+		LTMatrix transform;
+		if (!instance->GetCachedTransform(bone_index, transform))
+		{
+			return false;
+		}
+
+		// Match engine rendering transforms: remove bind-pose global transform.
+		diligent_skin_matrix_from_ltmatrix(transform * model->GetNode(bone_index)->GetInvGlobalTransform(), palette[bone_index]);
+	}
+
+	return true;
+}
+
+DiligentSkinPath diligent_get_best_skin_path()
+{
+	if (diligent_skin_path_available(kDiligentSkinPathAVX2))
+	{
+		return kDiligentSkinPathAVX2;
+	}
+
+	if (diligent_skin_path_available(kDiligentSkinPathSSE))
+	{
+		return kDiligentSkinPathSSE;
+	}
+
+	return kDiligentSkinPathScalar;
+}
+
+bool diligent_skin_vertices_range(
+	DiligentSkinPath path,
+	const DiligentSkinSoA& soa,
+	const DiligentSkinMatrix* palette,
+	uint32 first,
+	uint32 end,
+	const DiligentSkinOutput& output)
+{
+	if (path == kDiligentSkinPathBest)
+	{
+		path = diligent_get_best_skin_path();
+	}
+
+	if (!diligent_skin_path_available(path))
+	{
+		return false;
+	}
+
+	end = LTMIN(end, soa.vertex_count);
+	if (first >= end || !palette || !output.position)
+	{
+		return true;
+	}
+
+	switch (path)
+	{
+#if defined(LTJS_DILIGENT_SKIN_AVX2)
+		case kDiligentSkinPathAVX2:
+			diligent_skin_range_avx2(soa, palette, first, end, output);
+			break;
+#endif
+#if defined(LTJS_DILIGENT_SKIN_SSE)
+		case kDiligentSkinPathSSE:
+			diligent_skin_range_sse(soa, palette, first, end, output);
+			break;
+#endif
+		default:
+			diligent_skin_range_scalar(soa, palette, first, end, output);
+			break;
+	}
+
+	return true;
+}
+
+void diligent_skin_vertices(const DiligentSkinSoA& soa, const DiligentSkinMatrix* palette, const DiligentSkinOutput& output)
+{
+	const DiligentSkinPath path = diligent_get_best_skin_path();
+	if (soa.vertex_count < kSkinParallelVertexCount)
+	{
+		static_cast<void>(diligent_skin_vertices_range(path, soa, palette, 0, soa.vertex_count, output));
+		return;
+	}
+
+	DiligentSkinJob job{path, &soa, palette, &output};
+	const uint32 job_count = (soa.vertex_count + kSkinJobVertexCount - 1) / kSkinJobVertexCount;
+	lt_GetJobPool().ParallelFor(job_count, diligent_skin_job, &job);
+}
+
+void diligent_skinning_benchmark(uint32 vertex_count, uint32 bone_count, uint32 iterations)
+{
+	vertex_count = LTMAX(vertex_count, 1u);
+	bone_count = LTMAX(bone_count, 1u);
+	iterations = LTMAX(iterations, 1u);
+
+	// Synthetic mesh: four influences per vertex with normalized weights, and a palette of
+	// rotations about random axes plus translations.
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_int_distribution<uint32> pick_bone(0, bone_count - 1);
+
+	DiligentSkinSoA soa;
+	soa.Resize(vertex_count, kDiligentMaxSkinInfluences, true);
+	for (uint32 vert = 0; vert < vertex_count; ++vert)
+	{
+		soa.position_x[vert] = unit(random) * 64.0f;
+		soa.position_y[vert] = unit(random) * 64.0f;
+		soa.position_z[vert] = unit(random) * 64.0f;
+		soa.normal_x[vert] = unit(random);
+		soa.normal_y[vert] = unit(random);
+		soa.normal_z[vert] = unit(random);
+
+		float total = 0.0f;
+		for (uint32 influence = 0; influence < kDiligentMaxSkinInfluences; ++influence)
+		{
+			soa.weights[influence][vert] = unit(random) * 0.5f + 0.5f;
+			soa.bones[influence][vert] = pick_bone(random);
+			total += soa.weights[influence][vert];
+		}
+
+		for (uint32 influence = 0; influence < kDiligentMaxSkinInfluences; ++influence)
+		{
+			soa.weights[influence][vert] /= total;
+		}
+	}
+
+	std::vector<DiligentSkinMatrix> palette(bone_count);
+	for (uint32 bone = 0; bone < bone_count; ++bone)
+	{
+		LTVector axis(unit(random), unit(random), unit(random) + 2.0f);
+		axis.Norm();
+		LTMatrix transform;
+		transform.SetupRot(axis, unit(random) * 3.14159f);
+		transform.SetTranslation(unit(random) * 16.0f, unit(random) * 16.0f, unit(random) * 16.0f);
+		diligent_skin_matrix_from_ltmatrix(transform, palette[bone]);
+	}
+
+	// Interleaved like a real vertex buffer (position, weights, indices, normal, uv).
+	constexpr uint32 kStride = 48;
+	std::vector<uint8> reference(vertex_count * kStride);
+	std::vector<uint8> results(vertex_count * kStride);
+
+	const auto make_output = [](std::vector<uint8>& buffer)
+	{
+		DiligentSkinOutput output;
+		output.position = buffer.data();
+		output.position_stride = kStride;
+		output.normal = buffer.data() + 28;
+		output.normal_stride = kStride;
+		return output;
+	};
+
+	static_cast<void>(diligent_skin_vertices_range(kDiligentSkinPathScalar, soa, palette.data(), 0, vertex_count, make_output(reference)));
+
+	dsi_ConsolePrint("SkinBench: %u vertices, %u bones, %u passes, %u worker threads",
+		vertex_count, bone_count, iterations, lt_GetJobPool().GetNumThreads());
+
+	static const char* const kPathNames[] = {"scalar", "sse", "avx2", "best+jobs"};
+	double scalar_ms = 0.0;
+	for (uint32 path = kDiligentSkinPathScalar; path <= kDiligentSkinPathBest; ++path)
+	{
+		const DiligentSkinPath skin_path = static_cast<DiligentSkinPath>(path);
+		if (skin_path != kDiligentSkinPathBest && !diligent_skin_path_available(skin_path))
+		{
+			dsi_ConsolePrint("SkinBench: %-9s not available", kPathNames[path]);
+			continue;
+		}
+
+		std::fill(results.begin(), results.end(), static_cast<uint8>(0));
+		const DiligentSkinOutput output = make_output(results);
+
+		const auto start = std::chrono::steady_clock::now();
+		for (uint32 iteration = 0; iteration < iterations; ++iteration)
+		{
+			if (skin_path == kDiligentSkinPathBest)
+			{
+				diligent_skin_vertices(soa, palette.data(), output);
+			}
+			else
+			{
+				static_cast<void>(diligent_skin_vertices_range(skin_path, soa, palette.data(), 0, vertex_count, output));
+			}
+		}
+		const auto stop = std::chrono::steady_clock::now();
+
+		float max_error = 0.0f;
+		for (uint32 vert = 0; vert < vertex_count; ++vert)
+		{
+			const float* expected = reinterpret_cast<const float*>(reference.data() + vert * kStride);
+			const float* actual = reinterpret_cast<const float*>(results.data() + vert * kStride);
+			for (uint32 component = 0; component < 3; ++component)
+			{
+				max_error = LTMAX(max_error, std::fabs(expected[component] - actual[component]));
+				max_error = LTMAX(max_error, std::fabs(expected[component + 7] - actual[component + 7]));
+			}
+		}
+
+		const double total_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+		const double pass_ms = total_ms / iterations;
+		if (skin_path == kDiligentSkinPathScalar)
+		{
+			scalar_ms = pass_ms;
+		}
+
+		dsi_ConsolePrint("SkinBench: %-9s %8.3f ms/pass  %5.2fx  max error %g",
+			kPathNames[path], pass_ms, pass_ms > 0.0 ? scalar_ms / pass_ms : 0.0, max_error);
+	}
+}
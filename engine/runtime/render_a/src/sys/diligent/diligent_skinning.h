@@ -0,0 +1,101 @@
+/**
+ * diligent_skinning.h
+ *
+ * This header defines the CPU Skinning portion of the Diligent renderer.
+ * Skinned meshes keep a structure-of-arrays copy of their skinning inputs
+ * which the kernels here blend against a palette of 3x4 bone matrices,
+ * using AVX2 or SSE when the CPU has them and the job pool for large meshes.
+ */
+#ifndef LTJS_DILIGENT_SKINNING_H
+#define LTJS_DILIGENT_SKINNING_H
+
+#include "ltbasedefs.h"
+
+#include <array>
+#include <vector>
+
+struct LTMatrix;
+class ModelInstance;
+
+/// Maximum bone influences per vertex handled by the skinning kernels.
+constexpr uint32 kDiligentMaxSkinInfluences = 4;
+
+/// Row-major 3x4 affine bone matrix (the bottom row of an LTMatrix is implied).
+struct DiligentSkinMatrix
+{
+	float m[3][4];
+};
+
+/// Structure-of-arrays copy of a skinned mesh's bind pose and blend data.
+/// \details Weights are decoded to floats with the implied last weight filled in, and
+/// bone indices are resolved to palette indices, so the kernels don't need to know about
+/// vertex layouts or bone sets. Unused influences have a weight of 0 and bone 0.
+struct DiligentSkinSoA
+{
+	uint32 vertex_count = 0;
+	uint32 influence_count = 0;
+	std::vector<float> position_x;
+	std::vector<float> position_y;
+	std::vector<float> position_z;
+	std::vector<float> normal_x;
+	std::vector<float> normal_y;
+	std::vector<float> normal_z;
+	std::array<std::vector<float>, kDiligentMaxSkinInfluences> weights;
+	std::array<std::vector<uint32>, kDiligentMaxSkinInfluences> bones;
+
+	void Resize(uint32 count, uint32 influences, bool has_normals);
+	void Clear();
+	bool HasNormals() const { return !normal_x.empty(); }
+};
+
+/// Destination for skinned vertices, written at a byte stride (e.g. into a mapped vertex buffer).
+struct DiligentSkinOutput
+{
+	uint8* position = nullptr;
+	uint32 position_stride = 0;
+	uint8* normal = nullptr;
+	uint32 normal_stride = 0;
+};
+
+/// Kernel selection for the skinning entry points.
+enum DiligentSkinPath
+{
+	kDiligentSkinPathScalar,
+	kDiligentSkinPathSSE,
+	kDiligentSkinPathAVX2,
+	kDiligentSkinPathBest
+};
+
+/// Converts an LTMatrix to the 3x4 palette layout.
+void diligent_skin_matrix_from_ltmatrix(const LTMatrix& matrix, DiligentSkinMatrix& out);
+
+/// \brief Fetches the render transforms of every node of a model instance in one pass.
+/// \details Any nodes that haven't been evaluated this frame are put on the evaluation path
+/// together, so the transform maker runs once rather than once per bone.
+bool diligent_get_model_skin_palette(ModelInstance* instance, std::vector<DiligentSkinMatrix>& palette);
+
+/// Returns the fastest path the CPU supports.
+DiligentSkinPath diligent_get_best_skin_path();
+
+/// \brief Skins vertices [first, end) with a single kernel on the calling thread.
+/// \details Returns false if the requested path isn't available on this CPU.
+bool diligent_skin_vertices_range(
+	DiligentSkinPath path,
+	const DiligentSkinSoA& soa,
+	const DiligentSkinMatrix* palette,
+	uint32 first,
+	uint32 end,
+	const DiligentSkinOutput& output);
+
+/// \brief Skins every vertex with the best kernel, spread across the job pool for large meshes.
+/// \code
+/// diligent_skin_vertices(soa, palette.data(), output);
+/// \endcode
+void diligent_skin_vertices(const DiligentSkinSoA& soa, const DiligentSkinMatrix* palette, const DiligentSkinOutput& output);
+
+/// \brief CPU-only microbenchmark of the skinning kernels on synthetic data.
+/// \details Prints the time per pass for the scalar, SSE, AVX2 and job pool paths, and the
+/// largest difference from the scalar results, to the console. Run with "RCom SkinBench".
+void diligent_skinning_benchmark(uint32 vertex_count, uint32 bone_count, uint32 iterations);
+
+#endif
@@ -1,5 +1,6 @@
 #include "diligent_world_api.h"
 
+#include "diligent_scene_collect.h"
 #include "diligent_world_data.h"
 #include "texturescriptvarmgr.h"
 
@@ -13,6 +14,7 @@ bool diligent_LoadWorldData(ILTStream* stream)
 	}
 
 	g_render_world.reset();
+	diligent_reset_scene_collect();
 
 	auto world = std::unique_ptr<DiligentRenderWorld>(new DiligentRenderWorld());
 	if (!world->Load(stream))
@@ -280,49 +280,6 @@ SharedTexture* diligent_resolve_effect_texture(SharedTexture* texture)
 	return texture;
 }
 
-float diligent_calc_world_model_draw_distance(const LTObject* object, const ViewParams& params)
-{
-	if (!object)
-	{
-		return 0.0f;
-	}
-
-	if ((object->m_Flags & FLAG_REALLYCLOSE) == 0)
-	{
-		return (object->GetPos() - params.m_Pos).MagSqr();
-	}
-
-	return object->GetPos().MagSqr();
-}
-
-void diligent_sort_translucent_world_models(std::vector<WorldModelInstance*>& objects, const ViewParams& params)
-{
-	if (!g_CV_DrawSorted.m_Val || objects.size() < 2)
-	{
-		return;
-	}
-
-	std::sort(objects.begin(), objects.end(), [&params](const WorldModelInstance* a, const WorldModelInstance* b)
-	{
-		if (!a || !b)
-		{
-			return a != nullptr;
-		}
-
-		const auto* obj_a = static_cast<const LTObject*>(a);
-		const auto* obj_b = static_cast<const LTObject*>(b);
-		const bool a_close = (obj_a->m_Flags & FLAG_REALLYCLOSE) != 0;
-		const bool b_close = (obj_b->m_Flags & FLAG_REALLYCLOSE) != 0;
-		if (a_close != b_close)
-		{
-			return !a_close && b_close;
-		}
-
-		const float dist_a = diligent_calc_world_model_draw_distance(obj_a, params);
-		const float dist_b = diligent_calc_world_model_draw_distance(obj_b, params);
-		return dist_a > dist_b;
-	});
-}
 } // namespace
 
 DiligentWorldResources g_world_resources;
@@ -2466,12 +2423,14 @@ bool diligent_draw_world_model_list_with_view(
 }
 bool diligent_draw_world_model_list(const std::vector<WorldModelInstance*>& models, DiligentWorldBlendMode blend_mode)
 {
+	// Kept between frames so sorting doesn't allocate.
+	static std::vector<WorldModelInstance*> sorted_models;
+
 	const std::vector<WorldModelInstance*>* draw_list = &models;
-	std::vector<WorldModelInstance*> sorted_models;
 	if (blend_mode == kWorldBlendAlpha && g_CV_DrawSorted.m_Val && models.size() > 1)
 	{
-		sorted_models = models;
-		diligent_sort_translucent_world_models(sorted_models, g_diligent_state.view_params);
+		sorted_models.assign(models.begin(), models.end());
+		diligent_sort_translucent_list(sorted_models, g_diligent_state.view_params);
 		draw_list = &sorted_models;
 	}
 
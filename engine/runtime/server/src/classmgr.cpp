@@ -726,6 +726,7 @@ static LTRESULT InitExtraClassData(CClassMgr *pClassMgr)
             LT_MEM_TRACK_ALLOC(sb_Init2(&pClassData->m_ObjectBank, pClass->m_ClassObjectSize, 1, 1), LT_MEM_TYPE_MISC);      
             pClassData->m_ClassID = (uint16)i;
             pClassData->m_pClass = pClass;
+            pClassData->m_bThreadSafeUpdate = (pClass->m_ClassFlags & CF_THREADSAFEUPDATE) != 0;
             pClass->m_pInternal[pClassMgr->m_ClassIndex] = pClassData;
 
             hElement = hs_AddElement(pClassMgr->m_hClassNameHash, pClass->m_ClassName, strlen(pClass->m_ClassName));
@@ -87,6 +87,7 @@ class CClassData : public CGLLNode
 		ClassDef	*m_pClass;
 		LTObject	*m_pStaticObject;	// Static object for this class, if any.
 		uint16		m_ClassID;			// Unique ID for the class.
+		LTBOOL		m_bThreadSafeUpdate;	// The class itself (not a parent) has CF_THREADSAFEUPDATE.
 
 	protected :
 
@@ -16,8 +16,14 @@
 #include "ltmessage_server.h"
 #include "netmgr.h"
 #include "clienthack.h"
+#include "s_interest.h"
+#include "ltjobpool.h"
+#include "ltframearena.h"
+#include "animtracker.h"
 
+#include <algorithm>
 #include <queue>
+#include <vector>
 
 //------------------------------------------------------------------
 //------------------------------------------------------------------
@@ -59,9 +65,67 @@ struct UpdateInfo {
 	CPacket_Write	m_cUnguaranteed;
 	uint32			m_nTargetUpdateSize;
 	uint32			m_nUpdateTime;
+
+	// The sent lists from the previous update and the one being built.
+	SentList		*m_pPrevSentList;
+	SentList		*m_pCurSentList;
+
+	// The client's interest set, only used if m_bInterestSet is true.
+	bool			m_bInterestSet;
+	LTObject		**m_pInterestObjects;
+	uint32			m_nInterestObjects;
 };
 
-SentList *g_pCurSentList;
+
+// Walks the objects that are candidates for being sent to a client.  That's the
+// client's interest set if there is one, otherwise every object in the world.
+class CSendCandidateIter
+{
+public:
+	CSendCandidateIter(ObjectMgr *pObjectMgr, const UpdateInfo *pInfo) :
+		m_pObjectMgr(pObjectMgr),
+		m_bInterestSet(pInfo->m_bInterestSet),
+		m_pInterestObjects(pInfo->m_pInterestObjects),
+		m_nInterestObjects(pInfo->m_nInterestObjects),
+		m_iCur(0),
+		m_pCur(LTNULL)
+	{
+		if (!m_bInterestSet)
+			m_pCur = m_pObjectMgr->m_ObjectLists[0].m_Head.m_pNext;
+	}
+
+	LTObject* Next()
+	{
+		if (m_bInterestSet)
+		{
+			return (m_iCur < m_nInterestObjects) ? m_pInterestObjects[m_iCur++] : LTNULL;
+		}
+
+		while (m_iCur < NUM_OBJECTTYPES)
+		{
+			LTLink *pListHead = &m_pObjectMgr->m_ObjectLists[m_iCur].m_Head;
+			if (m_pCur != pListHead)
+			{
+				LTObject *pObject = (LTObject*)m_pCur->m_pData;
+				m_pCur = m_pCur->m_pNext;
+				return pObject;
+			}
+
+			if (++m_iCur < NUM_OBJECTTYPES)
+				m_pCur = m_pObjectMgr->m_ObjectLists[m_iCur].m_Head.m_pNext;
+		}
+
+		return LTNULL;
+	}
+
+private:
+	ObjectMgr	*m_pObjectMgr;
+	bool		m_bInterestSet;
+	LTObject	**m_pInterestObjects;
+	uint32		m_nInterestObjects;
+	uint32		m_iCur;
+	LTLink		*m_pCur;
+};
 
 
 uint32 g_Ticks_ClientVis;
@@ -105,6 +169,7 @@ Client::Client() :
 	m_hFTServ(0),
 	m_ObjInfos(0),
 	m_iPrevSentList(0),
+	m_pInterest(0),
 	m_pObject(0),
 	m_pPluginUserData(0),
 	m_ClientID(0),
@@ -254,6 +319,7 @@ Client::~Client( )
 	dfree(m_ObjInfos);
 	dfree(m_SentLists[0].m_ObjectIDs);
 	dfree(m_SentLists[1].m_ObjectIDs);
+	sm_FreeClientInterest(this);
 
 	dfree(m_Name);
 
@@ -918,7 +984,7 @@ void sm_AddObjectChangeInfo(UpdateInfo *pInfo, LTObject *pObject, ObjInfo *pObjI
 	// Update the send time
 	pObjInfo->m_nLastSentG = pInfo->m_nUpdateTime;
 
-	AddObjectIdToSentList(g_pCurSentList, pObject->m_ObjectID);
+	AddObjectIdToSentList(pInfo->m_pCurSentList, pObject->m_ObjectID);
 
 	// Setup the packet with update info.
 	CPacket_Write cSubPacket;
@@ -1037,7 +1103,7 @@ void sm_SendSoundTracks(UpdateInfo *pInfo, CPacket_Write &cPacket)
 		pObjInfo = &pInfo->m_pClient->m_ObjInfos[GetLinkID(pSoundTrack->m_pIDLink)];
 
 		uint16 nNewId = (uint16)GetLinkID(pSoundTrack->m_pIDLink);
-		AddObjectIdToSentList( g_pCurSentList, nNewId );
+		AddObjectIdToSentList( pInfo->m_pCurSentList, nNewId );
 
 		// Setup the packet with update info.  If the client already told us the sound is done, then don't
 		// send it again...
@@ -1196,33 +1262,28 @@ void SendAllObjectsGuaranteed(ObjectMgr *pObjectMgr, UpdateInfo *pInfo)
 	else
 	{
 		// Do this in priority order...
-		static TGuaranteedObjQueue aObjects;
+		TGuaranteedObjQueue aObjects;
 
 		// Try not to use up the whole update...
 		uint32 nUpdateSizeRemaining = pInfo->m_nTargetUpdateSize / 2;
 
-		for (i=0; i < NUM_OBJECTTYPES; i++)
+		CSendCandidateIter cCandidates(pObjectMgr, pInfo);
+		while ((pObject = cCandidates.Next()) != LTNULL)
 		{
-			pListHead = &pObjectMgr->m_ObjectLists[i].m_Head;
-			for (pCur=pListHead->m_pNext; pCur != pListHead; pCur=pCur->m_pNext)
-			{
-				pObject = (LTObject*)pCur->m_pData;
-
-				// Gotta check here too for objects not in the BSP.
-				if (!ShouldSendToClient(pInfo->m_pClient, pObject)) 
-					continue;
+			// Gotta check here too for objects not in the BSP.
+			if (!ShouldSendToClient(pInfo->m_pClient, pObject)) 
+				continue;
 
-				// Don't send over the main world model
-				if (pObject->IsMainWorldModel()) 
-					continue;
+			// Don't send over the main world model
+			if (pObject->IsMainWorldModel()) 
+				continue;
 
-				CGuaranteedObjTrack cCurObj;
-				cCurObj.m_pObject	= pObject;
-				cCurObj.m_pObjInfo	= &pInfo->m_pClient->m_ObjInfos[pObject->m_ObjectID];
-				cCurObj.m_fPriority = (float)(pInfo->m_nUpdateTime - cCurObj.m_pObjInfo->m_nLastSentG);
+			CGuaranteedObjTrack cCurObj;
+			cCurObj.m_pObject	= pObject;
+			cCurObj.m_pObjInfo	= &pInfo->m_pClient->m_ObjInfos[pObject->m_ObjectID];
+			cCurObj.m_fPriority = (float)(pInfo->m_nUpdateTime - cCurObj.m_pObjInfo->m_nLastSentG);
 
-				aObjects.push(cCurObj);
-			}
+			aObjects.push(cCurObj);
 		}
 
 		while (!aObjects.empty())
@@ -1246,7 +1307,7 @@ void SendAllObjectsGuaranteed(ObjectMgr *pObjectMgr, UpdateInfo *pInfo)
 			const CGuaranteedObjTrack &cCurObj = aObjects.top();
 
 			cCurObj.m_pObjInfo->m_ChangeFlags |= CF_SENTINFO;
-			AddObjectIdToSentList(g_pCurSentList, cCurObj.m_pObject->m_ObjectID);
+			AddObjectIdToSentList(pInfo->m_pCurSentList, cCurObj.m_pObject->m_ObjectID);
 
 			aObjects.pop();
 		}
@@ -1277,7 +1338,9 @@ static void WriteUnguaranteedDataWithAttachments(LTObject* pObject, CPacket_Writ
 static void UpdateSendTimeWithAttachments(LTObject* pObject, UpdateInfo *pInfo, const uint32 k_nUnguaranteedMask)
 {
 	// Update the send time
-	pInfo->m_pClient->m_ObjInfos[pObject->m_ObjectID].m_nLastSentU = pInfo->m_nUpdateTime;
+	ObjInfo *pObjInfo = &pInfo->m_pClient->m_ObjInfos[pObject->m_ObjectID];
+	pObjInfo->m_nLastSentU = pInfo->m_nUpdateTime;
+	pObjInfo->m_fUnguaranteedPriority = 0.0f;
 
 	// Update the send time of the attachments
 	for (Attachment *pAttachment = pObject->m_Attachments; pAttachment; pAttachment = pAttachment->m_pNext) 
@@ -1289,18 +1352,25 @@ static void UpdateSendTimeWithAttachments(LTObject* pObject, UpdateInfo *pInfo,
 		if ((pAttachedObj->sd->m_NetFlags & k_nUnguaranteedMask) == 0)
 			continue;
 
-		pInfo->m_pClient->m_ObjInfos[pAttachedObj->m_ObjectID].m_nLastSentU = pInfo->m_nUpdateTime;
+		ObjInfo *pAttachedInfo = &pInfo->m_pClient->m_ObjInfos[pAttachedObj->m_ObjectID];
+		pAttachedInfo->m_nLastSentU = pInfo->m_nUpdateTime;
+		pAttachedInfo->m_fUnguaranteedPriority = 0.0f;
 	}
 }
 
 
 struct CUnguaranteedObjTrack
 {
-	bool operator<(const CUnguaranteedObjTrack &sOther) const { return m_fPriority < sOther.m_fPriority; }
+	// Sorts highest priority first.
+	bool operator<(const CUnguaranteedObjTrack &sOther) const { return m_fPriority > sOther.m_fPriority; }
 	LTObject *m_pObject;
 	float m_fPriority;
 };
-typedef std::priority_queue<CUnguaranteedObjTrack> TUnguaranteedObjQueue;
+typedef std::vector<CUnguaranteedObjTrack> TUnguaranteedObjList;
+
+// Rough size of an object's unguaranteed info in bits.  Only used to decide how
+// many candidates to pick per selection pass, so it doesn't need to be exact.
+static const uint32 k_nEstimatedUnguaranteedObjBits = 96;
 
 void SendAllObjectsUnguaranteed(ObjectMgr *pObjectMgr, UpdateInfo *pInfo) 
 {
@@ -1343,65 +1413,76 @@ void SendAllObjectsUnguaranteed(ObjectMgr *pObjectMgr, UpdateInfo *pInfo)
 		
 		uint32 nUpdateSizeRemaining = pInfo->m_nTargetUpdateSize - pInfo->m_cPacket.Size();
 
-		// Do this in priority order...
-		static TUnguaranteedObjQueue aObjects;
+		// The candidate list is kept per thread so its memory gets reused from
+		// one update to the next.
+		static thread_local TUnguaranteedObjList s_aObjects;
+		TUnguaranteedObjList &aObjects = s_aObjects;
+		aObjects.clear();
 
-		uint32 nUnguaranteedLength = 0;
+		uint32 nUnguaranteedLength = pInfo->m_cUnguaranteed.Size();
 
 		const float k_fDistPriorityScale = 1.0f / 128.0f;
+		const float k_fDistPriorityScaleSqr = k_fDistPriorityScale * k_fDistPriorityScale;
 
-		for (uint32 i = 0; i < NUM_OBJECTTYPES; i++)
+		CSendCandidateIter cCandidates(pObjectMgr, pInfo);
+		LTObject *pObject;
+		while ((pObject = cCandidates.Next()) != LTNULL)
 		{
-			LTLink *pListHead = &pObjectMgr->m_ObjectLists[i].m_Head;
-			for (LTLink *pCur = pListHead->m_pNext; pCur != pListHead; pCur = pCur->m_pNext)
-			{
-				LTObject *pObject = (LTObject*)pCur->m_pData;
-
-				if ((pObject->sd->m_NetFlags & k_nUnguaranteedMask) == 0)
-					continue;
+			if ((pObject->sd->m_NetFlags & k_nUnguaranteedMask) == 0)
+				continue;
 
+			//Determine the weight of this message based upon some rules
+			ObjInfo* pObjInfo = &pInfo->m_pClient->m_ObjInfos[pObject->m_ObjectID];
 
-				CUnguaranteedObjTrack cCurObj;
-				cCurObj.m_pObject = pObject;
+			float fDistToClientSqr = LTMAX(pObject->m_Pos.DistSqr(pInfo->m_pClient->m_ViewPos) * k_fDistPriorityScaleSqr, 1.0f);
+			float fSize = pObject->m_Dims.MagSqr();
+			float fSpeed = (pObject->m_Velocity.MagSqr() * k_fDistPriorityScaleSqr) + 1.0f;
 
-				//Determine the weight of this message based upon some rules
-				ObjInfo* pObjInfo = &pInfo->m_pClient->m_ObjInfos[pObject->m_ObjectID];
+			// Objects that don't make it into the packet keep their priority, so
+			// starved objects climb the list until they get sent.
+			pObjInfo->m_fUnguaranteedPriority += (fSize * fSpeed) / fDistToClientSqr;
 
-				float fDistToClient = LTMAX(pObject->m_Pos.Dist(pInfo->m_pClient->m_ViewPos) * k_fDistPriorityScale, 1.0f);
-				float fTime = (float)(pInfo->m_nUpdateTime - pObjInfo->m_nLastSentU) + 1.0f;
-				float fSize = pObject->m_Dims.MagSqr();
-				float fSpeed = (pObject->m_Velocity.Mag() * k_fDistPriorityScale) + 1.0f;
-				cCurObj.m_fPriority = (fTime * fSize * fSpeed) / fDistToClient;
+			CUnguaranteedObjTrack cCurObj;
+			cCurObj.m_pObject = pObject;
+			cCurObj.m_fPriority = pObjInfo->m_fUnguaranteedPriority;
 
-				aObjects.push(cCurObj);
-			}
+			aObjects.push_back(cCurObj);
 		}
 
-		while (!aObjects.empty())
-		{
-			const CUnguaranteedObjTrack &cCurObj = aObjects.top();
+		// Only order as many objects as are likely to fit.  If the budget isn't
+		// used up by then, pick the next (bigger) batch from what's left.
+		uint32 nSelected = 0;
+		uint32 nBatchSize = LTMAX(nUpdateSizeRemaining / k_nEstimatedUnguaranteedObjBits, 1);
+		bool bFull = false;
 
-			//write out all the unguaranteed data
-			WriteUnguaranteedDataWithAttachments(cCurObj.m_pObject, pInfo->m_cUnguaranteed, k_nUnguaranteedMask);
+		while (!bFull && (nSelected < aObjects.size()))
+		{
+			uint32 nCount = LTMIN(nBatchSize, (uint32)aObjects.size() - nSelected);
+			TUnguaranteedObjList::iterator iBegin = aObjects.begin() + nSelected;
+			TUnguaranteedObjList::iterator iEnd = iBegin + nCount;
+			std::partial_sort(iBegin, iEnd, aObjects.end());
 
-			// Jump out if we're sending too much...
-			if (pInfo->m_cUnguaranteed.Size() >= nUpdateSizeRemaining)
+			for (TUnguaranteedObjList::iterator iCur = iBegin; iCur != iEnd; ++iCur)
 			{
-				break;
-			}
-			else
-				nUnguaranteedLength = pInfo->m_cUnguaranteed.Size();
+				//write out all the unguaranteed data
+				WriteUnguaranteedDataWithAttachments(iCur->m_pObject, pInfo->m_cUnguaranteed, k_nUnguaranteedMask);
 
-			// Update the send time
-			UpdateSendTimeWithAttachments(cCurObj.m_pObject, pInfo, k_nUnguaranteedMask);
+				// Jump out if we're sending too much...
+				if (pInfo->m_cUnguaranteed.Size() >= nUpdateSizeRemaining)
+				{
+					bFull = true;
+					break;
+				}
+				else
+					nUnguaranteedLength = pInfo->m_cUnguaranteed.Size();
 
-			// Next!
-			aObjects.pop();
-		}
+				// Update the send time
+				UpdateSendTimeWithAttachments(iCur->m_pObject, pInfo, k_nUnguaranteedMask);
+			}
 
-		// Forget the left-overs
-		while (!aObjects.empty())
-			aObjects.pop();
+			nSelected += nCount;
+			nBatchSize *= 2;
+		}
 
 		// Strip the end of the packet
 		if (nUnguaranteedLength != pInfo->m_cUnguaranteed.Size())
@@ -1413,28 +1494,24 @@ void SendAllObjectsUnguaranteed(ObjectMgr *pObjectMgr, UpdateInfo *pInfo)
 }
 
 
-void sm_UpdateClientInWorld(Client *pClient)
+// Sets up the client's update.  Returns false if the client shouldn't be
+// updated this frame.
+static bool sm_BeginClientUpdate(Client *pClient, UpdateInfo *pInfo)
 {
 	// If the client's queue is backed up, wait until it's ok.
 	if (IsClientInTrouble(pClient))
 	{
-		return;
+		return false;
 	}
 
 	// If they're not in the world, they don't need to be updated...
 	if (pClient->m_State != CLIENT_INWORLD)
-		return;
-
-	// Init the update info
-	UpdateInfo updateInfo;
-	updateInfo.m_cPacket.Writeuint8(SMSG_UPDATE);
-	updateInfo.m_cUnguaranteed.Writeuint8(SMSG_UNGUARANTEEDUPDATE);
-	updateInfo.m_pClient = pClient;
+		return false;
 
 	// Keep track of time
-	updateInfo.m_nUpdateTime = timeGetTime();
-	uint32 nTimeSinceUpdate = updateInfo.m_nUpdateTime - pClient->m_nLastUpdateTime;
-	pClient->m_nLastUpdateTime = updateInfo.m_nUpdateTime;
+	uint32 nUpdateTime = timeGetTime();
+	uint32 nTimeSinceUpdate = nUpdateTime - pClient->m_nLastUpdateTime;
+	pClient->m_nLastUpdateTime = nUpdateTime;
 
 	// Get the available bandwidth
 	// Note : We're more interested in multi-frame bandwidth usage.
@@ -1443,35 +1520,61 @@ void sm_UpdateClientInWorld(Client *pClient)
 	if (nAvailableBandwidth <= 0)
 	{
 		// Don't update them if we're choking
-		return;
+		return false;
 	}
-	updateInfo.m_nTargetUpdateSize = (uint32)nAvailableBandwidth;
 
-	SentList *pPrevList = &pClient->m_SentLists[pClient->m_iPrevSentList];
-	SentList *pCurList = &pClient->m_SentLists[!pClient->m_iPrevSentList];
-	g_pCurSentList = pCurList;
+	// Init the update info
+	pInfo->m_cPacket.Writeuint8(SMSG_UPDATE);
+	pInfo->m_cUnguaranteed.Writeuint8(SMSG_UNGUARANTEEDUPDATE);
+	pInfo->m_pClient = pClient;
+	pInfo->m_nUpdateTime = nUpdateTime;
+	pInfo->m_nTargetUpdateSize = (uint32)nAvailableBandwidth;
+	pInfo->m_bInterestSet = false;
+	pInfo->m_pInterestObjects = LTNULL;
+	pInfo->m_nInterestObjects = 0;
+
+	pInfo->m_pPrevSentList = &pClient->m_SentLists[pClient->m_iPrevSentList];
+	pInfo->m_pCurSentList = &pClient->m_SentLists[!pClient->m_iPrevSentList];
 
 	// Clear the CF_SENTINFO flag on all the objects we sent info on earlier.
+	SentList *pPrevList = pInfo->m_pPrevSentList;
 	for (uint32 i = 0; i < pPrevList->m_nObjectIDs; i++)
 	{
 		pClient->m_ObjInfos[pPrevList->m_ObjectIDs[i]].m_ChangeFlags &= ~CF_SENTINFO;
 	}
 
 	// Build the new SentInfo list.
-	pCurList->m_nObjectIDs = 0;
+	pInfo->m_pCurSentList->m_nObjectIDs = 0;
+
+	// Figure out which objects this client cares about.  Local clients share
+	// the server's objects so they always get everything.
+	if (sm_IsInterestEnabled() && !(pClient->m_ClientFlags & CFLAG_LOCAL))
+	{
+		pInfo->m_bInterestSet = true;
+		pInfo->m_pInterestObjects = sm_UpdateClientInterest(pClient, pInfo->m_nInterestObjects);
+	}
 
+	return true;
+}
+
+// Writes the guaranteed object updates.  Only touches the client's own state,
+// so it's safe to run for several clients at once.
+static void sm_WriteClientGuaranteedObjects(UpdateInfo *pInfo)
+{
 #ifdef USE_LOCAL_STUFF
-	if (!(pClient->m_ClientFlags & CFLAG_LOCAL))
+	if (!(pInfo->m_pClient->m_ClientFlags & CFLAG_LOCAL))
 #endif
 	{
-		// Activate everything they can see.
-		{
-			CountAdder cTicks_ClientVis(&g_Ticks_ClientVis);
-
-			// Send all the alive objects to the client
-			SendAllObjectsGuaranteed(&g_pServerMgr->m_ObjectMgr, &updateInfo);
-		}
+		// Send all the alive objects to the client
+		SendAllObjectsGuaranteed(&g_pServerMgr->m_ObjectMgr, pInfo);
 	}
+}
+
+// Writes the events, sound tracks and object removes.  These touch shared
+// reference counts so this always runs on the main thread.
+static void sm_WriteClientEvents(UpdateInfo *pInfo)
+{
+	Client *pClient = pInfo->m_pClient;
 
 	// Add all the event subpackets.
 	LTLink *pCur = pClient->m_Events.m_Head.m_pNext;
@@ -1480,7 +1583,7 @@ void sm_UpdateClientInWorld(Client *pClient)
 		LTLink *pNext = pCur->m_pNext;
 	 	CServerEvent *pEvent = (CServerEvent*)pCur->m_pData;
 	
-		WriteEventToPacket(pEvent, pClient, updateInfo.m_cPacket);
+		WriteEventToPacket(pEvent, pClient, pInfo->m_cPacket);
 
 		dl_RemoveAt(&pClient->m_Events, pCur);
 		pEvent->DecrementRefCount();
@@ -1489,23 +1592,34 @@ void sm_UpdateClientInWorld(Client *pClient)
 	}
 
  	// Send sound tracking data.
-	sm_SendSoundTracks(&updateInfo, updateInfo.m_cPacket);
+	sm_SendSoundTracks(pInfo, pInfo->m_cPacket);
 	
 	// Write the list of objects to remove (objects we didn't send info on).
-	WriteObjectRemoves(&updateInfo, pPrevList);
+	WriteObjectRemoves(pInfo, pInfo->m_pPrevSentList);
 
 	// Clear out the change status on all the sound objects
-	ClearSoundChangeFlags(&updateInfo);
+	ClearSoundChangeFlags(pInfo);
+}
 
+// Writes the unguaranteed object updates.  Like the guaranteed objects, this
+// is safe to run for several clients at once.
+static void sm_WriteClientUnguaranteedObjects(UpdateInfo *pInfo)
+{
 	// Write unguaranteed stuff. 
-	SendAllObjectsUnguaranteed(&g_pServerMgr->m_ObjectMgr, &updateInfo);
+	SendAllObjectsUnguaranteed(&g_pServerMgr->m_ObjectMgr, pInfo);
 
 	// Mark the end of the unguaranteed info
-	WriteEndUpdateInfo(pClient, updateInfo.m_cUnguaranteed);
+	WriteEndUpdateInfo(pInfo->m_pClient, pInfo->m_cUnguaranteed);
+}
+
+// Hands the finished packets to the net driver.
+static void sm_FinishClientUpdate(UpdateInfo *pInfo)
+{
+	Client *pClient = pInfo->m_pClient;
 
 	// Send them..
-	sm_FlushUpdate(&updateInfo, CPacket_Read(updateInfo.m_cPacket), MESSAGE_GUARANTEED);
-	sm_FlushUpdate(&updateInfo, CPacket_Read(updateInfo.m_cUnguaranteed), 0);
+	sm_FlushUpdate(pInfo, CPacket_Read(pInfo->m_cPacket), MESSAGE_GUARANTEED);
+	sm_FlushUpdate(pInfo, CPacket_Read(pInfo->m_cUnguaranteed), 0);
 
 	pClient->m_iPrevSentList = !pClient->m_iPrevSentList; // Swap this..
 
@@ -1525,6 +1639,107 @@ void sm_UpdateClientInWorld(Client *pClient)
 }
 
 
+void sm_UpdateClientInWorld(Client *pClient)
+{
+	UpdateInfo updateInfo;
+	if (!sm_BeginClientUpdate(pClient, &updateInfo))
+		return;
+
+	// Activate everything they can see.
+	{
+		CountAdder cTicks_ClientVis(&g_Ticks_ClientVis);
+		sm_WriteClientGuaranteedObjects(&updateInfo);
+	}
+
+	sm_WriteClientEvents(&updateInfo);
+	sm_WriteClientUnguaranteedObjects(&updateInfo);
+	sm_FinishClientUpdate(&updateInfo);
+}
+
+
+static void GuaranteedObjectsJob(uint32 iJob, void *pUser)
+{
+	sm_WriteClientGuaranteedObjects(&((UpdateInfo*)pUser)[iJob]);
+}
+
+static void UnguaranteedObjectsJob(uint32 iJob, void *pUser)
+{
+	sm_WriteClientUnguaranteedObjects(&((UpdateInfo*)pUser)[iJob]);
+}
+
+void sm_ClearDirtyTrackers(ObjectMgr *pObjectMgr)
+{
+	LTLink *pListHead = &pObjectMgr->m_ObjectLists[OT_MODEL].m_Head;
+	for (LTLink *pCur = pListHead->m_pNext; pCur != pListHead; pCur = pCur->m_pNext)
+	{
+		ModelInstance *pInst = ToModel((LTObject*)pCur->m_pData);
+		for (LTAnimTracker *pTracker = pInst->m_AnimTrackers; pTracker; pTracker = pTracker->GetNext())
+		{
+			pTracker->m_bDirty = false;
+		}
+	}
+}
+
+
+void sm_UpdateClientsInWorldParallel()
+{
+	uint32 nClients = 0;
+	LTLink *pListHead = &g_pServerMgr->m_Clients.m_Head;
+	for (LTLink *pCur = pListHead->m_pNext; pCur != pListHead; pCur = pCur->m_pNext) 
+	{
+		++nClients;
+	}
+
+	if (nClients == 0)
+		return;
+
+	// The update infos only live for this call, so they come from the frame arena.
+	CLTFrameArenaScope cArenaScope(lt_GetFrameArena());
+	UpdateInfo *pInfos = lt_GetFrameArena().AllocArray<UpdateInfo>(nClients);
+	for (uint32 i = 0; i < nClients; i++)
+	{
+		new (&pInfos[i]) UpdateInfo;
+	}
+
+	// Set up the updates on this thread, since that touches the world tree
+	// and the connections.
+	uint32 nUpdates = 0;
+	for (LTLink *pCur = pListHead->m_pNext; pCur != pListHead; pCur = pCur->m_pNext) 
+	{
+		if (sm_BeginClientUpdate((Client*)pCur->m_pData, &pInfos[nUpdates]))
+		{
+			++nUpdates;
+		}
+	}
+
+	// Fan the object updates out, with the shared bits in between on this thread.
+	// The unguaranteed pass depends on the size of the guaranteed packet so it
+	// has to wait for the events to be written.
+	{
+		CountAdder cTicks_ClientVis(&g_Ticks_ClientVis);
+		lt_GetJobPool().ParallelFor(nUpdates, GuaranteedObjectsJob, pInfos);
+	}
+
+	for (uint32 i = 0; i < nUpdates; i++)
+	{
+		sm_WriteClientEvents(&pInfos[i]);
+	}
+
+	lt_GetJobPool().ParallelFor(nUpdates, UnguaranteedObjectsJob, pInfos);
+
+	// Submit everything in client order.
+	for (uint32 i = 0; i < nUpdates; i++)
+	{
+		sm_FinishClientUpdate(&pInfos[i]);
+	}
+
+	for (uint32 i = 0; i < nClients; i++)
+	{
+		pInfos[i].~UpdateInfo();
+	}
+}
+
+
 Client* sm_FindClient(CBaseConn *connID)
 {
 	// otherwise, search for the corresponding client in the client list
@@ -15,6 +15,8 @@ struct FTServ;
 class HHashTable;
 class CServerMgr;
 class CBaseConn;
+class CClientInterest;
+class ObjectMgr;
 
 // ----------------------------------------------------------------------- //
 // Client states.
@@ -88,9 +90,15 @@ struct ObjInfo
 	// Used for soundtracks...
 	uint8			m_nSoundFlags;
 
+	// Interest management flags (OBJINFOINTERESTF_ in s_interest.h).
+	uint8			m_nInterestFlags;
+
 	// Used for timing of networking updates
 	uint32			m_nLastSentG;
 	uint32			m_nLastSentU;
+
+	// Unguaranteed send priority accumulated since the object was last sent.
+	float			m_fUnguaranteedPriority;
 };
 
 #define OBJINFOSOUNDF_CLIENTDONE	(1<<0)		// Sound track has completed on this client
@@ -145,6 +153,9 @@ struct Client
 	SentList	m_SentLists[2];
 	uint32		m_iPrevSentList;
 
+	// Objects the client is interested in (see s_interest.h).
+	CClientInterest	*m_pInterest;
+
 	// Every client is associated with an object.
 	LTObject	*m_pObject;			
 
@@ -208,6 +219,15 @@ void sm_UpdateClientState(Client *pClient);
 // Updates the client if it's in the world.
 void sm_UpdateClientInWorld(Client *pClient);
 
+// Updates all the in-world clients, writing their update packets on the job
+// pool.  The packets are still handed to the net driver in client order.
+void sm_UpdateClientsInWorldParallel();
+
+// Animation trackers are shared between clients, so their dirty flags are
+// only cleared once every client has been written for the frame, whether the
+// clients were updated serially or in parallel.
+void sm_ClearDirtyTrackers(ObjectMgr *pObjectMgr);
+
 // Finds a client given its connection ID.
 Client* sm_FindClient(CBaseConn *connID);
 
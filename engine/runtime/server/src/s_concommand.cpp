@@ -7,6 +7,14 @@
 #include "dhashtable.h"
 #include "s_client.h"
 #include "ltobjectcreate.h"
+#include "packet.h"
+#include "transformmaker.h"
+#include "impl_common.h"
+#include "world_shared_bsp.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
 
 //------------------------------------------------------------------
 //------------------------------------------------------------------
@@ -273,6 +281,158 @@ void con_SpawnObject(int argc, const char **argv)
 }
 
 
+void con_PacketStats(int argc, const char **argv)
+{
+    CPacket_Data::SAllocStats cStats;
+    CPacket_Data::GetAllocStats(&cStats);
+
+    dsi_PrintToConsole("Packets: %d active, %d allocated", cStats.m_nActivePackets, cStats.m_nAllocatedPackets);
+    dsi_PrintToConsole("Chunks: %d active, %d allocated, %d shared free", 
+        cStats.m_nActiveChunks, cStats.m_nAllocatedChunks, cStats.m_nSharedChunks);
+    dsi_PrintToConsole("Thread caches: %d, holding %d chunks (max %d)", 
+        cStats.m_nThreadCaches, cStats.m_nThreadCachedChunks, cStats.m_nMaxThreadCachedChunks);
+}
+
+
+// AnimBench [iterations]
+// Times the recursive and batched TransformMaker evaluators on every animated
+// model in the world and reports how far apart their results are.
+void con_AnimBench(int argc, const char **argv)
+{
+    LTLink *pCur, *pListHead;
+    LTObject *pObj;
+    uint32 nIterations, nModels;
+    float fRecurseMS, fBatchedMS, fMaxError;
+    float fTotalRecurseMS, fTotalBatchedMS, fTotalMaxError;
+
+    nIterations = (argc >= 1) ? (uint32)atoi(argv[0]) : 100;
+    nIterations = LTMAX(nIterations, 1);
+
+    nModels = 0;
+    fTotalRecurseMS = fTotalBatchedMS = fTotalMaxError = 0.0f;
+
+    pListHead = &g_pServerMgr->m_Objects.m_Head;
+    for (pCur=pListHead->m_pNext; pCur != pListHead; pCur=pCur->m_pNext)
+    {
+        pObj = (LTObject*)pCur->m_pData;
+        if (pObj->m_ObjectType != OT_MODEL)
+            continue;
+
+        ModelInstance *pInstance = pObj->ToModel();
+        if (!TransformMaker::Benchmark(pInstance, nIterations, fRecurseMS, fBatchedMS, fMaxError))
+            continue;
+
+        dsi_PrintToConsole("%-40s %3d nodes: recursive %7.4f ms, batched %7.4f ms, max error %g",
+            pInstance->GetModelDB()->GetFilename(), pInstance->GetModelDB()->NumNodes(),
+            fRecurseMS / nIterations, fBatchedMS / nIterations, fMaxError);
+
+        ++nModels;
+        fTotalRecurseMS += fRecurseMS;
+        fTotalBatchedMS += fBatchedMS;
+        fTotalMaxError = LTMAX(fTotalMaxError, fMaxError);
+    }
+
+    dsi_PrintToConsole("AnimBench: %d models, %d iterations: recursive %.3f ms, batched %.3f ms per pass, max error %g",
+        nModels, nIterations, fTotalRecurseMS / nIterations, fTotalBatchedMS / nIterations, fTotalMaxError);
+}
+
+
+// WorldLoadBench <directory> [iterations]
+// Loads the BSPs of every world in a directory without bringing the world up
+// and reports how long each took and where the time went.
+void con_WorldLoadBench(int argc, const char **argv)
+{
+    uint32 i, nIterations, nWorlds, nFailed;
+    WorldBspLoadTimes times, worldTimes;
+
+    if (argc < 1)
+    {
+        dsi_PrintToConsole("Usage: WorldLoadBench <directory> [iterations]");
+        return;
+    }
+
+    nIterations = (argc >= 2) ? (uint32)atoi(argv[1]) : 1;
+    nIterations = LTMAX(nIterations, 1);
+
+    // Gather the worlds in the directory.
+    std::vector<std::string> files;
+    FileEntry *pList = server_filemgr->GetFileList(argv[0]);
+    for (FileEntry *pEntry=pList; pEntry; pEntry=pEntry->m_pNext)
+    {
+        if (pEntry->m_Type != TYPE_FILE)
+            continue;
+
+        const char *pExt = strrchr(pEntry->m_pBaseFilename, '.');
+        if (pExt && stricmp(pExt, ".dat") == 0)
+        {
+            files.push_back(pEntry->m_pFullFilename);
+        }
+    }
+    ic_FreeFileList(pList);
+
+    if (files.empty())
+    {
+        dsi_PrintToConsole("WorldLoadBench: no worlds in %s", argv[0]);
+        return;
+    }
+
+    nWorlds = nFailed = 0;
+    double fTotalMS = 0.0;
+
+    for (std::vector<std::string>::iterator it=files.begin(); it != files.end(); ++it)
+    {
+        worldTimes.Clear();
+
+        ELoadWorldStatus status = LoadWorld_Ok;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        for (i=0; i < nIterations && status == LoadWorld_Ok; i++)
+        {
+            ILTStream *pStream = server_filemgr->OpenFile(it->c_str());
+            if (!pStream)
+            {
+                status = LoadWorld_Error;
+                break;
+            }
+
+            status = IWorldSharedBSP::BenchmarkBspLoad(pStream, worldTimes);
+            pStream->Release();
+        }
+
+        double fWorldMS = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (status != LoadWorld_Ok)
+        {
+            dsi_PrintToConsole("%-40s failed (%d)", it->c_str(), (int)status);
+            ++nFailed;
+            continue;
+        }
+
+        dsi_PrintToConsole("%-40s %4d bsps, %7.2f MB: %8.3f ms (%8.3f ms in WorldBsp::Load)",
+            it->c_str(), worldTimes.m_nBsps / nIterations,
+            (float)worldTimes.m_nBytes / (nIterations * 1024.0f * 1024.0f),
+            fWorldMS / nIterations, worldTimes.GetTotal() * 1000.0 / nIterations);
+
+        for (i=0; i < WorldBspLoadTimes::kNumSections; i++)
+            times.m_fSeconds[i] += worldTimes.m_fSeconds[i];
+
+        times.m_nBsps += worldTimes.m_nBsps;
+        times.m_nBytes += worldTimes.m_nBytes;
+        fTotalMS += fWorldMS;
+        ++nWorlds;
+    }
+
+    dsi_PrintToConsole("WorldLoadBench: %d worlds (%d failed), %d iterations, %.3f ms per pass",
+        nWorlds, nFailed, nIterations, fTotalMS / nIterations);
+
+    for (i=0; i < WorldBspLoadTimes::kNumSections; i++)
+    {
+        dsi_PrintToConsole("  %-14s %8.3f ms", WorldBspLoadTimes::GetSectionName(i),
+            times.m_fSeconds[i] * 1000.0 / nIterations);
+    }
+}
+
+
 // ------------------------------------------------------------------ //
 // Tables.
 // ------------------------------------------------------------------ //
@@ -286,6 +446,9 @@ static LTCommandStruct g_ServerCommandStructs[] =
     { "DisableWMPhysics", con_DisableWMPhysics, 0 },
     { "ExhaustMemory", con_ExhaustMemory, 0 },
     { "SpawnObject", con_SpawnObject, 0 },
+    { "PacketStats", con_PacketStats, 0 },
+    { "AnimBench", con_AnimBench, 0 },
+    { "WorldLoadBench", con_WorldLoadBench, 0 },
 	{ "Mem", LTMemConsole, 0 },
 };
 
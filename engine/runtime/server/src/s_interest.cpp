@@ -0,0 +1,220 @@
+#include "bdefs.h"
+
+#include "s_interest.h"
+#include "s_client.h"
+#include "servermgr.h"
+#include "world_tree.h"
+
+#include <vector>
+
+//------------------------------------------------------------------
+//------------------------------------------------------------------
+// Holders and their headers.
+//------------------------------------------------------------------
+//------------------------------------------------------------------
+
+//IWorld holder
+#include "world_server_bsp.h"
+static IWorldServerBSP *world_bsp_server;
+define_holder(IWorldServerBSP, world_bsp_server);
+
+
+extern float g_CV_NetInterestRadius;
+extern float g_CV_NetInterestHysteresis;
+
+
+// Per-client interest state.
+class CClientInterest
+{
+public:
+	// The objects in the interest set built on the last update.
+	std::vector<LTObject*>	m_Objects;
+
+	// IDs of the objects in m_Objects, used to clear their relevance flags on
+	// the next update (the objects themselves may be gone by then).
+	std::vector<uint16>		m_PrevIDs;
+};
+
+
+// Objects that are relevant to every client, rebuilt once per server frame.
+static std::vector<LTObject*> g_InterestGlobals;
+
+
+// Context for the WorldTree query.
+struct InterestQuery
+{
+	Client				*m_pClient;
+	CClientInterest		*m_pInterest;
+	LTVector			m_vViewPos;
+	float				m_fEnterDistSqr;
+	float				m_fLeaveDistSqr;
+};
+
+
+// Returns true if the object should be replicated to every client no matter
+// where the client is.
+static bool IsGloballyRelevant(LTObject *pObject)
+{
+	// Forced updates are always sent.
+	if (pObject->m_Flags & FLAG_FORCECLIENTUPDATE)
+		return true;
+
+	// Objects that aren't in the world tree can't be found by the spatial query.
+	if (!pObject->IsInWorldTree())
+		return true;
+
+	// Camera-relative objects sit on the always-visible list rather than the nodes.
+	if (pObject->m_Flags & FLAG_REALLYCLOSE)
+		return true;
+
+	// The sky is drawn no matter where the client is.
+	if (pObject->m_InternalFlags & IFLAG_INSKY)
+		return true;
+
+	// A light's influence reaches past its bounding box.
+	if (pObject->m_ObjectType == OT_LIGHT)
+		return true;
+
+	return false;
+}
+
+
+// Squared distance from a point to an axis-aligned box (0 if inside).
+inline float DistSqrToBox(const LTVector &vPt, const LTVector &vMin, const LTVector &vMax)
+{
+	float fDistSqr = 0.0f;
+	for (uint32 i = 0; i < 3; i++)
+	{
+		float fDelta = 0.0f;
+		if (vPt[i] < vMin[i])
+			fDelta = vMin[i] - vPt[i];
+		else if (vPt[i] > vMax[i])
+			fDelta = vPt[i] - vMax[i];
+
+		fDistSqr += fDelta * fDelta;
+	}
+
+	return fDistSqr;
+}
+
+
+inline void AddToInterestSet(CClientInterest *pInterest, ObjInfo *pObjInfo, LTObject *pObject)
+{
+	if (pObjInfo->m_nInterestFlags & OBJINFOINTERESTF_ADDED)
+		return;
+
+	pObjInfo->m_nInterestFlags |= OBJINFOINTERESTF_ADDED;
+	pInterest->m_Objects.push_back(pObject);
+}
+
+
+// Called by WorldTree::FindObjectsInBox.
+static void InterestQueryCB(WorldTreeObj *pObj, void *pUser)
+{
+	if (pObj->GetObjType() != WTObj_DObject)
+		return;
+
+	InterestQuery *pQuery = (InterestQuery*)pUser;
+	LTObject *pObject = (LTObject*)pObj;
+	ObjInfo *pObjInfo = &pQuery->m_pClient->m_ObjInfos[pObject->m_ObjectID];
+
+	// Objects that were relevant last update get to stay until they pass the
+	// outer radius.
+	float fMaxDistSqr = (pObjInfo->m_nInterestFlags & OBJINFOINTERESTF_RELEVANT) ?
+		pQuery->m_fLeaveDistSqr : pQuery->m_fEnterDistSqr;
+
+	if (DistSqrToBox(pQuery->m_vViewPos, pObject->GetBBoxMin(), pObject->GetBBoxMax()) > fMaxDistSqr)
+		return;
+
+	AddToInterestSet(pQuery->m_pInterest, pObjInfo, pObject);
+}
+
+
+bool sm_IsInterestEnabled()
+{
+	return g_CV_NetInterestRadius > 0.0f;
+}
+
+
+void sm_BeginInterestFrame(ObjectMgr *pObjectMgr)
+{
+	g_InterestGlobals.clear();
+
+	if (!sm_IsInterestEnabled())
+		return;
+
+	for (uint32 i = 0; i < NUM_OBJECTTYPES; i++)
+	{
+		LTLink *pListHead = &pObjectMgr->m_ObjectLists[i].m_Head;
+		for (LTLink *pCur = pListHead->m_pNext; pCur != pListHead; pCur = pCur->m_pNext)
+		{
+			LTObject *pObject = (LTObject*)pCur->m_pData;
+
+			if (IsGloballyRelevant(pObject))
+				g_InterestGlobals.push_back(pObject);
+		}
+	}
+}
+
+
+LTObject** sm_UpdateClientInterest(Client *pClient, uint32 &nObjects)
+{
+	if (!pClient->m_pInterest)
+	{
+		LT_MEM_TRACK_ALLOC(pClient->m_pInterest = new CClientInterest, LT_MEM_TYPE_MISC);
+	}
+
+	CClientInterest *pInterest = pClient->m_pInterest;
+	pInterest->m_Objects.clear();
+
+	// Globally relevant objects and the client's own object come first.
+	for (std::vector<LTObject*>::iterator iCur = g_InterestGlobals.begin(); iCur != g_InterestGlobals.end(); ++iCur)
+	{
+		AddToInterestSet(pInterest, &pClient->m_ObjInfos[(*iCur)->m_ObjectID], *iCur);
+	}
+
+	if (pClient->m_pObject)
+	{
+		AddToInterestSet(pInterest, &pClient->m_ObjInfos[pClient->m_pObject->m_ObjectID], pClient->m_pObject);
+	}
+
+	// Then everything near the view position.
+	float fHysteresis = LTMAX(g_CV_NetInterestHysteresis, 1.0f);
+	float fLeaveRadius = g_CV_NetInterestRadius * fHysteresis;
+
+	InterestQuery cQuery;
+	cQuery.m_pClient = pClient;
+	cQuery.m_pInterest = pInterest;
+	cQuery.m_vViewPos = pClient->m_ViewPos;
+	cQuery.m_fEnterDistSqr = g_CV_NetInterestRadius * g_CV_NetInterestRadius;
+	cQuery.m_fLeaveDistSqr = fLeaveRadius * fLeaveRadius;
+
+	LTVector vExtents(fLeaveRadius, fLeaveRadius, fLeaveRadius);
+	LTVector vMin = pClient->m_ViewPos - vExtents;
+	LTVector vMax = pClient->m_ViewPos + vExtents;
+	world_bsp_server->ServerTree()->FindObjectsInBox(&vMin, &vMax, InterestQueryCB, &cQuery);
+
+	// Swap the relevance flags over to the new set.
+	for (std::vector<uint16>::iterator iCur = pInterest->m_PrevIDs.begin(); iCur != pInterest->m_PrevIDs.end(); ++iCur)
+	{
+		pClient->m_ObjInfos[*iCur].m_nInterestFlags &= ~OBJINFOINTERESTF_RELEVANT;
+	}
+
+	pInterest->m_PrevIDs.clear();
+	for (std::vector<LTObject*>::iterator iCur = pInterest->m_Objects.begin(); iCur != pInterest->m_Objects.end(); ++iCur)
+	{
+		pClient->m_ObjInfos[(*iCur)->m_ObjectID].m_nInterestFlags = OBJINFOINTERESTF_RELEVANT;
+		pInterest->m_PrevIDs.push_back((*iCur)->m_ObjectID);
+	}
+
+	nObjects = (uint32)pInterest->m_Objects.size();
+	return pInterest->m_Objects.empty() ? LTNULL : &pInterest->m_Objects[0];
+}
+
+
+void sm_FreeClientInterest(Client *pClient)
+{
+	delete pClient->m_pInterest;
+	pClient->m_pInterest = LTNULL;
+}
+
@@ -0,0 +1,44 @@
+
+// This module implements spatial interest management for server-to-client
+// object replication.  Instead of considering every object in the world for
+// every client on every update, each client gets an interest set built from
+// a WorldTree box query around its view position, plus the handful of objects
+// that must always be replicated (forced updates, sky objects, lights, etc).
+//
+// Objects enter the set at NetInterestRadius and only leave it once they are
+// outside NetInterestRadius * NetInterestHysteresis so they don't flap in and
+// out at the boundary.  Objects that leave the set are removed on the client
+// through the normal sent-list mechanism.
+//
+// Interest management is disabled when NetInterestRadius is 0 (the default).
+
+#ifndef __S_INTEREST_H__
+#define __S_INTEREST_H__
+
+struct Client;
+class ObjectMgr;
+class CClientInterest;
+
+
+// ObjInfo::m_nInterestFlags.
+#define OBJINFOINTERESTF_RELEVANT	(1<<0)		// Object was in the client's interest set on the last update
+#define OBJINFOINTERESTF_ADDED		(1<<1)		// Object has been added to the interest set being built
+
+
+// Returns true if interest management is enabled.
+bool sm_IsInterestEnabled();
+
+// Collects the objects that are relevant to every client regardless of where
+// they are.  Called once per server frame before the in-world clients are updated.
+void sm_BeginInterestFrame(ObjectMgr *pObjectMgr);
+
+// Rebuilds the client's interest set and returns the objects in it.  The
+// returned array stays valid until the next call for this client.
+LTObject** sm_UpdateClientInterest(Client *pClient, uint32 &nObjects);
+
+// Frees the client's interest state.
+void sm_FreeClientInterest(Client *pClient);
+
+
+#endif  // __S_INTEREST_H__
+
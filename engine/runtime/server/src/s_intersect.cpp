@@ -1,6 +1,7 @@
 #include "bdefs.h"
 
 #include "fullintersectline.h"
+#include "s_object.h"
 
 
 //------------------------------------------------------------------
@@ -18,9 +19,19 @@ define_holder(IWorldServerBSP, world_bsp_server);
 
 bool ServerIntersectSegment(IntersectQuery *pQuery, IntersectInfo *pInfo)
 {
+	// This uses the world tree's scratch space and the objects' frame codes.
+	ASSERT(!sm_InDeferredUpdate());
+
 	return i_IntersectSegment(pQuery, pInfo, world_bsp_server->ServerTree());
 }
 
+uint32 ServerIntersectSegmentBatch(IntersectQuery *pQueries, IntersectInfo *pInfos, uint32 nQueries, uint32 batchFlags)
+{
+	ASSERT(!sm_InDeferredUpdate());
+
+	return i_IntersectSegmentBatch(pQueries, pInfos, nQueries, batchFlags, world_bsp_server->ServerTree());
+}
+
 
 
 
@@ -372,6 +372,9 @@ void sm_WriteChangedModelFiles(LTObject *pObj, CPacket_Write &cPacket, ObjectCre
 // ----------------------------------------------------------------------- //
 // Writes the model animation info into the packet.
 // ----------------------------------------------------------------------- //
+// The tracker dirty flags are left alone here, since every client being
+// updated this frame needs to see them.  sm_ClearDirtyTrackers clears them
+// once all the clients have been written.
 void WriteAnimInfo(ModelInstance *pInst, CPacket_Write &cPacket)
 {
 	for (LTAnimTracker *pTracker = pInst->m_AnimTrackers; pTracker; pTracker=pTracker->GetNext())
@@ -402,7 +405,6 @@ void WriteAnimInfo(ModelInstance *pInst, CPacket_Write &cPacket)
 				if(pTracker->m_bDirty)
 				{
 					cPacket.Writebool(true);
-					pTracker->m_bDirty = false;
 				}
 				else
 				{
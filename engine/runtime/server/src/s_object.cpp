@@ -293,6 +293,18 @@ uint32 sm_GetNewObjectChangeFlags(LTObject *pObject)
 // ----------------------------------------------------------------------- //
 
 void FullObjectUpdate(LTObject *pObj)
+{
+    ModelObjectUpdate(pObj);
+
+    if (!GameObjectUpdate(pObj))
+        return;
+
+    // Update the object's physics.
+    PhysicsUpdateObject(pObj);
+}
+
+
+void ModelObjectUpdate(LTObject *pObj)
 {
     // Update its server object if its a model instance.
 	if (pObj->m_ObjectType == OT_MODEL)
@@ -308,7 +320,11 @@ void FullObjectUpdate(LTObject *pObj)
 			}
 		}
     }
+}
+
 
+bool GameObjectUpdate(LTObject *pObj)
+{
     // Update the object (if the m_NextUpdate countdown has gone past zero).
     if (pObj->sd->m_NextUpdate > 0.0f)
     {
@@ -321,12 +337,11 @@ void FullObjectUpdate(LTObject *pObj)
 
             // Don't do anything else if it was removed.
             if (!(pObj->m_InternalFlags & IFLAG_INWORLD))
-                return;
+                return false;
         }
     }
 
-    // Update the object's physics.
-    PhysicsUpdateObject(pObj);
+    return true;
 }
 
 
@@ -643,6 +658,9 @@ void sm_SetObjectStateFlags(LTObject *pObj, uint32 flags)
 
     ASSERT((flags & ~IFLAG_INACTIVE_MASK) == 0);
 
+    // This moves the object around in the shared object list.
+    ASSERT(!sm_InDeferredUpdate());
+
     oldFlags = pObj->m_InternalFlags & IFLAG_INACTIVE_MASK;
     if (flags != oldFlags)
     {
@@ -739,6 +757,35 @@ uint16 sm_GetNewSoundTrackChangeFlags(CSoundTrack *pSoundTrack)
     return wChangeFlags;
 }
 
+// The object whose game update is running on this thread's job, if any.
+static thread_local LTObject *s_pDeferredUpdateObj = LTNULL;
+
+void sm_BeginDeferredUpdate(LTObject *pObj)
+{
+    ASSERT(!s_pDeferredUpdateObj);
+    s_pDeferredUpdateObj = pObj;
+}
+
+void sm_EndDeferredUpdate()
+{
+    s_pDeferredUpdateObj = LTNULL;
+}
+
+bool sm_InDeferredUpdate()
+{
+    return s_pDeferredUpdateObj != LTNULL;
+}
+
+void sm_ApplyDeferredChangeFlags(LTObject *pObj)
+{
+    uint32 flags = pObj->sd->m_DeferredChangeFlags;
+    if (flags == 0)
+        return;
+
+    pObj->sd->m_DeferredChangeFlags = 0;
+    SetObjectChangeFlags(pObj, flags);
+}
+
 void AddObjectToChangeList(LTObject *pObj)
 {
     if (!g_pServerMgr->m_bWorldLoaded)
@@ -755,6 +802,9 @@ void AddObjectToChangeList(LTObject *pObj)
     // Better not be re-adding it!
     ASSERT(!IsObjectInChangedList(pObj));
 
+	// The list is shared, so job pool updates have to defer this.
+	ASSERT(!sm_InDeferredUpdate());
+
 	dl_AddHead( &g_pServerMgr->m_ChangedObjectHead, &pObj->sd->m_ChangedNode, pObj );
 }
 
@@ -777,6 +827,16 @@ LTRESULT SetObjectChangeFlags(LTObject *pObj, uint32 flags)
     }
 
 
+    // Hold onto them until the main thread can add the object to
+    // the changed list.
+    if (sm_InDeferredUpdate())
+    {
+        // Thread safe updates may only change their own object.
+        ASSERT(pObj == s_pDeferredUpdateObj);
+        pObj->sd->m_DeferredChangeFlags |= (uint16)flags;
+        return LT_OK;
+    }
+
     // Make sure not to re-add it and screw it up.
     if (pObj->sd->m_ChangeFlags == 0)
     {
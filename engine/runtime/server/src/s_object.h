@@ -33,6 +33,17 @@ void AddObjectToChangeList(LTObject *pObj);
 // the object to the 'changed object' list.
 LTRESULT SetObjectChangeFlags(LTObject *pObj, uint32 flags);
 
+// While pObj's game update runs on the job pool, change flags set on it
+// are held in its m_DeferredChangeFlags instead of touching the shared
+// 'changed object' list.  sm_ApplyDeferredChangeFlags adds them on the
+// main thread once the jobs are done.  sm_InDeferredUpdate is true on the
+// thread running such an update, where anything that touches the world
+// tree or the object lists is not allowed.
+void sm_BeginDeferredUpdate(LTObject *pObj);
+void sm_EndDeferredUpdate();
+bool sm_InDeferredUpdate();
+void sm_ApplyDeferredChangeFlags(LTObject *pObj);
+
 // Registers a script callback function at a certain position for a model.
 bool RegisterModelCallback(LTObject *pObj, uint32 iAnim, uint32 msTime, char *pFunctionName);
 
@@ -55,6 +66,14 @@ void DeleteModels();
 // Fully updates the object (called once per frame).
 void FullObjectUpdate(LTObject *pObj);
 
+// The three parts of FullObjectUpdate, so objects that can update off the
+// main thread can have their game update run separately:  the model's
+// animation, the game object's update, and then physics.  GameObjectUpdate
+// returns false if the object was removed during its update.
+void ModelObjectUpdate(LTObject *pObj);
+bool GameObjectUpdate(LTObject *pObj);
+void PhysicsUpdateObject(LTObject *pObj);
+
 // Loads and instantiates objects from the given world file.
 LTRESULT LoadObjects(ILTStream *pStream, const char *pWorldName, bool bAllObjects, uint32 nObjectDataOffset );
 
@@ -113,6 +113,11 @@ ILTStream* IServerFileMgr::OpenFile2(const char *pFilename, int bAddUsedFile, sh
     if (hElement) {
         UsedFile *pUsedFile = (UsedFile*)hs_GetElementUserData(hElement);
         if (pUsedFile) {
+            ILTStream *pPrefetched = m_Prefetcher.Open(pUsedFile);
+            if (pPrefetched) {
+                return pPrefetched;
+            }
+
             return df_Open(pUsedFile->m_hFileTree, pFilename, 0);
         }
     }
@@ -148,6 +153,12 @@ ILTStream* IServerFileMgr::OpenFile3(UsedFile *pUsedFile) {
     const char *pFilename;
     char formattedFilename[256];
 
+    //use the prefetched copy if there is one.
+    ILTStream *pPrefetched = m_Prefetcher.Open(pUsedFile);
+    if (pPrefetched) {
+        return pPrefetched;
+    }
+
     pFilename = GetUsedFilename(pUsedFile);
 	CHelpers::FormatFilename(pFilename, formattedFilename, sizeof(formattedFilename));
 
@@ -156,6 +167,26 @@ ILTStream* IServerFileMgr::OpenFile3(UsedFile *pUsedFile) {
 }
 
 
+void IServerFileMgr::PrefetchFiles(UsedFile **ppFiles, uint32 nFiles, int32 priority) {
+    const char *pFilename;
+    char formattedFilename[256];
+
+    for (uint32 i = 0; i < nFiles; i++) {
+        if (!ppFiles[i]) continue;
+
+        pFilename = GetUsedFilename(ppFiles[i]);
+        CHelpers::FormatFilename(pFilename, formattedFilename, sizeof(formattedFilename));
+
+        m_Prefetcher.Prefetch(ppFiles[i], df_Open(ppFiles[i]->m_hFileTree, formattedFilename, DFOPEN_READ), priority);
+    }
+}
+
+
+void IServerFileMgr::FlushPrefetchedFiles() {
+    m_Prefetcher.Flush();
+}
+
+
 LTRESULT IServerFileMgr::CopyFile(const char *pSrc, const char *pDest) {
     //get first item in file tree list.
     SERVERFILEMGR_ELEMENT *cur = file_tree_list.First();
@@ -224,6 +255,17 @@ bool IServerFileMgr::DoesFileExist(const char *pFilename, HLTFileTree **phTree,
     return false;
 }
 
+bool IServerFileMgr::GetFullFilename(const char *pFilename, char *pOutName, uint32 maxLen) {
+    //find the tree the file is in.
+    HLTFileTree *hTree;
+    if (!DoesFileExist(pFilename, &hTree, NULL)) {
+        return false;
+    }
+
+    //only directory trees have real filenames.
+    return df_GetFullFilename(hTree, (char*)pFilename, pOutName, (int)maxLen) != 0;
+}
+
 
 FileEntry* IServerFileMgr::GetFileList(const char *pDirName) {
     //put all our file tree handles in an array.
@@ -374,6 +416,9 @@ void IServerFileMgr::ClearUsedFiles()
     HHashElement *hElement;
     UsedFile *pFile;
 
+    // Prefetches are keyed on the used files.
+    FlushPrefetchedFiles();
+
     hIterator = hs_GetFirstElement(m_hFileTable);
     while(hIterator)
     {
@@ -20,6 +20,10 @@
 #include "ltmodule.h"
 #endif
 
+#ifndef __LTRESOURCELOADER_H__
+#include "ltresourceloader.h"
+#endif
+
 
 class HHashElement;
 class HHashTable;
@@ -86,6 +90,9 @@ public:
 
 	ObjectBank<UsedFile>	m_UsedFileBank;
 
+	// Used files read in by PrefetchFiles that haven't been opened yet.
+	CLTFilePrefetcher	m_Prefetcher;
+
 
 public:
     //-------------------------------------------------------------
@@ -107,6 +114,13 @@ public:
     ILTStream* OpenFile2(const char *pFilename, int bAddUsedFile, short flags);
     ILTStream* OpenFile3(UsedFile *pUsedFile);
 
+    // Reads a batch of used files into memory on the resource loader's
+    // threads.  The next open of each one gets a stream over the memory copy.
+    void PrefetchFiles(UsedFile **ppFiles, uint32 nFiles, int32 priority);
+
+    // Throws away anything prefetched that hasn't been opened yet.
+    void FlushPrefetchedFiles();
+
     // Copy a file.  Returns LT_OK, LT_ERROR, or LT_NOTFOUND.
     LTRESULT CopyFile(const char *pSrc, const char *pDest);
 
@@ -114,6 +128,10 @@ public:
     //parameters are not NULL.
     bool DoesFileExist(const char *pFilename, HLTFileTree **phTree, uint32 *pFileSize);
 
+    // Gets the full path of a file that's on disk rather than in a rez file.
+    // Returns false if the file doesn't exist or is in a rez file.
+    bool GetFullFilename(const char *pFilename, char *pOutName, uint32 maxLen);
+
     // Get a file list.  Free it with ic_FreeFileList.
     FileEntry* GetFileList(const char *pDirName);
 
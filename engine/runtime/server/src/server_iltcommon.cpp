@@ -105,6 +105,9 @@ LTRESULT CLTCommonServer::SetObjectFlags(HOBJECT hObj, const ObjFlagType nFlagTy
 	{
 		case OFT_Flags :
         {
+            // This touches objects standing on it and the world tree.
+            ASSERT(!sm_InDeferredUpdate());
+
             // They changed a FLAGS_.
             hObj->m_InternalFlags |= IFLAG_APPLYPHYSICS;
             // If we're going to nonsolid, get rid of anything standing on us.
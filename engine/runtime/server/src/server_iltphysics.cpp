@@ -119,6 +119,9 @@ LTRESULT CLTPhysicsServer::SetObjectDims(HOBJECT hObj, LTVector *pNewDims, uint3
     pObj = HandleToServerObj(hObj);
     CHECK_PARAMS(hObj && pNewDims, SPhysicsLT::SetObjectDims);
 
+    // Resizing relocates the object in the world tree.
+    ASSERT(!sm_InDeferredUpdate());
+
     // Not allowed to change a WorldModel's dimensions!
     if (pObj->m_ObjectType != OT_CONTAINER && pObj->m_ObjectType != OT_WORLDMODEL)
     {
@@ -130,6 +130,7 @@ public:
 
 
 extern bool ServerIntersectSegment(IntersectQuery *pQuery, IntersectInfo *pInfo);
+extern uint32 ServerIntersectSegmentBatch(IntersectQuery *pQueries, IntersectInfo *pInfos, uint32 nQueries, uint32 batchFlags);
 
 
 // --------------------------------------------------------------- //
@@ -448,6 +449,8 @@ LTRESULT CLTServer::RemoveObject(const HCLASS hClass, LPBASECLASS pObject)
 	if (!hClass || !pObject)
 		return LT_ERROR;
 
+	ASSERT(!sm_InDeferredUpdate());
+
 	CClassData *pClassData = (CClassData*)hClass;
 
 	// Only class-only objects, please
@@ -1017,6 +1020,9 @@ LTRESULT CLTServer::RemoveObject(HOBJECT hObject)
 	if (!hObject)
 		return LT_ERROR;
 
+	// The remove list is shared.
+	ASSERT(!sm_InDeferredUpdate());
+
 	pObject = HandleToServerObj(hObject);
 	AddObjectToRemoveList(pObject);
 
@@ -1258,6 +1264,9 @@ LTRESULT CLTServer::SendToClient(ILTMessage_Read *pMsg, HCLIENT hSendTo, uint32
 	FN_NAME(CLTServer::SendToClient);
 	CHECK_PARAMS2(pMsg);
 
+	// The connections' outgoing queues are only filled from the main thread.
+	ASSERT(!sm_InDeferredUpdate());
+
 	// Reference the message just in case
 	CLTMsgRef_Read cMsgRef(pMsg);
 	CLTMessage_Read *pServerMsg = reinterpret_cast<CLTMessage_Read *>(pMsg);
@@ -1287,6 +1296,9 @@ LTRESULT CLTServer::SendToObject(ILTMessage_Read *pMsg, HOBJECT hSender, HOBJECT
 {
 	CHECK_PARAMS(hSendTo && pMsg, ILTServer::SendToObject);
 
+	// This runs the other object's message handler right here.
+	ASSERT(!sm_InDeferredUpdate());
+
 	// Reference the message just in case
 	CLTMsgRef_Read cMsgRef(pMsg);
 
@@ -1582,6 +1594,9 @@ void SphereFindCallback(WorldTreeObj *pObj, void *pCBUser)
 
 ObjectList* si_FindObjectsTouchingSphere(const LTVector *pPosition, float radius)
 {
+	// The world tree query and the list banks aren't thread safe.
+	ASSERT(!sm_InDeferredUpdate());
+
 	SphereFindStruct theStruct;
 
 	// Setup the global stuff.
@@ -1633,6 +1648,8 @@ void BoxFindCallback(WorldTreeObj *pObj, void *pCBUser)
 
 ObjectList* si_GetBoxIntersectors(const LTVector *pMin, const LTVector *pMax)
 {
+	ASSERT(!sm_InDeferredUpdate());
+
 	BoxFindStruct	BFStruct;
 
 	BFStruct.m_pBoxTouchList = (ObjectList*)sb_Allocate( &g_pServerMgr->m_ObjectListBank);
@@ -1894,6 +1911,9 @@ LPBASECLASS si_CreateObject(HCLASS hClass, ObjectCreateStruct *pStruct)
 		return LTNULL;
 	}
 
+	// Adds to the object lists and the world tree.
+	ASSERT(!sm_InDeferredUpdate());
+
 	CClassData *pClassData = (CClassData*)hClass;
 
 	// Only class-only objects are allowed to create objects without an OCS
@@ -1905,6 +1925,8 @@ LPBASECLASS si_CreateObject(HCLASS hClass, ObjectCreateStruct *pStruct)
 
 LPBASECLASS si_CreateObjectProps(HCLASS hClass, ObjectCreateStruct *pStruct, const char *pszProps)
 {
+	ASSERT(!sm_InDeferredUpdate());
+
 	CClassData *pClass = (CClassData*)hClass;
 
 	// Create and construct the object.
@@ -2732,6 +2754,9 @@ LTRESULT si_DoObjectRotation(HOBJECT hObj, const LTRotation *pRotation, bool bSn
 		RETURN_ERROR(1, ILTPhysics::SetObjectRotation, LT_ERROR);
 	}
 
+	// Rotating can relocate the object in the world tree.
+	ASSERT(!sm_InDeferredUpdate());
+
 	LTObject *pObj = HandleToServerObj(hObj);
 
 	// Avoid setting the change flags if they're the same.
@@ -3096,6 +3121,7 @@ void CLTServer::SetupFunctionPointers()
 	SetGlobalLightObject = si_SetGlobalLightObject;
 
 	IntersectSegment = ServerIntersectSegment;
+	IntersectSegmentBatch = ServerIntersectSegmentBatch;
 	CastRay = si_CastRay;
 
 	GetObjectScale = si_GetObjectScale;
@@ -38,6 +38,7 @@
 #include "ltnetwork_hooks.h"
 #include "server_filemgr.h"
 #include "s_client.h"
+#include "s_interest.h"
 #include "serverevent.h"
 #include "dhashtable.h"
 #include "ftserv.h"
@@ -45,6 +46,9 @@
 #include "ltobjectcreate.h"
 #include <time.h>
 #include "ltobjref.h"
+#include "ltjobpool.h"
+#include "ltresourceloader.h"
+#include "ltframearena.h"
 
 
 // [KLS 4/19/02] - All the class-tick stuff is really just debugging info, so make sure we aren't
@@ -118,6 +122,9 @@ extern int32 g_CV_ShowGameTime;
 extern int32 g_CV_ShowSphereFindTicks;
 
 extern int32 g_CV_BandwidthTargetServer;
+extern int32 g_CV_ParallelClientUpdates;
+extern int32 g_CV_ParallelObjectUpdates;
+extern int32 g_CV_WorldCache;
 
 CServerMgr	  *g_pServerMgr = LTNULL;
 
@@ -342,13 +349,25 @@ void sm_UpdateClientStates()
  
 void sm_UpdateClientsInWorld() 
 {
-	LTLink *pListHead = &g_pServerMgr->m_Clients.m_Head;
-	for (LTLink *pCur = pListHead->m_pNext; pCur != pListHead; pCur = pCur->m_pNext) 
+	// Gather the objects every client is interested in.
+	sm_BeginInterestFrame(&g_pServerMgr->m_ObjectMgr);
+
+	if (g_CV_ParallelClientUpdates)
 	{
-		Client *pClient = (Client*)pCur->m_pData;
-		sm_UpdateClientInWorld(pClient);
+		sm_UpdateClientsInWorldParallel();
+	}
+	else
+	{
+		LTLink *pListHead = &g_pServerMgr->m_Clients.m_Head;
+		for (LTLink *pCur = pListHead->m_pNext; pCur != pListHead; pCur = pCur->m_pNext) 
+		{
+			Client *pClient = (Client*)pCur->m_pData;
+			sm_UpdateClientInWorld(pClient);
+		}
 	}
 
+	sm_ClearDirtyTrackers(&g_pServerMgr->m_ObjectMgr);
+
 	// Clear the send/drop counts
 	g_pServerMgr->m_nSendPackets = 0;
 	g_pServerMgr->m_nDroppedSendPackets = 0;
@@ -508,6 +527,9 @@ bool CServerMgr::Init()
 	sm_InitConsoleCommands(console_state->State());
 	cc_RunConfigFile(console_state->State(), "s_autoexec.cfg", CC_NOCOMMANDS, 0);
 
+	lt_InitJobPool();
+	lt_InitResourceLoader();
+
 	server_filemgr->Init();
 
 	m_ClassMgr.Init();
@@ -591,6 +613,9 @@ void CServerMgr::Term()
 	// Get rid of the file trees.
 	server_filemgr->Term();
 
+	lt_TermResourceLoader();
+	lt_TermJobPool();
+
 	// Get rid of the struct banks.
 	sb_Term(&m_ObjectListBank);
 	sb_Term(&m_ObjectLinkBank);
@@ -896,6 +921,21 @@ void sm_MergeClientChangeLists()
 
 void CServerMgr::PreUpdateObjects()
 {
+	// The tick counters aren't thread safe, so stay serial while
+	// they're being shown.
+	bool bParallel = (g_CV_ParallelObjectUpdates != 0);
+
+#ifdef _PROCESS_CLASS_TICKS_
+	if (g_CV_ShowClassTicks)
+		bParallel = false;
+#endif // _PROCESS_CLASS_TICKS_
+
+	if (bParallel)
+	{
+		PreUpdateObjectsParallel();
+		IncrementFrameCode();
+		return;
+	}
  
 #ifdef _PROCESS_CLASS_TICKS_
  
@@ -984,6 +1024,74 @@ void CServerMgr::PreUpdateObjects()
 	IncrementFrameCode();
 }
 
+
+static void ObjectUpdateJob(uint32 iJob, void *pUser)
+{
+	LTObject *pObj = ((LTObject**)pUser)[iJob];
+
+	// Something updated on the main thread may have removed or
+	// deactivated it since it was queued.
+	if (!(pObj->m_InternalFlags & IFLAG_INWORLD) || (pObj->m_InternalFlags & IFLAG_INACTIVE_MASK))
+		return;
+
+	sm_BeginDeferredUpdate(pObj);
+	GameObjectUpdate(pObj);
+	sm_EndDeferredUpdate();
+}
+
+
+void CServerMgr::PreUpdateObjectsParallel()
+{
+	// Update everything that isn't thread safe as usual, and queue up the
+	// game updates for everything that is.  Their models get updated now,
+	// same as they would have been before their game update.
+	m_ParallelUpdateObjects.clear();
+
+	LTLink* pHead = &m_Objects.m_Head;
+	for (LTLink* pCur=pHead->m_pNext; pCur != pHead;)
+	{
+		LTObject* pObj = (LTObject*)pCur->m_pData;
+		pCur=pCur->m_pNext;
+
+		// Since all inactive objects are at the end, just stop
+		// at the first one.
+		if (pObj->m_InternalFlags & IFLAG_INACTIVE_MASK)
+			break;
+
+		if (!(pObj->m_InternalFlags & IFLAG_INWORLD))
+			continue;
+
+		if (m_ClassMgr.GetClassData(pObj->sd->m_pClass)->m_bThreadSafeUpdate)
+		{
+			ModelObjectUpdate(pObj);
+			m_ParallelUpdateObjects.push_back(pObj);
+		}
+		else
+		{
+			FullObjectUpdate(pObj);
+		}
+	}
+
+	uint32 nObjects = (uint32)m_ParallelUpdateObjects.size();
+	if (nObjects == 0)
+		return;
+
+	lt_GetJobPool().ParallelFor(nObjects, ObjectUpdateJob, &m_ParallelUpdateObjects[0], 16);
+
+	// Physics moves objects through the world tree and touches other
+	// objects, so it's applied back on this thread, in list order.
+	for (uint32 i = 0; i < nObjects; i++)
+	{
+		LTObject *pObj = m_ParallelUpdateObjects[i];
+
+		if (!(pObj->m_InternalFlags & IFLAG_INWORLD) || (pObj->m_InternalFlags & IFLAG_INACTIVE_MASK))
+			continue;
+
+		sm_ApplyDeferredChangeFlags(pObj);
+		PhysicsUpdateObject(pObj);
+	}
+}
+
 // This is called after objects have been updating.  It updates client states,
 // clears queues, etc.
 void sm_FinishUpdateFrame()
@@ -1087,6 +1195,9 @@ bool CServerMgr::Update(int32 updateFlags, uint32 nCurTimeMS)
 	static float s_serverSleepSecs = 0.0f;
 	#endif // DE_SERVER_COMPILE
 
+	// Scratch memory handed out during the tick is released when it ends.
+	CLTFrameArenaScope cFrameScope(lt_GetFrameArena());
+
 	int32 nOffsetTimeMS = (int32)nCurTimeMS + m_nTimeOffsetMS;
 
 	float curTime = nOffsetTimeMS / 1000.0f;
@@ -1098,6 +1209,9 @@ bool CServerMgr::Update(int32 updateFlags, uint32 nCurTimeMS)
 
 	m_NetMgr.Update("Server: ", curTime);
 
+	// Hand over anything the resource loader has finished with.
+	lt_GetResourceLoader().Update();
+
 	// Reset counters.
 	g_Ticks_MoveObject = 0;
 	g_nMoveObjectCalls = 0;
@@ -1771,6 +1885,7 @@ LTRESULT sm_CreateServerData(ObjectCreateStruct *pStruct,
 	pRet->m_cSpecialEffectMsg.Clear();
 	pRet->m_pIDLink = LTNULL;
 	pRet->m_ChangeFlags = 0;
+	pRet->m_DeferredChangeFlags = 0;
 	dl_TieOff(&pRet->m_ChangedNode);
 	pRet->m_NetFlags = 0;
 
@@ -1856,14 +1971,66 @@ LTRESULT sm_StartCachingFiles()
 }
 
 
+// Loads the models and sounds the shell cached.  The resource loader has
+// been reading their files in since they were asked for.  sm_CacheFile
+// already returned for these, so each model that fails to load is
+// reported here the way sm_CacheFile would have, and LT_MISSINGFILE is
+// returned once the rest are loaded.
+static LTRESULT sm_LoadDeferredCacheFiles()
+{
+	std::vector<DeferredCacheFile> &deferred = g_pServerMgr->m_DeferredCacheFiles;
+	LTRESULT dResult = LT_OK;
+
+	for (std::vector<DeferredCacheFile>::iterator iCur = deferred.begin(); iCur != deferred.end(); ++iCur)
+	{
+		if (iCur->m_FileType == FT_MODEL)
+		{
+			const char *pFilename = server_filemgr->GetUsedFilename(iCur->m_pFile);
+			if (g_pServerMgr->CacheModelFile(pFilename) != LT_OK)
+			{
+				GENERATE_ERROR(1, sm_CacheFile, LT_MISSINGFILE, pFilename);
+				dResult = LT_MISSINGFILE;
+			}
+		}
+		else
+		{
+			CSoundData *pSoundData = g_pServerMgr->GetSoundData(iCur->m_pFile);
+			if (pSoundData)
+			{
+				pSoundData->SetTouched(true);
+			}
+		}
+	}
+
+	deferred.clear();
+
+	// Anything that turned out not to need opening.
+	server_filemgr->FlushPrefetchedFiles();
+
+	return dResult;
+}
+
+
+static void sm_DeferCacheFile(uint32 fileType, UsedFile *pFile)
+{
+	DeferredCacheFile cacheFile;
+	cacheFile.m_FileType = fileType;
+	cacheFile.m_pFile = pFile;
+	g_pServerMgr->m_DeferredCacheFiles.push_back(cacheFile);
+
+	server_filemgr->PrefetchFiles(&pFile, 1, LTRESOURCE_PRIORITY_NORMAL);
+}
+
+
 LTRESULT sm_EndCachingFiles()
 {
 	i_server_shell->CacheFiles();
+	LTRESULT dResult = sm_LoadDeferredCacheFiles();
 	g_pServerMgr->m_InternalFlags &= ~SFLAG_BUILDINGCACHELIST;
 
 	sm_RemoveAllUnusedSoundData();
 
-	return LT_OK;
+	return dResult;
 }
 
 
@@ -2285,7 +2452,21 @@ LTRESULT sm_CacheFile(uint32 fileType, const char *pFilename)
 	{
 		case FT_MODEL:
 		{
-			if (g_pServerMgr->CacheModelFile(pszFinalFilename) != LT_OK )
+			if (g_pServerMgr->m_InternalFlags & SFLAG_BUILDINGCACHELIST)
+			{
+				// Start reading it now and load it with the rest of the
+				// cache list in sm_EndCachingFiles.
+				if (!g_pServerMgr->IsModelCached(pszFinalFilename))
+				{
+					if (server_filemgr->AddUsedFile(pszFinalFilename, 0, &pFile) == 0)
+					{
+						RETURN_ERROR_PARAM(1, sm_CacheFile, LT_MISSINGFILE, pszFinalFilename);
+					}
+
+					sm_DeferCacheFile(FT_MODEL, pFile);
+				}
+			}
+			else if (g_pServerMgr->CacheModelFile(pszFinalFilename) != LT_OK )
 			{
 				RETURN_ERROR_PARAM(1, sm_CacheFile, LT_MISSINGFILE, pszFinalFilename);
 			}	
@@ -2317,11 +2498,25 @@ LTRESULT sm_CacheFile(uint32 fileType, const char *pFilename)
             // Load up the sound and add it to our cache list
             else
 			{
-				// Keep a copy of the data on the server side...
-				CSoundData *pSoundData = g_pServerMgr->GetSoundData(pFile);
-				if (pSoundData) 
+				// Keep a copy of the data on the server side...  If we're
+				// building the cache list, it's loaded in sm_EndCachingFiles
+				// along with everything else.
+				CSoundData *pSoundData = g_pServerMgr->FindSoundData(pFile);
+				if (!pSoundData && (g_pServerMgr->m_InternalFlags & SFLAG_BUILDINGCACHELIST))
 				{
-					pSoundData->SetTouched(true);
+					sm_DeferCacheFile(FT_SOUND, pFile);
+				}
+				else
+				{
+					if (!pSoundData)
+					{
+						pSoundData = g_pServerMgr->GetSoundData(pFile);
+					}
+
+					if (pSoundData) 
+					{
+						pSoundData->SetTouched(true);
+					}
 				}
 
 				// See if we are batching up the cache list or sending them down individually
@@ -2353,14 +2548,25 @@ void CServerMgr::SetGlobalLightObject(HOBJECT hObject)
 	}
 }
 
-LTRESULT CServerMgr::LoadWorld(ILTStream* pStream, const char *pWorldName)
+LTRESULT CServerMgr::LoadWorld(ILTStream* pStream, const char *pWorldName, const char *pWorldFilename)
 {
 	world_bsp_server->Term();
 
+	// The baked world cache lives next to the world, so it can only be used
+	// for worlds that aren't in rez files.
+	char szCacheFilename[512];
+	const char *pCacheFilename = LTNULL;
+	if (g_CV_WorldCache && 
+		server_filemgr->GetFullFilename(pWorldFilename, szCacheFilename, sizeof(szCacheFilename) - 8))
+	{
+		LTStrCat(szCacheFilename, ".cache", sizeof(szCacheFilename));
+		pCacheFilename = szCacheFilename;
+	}
+
 	// Load the world geometry.
 	pStream->SeekTo(0);
  
-	int32 loadStatus = world_bsp_server->Load(pStream);
+	int32 loadStatus = world_bsp_server->Load(pStream, pCacheFilename);
 
 	// Invalid file version
 	if (loadStatus != 0)
@@ -2662,7 +2868,7 @@ LTRESULT CServerMgr::DoStartWorld(const char *pWorldName, uint32 flags, uint32 n
 	{
 		dsi_ConsolePrint("Loading world: %s", pWorldName);
 
-		dResult = LoadWorld(pStream, pWorldName);
+		dResult = LoadWorld(pStream, pWorldName, worldName);
 		if (dResult != LT_OK)
 		{
  			if (pStream)
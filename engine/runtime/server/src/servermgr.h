@@ -125,6 +125,15 @@ struct OtherFile
 	uint16  m_FileID;
 };
 
+// A model or sound cached during ServerShell::CacheFiles.  Its file is read
+// in on the resource loader as soon as it's asked for, and it's loaded once
+// the shell is done asking.
+struct DeferredCacheFile
+{
+	uint32		m_FileType;  // FT_MODEL or FT_SOUND.
+	UsedFile	*m_pFile;
+};
+
 
 class ILTServer;
 
@@ -168,6 +177,10 @@ class CServerMgr : public CNetHandler
 //	  void 			   UpdateClientStates();
 		void 			PreUpdateObjects();
 
+		// PreUpdateObjects with the CF_THREADSAFEUPDATE objects' updates
+		// run on the job pool.
+		void 			PreUpdateObjectsParallel();
+
 		void 			UpdateSounds(float fDeltaTime);
 		void 			RemoveSounds();
 		void 			UntouchAllSoundData();
@@ -190,7 +203,9 @@ class CServerMgr : public CNetHandler
 	//////// Main server functionality ///////////////////////////////////////////
 	public:
 
-		LTRESULT 		LoadWorld(ILTStream* pStream, const char *pWorldName);
+		// pWorldFilename is the world's file (with the extension), which is
+		// used to find the baked world cache.
+		LTRESULT 		LoadWorld(ILTStream* pStream, const char *pWorldName, const char *pWorldFilename);
 		
 		void 			ResizeUpdateInfos(uint32 nAllocatedIDs);
 
@@ -361,6 +376,9 @@ class CServerMgr : public CNetHandler
 		LTLink 			m_IDs;	  // Allocated ID list (m_pData = ID).
 		LTList 			m_Objects;  // All the objects.
 
+		// Objects waiting for their update on the job pool this frame.
+		std::vector<LTObject*>	m_ParallelUpdateObjects;
+
 		
 		// All the client references (from a saved game).
 		LTList 			m_ClientReferences;
@@ -380,6 +398,9 @@ class CServerMgr : public CNetHandler
 		uint32 			m_CacheListSize; // How many elements are used.
 		uint32 			m_CacheListAllocedSize; // How many elements are allocated.
 
+		// Models and sounds waiting for sm_EndCachingFiles to load them.
+		std::vector<DeferredCacheFile>	m_DeferredCacheFiles;
+
 		// Sky box definition.
 		SkyDef 			m_SkyDef;
 		uint16 			m_SkyObjects[MAX_SKYOBJECTS]; // Objects in the sky (0xFF if none).
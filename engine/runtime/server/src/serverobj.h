@@ -85,6 +85,7 @@ public:
 	LTLink			m_ChangedNode;	// Used in the linked list of changed objects..
 
 	uint16			m_ChangeFlags;		// Stored during updates.
+	uint16			m_DeferredChangeFlags;	// Set during a job pool update, see sm_BeginDeferredUpdate.
 	uint16			m_NetFlags;			// Net flags (combination of NETFLAG_ defines).
 };
 
@@ -21,6 +21,11 @@ define_holder(IWorldServerBSP, world_bsp_server);
 static ILTServer *ilt_server;
 define_holder(ILTServer, ilt_server);
 
+//the server collision manager, NULL when the physics module isn't linked in
+#include "collision_mgr.h"
+static ILTCollisionMgr *server_collision_mgr;
+define_holder_to_instance(ILTCollisionMgr, server_collision_mgr, Server);
+
 
 
 
@@ -155,6 +160,9 @@ const char* SMoveAbstract::GetObjectClassName(LTObject *pObject)
 void FullMoveObject(LTObject *pObj, const LTVector *pP1, const uint32 flags) {
     MoveState moveState;
 
+    // Moving goes through the world tree, which job pool updates can't touch.
+    ASSERT(!sm_InDeferredUpdate());
+
     moveState.Setup(world_bsp_server->ServerTree(), g_pServerMgr->m_MoveAbstract, pObj, pObj->m_BPriority);
 
     MoveObject(&moveState, *pP1, flags);
@@ -163,4 +171,8 @@ void FullMoveObject(LTObject *pObj, const LTVector *pP1, const uint32 flags) {
 ILTPhysics *SMoveAbstract::GetPhysics() { 
     return ilt_server->Physics(); 
 }
+
+ILTCollisionMgr *SMoveAbstract::GetCollisionMgr() {
+    return server_collision_mgr;
+}
 //EOF
@@ -33,6 +33,7 @@ public:
 	LTBOOL			CanOptimizeObject(LTObject *pObj);
 	const char*		GetObjectClassName(LTObject *pObject);
 	ILTPhysics *	GetPhysics();
+	ILTCollisionMgr *GetCollisionMgr();
 };
 
 
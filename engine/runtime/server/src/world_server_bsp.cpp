@@ -57,7 +57,7 @@ public:
     //
 
     WorldTree *ServerTree();
-    ELoadWorldStatus Load(ILTStream *pStream);
+    ELoadWorldStatus Load(ILTStream *pStream, const char *pCacheFilename);
     bool IsLoaded();
 
     uint32 NumWorldModels();
@@ -177,7 +177,7 @@ void CWorldServerBSP::GetWorldBox(LTVector &min, LTVector &max) {
     max = box_max_padded;
 }
 
-ELoadWorldStatus CWorldServerBSP::Load(ILTStream *pStream)
+ELoadWorldStatus CWorldServerBSP::Load(ILTStream *pStream, const char *pCacheFilename)
 {
     //check parameters.
     IFBREAKRETURNVAL(!pStream, LoadWorld_InvalidParams);
@@ -186,7 +186,7 @@ ELoadWorldStatus CWorldServerBSP::Load(ILTStream *pStream)
     Term();
 
     //call shared world loading function.
-    ELoadWorldStatus status = world_bsp_shared->Load(pStream, world_tree, world_models, num_world_models);
+    ELoadWorldStatus status = world_bsp_shared->Load(pStream, world_tree, world_models, num_world_models, pCacheFilename);
 
     //check if there was an error.
     if (status != LoadWorld_Ok) {
@@ -2,8 +2,12 @@
 #include "bdefs.h"
 #include "dtxmgr.h"
 #include "render.h"
+#include "ltjobpool.h"
 
-int g_dtxInMemSize = 0;
+#include <atomic>
+
+// Textures can be loaded on the job pool, so the running total is atomic.
+std::atomic<int> g_dtxInMemSize(0);
 
 //Texture groups, used to control offsetting of Mip Maps when they are loaded, thus allowing
 //us to not waste any memory loading mips higher than those that we are going to use. Note that
@@ -242,10 +246,6 @@ LTRESULT dtx_Create(ILTStream *pStream, TextureData **ppOut, uint32& nBaseWidth,
 	uint32 nTexHeight = hdr.m_BaseHeight / (1 << nMipOffset);
 	uint32 nNumMips	  = hdr.m_nMipmaps - nMipOffset;
 
-	TextureMipData* pMip = nullptr;
-	uint32 y = 0;
-	uint32 size = 0;
-
 	// Allocate it.
 	pRet = dtx_Alloc(hdr.GetBPPIdent(), nTexWidth, nTexHeight, nNumMips, &allocSize, &textureDataSize);
 	if (!pRet) RETURN_ERROR(1, dtx_Create, LT_OUTOFMEMORY);
@@ -260,43 +260,39 @@ LTRESULT dtx_Create(ILTStream *pStream, TextureData **ppOut, uint32& nBaseWidth,
 	pRet->m_Header.m_BaseHeight = static_cast<uint16>(nTexHeight);
 	pRet->m_Header.m_nMipmaps = static_cast<uint16>(nNumMips);
 
-	// Read in mipmap data.
+	// Work out how much image data we're skipping and keeping.  The mips are stored
+	// back to back in the file, and dtx_Alloc lays the kept ones out back to back in
+	// m_pDataBuffer with tightly packed rows, so each part is a single seek or read.
+	uint32 nSkipSize = 0;
+	uint32 nKeepSize = 0;
 	for (uint32 iMipmap = 0; iMipmap < hdr.m_nMipmaps; iMipmap++)
 	{
-		// Skip mipmaps before offset (but still read past them in stream)
-		bool bSkipImageData = (iMipmap < nMipOffset);
-
-		// Only access allocated mip data for mipmaps we're keeping
-		if (!bSkipImageData)
-		{
-			pMip = &pRet->m_Mips[iMipmap - nMipOffset];
-		}
-
 		// Calculate size based on original header dimensions at this mip level
-		uint32 mipWidth = hdr.m_BaseWidth >> iMipmap;
-		uint32 mipHeight = hdr.m_BaseHeight >> iMipmap;
+		uint32 size = CalcImageSize(hdr.GetBPPIdent(), hdr.m_BaseWidth >> iMipmap, hdr.m_BaseHeight >> iMipmap);
 
-		if (hdr.GetBPPIdent() == BPP_32)
+		if (iMipmap < nMipOffset)
 		{
-			size = mipWidth * sizeof(uint32);
-			for (y = 0; y < mipHeight; y++)
-			{
-				if (bSkipImageData)
-				{
-					pStream->SeekTo(pStream->GetPos() + size);
-				}
-				else
-				{
-					pStream->Read(&pMip->m_Data[y * pMip->m_Pitch], size);
-				}
-			}
+			nSkipSize += size;
 		}
 		else
 		{
-			size = CalcImageSize(hdr.GetBPPIdent(), mipWidth, mipHeight);
-			dtx_ReadOrSkip(bSkipImageData, pStream, bSkipImageData ? nullptr : pMip->m_Data, size);
+			ASSERT(pRet->m_Mips[iMipmap - nMipOffset].m_Data == pRet->m_pDataBuffer + nKeepSize);
+			nKeepSize += size;
 		}
 	}
+	ASSERT(nKeepSize == textureDataSize);
+
+	// Skip mipmaps before offset (but still read past them in stream)
+	if (nSkipSize > 0)
+	{
+		dtx_ReadOrSkip(LTTRUE, pStream, nullptr, nSkipSize);
+	}
+
+	// Read in all the mipmaps we're keeping.
+	if (nKeepSize > 0)
+	{
+		dtx_ReadOrSkip(LTFALSE, pStream, pRet->m_pDataBuffer, nKeepSize);
+	}
 	
 	// Read in the sections if present.
 	if ((hdr.m_IFlags & DTX_SECTIONSFIXED) != 0)
@@ -342,6 +338,34 @@ LTRESULT dtx_Create(ILTStream *pStream, TextureData **ppOut, uint32& nBaseWidth,
 }
 
 
+static void dtx_CreateBatchJob(uint32 iJob, void *pUser)
+{
+	DtxLoadRequest *pRequest = &((DtxLoadRequest*)pUser)[iJob];
+
+	pRequest->m_pTexture = LTNULL;
+	pRequest->m_nBaseWidth = pRequest->m_nBaseHeight = 0;
+
+	if (!pRequest->m_pStream)
+	{
+		pRequest->m_Result = LT_MISSINGFILE;
+		return;
+	}
+
+	pRequest->m_Result = dtx_Create(pRequest->m_pStream, &pRequest->m_pTexture, 
+		pRequest->m_nBaseWidth, pRequest->m_nBaseHeight);
+}
+
+void dtx_CreateBatch(DtxLoadRequest *pRequests, uint32 nRequests)
+{
+	if (nRequests == 0)
+		return;
+
+	// Each job is a whole file, so hand them out one at a time to keep the threads busy
+	// when the sizes are uneven.
+	lt_GetJobPool().ParallelFor(nRequests, dtx_CreateBatchJob, pRequests, 1);
+}
+
+
 void dtx_Destroy(TextureData *pTextureData)
 {
 	if(pTextureData)
@@ -217,6 +217,22 @@ LTRESULT dtx_Create(ILTStream *pStream, TextureData **ppOut, uint32& nBaseWidth,
 TextureData* dtx_Alloc(BPPIdent bpp, uint32 baseWidth, uint32 baseHeight, uint32 nMipmaps,
     uint32 *pAllocSize, uint32 *pTextureDataSize, uint32 iFlags = NULL);
 
+// One texture for dtx_CreateBatch.  Fill in m_pStream, and the rest is filled in
+// with what dtx_Create would return for it.
+struct DtxLoadRequest
+{
+    ILTStream       *m_pStream;
+    TextureData     *m_pTexture;
+    uint32          m_nBaseWidth;
+    uint32          m_nBaseHeight;
+    LTRESULT        m_Result;
+};
+
+// Runs dtx_Create on a set of streams in parallel on the job pool and returns when
+// they're all done.  Every request must have its own stream, and the caller still
+// owns the streams.
+void dtx_CreateBatch(DtxLoadRequest *pRequests, uint32 nRequests);
+
 void dtx_Destroy(TextureData *pTextureData);
 
 // Fill in the DTX format.
@@ -198,6 +198,28 @@ int32 g_CV_BandwidthTargetServer = 256000; // server send bandwidth target in bi
 
 int32 g_CV_NewPlayerPhysics = 1;	// Use the new player physics
 
+// Server-side interest management (see s_interest.h).  Objects further than
+// NetInterestRadius from a client's view position aren't replicated to it.
+// 0 disables interest management.
+float g_CV_NetInterestRadius = 0.0f;
+float g_CV_NetInterestHysteresis = 1.25f;	// multiplier on the radius before an object drops out
+
+// Write the per-client update packets on the job pool.
+int32 g_CV_ParallelClientUpdates = 0;
+
+// Run the game updates for CF_THREADSAFEUPDATE objects on the job pool.
+int32 g_CV_ParallelObjectUpdates = 0;
+
+// Load the server world's BSPs and static lights from a baked cache next to
+// the world file, writing it out the first time.
+int32 g_CV_WorldCache = 0;
+
+// Budget in KB for the PCM of compressed sounds kept around after they play
+// (see sounddecodecache.h).  0 turns the cache off.  SoundCacheStats publishes
+// its counters as the SoundCacheHits/Misses/Evictions/KB console variables.
+int32 g_CV_SoundCacheSize = 32768;
+int32 g_CV_SoundCacheStats = 0;
+
 int32 g_CV_UDPSimulatePacketLoss = 0;
 int32 g_CV_UDPSimulateCorruption = 0;
 
@@ -338,6 +360,14 @@ static LTEngineVar g_LTEngineVars[] =
 
 	EV_LONG("NewPlayerPhysics", &g_CV_NewPlayerPhysics),
 
+	EV_FLOAT("NetInterestRadius", &g_CV_NetInterestRadius),
+	EV_FLOAT("NetInterestHysteresis", &g_CV_NetInterestHysteresis),
+	EV_LONG("ParallelClientUpdates", &g_CV_ParallelClientUpdates),
+	EV_LONG("ParallelObjectUpdates", &g_CV_ParallelObjectUpdates),
+	EV_LONG("WorldCache", &g_CV_WorldCache),
+	EV_LONG("SoundCacheSize", &g_CV_SoundCacheSize),
+	EV_LONG("SoundCacheStats", &g_CV_SoundCacheStats),
+
 	EV_LONG("UDPSimulatePacketLoss", &g_CV_UDPSimulatePacketLoss),
 	EV_LONG("UDPSimulateCorruption", &g_CV_UDPSimulateCorruption),
 
@@ -65,7 +65,6 @@
 
 //	#if defined(__LINUX)
 //            link_to_implementation(CServerConsoleState,		Default);
-//            link_to_implementation(CServerLoaderThread,		Default);
 //            link_to_implementation(CWorldServerBSP,			Default);
 //            link_to_implementation(LTCollisionMgr,          Server);
 //            link_to_implementation(CLTPhysicsServer,        Server);
@@ -0,0 +1,171 @@
+#include "bdefs.h"
+#include "ltframearena.h"
+
+
+CLTFrameArena::CLTFrameArena(uint32 nMemType, uint32 nChunkSize) :
+	m_nMemType(nMemType),
+	m_nChunkSize(nChunkSize),
+	m_pFirst(LTNULL),
+	m_pCur(LTNULL),
+	m_pLastAlloc(LTNULL),
+	m_nLastStart(0),
+	m_nBytesUsed(0),
+	m_nPeakBytesUsed(0),
+	m_nBytesReserved(0)
+{
+}
+
+
+CLTFrameArena::~CLTFrameArena()
+{
+	FreeChunks();
+}
+
+
+void* CLTFrameArena::Alloc(uint32 nSize, uint32 nAlign)
+{
+	ASSERT(nAlign && !(nAlign & (nAlign - 1)));
+
+	uint32 nStart = 0;
+	if (m_pCur)
+	{
+		uint8 *pData = m_pCur->GetData();
+		std::uintptr_t nAddr = (std::uintptr_t)(pData + m_pCur->m_nUsed);
+		nStart = (uint32)(((nAddr + nAlign - 1) & ~(std::uintptr_t)(nAlign - 1)) - (std::uintptr_t)pData);
+	}
+
+	if (!m_pCur || (nStart + nSize > m_pCur->m_nSize))
+	{
+		NextChunk(nSize, nAlign);
+
+		std::uintptr_t nAddr = (std::uintptr_t)m_pCur->GetData();
+		nStart = (uint32)(((nAddr + nAlign - 1) & ~(std::uintptr_t)(nAlign - 1)) - nAddr);
+	}
+
+	m_nBytesUsed += (nStart - m_pCur->m_nUsed) + nSize;
+	m_nPeakBytesUsed = LTMAX(m_nPeakBytesUsed, m_nBytesUsed);
+
+	m_nLastStart = m_pCur->m_nUsed;
+	m_pLastAlloc = m_pCur->GetData() + nStart;
+
+	m_pCur->m_nUsed = nStart + nSize;
+	return m_pLastAlloc;
+}
+
+
+void CLTFrameArena::Free(void *pMem, uint32 nSize)
+{
+	if (!m_pCur || !pMem || (pMem != m_pLastAlloc))
+		return;
+
+	ASSERT((uint8*)pMem + nSize == m_pCur->GetData() + m_pCur->m_nUsed);
+
+	// Undo the whole allocation, padding included, so the bytes used match
+	// what Alloc added.
+	m_nBytesUsed -= m_pCur->m_nUsed - m_nLastStart;
+	m_pCur->m_nUsed = m_nLastStart;
+
+	m_pLastAlloc = LTNULL;
+}
+
+
+CLTFrameArena::Mark CLTFrameArena::GetMark() const
+{
+	Mark mark;
+	mark.m_pChunk = m_pCur;
+	mark.m_nUsed = m_pCur ? m_pCur->m_nUsed : 0;
+	mark.m_nBytesUsed = m_nBytesUsed;
+	return mark;
+}
+
+
+void CLTFrameArena::Rewind(const Mark &mark)
+{
+	m_pCur = (Chunk*)mark.m_pChunk;
+	if (m_pCur)
+	{
+		m_pCur->m_nUsed = mark.m_nUsed;
+	}
+
+	m_nBytesUsed = mark.m_nBytesUsed;
+	m_pLastAlloc = LTNULL;
+
+	// Back to empty, so this is the time to swap a chain of chunks for a
+	// single one.  Nothing can still point into them.
+	if (!m_pCur && m_pFirst && m_pFirst->m_pNext)
+	{
+		// Leave some slack for alignment and chunk tails.
+		uint32 nSize = LTMAX(m_nPeakBytesUsed + m_nPeakBytesUsed / 4, m_nChunkSize);
+
+		FreeChunks();
+		m_pFirst = NewChunk(nSize);
+	}
+}
+
+
+void CLTFrameArena::NextChunk(uint32 nSize, uint32 nAlign)
+{
+	uint32 nNeeded = nSize + nAlign;
+
+	// Reuse the next chunk if it's big enough, otherwise put a new one in
+	// front of it.
+	Chunk *pNext = m_pCur ? m_pCur->m_pNext : m_pFirst;
+	if (!pNext || (pNext->m_nSize < nNeeded))
+	{
+		Chunk *pNew = NewChunk(LTMAX(m_nChunkSize, nNeeded));
+		pNew->m_pNext = pNext;
+
+		if (m_pCur)
+		{
+			m_pCur->m_pNext = pNew;
+		}
+		else
+		{
+			m_pFirst = pNew;
+		}
+
+		pNext = pNew;
+	}
+
+	pNext->m_nUsed = 0;
+	m_pCur = pNext;
+}
+
+
+CLTFrameArena::Chunk* CLTFrameArena::NewChunk(uint32 nSize)
+{
+	uint8 *pMem;
+	LT_MEM_TRACK_ALLOC(pMem = new uint8[sizeof(Chunk) + nSize], m_nMemType);
+
+	Chunk *pChunk = (Chunk*)pMem;
+	pChunk->m_pNext = LTNULL;
+	pChunk->m_nSize = nSize;
+	pChunk->m_nUsed = 0;
+
+	m_nBytesReserved += nSize;
+	return pChunk;
+}
+
+
+void CLTFrameArena::FreeChunks()
+{
+	Chunk *pChunk = m_pFirst;
+	while (pChunk)
+	{
+		Chunk *pNext = pChunk->m_pNext;
+		delete [] (uint8*)pChunk;
+		pChunk = pNext;
+	}
+
+	m_pFirst = LTNULL;
+	m_pCur = LTNULL;
+	m_pLastAlloc = LTNULL;
+	m_nBytesReserved = 0;
+}
+
+
+CLTFrameArena& lt_GetFrameArena()
+{
+	static thread_local CLTFrameArena s_FrameArena(LT_MEM_TYPE_FRAMEARENA);
+	return s_FrameArena;
+}
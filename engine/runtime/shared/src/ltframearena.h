@@ -0,0 +1,184 @@
+
+// The frame arena hands out memory that only needs to live until the end of
+// the current client frame or server tick.  Allocating is a pointer bump and
+// nothing is freed on its own; instead a CLTFrameArenaScope rewinds the arena
+// when it goes out of scope, releasing everything allocated inside it at once.
+// Scopes nest, so the client frame, the server tick and any function that
+// wants scratch memory can each open one.
+//
+// Every thread has its own arena, so there's no locking.  Memory from an arena
+// can be handed to other threads (the job pool, say) as long as they're done
+// with it before the scope that owns it closes.
+//
+// The arena's chunks are tracked with ltmem like any other allocation, so they
+// show up under their LT_MEM_TYPE_* in the mem stats.  The allocations inside
+// them don't.
+
+#ifndef __LTFRAMEARENA_H__
+#define __LTFRAMEARENA_H__
+
+#ifndef __LTBASETYPES_H__
+#include "ltbasetypes.h"
+#endif
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+
+class CLTFrameArena
+{
+public:
+
+	// Where the arena was at some point, for rewinding back to.
+	struct Mark
+	{
+		void		*m_pChunk;
+		uint32		m_nUsed;
+		uint32		m_nBytesUsed;
+	};
+
+					CLTFrameArena(uint32 nMemType, uint32 nChunkSize = 64 * 1024);
+					~CLTFrameArena();
+
+	// Returns uninitialized memory.  Never returns null; if the current chunk
+	// is full another one is added.
+	void*			Alloc(uint32 nSize, uint32 nAlign = 16);
+
+	// Gives memory back, along with the padding that aligned it, if it was
+	// the last thing allocated, which is common for short-lived scratch
+	// buffers.  Otherwise does nothing.
+	void			Free(void *pMem, uint32 nSize);
+
+	template <typename T>
+	T*				AllocArray(uint32 nCount)
+	{
+		return (T*)Alloc(nCount * sizeof(T), alignof(T));
+	}
+
+	Mark			GetMark() const;
+
+	// Releases everything allocated since the mark.  Rewinding an arena all
+	// the way back merges its chunks into one big enough for everything that
+	// was in use, so a busy frame only has to grow the arena once.
+	void			Rewind(const Mark &mark);
+
+	// Bytes handed out since the arena was last empty, and the most there has
+	// ever been.
+	uint32			GetBytesUsed() const		{ return m_nBytesUsed; }
+	uint32			GetPeakBytesUsed() const	{ return m_nPeakBytesUsed; }
+
+	// Bytes held in chunks.
+	uint32			GetBytesReserved() const	{ return m_nBytesReserved; }
+
+private:
+
+	struct Chunk
+	{
+		Chunk		*m_pNext;
+		uint32		m_nSize;
+		uint32		m_nUsed;
+
+		uint8*		GetData()		{ return (uint8*)(this + 1); }
+	};
+
+	// Moves on to a chunk with room for the allocation, adding one if needed.
+	void			NextChunk(uint32 nSize, uint32 nAlign);
+
+	Chunk*			NewChunk(uint32 nSize);
+	void			FreeChunks();
+
+	uint32			m_nMemType;
+	uint32			m_nChunkSize;
+
+	// The chunks in use are m_pFirst up to m_pCur.  Chunks after m_pCur were
+	// used earlier and are kept around for reuse.
+	Chunk			*m_pFirst;
+	Chunk			*m_pCur;
+
+	// The last allocation and how much of m_pCur was used before it, so
+	// Free can take back its alignment padding as well.
+	void			*m_pLastAlloc;
+	uint32			m_nLastStart;
+
+	uint32			m_nBytesUsed;
+	uint32			m_nPeakBytesUsed;
+	uint32			m_nBytesReserved;
+};
+
+
+// Rewinds an arena to where it was when the scope was opened.
+class CLTFrameArenaScope
+{
+public:
+
+	explicit		CLTFrameArenaScope(CLTFrameArena &arena) :
+						m_Arena(arena),
+						m_Mark(arena.GetMark())
+					{
+					}
+
+					~CLTFrameArenaScope()
+					{
+						m_Arena.Rewind(m_Mark);
+					}
+
+private:
+
+	CLTFrameArenaScope(const CLTFrameArenaScope&);
+	CLTFrameArenaScope& operator=(const CLTFrameArenaScope&);
+
+	CLTFrameArena			&m_Arena;
+	CLTFrameArena::Mark		m_Mark;
+};
+
+
+// This thread's frame arena.
+CLTFrameArena& lt_GetFrameArena();
+
+
+// STL allocator over a frame arena, the calling thread's unless another one is
+// given.  A container using it must not outlive the scope it was filled in.
+template <typename T>
+class CLTFrameAllocator
+{
+public:
+
+	typedef T value_type;
+
+					CLTFrameAllocator() : m_pArena(&lt_GetFrameArena()) {}
+	explicit		CLTFrameAllocator(CLTFrameArena &arena) : m_pArena(&arena) {}
+
+	template <typename U>
+					CLTFrameAllocator(const CLTFrameAllocator<U> &other) : m_pArena(other.GetArena()) {}
+
+	T*				allocate(size_t nCount)
+	{
+		return (T*)m_pArena->Alloc((uint32)(nCount * sizeof(T)), alignof(T));
+	}
+
+	void			deallocate(T *pMem, size_t nCount)
+	{
+		m_pArena->Free(pMem, (uint32)(nCount * sizeof(T)));
+	}
+
+	CLTFrameArena*	GetArena() const	{ return m_pArena; }
+
+	template <typename U>
+	bool			operator==(const CLTFrameAllocator<U> &other) const	{ return m_pArena == other.GetArena(); }
+	template <typename U>
+	bool			operator!=(const CLTFrameAllocator<U> &other) const	{ return m_pArena != other.GetArena(); }
+
+private:
+
+	CLTFrameArena	*m_pArena;
+};
+
+
+// A vector whose memory comes from the calling thread's frame arena.
+template <typename T>
+using LTFrameVector = std::vector<T, CLTFrameAllocator<T> >;
+
+
+#endif  // __LTFRAMEARENA_H__
+
@@ -0,0 +1,217 @@
+#include "bdefs.h"
+#include "ltjobpool.h"
+
+
+// Set on the pool's worker threads, and on a ParallelFor caller while it
+// helps with its own batch, so nested batches run inline instead of trying
+// to take the pool again.
+static thread_local bool s_bRunningJobs = false;
+
+
+CLTJobPool::CLTJobPool() :
+	m_nGeneration(0),
+	m_nActiveWorkers(0),
+	m_bBatchOpen(false),
+	m_bShutdown(false),
+	m_pFn(LTNULL),
+	m_pUser(LTNULL),
+	m_nJobs(0),
+	m_nJobsPerGrab(1),
+	m_nNextJob(0),
+	m_nJobsDone(0)
+{
+}
+
+
+CLTJobPool::~CLTJobPool()
+{
+	Term();
+}
+
+
+void CLTJobPool::Init(uint32 nThreads)
+{
+	Term();
+
+	if (nThreads == 0)
+	{
+		uint32 nCores = std::thread::hardware_concurrency();
+		nThreads = (nCores > 1) ? (nCores - 1) : 0;
+	}
+
+	std::lock_guard<std::mutex> cBatchLock(m_BatchMutex);
+
+	m_bShutdown = false;
+	m_Threads.reserve(nThreads);
+	for (uint32 i = 0; i < nThreads; i++)
+	{
+		m_Threads.push_back(std::thread(&CLTJobPool::WorkerThread, this));
+	}
+}
+
+
+void CLTJobPool::Term()
+{
+	std::lock_guard<std::mutex> cBatchLock(m_BatchMutex);
+
+	if (m_Threads.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> cLock(m_Mutex);
+		m_bShutdown = true;
+	}
+	m_WakeCV.notify_all();
+
+	for (std::vector<std::thread>::iterator iCur = m_Threads.begin(); iCur != m_Threads.end(); ++iCur)
+	{
+		iCur->join();
+	}
+
+	m_Threads.clear();
+}
+
+
+void CLTJobPool::ParallelFor(uint32 nJobs, LTJobFn fn, void *pUser, uint32 nJobsPerGrab)
+{
+	if (nJobs == 0)
+		return;
+
+	// Run it here if there's no one to share with, we're already inside a job,
+	// or someone else has the pool.
+	bool bInline = (nJobs == 1) || m_Threads.empty() || s_bRunningJobs;
+	if (!bInline && !m_BatchMutex.try_lock())
+		bInline = true;
+
+	if (bInline)
+	{
+		for (uint32 i = 0; i < nJobs; i++)
+		{
+			fn(i, pUser);
+		}
+		return;
+	}
+
+	// Publish the batch.
+	{
+		std::lock_guard<std::mutex> cLock(m_Mutex);
+
+		m_pFn = fn;
+		m_pUser = pUser;
+		m_nJobs = nJobs;
+		m_nJobsPerGrab = LTMAX(nJobsPerGrab, 1);
+		m_nNextJob.store(0);
+		m_nJobsDone.store(0);
+		m_bBatchOpen = true;
+		++m_nGeneration;
+	}
+	m_WakeCV.notify_all();
+
+	// Help out.
+	s_bRunningJobs = true;
+	RunJobs();
+	s_bRunningJobs = false;
+
+	// Wait for the stragglers, and make sure none of the workers are still
+	// looking at this batch before the next one overwrites it.
+	{
+		std::unique_lock<std::mutex> cLock(m_Mutex);
+		m_bBatchOpen = false;
+
+		while ((m_nJobsDone.load() != m_nJobs) || (m_nActiveWorkers != 0))
+		{
+			m_DoneCV.wait(cLock);
+		}
+	}
+
+	m_BatchMutex.unlock();
+}
+
+
+void CLTJobPool::WorkerThread()
+{
+	s_bRunningJobs = true;
+
+	uint32 nSeenGeneration = 0;
+
+	for (;;)
+	{
+		std::unique_lock<std::mutex> cLock(m_Mutex);
+
+		while (!m_bShutdown && (!m_bBatchOpen || (m_nGeneration == nSeenGeneration)))
+		{
+			m_WakeCV.wait(cLock);
+		}
+
+		if (m_bShutdown)
+			return;
+
+		nSeenGeneration = m_nGeneration;
+		++m_nActiveWorkers;
+		cLock.unlock();
+
+		RunJobs();
+
+		cLock.lock();
+		--m_nActiveWorkers;
+		cLock.unlock();
+
+		m_DoneCV.notify_all();
+	}
+}
+
+
+void CLTJobPool::RunJobs()
+{
+	for (;;)
+	{
+		uint32 iFirst = m_nNextJob.fetch_add(m_nJobsPerGrab);
+		if (iFirst >= m_nJobs)
+			break;
+
+		uint32 iEnd = LTMIN(iFirst + m_nJobsPerGrab, m_nJobs);
+		for (uint32 i = iFirst; i < iEnd; i++)
+		{
+			m_pFn(i, m_pUser);
+		}
+
+		if (m_nJobsDone.fetch_add(iEnd - iFirst) + (iEnd - iFirst) == m_nJobs)
+		{
+			// Take the lock so the notify can't slip in between the caller's
+			// check and its wait.
+			std::lock_guard<std::mutex> cLock(m_Mutex);
+			m_DoneCV.notify_all();
+		}
+	}
+}
+
+
+static CLTJobPool s_JobPool;
+static std::mutex s_JobPoolRefMutex;
+static uint32 s_nJobPoolRefs = 0;
+
+
+void lt_InitJobPool()
+{
+	std::lock_guard<std::mutex> cLock(s_JobPoolRefMutex);
+
+	if (s_nJobPoolRefs++ == 0)
+		s_JobPool.Init();
+}
+
+
+void lt_TermJobPool()
+{
+	std::lock_guard<std::mutex> cLock(s_JobPoolRefMutex);
+
+	ASSERT(s_nJobPoolRefs > 0);
+	if ((s_nJobPoolRefs > 0) && (--s_nJobPoolRefs == 0))
+		s_JobPool.Term();
+}
+
+
+CLTJobPool& lt_GetJobPool()
+{
+	return s_JobPool;
+}
+
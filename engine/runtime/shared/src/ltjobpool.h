@@ -0,0 +1,92 @@
+
+// The job pool is a small set of worker threads shared by the engine for
+// fanning independent pieces of work out across cores.  ParallelFor is
+// blocking: the calling thread works on the jobs too and returns once every
+// job has finished, so callers don't need to deal with completion.
+//
+// Jobs may call ParallelFor themselves, on a worker or on the thread that
+// started the batch; the nested batch simply runs on that thread.  So does a
+// batch started while another thread has the pool busy.
+
+#ifndef __LTJOBPOOL_H__
+#define __LTJOBPOOL_H__
+
+#ifndef __LTBASETYPES_H__
+#include "ltbasetypes.h"
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Called once for each job index in [0, nJobs).
+typedef void (*LTJobFn)(uint32 iJob, void *pUser);
+
+
+class CLTJobPool
+{
+public:
+
+					CLTJobPool();
+					~CLTJobPool();
+
+	// Starts the worker threads.  0 picks one less than the number of cores.
+	// Calling Init on a running pool restarts it with the new thread count.
+	void			Init(uint32 nThreads = 0);
+	void			Term();
+
+	// Number of worker threads, not counting the calling thread.
+	uint32			GetNumThreads() const		{ return (uint32)m_Threads.size(); }
+
+	// Runs fn for every job index and waits for them all to finish.  Jobs are
+	// handed out in order, nJobsPerGrab at a time.
+	void			ParallelFor(uint32 nJobs, LTJobFn fn, void *pUser, uint32 nJobsPerGrab = 1);
+
+private:
+
+	void			WorkerThread();
+
+	// Works on the current batch until there's nothing left to grab.
+	void			RunJobs();
+
+	std::vector<std::thread>	m_Threads;
+
+	// Serializes ParallelFor callers.
+	std::mutex					m_BatchMutex;
+
+	// Protects the batch description and the wakeup generation.
+	std::mutex					m_Mutex;
+	std::condition_variable		m_WakeCV;
+	std::condition_variable		m_DoneCV;
+	uint32						m_nGeneration;
+	uint32						m_nActiveWorkers;
+	bool						m_bBatchOpen;
+	bool						m_bShutdown;
+
+	// The current batch.
+	LTJobFn						m_pFn;
+	void						*m_pUser;
+	uint32						m_nJobs;
+	uint32						m_nJobsPerGrab;
+	std::atomic<uint32>			m_nNextJob;
+	std::atomic<uint32>			m_nJobsDone;
+};
+
+
+// The engine-wide job pool.  The client and server each call lt_InitJobPool
+// at startup and lt_TermJobPool at shutdown, and the worker threads run from
+// the first Init to the last Term.  Keeping the threads out of static
+// construction and destruction means a module is never unloaded with them
+// still being joined.  Until the pool is started, ParallelFor runs every job
+// on the calling thread.
+void lt_InitJobPool();
+void lt_TermJobPool();
+
+CLTJobPool& lt_GetJobPool();
+
+
+#endif  // __LTJOBPOOL_H__
+
@@ -0,0 +1,588 @@
+
+#include "bdefs.h"
+#include "ltresourceloader.h"
+#include "genltstream.h"
+
+#include <algorithm>
+
+
+CLTResourceLoader::CLTResourceLoader() :
+	m_bShutdown(false),
+	m_hNextHandle(1),
+	m_nNextSequence(0)
+{
+}
+
+
+CLTResourceLoader::~CLTResourceLoader()
+{
+	Term();
+}
+
+
+void CLTResourceLoader::Init(uint32 nThreads)
+{
+	Term();
+
+	if (nThreads == 0)
+	{
+		uint32 nCores = std::thread::hardware_concurrency();
+		nThreads = (nCores > 1) ? (nCores - 1) : 1;
+	}
+
+	std::lock_guard<std::mutex> cLock(m_Mutex);
+
+	m_bShutdown = false;
+	m_Threads.reserve(nThreads);
+	for (uint32 i = 0; i < nThreads; i++)
+	{
+		m_Threads.push_back(std::thread(&CLTResourceLoader::LoaderThread, this));
+	}
+}
+
+
+void CLTResourceLoader::Term()
+{
+	// Anything that hasn't started isn't wanted any more.
+	std::vector<HLTRESOURCE> queued;
+	{
+		std::lock_guard<std::mutex> cLock(m_Mutex);
+		for (RequestQueue::iterator iCur = m_Queue.begin(); iCur != m_Queue.end(); ++iCur)
+		{
+			queued.push_back((*iCur)->m_hHandle);
+		}
+	}
+
+	for (std::vector<HLTRESOURCE>::iterator iCur = queued.begin(); iCur != queued.end(); ++iCur)
+	{
+		Cancel(*iCur);
+	}
+
+	WaitAll();
+
+	{
+		std::lock_guard<std::mutex> cLock(m_Mutex);
+		m_bShutdown = true;
+	}
+	m_WakeCV.notify_all();
+
+	for (std::vector<std::thread>::iterator iCur = m_Threads.begin(); iCur != m_Threads.end(); ++iCur)
+	{
+		iCur->join();
+	}
+
+	m_Threads.clear();
+}
+
+
+HLTRESOURCE CLTResourceLoader::Queue(const LTResourceRequest &request)
+{
+	if (!request.m_pStream)
+		return 0;
+
+	if (!request.m_LoadFn)
+	{
+		request.m_pStream->Release();
+		return 0;
+	}
+
+	std::unique_lock<std::mutex> cLock(m_Mutex);
+
+	if (request.m_pKey)
+	{
+		std::unordered_map<const void*, Request*>::iterator iExisting = m_ByKey.find(request.m_pKey);
+		if (iExisting != m_ByKey.end())
+		{
+			Request *pExisting = iExisting->second;
+
+			// Bump it up the queue if this caller is in more of a hurry.
+			if ((pExisting->m_State == kQueued) && (request.m_Priority > pExisting->m_Request.m_Priority))
+			{
+				m_Queue.erase(pExisting);
+				pExisting->m_Request.m_Priority = request.m_Priority;
+				m_Queue.insert(pExisting);
+			}
+
+			HLTRESOURCE hExisting = pExisting->m_hHandle;
+			cLock.unlock();
+
+			request.m_pStream->Release();
+			return hExisting;
+		}
+	}
+
+	Request *pRequest;
+	LT_MEM_TRACK_ALLOC(pRequest = new Request, LT_MEM_TYPE_FILE);
+
+	pRequest->m_Request = request;
+	pRequest->m_Request.m_Result = LT_OK;
+	pRequest->m_Request.m_pData = LTNULL;
+	pRequest->m_Request.m_DataSize = 0;
+	pRequest->m_hHandle = m_hNextHandle++;
+	pRequest->m_nSequence = m_nNextSequence++;
+	pRequest->m_State = kQueued;
+
+	if (m_hNextHandle == 0)
+		m_hNextHandle = 1;
+
+	m_Queue.insert(pRequest);
+	m_ByHandle[pRequest->m_hHandle] = pRequest;
+	if (request.m_pKey)
+		m_ByKey[request.m_pKey] = pRequest;
+
+	HLTRESOURCE hRet = pRequest->m_hHandle;
+	cLock.unlock();
+
+	m_WakeCV.notify_one();
+	return hRet;
+}
+
+
+HLTRESOURCE CLTResourceLoader::Find(const void *pKey)
+{
+	std::lock_guard<std::mutex> cLock(m_Mutex);
+
+	std::unordered_map<const void*, Request*>::iterator iFound = m_ByKey.find(pKey);
+	return (iFound != m_ByKey.end()) ? iFound->second->m_hHandle : 0;
+}
+
+
+bool CLTResourceLoader::Cancel(HLTRESOURCE hRequest)
+{
+	Request *pRequest;
+	{
+		std::lock_guard<std::mutex> cLock(m_Mutex);
+
+		std::unordered_map<HLTRESOURCE, Request*>::iterator iFound = m_ByHandle.find(hRequest);
+		if ((iFound == m_ByHandle.end()) || (iFound->second->m_State != kQueued))
+			return false;
+
+		pRequest = iFound->second;
+		m_Queue.erase(pRequest);
+		Remove(pRequest);
+	}
+
+	pRequest->m_Request.m_Result = LT_USERCANCELED;
+	Finish(pRequest);
+	return true;
+}
+
+
+void CLTResourceLoader::Update()
+{
+	std::vector<Request*> loaded;
+	{
+		std::lock_guard<std::mutex> cLock(m_Mutex);
+		if (m_Loaded.empty())
+			return;
+
+		loaded.swap(m_Loaded);
+		for (std::vector<Request*>::iterator iCur = loaded.begin(); iCur != loaded.end(); ++iCur)
+		{
+			Remove(*iCur);
+		}
+	}
+
+	for (std::vector<Request*>::iterator iCur = loaded.begin(); iCur != loaded.end(); ++iCur)
+	{
+		Finish(*iCur);
+	}
+}
+
+
+LTRESULT CLTResourceLoader::Wait(HLTRESOURCE hRequest)
+{
+	std::unique_lock<std::mutex> cLock(m_Mutex);
+
+	std::unordered_map<HLTRESOURCE, Request*>::iterator iFound = m_ByHandle.find(hRequest);
+	if (iFound == m_ByHandle.end())
+		return LT_NOTFOUND;
+
+	Request *pRequest = iFound->second;
+
+	if (pRequest->m_State == kQueued)
+	{
+		// Nobody's got to it yet, so do it here rather than wait in line.
+		m_Queue.erase(pRequest);
+		pRequest->m_State = kLoading;
+		cLock.unlock();
+
+		Load(pRequest);
+
+		cLock.lock();
+		pRequest->m_State = kLoaded;
+	}
+	else
+	{
+		while (pRequest->m_State != kLoaded)
+		{
+			m_LoadedCV.wait(cLock);
+		}
+
+		std::vector<Request*>::iterator iLoaded = std::find(m_Loaded.begin(), m_Loaded.end(), pRequest);
+		if (iLoaded != m_Loaded.end())
+			m_Loaded.erase(iLoaded);
+	}
+
+	Remove(pRequest);
+	cLock.unlock();
+
+	LTRESULT result = pRequest->m_Request.m_Result;
+	Finish(pRequest);
+	return result;
+}
+
+
+void CLTResourceLoader::WaitAll()
+{
+	for (;;)
+	{
+		std::vector<HLTRESOURCE> outstanding;
+		{
+			std::lock_guard<std::mutex> cLock(m_Mutex);
+			if (m_ByHandle.empty())
+				return;
+
+			// Highest priority first, then whatever's already in flight.
+			for (RequestQueue::iterator iCur = m_Queue.begin(); iCur != m_Queue.end(); ++iCur)
+			{
+				outstanding.push_back((*iCur)->m_hHandle);
+			}
+
+			for (std::unordered_map<HLTRESOURCE, Request*>::iterator iCur = m_ByHandle.begin(); iCur != m_ByHandle.end(); ++iCur)
+			{
+				if (iCur->second->m_State != kQueued)
+					outstanding.push_back(iCur->first);
+			}
+		}
+
+		for (std::vector<HLTRESOURCE>::iterator iCur = outstanding.begin(); iCur != outstanding.end(); ++iCur)
+		{
+			Wait(*iCur);
+		}
+	}
+}
+
+
+uint32 CLTResourceLoader::GetNumOutstanding()
+{
+	std::lock_guard<std::mutex> cLock(m_Mutex);
+	return (uint32)m_ByHandle.size();
+}
+
+
+void CLTResourceLoader::LoaderThread()
+{
+	for (;;)
+	{
+		std::unique_lock<std::mutex> cLock(m_Mutex);
+
+		while (!m_bShutdown && m_Queue.empty())
+		{
+			m_WakeCV.wait(cLock);
+		}
+
+		if (m_bShutdown)
+			return;
+
+		Request *pRequest = *m_Queue.begin();
+		m_Queue.erase(m_Queue.begin());
+		pRequest->m_State = kLoading;
+		cLock.unlock();
+
+		Load(pRequest);
+
+		cLock.lock();
+		pRequest->m_State = kLoaded;
+		m_Loaded.push_back(pRequest);
+		cLock.unlock();
+
+		m_LoadedCV.notify_all();
+	}
+}
+
+
+void CLTResourceLoader::Load(Request *pRequest)
+{
+	LTResourceRequest *pLoad = &pRequest->m_Request;
+	pLoad->m_Result = pLoad->m_LoadFn(pLoad);
+}
+
+
+void CLTResourceLoader::Finish(Request *pRequest)
+{
+	LTResourceRequest *pDone = &pRequest->m_Request;
+
+	pDone->m_pStream->Release();
+	pDone->m_pStream = LTNULL;
+
+	if (pDone->m_DoneFn)
+	{
+		pDone->m_DoneFn(pDone);
+	}
+	else if (pDone->m_pData)
+	{
+		// Nobody to hand it to.  Loads without a done function can only
+		// come from lt_LoadResourceFile.
+		lt_FreeResourceFile(pDone->m_pData);
+	}
+
+	delete pRequest;
+}
+
+
+void CLTResourceLoader::Remove(Request *pRequest)
+{
+	m_ByHandle.erase(pRequest->m_hHandle);
+
+	if (pRequest->m_Request.m_pKey)
+	{
+		std::unordered_map<const void*, Request*>::iterator iKey = m_ByKey.find(pRequest->m_Request.m_pKey);
+		if ((iKey != m_ByKey.end()) && (iKey->second == pRequest))
+			m_ByKey.erase(iKey);
+	}
+}
+
+
+// ------------------------------------------------------------------------
+// Whole-file loads.
+// ------------------------------------------------------------------------
+
+// Read-only stream over a buffer from lt_LoadResourceFile.
+class CLTResourceFileStream : public CGenLTStream
+{
+public:
+
+					CLTResourceFileStream(uint8 *pData, uint32 dataSize) :
+						m_pData(pData),
+						m_DataSize(dataSize),
+						m_Pos(0),
+						m_bError(false)
+					{
+					}
+
+					~CLTResourceFileStream()
+					{
+						lt_FreeResourceFile(m_pData);
+					}
+
+	LTRESULT		Read(void *pData, uint32 size)
+	{
+		if (size == 0)
+			return LT_OK;
+
+		if ((m_Pos + size) > m_DataSize)
+		{
+			m_Pos = m_DataSize;
+			m_bError = true;
+			memset(pData, 0, size);
+			return LT_ERROR;
+		}
+
+		memcpy(pData, &m_pData[m_Pos], size);
+		m_Pos += size;
+		return LT_OK;
+	}
+
+	LTRESULT		Write(const void *pData, uint32 size)	{ return LT_ERROR; }
+	LTRESULT		ErrorStatus()							{ return m_bError ? LT_ERROR : LT_OK; }
+
+	LTRESULT		SeekTo(uint32 offset)
+	{
+		if (offset > m_DataSize)
+			return LT_ERROR;
+
+		m_Pos = offset;
+		return LT_OK;
+	}
+
+	LTRESULT		GetPos(uint32 *pPos)					{ *pPos = m_Pos; return LT_OK; }
+	LTRESULT		GetLen(uint32 *pLen)					{ *pLen = m_DataSize; return LT_OK; }
+	void			Release()								{ delete this; }
+
+private:
+
+	uint8			*m_pData;
+	uint32			m_DataSize;
+	uint32			m_Pos;
+	bool			m_bError;
+};
+
+
+LTRESULT lt_LoadResourceFile(LTResourceRequest *pRequest)
+{
+	ILTStream *pStream = pRequest->m_pStream;
+
+	uint32 nSize = 0;
+	pStream->GetLen(&nSize);
+
+	uint8 *pData;
+	LT_MEM_TRACK_ALLOC(pData = new uint8[LTMAX(nSize, 1)], LT_MEM_TYPE_FILE);
+	if (!pData)
+		return LT_OUTOFMEMORY;
+
+	if ((pStream->SeekTo(0) != LT_OK) || (pStream->Read(pData, nSize) != LT_OK))
+	{
+		delete [] pData;
+		return LT_ERROR;
+	}
+
+	pRequest->m_pData = pData;
+	pRequest->m_DataSize = nSize;
+	return LT_OK;
+}
+
+
+void lt_FreeResourceFile(void *pData)
+{
+	delete [] (uint8*)pData;
+}
+
+
+ILTStream* lt_OpenResourceFileStream(void *pData, uint32 dataSize)
+{
+	CLTResourceFileStream *pStream;
+	LT_MEM_TRACK_ALLOC(pStream = new CLTResourceFileStream((uint8*)pData, dataSize), LT_MEM_TYPE_FILE);
+	return pStream;
+}
+
+
+// ------------------------------------------------------------------------
+// CLTFilePrefetcher.
+// ------------------------------------------------------------------------
+
+void CLTFilePrefetcher::Prefetch(const void *pKey, ILTStream *pStream, int32 priority)
+{
+	if (!pStream)
+		return;
+
+	if (m_Files.find(pKey) != m_Files.end())
+	{
+		pStream->Release();
+		return;
+	}
+
+	LTResourceRequest request;
+	request.m_pKey = pKey;
+	request.m_Priority = priority;
+	request.m_pStream = pStream;
+	request.m_LoadFn = lt_LoadResourceFile;
+	request.m_DoneFn = OnPrefetchDone;
+	request.m_pUser = this;
+
+	PrefetchedFile &file = m_Files[pKey];
+	file.m_pData = LTNULL;
+	file.m_DataSize = 0;
+	file.m_hRequest = lt_GetResourceLoader().Queue(request);
+
+	if (!file.m_hRequest)
+		m_Files.erase(pKey);
+}
+
+
+ILTStream* CLTFilePrefetcher::Open(const void *pKey)
+{
+	std::unordered_map<const void*, PrefetchedFile>::iterator iFile = m_Files.find(pKey);
+	if (iFile == m_Files.end())
+		return LTNULL;
+
+	// Still loading?  OnPrefetchDone fills it in, or drops it if the read
+	// failed.
+	if (!iFile->second.m_pData)
+	{
+		lt_GetResourceLoader().Wait(iFile->second.m_hRequest);
+
+		iFile = m_Files.find(pKey);
+		if (iFile == m_Files.end())
+			return LTNULL;
+
+		// Merged into someone else's request for the same key.
+		if (!iFile->second.m_pData)
+		{
+			m_Files.erase(iFile);
+			return LTNULL;
+		}
+	}
+
+	ILTStream *pStream = lt_OpenResourceFileStream(iFile->second.m_pData, iFile->second.m_DataSize);
+	m_Files.erase(iFile);
+	return pStream;
+}
+
+
+void CLTFilePrefetcher::Flush()
+{
+	std::vector<HLTRESOURCE> pending;
+	std::unordered_map<const void*, PrefetchedFile>::iterator iFile;
+
+	for (iFile = m_Files.begin(); iFile != m_Files.end(); ++iFile)
+	{
+		if (!iFile->second.m_pData)
+			pending.push_back(iFile->second.m_hRequest);
+	}
+
+	// Either of these gets OnPrefetchDone called.
+	for (std::vector<HLTRESOURCE>::iterator iCur = pending.begin(); iCur != pending.end(); ++iCur)
+	{
+		if (!lt_GetResourceLoader().Cancel(*iCur))
+			lt_GetResourceLoader().Wait(*iCur);
+	}
+
+	for (iFile = m_Files.begin(); iFile != m_Files.end(); ++iFile)
+	{
+		lt_FreeResourceFile(iFile->second.m_pData);
+	}
+
+	m_Files.clear();
+}
+
+
+void CLTFilePrefetcher::OnPrefetchDone(LTResourceRequest *pRequest)
+{
+	CLTFilePrefetcher *pPrefetcher = (CLTFilePrefetcher*)pRequest->m_pUser;
+
+	std::unordered_map<const void*, PrefetchedFile>::iterator iFile = pPrefetcher->m_Files.find(pRequest->m_pKey);
+
+	if ((pRequest->m_Result != LT_OK) || (iFile == pPrefetcher->m_Files.end()))
+	{
+		// Cancelled or failed.  Whoever opens it goes to the disk instead.
+		lt_FreeResourceFile(pRequest->m_pData);
+		if (iFile != pPrefetcher->m_Files.end())
+			pPrefetcher->m_Files.erase(iFile);
+		return;
+	}
+
+	iFile->second.m_pData = pRequest->m_pData;
+	iFile->second.m_DataSize = pRequest->m_DataSize;
+}
+
+
+static CLTResourceLoader s_ResourceLoader;
+static std::mutex s_ResourceLoaderRefMutex;
+static uint32 s_nResourceLoaderRefs = 0;
+
+
+void lt_InitResourceLoader()
+{
+	std::lock_guard<std::mutex> cLock(s_ResourceLoaderRefMutex);
+
+	if (s_nResourceLoaderRefs++ == 0)
+		s_ResourceLoader.Init();
+}
+
+
+void lt_TermResourceLoader()
+{
+	std::lock_guard<std::mutex> cLock(s_ResourceLoaderRefMutex);
+
+	ASSERT(s_nResourceLoaderRefs > 0);
+	if ((s_nResourceLoaderRefs > 0) && (--s_nResourceLoaderRefs == 0))
+		s_ResourceLoader.Term();
+}
+
+
+CLTResourceLoader& lt_GetResourceLoader()
+{
+	return s_ResourceLoader;
+}
+
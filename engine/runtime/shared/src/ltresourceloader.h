@@ -0,0 +1,254 @@
+
+// The resource loader streams resources in on its own set of threads so a
+// batch of loads (a precache list, a level's textures) can be issued all at
+// once instead of one blocking load after another.
+//
+// Requests are picked up highest priority first, in the order they were
+// queued within a priority.  A request for a key that's already queued or
+// loading is merged into the existing one, and a request that hasn't started
+// yet can be cancelled.  Once a request's load function has run on a loader
+// thread, its done function is called on the thread that owns the loader
+// from Update or Wait, so it's free to touch the engine's non-thread-safe
+// state (file managers, object banks, the renderer).
+
+#ifndef __LTRESOURCELOADER_H__
+#define __LTRESOURCELOADER_H__
+
+#ifndef __LTBASETYPES_H__
+#include "ltbasetypes.h"
+#endif
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+class ILTStream;
+struct LTResourceRequest;
+
+
+// Called on a loader thread.  It must only touch the request (and its
+// stream) and should fill in m_pData and m_DataSize.  Returns the result
+// passed on to the done function.
+typedef LTRESULT (*LTResourceLoadFn)(LTResourceRequest *pRequest);
+
+// Called on the owning thread once the request has loaded, or with
+// LT_USERCANCELED if it was cancelled.  It owns m_pData from then on.  If
+// a request has no done function, m_pData is freed with lt_FreeResourceFile.
+typedef void (*LTResourceDoneFn)(LTResourceRequest *pRequest);
+
+
+// Handle to a queued request.  0 is never a valid handle.
+typedef uint32 HLTRESOURCE;
+
+
+// Higher priorities are loaded first.
+#define LTRESOURCE_PRIORITY_LOW		-100
+#define LTRESOURCE_PRIORITY_NORMAL	0
+#define LTRESOURCE_PRIORITY_HIGH	100
+
+
+struct LTResourceRequest
+{
+					LTResourceRequest() :
+						m_pKey(LTNULL),
+						m_Priority(LTRESOURCE_PRIORITY_NORMAL),
+						m_pStream(LTNULL),
+						m_LoadFn(LTNULL),
+						m_DoneFn(LTNULL),
+						m_pUser(LTNULL),
+						m_Result(LT_OK),
+						m_pData(LTNULL),
+						m_DataSize(0)
+					{
+					}
+
+	// Requests with the same key are merged.  This is normally the
+	// FileIdentifier (client) or UsedFile (server) being loaded.
+	const void		*m_pKey;
+	int32			m_Priority;
+
+	// The stream to load from.  The loader owns it once the request is
+	// queued and releases it on the owning thread just before the done
+	// function is called.
+	ILTStream		*m_pStream;
+
+	LTResourceLoadFn	m_LoadFn;
+	LTResourceDoneFn	m_DoneFn;
+	void			*m_pUser;
+
+	// Filled in by the load function.
+	LTRESULT		m_Result;
+	void			*m_pData;
+	uint32			m_DataSize;
+};
+
+
+class CLTResourceLoader
+{
+public:
+
+					CLTResourceLoader();
+					~CLTResourceLoader();
+
+	// Starts the loader threads.  0 picks one less than the number of cores.
+	void			Init(uint32 nThreads = 0);
+
+	// Cancels anything that hasn't started, finishes the rest and stops the
+	// threads.
+	void			Term();
+
+	// Queues a request.  If a request with the same key is already queued or
+	// loading, its priority is raised to match and its handle is returned;
+	// the new request is dropped, its stream released and its done function
+	// never called.  Returns 0 if the request has no stream or load function.
+	HLTRESOURCE		Queue(const LTResourceRequest &request);
+
+	// Returns the handle of the outstanding request for a key, or 0.
+	HLTRESOURCE		Find(const void *pKey);
+
+	// Cancels a request that hasn't started loading yet, calling its done
+	// function with LT_USERCANCELED.  Returns false if it has already
+	// started (or finished), in which case it completes as usual.
+	bool			Cancel(HLTRESOURCE hRequest);
+
+	// Calls the done functions of everything that's finished loading.
+	void			Update();
+
+	// Waits for a single request, loading it on this thread if no loader
+	// thread has picked it up yet, and calls its done function.  Returns its
+	// result, or LT_NOTFOUND if the handle isn't outstanding.
+	LTRESULT		Wait(HLTRESOURCE hRequest);
+
+	// Waits for (and finishes) everything that's outstanding, including
+	// anything queued by the done functions.
+	void			WaitAll();
+
+	// Number of requests that haven't had their done function called yet.
+	uint32			GetNumOutstanding();
+
+private:
+
+	enum RequestState
+	{
+		kQueued,
+		kLoading,
+		kLoaded
+	};
+
+	struct Request
+	{
+		LTResourceRequest	m_Request;
+		HLTRESOURCE			m_hHandle;
+		uint32				m_nSequence;
+		RequestState		m_State;
+	};
+
+	// Highest priority first, then first come first served.
+	struct QueueOrder
+	{
+		bool operator()(const Request *pA, const Request *pB) const
+		{
+			if (pA->m_Request.m_Priority != pB->m_Request.m_Priority)
+				return pA->m_Request.m_Priority > pB->m_Request.m_Priority;
+			return pA->m_nSequence < pB->m_nSequence;
+		}
+	};
+
+	typedef std::set<Request*, QueueOrder>	RequestQueue;
+
+	void			LoaderThread();
+
+	// Runs the load function.  Called without the lock held.
+	static void		Load(Request *pRequest);
+
+	// Releases the stream, calls the done function and frees the request.
+	// Called on the owning thread without the lock held.
+	static void		Finish(Request *pRequest);
+
+	// Forgets about a request.  Must be called with the lock held.
+	void			Remove(Request *pRequest);
+
+	std::vector<std::thread>	m_Threads;
+
+	std::mutex					m_Mutex;
+	std::condition_variable		m_WakeCV;
+	std::condition_variable		m_LoadedCV;
+	bool						m_bShutdown;
+
+	RequestQueue				m_Queue;
+	std::vector<Request*>		m_Loaded;
+	std::unordered_map<const void*, Request*>	m_ByKey;
+	std::unordered_map<HLTRESOURCE, Request*>	m_ByHandle;
+
+	HLTRESOURCE					m_hNextHandle;
+	uint32						m_nNextSequence;
+};
+
+
+// Load function that reads the whole stream into m_pData.
+LTRESULT lt_LoadResourceFile(LTResourceRequest *pRequest);
+
+// Frees data read by lt_LoadResourceFile.
+void lt_FreeResourceFile(void *pData);
+
+// Wraps data read by lt_LoadResourceFile in a read-only stream, which takes
+// ownership of the data and frees it when it's released.
+ILTStream* lt_OpenResourceFileStream(void *pData, uint32 dataSize);
+
+
+// Holds whole files read ahead on the resource loader until they're opened.
+// The file managers use it so a batch of files can be read in parallel and
+// then parsed in order.  Only use it from the loader's owning thread.
+class CLTFilePrefetcher
+{
+public:
+
+	// Queues a read of the stream for the key (a FileIdentifier or UsedFile),
+	// taking ownership of the stream.  Does nothing but release the stream if
+	// the key is already prefetched.
+	void			Prefetch(const void *pKey, ILTStream *pStream, int32 priority);
+
+	// Returns a stream over the key's prefetched data, waiting for the read
+	// if it's still going, and forgets about it.  Returns null if the key
+	// wasn't prefetched or the read failed.
+	ILTStream*		Open(const void *pKey);
+
+	// Throws away everything that hasn't been opened.
+	void			Flush();
+
+	uint32			GetNumFiles() const		{ return (uint32)m_Files.size(); }
+
+private:
+
+	// m_pData is null until the loader hands it over.
+	struct PrefetchedFile
+	{
+		HLTRESOURCE		m_hRequest;
+		void			*m_pData;
+		uint32			m_DataSize;
+	};
+
+	static void		OnPrefetchDone(LTResourceRequest *pRequest);
+
+	std::unordered_map<const void*, PrefetchedFile>	m_Files;
+};
+
+
+// The engine-wide resource loader.  The client and server each call
+// lt_InitResourceLoader before their file managers start and
+// lt_TermResourceLoader after they've shut down, and the loader threads run
+// from the first Init to the last Term, so they're never joined while the
+// module is being unloaded or after the done functions' owners are gone.
+// Until the loader is started, requests only load when they're waited on.
+void lt_InitResourceLoader();
+void lt_TermResourceLoader();
+
+CLTResourceLoader& lt_GetResourceLoader();
+
+
+#endif  // __LTRESOURCELOADER_H__
+
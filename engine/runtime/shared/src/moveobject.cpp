@@ -13,6 +13,7 @@
 #include "ltsysoptim.h"
 #include "moveplayer.h"
 #include "fullintersectline.h"
+#include "collision_mgr.h"
 
 extern int32 g_CV_NewPlayerPhysics;	// Use the new player physics
 
@@ -23,6 +24,22 @@ void RetransformWorldModel(WorldModelInstance *pWorldModel)
 }
 
 
+void UpdateCollisionObject(ILTCollisionMgr *pMgr, LTObject *pObj, const LTVector &startPos)
+{
+	if(!pMgr)
+		return;
+
+	ILTCollisionObject *pCollisionObj = pMgr->Find((HOBJECT)pObj);
+	if(!pCollisionObj)
+		return;
+
+	// m_P0 and m_P1 belong to the game, so the manager keeps its own copy.
+	const LTVector &curPos = pObj->GetPos();
+	pMgr->Move(pCollisionObj, LTVector3f(startPos.x, startPos.y, startPos.z),
+		LTVector3f(curPos.x, curPos.y, curPos.z));
+}
+
+
 uint32 g_Ticks_MoveObject;
 uint32 g_nMoveObjectCalls;
 
@@ -1116,43 +1133,38 @@ inline LTBOOL MaybeCollide(MoveState *pState, LTObject *pTestObj)
 }
 
 
-// Called by WorldTree::FindObjectsInBox.
-static void FindObjectsCB(WorldTreeObj *pTreeObj, void *pCBUser)
+// Adds the objects the movement box touches to the array, skipping the ones that 
+// can't collide with the object being moved.
+static void FindIntersectingObjects(MoveState *pState, IntersectingObjectArray *pArray)
 {
-	LTObject *pObject;
-	IntersectingObjectArray *pArray;
-
-
-	if(pTreeObj->GetObjType() != WTObj_DObject)
-		return;
+	WTQueryArray treeObjects(pState->m_pWorldTree);
+	pState->m_pWorldTree->CollectObjectsInBox(pState->m_vMoveMin, pState->m_vMoveMax, treeObjects.Get());
 
-	pObject = (LTObject*)pTreeObj;
-	pArray = (IntersectingObjectArray*)pCBUser;
-	
-	if(pArray->m_nObjects < MAX_INTERSECTING_OBJECTS)
+	const WTObjArray &objects = treeObjects.Get();
+	for(uint32 i=0; i < objects.size(); i++)
 	{
-		if(pObject == pArray->m_pState->m_pObj)
-			return;
+		WorldTreeObj *pTreeObj = objects[i];
+		if(pTreeObj->GetObjType() != WTObj_DObject)
+			continue;
+
+		LTObject *pObject = (LTObject*)pTreeObj;
+		if(pObject == pState->m_pObj)
+			continue;
 
 		// Check for no possible collisions between these objects...
-		if(!IsPhysical(pObject->m_Flags, pArray->m_pState->m_bServer) && !( pObject->m_Flags & FLAG_TOUCHABLE ))
-			return;
+		if(!IsPhysical(pObject->m_Flags, pState->m_bServer) && !( pObject->m_Flags & FLAG_TOUCHABLE ))
+			continue;
 
-		// [RP]
-//		if(!pArray->m_pState->m_bServer)
-//		{
-//			if(pObject->m_Flags & FLAG_CLIENTNONSOLID || !(pObject->m_Flags & FLAG_SOLID))
-//				return;
-//		}
+		if(pArray->m_nObjects >= MAX_INTERSECTING_OBJECTS)
+		{
+			dsi_ConsolePrint("FindIntersectingObjects: Overflowed (more than %d intersecting objects)!",
+				MAX_INTERSECTING_OBJECTS);
+			break;
+		}
 
 		pArray->m_pObjects[pArray->m_nObjects] = pObject;
 		pArray->m_nObjects++;
 	}
-	else
-	{
-		dsi_ConsolePrint("FindObjectsCB: Overflowed (more than %d intersecting objects)!",
-			MAX_INTERSECTING_OBJECTS);
-	}
 }
 
 
@@ -1187,8 +1199,7 @@ static void DetectAndProcessCollisions
 	}
 	else
 	{
-		pState->m_pWorldTree->FindObjectsInBox(&pState->m_vMoveMin, &pState->m_vMoveMax,
-			FindObjectsCB, &objectArray);
+		FindIntersectingObjects(pState, &objectArray);
 	}
 
 	pHitObjects[0] = pHitObjects[1] = LTNULL;
@@ -1449,7 +1460,9 @@ void MoveObject
 			pState->m_pAbstract->SetObjectChangeFlags(pState->m_pObj, CF_POSITION);
 		}
 
+		startPos = pState->m_pObj->GetPos();
 		pState->m_pObj->SetPos( P1 );
+		UpdateCollisionObject(pState->m_pAbstract->GetCollisionMgr(), pState->m_pObj, (flags & MO_TELEPORT) ? P1 : startPos);
 		return;
 	}
 
@@ -1565,6 +1578,7 @@ void MoveObject
 
 	// Done moving it around...
 	pState->m_pWorldTree->InsertObject(pState->m_pObj);
+	UpdateCollisionObject(pState->m_pAbstract->GetCollisionMgr(), pState->m_pObj, startPos);
 
 	if(flags & MO_MOVESTANDINGONS)
 	{
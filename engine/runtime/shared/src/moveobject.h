@@ -7,10 +7,15 @@ class ILTPhysics;
 class WorldTree;
 class Node;
 class WorldModelInstance;
+class ILTCollisionMgr;
 
 
 void RetransformWorldModel(WorldModelInstance *pWorldModel);
 
+// Refreshes pObj's entry in the collision manager (if it has one) after it
+// moved from startPos to its current position.
+void UpdateCollisionObject(ILTCollisionMgr *pMgr, LTObject *pObj, const LTVector &startPos);
+
 
 // Flags to MoveObject.
 #define MO_DETACHSTANDING	(1<<0)
@@ -37,6 +42,7 @@ public:
 	virtual LTBOOL			CanOptimizeObject(LTObject *pObject)=0;
 	virtual const char*		GetObjectClassName(LTObject *pObject)=0;
 	virtual ILTPhysics *	GetPhysics()=0;
+	virtual ILTCollisionMgr *GetCollisionMgr()=0;
 };
 
 
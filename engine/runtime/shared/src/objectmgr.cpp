@@ -1369,6 +1369,10 @@ LTParticleSystem::LTParticleSystem() : LTObject(OT_PARTICLESYSTEM) {
 
   m_ParticleHead.m_pNext = m_ParticleHead.m_pPrev = &m_ParticleHead;
 
+  memset(&m_ParticleArrays, 0, sizeof(m_ParticleArrays));
+  m_nParticleArrayCapacity = 0;
+  m_pParticleArrayBlock = LTNULL;
+
   m_nParticles = 0;
   m_nChangedParticles = 0;
 
@@ -1395,6 +1399,7 @@ LTParticleSystem::~LTParticleSystem() {
   }
 
   m_ParticleHead.m_pNext = m_ParticleHead.m_pPrev = &m_ParticleHead;
+  FreeParticleArrays();
   m_nParticles = 0;
 }
 
@@ -1403,6 +1408,35 @@ void LTParticleSystem::Init(ObjectMgr *pMgr, ObjectCreateStruct *pStruct) {
   m_pParticleBank = &pMgr->m_ParticleBank;
 }
 
+bool LTParticleSystem::ReserveParticleArrays(uint32 nParticles) {
+  if (nParticles <= m_nParticleArrayCapacity)
+    return true;
+
+  // Grow by half again at least, and keep each field a multiple of 16 bytes
+  // long so they all stay aligned.
+  uint32 nCapacity = LTMAX(nParticles, m_nParticleArrayCapacity + m_nParticleArrayCapacity / 2);
+  nCapacity = LTMAX((nCapacity + 3) & ~3U, 64U);
+
+  float *pBlock;
+  LT_MEM_TRACK_ALLOC(pBlock = new float[nCapacity * PARTICLEARRAYS_NUMFIELDS], LT_MEM_TYPE_OBJECT);
+  if (!pBlock)
+    return false;
+
+  lt_MoveParticleArrays(m_ParticleArrays, pBlock, nCapacity);
+
+  delete[] m_pParticleArrayBlock;
+  m_pParticleArrayBlock = pBlock;
+  m_nParticleArrayCapacity = nCapacity;
+  return true;
+}
+
+void LTParticleSystem::FreeParticleArrays() {
+  delete[] m_pParticleArrayBlock;
+  m_pParticleArrayBlock = LTNULL;
+  m_nParticleArrayCapacity = 0;
+  memset(&m_ParticleArrays, 0, sizeof(m_ParticleArrays));
+}
+
 // ------------------------------------------------------------------------- //
 // LTPolyGrid.
 // ------------------------------------------------------------------------- //
@@ -3,6 +3,7 @@
 #include "clientmgr.h"
 #include "soundmgr.h"
 #include "soundbuffer.h"
+#include "sounddecodecache.h"
 #include "memorywatch.h"
 #include "sysstreamsim.h"
 #include "sysdebugging.h"
@@ -50,6 +51,7 @@ CSoundBuffer::CSoundBuffer()
     m_pSoundData = LTNULL;
     m_pDecompressedSoundBuffer = LTNULL;
     m_pFileData = LTNULL;
+    m_pDecodeBlock = LTNULL;
     m_dwFileSize = 0;
     m_nSampleType = DIG_F_MONO_8;
     dl_InitList(&m_InstanceList);
@@ -88,7 +90,18 @@ LTRESULT CSoundBuffer::InitFromCompressed(CSoundBuffer &compressedSoundBuffer)
 
     m_bTouched = LTTRUE;
 
-    if (compressedSoundBuffer.m_WaveHeader.m_WaveFormat.tag_ == ul::WaveFormatTag::ima_adpcm)
+    CSoundDecodeCache &decodeCache = GetClientILTSoundMgrImpl()->GetDecodeCache();
+
+    if (decodeCache.IsEnabled())
+    {
+        m_pDecodeBlock = decodeCache.Acquire(compressedSoundBuffer);
+        if (!m_pDecodeBlock)
+            return LT_ERROR;
+
+        m_pFileData = m_pDecodeBlock->m_pData;
+        m_dwFileSize = m_pDecodeBlock->m_dwDataSize;
+    }
+    else if (compressedSoundBuffer.m_WaveHeader.m_WaveFormat.tag_ == ul::WaveFormatTag::ima_adpcm)
     {
         if (!GetSoundSys()->DecompressADPCM(compressedSoundBuffer.m_SoundInfo,
             reinterpret_cast<void*&>(m_pFileData), m_dwFileSize))
@@ -115,9 +128,7 @@ LTRESULT CSoundBuffer::InitFromCompressed(CSoundBuffer &compressedSoundBuffer)
 
     if (LoadDataFromDecompressed() != LT_OK)
     {
-        GetSoundSys()->MemFreeLock(m_pFileData);
-
-        m_pFileData = LTNULL;
+        FreeFileData();
         return LT_ERROR;
     }
     g_dwSoundMemory += m_dwFileSize;
@@ -131,7 +142,12 @@ void CSoundBuffer::Term()
     LTLink *pCur, *pNext;
 
     if (m_pFileIdent)
+    {
         m_pFileIdent->m_pData = LTNULL;
+
+        // Nothing decoded from the file is any use once the identifier has gone.
+        GetClientILTSoundMgrImpl()->GetDecodeCache().Forget(m_pFileIdent);
+    }
     m_pFileIdent = LTNULL;
 
     pCur = m_InstanceList.m_Head.m_pNext;
@@ -159,14 +175,28 @@ void CSoundBuffer::Term()
 
     if (m_pFileData)
     {
-        GetSoundSys()->MemFreeLock(m_pFileData);
+        FreeFileData();
 
-        m_pFileData = LTNULL;
         g_dwSoundMemory -= m_dwFileSize;
         m_pSoundData = LTNULL;
     }
 }
 
+void CSoundBuffer::FreeFileData()
+{
+    if (m_pDecodeBlock)
+    {
+        GetClientILTSoundMgrImpl()->GetDecodeCache().Release(m_pDecodeBlock);
+        m_pDecodeBlock = LTNULL;
+    }
+    else if (m_pFileData)
+    {
+        GetSoundSys()->MemFreeLock(m_pFileData);
+    }
+
+    m_pFileData = LTNULL;
+}
+
 inline void CSoundBuffer::CalcSampleType(S32 &sampleType, ul::WaveFormatEx &waveFormat)
 {
     // Get the MSS sample type.
@@ -316,7 +346,9 @@ LTRESULT CSoundBuffer::LoadData()
                 m_pFileData = m_pDecompressedSoundBuffer->m_pFileData;
                 m_dwFileSize = m_pDecompressedSoundBuffer->m_dwFileSize;
                 m_pSoundData = m_pDecompressedSoundBuffer->m_pSoundData;
+                m_pDecodeBlock = m_pDecompressedSoundBuffer->m_pDecodeBlock;
                 m_pDecompressedSoundBuffer->m_pFileData = LTNULL;
+                m_pDecompressedSoundBuffer->m_pDecodeBlock = LTNULL;
                 m_SoundInfo = m_pDecompressedSoundBuffer->m_SoundInfo;
 
                 // No longer need the decompressed buffer.
@@ -347,7 +379,7 @@ LTRESULT CSoundBuffer::LoadData()
                         m_pFileData + dwTemp + 2 * m_WaveHeader.m_dwDataSize, 
                         m_dwFileSize - dwTemp - 2 * m_WaveHeader.m_dwDataSize);
 
-                    GetSoundSys()->MemFreeLock(m_pFileData);
+                    FreeFileData();
                     m_pFileData = pTempBuffer;
                     m_pSoundData = m_pFileData + dwTemp;
                     m_dwFileSize -= m_WaveHeader.m_dwDataSize;
@@ -470,10 +502,8 @@ LTRESULT CSoundBuffer::Unload()
 
     if (m_pFileData)
     {
+        FreeFileData();
 
-        GetSoundSys()->MemFreeLock(m_pFileData);
-
-        m_pFileData = LTNULL;
         g_dwSoundMemory -= m_dwFileSize;
         m_pSoundData = LTNULL;
     }
@@ -508,8 +538,10 @@ LTRESULT CSoundBuffer::AddInstance(CSoundInstance &soundInstance)
     }
 
     // If the buffer is compressed and it should be decompressed at start, then do it.
+    // With the decode cache on, all compressed sounds are, since that's what's cached.
     if (IsCompressed() && !(GetSoundBufferFlags() & SOUNDBUFFERFLAG_STREAM) &&
-        GetSoundBufferFlags() & SOUNDBUFFERFLAG_DECOMPRESSATSTART)
+        ((GetSoundBufferFlags() & SOUNDBUFFERFLAG_DECOMPRESSATSTART) ||
+        GetClientILTSoundMgrImpl()->GetDecodeCache().IsEnabled()))
     {
         // If the buffer is compressed and it doesn't have a decompressed buffer, decompress now.
         if (!m_pDecompressedSoundBuffer)
@@ -528,7 +560,9 @@ LTRESULT CSoundBuffer::RemoveInstance(CSoundInstance &soundInstance)
     dl_RemoveAt(&m_InstanceList, (LTLink *)soundInstance.GetSoundBufferLink());
 
     // Toss the decompressed buffer if we just needed it for a decompress at start buffer.
-    if (m_pDecompressedSoundBuffer && GetSoundBufferFlags() & SOUNDBUFFERFLAG_DECOMPRESSATSTART)
+    // A cached one goes back to the cache, where it can be picked up again cheaply.
+    if (m_pDecompressedSoundBuffer &&
+        ((GetSoundBufferFlags() & SOUNDBUFFERFLAG_DECOMPRESSATSTART) || m_pDecompressedSoundBuffer->m_pDecodeBlock))
     {
         // If there are no more instances of this buffer, then dump the decompressed data.
         if (m_InstanceList.m_nElements == 0)
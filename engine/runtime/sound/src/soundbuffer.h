@@ -19,6 +19,7 @@ namespace ul = bibendovsky::spul;
 
 
 class CSoundInstance;
+struct SoundDecodeBlock;
 
 inline float GetRandom(float min, float max)
 {
@@ -155,6 +156,10 @@ protected:
 
 	LTRESULT			LoadDataFromDecompressed( )	;
 
+	// Frees m_pFileData, or gives it back to the decode cache if that's where
+	// it came from.
+	void				FreeFileData( );
+
 	void				CalcSampleType( S32 &sampleType, ul::WaveFormatEx &waveFormat );
 
 protected:
@@ -169,6 +174,9 @@ protected:
 	uint32	m_dwFileSize;
 	uint8 *	m_pSoundData;
 
+	// Set if m_pFileData is shared with the decode cache.
+	SoundDecodeBlock *	m_pDecodeBlock;
+
 	CSoundBuffer *	m_pDecompressedSoundBuffer;
 
 	uint32	m_dwDuration;
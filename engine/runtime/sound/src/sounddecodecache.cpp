@@ -0,0 +1,451 @@
+
+#include "bdefs.h"
+
+#include "soundmgr.h"
+#include "soundbuffer.h"
+#include "sounddecodecache.h"
+#include "ltresourceloader.h"
+
+#include "bibendovsky_spul_memory_stream.h"
+
+#include <cstring>
+
+
+// "RIFF" + size + "WAVE" + "fmt " + size + format + "data" + size.
+#define SDC_WAVE_HEADER_SIZE	(4 + 4 + 4 + 4 + 4 + ul::WaveFormatEx::class_size + 4 + 4)
+
+
+static uint32 sdc_MakeFormat(uint32 dwChannels, uint32 dwBitDepth, uint32 dwSampleRate)
+{
+	return (dwSampleRate << 8) | ((dwBitDepth & 0x3F) << 2) | ((dwChannels - 1) & 0x3);
+}
+
+
+static void sdc_FreeWave(uint8 *pWave)
+{
+	delete [] pWave;
+}
+
+
+static uint8* sdc_WriteChunkHeader(uint8 *pOut, const char *pId, uint32 dwSize)
+{
+	memcpy(pOut, pId, 4);
+	memcpy(pOut + 4, &dwSize, 4);
+	return pOut + 8;
+}
+
+
+//----------------------------------------------------------------------------------------------
+//
+//  sdc_DecodeWave()
+//
+//  Decodes a compressed wave file into a PCM wave file in the given format.  The decoder is
+//  passed in so the client thread can reuse one; the resource loader threads make their own.
+//
+//----------------------------------------------------------------------------------------------
+static LTBOOL sdc_DecodeWave(ltjs::AudioDecoder &decoder, const void *pSource, uint32 dwSourceSize,
+	uint32 dwFormat, uint8 *&pWave, uint32 &dwWaveSize)
+{
+	pWave = LTNULL;
+	dwWaveSize = 0;
+
+	auto memoryStream = ul::MemoryStream{pSource, static_cast<int>(dwSourceSize)};
+
+	if (!memoryStream.is_open())
+		return LTFALSE;
+
+	auto decoderParam = ltjs::AudioDecoder::OpenParam{};
+	decoderParam.dst_channel_count_ = static_cast<int>((dwFormat & 0x3) + 1);
+	decoderParam.dst_bit_depth_ = static_cast<int>((dwFormat >> 2) & 0x3F);
+	decoderParam.dst_sample_rate_ = static_cast<int>(dwFormat >> 8);
+	decoderParam.stream_ptr_ = &memoryStream;
+
+	if (!decoder.open(decoderParam) || decoder.is_pcm())
+	{
+		decoder.close();
+		return LTFALSE;
+	}
+
+	const auto maxDecodedSize = decoder.get_data_size();
+
+	uint8 *pData;
+	LT_MEM_TRACK_ALLOC(pData = new uint8[SDC_WAVE_HEADER_SIZE + maxDecodedSize], LT_MEM_TYPE_SOUND);
+	if (!pData)
+	{
+		decoder.close();
+		return LTFALSE;
+	}
+
+	const auto decodedSize = decoder.decode(pData + SDC_WAVE_HEADER_SIZE, maxDecodedSize);
+
+	if (decodedSize <= 0)
+	{
+		decoder.close();
+		sdc_FreeWave(pData);
+		return LTFALSE;
+	}
+
+	const uint32 dwDataSize = static_cast<uint32>(decodedSize);
+	const auto& waveFormat = decoder.get_wave_format_ex();
+
+	uint8 *pOut = sdc_WriteChunkHeader(pData, "RIFF", SDC_WAVE_HEADER_SIZE - 8 + dwDataSize);
+	memcpy(pOut, "WAVE", 4);
+	pOut = sdc_WriteChunkHeader(pOut + 4, "fmt ", ul::WaveFormatEx::class_size);
+	memcpy(pOut, &waveFormat, ul::WaveFormatEx::class_size);
+	sdc_WriteChunkHeader(pOut + ul::WaveFormatEx::class_size, "data", dwDataSize);
+
+	decoder.close();
+
+	pWave = pData;
+	dwWaveSize = SDC_WAVE_HEADER_SIZE + dwDataSize;
+	return LTTRUE;
+}
+
+
+CSoundDecodeCache::CSoundDecodeCache()
+{
+	dl_InitList(&m_LRUList);
+
+	m_dwBudget = 0;
+	m_dwBytesUsed = 0;
+
+	m_dwNumHits = 0;
+	m_dwNumMisses = 0;
+	m_dwNumEvictions = 0;
+}
+
+CSoundDecodeCache::~CSoundDecodeCache()
+{
+	Term();
+}
+
+void CSoundDecodeCache::Term()
+{
+	// The done functions take the requests out of the map.
+	while (!m_Pending.empty())
+		FinishPending(m_Pending.begin()->second);
+
+	// Anything still in use is freed by its last release.
+	for (BlockMap::iterator iBlock = m_Blocks.begin(); iBlock != m_Blocks.end(); ++iBlock)
+	{
+		SoundDecodeBlock *pBlock = iBlock->second;
+
+		if (pBlock->m_dwRefCount == 0)
+			FreeBlock(pBlock);
+		else
+			pBlock->m_bCached = LTFALSE;
+	}
+
+	m_Blocks.clear();
+	dl_InitList(&m_LRUList);
+	m_dwBytesUsed = 0;
+}
+
+void CSoundDecodeCache::SetBudget(uint32 dwBytes)
+{
+	m_dwBudget = dwBytes;
+	Trim();
+}
+
+LTBOOL CSoundDecodeCache::MakeKey(CSoundBuffer &soundBuffer, SoundDecodeKey &key)
+{
+	if (!soundBuffer.GetFileIdent() || !soundBuffer.GetFileData(LTFALSE) || !soundBuffer.IsCompressed())
+		return LTFALSE;
+
+	// The decoders always put out 16 bits at the source's rate.
+	const ul::WaveFormatEx &waveFormat = soundBuffer.GetWaveFormat(LTFALSE);
+
+	key.m_pFileIdent = soundBuffer.GetFileIdent();
+	key.m_dwFormat = sdc_MakeFormat(waveFormat.channel_count_, 16, waveFormat.sample_rate_);
+	return LTTRUE;
+}
+
+SoundDecodeBlock* CSoundDecodeCache::Acquire(CSoundBuffer &soundBuffer)
+{
+	SoundDecodeKey key;
+	if (!MakeKey(soundBuffer, key))
+		return LTNULL;
+
+	// Finish the decode here rather than doing it twice.
+	PendingMap::iterator iPending = m_Pending.find(key);
+	if (iPending != m_Pending.end())
+		lt_GetResourceLoader().Wait(iPending->second->m_hRequest);
+
+	SoundDecodeBlock *pBlock;
+
+	BlockMap::iterator iBlock = m_Blocks.find(key);
+	if (iBlock != m_Blocks.end())
+	{
+		pBlock = iBlock->second;
+		++m_dwNumHits;
+
+		if (pBlock->m_dwRefCount == 0)
+			dl_RemoveAt(&m_LRUList, &pBlock->m_LRULink);
+	}
+	else
+	{
+		++m_dwNumMisses;
+
+		uint8 *pWave;
+		uint32 dwWaveSize;
+		if (!sdc_DecodeWave(m_Decoder, soundBuffer.GetFileData(LTFALSE), soundBuffer.GetFileDataLen(LTFALSE),
+			key.m_dwFormat, pWave, dwWaveSize))
+		{
+			return LTNULL;
+		}
+
+		pBlock = AddBlock(key, pWave, dwWaveSize);
+		if (!pBlock)
+			return LTNULL;
+
+		dl_RemoveAt(&m_LRUList, &pBlock->m_LRULink);
+	}
+
+	++pBlock->m_dwRefCount;
+
+	// Adding the block may have put the cache over budget.
+	Trim();
+
+	return pBlock;
+}
+
+void CSoundDecodeCache::Release(SoundDecodeBlock *pBlock)
+{
+	if (!pBlock)
+		return;
+
+	ASSERT(pBlock->m_dwRefCount > 0);
+	if (--pBlock->m_dwRefCount > 0)
+		return;
+
+	if (!pBlock->m_bCached)
+	{
+		FreeBlock(pBlock);
+		return;
+	}
+
+	dl_AddTail(&m_LRUList, &pBlock->m_LRULink, pBlock);
+	Trim();
+}
+
+void CSoundDecodeCache::DecodeAhead(CSoundBuffer &soundBuffer)
+{
+	if (!IsEnabled())
+		return;
+
+	SoundDecodeKey key;
+	if (!MakeKey(soundBuffer, key))
+		return;
+
+	if (m_Blocks.find(key) != m_Blocks.end() || m_Pending.find(key) != m_Pending.end())
+		return;
+
+	// The loader gets its own copy of the compressed data, so the sound buffer is free to be
+	// unloaded while it's being decoded.
+	const uint32 dwSourceSize = soundBuffer.GetFileDataLen(LTFALSE);
+
+	uint8 *pSource;
+	LT_MEM_TRACK_ALLOC(pSource = new uint8[dwSourceSize], LT_MEM_TYPE_SOUND);
+	if (!pSource)
+		return;
+
+	memcpy(pSource, soundBuffer.GetFileData(LTFALSE), dwSourceSize);
+
+	ILTStream *pStream = lt_OpenResourceFileStream(pSource, dwSourceSize);
+	if (!pStream)
+	{
+		lt_FreeResourceFile(pSource);
+		return;
+	}
+
+	PendingDecode *pPending;
+	LT_MEM_TRACK_ALLOC(pPending = new PendingDecode, LT_MEM_TYPE_SOUND);
+	pPending->m_pCache = this;
+	pPending->m_Key = key;
+	pPending->m_hRequest = 0;
+
+	LTResourceRequest request;
+	request.m_pKey = pPending;
+	request.m_Priority = LTRESOURCE_PRIORITY_LOW;
+	request.m_pStream = pStream;
+	request.m_LoadFn = DecodeAheadLoad;
+	request.m_DoneFn = DecodeAheadDone;
+	request.m_pUser = pPending;
+
+	pPending->m_hRequest = lt_GetResourceLoader().Queue(request);
+	if (!pPending->m_hRequest)
+	{
+		delete pPending;
+		return;
+	}
+
+	m_Pending[key] = pPending;
+}
+
+LTRESULT CSoundDecodeCache::DecodeAheadLoad(LTResourceRequest *pRequest)
+{
+	PendingDecode *pPending = (PendingDecode*)pRequest->m_pUser;
+
+	LTRESULT result = lt_LoadResourceFile(pRequest);
+	if (result != LT_OK)
+		return result;
+
+	void *pSource = pRequest->m_pData;
+	uint32 dwSourceSize = pRequest->m_DataSize;
+
+	pRequest->m_pData = LTNULL;
+	pRequest->m_DataSize = 0;
+
+	ltjs::AudioDecoder decoder;
+
+	uint8 *pWave;
+	uint32 dwWaveSize;
+	if (sdc_DecodeWave(decoder, pSource, dwSourceSize, pPending->m_Key.m_dwFormat, pWave, dwWaveSize))
+	{
+		pRequest->m_pData = pWave;
+		pRequest->m_DataSize = dwWaveSize;
+	}
+	else
+	{
+		result = LT_ERROR;
+	}
+
+	lt_FreeResourceFile(pSource);
+
+	return result;
+}
+
+void CSoundDecodeCache::DecodeAheadDone(LTResourceRequest *pRequest)
+{
+	PendingDecode *pPending = (PendingDecode*)pRequest->m_pUser;
+	CSoundDecodeCache *pCache = pPending->m_pCache;
+
+	PendingMap::iterator iPending = pCache->m_Pending.find(pPending->m_Key);
+	if (iPending != pCache->m_Pending.end() && iPending->second == pPending)
+		pCache->m_Pending.erase(iPending);
+
+	uint8 *pWave = (uint8*)pRequest->m_pData;
+
+	if (pRequest->m_Result == LT_OK && pWave &&
+		pCache->m_Blocks.find(pPending->m_Key) == pCache->m_Blocks.end())
+	{
+		if (pCache->AddBlock(pPending->m_Key, pWave, pRequest->m_DataSize))
+			pCache->Trim();
+	}
+	else
+	{
+		sdc_FreeWave(pWave);
+	}
+
+	pRequest->m_pData = LTNULL;
+
+	delete pPending;
+}
+
+void CSoundDecodeCache::Forget(const FileIdentifier *pFileIdent)
+{
+	if (!pFileIdent)
+		return;
+
+	// Get the decodes out of the way first; finishing one adds its block.
+	PendingMap::iterator iPending = m_Pending.begin();
+	while (iPending != m_Pending.end())
+	{
+		if (iPending->first.m_pFileIdent == pFileIdent)
+		{
+			FinishPending(iPending->second);
+			iPending = m_Pending.begin();
+		}
+		else
+		{
+			++iPending;
+		}
+	}
+
+	BlockMap::iterator iBlock = m_Blocks.begin();
+	while (iBlock != m_Blocks.end())
+	{
+		SoundDecodeBlock *pBlock = iBlock->second;
+
+		if (iBlock->first.m_pFileIdent != pFileIdent)
+		{
+			++iBlock;
+			continue;
+		}
+
+		iBlock = m_Blocks.erase(iBlock);
+		m_dwBytesUsed -= pBlock->m_dwDataSize;
+
+		if (pBlock->m_dwRefCount == 0)
+		{
+			dl_RemoveAt(&m_LRUList, &pBlock->m_LRULink);
+			FreeBlock(pBlock);
+		}
+		else
+		{
+			pBlock->m_bCached = LTFALSE;
+		}
+	}
+}
+
+void CSoundDecodeCache::FinishPending(PendingDecode *pPending)
+{
+	CLTResourceLoader &loader = lt_GetResourceLoader();
+
+	if (!loader.Cancel(pPending->m_hRequest))
+		loader.Wait(pPending->m_hRequest);
+}
+
+//----------------------------------------------------------------------------------------------
+//
+//  CSoundDecodeCache::AddBlock()
+//
+//  Takes ownership of decoded data and adds it to the cache as the most recently used block.
+//  The data is freed if it can't be added.
+//
+//----------------------------------------------------------------------------------------------
+SoundDecodeBlock* CSoundDecodeCache::AddBlock(const SoundDecodeKey &key, uint8 *pData, uint32 dwDataSize)
+{
+	SoundDecodeBlock *pBlock;
+	LT_MEM_TRACK_ALLOC(pBlock = new SoundDecodeBlock, LT_MEM_TYPE_SOUND);
+	if (!pBlock)
+	{
+		sdc_FreeWave(pData);
+		return LTNULL;
+	}
+
+	pBlock->m_Key = key;
+	pBlock->m_pData = pData;
+	pBlock->m_dwDataSize = dwDataSize;
+	pBlock->m_dwRefCount = 0;
+	pBlock->m_bCached = LTTRUE;
+
+	dl_TieOff(&pBlock->m_LRULink);
+	dl_AddTail(&m_LRUList, &pBlock->m_LRULink, pBlock);
+
+	m_Blocks[key] = pBlock;
+	m_dwBytesUsed += dwDataSize;
+
+	return pBlock;
+}
+
+void CSoundDecodeCache::FreeBlock(SoundDecodeBlock *pBlock)
+{
+	sdc_FreeWave(pBlock->m_pData);
+	delete pBlock;
+}
+
+void CSoundDecodeCache::Trim()
+{
+	while (m_dwBytesUsed > m_dwBudget && m_LRUList.m_nElements > 0)
+	{
+		SoundDecodeBlock *pBlock = (SoundDecodeBlock*)m_LRUList.m_Head.m_pNext->m_pData;
+
+		dl_RemoveAt(&m_LRUList, &pBlock->m_LRULink);
+		m_Blocks.erase(pBlock->m_Key);
+		m_dwBytesUsed -= pBlock->m_dwDataSize;
+		++m_dwNumEvictions;
+
+		FreeBlock(pBlock);
+	}
+}
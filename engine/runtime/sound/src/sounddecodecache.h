@@ -0,0 +1,164 @@
+#ifndef __SOUNDDECODECACHE_H__
+#define __SOUNDDECODECACHE_H__
+
+
+#include <unordered_map>
+
+#include "ltjs_audio_decoder.h"
+
+
+class CSoundBuffer;
+struct FileIdentifier;
+struct LTResourceRequest;
+
+
+// What a sound is decoded from and to.  The format packs the output channel
+// count, bit depth and sample rate.
+struct SoundDecodeKey
+{
+	const FileIdentifier	*m_pFileIdent;
+	uint32					m_dwFormat;
+
+	bool operator==(const SoundDecodeKey &other) const
+	{ return m_pFileIdent == other.m_pFileIdent && m_dwFormat == other.m_dwFormat; }
+};
+
+struct SoundDecodeKeyHash
+{
+	size_t operator()(const SoundDecodeKey &key) const
+	{ return std::hash<const void*>()(key.m_pFileIdent) ^ (size_t)key.m_dwFormat * 0x9E3779B1U; }
+};
+
+
+// A decoded sound, laid out as a PCM wave file so it can stand in for the
+// file data of a decompressed sound buffer.
+struct SoundDecodeBlock
+{
+	SoundDecodeKey	m_Key;
+
+	uint8 *			m_pData;
+	uint32			m_dwDataSize;
+
+	// Sound buffers using the block.  Blocks nobody is using sit in the LRU
+	// list and can be evicted.
+	uint32			m_dwRefCount;
+	LTLink			m_LRULink;
+
+	// Cleared when the block is dropped from the cache while it's still in
+	// use, so the last release frees it.
+	LTBOOL			m_bCached;
+};
+
+
+//------------------------------------------------------------------------
+//
+//	CLASS:		CSoundDecodeCache
+//
+//	PURPOSE:	Keeps the PCM of compressed (MP3, IMA ADPCM) sounds around
+//				after they've played, so sounds that play over and over
+//				aren't decoded every time.  Unused sounds are evicted least
+//				recently used first once the cache is over its budget.
+//
+//				Only use it from the client thread.  Decoding ahead happens
+//				on the resource loader, and the results are added to the
+//				cache from its done functions.
+//
+//------------------------------------------------------------------------
+class CSoundDecodeCache
+{
+public:
+
+	CSoundDecodeCache( );
+	~CSoundDecodeCache( );
+
+	// Waits for decoding ahead to finish and frees everything not in use.
+	void			Term( );
+
+	// A budget of zero turns the cache off.  Going over budget evicts unused
+	// blocks straight away.
+	void			SetBudget( uint32 dwBytes );
+
+	uint32			GetBudget( ) const
+	{ return m_dwBudget; }
+
+	LTBOOL			IsEnabled( ) const
+	{ return m_dwBudget != 0; }
+
+	// Returns the decoded data for a compressed sound buffer, decoding it now
+	// if it isn't cached.  Returns null if it can't be decoded.  Each
+	// Acquire needs a Release.
+	SoundDecodeBlock *	Acquire( CSoundBuffer &soundBuffer );
+
+	void			Release( SoundDecodeBlock *pBlock );
+
+	// Decodes a compressed sound buffer on the resource loader so the first
+	// time it plays is a hit.
+	void			DecodeAhead( CSoundBuffer &soundBuffer );
+
+	// Drops everything decoded from a file.  Called when its sound buffer
+	// goes away, since the file identifier may be reused.
+	void			Forget( const FileIdentifier *pFileIdent );
+
+	uint32			GetNumHits( ) const
+	{ return m_dwNumHits; }
+
+	uint32			GetNumMisses( ) const
+	{ return m_dwNumMisses; }
+
+	uint32			GetNumEvictions( ) const
+	{ return m_dwNumEvictions; }
+
+	// Bytes held by cached blocks, in use or not.
+	uint32			GetBytesUsed( ) const
+	{ return m_dwBytesUsed; }
+
+	uint32			GetNumBlocks( ) const
+	{ return (uint32)m_Blocks.size( ); }
+
+private:
+
+	// A decode queued on the resource loader.
+	struct PendingDecode
+	{
+		CSoundDecodeCache *	m_pCache;
+		SoundDecodeKey		m_Key;
+		uint32				m_hRequest;
+	};
+
+	typedef std::unordered_map< SoundDecodeKey, SoundDecodeBlock*, SoundDecodeKeyHash > BlockMap;
+	typedef std::unordered_map< SoundDecodeKey, PendingDecode*, SoundDecodeKeyHash > PendingMap;
+
+	static LTBOOL	MakeKey( CSoundBuffer &soundBuffer, SoundDecodeKey &key );
+
+	static LTRESULT	DecodeAheadLoad( LTResourceRequest *pRequest );
+	static void		DecodeAheadDone( LTResourceRequest *pRequest );
+
+	// Cancels a decode, or waits for it if it's already started.  Either way
+	// its done function runs and takes it out of m_Pending.
+	void			FinishPending( PendingDecode *pPending );
+
+	SoundDecodeBlock *	AddBlock( const SoundDecodeKey &key, uint8 *pData, uint32 dwDataSize );
+	void			FreeBlock( SoundDecodeBlock *pBlock );
+
+	// Evicts unused blocks until the cache is within budget.
+	void			Trim( );
+
+	BlockMap		m_Blocks;
+	PendingMap		m_Pending;
+
+	// Unused blocks, least recently used first.
+	LTList			m_LRUList;
+
+	uint32			m_dwBudget;
+	uint32			m_dwBytesUsed;
+
+	uint32			m_dwNumHits;
+	uint32			m_dwNumMisses;
+	uint32			m_dwNumEvictions;
+
+	// Used for decoding on the client thread.
+	ltjs::AudioDecoder	m_Decoder;
+};
+
+
+#endif // __SOUNDDECODECACHE_H__
@@ -82,6 +82,7 @@ CSoundInstance::CSoundInstance( )
  
 	m_nNumCollisions = 0;
 	m_fModifiedPriority = 0;
+	m_nPriorityKey = 0;
 	m_dwListIndex = 0;
 	dl_TieOff( &m_BufferLink );
 
@@ -127,6 +128,7 @@ LTRESULT	CSoundInstance::Init( CSoundBuffer &soundBuffer, PlaySoundInfo &playSou
 	m_h3DSample = LTNULL;
 	m_hStream = LTNULL;
 	m_fModifiedPriority = ( float )m_nPriority + 1.0f;
+	m_nPriorityKey = 0;
 	m_dwResumeTime = 0;
 
 	// If the sound is client side, then set the sound handle as this object
@@ -230,6 +232,7 @@ void CSoundInstance::Term( )
 	m_hStream = LTNULL;
 
 	m_fModifiedPriority = 0;
+	m_nPriorityKey = 0;
 	m_dwListIndex = 0;
 
 #ifdef USE_DX8_SOFTWARE_FILTERS
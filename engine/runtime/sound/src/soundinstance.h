@@ -58,6 +58,13 @@ public:
 	float			GetModifiedPriority( ) const
 	{ return m_fModifiedPriority; }
 
+	// The sound manager's ordering key, worked out from the priority each update.
+	uint64			GetPriorityKey( ) const
+	{ return m_nPriorityKey; }
+
+	void			SetPriorityKey( uint64 nPriorityKey )
+	{ m_nPriorityKey = nPriorityKey; }
+
 	uint32			GetPlaySoundFlags( ) const
 	{ return m_dwPlaySoundFlags; }
 
@@ -216,6 +223,7 @@ protected:
 
 	uint8			m_nPriority;
 	float			m_fModifiedPriority;
+	uint64			m_nPriorityKey;
 	uint8			m_nVolume;
 	uint16			m_nCurRawVolume;
 	uint16			m_nCurPan;
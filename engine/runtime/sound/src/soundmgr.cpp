@@ -6,6 +6,9 @@
 #include "clientshell.h"
 #include "wave.h"
 
+#include <algorithm>
+#include <cstring>
+
 //------------------------------------------------------------------
 //------------------------------------------------------------------
 // Holders and their headers.
@@ -35,6 +38,7 @@ implements_also(CSoundMgr, Default, ILTSoundMgr, Client)
 //#define MODPROVIDER
 
 extern int32 g_CV_ForceNoSound;
+extern int32 g_CV_SoundCacheSize;
 
 #define EAX_ENVIRONMENT_GENERIC     LS_ROOM_GENERIC
 #define EAX_ENVIRONMENT_COUNT       LS_ROOM_TYPE_COUNT
@@ -197,6 +201,9 @@ CSoundMgr::CSoundMgr()
 
     memset(m_SoundInstanceList, 0, SOUNDMGR_MAXSOUNDINSTANCES * sizeof(CSoundInstance *));
     m_dwNumSoundInstances = 0;
+    m_dwNum3DVoices = 0;
+    m_dwNumSWVoices = 0;
+    m_bVoiceHeapsBuilt = false;
 
     m_bConvert16to8 = false;
 
@@ -327,6 +334,9 @@ LTRESULT CSoundMgr::Init(InitSoundInfo &soundInit)
     m_bValid = true;
     m_bEnabled = true;
 
+    // Set here as well as in Update, since sounds can be preloaded before the first update.
+    m_DecodeCache.SetBudget((uint32)LTMAX(g_CV_SoundCacheSize, 0) * 1024);
+
     // Initialize the Sound System
 
 	// In case of failure, be sure to return gracefully instead of bombing
@@ -566,6 +576,8 @@ void CSoundMgr::Term(bool bRemoveSounds)
         }
         dl_InitList(&m_SoundBufferList);
         m_SoundBufferBank.Term();
+
+        m_DecodeCache.Term();
     }
 
     // Remove the samples
@@ -852,6 +864,7 @@ LTRESULT CSoundMgr::Create3DSamples()
                 break;
             g_pSoundSys->Set3DUserData(m_p3DSampleList[nSample].m_h3DSample, SAMPLE_TYPE, SAMPLETYPE_3D);
             g_pSoundSys->Set3DUserData(m_p3DSampleList[nSample].m_h3DSample, SAMPLE_LISTITEM, reinterpret_cast<std::intptr_t>(&m_p3DSampleList[nSample]));
+            m_p3DSampleList[nSample].m_pSoundInstance = LTNULL;
             dl_AddHead(&m_3DFreeSampleList, &m_p3DSampleList[nSample].m_Link, &m_p3DSampleList[nSample]);
         }
 
@@ -884,7 +897,7 @@ LTRESULT CSoundMgr::Remove3DSamples()
         while (nSample-- > 0)
         {
             // Get rid of any instance using this sample
-            pSoundInstance = GetLink3DSampleSoundInstance(m_p3DSampleList[nSample].m_h3DSample);
+            pSoundInstance = m_p3DSampleList[nSample].m_pSoundInstance;
             if (pSoundInstance)
             {
                 pSoundInstance->Silence(true);
@@ -944,6 +957,7 @@ LTRESULT CSoundMgr::CreateSWSamples()
                 break;
             g_pSoundSys->SetSampleUserData(m_pSWSampleList[nSample].m_hSample, SAMPLE_TYPE, SAMPLETYPE_SW);
             g_pSoundSys->SetSampleUserData(m_pSWSampleList[nSample].m_hSample, SAMPLE_LISTITEM, reinterpret_cast<std::intptr_t>(&m_pSWSampleList[nSample]));
+            m_pSWSampleList[nSample].m_pSoundInstance = LTNULL;
             
             dl_AddHead(&m_SWFreeSampleList, &m_pSWSampleList[nSample].m_Link, &m_pSWSampleList[nSample]);
         }
@@ -979,7 +993,7 @@ LTRESULT CSoundMgr::RemoveSWSamples()
         while (nSample-- > 0)
         {
             // Get rid of any instance using this sample
-            pSoundInstance = GetLinkSampleSoundInstance(m_pSWSampleList[nSample].m_hSample);
+            pSoundInstance = m_pSWSampleList[nSample].m_pSoundInstance;
             if (pSoundInstance)
             {
                 pSoundInstance->Silence(true);
@@ -1244,11 +1258,9 @@ CSoundInstance *CSoundMgr::FindSoundInstance(HLTSOUND hSound, bool bClientSound)
 //----------------------------------------------------------------------------------------------
 LTRESULT CSoundMgr::Update()
 {
-    uint32 dwIndex, dwSearchIndex;
+    uint32 dwIndex;
     CSoundInstance *pSoundInstance, *pSearchSoundInstance;
 
-    HSAMPLE hSample;
-
     LTObject *pClientObject = LTNULL;
     LTVector vDeltaPos;
     LTVector vVelocity;
@@ -1264,6 +1276,8 @@ LTRESULT CSoundMgr::Update()
     if (m_bDigitalHandleReleased && m_bReacquireDigitalHandle)
         ReacquireDigitalHandle();
 
+    m_DecodeCache.SetBudget((uint32)LTMAX(g_CV_SoundCacheSize, 0) * 1024);
+
     // Update the timer
     dwCurTime = g_pSoundSys->MsCount();
 
@@ -1338,42 +1352,25 @@ LTRESULT CSoundMgr::Update()
     {
         pSoundInstance = m_SoundInstanceList[dwIndex];
         ASSERT(pSoundInstance);
-        if (!pSoundInstance)
-            continue;
-
-        if (pSoundInstance->GetSoundInstanceFlags() & SOUNDINSTANCEFLAG_DONE)
-            continue;
-        
-        pSoundInstance->Preupdate(m_vListenerPosition);
-        // Check if sound is within ear shot...
-        if (!(pSoundInstance->GetSoundInstanceFlags() & SOUNDINSTANCEFLAG_EARSHOT))
-        {
-            pSoundInstance->Silence();
-        }
-    }
-
-    if (m_dwNumSoundInstances > 1)
-    {
-
-        qsort(m_SoundInstanceList, m_dwNumSoundInstances, sizeof(CSoundInstance *), CompareSoundInstances);
 
-        // Reset the indices
-        for (dwIndex = 0; dwIndex < m_dwNumSoundInstances; dwIndex++)
+        if (!(pSoundInstance->GetSoundInstanceFlags() & SOUNDINSTANCEFLAG_DONE))
         {
-            pSoundInstance = m_SoundInstanceList[dwIndex];
-            ASSERT(pSoundInstance);
-            if (!pSoundInstance)
+            pSoundInstance->Preupdate(m_vListenerPosition);
+            // Check if sound is within ear shot...
+            if (!(pSoundInstance->GetSoundInstanceFlags() & SOUNDINSTANCEFLAG_EARSHOT))
             {
-                m_dwNumSoundInstances = dwIndex;
-                break;
+                pSoundInstance->Silence();
             }
-
-            // The sort messes up the indices, so this needs to happen
-            pSoundInstance->SetListIndex(dwIndex);
         }
 
+        pSoundInstance->SetPriorityKey(MakePriorityKey(*pSoundInstance));
     }
 
+    SortSoundInstances();
+
+    // The voice heaps get built if a sound needs to take another's sample
+    m_bVoiceHeapsBuilt = false;
+
     // Give sounds channel samples based on priority
     for (dwIndex = 0; dwIndex < m_dwNumSoundInstances; dwIndex++)
     {
@@ -1416,37 +1413,44 @@ LTRESULT CSoundMgr::Update()
         {
             // Try to get a free 3d sample
             if (pSoundInstance->Acquire3DSample() == LT_OK)
+            {
+                AddVoice(pSoundInstance);
                 continue;
+            }
         }
         else if (pSoundInstance->AcquireSample() == LT_OK)
+        {
+            AddVoice(pSoundInstance);
             continue;
+        }
+
+        if (!m_bVoiceHeapsBuilt)
+            BuildVoiceHeaps();
 
         // Find the lowest priority sound with a sample and snag it
-        for (dwSearchIndex = m_dwNumSoundInstances - 1; dwSearchIndex > dwIndex; dwSearchIndex--)
+        if (m_nMax3DSamples && (pSoundInstance->GetType() == SOUNDTYPE_3D || 
+            (m_b3DReverb && pSoundInstance->GetPlaySoundFlags() & PLAYSOUND_REVERB)))
         {
-            pSearchSoundInstance = m_SoundInstanceList[dwSearchIndex];
+            // Only non-streaming 3d sounds take 3d samples from other sounds
+            if (pSoundInstance->GetType() != SOUNDTYPE_3D)
+                continue;
 
-            if (m_nMax3DSamples && (pSoundInstance->GetType() == SOUNDTYPE_3D || 
-                (m_b3DReverb && pSoundInstance->GetPlaySoundFlags() & PLAYSOUND_REVERB)))
+            pSearchSoundInstance = RemoveLowestVoice(true, dwIndex);
+            if (pSearchSoundInstance)
             {
-                // Check if it has a 3d sample
-                if ((pSearchSoundInstance->Get3DSample()) != LTNULL)
-                {
-                    // Check if new sound is non-streaming 3d sound
-                    if (pSoundInstance->GetType() == SOUNDTYPE_3D && !(pSoundInstance->GetSoundBuffer()->GetSoundBufferFlags() & SOUNDBUFFERFLAG_STREAM))
-                    {
-                        pSearchSoundInstance->Silence();
-                        pSoundInstance->Acquire3DSample();
-                        break;
-                    }
-                }
+                pSearchSoundInstance->Silence();
+                if (pSoundInstance->Acquire3DSample() == LT_OK)
+                    AddVoice(pSoundInstance);
             }
-            // Check if it has a regular sample
-            else if ((hSample = pSearchSoundInstance->GetSample()) != LTNULL)
+        }
+        else
+        {
+            pSearchSoundInstance = RemoveLowestVoice(false, dwIndex);
+            if (pSearchSoundInstance)
             {
                 pSearchSoundInstance->Silence();
-                pSoundInstance->AcquireSample();
-                break;
+                if (pSoundInstance->AcquireSample() == LT_OK)
+                    AddVoice(pSoundInstance);
             }
         }
     }
@@ -1508,79 +1512,178 @@ LTRESULT CSoundMgr::Update()
 
 //----------------------------------------------------------------------------------------------
 //
-//  CSoundMgr::CompareSoundInstances
+//  CSoundMgr::MakePriorityKey
+//
+//  Packs everything sounds are ordered by into one number, so the list can be kept in order
+//  by comparing keys.  From the top bit down:
 //
-//  Compares priority of two sound instances.  Return values are reversed so qsort sorts in 
-//  decreasing order.
+//      63      Local sound.  Local sounds go before all non-local sounds.
+//      62-31   Modified priority.
+//      30      Playing.  Playing sounds go before non-playing ones of equal priority.
+//      29-0    How new the sound is.  Newer sounds go first, and sounds with a pre-delay or
+//              no buffer go last.
 // 
 //----------------------------------------------------------------------------------------------
-int CSoundMgr::CompareSoundInstances(const void *pElem1, const void *pElem2)
+uint64 CSoundMgr::MakePriorityKey(const CSoundInstance &soundInstance)
 {
-    CSoundInstance *pSoundInstance1, *pSoundInstance2;
-    int nTimePlaying1, nTimePlaying2;
+    const uint32 dwMaxAge = (1 << 30) - 1;
+    uint64 nKey;
+    uint32 dwPriority;
+    float fPriority;
+    int32 nTimePlaying;
+
+    nKey = 0;
 
-    pSoundInstance1 = *(CSoundInstance **)pElem1;
-    pSoundInstance2 = *(CSoundInstance **)pElem2;
+    if (soundInstance.GetType() == SOUNDTYPE_LOCAL)
+        nKey |= (uint64)1 << 63;
 
-    // Null pointers are considered low order
-    if (pSoundInstance1)
+    // Flip the float's bits so they compare as unsigned integers in the same order as the floats
+    fPriority = soundInstance.GetModifiedPriority();
+    memcpy(&dwPriority, &fPriority, sizeof(dwPriority));
+    dwPriority = (dwPriority & 0x80000000) ? ~dwPriority : (dwPriority | 0x80000000);
+    nKey |= (uint64)dwPriority << 31;
+
+    if (soundInstance.GetSoundInstanceFlags() & SOUNDINSTANCEFLAG_PLAYING)
+        nKey |= (uint64)1 << 30;
+
+    if (soundInstance.GetSoundBuffer())
     {
-        if (!pSoundInstance2)
-            return -1;
+        // The amount of time the sound has been alive.  If there is a pre-delay, it's negative.
+        nTimePlaying = (int32)(soundInstance.GetDuration() - soundInstance.GetTimer());
+        if (nTimePlaying >= 0)
+            nKey |= dwMaxAge - LTMIN((uint32)nTimePlaying, dwMaxAge - 1);
     }
-    else if (pSoundInstance2)
-        return 1;
-    else
-        return 0;
 
-    // Local sounds have highest priority of all, and go before all non-local sounds in list
-    if (pSoundInstance1->GetType() == SOUNDTYPE_LOCAL)
+    return nKey;
+}
+
+//----------------------------------------------------------------------------------------------
+//
+//  CSoundMgr::SortSoundInstances
+//
+//  Puts the sound instances back in decreasing order of priority key.  Priorities only drift
+//  between updates, and new sounds are added at the end, so the list is nearly in order
+//  already.  An insertion sort only has to move the sounds that changed places, and keeps
+//  sounds with equal keys in the order they were in.
+// 
+//----------------------------------------------------------------------------------------------
+void CSoundMgr::SortSoundInstances()
+{
+    uint32 dwIndex, dwInsert;
+    CSoundInstance *pSoundInstance;
+    uint64 nKey;
+
+    for (dwIndex = 1; dwIndex < m_dwNumSoundInstances; dwIndex++)
     {
-        if (pSoundInstance2->GetType() != SOUNDTYPE_LOCAL)
-            return -1;
+        pSoundInstance = m_SoundInstanceList[dwIndex];
+        nKey = pSoundInstance->GetPriorityKey();
+
+        if (m_SoundInstanceList[dwIndex - 1]->GetPriorityKey() >= nKey)
+            continue;
+
+        // Shift lower priority sounds down to make room
+        dwInsert = dwIndex;
+        do
+        {
+            m_SoundInstanceList[dwInsert] = m_SoundInstanceList[dwInsert - 1];
+            m_SoundInstanceList[dwInsert]->SetListIndex(dwInsert);
+            dwInsert--;
+        }
+        while (dwInsert > 0 && m_SoundInstanceList[dwInsert - 1]->GetPriorityKey() < nKey);
+
+        m_SoundInstanceList[dwInsert] = pSoundInstance;
+        pSoundInstance->SetListIndex(dwInsert);
     }
-    else if (pSoundInstance2->GetType() == SOUNDTYPE_LOCAL)
-        return 1;
+}
+
+//----------------------------------------------------------------------------------------------
+//
+//  Voice heaps
+//
+//  The heaps are ordered on list index, so the top of each is the lowest priority sound with
+//  that kind of sample.
+// 
+//----------------------------------------------------------------------------------------------
+
+static bool CompareVoiceListIndex(const CSoundInstance *pSoundInstance1, const CSoundInstance *pSoundInstance2)
+{
+    return pSoundInstance1->GetListIndex() < pSoundInstance2->GetListIndex();
+}
 
-    // If sound has higher priority, then insert it before the test sound
-    if (pSoundInstance1->GetModifiedPriority() > pSoundInstance2->GetModifiedPriority())
-        return -1;
+void CSoundMgr::BuildVoiceHeaps()
+{
+    uint8 nSample;
+    CSoundInstance *pSoundInstance;
 
-    // Check if sounds have equal priority
-    if (pSoundInstance1->GetModifiedPriority() == pSoundInstance2->GetModifiedPriority())
+    m_dwNum3DVoices = 0;
+    for (nSample = 0; nSample < m_nNum3DSamples; nSample++)
     {
-        // Playing sounds have a slightly higher priority than non-playing
-        if (pSoundInstance1->GetSoundInstanceFlags() & SOUNDINSTANCEFLAG_PLAYING)
-        { 
-            if (!(pSoundInstance2->GetSoundInstanceFlags() & SOUNDINSTANCEFLAG_PLAYING))
-                return -1;
-        }
-        else if (pSoundInstance2->GetSoundInstanceFlags() & SOUNDINSTANCEFLAG_PLAYING)
-            return 1;
+        pSoundInstance = m_p3DSampleList[nSample].m_pSoundInstance;
+        if (pSoundInstance)
+            m_3DVoiceHeap[m_dwNum3DVoices++] = pSoundInstance;
+    }
+    std::make_heap(m_3DVoiceHeap, m_3DVoiceHeap + m_dwNum3DVoices, CompareVoiceListIndex);
 
-        if (!pSoundInstance1->GetSoundBuffer() || !pSoundInstance2->GetSoundBuffer())
-            return 0;
-    
-        // Get the amount of time the sound has been alive.  If there is a pre-delay, then it has low priority
-        nTimePlaying1 = pSoundInstance1->GetDuration() - pSoundInstance1->GetTimer();
-        if (nTimePlaying1 < 0)
-            return 1;
-
-        // Get the amount of time the sound has been alive.  If there is a pre-delay, then it has low priority
-        nTimePlaying2 = pSoundInstance2->GetDuration() - pSoundInstance2->GetTimer();
-        if (nTimePlaying2 < 0)
-            return -1;
-
-        // Neither sound is playing.  Give priority to newest sound.
-        if (nTimePlaying1 < nTimePlaying2)
-            return -1;
-        else if (nTimePlaying1 > nTimePlaying2)
-            return 1;
+    m_dwNumSWVoices = 0;
+    for (nSample = 0; nSample < m_nNumSWSamples; nSample++)
+    {
+        pSoundInstance = m_pSWSampleList[nSample].m_pSoundInstance;
+        if (pSoundInstance)
+            m_SWVoiceHeap[m_dwNumSWVoices++] = pSoundInstance;
+    }
+    std::make_heap(m_SWVoiceHeap, m_SWVoiceHeap + m_dwNumSWVoices, CompareVoiceListIndex);
+
+    m_bVoiceHeapsBuilt = true;
+}
+
+void CSoundMgr::AddVoice(CSoundInstance *pSoundInstance)
+{
+    if (!m_bVoiceHeapsBuilt)
+        return;
+
+    if (pSoundInstance->Get3DSample() && m_dwNum3DVoices < SOUNDMGR_MAXSOUNDINSTANCES)
+    {
+        m_3DVoiceHeap[m_dwNum3DVoices++] = pSoundInstance;
+        std::push_heap(m_3DVoiceHeap, m_3DVoiceHeap + m_dwNum3DVoices, CompareVoiceListIndex);
+    }
+    else if (pSoundInstance->GetSample() && m_dwNumSWVoices < SOUNDMGR_MAXSOUNDINSTANCES)
+    {
+        m_SWVoiceHeap[m_dwNumSWVoices++] = pSoundInstance;
+        std::push_heap(m_SWVoiceHeap, m_SWVoiceHeap + m_dwNumSWVoices, CompareVoiceListIndex);
+    }
+}
+
+CSoundInstance *CSoundMgr::RemoveLowestVoice(bool b3D, uint32 dwIndex)
+{
+    CSoundInstance **pHeap;
+    uint32 *pdwNumVoices;
+    CSoundInstance *pSoundInstance;
+
+    pHeap = b3D ? m_3DVoiceHeap : m_SWVoiceHeap;
+    pdwNumVoices = b3D ? &m_dwNum3DVoices : &m_dwNumSWVoices;
+
+    while (*pdwNumVoices > 0)
+    {
+        pSoundInstance = pHeap[0];
+
+        // Sounds that already lost their sample are left in the heap until they reach the top
+        if (b3D ? pSoundInstance->Get3DSample() : pSoundInstance->GetSample())
+        {
+            // Don't take samples from sounds with higher priority
+            if (pSoundInstance->GetListIndex() <= dwIndex)
+                return LTNULL;
+        }
         else
-            return 0;
+            pSoundInstance = LTNULL;
+
+        std::pop_heap(pHeap, pHeap + *pdwNumVoices, CompareVoiceListIndex);
+        (*pdwNumVoices)--;
+
+        if (pSoundInstance)
+            return pSoundInstance;
     }
 
-    return 1;
+    return LTNULL;
 }
 
 //----------------------------------------------------------------------------------------------
@@ -1775,11 +1878,16 @@ LTRESULT CSoundMgr::PlaySound(PlaySoundInfo &playSoundInfo, FileIdentifier &file
 
 LTRESULT CSoundMgr::LinkSampleSoundInstance(HSAMPLE hSample, CSoundInstance *pSoundInstance)
 {
+    CSample *pSample;
     ASSERT(hSample);
     if (!hSample || !g_pSoundSys)
         return LT_ERROR;
 
-    g_pSoundSys->SetSampleUserData(hSample, SAMPLE_INSTANCE, reinterpret_cast<std::intptr_t>(pSoundInstance));
+    pSample = (CSample*) g_pSoundSys->GetSampleUserData(hSample, SAMPLE_LISTITEM);
+    if (!pSample)
+        return LT_ERROR;
+
+    pSample->m_pSoundInstance = pSoundInstance;
 
     return LT_OK;
 }
@@ -1794,14 +1902,14 @@ LTRESULT CSoundMgr::LinkSampleSoundInstance(HSAMPLE hSample, CSoundInstance *pSo
 
 CSoundInstance *CSoundMgr::GetLinkSampleSoundInstance(HSAMPLE hSample)
 {
-    CSoundInstance *pSoundInstance;
+    CSample *pSample;
     ASSERT(hSample);
     if (!hSample || !g_pSoundSys)
         return LTNULL;
 
-    pSoundInstance = (CSoundInstance*) g_pSoundSys->GetSampleUserData(hSample, SAMPLE_INSTANCE);
+    pSample = (CSample*) g_pSoundSys->GetSampleUserData(hSample, SAMPLE_LISTITEM);
 
-    return pSoundInstance;
+    return pSample ? pSample->m_pSoundInstance : LTNULL;
 }
 
 //----------------------------------------------------------------------------------------------
@@ -1814,10 +1922,15 @@ CSoundInstance *CSoundMgr::GetLinkSampleSoundInstance(HSAMPLE hSample)
 
 LTRESULT CSoundMgr::Link3DSampleSoundInstance(H3DSAMPLE h3DSample, CSoundInstance *pSoundInstance)
 {
+    CSample *pSample;
     if (!h3DSample || !g_pSoundSys)
         return LT_ERROR;
 
-    g_pSoundSys->Set3DUserData(h3DSample, SAMPLE_INSTANCE, reinterpret_cast<std::intptr_t>(pSoundInstance));
+    pSample = (CSample*) g_pSoundSys->Get3DUserData(h3DSample, SAMPLE_LISTITEM);
+    if (!pSample)
+        return LT_ERROR;
+
+    pSample->m_pSoundInstance = pSoundInstance;
 
     return LT_OK;
 }
@@ -1832,13 +1945,13 @@ LTRESULT CSoundMgr::Link3DSampleSoundInstance(H3DSAMPLE h3DSample, CSoundInstanc
 
 CSoundInstance *CSoundMgr::GetLink3DSampleSoundInstance(H3DSAMPLE h3DSample)
 {
-    CSoundInstance *pSoundInstance;
+    CSample *pSample;
     if (!h3DSample || !g_pSoundSys)
         return LTNULL;
 
-    pSoundInstance = (CSoundInstance*) g_pSoundSys->Get3DUserData(h3DSample, SAMPLE_INSTANCE);
+    pSample = (CSample*) g_pSoundSys->Get3DUserData(h3DSample, SAMPLE_LISTITEM);
 
-    return pSoundInstance;
+    return pSample ? pSample->m_pSoundInstance : LTNULL;
 }
 
 //----------------------------------------------------------------------------------------------
@@ -62,6 +62,10 @@ extern ILTSoundSys* SoundSys( bool bTerminate = false );
 #include "soundinstance.h"
 #endif
 
+#ifndef __SOUNDDECODECACHE_H__
+#include "sounddecodecache.h"
+#endif
+
 
 
 class CSoundBuffer;
@@ -138,6 +142,9 @@ struct CSample
 //	===========================================================================
 	};
 
+	// The sound instance playing on the sample, if any.
+	CSoundInstance *	m_pSoundInstance;
+
 	LTLink			m_Link;
 };
 
@@ -309,7 +316,8 @@ public:
 	float		GetDistanceFactor( ) const
 	{ return m_fDistanceFactor; }
 	
-	static int	CompareSoundInstances( const void *pElem1, const void *pElem2 )
+	// Orders sound instances by priority; a higher key plays first.
+	static uint64	MakePriorityKey( const CSoundInstance &soundInstance )
 	;
 
 	bool		UseSWReverb( ) const
@@ -393,6 +401,9 @@ public:
 	ObjectBank< CSoundBuffer > &GetSoundBufferBank( ) 
 	{ return m_SoundBufferBank; }
 
+	CSoundDecodeCache &GetDecodeCache( )
+	{ return m_DecodeCache; }
+
 private:
 	
 	LTRESULT	Get3DProviderLists( CProvider *&p3DProviderList, bool bVerifyOpens = TRUE, uint32 uiMax3DVoices = 0 )
@@ -422,6 +433,22 @@ private:
 	LTRESULT	RemoveBuffer( CSoundBuffer &soundBuffer )
 	;
 
+	// Puts m_SoundInstanceList back in priority order.
+	void		SortSoundInstances( )
+	;
+
+	void		BuildVoiceHeaps( )
+	;
+
+	// Adds a sound that just got a sample to the voice heaps, if they've been built.
+	void		AddVoice( CSoundInstance *pSoundInstance )
+	;
+
+	// Takes the lowest priority sound with a 3d or software sample off its heap, as long as
+	// it's lower in the list than dwIndex.
+	CSoundInstance *	RemoveLowestVoice( bool b3D, uint32 dwIndex )
+	;
+
 private:
 
 	InitSoundInfo	m_InitSoundInfo;
@@ -463,6 +490,10 @@ private:
 	CSample *	m_pSWSampleList;
 	LTList		m_SWFreeSampleList;
 
+	// Declared ahead of the buffers, which hand their decoded data back to it
+	// when they're destroyed.
+	CSoundDecodeCache	m_DecodeCache;
+
 	ObjectBank< CSoundBuffer > m_SoundBufferBank;
 	LTList		m_SoundBufferList;
 
@@ -473,6 +504,15 @@ private:
 	CSoundInstance *	m_SoundInstanceList[SOUNDMGR_MAXSOUNDINSTANCES];
 	uint32		m_dwNumSoundInstances;
 
+	// The sounds with 3d and software samples, as heaps with the lowest priority sound (the
+	// one furthest down m_SoundInstanceList) on top.  Only built during an update once a sound
+	// has to take a sample from another.
+	CSoundInstance *	m_3DVoiceHeap[SOUNDMGR_MAXSOUNDINSTANCES];
+	uint32		m_dwNum3DVoices;
+	CSoundInstance *	m_SWVoiceHeap[SOUNDMGR_MAXSOUNDINSTANCES];
+	uint32		m_dwNumSWVoices;
+	bool		m_bVoiceHeapsBuilt;
+
     ul::WaveFormatEx m_PrimaryBufferWaveFormat;
 
 //	===========================================================================
@@ -1382,6 +1382,7 @@ LHSTREAM OalLtSoundSys::OpenStream(
 	open_param.is_file_ = true;
 	open_param.file_name_ = file_name;
 	open_param.file_offset_ = file_offset;
+	open_param.decoder_pool_ = &decoder_pool_;
 
 	if (!source.open(open_param))
 	{
@@ -1765,12 +1766,16 @@ void OalLtSoundSys::uninitialize_streaming()
 
 	streams_.clear();
 	mt_open_streams_.clear();
+
+	decoder_pool_.stop();
 }
 
 void OalLtSoundSys::initialize_streaming()
 {
 	uninitialize_streaming();
 
+	decoder_pool_.start(decoder_pool_thread_count);
+
 	mt_sound_thread_ = MtThread{std::bind(&OalLtSoundSys::sound_worker, this)};
 }
 
@@ -14,6 +14,7 @@
 #include "iltsound.h"
 
 #include "ltjs_audio_utils.h"
+#include "ltjs_oal_lt_sound_sys_decoder_pool.h"
 #include "ltjs_oal_lt_sound_sys_generic_stream.h"
 #include "ltjs_oal_lt_sound_sys_streaming_source.h"
 #include "ltjs_oal_lt_filter.h"
@@ -462,6 +463,10 @@ public:
 
 
 private:
+	// Worker threads decoding streams ahead of the sound thread.
+	static constexpr auto decoder_pool_thread_count = 2;
+
+
 	using String = std::string;
 	using ExtensionsStrings = std::vector<String>;
 
@@ -490,6 +495,8 @@ private:
 
 	ClockTs clock_base_;
 
+	OalLtSoundSysDecoderPool decoder_pool_;
+
 	Sources samples_;
 	MtMutex mt_samples_mutex_;
 	OpenSources mt_open_samples_;
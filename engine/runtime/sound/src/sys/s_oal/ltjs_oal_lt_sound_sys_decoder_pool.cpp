@@ -0,0 +1,191 @@
+#include "ltjs_oal_lt_sound_sys_decoder_pool.h"
+
+#include <algorithm>
+#include <functional>
+
+
+namespace ltjs
+{
+
+
+OalLtSoundSysDecoderPool::OalLtSoundSysDecoderPool()
+	:
+	mt_mutex_{},
+	mt_work_cv_{},
+	mt_done_cv_{},
+	mt_is_stop_{},
+	mt_threads_{},
+	mt_queue_{},
+	mt_busy_sources_{},
+	mt_busy_reposts_{}
+{
+}
+
+OalLtSoundSysDecoderPool::~OalLtSoundSysDecoderPool()
+{
+	stop();
+}
+
+void OalLtSoundSysDecoderPool::start(
+	const int thread_count)
+{
+	stop();
+
+	if (thread_count <= 0)
+	{
+		return;
+	}
+
+	mt_busy_sources_.assign(thread_count, nullptr);
+	mt_busy_reposts_.assign(thread_count, false);
+	mt_threads_.reserve(thread_count);
+
+	for (auto i = 0; i < thread_count; ++i)
+	{
+		mt_threads_.emplace_back(std::bind(&OalLtSoundSysDecoderPool::worker, this, i));
+	}
+}
+
+void OalLtSoundSysDecoderPool::stop()
+{
+	{
+		MtUniqueLock lock{mt_mutex_};
+
+		mt_is_stop_ = true;
+	}
+
+	mt_work_cv_.notify_all();
+
+	for (auto& thread : mt_threads_)
+	{
+		if (thread.joinable())
+		{
+			thread.join();
+		}
+	}
+
+	mt_threads_.clear();
+	mt_queue_.clear();
+	mt_busy_sources_.clear();
+	mt_busy_reposts_.clear();
+
+	mt_is_stop_ = false;
+}
+
+void OalLtSoundSysDecoderPool::post(
+	OalLtSoundSysDecoderPoolSource* source_ptr)
+{
+	if (source_ptr == nullptr)
+	{
+		return;
+	}
+
+	{
+		MtUniqueLock lock{mt_mutex_};
+
+		if (mt_threads_.empty() || is_queued(source_ptr))
+		{
+			return;
+		}
+
+		const auto busy_index = find_busy(source_ptr);
+
+		if (busy_index >= 0)
+		{
+			// The worker may already be past the point where it would see
+			// what was read since, so it queues the source again when done.
+			mt_busy_reposts_[busy_index] = true;
+			return;
+		}
+
+		mt_queue_.emplace_back(source_ptr);
+	}
+
+	mt_work_cv_.notify_one();
+}
+
+void OalLtSoundSysDecoderPool::cancel(
+	OalLtSoundSysDecoderPoolSource* source_ptr)
+{
+	if (source_ptr == nullptr)
+	{
+		return;
+	}
+
+	MtUniqueLock lock{mt_mutex_};
+
+	mt_queue_.erase(std::remove(mt_queue_.begin(), mt_queue_.end(), source_ptr), mt_queue_.end());
+
+	const auto busy_index = find_busy(source_ptr);
+
+	if (busy_index < 0)
+	{
+		return;
+	}
+
+	// Don't let the worker queue it again.
+	mt_busy_reposts_[busy_index] = false;
+
+	mt_done_cv_.wait(lock, [&](){ return mt_busy_sources_[busy_index] != source_ptr; });
+}
+
+bool OalLtSoundSysDecoderPool::is_queued(
+	const OalLtSoundSysDecoderPoolSource* source_ptr) const
+{
+	return std::find(mt_queue_.cbegin(), mt_queue_.cend(), source_ptr) != mt_queue_.cend();
+}
+
+int OalLtSoundSysDecoderPool::find_busy(
+	const OalLtSoundSysDecoderPoolSource* source_ptr) const
+{
+	const auto busy_it = std::find(mt_busy_sources_.cbegin(), mt_busy_sources_.cend(), source_ptr);
+
+	if (busy_it == mt_busy_sources_.cend())
+	{
+		return -1;
+	}
+
+	return static_cast<int>(busy_it - mt_busy_sources_.cbegin());
+}
+
+void OalLtSoundSysDecoderPool::worker(
+	const int index)
+{
+	MtUniqueLock lock{mt_mutex_};
+
+	while (true)
+	{
+		mt_work_cv_.wait(lock, [&](){ return mt_is_stop_ || !mt_queue_.empty(); });
+
+		if (mt_is_stop_)
+		{
+			break;
+		}
+
+		auto source_ptr = mt_queue_.front();
+		mt_queue_.pop_front();
+
+		mt_busy_sources_[index] = source_ptr;
+
+		lock.unlock();
+
+		source_ptr->decode_ahead();
+
+		lock.lock();
+
+		mt_busy_sources_[index] = nullptr;
+
+		if (mt_busy_reposts_[index])
+		{
+			mt_busy_reposts_[index] = false;
+
+			// Picked up by this worker or another on the next pass.
+			mt_queue_.emplace_back(source_ptr);
+		}
+
+		mt_done_cv_.notify_all();
+	}
+}
+
+
+} // ltjs
@@ -0,0 +1,122 @@
+#ifndef LTJS_OAL_LT_SOUND_SYS_DECODER_POOL_INCLUDED
+#define LTJS_OAL_LT_SOUND_SYS_DECODER_POOL_INCLUDED
+
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace ltjs
+{
+
+
+//
+// Something the decoder pool decodes ahead; a streaming source.
+//
+class OalLtSoundSysDecoderPoolSource
+{
+public:
+	virtual ~OalLtSoundSysDecoderPoolSource() = default;
+
+
+	//
+	// Decodes until the source's decode-ahead buffer is full or its data ends.
+	//
+	// Called on one of the pool's threads.
+	//
+	virtual void decode_ahead() = 0;
+}; // OalLtSoundSysDecoderPoolSource
+
+
+//
+// Worker threads that decode streaming sources ahead of the sound thread.
+//
+// A posted source gets its "decode_ahead" called on one of the workers, and
+// never on more than one at a time.
+//
+class OalLtSoundSysDecoderPool final
+{
+public:
+	OalLtSoundSysDecoderPool();
+
+	OalLtSoundSysDecoderPool(
+		const OalLtSoundSysDecoderPool& that) = delete;
+
+	OalLtSoundSysDecoderPool& operator=(
+		const OalLtSoundSysDecoderPool& that) = delete;
+
+	~OalLtSoundSysDecoderPool();
+
+
+	void start(
+		const int thread_count);
+
+	void stop();
+
+	//
+	// Queues a source for decoding.
+	//
+	// Does nothing if the source is already queued.  If a worker is decoding
+	// it, it's queued again once the worker is done, so whatever was read
+	// from it in the meantime gets topped up.
+	//
+	void post(
+		OalLtSoundSysDecoderPoolSource* source_ptr);
+
+	//
+	// Takes a source out of the queue, and waits for a worker to finish
+	// decoding it.
+	//
+	// After that the caller has the source's decoder to itself until the next
+	// "post".
+	//
+	void cancel(
+		OalLtSoundSysDecoderPoolSource* source_ptr);
+
+
+private:
+	using MtThread = std::thread;
+	using MtMutex = std::mutex;
+	using MtUniqueLock = std::unique_lock<MtMutex>;
+	using MtCondVar = std::condition_variable;
+
+	using MtThreads = std::vector<MtThread>;
+	using Sources = std::deque<OalLtSoundSysDecoderPoolSource*>;
+	using BusySources = std::vector<OalLtSoundSysDecoderPoolSource*>;
+	using BusyReposts = std::vector<bool>;
+
+
+	MtMutex mt_mutex_;
+	MtCondVar mt_work_cv_;
+	MtCondVar mt_done_cv_;
+
+	bool mt_is_stop_;
+	MtThreads mt_threads_;
+	Sources mt_queue_;
+
+	// The source each worker is decoding, if any.
+	BusySources mt_busy_sources_;
+
+	// Whether each worker's source was posted again while being decoded.
+	BusyReposts mt_busy_reposts_;
+
+
+	bool is_queued(
+		const OalLtSoundSysDecoderPoolSource* source_ptr) const;
+
+	// Returns the index of the worker decoding the source, or -1.
+	int find_busy(
+		const OalLtSoundSysDecoderPoolSource* source_ptr) const;
+
+	void worker(
+		const int index);
+}; // OalLtSoundSysDecoderPool
+
+
+} // ltjs
+
+
+#endif // !LTJS_OAL_LT_SOUND_SYS_DECODER_POOL_INCLUDED
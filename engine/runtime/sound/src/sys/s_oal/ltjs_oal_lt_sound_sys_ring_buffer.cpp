@@ -0,0 +1,127 @@
+#include "ltjs_oal_lt_sound_sys_ring_buffer.h"
+
+#include <algorithm>
+
+
+namespace ltjs
+{
+
+
+OalLtSoundSysRingBuffer::OalLtSoundSysRingBuffer()
+	:
+	data_{},
+	capacity_{},
+	read_position_{},
+	write_position_{},
+	is_ended_{}
+{
+}
+
+void OalLtSoundSysRingBuffer::resize(
+	const int capacity)
+{
+	capacity_ = std::max(capacity, 0);
+	data_.resize(capacity_);
+
+	reset();
+}
+
+void OalLtSoundSysRingBuffer::reset() noexcept
+{
+	read_position_.store(0, std::memory_order_relaxed);
+	write_position_.store(0, std::memory_order_relaxed);
+	is_ended_.store(false, std::memory_order_relaxed);
+}
+
+int OalLtSoundSysRingBuffer::get_capacity() const noexcept
+{
+	return capacity_;
+}
+
+int OalLtSoundSysRingBuffer::get_read_size() const noexcept
+{
+	const auto write_position = write_position_.load(std::memory_order_acquire);
+	const auto read_position = read_position_.load(std::memory_order_relaxed);
+
+	return static_cast<int>(write_position - read_position);
+}
+
+int OalLtSoundSysRingBuffer::read(
+	void* buffer,
+	const int size) noexcept
+{
+	if (capacity_ == 0 || size <= 0)
+	{
+		return 0;
+	}
+
+	const auto write_position = write_position_.load(std::memory_order_acquire);
+	const auto read_position = read_position_.load(std::memory_order_relaxed);
+
+	const auto read_size = std::min(size, static_cast<int>(write_position - read_position));
+
+	if (read_size == 0)
+	{
+		return 0;
+	}
+
+	const auto read_index = static_cast<int>(read_position % capacity_);
+	const auto first_size = std::min(read_size, capacity_ - read_index);
+
+	auto dst_bytes = static_cast<std::uint8_t*>(buffer);
+
+	std::copy_n(data_.cbegin() + read_index, first_size, dst_bytes);
+	std::copy_n(data_.cbegin(), read_size - first_size, dst_bytes + first_size);
+
+	read_position_.store(read_position + read_size, std::memory_order_release);
+
+	return read_size;
+}
+
+bool OalLtSoundSysRingBuffer::is_ended() const noexcept
+{
+	return is_ended_.load(std::memory_order_acquire);
+}
+
+std::uint8_t* OalLtSoundSysRingBuffer::begin_write(
+	int& size) noexcept
+{
+	size = 0;
+
+	if (capacity_ == 0)
+	{
+		return nullptr;
+	}
+
+	const auto read_position = read_position_.load(std::memory_order_acquire);
+	const auto write_position = write_position_.load(std::memory_order_relaxed);
+
+	const auto free_size = capacity_ - static_cast<int>(write_position - read_position);
+	const auto write_index = static_cast<int>(write_position % capacity_);
+
+	size = std::min(free_size, capacity_ - write_index);
+
+	return &data_[write_index];
+}
+
+void OalLtSoundSysRingBuffer::end_write(
+	const int size) noexcept
+{
+	if (size <= 0)
+	{
+		return;
+	}
+
+	const auto write_position = write_position_.load(std::memory_order_relaxed);
+
+	write_position_.store(write_position + size, std::memory_order_release);
+}
+
+void OalLtSoundSysRingBuffer::set_ended(
+	const bool is_ended) noexcept
+{
+	is_ended_.store(is_ended, std::memory_order_release);
+}
+
+
+} // ltjs
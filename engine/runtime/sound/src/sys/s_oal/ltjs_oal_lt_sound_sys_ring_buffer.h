@@ -0,0 +1,113 @@
+#ifndef LTJS_OAL_LT_SOUND_SYS_RING_BUFFER_INCLUDED
+#define LTJS_OAL_LT_SOUND_SYS_RING_BUFFER_INCLUDED
+
+
+#include <cstdint>
+
+#include <atomic>
+#include <vector>
+
+
+namespace ltjs
+{
+
+
+//
+// A byte ring buffer for one producer thread and one consumer thread.
+//
+// Neither side blocks or locks; the read and write positions are published
+// with release/acquire ordering, so the consumer sees every byte the producer
+// wrote before advancing the write position.
+//
+// Resizing and resetting are not thread-safe; neither side may be using the
+// buffer at the time.
+//
+class OalLtSoundSysRingBuffer final
+{
+public:
+	OalLtSoundSysRingBuffer();
+
+	OalLtSoundSysRingBuffer(
+		const OalLtSoundSysRingBuffer& that) = delete;
+
+	OalLtSoundSysRingBuffer& operator=(
+		const OalLtSoundSysRingBuffer& that) = delete;
+
+
+	void resize(
+		const int capacity);
+
+	void reset() noexcept;
+
+	int get_capacity() const noexcept;
+
+
+	// -------------------------------------------------------------------------
+	// Consumer
+
+	int get_read_size() const noexcept;
+
+	//
+	// Reads up to "size" bytes.
+	//
+	// Returns:
+	//    - The number of bytes read.
+	//
+	int read(
+		void* buffer,
+		const int size) noexcept;
+
+	//
+	// Gets a flag whether the producer has nothing more to write.
+	//
+	// Check it before the read size; once it's set, the read size is final.
+	//
+	bool is_ended() const noexcept;
+
+	// Consumer
+	// -------------------------------------------------------------------------
+
+
+	// -------------------------------------------------------------------------
+	// Producer
+
+	//
+	// Gets the free space that follows the write position without wrapping.
+	//
+	// Returns:
+	//    - A pointer to write to, and its size in "size".
+	//
+	std::uint8_t* begin_write(
+		int& size) noexcept;
+
+	//
+	// Publishes "size" bytes written to the pointer from "begin_write".
+	//
+	void end_write(
+		const int size) noexcept;
+
+	void set_ended(
+		const bool is_ended) noexcept;
+
+	// Producer
+	// -------------------------------------------------------------------------
+
+
+private:
+	using Data = std::vector<std::uint8_t>;
+	using Position = std::atomic<std::uint64_t>;
+
+
+	Data data_;
+	int capacity_;
+
+	Position read_position_;
+	Position write_position_;
+	std::atomic<bool> is_ended_;
+}; // OalLtSoundSysRingBuffer
+
+
+} // ltjs
+
+
+#endif // !LTJS_OAL_LT_SOUND_SYS_RING_BUFFER_INCLUDED
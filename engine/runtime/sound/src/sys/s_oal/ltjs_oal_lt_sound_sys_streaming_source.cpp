@@ -59,6 +59,10 @@ OalLtSoundSysStreamingSource::OalLtSoundSysStreamingSource(
 	file_stream_{},
 	file_substream_{},
 	decoder_{},
+	decoder_pool_{},
+	decode_ring_{},
+	decode_offset_{},
+	decode_data_size_{},
 	mix_mono_buffer_{},
 	mix_stereo_buffer_{},
 	master_3d_listener_volume_{},
@@ -142,6 +146,10 @@ OalLtSoundSysStreamingSource::OalLtSoundSysStreamingSource(
 	file_stream_{std::move(that.file_stream_)},
 	file_substream_{std::move(that.file_substream_)},
 	decoder_{std::move(that.decoder_)},
+	decoder_pool_{std::move(that.decoder_pool_)},
+	decode_ring_{std::move(that.decode_ring_)},
+	decode_offset_{std::move(that.decode_offset_)},
+	decode_data_size_{std::move(that.decode_data_size_)},
 	mix_mono_buffer_{std::move(that.mix_mono_buffer_)},
 	mix_stereo_buffer_{std::move(that.mix_stereo_buffer_)},
 	master_3d_listener_volume_{std::move(that.master_3d_listener_volume_)},
@@ -279,6 +287,8 @@ void OalLtSoundSysStreamingSource::stop()
 	{
 		data_offset_ = loop_begin_;
 	}
+
+	decode_ahead_restart();
 }
 
 int32 OalLtSoundSysStreamingSource::get_volume() const
@@ -351,6 +361,8 @@ void OalLtSoundSysStreamingSource::set_loop_block(
 		return;
 	}
 
+	decode_ahead_cancel();
+
 	const auto data_size = static_cast<int>(data_.size());
 	const auto sample_size = block_align_;
 
@@ -382,6 +394,8 @@ void OalLtSoundSysStreamingSource::set_loop_block(
 	{
 		has_loop_block_ = false;
 	}
+
+	decode_ahead_continue();
 }
 
 void OalLtSoundSysStreamingSource::set_loop(
@@ -392,7 +406,11 @@ void OalLtSoundSysStreamingSource::set_loop(
 		return;
 	}
 
+	decode_ahead_cancel();
+
 	is_looping_ = is_enable;
+
+	decode_ahead_continue();
 }
 
 void OalLtSoundSysStreamingSource::set_ms_position(
@@ -406,20 +424,23 @@ void OalLtSoundSysStreamingSource::set_ms_position(
 	if (milliseconds <= 0)
 	{
 		data_offset_ = 0;
-		return;
-	}
-
-	const auto sample_offset = static_cast<int>((sample_rate_ * milliseconds) / 1000LL);
-	const auto data_offset = sample_offset * block_align_;
-
-	if (data_offset <= data_size_)
-	{
-		data_offset_ = data_offset;
 	}
 	else
 	{
-		data_offset_ = 0;
+		const auto sample_offset = static_cast<int>((sample_rate_ * milliseconds) / 1000LL);
+		const auto data_offset = sample_offset * block_align_;
+
+		if (data_offset <= data_size_)
+		{
+			data_offset_ = data_offset;
+		}
+		else
+		{
+			data_offset_ = 0;
+		}
 	}
+
+	decode_ahead_restart();
 }
 
 void OalLtSoundSysStreamingSource::mix()
@@ -463,7 +484,7 @@ void OalLtSoundSysStreamingSource::mix()
 		assert(oal_queued_count_ >= 0);
 	}
 
-	if (!is_looping_ && data_offset_ == data_size_)
+	if (is_data_ended())
 	{
 		if (oal_queued_count_ == 0)
 		{
@@ -1034,6 +1055,8 @@ void OalLtSoundSysStreamingSource::destroy()
 		LTJS_OAL_ENSURE_CALL_DEBUG(::alDeleteBuffers(oal_max_buffer_count, oal_buffers_.data()));
 	}
 
+	decode_ahead_cancel();
+
 	decoder_.close();
 	file_substream_.close();
 	file_stream_.close();
@@ -1093,6 +1116,10 @@ void OalLtSoundSysStreamingSource::fail()
 
 void OalLtSoundSysStreamingSource::reset()
 {
+	decode_ahead_cancel();
+
+	decoder_pool_ = nullptr;
+
 	decoder_.close();
 	file_substream_.close();
 	file_stream_.close();
@@ -1230,6 +1257,7 @@ bool OalLtSoundSysStreamingSource::open_file_internal(
 	storage_type_ = OalLtSoundSysStreamingSourceStorageType::decoder;
 	data_.clear();
 	data_size_ = decoder_.get_data_size();
+	decoder_pool_ = param.decoder_pool_;
 
 	open_set_wave_format_internal(decoder_.get_wave_format_ex());
 
@@ -1407,16 +1435,196 @@ bool OalLtSoundSysStreamingSource::open_internal(
 		return false;
 	}
 
+	if (!open_decode_ahead_internal())
+	{
+		return false;
+	}
+
 	return true;
 }
 
+bool OalLtSoundSysStreamingSource::open_decode_ahead_internal()
+{
+	if (decoder_pool_ == nullptr ||
+		storage_type_ != OalLtSoundSysStreamingSourceStorageType::decoder)
+	{
+		return true;
+	}
+
+	if (decode_ring_ == nullptr)
+	{
+		decode_ring_ = std::make_unique<OalLtSoundSysRingBuffer>();
+	}
+
+	decode_ring_->resize(mix_size_ * decode_ahead_mix_count);
+
+	// Start decoding now, so there's something to play by the time the
+	// stream is started.
+	decode_ahead_restart();
+
+	return !is_failed();
+}
+
 void OalLtSoundSysStreamingSource::close_internal()
 {
+	decode_ahead_cancel();
+
 	decoder_.close();
 	file_substream_.close();
 	file_stream_.close();
 }
 
+bool OalLtSoundSysStreamingSource::is_decoding_ahead() const
+{
+	return
+		decoder_pool_ != nullptr &&
+		decode_ring_ != nullptr &&
+		storage_type_ == OalLtSoundSysStreamingSourceStorageType::decoder;
+}
+
+void OalLtSoundSysStreamingSource::decode_ahead_cancel()
+{
+	if (decoder_pool_ == nullptr)
+	{
+		return;
+	}
+
+	decoder_pool_->cancel(this);
+}
+
+void OalLtSoundSysStreamingSource::decode_ahead_continue()
+{
+	if (!is_decoding_ahead())
+	{
+		return;
+	}
+
+	// The data may have ended only because the source wasn't looping.
+	if (is_looping_)
+	{
+		decode_ring_->set_ended(false);
+	}
+
+	decoder_pool_->post(this);
+}
+
+void OalLtSoundSysStreamingSource::decode_ahead_restart()
+{
+	if (!is_decoding_ahead())
+	{
+		return;
+	}
+
+	decoder_pool_->cancel(this);
+
+	decode_ring_->reset();
+	decode_offset_ = data_offset_;
+	decode_data_size_ = data_size_;
+
+	if (block_align_ <= 0 || !decoder_.set_position(data_offset_ / block_align_))
+	{
+		fail();
+		return;
+	}
+
+	decoder_pool_->post(this);
+}
+
+void OalLtSoundSysStreamingSource::decode_ahead()
+{
+	auto& ring = *decode_ring_;
+
+	const auto is_looping = is_looping_;
+
+	const auto data_begin_offset = static_cast<int>(
+		is_looping && has_loop_block_ ? loop_begin_ : 0);
+
+	auto data_end_offset = static_cast<int>(
+		is_looping && has_loop_block_ ? loop_end_ : decode_data_size_);
+
+	// Guards against looping forever over data that decodes to nothing.
+	auto is_wrapped_without_data = false;
+
+	while (!ring.is_ended())
+	{
+		const auto data_remain_size = data_end_offset - decode_offset_;
+
+		if (data_remain_size <= 0)
+		{
+			if (!is_looping || is_wrapped_without_data)
+			{
+				ring.set_ended(true);
+				break;
+			}
+
+			if (!decoder_.set_position(data_begin_offset / block_align_))
+			{
+				ring.set_ended(true);
+				break;
+			}
+
+			decode_offset_ = data_begin_offset;
+			is_wrapped_without_data = true;
+
+			continue;
+		}
+
+		auto write_size = 0;
+		const auto write_ptr = ring.begin_write(write_size);
+
+		// Keep whole frames together, so the ring wraps on a frame boundary.
+		write_size = std::min(write_size, data_remain_size);
+		write_size -= write_size % block_align_;
+
+		if (write_size <= 0)
+		{
+			// Full.
+			break;
+		}
+
+		const auto decoded_size = decoder_.decode(write_ptr, write_size);
+
+		if (decoded_size > 0)
+		{
+			ring.end_write(decoded_size);
+			decode_offset_ += decoded_size;
+			is_wrapped_without_data = false;
+
+			continue;
+		}
+
+		if (decoded_size < 0)
+		{
+			ring.set_ended(true);
+			break;
+		}
+
+		// The data is shorter than the header said.
+		//
+		decode_data_size_ = decode_offset_;
+
+		if (!(is_looping && has_loop_block_))
+		{
+			data_end_offset = decode_data_size_;
+		}
+		else
+		{
+			ring.set_ended(true);
+			break;
+		}
+	}
+}
+
+bool OalLtSoundSysStreamingSource::is_data_ended() const
+{
+	if (is_decoding_ahead())
+	{
+		return decode_ring_->is_ended() && decode_ring_->get_read_size() == 0;
+	}
+
+	return !is_looping_ && data_offset_ == data_size_;
+}
+
 template<
 	int TBitDepth
 >
@@ -1458,7 +1666,7 @@ void OalLtSoundSysStreamingSource::mix_mono_to_stereo(
 	}
 }
 
-int OalLtSoundSysStreamingSource::mix_fill_buffer()
+int OalLtSoundSysStreamingSource::mix_fill_from_data()
 {
 	const auto is_looping = is_looping_;
 
@@ -1556,6 +1764,37 @@ int OalLtSoundSysStreamingSource::mix_fill_buffer()
 		}
 	}
 
+	return mix_offset;
+}
+
+int OalLtSoundSysStreamingSource::mix_fill_from_decode_ring()
+{
+	auto& ring = *decode_ring_;
+
+	// Check for the end first; once it's set, the read size is final.
+	const auto is_ended = ring.is_ended();
+	const auto read_size = ring.get_read_size();
+
+	if (!is_ended)
+	{
+		// Top the ring up for the next time.
+		decoder_pool_->post(this);
+
+		// The pool has fallen behind.  Wait for a whole buffer rather than
+		// queue a short one.
+		if (read_size < mix_size_)
+		{
+			return 0;
+		}
+	}
+
+	return ring.read(mix_mono_buffer_.data(), mix_size_);
+}
+
+int OalLtSoundSysStreamingSource::mix_fill_buffer()
+{
+	const auto mix_offset = is_decoding_ahead() ? mix_fill_from_decode_ring() : mix_fill_from_data();
+
 	if (!is_spatial() && is_mono())
 	{
 		switch (get_bit_depth())
@@ -3,6 +3,7 @@
 
 
 #include <array>
+#include <memory>
 #include <vector>
 
 #include "al.h"
@@ -13,7 +14,9 @@
 #include "iltsound.h"
 
 #include "ltjs_audio_decoder.h"
+#include "ltjs_oal_lt_sound_sys_decoder_pool.h"
 #include "ltjs_oal_lt_sound_sys_orientation_3d.h"
+#include "ltjs_oal_lt_sound_sys_ring_buffer.h"
 #include "ltjs_oal_lt_sound_user_data.h"
 #include "ltjs_oal_lt_sound_sys_vector_3d.h"
 
@@ -59,6 +62,7 @@ struct OalLtSoundSysStreamingSourceOpenParam
 	bool is_file_;
 	const char* file_name_;
 	uint32 file_offset_;
+	OalLtSoundSysDecoderPool* decoder_pool_;
 
 	bool is_mapped_file_;
 	const void* mapped_storage_ptr;
@@ -73,7 +77,8 @@ struct OalLtSoundSysStreamingSourceOpenParam
 }; // OpenParam
 
 
-class OalLtSoundSysStreamingSource
+class OalLtSoundSysStreamingSource :
+	public OalLtSoundSysDecoderPoolSource
 {
 public:
 	static constexpr auto mix_size_ms = 20;
@@ -83,6 +88,9 @@ public:
 	static constexpr auto oal_max_buffer_count = 3;
 	static constexpr auto oal_max_pans = 2;
 
+	// How many mix buffers a decoder pool keeps decoded ahead of playback.
+	static constexpr auto decode_ahead_mix_count = 16;
+
 	using Data = std::vector<std::uint8_t>;
 	using OalPans = std::array<float, oal_max_pans>;
 	using OalBuffers = std::array<::ALuint, oal_max_buffer_count>;
@@ -217,6 +225,13 @@ public:
 
 	const OalLtSoundSysOrientation3d& get_3d_orientation() const;
 
+	//
+	// Decodes into the decode-ahead buffer until it's full or the data ends.
+	//
+	// Called by the decoder pool, on one of its threads.
+	//
+	void decode_ahead() override;
+
 
 private:
 	static constexpr auto pan_center = 64;
@@ -258,6 +273,9 @@ private:
 	struct MonoToStereoSample<16, TDummy>;
 
 
+	using DecodeRingUPtr = std::unique_ptr<OalLtSoundSysRingBuffer>;
+
+
 	OalLtSoundSysStreamingSourceType type_;
 	OalLtSoundSysStreamingSourceSpatialType spatial_type_;
 	OalLtSoundSysStreamingSourceStorageType storage_type_;
@@ -286,6 +304,18 @@ private:
 	ul::FileStream file_stream_;
 	ul::Substream file_substream_;
 	AudioDecoder decoder_;
+
+	// Decoding ahead.
+	//
+	// The pool decodes into the ring while the sound thread reads from it.
+	// While the source is posted, the pool owns the decoder and the decode
+	// offset and size, and reads the looping fields; anything that changes
+	// them cancels first.
+	OalLtSoundSysDecoderPool* decoder_pool_;
+	DecodeRingUPtr decode_ring_;
+	int decode_offset_;
+	int decode_data_size_;
+
 	MixBuffer mix_mono_buffer_;
 	MixBuffer mix_stereo_buffer_;
 
@@ -356,14 +386,32 @@ private:
 	bool open_internal(
 		const OalLtSoundSysStreamingSourceOpenParam& param);
 
+	bool open_decode_ahead_internal();
+
 	void close_internal();
 
+	bool is_decoding_ahead() const;
+
+	void decode_ahead_cancel();
+
+	// Lets the pool carry on after the looping fields changed.
+	void decode_ahead_continue();
+
+	// Throws away what's been decoded and starts again from the data offset.
+	void decode_ahead_restart();
+
+	bool is_data_ended() const;
+
 	template<
 		int TBitDepth
 	>
 	void mix_mono_to_stereo(
 		const int byte_offset);
 
+	int mix_fill_from_data();
+
+	int mix_fill_from_decode_ring();
+
 	int mix_fill_buffer();
 }; // OalLtSoundSysStreamingSource
 
@@ -0,0 +1,281 @@
+#include "ltjs_oal_lt_sound_sys_decoder_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+using ltjs::OalLtSoundSysDecoderPool;
+using ltjs::OalLtSoundSysDecoderPoolSource;
+
+using namespace std::chrono_literals;
+
+constexpr auto wait_timeout = 5s;
+
+// A source whose decodes can be held up until the test lets them finish.
+class FakeSource final : public OalLtSoundSysDecoderPoolSource
+{
+public:
+	void decode_ahead() override
+	{
+		std::unique_lock<std::mutex> lock{mutex_};
+
+		++started_count_;
+		++active_count_;
+		max_active_count_ = std::max(max_active_count_, active_count_);
+		cv_.notify_all();
+
+		cv_.wait(lock, [&](){ return !is_holding_; });
+
+		--active_count_;
+		++decoded_count_;
+		cv_.notify_all();
+	}
+
+	void hold()
+	{
+		std::unique_lock<std::mutex> lock{mutex_};
+		is_holding_ = true;
+	}
+
+	void release()
+	{
+		{
+			std::unique_lock<std::mutex> lock{mutex_};
+			is_holding_ = false;
+		}
+
+		cv_.notify_all();
+	}
+
+	bool wait_started(int count)
+	{
+		std::unique_lock<std::mutex> lock{mutex_};
+		return cv_.wait_for(lock, wait_timeout, [&](){ return started_count_ >= count; });
+	}
+
+	bool wait_decoded(int count)
+	{
+		std::unique_lock<std::mutex> lock{mutex_};
+		return cv_.wait_for(lock, wait_timeout, [&](){ return decoded_count_ >= count; });
+	}
+
+	int get_decoded_count()
+	{
+		std::unique_lock<std::mutex> lock{mutex_};
+		return decoded_count_;
+	}
+
+	int get_max_active_count()
+	{
+		std::unique_lock<std::mutex> lock{mutex_};
+		return max_active_count_;
+	}
+
+
+private:
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	bool is_holding_{};
+	int started_count_{};
+	int active_count_{};
+	int max_active_count_{};
+	int decoded_count_{};
+};
+
+// Long enough for a worker to have picked up anything it was going to.
+void settle()
+{
+	std::this_thread::sleep_for(50ms);
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Posting
+// -----------------------------------------------------------------------------
+
+TEST(OalLtSoundSysDecoderPool, Post_DecodesOnAWorker)
+{
+	auto pool = OalLtSoundSysDecoderPool{};
+	pool.start(2);
+
+	auto source = FakeSource{};
+	pool.post(&source);
+
+	EXPECT_TRUE(source.wait_decoded(1));
+}
+
+TEST(OalLtSoundSysDecoderPool, Post_NothingWithoutWorkers)
+{
+	auto pool = OalLtSoundSysDecoderPool{};
+
+	auto source = FakeSource{};
+	pool.post(&source);
+	settle();
+
+	EXPECT_EQ(source.get_decoded_count(), 0);
+}
+
+TEST(OalLtSoundSysDecoderPool, Post_WhileQueuedIsIgnored)
+{
+	auto pool = OalLtSoundSysDecoderPool{};
+	pool.start(1);
+
+	// Keep the only worker busy so the next source stays queued.
+	auto busy_source = FakeSource{};
+	busy_source.hold();
+	pool.post(&busy_source);
+	ASSERT_TRUE(busy_source.wait_started(1));
+
+	auto source = FakeSource{};
+	pool.post(&source);
+	pool.post(&source);
+	pool.post(&source);
+
+	busy_source.release();
+
+	EXPECT_TRUE(source.wait_decoded(1));
+	settle();
+	EXPECT_EQ(source.get_decoded_count(), 1);
+}
+
+TEST(OalLtSoundSysDecoderPool, Post_WhileBusyDecodesAgainAfterwards)
+{
+	auto pool = OalLtSoundSysDecoderPool{};
+	pool.start(2);
+
+	auto source = FakeSource{};
+	source.hold();
+	pool.post(&source);
+	ASSERT_TRUE(source.wait_started(1));
+
+	// The idle worker must not pick it up while the other one has it.
+	pool.post(&source);
+	pool.post(&source);
+	settle();
+	EXPECT_EQ(source.get_decoded_count(), 0);
+
+	source.release();
+
+	// Once more for all the posts made while it was busy.
+	EXPECT_TRUE(source.wait_decoded(2));
+	settle();
+	EXPECT_EQ(source.get_decoded_count(), 2);
+	EXPECT_EQ(source.get_max_active_count(), 1);
+}
+
+// -----------------------------------------------------------------------------
+// Cancelling
+// -----------------------------------------------------------------------------
+
+TEST(OalLtSoundSysDecoderPool, Cancel_TakesAQueuedSourceOut)
+{
+	auto pool = OalLtSoundSysDecoderPool{};
+	pool.start(1);
+
+	auto busy_source = FakeSource{};
+	busy_source.hold();
+	pool.post(&busy_source);
+	ASSERT_TRUE(busy_source.wait_started(1));
+
+	auto source = FakeSource{};
+	pool.post(&source);
+
+	// Not being decoded, so this doesn't wait.
+	pool.cancel(&source);
+
+	busy_source.release();
+	ASSERT_TRUE(busy_source.wait_decoded(1));
+	settle();
+
+	EXPECT_EQ(source.get_decoded_count(), 0);
+}
+
+TEST(OalLtSoundSysDecoderPool, Cancel_WaitsForTheBusyDecode)
+{
+	auto pool = OalLtSoundSysDecoderPool{};
+	pool.start(2);
+
+	auto source = FakeSource{};
+	source.hold();
+	pool.post(&source);
+	ASSERT_TRUE(source.wait_started(1));
+
+	auto cancelled = std::async(std::launch::async, [&](){ pool.cancel(&source); });
+	EXPECT_EQ(cancelled.wait_for(50ms), std::future_status::timeout);
+
+	source.release();
+
+	ASSERT_EQ(cancelled.wait_for(wait_timeout), std::future_status::ready);
+	EXPECT_EQ(source.get_decoded_count(), 1);
+}
+
+TEST(OalLtSoundSysDecoderPool, Cancel_DropsAPostMadeWhileBusy)
+{
+	auto pool = OalLtSoundSysDecoderPool{};
+	pool.start(2);
+
+	auto source = FakeSource{};
+	source.hold();
+	pool.post(&source);
+	ASSERT_TRUE(source.wait_started(1));
+
+	pool.post(&source);
+
+	auto cancelled = std::async(std::launch::async, [&](){ pool.cancel(&source); });
+	EXPECT_EQ(cancelled.wait_for(50ms), std::future_status::timeout);
+
+	source.release();
+
+	ASSERT_EQ(cancelled.wait_for(wait_timeout), std::future_status::ready);
+	settle();
+
+	// The caller has the source to itself now.
+	EXPECT_EQ(source.get_decoded_count(), 1);
+}
+
+TEST(OalLtSoundSysDecoderPool, Cancel_UnknownSourceReturnsAtOnce)
+{
+	auto pool = OalLtSoundSysDecoderPool{};
+	pool.start(2);
+
+	auto source = FakeSource{};
+	pool.cancel(&source);
+	pool.cancel(nullptr);
+
+	EXPECT_EQ(source.get_decoded_count(), 0);
+}
+
+// -----------------------------------------------------------------------------
+// Stopping
+// -----------------------------------------------------------------------------
+
+TEST(OalLtSoundSysDecoderPool, Stop_DropsTheQueue)
+{
+	auto pool = OalLtSoundSysDecoderPool{};
+	pool.start(1);
+
+	auto busy_source = FakeSource{};
+	busy_source.hold();
+	pool.post(&busy_source);
+	ASSERT_TRUE(busy_source.wait_started(1));
+
+	auto source = FakeSource{};
+	pool.post(&source);
+
+	// Stop waits for the busy decode.
+	auto stopped = std::async(std::launch::async, [&](){ pool.stop(); });
+	EXPECT_EQ(stopped.wait_for(50ms), std::future_status::timeout);
+
+	busy_source.release();
+	ASSERT_EQ(stopped.wait_for(wait_timeout), std::future_status::ready);
+
+	EXPECT_EQ(source.get_decoded_count(), 0);
+}
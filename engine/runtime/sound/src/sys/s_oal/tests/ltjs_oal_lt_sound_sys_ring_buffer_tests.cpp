@@ -0,0 +1,322 @@
+#include "ltjs_oal_lt_sound_sys_ring_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using ltjs::OalLtSoundSysRingBuffer;
+
+using Bytes = std::vector<std::uint8_t>;
+
+// Writes as much of "bytes" as fits before the end of the ring.
+int write_some(OalLtSoundSysRingBuffer& ring, const std::uint8_t* bytes, int size)
+{
+	auto write_size = 0;
+	const auto write_ptr = ring.begin_write(write_size);
+
+	write_size = std::min(write_size, size);
+
+	if (write_size > 0)
+	{
+		std::memcpy(write_ptr, bytes, write_size);
+		ring.end_write(write_size);
+	}
+
+	return write_size;
+}
+
+Bytes make_bytes(int size, int first)
+{
+	Bytes bytes(size);
+
+	for (auto i = 0; i < size; ++i)
+	{
+		bytes[i] = static_cast<std::uint8_t>(first + i);
+	}
+
+	return bytes;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Reading and writing
+// -----------------------------------------------------------------------------
+
+TEST(OalLtSoundSysRingBuffer, Empty_NothingToRead)
+{
+	auto ring = OalLtSoundSysRingBuffer{};
+	ring.resize(16);
+
+	std::uint8_t buffer[16];
+
+	EXPECT_EQ(ring.get_capacity(), 16);
+	EXPECT_EQ(ring.get_read_size(), 0);
+	EXPECT_EQ(ring.read(buffer, 16), 0);
+	EXPECT_FALSE(ring.is_ended());
+
+	auto write_size = 0;
+	EXPECT_NE(ring.begin_write(write_size), nullptr);
+	EXPECT_EQ(write_size, 16);
+}
+
+TEST(OalLtSoundSysRingBuffer, NoCapacity_NothingToReadOrWrite)
+{
+	auto ring = OalLtSoundSysRingBuffer{};
+	ring.resize(0);
+
+	std::uint8_t buffer[4];
+
+	auto write_size = -1;
+	EXPECT_EQ(ring.begin_write(write_size), nullptr);
+	EXPECT_EQ(write_size, 0);
+	EXPECT_EQ(ring.read(buffer, 4), 0);
+}
+
+TEST(OalLtSoundSysRingBuffer, ReadsInOrder)
+{
+	auto ring = OalLtSoundSysRingBuffer{};
+	ring.resize(16);
+
+	const auto bytes = make_bytes(10, 1);
+	ASSERT_EQ(write_some(ring, bytes.data(), 10), 10);
+	EXPECT_EQ(ring.get_read_size(), 10);
+
+	std::uint8_t buffer[16];
+
+	ASSERT_EQ(ring.read(buffer, 4), 4);
+	EXPECT_EQ(Bytes(buffer, buffer + 4), Bytes(bytes.begin(), bytes.begin() + 4));
+	EXPECT_EQ(ring.get_read_size(), 6);
+
+	// Asking for more than there is reads what there is.
+	ASSERT_EQ(ring.read(buffer, 16), 6);
+	EXPECT_EQ(Bytes(buffer, buffer + 6), Bytes(bytes.begin() + 4, bytes.end()));
+	EXPECT_EQ(ring.get_read_size(), 0);
+}
+
+TEST(OalLtSoundSysRingBuffer, Full_NoRoomToWrite)
+{
+	auto ring = OalLtSoundSysRingBuffer{};
+	ring.resize(8);
+
+	const auto bytes = make_bytes(8, 0);
+	ASSERT_EQ(write_some(ring, bytes.data(), 8), 8);
+
+	auto write_size = -1;
+	ring.begin_write(write_size);
+	EXPECT_EQ(write_size, 0);
+
+	std::uint8_t buffer[3];
+	ASSERT_EQ(ring.read(buffer, 3), 3);
+
+	// The room freed is at the start, after the wrap.
+	ring.begin_write(write_size);
+	EXPECT_EQ(write_size, 3);
+}
+
+TEST(OalLtSoundSysRingBuffer, Wrap_WriteStopsAtTheEndAndReadCrossesIt)
+{
+	auto ring = OalLtSoundSysRingBuffer{};
+	ring.resize(10);
+
+	std::uint8_t buffer[10];
+
+	const auto first = make_bytes(7, 0);
+	ASSERT_EQ(write_some(ring, first.data(), 7), 7);
+	ASSERT_EQ(ring.read(buffer, 7), 7);
+
+	// Only the space up to the end of the ring in one go.
+	const auto second = make_bytes(8, 100);
+	ASSERT_EQ(write_some(ring, second.data(), 8), 3);
+	ASSERT_EQ(write_some(ring, second.data() + 3, 5), 5);
+	EXPECT_EQ(ring.get_read_size(), 8);
+
+	ASSERT_EQ(ring.read(buffer, 10), 8);
+	EXPECT_EQ(Bytes(buffer, buffer + 8), second);
+}
+
+TEST(OalLtSoundSysRingBuffer, Wrap_PositionsKeepGoingPastTheCapacity)
+{
+	auto ring = OalLtSoundSysRingBuffer{};
+	ring.resize(7);
+
+	std::uint8_t buffer[5];
+	auto next_byte = 0;
+	auto expected_byte = 0;
+
+	for (auto round = 0; round < 1000; ++round)
+	{
+		const auto size = 1 + (round % 5);
+		const auto bytes = make_bytes(size, next_byte);
+		auto written = 0;
+
+		while (written < size)
+		{
+			const auto write_size = write_some(ring, bytes.data() + written, size - written);
+			ASSERT_GT(write_size, 0);
+			written += write_size;
+		}
+
+		next_byte += size;
+
+		ASSERT_EQ(ring.read(buffer, size), size);
+
+		for (auto i = 0; i < size; ++i)
+		{
+			ASSERT_EQ(buffer[i], static_cast<std::uint8_t>(expected_byte++));
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Reset and end
+// -----------------------------------------------------------------------------
+
+TEST(OalLtSoundSysRingBuffer, Reset_EmptiesAndClearsTheEnd)
+{
+	auto ring = OalLtSoundSysRingBuffer{};
+	ring.resize(8);
+
+	const auto bytes = make_bytes(8, 0);
+	ASSERT_EQ(write_some(ring, bytes.data(), 5), 5);
+
+	std::uint8_t buffer[8];
+	ASSERT_EQ(ring.read(buffer, 2), 2);
+
+	ring.set_ended(true);
+	ring.reset();
+
+	EXPECT_EQ(ring.get_capacity(), 8);
+	EXPECT_EQ(ring.get_read_size(), 0);
+	EXPECT_FALSE(ring.is_ended());
+
+	// Back to the start, with all of it free.
+	auto write_size = 0;
+	const auto write_ptr = ring.begin_write(write_size);
+	EXPECT_EQ(write_size, 8);
+
+	ASSERT_EQ(write_some(ring, bytes.data(), 8), 8);
+	EXPECT_EQ(write_ptr[0], bytes[0]);
+	ASSERT_EQ(ring.read(buffer, 8), 8);
+	EXPECT_EQ(Bytes(buffer, buffer + 8), bytes);
+}
+
+TEST(OalLtSoundSysRingBuffer, Resize_Resets)
+{
+	auto ring = OalLtSoundSysRingBuffer{};
+	ring.resize(8);
+
+	const auto bytes = make_bytes(4, 0);
+	ASSERT_EQ(write_some(ring, bytes.data(), 4), 4);
+	ring.set_ended(true);
+
+	ring.resize(32);
+
+	EXPECT_EQ(ring.get_capacity(), 32);
+	EXPECT_EQ(ring.get_read_size(), 0);
+	EXPECT_FALSE(ring.is_ended());
+}
+
+TEST(OalLtSoundSysRingBuffer, SetEnded_LeavesTheDataToRead)
+{
+	auto ring = OalLtSoundSysRingBuffer{};
+	ring.resize(8);
+
+	const auto bytes = make_bytes(5, 0);
+	ASSERT_EQ(write_some(ring, bytes.data(), 5), 5);
+
+	ring.set_ended(true);
+	EXPECT_TRUE(ring.is_ended());
+	EXPECT_EQ(ring.get_read_size(), 5);
+
+	std::uint8_t buffer[8];
+	EXPECT_EQ(ring.read(buffer, 8), 5);
+
+	// A looping source starts producing again.
+	ring.set_ended(false);
+	EXPECT_FALSE(ring.is_ended());
+}
+
+// -----------------------------------------------------------------------------
+// Threads
+// -----------------------------------------------------------------------------
+
+TEST(OalLtSoundSysRingBuffer, Threads_ConsumerSeesEveryByteThenTheEnd)
+{
+	constexpr auto total_size = 4 * 1024 * 1024;
+
+	auto ring = OalLtSoundSysRingBuffer{};
+	ring.resize(1000);
+
+	auto producer = std::thread{
+		[&]()
+		{
+			auto offset = 0;
+			auto chunk = 0;
+
+			while (offset < total_size)
+			{
+				auto write_size = 0;
+				const auto write_ptr = ring.begin_write(write_size);
+
+				write_size = std::min({write_size, total_size - offset, 1 + ((chunk++ * 37) % 300)});
+
+				if (write_size <= 0)
+				{
+					std::this_thread::yield();
+					continue;
+				}
+
+				for (auto i = 0; i < write_size; ++i)
+				{
+					write_ptr[i] = static_cast<std::uint8_t>((offset + i) * 7);
+				}
+
+				ring.end_write(write_size);
+				offset += write_size;
+			}
+
+			ring.set_ended(true);
+		}
+	};
+
+	std::uint8_t buffer[333];
+	auto offset = 0;
+	auto mismatch_count = 0;
+
+	while (true)
+	{
+		// The end first; once it's set, the read size is final.
+		const auto is_ended = ring.is_ended();
+		const auto read_size = ring.read(buffer, sizeof(buffer));
+
+		for (auto i = 0; i < read_size; ++i)
+		{
+			mismatch_count += buffer[i] != static_cast<std::uint8_t>((offset + i) * 7);
+		}
+
+		offset += read_size;
+
+		if (is_ended && ring.get_read_size() == 0)
+		{
+			break;
+		}
+
+		if (read_size == 0)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	producer.join();
+
+	EXPECT_EQ(offset, total_size);
+	EXPECT_EQ(mismatch_count, 0);
+}
@@ -21,6 +21,9 @@
 #include "s_client.h"
 #include "servermgr.h"
 
+#include <chrono>
+#include <stddef.h>
+
 #ifndef __LINUX
      #include "renderstruct.h"
 #endif
@@ -266,6 +269,7 @@ void WorldBsp::Clear()
 
     m_TextureNameData = NULL;
     m_TextureNames = NULL;
+    m_nTextures = 0;
 
     m_MinBox.Init();
     m_MaxBox.Init();
@@ -276,6 +280,9 @@ void WorldBsp::Clear()
 
     m_PolyData = NULL;
     m_PolyDataSize = 0;
+
+    m_BakedData = NULL;
+    m_BakedDataSize = 0;
     
     m_WorldInfoFlags = 0;
 
@@ -286,15 +293,23 @@ void WorldBsp::Clear()
 void WorldBsp::Term()
 {
 	//free up all of our allocations
-    dfree(m_PolyData);
-    dfree(m_Polies);
-    dfree(m_Points);
-    dfree(m_Planes);
-    delete [] m_Surfaces;
-    delete [] m_Nodes;
-    
-    dfree(m_TextureNames);
-    dfree(m_TextureNameData);
+	if (m_BakedData)
+	{
+		//everything is in the one block
+		dfree(m_BakedData);
+	}
+	else
+	{
+	    dfree(m_PolyData);
+	    dfree(m_Polies);
+	    dfree(m_Points);
+	    dfree(m_Planes);
+	    delete [] m_Surfaces;
+	    delete [] m_Nodes;
+	    
+	    dfree(m_TextureNames);
+	    dfree(m_TextureNameData);
+	}
 
     g_WorldGeometryMemory -= m_MemoryUse;
 
@@ -366,14 +381,264 @@ struct SDiskPoly
 	uint32	m_nVerts[MAX_WORLDPOLY_VERTS];
 };
 
-ELoadWorldStatus WorldBsp::Load(ILTStream *pStream, bool bUsePlaneTypes) 
+//size of a node on disk (poly index, leaf, and the two child indices)
+#define DISK_NODE_SIZE		(sizeof(uint32) + sizeof(uint16) + sizeof(int32) * 2)
+
+//how much of the stream the section reader buffers at a time
+#define BSP_READ_BLOCK_SIZE	(64 * 1024)
+
+
+// Reads a BSP off the stream a block at a time so each section can be parsed
+// straight out of memory rather than with a stream read per field.  Since it
+// reads ahead, Finish has to be called to leave the stream positioned at the
+// end of the BSP.
+class CBspSectionReader
+{
+public:
+
+	CBspSectionReader(ILTStream *pStream) :
+		m_pStream(pStream),
+		m_pBuffer(NULL),
+		m_nBufferSize(0),
+		m_nHead(0),
+		m_nTail(0),
+		m_bError(false)
+	{
+		m_nStreamPos = pStream->GetPos();
+		m_nStreamLen = pStream->GetLen();
+	}
+
+	~CBspSectionReader()
+	{
+		dfree(m_pBuffer);
+	}
+
+	// Returns the next nBytes of the stream and moves past them, or NULL if
+	// there aren't that many left.
+	const uint8* Get(uint32 nBytes)
+	{
+		if (Fill(nBytes) < nBytes)
+		{
+			m_bError = true;
+			return NULL;
+		}
+
+		const uint8 *pRet = &m_pBuffer[m_nHead];
+		m_nHead += nBytes;
+		return pRet;
+	}
+
+	// Returns up to the next nBytes of the stream without moving past them.
+	// nAvail is set to how many are actually there.
+	const uint8* Peek(uint32 nBytes, uint32 &nAvail)
+	{
+		nAvail = Fill(nBytes);
+		return &m_pBuffer[m_nHead];
+	}
+
+	// Copies the next nBytes into pDest.  Anything not already buffered is
+	// read straight into pDest.
+	bool Read(void *pDest, uint32 nBytes)
+	{
+		uint32 nBuffered = LTMIN(nBytes, m_nTail - m_nHead);
+		if (nBuffered > 0)
+		{
+			memcpy(pDest, &m_pBuffer[m_nHead], nBuffered);
+			m_nHead += nBuffered;
+		}
+
+		uint32 nLeft = nBytes - nBuffered;
+		if (nLeft == 0)
+			return true;
+
+		if (nLeft < BSP_READ_BLOCK_SIZE)
+		{
+			const uint8 *pSrc = Get(nLeft);
+			if (!pSrc)
+				return false;
+
+			memcpy((uint8*)pDest + nBuffered, pSrc, nLeft);
+			return true;
+		}
+
+		if (nLeft > GetStreamLeft() ||
+			m_pStream->Read((uint8*)pDest + nBuffered, nLeft) != LT_OK)
+		{
+			m_bError = true;
+			return false;
+		}
+
+		m_nStreamPos += nLeft;
+		return true;
+	}
+
+	template<class T>
+	bool ReadValue(T &value)
+	{
+		return Read(&value, sizeof(value));
+	}
+
+	bool Skip(uint32 nBytes)
+	{
+		return Get(nBytes) != NULL;
+	}
+
+	// Puts the stream back where the reader is up to.  Returns false if
+	// anything failed to read.
+	bool Finish()
+	{
+		m_pStream->SeekTo(m_nStreamPos - (m_nTail - m_nHead));
+		m_nStreamPos -= m_nTail - m_nHead;
+		m_nHead = m_nTail = 0;
+		return !m_bError && m_pStream->ErrorStatus() == LT_OK;
+	}
+
+private:
+
+	uint32 GetStreamLeft() const
+	{
+		return (m_nStreamLen > m_nStreamPos) ? (m_nStreamLen - m_nStreamPos) : 0;
+	}
+
+	// Tries to get nBytes buffered past the head.  Returns how many are.
+	uint32 Fill(uint32 nBytes)
+	{
+		uint32 nBuffered = m_nTail - m_nHead;
+		if (nBuffered >= nBytes)
+			return nBuffered;
+
+		// Move what's left to the front and make sure there's room for the rest.
+		if (m_nHead > 0)
+		{
+			memmove(m_pBuffer, &m_pBuffer[m_nHead], nBuffered);
+			m_nHead = 0;
+			m_nTail = nBuffered;
+		}
+
+		uint32 nWantSize = LTMAX((uint32)BSP_READ_BLOCK_SIZE, nBytes);
+		if (nWantSize > m_nBufferSize)
+		{
+			uint8 *pNewBuffer;
+			LT_MEM_TRACK_ALLOC(pNewBuffer = (uint8*)dalloc(nWantSize),LT_MEM_TYPE_WORLD);
+			if (m_pBuffer)
+			{
+				memcpy(pNewBuffer, m_pBuffer, nBuffered);
+				dfree(m_pBuffer);
+			}
+
+			m_pBuffer = pNewBuffer;
+			m_nBufferSize = nWantSize;
+		}
+
+		uint32 nRead = LTMIN(m_nBufferSize - m_nTail, GetStreamLeft());
+		if (nRead > 0)
+		{
+			if (m_pStream->Read(&m_pBuffer[m_nTail], nRead) != LT_OK)
+			{
+				m_bError = true;
+				return nBuffered;
+			}
+
+			m_nTail += nRead;
+			m_nStreamPos += nRead;
+		}
+
+		return m_nTail - m_nHead;
+	}
+
+	ILTStream	*m_pStream;
+	uint32		m_nStreamPos;
+	uint32		m_nStreamLen;
+
+	uint8		*m_pBuffer;
+	uint32		m_nBufferSize;
+	uint32		m_nHead;
+	uint32		m_nTail;
+
+	bool		m_bError;
+};
+
+// Adds the time since the last call to a section of a WorldBspLoadTimes.
+// Does nothing if there's nothing to add to.
+class CBspLoadTimer
+{
+public:
+
+	CBspLoadTimer(WorldBspLoadTimes *pTimes) :
+		m_pTimes(pTimes)
+	{
+		if (m_pTimes)
+			m_Last = std::chrono::steady_clock::now();
+	}
+
+	void EndSection(uint32 iSection)
+	{
+		if (!m_pTimes)
+			return;
+
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		m_pTimes->m_fSeconds[iSection] += std::chrono::duration<double>(now - m_Last).count();
+		m_Last = now;
+	}
+
+private:
+
+	WorldBspLoadTimes						*m_pTimes;
+	std::chrono::steady_clock::time_point	m_Last;
+};
+
+template<class T>
+inline void w_ReadDiskValue(const uint8 *&pData, T &value)
+{
+	memcpy(&value, pData, sizeof(value));
+	pData += sizeof(value);
+}
+
+
+void WorldBspLoadTimes::Clear()
+{
+	for (uint32 i=0; i < kNumSections; i++)
+		m_fSeconds[i] = 0.0;
+
+	m_nBsps = 0;
+	m_nBytes = 0;
+}
+
+double WorldBspLoadTimes::GetTotal() const
+{
+	double fTotal = 0.0;
+	for (uint32 i=0; i < kNumSections; i++)
+		fTotal += m_fSeconds[i];
+
+	return fTotal;
+}
+
+const char* WorldBspLoadTimes::GetSectionName(uint32 iSection)
+{
+	static const char *s_SectionNames[kNumSections] =
+	{
+		"Header",
+		"TextureNames",
+		"PolyAlloc",
+		"LeafLists",
+		"Planes",
+		"Surfaces",
+		"Polies",
+		"Nodes",
+		"Points"
+	};
+
+	return (iSection < kNumSections) ? s_SectionNames[iSection] : "";
+}
+
+
+ELoadWorldStatus WorldBsp::Load(ILTStream *pStream, bool bUsePlaneTypes, WorldBspLoadTimes *pTimes) 
 {
     uint32 i, k;
     uint16 wLeaf;
 
     uint32 curVert, nLeafs;
     uint32 nPoints, nPolies, nVerts, totalVisListSize;
-    uint32 poliesStartPos;
     uint32 poliesSize;
     
     uint32 curPos;
@@ -384,50 +649,74 @@ ELoadWorldStatus WorldBsp::Load(ILTStream *pStream, bool bUsePlaneTypes)
     Node *pNode;
     int j, nodeIndex;
     uint16 tempWord;
-    ConParse conParse;
     uint32 nSections;
     uint8 nVertices;
 	uint32 nUserPortals;
 	uint32 nLeafLists;
+	const uint8 *pData;
+
+	CBspSectionReader reader(pStream);
+	CBspLoadTimer timer(pTimes);
+	uint32 nStartPos = pStream->GetPos();
       
 	uint32 nDWordWorldInfoFlags;
-    STREAM_READ(nDWordWorldInfoFlags);
+	reader.ReadValue(nDWordWorldInfoFlags);
 
 	//make sure we aren't truncating anything
 	assert((nDWordWorldInfoFlags & 0xFFFF0000) == 0);
 	m_WorldInfoFlags = static_cast<uint16>(nDWordWorldInfoFlags);
 
-    pStream->ReadString(m_WorldName, MAX_WORLDNAME_LEN);
+	//the name is a uint16 length followed by the characters, of which we keep
+	//as many as will fit
+	uint16 nNameLen = 0;
+	reader.ReadValue(nNameLen);
+	uint32 nNameKeep = LTMIN((uint32)nNameLen, (uint32)(MAX_WORLDNAME_LEN - 1));
+	reader.Read(m_WorldName, nNameKeep);
+	m_WorldName[nNameKeep] = 0;
+	reader.Skip(nNameLen - nNameKeep);
+
+	//the counts and extents are all together
+	pData = reader.Get(sizeof(uint32) * 10 + sizeof(LTVector) * 3);
+	if (!pData)
+		return LoadWorld_InvalidFile;
 
-    STREAM_READ(nPoints);
-    STREAM_READ(nPlanes);
-    STREAM_READ(nSurfaces);
+	w_ReadDiskValue(pData, nPoints);
+	w_ReadDiskValue(pData, nPlanes);
+	w_ReadDiskValue(pData, nSurfaces);
 
-    STREAM_READ(nUserPortals);
-    STREAM_READ(nPolies);
-    STREAM_READ(nLeafs);
-    STREAM_READ(nVerts);
-    STREAM_READ(totalVisListSize);
-    STREAM_READ(nLeafLists);
-    STREAM_READ(m_nNodes);
+	w_ReadDiskValue(pData, nUserPortals);
+	w_ReadDiskValue(pData, nPolies);
+	w_ReadDiskValue(pData, nLeafs);
+	w_ReadDiskValue(pData, nVerts);
+	w_ReadDiskValue(pData, totalVisListSize);
+	w_ReadDiskValue(pData, nLeafLists);
+	w_ReadDiskValue(pData, m_nNodes);
 
-    STREAM_READ(m_MinBox);
-    STREAM_READ(m_MaxBox);
-    STREAM_READ(m_WorldTranslation);
+	w_ReadDiskValue(pData, m_MinBox);
+	w_ReadDiskValue(pData, m_MaxBox);
+	w_ReadDiskValue(pData, m_WorldTranslation);
 
 	//we should never have any user portals anymroe
 	if(nUserPortals > 0)
 		return LoadWorld_InvalidFile;
 
+	timer.EndSection(WorldBspLoadTimes::kHeader);
+
     // Read the texture list.
-	uint32 nNamesLen;
-	uint32 nTextures;
+	uint32 nNamesLen = 0;
+	uint32 nTextures = 0;
 
-    STREAM_READ(nNamesLen);
-    STREAM_READ(nTextures);
+	reader.ReadValue(nNamesLen);
+	reader.ReadValue(nTextures);
 
     LT_MEM_TRACK_ALLOC(m_TextureNameData = (char*)dalloc_z(nNamesLen),LT_MEM_TYPE_WORLD);
     LT_MEM_TRACK_ALLOC(m_TextureNames = (char**)dalloc_z(sizeof(char*) * nTextures),LT_MEM_TYPE_WORLD);
+    m_nTextures = nTextures;
+
+	//the names are packed one after another, each null terminated, so walk
+	//the block to find where each starts
+	uint32 nNamesAvail;
+	pData = reader.Peek(nNamesLen, nNamesAvail);
 
     curPos = 0;
     for (i=0; i < nTextures; i++)
@@ -435,28 +724,38 @@ ELoadWorldStatus WorldBsp::Load(ILTStream *pStream, bool bUsePlaneTypes)
         m_TextureNames[i] = &m_TextureNameData[curPos];
         for (;;)
         {
-            STREAM_READ(m_TextureNameData[curPos]);
+			if (curPos >= nNamesAvail)
+				return LoadWorld_InvalidFile;
+
+            m_TextureNameData[curPos] = (char)pData[curPos];
             curPos++;
             if (m_TextureNameData[curPos-1] == 0)
                 break;
         }
     }
+
+	reader.Skip(curPos);
+
+	timer.EndSection(WorldBspLoadTimes::kTextureNames);
 	
-    // Figure out how much space to allocate for the polygon buffers.
+    // Figure out how much space to allocate for the polygon buffers.  The
+	// vertex counts point into the reader's buffer, so they're only good
+	// until its next Get; the polygons laid out below keep their own.
+	const uint8 *pVertexCounts = reader.Get(nPolies);
+	if (!pVertexCounts)
+		return LoadWorld_InvalidFile;
+
     poliesSize = 0;
-    pStream->GetPos(&poliesStartPos);
 
     // Read in the initial structure sizes so it can do structure alignment.    
 	for (i=0; i < nPolies; i++) 
 	{
-		STREAM_READ(nVertices);
+		nVertices = pVertexCounts[i];
 
 		poliesSize += WORLDPOLY_SIZE(nVertices);
 		poliesSize = ALIGN_MEMORY(poliesSize); 
 	}
 
-    pStream->SeekTo(poliesStartPos);
-
     // (Try to) allocate all the data.
     m_PolyDataSize = poliesSize;
 
@@ -489,7 +788,7 @@ ELoadWorldStatus WorldBsp::Load(ILTStream *pStream, bool bUsePlaneTypes)
     curPos = 0;
     for (i=0; i < nPolies; i++) 
 	{
-        STREAM_READ(nVertices);
+        nVertices = pVertexCounts[i];
 
         pPoly = (WorldPoly*)(&m_PolyData[curPos]);
         pPoly->SetIndex(i);
@@ -501,16 +800,18 @@ ELoadWorldStatus WorldBsp::Load(ILTStream *pStream, bool bUsePlaneTypes)
         curPos  = ALIGN_MEMORY(curPos); 
 	}
 
+	timer.EndSection(WorldBspLoadTimes::kPolyAlloc);
+
 	//pseudo load in the leaf lists
     for (i=0; i < nLeafs; i++)
     {
-		uint16 nNumLeafLists;
-        STREAM_READ(nNumLeafLists);
+		uint16 nNumLeafLists = 0;
+        reader.ReadValue(nNumLeafLists);
         
         if (nNumLeafLists == 0xFFFF)
         {
             // This leaf uses the lists from another leaf.
-            STREAM_READ(tempWord);
+            reader.ReadValue(tempWord);
         }
         else
         {
@@ -518,26 +819,36 @@ ELoadWorldStatus WorldBsp::Load(ILTStream *pStream, bool bUsePlaneTypes)
             for (k=0; k < nNumLeafLists; k++)
             {
 				//portal ID
-                STREAM_READ(tempWord);
+                reader.ReadValue(tempWord);
 
 				//list size
-				uint16 nListSize;
-                STREAM_READ(nListSize);
+				uint16 nListSize = 0;
+                reader.ReadValue(nListSize);
 
 				//skip over the list
-				pStream->SeekTo(pStream->GetPos() + nListSize);
+				reader.Skip(nListSize);
             }
         }
     }
 
-    // Read in the planes.
-	pStream->Read(m_Planes, sizeof(LTPlane) * nPlanes);
+	timer.EndSection(WorldBspLoadTimes::kLeafLists);
+
+    // Read in the planes.  These are stored just as they are in memory, so
+	// they go straight into place.
+	if (!reader.Read(m_Planes, sizeof(LTPlane) * nPlanes))
+		return LoadWorld_InvalidFile;
+
+	timer.EndSection(WorldBspLoadTimes::kPlanes);
 
     // Read in the surfaces.
+	pData = reader.Get(sizeof(SDiskSurface) * nSurfaces);
+	if (!pData)
+		return LoadWorld_InvalidFile;
+
 	SDiskSurface DiskSurface;
     for (i=0; i < nSurfaces; i++)
     {
-		pStream->Read(&DiskSurface, sizeof(DiskSurface));
+		w_ReadDiskValue(pData, DiskSurface);
 
 		m_Surfaces[i].m_pTexture		= NULL;
         m_Surfaces[i].m_Flags			= DiskSurface.m_nFlags;
@@ -545,14 +856,26 @@ ELoadWorldStatus WorldBsp::Load(ILTStream *pStream, bool bUsePlaneTypes)
         m_Surfaces[i].m_TextureFlags	= DiskSurface.m_nTextureFlags;
     }
 
+	timer.EndSection(WorldBspLoadTimes::kSurfaces);
+
     // Read in all the polies.
+	uint32 nDiskPoliesSize = 0;
+	for (i=0; i < nPolies; i++)
+		nDiskPoliesSize += SDiskPoly::CalcPolyReadSize(m_Polies[i]->GetNumVertices());
+
+	pData = reader.Get(nDiskPoliesSize);
+	if (!pData)
+		return LoadWorld_InvalidFile;
+
 	SDiskPoly DiskPoly;
     for (i=0; i < nPolies; i++)
     {
         pPoly = m_Polies[i];
 
-		//read in our polygon from disk
-		pStream->Read(&DiskPoly, SDiskPoly::CalcPolyReadSize(pPoly->GetNumVertices()));
+		//copy our polygon out of the block
+		uint32 nPolyReadSize = SDiskPoly::CalcPolyReadSize(pPoly->GetNumVertices());
+		memcpy(&DiskPoly, pData, nPolyReadSize);
+		pData += nPolyReadSize;
 
         if (DiskPoly.m_nSurface >= m_nSurfaces) 
             return LoadWorld_InvalidFile; 
@@ -574,14 +897,20 @@ ELoadWorldStatus WorldBsp::Load(ILTStream *pStream, bool bUsePlaneTypes)
 		} 
 	}
 
+	timer.EndSection(WorldBspLoadTimes::kPolies);
+
     // Read nodes.
+	pData = reader.Get(DISK_NODE_SIZE * m_nNodes);
+	if (!pData)
+		return LoadWorld_InvalidFile;
+
 	uint32 nNodeIndices[2];
 
     for (i=0; i < m_nNodes; i++)
     {
         pNode = &m_Nodes[i];
         
-        STREAM_READ(iPoly);
+        w_ReadDiskValue(pData, iPoly);
         if (iPoly >= m_nPolies)
         {
             return LoadWorld_InvalidFile;
@@ -591,8 +920,8 @@ ELoadWorldStatus WorldBsp::Load(ILTStream *pStream, bool bUsePlaneTypes)
 		pNode->m_Flags		= 0;
 		pNode->m_PlaneType	= 0;
 
-        STREAM_READ(wLeaf);
-        STREAM_READ(nNodeIndices);
+        w_ReadDiskValue(pData, wLeaf);
+        w_ReadDiskValue(pData, nNodeIndices);
 
         for (j=0; j < 2; j++)
         {
@@ -607,11 +936,15 @@ ELoadWorldStatus WorldBsp::Load(ILTStream *pStream, bool bUsePlaneTypes)
     // Classify its plane.
     w_SetPlaneTypes(m_Nodes, m_nNodes, bUsePlaneTypes);
 
-    // Read m_Points.
-	pStream->Read(m_Points, (nPoints * sizeof(LTVector3f)));
+	timer.EndSection(WorldBspLoadTimes::kNodes);
+
+    // Read m_Points.  Like the planes, these go straight into place.
+	if (!reader.Read(m_Points, (nPoints * sizeof(LTVector3f))))
+		return LoadWorld_InvalidFile;
 
     // Root poly index..
-    STREAM_READ(nodeIndex);
+    nodeIndex = 0;
+    reader.ReadValue(nodeIndex);
     m_RootNode = w_NodeForIndex(m_Nodes, m_nNodes, nodeIndex);
     if (!m_RootNode) 
 	{
@@ -619,19 +952,28 @@ ELoadWorldStatus WorldBsp::Load(ILTStream *pStream, bool bUsePlaneTypes)
 	}
     
     // Sections.
-    STREAM_READ(nSections);
+    nSections = 0;
+    reader.ReadValue(nSections);
 
 	//Note that this should always be 0, this should be removed later when the level
 	//version is updated
 	if(nSections > 0)
 		return LoadWorld_InvalidFile;
 
-    // See if there were any errors.
-    if (pStream->ErrorStatus() != LT_OK)
+    // Leave the stream at the end of the bsp and see if there were any errors.
+    if (!reader.Finish())
     {
         return LoadWorld_InvalidFile;
     }
 
+	timer.EndSection(WorldBspLoadTimes::kPoints);
+
+	if (pTimes)
+	{
+		pTimes->m_nBsps++;
+		pTimes->m_nBytes += pStream->GetPos() - nStartPos;
+	}
+
     g_WorldGeometryMemory += m_MemoryUse;
 
     return LoadWorld_Ok;
@@ -671,11 +1013,339 @@ void WorldBsp::CalcBoundingSpheres()
 }
 
 
+// ----------------------------------------------------------------------------- //
+// Baked BSPs.
+// ----------------------------------------------------------------------------- //
+
+// A baked BSP is one block holding all of a WorldBsp's arrays, with every
+// pointer stored as an offset from the start of the block.  The block starts
+// with this header, so an offset of 0 is always a null pointer.
+struct SBakedBspHeader
+{
+	uint32		m_nPointsOffset;
+	uint32		m_nPlanesOffset;
+	uint32		m_nSurfacesOffset;
+	uint32		m_nNodesOffset;
+	uint32		m_nPoliesOffset;
+	uint32		m_nPolyDataOffset;
+	uint32		m_nTextureNamesOffset;
+	uint32		m_nTextureNameDataOffset;
+
+	uint32		m_nPoints;
+	uint32		m_nPlanes;
+	uint32		m_nSurfaces;
+	uint32		m_nNodes;
+	uint32		m_nPolies;
+	uint32		m_nPolyDataSize;
+	uint32		m_nTextures;
+	uint32		m_nTextureNameDataSize;
+
+	int32		m_nRootNode;			// Index, as it is in the world file.
+	uint32		m_nWorldInfoFlags;
+
+	LTVector	m_MinBox;
+	LTVector	m_MaxBox;
+	LTVector	m_WorldTranslation;
+
+	char		m_WorldName[MAX_WORLDNAME_LEN+1];
+};
+
+#define BAKED_ALIGNMENT			16
+#define BAKED_ALIGN(n)			(((n) + (BAKED_ALIGNMENT - 1)) & ~(BAKED_ALIGNMENT - 1))
+
+// Offsets used for the two special nodes.
+#define BAKED_NODE_IN			((uintptr_t)-1)
+#define BAKED_NODE_OUT			((uintptr_t)-2)
+
+// Turns a pointer into an array of the bsp into an offset in the baked block.
+template<class T>
+inline T* w_BakePtr(const T *pPtr, const void *pArray, uint32 nArrayOffset)
+{
+	if (!pPtr)
+		return NULL;
+
+	return (T*)(uintptr_t)(nArrayOffset + ((const char*)pPtr - (const char*)pArray));
+}
+
+// Turns an offset back into a pointer.  Fails if it points outside the block.
+template<class T>
+inline bool w_UnbakePtr(T *&pPtr, char *pBlock, uint32 nBlockSize)
+{
+	uintptr_t nOffset = (uintptr_t)pPtr;
+	if (nOffset == 0)
+		return true;
+
+	if (nOffset + sizeof(T) > nBlockSize)
+		return false;
+
+	pPtr = (T*)&pBlock[nOffset];
+	return true;
+}
+
+inline Node* w_BakeNodePtr(const Node *pNode, const Node *pNodes, uint32 nNodesOffset)
+{
+	if (pNode == NODE_IN)
+		return (Node*)BAKED_NODE_IN;
+	else if (pNode == NODE_OUT)
+		return (Node*)BAKED_NODE_OUT;
+
+	return w_BakePtr(pNode, pNodes, nNodesOffset);
+}
+
+inline bool w_UnbakeNodePtr(Node *&pNode, char *pBlock, uint32 nBlockSize)
+{
+	if ((uintptr_t)pNode == BAKED_NODE_IN)
+	{
+		pNode = NODE_IN;
+		return true;
+	}
+	else if ((uintptr_t)pNode == BAKED_NODE_OUT)
+	{
+		pNode = NODE_OUT;
+		return true;
+	}
+
+	return pNode && w_UnbakePtr(pNode, pBlock, nBlockSize);
+}
+
+// Lays out the arrays of a baked block.  Returns the size of the block.
+static uint32 w_LayoutBakedBsp(const WorldBsp *pBsp, uint32 nTextures, uint32 nTextureNameDataSize, 
+	SBakedBspHeader &header)
+{
+	uint32 nSize = BAKED_ALIGN(sizeof(SBakedBspHeader));
+
+	header.m_nPointsOffset = nSize;
+	nSize = BAKED_ALIGN(nSize + sizeof(Vertex) * pBsp->m_nPoints);
+
+	header.m_nPlanesOffset = nSize;
+	nSize = BAKED_ALIGN(nSize + sizeof(LTPlane) * pBsp->m_nPlanes);
+
+	header.m_nSurfacesOffset = nSize;
+	nSize = BAKED_ALIGN(nSize + sizeof(Surface) * pBsp->m_nSurfaces);
+
+	header.m_nNodesOffset = nSize;
+	nSize = BAKED_ALIGN(nSize + sizeof(Node) * pBsp->m_nNodes);
+
+	header.m_nPoliesOffset = nSize;
+	nSize = BAKED_ALIGN(nSize + sizeof(WorldPoly*) * pBsp->m_nPolies);
+
+	header.m_nPolyDataOffset = nSize;
+	nSize = BAKED_ALIGN(nSize + pBsp->m_PolyDataSize);
+
+	header.m_nTextureNamesOffset = nSize;
+	nSize = BAKED_ALIGN(nSize + sizeof(char*) * nTextures);
+
+	header.m_nTextureNameDataOffset = nSize;
+	nSize = BAKED_ALIGN(nSize + nTextureNameDataSize);
+
+	return nSize;
+}
+
+// Works out how much name data the textures use, since the bsp doesn't keep
+// it around.
+static void w_GetBakedTextureSizes(const WorldBsp *pBsp, uint32 &nTextures, uint32 &nTextureNameDataSize)
+{
+	nTextures = pBsp->m_nTextures;
+
+	nTextureNameDataSize = 0;
+	for (uint32 i=0; i < nTextures; i++)
+	{
+		uint32 nEnd = (uint32)(pBsp->m_TextureNames[i] - pBsp->m_TextureNameData) + (uint32)strlen(pBsp->m_TextureNames[i]) + 1;
+		nTextureNameDataSize = LTMAX(nTextureNameDataSize, nEnd);
+	}
+}
+
+uint32 WorldBsp::GetBakedSize() const
+{
+	uint32 nTextures, nTextureNameDataSize;
+	w_GetBakedTextureSizes(this, nTextures, nTextureNameDataSize);
+
+	SBakedBspHeader header;
+	return w_LayoutBakedBsp(this, nTextures, nTextureNameDataSize, header);
+}
+
+void WorldBsp::Bake(char *pDest) const
+{
+	uint32 i, k;
+
+	uint32 nTextures, nTextureNameDataSize;
+	w_GetBakedTextureSizes(this, nTextures, nTextureNameDataSize);
+
+	SBakedBspHeader header;
+	memset(&header, 0, sizeof(header));
+	uint32 nSize = w_LayoutBakedBsp(this, nTextures, nTextureNameDataSize, header);
+	memset(pDest, 0, nSize);
+
+	header.m_nPoints				= m_nPoints;
+	header.m_nPlanes				= m_nPlanes;
+	header.m_nSurfaces				= m_nSurfaces;
+	header.m_nNodes					= m_nNodes;
+	header.m_nPolies				= m_nPolies;
+	header.m_nPolyDataSize			= m_PolyDataSize;
+	header.m_nTextures				= nTextures;
+	header.m_nTextureNameDataSize	= nTextureNameDataSize;
+	header.m_nRootNode				= (m_RootNode == NODE_IN) ? -1 : ((m_RootNode == NODE_OUT) ? -2 : (int32)(m_RootNode - m_Nodes));
+	header.m_nWorldInfoFlags		= m_WorldInfoFlags;
+	header.m_MinBox					= m_MinBox;
+	header.m_MaxBox					= m_MaxBox;
+	header.m_WorldTranslation		= m_WorldTranslation;
+	LTStrCpy(header.m_WorldName, m_WorldName, sizeof(header.m_WorldName));
+	memcpy(pDest, &header, sizeof(header));
+
+	// Points and planes have no pointers.
+	memcpy(&pDest[header.m_nPointsOffset], m_Points, sizeof(Vertex) * m_nPoints);
+	memcpy(&pDest[header.m_nPlanesOffset], m_Planes, sizeof(LTPlane) * m_nPlanes);
+
+	// Surfaces only point at their textures, which are set up after loading.
+	Surface *pSurfaces = (Surface*)&pDest[header.m_nSurfacesOffset];
+	memcpy(pSurfaces, m_Surfaces, sizeof(Surface) * m_nSurfaces);
+	for (i=0; i < m_nSurfaces; i++)
+		pSurfaces[i].m_pTexture = NULL;
+
+	Node *pNodes = (Node*)&pDest[header.m_nNodesOffset];
+	memcpy(pNodes, m_Nodes, sizeof(Node) * m_nNodes);
+	for (i=0; i < m_nNodes; i++)
+	{
+		pNodes[i].m_pPoly		= w_BakePtr(m_Nodes[i].m_pPoly, m_PolyData, header.m_nPolyDataOffset);
+		pNodes[i].m_Sides[0]	= w_BakeNodePtr(m_Nodes[i].m_Sides[0], m_Nodes, header.m_nNodesOffset);
+		pNodes[i].m_Sides[1]	= w_BakeNodePtr(m_Nodes[i].m_Sides[1], m_Nodes, header.m_nNodesOffset);
+	}
+
+	WorldPoly **pPolies = (WorldPoly**)&pDest[header.m_nPoliesOffset];
+	for (i=0; i < m_nPolies; i++)
+		pPolies[i] = w_BakePtr(m_Polies[i], m_PolyData, header.m_nPolyDataOffset);
+
+	memcpy(&pDest[header.m_nPolyDataOffset], m_PolyData, m_PolyDataSize);
+	for (i=0; i < m_nPolies; i++)
+	{
+		const WorldPoly *pSrcPoly = m_Polies[i];
+		WorldPoly *pPoly = (WorldPoly*)&pDest[header.m_nPolyDataOffset + ((const char*)pSrcPoly - m_PolyData)];
+
+		pPoly->SetSurface(w_BakePtr(pSrcPoly->GetSurface(), m_Surfaces, header.m_nSurfacesOffset));
+		pPoly->SetPlane(w_BakePtr(pSrcPoly->GetPlane(), m_Planes, header.m_nPlanesOffset));
+
+		for (k=0; k < pPoly->GetNumVertices(); k++)
+		{
+			pPoly->GetVertices()[k].m_Vertex = 
+				w_BakePtr(pSrcPoly->GetVertices()[k].m_Vertex, m_Points, header.m_nPointsOffset);
+		}
+	}
+
+	char **pTextureNames = (char**)&pDest[header.m_nTextureNamesOffset];
+	for (i=0; i < nTextures; i++)
+		pTextureNames[i] = w_BakePtr(m_TextureNames[i], m_TextureNameData, header.m_nTextureNameDataOffset);
+
+	memcpy(&pDest[header.m_nTextureNameDataOffset], m_TextureNameData, nTextureNameDataSize);
+}
+
+ELoadWorldStatus WorldBsp::LoadBaked(char *pData, uint32 nDataSize, bool bUsePlaneTypes)
+{
+	uint32 i, k;
+
+	Term();
+
+	// Take the block over right away so Term frees it if anything's wrong with it.
+	m_BakedData = pData;
+	m_BakedDataSize = nDataSize;
+
+	if (nDataSize < sizeof(SBakedBspHeader))
+		return LoadWorld_InvalidFile;
 
+	SBakedBspHeader header;
+	memcpy(&header, pData, sizeof(header));
+
+	SBakedBspHeader layout;
+	uint32 nTextureNameDataSize = header.m_nTextureNameDataSize;
+	m_nPoints		= header.m_nPoints;
+	m_nPlanes		= header.m_nPlanes;
+	m_nSurfaces		= header.m_nSurfaces;
+	m_nNodes		= header.m_nNodes;
+	m_nPolies		= header.m_nPolies;
+	m_PolyDataSize	= header.m_nPolyDataSize;
+	m_nTextures		= header.m_nTextures;
+
+	// The arrays have to be where they would have been put.
+	if (w_LayoutBakedBsp(this, header.m_nTextures, nTextureNameDataSize, layout) != nDataSize ||
+		memcmp(&layout, &header, offsetof(SBakedBspHeader, m_nPoints)) != 0)
+	{
+		return LoadWorld_InvalidFile;
+	}
 
+	m_Points			= (Vertex*)&pData[header.m_nPointsOffset];
+	m_Planes			= (LTPlane*)&pData[header.m_nPlanesOffset];
+	m_Surfaces			= (Surface*)&pData[header.m_nSurfacesOffset];
+	m_Nodes				= (Node*)&pData[header.m_nNodesOffset];
+	m_Polies			= (WorldPoly**)&pData[header.m_nPoliesOffset];
+	m_PolyData			= &pData[header.m_nPolyDataOffset];
+	m_TextureNames		= (char**)&pData[header.m_nTextureNamesOffset];
+	m_TextureNameData	= &pData[header.m_nTextureNameDataOffset];
+
+	m_WorldInfoFlags	= (uint16)header.m_nWorldInfoFlags;
+	m_MinBox			= header.m_MinBox;
+	m_MaxBox			= header.m_MaxBox;
+	m_WorldTranslation	= header.m_WorldTranslation;
+	LTStrCpy(m_WorldName, header.m_WorldName, sizeof(m_WorldName));
+
+	m_RootNode = w_NodeForIndex(m_Nodes, m_nNodes, header.m_nRootNode);
+	if (!m_RootNode)
+		return LoadWorld_InvalidFile;
 
+	// Turn the offsets back into pointers.
 
+	for (i=0; i < m_nNodes; i++)
+	{
+		Node *pNode = &m_Nodes[i];
+		if (!w_UnbakePtr(pNode->m_pPoly, pData, nDataSize) ||
+			!w_UnbakeNodePtr(pNode->m_Sides[0], pData, nDataSize) ||
+			!w_UnbakeNodePtr(pNode->m_Sides[1], pData, nDataSize))
+		{
+			return LoadWorld_InvalidFile;
+		}
+	}
 
+	for (i=0; i < m_nPolies; i++)
+	{
+		if (!w_UnbakePtr(m_Polies[i], pData, nDataSize))
+			return LoadWorld_InvalidFile;
 
+		WorldPoly *pPoly = m_Polies[i];
+		if ((char*)pPoly < m_PolyData || 
+			(char*)pPoly + WORLDPOLY_SIZE(pPoly->GetNumVertices()) > m_PolyData + m_PolyDataSize)
+		{
+			return LoadWorld_InvalidFile;
+		}
 
+		Surface *pSurface = pPoly->GetSurface();
+		LTPlane *pPlane = pPoly->GetPlane();
+		if (!w_UnbakePtr(pSurface, pData, nDataSize) || !w_UnbakePtr(pPlane, pData, nDataSize))
+			return LoadWorld_InvalidFile;
 
+		pPoly->SetSurface(pSurface);
+		pPoly->SetPlane(pPlane);
+
+		for (k=0; k < pPoly->GetNumVertices(); k++)
+		{
+			if (!w_UnbakePtr(pPoly->GetVertices()[k].m_Vertex, pData, nDataSize))
+				return LoadWorld_InvalidFile;
+		}
+	}
+
+	for (i=0; i < header.m_nTextures; i++)
+	{
+		if (!w_UnbakePtr(m_TextureNames[i], pData, nDataSize))
+			return LoadWorld_InvalidFile;
+	}
+
+	// The names have to end inside the block.
+	if (nTextureNameDataSize > 0 && m_TextureNameData[nTextureNameDataSize - 1] != 0)
+		return LoadWorld_InvalidFile;
+
+	// The nodes were baked with plane types, but moveable bsps don't use them.
+	if (!bUsePlaneTypes)
+		w_SetPlaneTypes(m_Nodes, m_nNodes, false);
+
+	m_MemoryUse = nDataSize + sizeof(WorldBsp);
+	g_WorldGeometryMemory += m_MemoryUse;
+
+	return LoadWorld_Ok;
+}
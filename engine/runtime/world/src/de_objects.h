@@ -62,6 +62,10 @@ struct ObjectCreateStruct;
 #include "iltspritecontrol.h"
 #endif
 
+#ifndef __LTPARTICLEARRAYS_H__
+#include "ltparticlearrays.h"
+#endif
+
 #ifndef __TRANSFORMMAKER_H__
 #include "transformmaker.h"
 #endif
@@ -675,12 +679,23 @@ public:
 
     virtual void        Init(ObjectMgr *pMgr, ObjectCreateStruct *pStruct);
 
+    // Makes room in m_ParticleArrays for at least this many particles.
+    bool                ReserveParticleArrays(uint32 nParticles);
+    void                FreeParticleArrays();
+
 
 // Vars.
 public:
 
     PSParticle      m_ParticleHead;     // Lists of particles.
 
+    // The particles of PS_ARRAYS systems, in place of m_ParticleHead.
+    // m_pParticleArrayBlock holds m_nParticleArrayCapacity of each field,
+    // one field after another.
+    LTParticleArrays    m_ParticleArrays;
+    uint32              m_nParticleArrayCapacity;
+    float               *m_pParticleArrayBlock;
+
     StructBank      *m_pParticleBank;   // Where the particles come from.
     SharedTexture   *m_pCurTexture;     // Current texture for particles.
 
@@ -368,6 +368,36 @@ public:
 	ELightAttenuationType	m_eAttenuation;		// The attenuation model of this light
 };
 
+// Time spent in each section of WorldBsp::Load, summed over every load it's
+// passed to.
+struct WorldBspLoadTimes
+{
+	enum ESection
+	{
+		kHeader,
+		kTextureNames,
+		kPolyAlloc,
+		kLeafLists,
+		kPlanes,
+		kSurfaces,
+		kPolies,
+		kNodes,
+		kPoints,
+		kNumSections
+	};
+
+					WorldBspLoadTimes()		{ Clear(); }
+
+	void			Clear();
+	double			GetTotal() const;
+
+	static const char*	GetSectionName(uint32 iSection);
+
+	double			m_fSeconds[kNumSections];
+	uint32			m_nBsps;
+	uint32			m_nBytes;
+};
+
 // A world BSP.
 class WorldBsp
 {
@@ -379,12 +409,25 @@ public:
     void            Clear();
     void            Term();
 
-    //loads the bsp.
-    ELoadWorldStatus Load(ILTStream *pStream, bool bUsePlaneTypes);
+    //loads the bsp.  If pTimes is set, the time spent in each section is
+    //added to it.
+    ELoadWorldStatus Load(ILTStream *pStream, bool bUsePlaneTypes, WorldBspLoadTimes *pTimes = NULL);
 
     // Get bounding radius of the world.
     float			GetBoundRadiusSqr() const {return (m_MaxBox - m_MinBox).MagSqr();}
 
+    //The size of the block that Bake writes.
+    uint32          GetBakedSize() const;
+
+    //Writes a copy of the bsp into a single block of GetBakedSize bytes, with
+    //its pointers turned into offsets, for the baked world cache.
+    void            Bake(char *pDest) const;
+
+    //Loads the bsp from a block written by Bake, turning the offsets back
+    //into pointers.  Takes ownership of the block (which must be allocated
+    //with dalloc) even if it fails.
+    ELoadWorldStatus LoadBaked(char *pData, uint32 nDataSize, bool bUsePlaneTypes);
+
     //Computes m_Center and m_Radius of all the leaves, and all the polies.
     //used to be w_CalcBoundingSpheres.
     void			CalcBoundingSpheres();
@@ -431,6 +474,7 @@ public:
 
     char			*m_TextureNameData; // The list of texture names used in this world.
     char			**m_TextureNames;
+    uint32			m_nTextures;
 
     LTVector        m_MinBox, m_MaxBox; // Bounding box on the whole WorldBsp.
 
@@ -446,6 +490,9 @@ public:
     char            *m_PolyData;        // Data blocks
     uint32          m_PolyDataSize;
 
+    char            *m_BakedData;       // If this was loaded by LoadBaked, the block
+    uint32          m_BakedDataSize;    // that holds all the arrays above.
+
     char            m_WorldName[MAX_WORLDNAME_LEN+1];   // Name of this world.
 };
 
@@ -11,36 +11,43 @@
 #include "geometry.h"
 #include "syscounter.h"
 #include "intersect_line.h"
+#include "world_tree.h"
+#include "ltjobpool.h"
+
+#include <algorithm>
+#include <vector>
 
 
 
 uint32 g_Ticks_Intersect, g_nIntersectCalls;
 
 
-static void (*g_FindIntersectionsFn)(const WorldBsp *pWorldBsp, const Node **pNodeIntersectionPtr, 
+// The query state is per thread so IntersectSegmentBatch can run queries on
+// the job pool.
+static thread_local void (*g_FindIntersectionsFn)(const WorldBsp *pWorldBsp, const Node **pNodeIntersectionPtr, 
     LTVector *pIntersectionPosPtr, float *pDistSqrPtr, HPOLY *hWorldPoly,
     LTVector *pPoint1, LTVector *pPoint2, uint8 bWorldModel);
 
 
 // The current query.
-static IntersectQuery *g_pCurQuery;
-static uint8 g_bProcessNonSolid;
-static uint8 g_bProcessObjects;
-static uint8 g_bCheckIfFromPointIsInsideObject;
-static uint8 g_bProcessModelObbs;
+static thread_local IntersectQuery *g_pCurQuery;
+static thread_local uint8 g_bProcessNonSolid;
+static thread_local uint8 g_bProcessObjects;
+static thread_local uint8 g_bCheckIfFromPointIsInsideObject;
+static thread_local uint8 g_bProcessModelObbs;
 
 
 // The current best intersection (LTNULL if none).
-static const Node *g_pWorldIntersection; // The node we intersected if we hit a BSP.
-static LTObject *g_pIntersection;
-static float g_IntersectionBestDistSqr; // Distance to intersection point squared.
-static LTPlane g_IntersectionPlane;
-static LTVector g_IntersectionPos;
-static HPOLY g_hWorldPoly;  // The WorldModel poly we're touching.
-static HMODELNODE g_hModelNode; // The node we hit.
+static thread_local const Node *g_pWorldIntersection; // The node we intersected if we hit a BSP.
+static thread_local LTObject *g_pIntersection;
+static thread_local float g_IntersectionBestDistSqr; // Distance to intersection point squared.
+static thread_local LTPlane g_IntersectionPlane;
+static thread_local LTVector g_IntersectionPos;
+static thread_local HPOLY g_hWorldPoly;  // The WorldModel poly we're touching.
+static thread_local HMODELNODE g_hModelNode; // The node we hit.
 
-static LTVector g_V, g_VTimesInvVV, g_VOrigin, g_VDir;
-static float g_VPTimesInvVV, g_LineLen;
+static thread_local LTVector g_V, g_VTimesInvVV, g_VOrigin, g_VDir;
+static thread_local float g_VPTimesInvVV, g_LineLen;
 
 
 
@@ -637,13 +644,12 @@ static bool i_ISCallback(WorldTreeObj *pObj, void *pCBUser)
 }       
 
 
-bool i_IntersectSegment(IntersectQuery *pQuery, IntersectInfo *pInfo, WorldTree *pWorldTree)
+// Sets up the globals for a query.  Returns false if the segment is too short
+// to test.
+static bool i_BeginQuery(IntersectQuery *pQuery)
 {
     float InvVV, VP, testMag;
 
-    ++g_nIntersectCalls;
-	CountAdder cTicks_Intersect(&g_Ticks_Intersect);
-        
     // Init..
     g_pCurQuery = pQuery;
     g_pIntersection = LTNULL;
@@ -687,9 +693,13 @@ bool i_IntersectSegment(IntersectQuery *pQuery, IntersectInfo *pInfo, WorldTree
         g_FindIntersectionsFn = i_FindIntersections;
     }
 
-    // Start at the world tree.
-    pWorldTree->IntersectSegment((LTVector*)&pQuery->m_From, (LTVector*)&pQuery->m_To, i_ISCallback, LTNULL);
+    return true;
+}
+
 
+// Fills in pInfo from the best intersection found.
+static bool i_EndQuery(IntersectInfo *pInfo)
+{
     // If an object was hit, use it!
     if (g_pIntersection) 
 	{
@@ -716,3 +726,189 @@ bool i_IntersectSegment(IntersectQuery *pQuery, IntersectInfo *pInfo, WorldTree
     }
 }
 
+
+bool i_IntersectSegment(IntersectQuery *pQuery, IntersectInfo *pInfo, WorldTree *pWorldTree)
+{
+    ++g_nIntersectCalls;
+	CountAdder cTicks_Intersect(&g_Ticks_Intersect);
+        
+    if (!i_BeginQuery(pQuery))
+    {
+        return false;
+    }
+
+    // Start at the world tree.
+    pWorldTree->IntersectSegment((LTVector*)&pQuery->m_From, (LTVector*)&pQuery->m_To, i_ISCallback, LTNULL);
+
+    return i_EndQuery(pInfo);
+}
+
+
+// -------------------------------------------------------------------------------- //
+// Batched queries.
+// -------------------------------------------------------------------------------- //
+
+class IntersectBatch
+{
+public:
+    IntersectQuery      *m_pQueries;
+    IntersectInfo       *m_pInfos;
+    const WorldTree     *m_pWorldTree;
+
+    // The queries to run, sorted so neighboring rays run one after another.
+    std::vector<uint32> m_Order;
+
+    // Set for each query that hit something.
+    std::vector<uint8>  m_Hits;
+};
+
+
+// Interleaves the bits of x and z.
+static uint32 i_MortonCode(uint32 x, uint32 z)
+{
+    uint32 code = 0;
+    for (uint32 i = 0; i < 14; i++) 
+	{
+        code |= ((x >> i) & 1) << (i * 2);
+        code |= ((z >> i) & 1) << (i * 2 + 1);
+    }
+
+    return code;
+}
+
+
+// Sorts the rays by the direction they go in, then by where they start, so
+// rays that cover the same part of the world run together and find the tree
+// and BSP nodes they need already in the cache.
+static void i_SortBatch(IntersectBatch &batch, uint32 nQueries)
+{
+    const LTVector &vWorldMin = batch.m_pWorldTree->GetRootNode()->GetBBoxMin();
+    const LTVector &vWorldMax = batch.m_pWorldTree->GetRootNode()->GetBBoxMax();
+
+    float fScaleX = (vWorldMax.x > vWorldMin.x) ? 16383.0f / (vWorldMax.x - vWorldMin.x) : 0.0f;
+    float fScaleZ = (vWorldMax.z > vWorldMin.z) ? 16383.0f / (vWorldMax.z - vWorldMin.z) : 0.0f;
+
+    std::vector<std::pair<uint32, uint32> > keys(nQueries);
+    for (uint32 i = 0; i < nQueries; i++) 
+	{
+        const IntersectQuery &query = batch.m_pQueries[i];
+
+        uint32 octant = 
+            ((query.m_To.x < query.m_From.x) ? 1 : 0) |
+            ((query.m_To.y < query.m_From.y) ? 2 : 0) |
+            ((query.m_To.z < query.m_From.z) ? 4 : 0);
+
+        float fX = LTCLAMP((query.m_From.x - vWorldMin.x) * fScaleX, 0.0f, 16383.0f);
+        float fZ = LTCLAMP((query.m_From.z - vWorldMin.z) * fScaleZ, 0.0f, 16383.0f);
+
+        keys[i].first = (octant << 28) | i_MortonCode((uint32)fX, (uint32)fZ);
+        keys[i].second = i;
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    batch.m_Order.resize(nQueries);
+    for (uint32 i = 0; i < nQueries; i++) 
+	{
+        batch.m_Order[i] = keys[i].second;
+    }
+}
+
+
+static void i_RunBatchQuery(IntersectBatch &batch, uint32 iQuery)
+{
+    // Each thread keeps its own scratch space for the world tree.
+    static thread_local WTQueryScratch s_Scratch;
+    static thread_local WTObjArray s_Objects;
+
+    IntersectQuery *pQuery = &batch.m_pQueries[iQuery];
+    IntersectInfo *pInfo = &batch.m_pInfos[iQuery];
+
+    *pInfo = IntersectInfo();
+    batch.m_Hits[iQuery] = false;
+
+    if (!i_BeginQuery(pQuery))
+    {
+        return;
+    }
+
+    batch.m_pWorldTree->CollectObjectsOnSegment(pQuery->m_From, pQuery->m_To, s_Objects, s_Scratch);
+    for (uint32 i = 0; i < s_Objects.size(); i++) 
+	{
+        i_ISCallback(s_Objects[i], LTNULL);
+    }
+
+    batch.m_Hits[iQuery] = i_EndQuery(pInfo);
+}
+
+
+static void i_BatchQueryJob(uint32 iJob, void *pUser)
+{
+    IntersectBatch *pBatch = (IntersectBatch*)pUser;
+    i_RunBatchQuery(*pBatch, pBatch->m_Order[iJob]);
+}
+
+
+uint32 i_IntersectSegmentBatch(IntersectQuery *pQueries, IntersectInfo *pInfos, 
+    uint32 nQueries, uint32 batchFlags, const WorldTree *pWorldTree)
+{
+    if (nQueries == 0) 
+	{
+        return 0;
+    }
+
+    g_nIntersectCalls += nQueries;
+	CountAdder cTicks_Intersect(&g_Ticks_Intersect);
+
+    IntersectBatch batch;
+    batch.m_pQueries = pQueries;
+    batch.m_pInfos = pInfos;
+    batch.m_pWorldTree = pWorldTree;
+    batch.m_Hits.resize(nQueries);
+
+    i_SortBatch(batch, nQueries);
+
+    if (batchFlags & INTERSECTBATCH_THREADED) 
+	{
+        // Model OBB tests pull node transforms out of the model instances,
+        // which isn't safe off this thread, so those queries run here afterwards.
+        std::vector<uint32> localQueries;
+        uint32 nThreaded = 0;
+        for (uint32 i = 0; i < nQueries; i++) 
+		{
+            uint32 iQuery = batch.m_Order[i];
+            if (pQueries[iQuery].m_Flags & INTERSECT_MODELOBBS) 
+			{
+                localQueries.push_back(iQuery);
+            }
+            else 
+			{
+                batch.m_Order[nThreaded++] = iQuery;
+            }
+        }
+
+        // Hand the rays out a few at a time so each thread gets a run of
+        // neighbors.
+        lt_GetJobPool().ParallelFor(nThreaded, i_BatchQueryJob, &batch, 8);
+
+        for (uint32 i = 0; i < localQueries.size(); i++) 
+		{
+            i_RunBatchQuery(batch, localQueries[i]);
+        }
+    }
+    else 
+	{
+        for (uint32 i = 0; i < nQueries; i++) 
+		{
+            i_RunBatchQuery(batch, batch.m_Order[i]);
+        }
+    }
+
+    uint32 nHits = 0;
+    for (uint32 i = 0; i < nQueries; i++) 
+	{
+        nHits += batch.m_Hits[i];
+    }
+
+    return nHits;
+}
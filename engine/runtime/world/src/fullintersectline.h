@@ -7,6 +7,11 @@ bool i_BoundingBoxTest(const LTVector& Point1, const LTVector& Point2, const LTO
     LTVector *pIntersectPt, LTPlane *pIntersectPlane);
 bool i_IntersectSegment(IntersectQuery* pQuery, IntersectInfo *pInfo, WorldTree* pWorldTree);
 
+// Runs a batch of queries (see IntersectSegmentBatch in ILTServer/ILTClient).
+// Returns how many of them hit something.
+uint32 i_IntersectSegmentBatch(IntersectQuery *pQueries, IntersectInfo *pInfos, 
+    uint32 nQueries, uint32 batchFlags, const WorldTree *pWorldTree);
+
 #endif
 
 
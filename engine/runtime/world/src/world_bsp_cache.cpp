@@ -0,0 +1,361 @@
+#include "bdefs.h"
+
+#include "world_bsp_cache.h"
+
+#include <stdio.h>
+#include <vector>
+
+
+#define WORLDCACHE_ID			(('W') | ('B' << 8) | ('S' << 16) | ('C' << 24))
+#define WORLDCACHE_VERSION		1
+
+// Bytes hashed at a time.
+#define WORLDCACHE_HASH_BLOCK	(64 * 1024)
+
+
+// Everything the baked data depends on.  A cache written by a build where
+// any of these differ can't be used.
+struct SWorldCacheLayout
+{
+	uint32	m_nWorldVersion;
+	uint32	m_nPointerSize;
+	uint32	m_nPolySize;
+	uint32	m_nPolyVertexSize;
+	uint32	m_nNodeSize;
+	uint32	m_nSurfaceSize;
+	uint32	m_nPlaneSize;
+	uint32	m_nVertexSize;
+};
+
+struct SWorldCacheHeader
+{
+	uint32				m_nID;
+	uint32				m_nVersion;
+	SWorldCacheLayout	m_Layout;
+	uint64				m_nWorldHash;
+	uint32				m_nWorldModels;
+	uint32				m_nStaticLights;
+};
+
+// Each world model is its flags and the size of its baked bsp, followed by
+// the bsp.  Moveable world models get a second copy of the bsp on load.
+struct SWorldCacheModel
+{
+	uint32	m_nFlags;
+	uint32	m_nBakedSize;
+};
+
+#define WORLDCACHE_MODEL_MOVEABLE	(1<<0)
+
+struct SWorldCacheLight
+{
+	LTVector	m_Pos;
+	float		m_Radius;
+	LTVector	m_Color;
+	LTVector	m_Dir;
+	float		m_FOV;
+	LTVector	m_AttCoefs;
+	float		m_fConvertToAmbient;
+	uint32		m_Flags;
+	uint32		m_nLightGroupID;
+	uint32		m_eAttenuation;
+};
+
+
+static void w_GetWorldCacheLayout(SWorldCacheLayout &layout)
+{
+	memset(&layout, 0, sizeof(layout));
+	layout.m_nWorldVersion		= CURRENT_WORLD_VERSION;
+	layout.m_nPointerSize		= sizeof(void*);
+	layout.m_nPolySize			= sizeof(WorldPoly);
+	layout.m_nPolyVertexSize	= sizeof(SPolyVertex);
+	layout.m_nNodeSize			= sizeof(Node);
+	layout.m_nSurfaceSize		= sizeof(Surface);
+	layout.m_nPlaneSize			= sizeof(LTPlane);
+	layout.m_nVertexSize		= sizeof(Vertex);
+}
+
+static inline uint64 w_MixHash(uint64 nHash, uint64 nValue)
+{
+	nHash ^= nValue * 0x9E3779B97F4A7C15ULL;
+	nHash = (nHash << 31) | (nHash >> 33);
+	return nHash * 0x87C37B91114253D5ULL;
+}
+
+uint64 w_HashWorldFile(ILTStream *pStream)
+{
+	uint32 nStartPos = pStream->GetPos();
+	uint32 nLen = pStream->GetLen();
+
+	std::vector<uint8> block(WORLDCACHE_HASH_BLOCK);
+	uint64 nHash = w_MixHash(0xCBF29CE484222325ULL, nLen);
+
+	pStream->SeekTo(0);
+	for (uint32 nPos=0; nPos < nLen; )
+	{
+		uint32 nRead = LTMIN(nLen - nPos, (uint32)WORLDCACHE_HASH_BLOCK);
+		if (pStream->Read(&block[0], nRead) != LT_OK)
+			break;
+
+		// The last block is padded out with zeros to a whole number of words.
+		uint32 nWords = (nRead + sizeof(uint64) - 1) / sizeof(uint64);
+		memset(&block[nRead], 0, nWords * sizeof(uint64) - nRead);
+
+		for (uint32 i=0; i < nWords; i++)
+		{
+			uint64 nValue;
+			memcpy(&nValue, &block[i * sizeof(uint64)], sizeof(nValue));
+			nHash = w_MixHash(nHash, nValue);
+		}
+
+		nPos += nRead;
+	}
+
+	pStream->SeekTo(nStartPos);
+	return nHash;
+}
+
+// Deletes the world models that have been loaded so far.
+static void w_FreeCachedWorldModels(WorldData **world_models, uint32 num_world_models)
+{
+	for (uint32 i = 0; i < num_world_models; i++)
+	{
+		delete world_models[i];
+		world_models[i] = NULL;
+	}
+}
+
+// Loads a bsp from a baked block, copying the block first if bCopy is set.
+static WorldBsp* w_LoadCachedBsp(char *pBlock, uint32 nSize, bool bCopy, bool bUsePlaneTypes)
+{
+	if (bCopy)
+	{
+		char *pCopy;
+		LT_MEM_TRACK_ALLOC(pCopy = (char*)dalloc(nSize),LT_MEM_TYPE_WORLD);
+		if (!pCopy)
+			return NULL;
+
+		memcpy(pCopy, pBlock, nSize);
+		pBlock = pCopy;
+	}
+
+	WorldBsp *pBsp;
+	LT_MEM_TRACK_ALLOC(pBsp = new WorldBsp,LT_MEM_TYPE_WORLD);
+	if (pBsp->LoadBaked(pBlock, nSize, bUsePlaneTypes) != LoadWorld_Ok)
+	{
+		delete pBsp;
+		return NULL;
+	}
+
+	return pBsp;
+}
+
+bool w_LoadWorldCache(const char *pFilename, uint64 nWorldHash, 
+	WorldData **world_models, uint32 num_world_models, StaticLightListHead &static_lights)
+{
+	uint32 i;
+
+	FILE *fp = fopen(pFilename, "rb");
+	if (!fp)
+		return false;
+
+	fseek(fp, 0, SEEK_END);
+	uint32 nFileSize = (uint32)ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	SWorldCacheHeader header;
+	SWorldCacheLayout layout;
+	w_GetWorldCacheLayout(layout);
+
+	if (fread(&header, sizeof(header), 1, fp) != 1 ||
+		header.m_nID != WORLDCACHE_ID || 
+		header.m_nVersion != WORLDCACHE_VERSION ||
+		memcmp(&header.m_Layout, &layout, sizeof(layout)) != 0 ||
+		header.m_nWorldHash != nWorldHash ||
+		header.m_nWorldModels != num_world_models)
+	{
+		fclose(fp);
+		return false;
+	}
+
+	uint32 nPos = sizeof(header);
+
+	// Each bsp is read straight into the block it's loaded from.
+	for (i = 0; i < num_world_models; i++)
+	{
+		SWorldCacheModel model;
+		if (fread(&model, sizeof(model), 1, fp) != 1)
+			break;
+
+		nPos += sizeof(model);
+		if (model.m_nBakedSize > nFileSize - nPos)
+			break;
+
+		char *pBlock;
+		LT_MEM_TRACK_ALLOC(pBlock = (char*)dalloc(model.m_nBakedSize),LT_MEM_TYPE_WORLD);
+		if (!pBlock)
+			break;
+
+		if (fread(pBlock, model.m_nBakedSize, 1, fp) != 1)
+		{
+			dfree(pBlock);
+			break;
+		}
+
+		nPos += model.m_nBakedSize;
+
+		WorldData *world_model;
+		LT_MEM_TRACK_ALLOC(world_model = world_models[i] = new WorldData,LT_MEM_TYPE_WORLD);
+
+		//moveable world models get a copy to transform, which is loaded
+		//first so the original block is still intact.
+		if (model.m_nFlags & WORLDCACHE_MODEL_MOVEABLE)
+		{
+			world_model->m_pWorldBsp = w_LoadCachedBsp(pBlock, model.m_nBakedSize, true, false);
+			world_model->m_Flags |= WD_WORLDBSPALLOCED;
+			if (!world_model->m_pWorldBsp)
+			{
+				dfree(pBlock);
+				break;
+			}
+		}
+
+		WorldBsp *loaded_bsp = w_LoadCachedBsp(pBlock, model.m_nBakedSize, false, true);
+		world_model->SetOriginalBSP(loaded_bsp);
+		world_model->m_Flags |= WD_ORIGINALBSPALLOCED;
+		if (!loaded_bsp)
+			break;
+
+		world_model->SetValidBsp();
+
+		world_model->OriginalBSP()->m_Index = (uint16)i;
+		if (world_model->m_pWorldBsp)
+			world_model->m_pWorldBsp->m_Index = (uint16)i;
+	}
+
+	// The lights fill the rest of the file.
+	bool bOk = (i == num_world_models) && 
+		(nPos + sizeof(SWorldCacheLight) * header.m_nStaticLights == nFileSize);
+
+	std::vector<SWorldCacheLight> lights;
+	if (bOk && header.m_nStaticLights > 0)
+	{
+		lights.resize(header.m_nStaticLights);
+		bOk = fread(&lights[0], sizeof(SWorldCacheLight), lights.size(), fp) == lights.size();
+	}
+
+	fclose(fp);
+
+	if (!bOk)
+	{
+		w_FreeCachedWorldModels(world_models, num_world_models);
+		return false;
+	}
+
+	// Lights are added to the front of the list, so go backwards to end up
+	// with them in the order they were saved in.
+	for (i = (uint32)lights.size(); i > 0; i--)
+	{
+		const SWorldCacheLight &cached = lights[i - 1];
+
+		StaticLightListElement *element;
+		LT_MEM_TRACK_ALLOC(element = new StaticLightListElement,LT_MEM_TYPE_WORLD);
+
+		StaticLight &light = element->Item();
+		light.m_Pos					= cached.m_Pos;
+		light.m_Radius				= cached.m_Radius;
+		light.m_Color				= cached.m_Color;
+		light.m_Dir					= cached.m_Dir;
+		light.m_FOV					= cached.m_FOV;
+		light.m_AttCoefs			= cached.m_AttCoefs;
+		light.m_fConvertToAmbient	= cached.m_fConvertToAmbient;
+		light.m_Flags				= cached.m_Flags;
+		light.m_nLightGroupID		= cached.m_nLightGroupID;
+		light.m_eAttenuation		= (ELightAttenuationType)cached.m_eAttenuation;
+
+		light.UpdateBBox(light.m_Pos, LTVector(light.m_Radius, light.m_Radius, light.m_Radius));
+
+		static_lights.Add(element);
+	}
+
+	return true;
+}
+
+bool w_SaveWorldCache(const char *pFilename, uint64 nWorldHash, 
+	WorldData **world_models, uint32 num_world_models, StaticLightListHead &static_lights)
+{
+	uint32 i;
+
+	SWorldCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	header.m_nID			= WORLDCACHE_ID;
+	header.m_nVersion		= WORLDCACHE_VERSION;
+	header.m_nWorldHash		= nWorldHash;
+	header.m_nWorldModels	= num_world_models;
+	w_GetWorldCacheLayout(header.m_Layout);
+
+	StaticLightListElement *element;
+	for (element = static_lights.First(); !static_lights.IsHead(element); element = element->Next())
+		header.m_nStaticLights++;
+
+	// Write to a temporary file and move it into place once it's complete, so
+	// a partly written cache is never picked up.
+	char szTempName[512];
+	LTSNPrintF(szTempName, sizeof(szTempName), "%s.tmp", pFilename);
+
+	FILE *fp = fopen(szTempName, "wb");
+	if (!fp)
+		return false;
+
+	bool bOk = fwrite(&header, sizeof(header), 1, fp) == 1;
+
+	std::vector<char> baked;
+	for (i = 0; i < num_world_models && bOk; i++)
+	{
+		const WorldBsp *pBsp = world_models[i]->OriginalBSP();
+
+		SWorldCacheModel model;
+		model.m_nFlags		= world_models[i]->m_pWorldBsp ? WORLDCACHE_MODEL_MOVEABLE : 0;
+		model.m_nBakedSize	= pBsp->GetBakedSize();
+
+		baked.resize(model.m_nBakedSize);
+		pBsp->Bake(&baked[0]);
+
+		bOk = fwrite(&model, sizeof(model), 1, fp) == 1 &&
+			fwrite(&baked[0], model.m_nBakedSize, 1, fp) == 1;
+	}
+
+	for (element = static_lights.First(); !static_lights.IsHead(element) && bOk; element = element->Next())
+	{
+		const StaticLight &light = element->Item();
+
+		SWorldCacheLight cached;
+		memset(&cached, 0, sizeof(cached));
+		cached.m_Pos				= light.m_Pos;
+		cached.m_Radius				= light.m_Radius;
+		cached.m_Color				= light.m_Color;
+		cached.m_Dir				= light.m_Dir;
+		cached.m_FOV				= light.m_FOV;
+		cached.m_AttCoefs			= light.m_AttCoefs;
+		cached.m_fConvertToAmbient	= light.m_fConvertToAmbient;
+		cached.m_Flags				= light.m_Flags;
+		cached.m_nLightGroupID		= light.m_nLightGroupID;
+		cached.m_eAttenuation		= (uint32)light.m_eAttenuation;
+
+		bOk = fwrite(&cached, sizeof(cached), 1, fp) == 1;
+	}
+
+	if (fclose(fp) != 0)
+		bOk = false;
+
+	if (bOk)
+	{
+		remove(pFilename);
+		bOk = rename(szTempName, pFilename) == 0;
+	}
+
+	if (!bOk)
+		remove(szTempName);
+
+	return bOk;
+}
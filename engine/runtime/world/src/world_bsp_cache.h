@@ -0,0 +1,32 @@
+//////////////////////////////////////////////////////////////////////////////
+// The baked world cache.  This holds a world's BSPs (with their bounding
+// spheres already worked out) and its static lights in a form that loads with
+// a read per BSP and a pass to turn offsets back into pointers, instead of
+// being rebuilt from the world file.  It's written after a world has been
+// loaded the long way and is keyed by a hash of the world file, so it's
+// thrown away as soon as the world changes.
+
+#ifndef __WORLD_BSP_CACHE_H__
+#define __WORLD_BSP_CACHE_H__
+
+#ifndef __WORLD_SHARED_BSP_H__
+#include "world_shared_bsp.h"
+#endif
+
+
+// Hashes a whole world file, leaving the stream where it was.
+uint64 w_HashWorldFile(ILTStream *pStream);
+
+// Fills in world_models (num_world_models entries, all null) and static_lights
+// from a cache file.  Returns false, leaving them as they were, if there's no
+// cache, it's for a different version of the world, or it was written by a
+// build with a different memory layout.
+bool w_LoadWorldCache(const char *pFilename, uint64 nWorldHash, 
+	WorldData **world_models, uint32 num_world_models, StaticLightListHead &static_lights);
+
+// Writes a cache file for the loaded world models and static lights.
+bool w_SaveWorldCache(const char *pFilename, uint64 nWorldHash, 
+	WorldData **world_models, uint32 num_world_models, StaticLightListHead &static_lights);
+
+
+#endif  // __WORLD_BSP_CACHE_H__
@@ -28,8 +28,9 @@ class IWorldServerBSP : public IWorldServer {
     //deletes everything we have alloctated.
     virtual void Term() = 0;
 
-    //loads the world.
-    virtual ELoadWorldStatus Load(ILTStream *pStream) = 0;
+    //loads the world.  pCacheFilename is where to keep the baked world
+    //cache, or NULL not to use it.
+    virtual ELoadWorldStatus Load(ILTStream *pStream, const char *pCacheFilename = NULL) = 0;
 
     //returns true if server world is loaded.
     virtual bool IsLoaded() = 0;
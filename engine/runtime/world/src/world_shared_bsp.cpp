@@ -11,6 +11,7 @@
 #include "world_blind_object_data.h"
 #include "ltproperty.h"
 #include "strtools.h"
+#include "world_bsp_cache.h"
 
 //----------------------------------------------------------------------
 //
@@ -40,7 +41,7 @@ public:
     //
     void Term();
     ELoadWorldStatus Load(ILTStream *pStream, WorldTree &world_tree, 
-        WorldData **&world_models, uint32 &num_world_models);
+        WorldData **&world_models, uint32 &num_world_models, const char *pCacheFilename);
     bool InitWorldModel(WorldData **&world_models, uint32 &num_world_models, 
         WorldModelInstance *instance, const char *world_name);
     WorldData *GetWorldDataFromHPoly(WorldData **&world_models, uint32 &num_world_models, HPOLY hPoly);
@@ -54,6 +55,9 @@ public:
     //Calculate bounding spheres for polies and leaves of the given worldmodels.
     void CalcBoundingSpheres(WorldData **&world_models, uint32 &num_world_models);
 
+    //Loads the world models from the world file.
+    ELoadWorldStatus LoadWorldModels(ILTStream *pStream, WorldData **&world_models, uint32 &num_world_models);
+
     void LoadLightGrid(ILTStream *pStream);
     void AddStaticLights(ILTStream* pStream);
 
@@ -142,7 +146,7 @@ void CWorldSharedBSP::Term() {
 }
 
 ELoadWorldStatus CWorldSharedBSP::Load(ILTStream *pStream, WorldTree &world_tree,
-    WorldData **&world_models, uint32 &num_world_models) 
+    WorldData **&world_models, uint32 &num_world_models, const char *pCacheFilename) 
 {
     uint32 i; // loop counter
 
@@ -207,6 +211,99 @@ ELoadWorldStatus CWorldSharedBSP::Load(ILTStream *pStream, WorldTree &world_tree
         return LoadWorld_Error;
     }
 
+    //the cache is keyed by the contents of the world file.
+    uint64 world_hash = 0;
+    bool loaded_from_cache = false;
+    if (pCacheFilename)
+	{
+        world_hash = w_HashWorldFile(pStream);
+        loaded_from_cache = w_LoadWorldCache(pCacheFilename, world_hash, 
+            world_models, num_world_models, static_light_list);
+    }
+
+    if (!loaded_from_cache)
+	{
+        ELoadWorldStatus loadmodels_status = LoadWorldModels(pStream, world_models, num_world_models);
+        if (loadmodels_status != LoadWorld_Ok)
+            return loadmodels_status;
+    }
+
+    //
+    //Precalculate stuff.
+    //
+
+    //get our ambient light from the info string.
+    LTVector ambient_light;
+    ParseAmbientLight(world_info_string, &ambient_light);
+
+    //the cache already has these worked out.
+    if (!loaded_from_cache)
+	{
+        //Figure out world model leaf spheres..
+        CalcBoundingSpheres(world_models, num_world_models);
+
+        //Gen our list of static lights...
+        AddStaticLights(pStream);
+
+        //save them for next time.
+        if (pCacheFilename)
+		{
+            w_SaveWorldCache(pCacheFilename, world_hash, 
+                world_models, num_world_models, static_light_list);
+        }
+    }
+
+    //insert the static light objects into the given world tree.
+    InsertStaticLights(world_tree);
+
+	// Read in the lightgrid...
+	pStream->SeekTo(lightgrid_pos);
+	LoadLightGrid(pStream);
+
+	// Read the blocker data
+	pStream->SeekTo( collision_data_pos );
+	ASSERT(g_iWorldBlockerData);
+	ELoadWorldStatus eResult = g_iWorldBlockerData->Load(pStream);
+	if (eResult != LoadWorld_Ok)
+	{
+		Term();
+		return eResult;
+	}
+
+	// Read the particle blocker data
+	pStream->SeekTo( particle_blocker_data_pos );
+	ASSERT(g_iWorldParticleBlockerData);
+	eResult = g_iWorldParticleBlockerData->Load(pStream);
+	if( eResult != LoadWorld_Ok )
+	{
+		Term();
+		return eResult;
+	}
+
+	//////////////////////////////////////////////////////////
+	//read in the rendering data
+	pStream->SeekTo( render_data_pos );
+	if (!LoadRenderData(pStream))
+	{
+		Term();
+		return LoadWorld_Error;
+	}
+
+    //See if there were errors.
+    if (pStream->ErrorStatus() != LT_OK) {
+        Term();
+        return LoadWorld_InvalidFile;
+    }
+
+    //loaded everything ok.
+    return LoadWorld_Ok;
+}
+
+ELoadWorldStatus CWorldSharedBSP::LoadWorldModels(ILTStream *pStream, 
+    WorldData **&world_models, uint32 &num_world_models)
+{
+    uint32 i; // loop counter
+
     //read in each worldmodel.
     for (i = 0; i < num_world_models; i++)
 	{
@@ -298,62 +395,6 @@ ELoadWorldStatus CWorldSharedBSP::Load(ILTStream *pStream, WorldTree &world_tree
         }
     }
 
-    //
-    //Precalculate stuff.
-    //
-
-    //get our ambient light from the info string.
-    LTVector ambient_light;
-    ParseAmbientLight(world_info_string, &ambient_light);
-
-    //Figure out world model leaf spheres..
-    CalcBoundingSpheres(world_models, num_world_models);
-
-    //Gen our list of static lights...
-    AddStaticLights(pStream);
-
-    //insert the static light objects into the given world tree.
-    InsertStaticLights(world_tree);
-
-	// Read in the lightgrid...
-	pStream->SeekTo(lightgrid_pos);
-	LoadLightGrid(pStream);
-
-	// Read the blocker data
-	pStream->SeekTo( collision_data_pos );
-	ASSERT(g_iWorldBlockerData);
-	ELoadWorldStatus eResult = g_iWorldBlockerData->Load(pStream);
-	if (eResult != LoadWorld_Ok)
-	{
-		Term();
-		return eResult;
-	}
-
-	// Read the particle blocker data
-	pStream->SeekTo( particle_blocker_data_pos );
-	ASSERT(g_iWorldParticleBlockerData);
-	eResult = g_iWorldParticleBlockerData->Load(pStream);
-	if( eResult != LoadWorld_Ok )
-	{
-		Term();
-		return eResult;
-	}
-
-	//////////////////////////////////////////////////////////
-	//read in the rendering data
-	pStream->SeekTo( render_data_pos );
-	if (!LoadRenderData(pStream))
-	{
-		Term();
-		return LoadWorld_Error;
-	}
-
-    //See if there were errors.
-    if (pStream->ErrorStatus() != LT_OK) {
-        Term();
-        return LoadWorld_InvalidFile;
-    }
-
     //loaded everything ok.
     return LoadWorld_Ok;
 }
@@ -410,6 +451,63 @@ bool IWorldSharedBSP::ReadWorldHeader
 	return true;
 }
 
+// Reads the world the same way CWorldSharedBSP::Load does, up to the end of
+// the world models, without setting up anything else.
+ELoadWorldStatus IWorldSharedBSP::BenchmarkBspLoad(ILTStream *pStream, WorldBspLoadTimes &times)
+{
+    uint32 file_version, object_data_pos, blind_object_data_pos, lightgrid_pos;
+    uint32 collision_data_pos, particle_blocker_data_pos, render_data_pos;
+    if (!ReadWorldHeader(pStream, file_version,
+						object_data_pos,
+						blind_object_data_pos,
+						lightgrid_pos,
+						collision_data_pos,
+						particle_blocker_data_pos,
+						render_data_pos))
+    {
+        return LoadWorld_InvalidVersion;
+    }
+
+    //skip the world info string, the extents and the offset.
+    uint32 str_length;
+    STREAM_READ(str_length);
+    pStream->SeekTo(pStream->GetPos() + str_length + sizeof(LTVector) * 3);
+
+    WorldTree world_tree;
+    if (!world_tree.LoadLayout(pStream)) {
+        return LoadWorld_Error;
+    }
+
+    uint32 num_world_models = 0;
+    STREAM_READ(num_world_models);
+
+    for (uint32 i = 0; i < num_world_models; i++)
+	{
+        uint32 nDummy;
+        *pStream >> nDummy;
+
+        uint32 start_position = pStream->GetPos();
+
+        WorldBsp loaded_bsp;
+        ELoadWorldStatus loadbsp_status = loaded_bsp.Load(pStream, true, &times);
+        if (loadbsp_status != LoadWorld_Ok)
+            return loadbsp_status;
+
+        //moveable bsps get loaded a second time.
+        if (loaded_bsp.m_WorldInfoFlags & WIF_MOVEABLE)
+		{
+            pStream->SeekTo(start_position);
+
+            WorldBsp moveable_bsp;
+            loadbsp_status = moveable_bsp.Load(pStream, false, &times);
+            if (loadbsp_status != LoadWorld_Ok)
+                return loadbsp_status;
+        }
+    }
+
+    return LoadWorld_Ok;
+}
+
 void CWorldSharedBSP::CalcBoundingSpheres(WorldData **&world_models, uint32 &num_world_models) {
     //go through all the worldmodels.
     for (uint32 i = 0; i < num_world_models; i++) {
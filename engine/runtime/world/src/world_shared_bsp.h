@@ -58,9 +58,11 @@ public:
     //cleans up anything we have lying around.
     virtual void Term() = 0;
 
-    //loads a world
+    //loads a world.  If pCacheFilename is set, the world models and static
+    //lights are loaded from the baked world cache there if it's up to date,
+    //and the cache is written out if it isn't.
     virtual ELoadWorldStatus Load(ILTStream *pStream, WorldTree &world_tree,
-        WorldData **&world_models, uint32 &num_world_models) = 0;
+        WorldData **&world_models, uint32 &num_world_models, const char *pCacheFilename = NULL) = 0;
 
     //Calls pInstance->InitWorldModel with WorldBsp either from WorldDatas or TerrainSection.
     virtual bool InitWorldModel(WorldData **&world_models, uint32 &num_world_models, 
@@ -87,6 +89,10 @@ public:
         uint32 &objectDataPos, uint32& blindObjectDataPos, uint32& lightgrid_pos,
 		uint32 &collisionDataPos, uint32 &particleBlockerDataPos, uint32 &renderDataPos);
 
+    //Loads every bsp in a world file and throws them away, adding the time
+    //spent in each section of WorldBsp::Load to times.
+    static ELoadWorldStatus BenchmarkBspLoad(ILTStream *pStream, WorldBspLoadTimes &times);
+
     static WorldData *FindWorldModel(WorldData **&world_models, uint32 &num_world_models, const char *name);
 
 
@@ -5,6 +5,14 @@
 
 #include "worldtreehelper.h"
 
+#include <float.h>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WORLDTREE_SSE 1
+#endif
+
 
 // Used by some of the recursive routines.
 typedef void (*FilterFn_R)(WorldTreeNode *pNode, void *pData);
@@ -22,19 +30,6 @@ public:
 };
 
 
-class ISInfo
-{
-public:
-	WorldTree		*m_pTree;
-	NodeObjArray	m_iObjArray;
-	LTVector		m_Pts[2];
-	ISCallback		m_CB;
-	void			*m_pCBUser;
-};
-
-
-static bool IntersectSegment_R(WorldTreeNode *pNode, ISInfo *pInfo);
-
 // -------------------------------------------------------------------------------- //
 // WorldTree internal helpers.
 // -------------------------------------------------------------------------------- //
@@ -107,6 +102,42 @@ inline bool DoBoxesTouch(	const LTVector& vMin1, const LTVector& vMax1,
 }
 
 
+#ifdef WORLDTREE_SSE
+
+// The object tests load the object's box as two overlapping quads, 
+// (min.x min.y min.z max.x) and (min.z max.x max.y max.z).
+static_assert(sizeof(LTVector) == sizeof(float) * 3, "WorldTreeObj box must be packed floats");
+
+// The query box, set up to test against those two quads.
+struct SSEQueryBox
+{
+	__m128	m_vMaxA;	// Max x, y, z and +inf.
+	__m128	m_vMinA;	// -inf, -inf, -inf and min x.
+	__m128	m_vMinB;	// -inf, -inf, min y and min z.
+};
+
+inline void SetupSSEQueryBox(SSEQueryBox &box, const LTVector &vMin, const LTVector &vMax)
+{
+	box.m_vMaxA = _mm_setr_ps(vMax.x, vMax.y, vMax.z, FLT_MAX);
+	box.m_vMinA = _mm_setr_ps(-FLT_MAX, -FLT_MAX, -FLT_MAX, vMin.x);
+	box.m_vMinB = _mm_setr_ps(-FLT_MAX, -FLT_MAX, vMin.y, vMin.z);
+}
+
+// Same as DoBoxesTouch.
+inline bool DoesObjTouchBox(const WorldTreeObj *pObj, const SSEQueryBox &box)
+{
+	const float *pBox = &pObj->m_MinBox.x;
+	__m128 vA = _mm_loadu_ps(pBox);
+	__m128 vB = _mm_loadu_ps(pBox + 2);
+
+	__m128 vOut = _mm_or_ps(_mm_cmpgt_ps(vA, box.m_vMaxA), _mm_cmplt_ps(vA, box.m_vMinA));
+	vOut = _mm_or_ps(vOut, _mm_cmplt_ps(vB, box.m_vMinB));
+	return _mm_movemask_ps(vOut) == 0;
+}
+
+#endif
+
+
 // Returns true if the line segment from pt0 to pt1 is outside of the bounding
 // box in the dimension specified by iDim.
 inline bool IsSegmentDimOutsideBox(	const LTVector &pt0, const LTVector &pt1, 
@@ -133,45 +164,6 @@ inline PolySide GetDimBoxStatus(const LTVector &pt0, const LTVector &pt1,
 }
 
 
-// Filters the box down the tree and calls the callback for any objects
-// that the box touches.
-static void FindObjectsInBox_R(WorldTreeNode *pNode, FindObjInfo *pInfo)
-{
-	// Check objects sitting on this node.	
-	if(pNode->GetNumObjectsOnOrBelow() == 0)
-		return;
-
-	LTLink *pCur, *pListHead;
-	WorldTreeObj *pObj;
-
-	pListHead = pNode->m_Objects[pInfo->m_iObjArray].AsLTLink();
-	for(pCur=pListHead->m_pNext; pCur != pListHead;)
-	{
-		pObj = (WorldTreeObj*)pCur->m_pData;
-
-		// KEF - 04/03/00 - Increment the link pointer here in case this link goes away in the callback
-		pCur = pCur->m_pNext;
-	
-		// Check the frame code.
-		if(pObj->m_WTFrameCode == pInfo->m_pTree->GetTempFrameCode())
-			continue;
-
-		pObj->m_WTFrameCode = pInfo->m_pTree->GetTempFrameCode();
-
-		// Do the boxes intersect?
-		if(DoBoxesTouch(pObj->GetBBoxMin(), pObj->GetBBoxMax(), pInfo->m_Min, pInfo->m_Max))
-		{
-			pInfo->m_CB(pObj, pInfo->m_pCBUser);
-		}
-	}
-
-	// Recurse into appropriate nodes.
-	if(pNode->HasChildren())
-	{
-		FilterBox(&pInfo->m_Min, &pInfo->m_Max, pNode, (FilterFn_R)FindObjectsInBox_R, pInfo);
-	}
-}
-
 // Intersects the line segment in the specified dimension on fPlane's plane, 
 // then sees if the intersection point is inside the box on iOtherDim1 and iOtherDim2.
 inline bool TestBoxPlane(	const LTVector &pt1, 
@@ -222,97 +214,35 @@ static bool TestBoxBothSides(	const LTVector &pt1,
 }
 
 
-// Does tests to see if the segment intersects the node.  If so, calls IntersectSegment_R
-// on it and returns the value.
-static bool TestNode(WorldTreeNode *pNode, ISInfo *pInfo)
+// Returns true if the segment intersects the node in X and Z.
+static bool DoesSegmentTouchNode(const LTVector &pt0, const LTVector &pt1, const WorldTreeNode *pNode)
 {
 	PolySide outStatus;
 
 	// Trivial accept.
-	if(base_IsPtInBoxXZ(&pInfo->m_Pts[0], &pNode->GetBBoxMin(), &pNode->GetBBoxMax()) ||
-		base_IsPtInBoxXZ(&pInfo->m_Pts[1], &pNode->GetBBoxMin(), &pNode->GetBBoxMax()))
+	if(base_IsPtInBoxXZ(&pt0, &pNode->GetBBoxMin(), &pNode->GetBBoxMax()) ||
+		base_IsPtInBoxXZ(&pt1, &pNode->GetBBoxMin(), &pNode->GetBBoxMax()))
 	{
-		return IntersectSegment_R(pNode, pInfo);
+		return true;
 	}
-	else
+
+	// If both points are outside on the same side, then the line is outside.
+	outStatus = GetDimBoxStatus(pt0, pt1, pNode->GetBBoxMin(), pNode->GetBBoxMax(), 0);
+	if(outStatus != Intersect)
 	{
-		// If both points are outside on the same side, then the line is outside.
-		outStatus = GetDimBoxStatus(pInfo->m_Pts[0], pInfo->m_Pts[1], pNode->GetBBoxMin(), pNode->GetBBoxMax(), 0);
-		if(outStatus != Intersect)
+		if(outStatus == GetDimBoxStatus(pt0, pt1, pNode->GetBBoxMin(), pNode->GetBBoxMax(), 2))
 		{
-			if(outStatus == GetDimBoxStatus(pInfo->m_Pts[0], pInfo->m_Pts[1], pNode->GetBBoxMin(), pNode->GetBBoxMax(), 2))
-			{
-				// Trivial reject.
-				return false;
-			}
-		}
-		
-		// Allllllllllll-righty, we'll do the extensive test!
-		if(TestBoxBothSides(pInfo->m_Pts[0], pInfo->m_Pts[1], pNode->GetBBoxMin(), pNode->GetBBoxMax(), 0, 2) ||
-			TestBoxBothSides(pInfo->m_Pts[0], pInfo->m_Pts[1], pNode->GetBBoxMin(), pNode->GetBBoxMax(), 2, 0))
-		{
-			return IntersectSegment_R(pNode, pInfo);
+			// Trivial reject.
+			return false;
 		}
 	}
-
-	return false;
-}
-
-
-// Filters the line segment down the tree and calls the callback for objects
-// in nodes that the line segment intersects.
-
-// Returns true if it tested all subnodes and an object was hit (ie: it should
-// return true up the stack and terminate early thus avoid tons of tests).
-static bool IntersectSegment_R(WorldTreeNode *pNode, ISInfo *pInfo)
-{
-	LTLink *pCur, *pListHead;
-	LTVector vMin, vMax;
-	WorldTreeObj *pObj;
-	bool bIntersected;
-	int iX, iZ;
-
-
-	bIntersected = false;
-
-	// Visit objects in this node.
-	pListHead = pNode->m_Objects[pInfo->m_iObjArray].AsLTLink();
-	for(pCur=pListHead->m_pNext; pCur != pListHead;)
-	{
-		pObj = (WorldTreeObj*)pCur->m_pData;
-
-		// KEF - 04/03/00 - Increment the link pointer here in case this link goes away in the callback
-		pCur = pCur->m_pNext;
 	
-		// Check the frame code.
-		if(pObj->m_WTFrameCode == pInfo->m_pTree->GetTempFrameCode())
-			continue;
-
-		pObj->m_WTFrameCode = pInfo->m_pTree->GetTempFrameCode();
-		bIntersected |= pInfo->m_CB(pObj, pInfo->m_pCBUser);
-	}
-
-	// Recurse into child nodes.
-	if(pNode->HasChildren())
-	{
-		// Test in front to back order.  Node: it should be possible to remove one of these
-		// calls because the segment can only cross 3 of the nodes so
-		// we could test the front one, the diagonal one it intersects, and the back one.
-		iX = pInfo->m_Pts[0].x > pNode->GetCenterX();
-		iZ = pInfo->m_Pts[0].z > pNode->GetCenterZ();
-		
-		bool bResult = TestNode(pNode->GetChild(iX, iZ), pInfo);
-		bResult |= TestNode(pNode->GetChild(!iX, iZ), pInfo);
-		bResult |= TestNode(pNode->GetChild(iX, !iZ), pInfo);
-		bResult |= TestNode(pNode->GetChild(!iX, !iZ), pInfo);
-
-		if (bResult)
-			return true;
-	}
-
-	return bIntersected;
+	// Allllllllllll-righty, we'll do the extensive test!
+	return TestBoxBothSides(pt0, pt1, pNode->GetBBoxMin(), pNode->GetBBoxMax(), 0, 2) ||
+		TestBoxBothSides(pt0, pt1, pNode->GetBBoxMin(), pNode->GetBBoxMax(), 2, 0);
 }
 
+
 // -------------------------------------------------------------------------------- //
 // WorldTreeObj.
 // -------------------------------------------------------------------------------- //
@@ -329,6 +259,8 @@ WorldTreeObj::WorldTreeObj(WTObjType objType)
 		pLink->m_Link.TieOff();
 		pLink->m_Link.m_pData = this;
 		pLink->m_pNode = NULL;
+		pLink->m_iNodeArray = NOA_Objects;
+		pLink->m_iNodeSlot = 0;
 	}
 
 	m_ObjType = objType;
@@ -378,6 +310,7 @@ void WorldTreeNode::Clear()
 	for(uint32 i=0; i < NUM_NODEOBJ_ARRAYS; i++)
 	{
 		m_Objects[i].TieOff();
+		m_ObjectArrays[i].clear();
 	}
 
 	m_nObjectsOnOrBelow = 0;
@@ -408,6 +341,35 @@ void WorldTreeNode::RemoveLink(WTObjLink* pLink)
 {
 	pLink->m_Link.Remove();
 	pLink->m_Link.TieOff();
+
+	// Take it out of the node's object array by moving the last object into its slot
+	if(pLink->m_pNode)
+	{
+		WorldTreeNode *pNode = pLink->m_pNode;
+		WTObjArray &objects = pNode->m_ObjectArrays[pLink->m_iNodeArray];
+		WorldTreeObj *pLast = objects.back();
+
+		assert(pLink->m_iNodeSlot < objects.size());
+		assert(objects[pLink->m_iNodeSlot] == (WorldTreeObj*)pLink->m_Link.m_pData);
+
+		if(pLast != objects[pLink->m_iNodeSlot])
+		{
+			objects[pLink->m_iNodeSlot] = pLast;
+
+			//find the last object's link to this node so its slot can be updated
+			for(uint32 i=0; i < MAX_OBJ_NODE_LINKS; i++)
+			{
+				WTObjLink *pLastLink = &pLast->m_Links[i];
+				if(pLastLink->m_pNode == pNode && pLastLink->m_iNodeArray == pLink->m_iNodeArray)
+				{
+					pLastLink->m_iNodeSlot = pLink->m_iNodeSlot;
+					break;
+				}
+			}
+		}
+
+		objects.pop_back();
+	}
 		
 	// Remove references from this node all the way up the tree
 	while(pLink->m_pNode)
@@ -520,6 +482,10 @@ void WorldTreeNode::AddObjectToList(WTObjLink *pLink, NodeObjArray iArray)
 
 	dl_Insert(&m_Objects[iArray], &pLink->m_Link);
 	pLink->m_pNode = this;
+
+	pLink->m_iNodeArray = iArray;
+	pLink->m_iNodeSlot = (uint32)m_ObjectArrays[iArray].size();
+	m_ObjectArrays[iArray].push_back((WorldTreeObj*)pLink->m_Link.m_pData);
 	
 	// Add a reference to all the nodes above here.
 	pTempNode = this;
@@ -539,14 +505,29 @@ void WorldTreeNode::AddObjectToList(WTObjLink *pLink, NodeObjArray iArray)
 WorldTree::WorldTree() :
 	m_pHelper(NULL),
 	m_pNodes(NULL),
-	m_nNumNodes(1)
+	m_nNumNodes(1),
+	m_pFilterMinX(NULL),
+	m_pFilterMaxX(NULL),
+	m_pFilterMinZ(NULL),
+	m_pFilterMaxZ(NULL),
+	m_pFirstChild(NULL),
+	m_nQueryDepth(0)
 {
 	m_AlwaysVisObjects.TieOff();
+	m_NodeStack.resize(MAX_WTNODE_CHILDREN);
 }
 
 WorldTree::~WorldTree()
 {
 	Term();
+
+	//there shouldn't be any queries still going on
+	assert(m_nQueryDepth == 0);
+	for(uint32 i=0; i < m_QueryArrays.size(); i++)
+	{
+		delete m_QueryArrays[i];
+	}
+	m_QueryArrays.clear();
 }
 
 void WorldTree::InitWorldTree(WorldTreeHelper *pHelper)
@@ -564,6 +545,8 @@ void WorldTree::Term()
 	delete [] m_pNodes;
 	m_pNodes = NULL;
 
+	FreeNodeArrays();
+
 	//clear out the number of nodes
 	m_nNumNodes = 1;
 
@@ -619,12 +602,114 @@ void WorldTree::FindObjectsInBox(const LTVector *pMin, const LTVector *pMax,
 
 
 void WorldTree::FindObjectsInBox2(FindObjInfo *pInfo)
+{
+	pInfo->m_pTree = this;
+
+	WTQueryArray objects(this);
+	CollectObjectsInBox(pInfo->m_Min, pInfo->m_Max, objects.Get(), pInfo->m_iObjArray);
+
+	for(uint32 i=0; i < objects.Get().size(); i++)
+	{
+		pInfo->m_CB(objects.Get()[i], pInfo->m_pCBUser);
+	}
+}
+
+
+uint32 WorldTree::CollectObjectsInBox(const LTVector &vMin, const LTVector &vMax, 
+	WTObjArray &objects, NodeObjArray iArray)
 {
 	ASSERT(m_pHelper);
 	m_nTempFrameCode = m_pHelper->IncFrameCode();
 
-	pInfo->m_pTree = this;
-	FindObjectsInBox_R(&m_RootNode, pInfo);
+	objects.clear();
+
+#ifdef WORLDTREE_SSE
+	SSEQueryBox sseBox;
+	SetupSSEQueryBox(sseBox, vMin, vMax);
+
+	__m128 vQueryMinX = _mm_set1_ps(vMin.x);
+	__m128 vQueryMaxX = _mm_set1_ps(vMax.x);
+	__m128 vQueryMinZ = _mm_set1_ps(vMin.z);
+	__m128 vQueryMaxZ = _mm_set1_ps(vMax.z);
+#endif
+
+	uint32 *pStack = &m_NodeStack[0];
+	uint32 nStack = 0;
+	pStack[nStack++] = 0;
+
+	while(nStack)
+	{
+		uint32 iNode = pStack[--nStack];
+		WorldTreeNode *pNode = GetNode(iNode);
+
+		if(pNode->GetNumObjectsOnOrBelow() == 0)
+			continue;
+
+		// Check objects sitting on this node, newest first like the list.
+		const WTObjArray &nodeObjects = pNode->m_ObjectArrays[iArray];
+		for(uint32 i=(uint32)nodeObjects.size(); i > 0; i--)
+		{
+			WorldTreeObj *pObj = nodeObjects[i - 1];
+
+			// Check the frame code.
+			if(pObj->m_WTFrameCode == m_nTempFrameCode)
+				continue;
+
+			pObj->m_WTFrameCode = m_nTempFrameCode;
+
+			// Do the boxes intersect?
+#ifdef WORLDTREE_SSE
+			if(DoesObjTouchBox(pObj, sseBox))
+#else
+			if(DoBoxesTouch(pObj->GetBBoxMin(), pObj->GetBBoxMax(), vMin, vMax))
+#endif
+			{
+				objects.push_back(pObj);
+			}
+		}
+
+		if(!pNode->HasChildren())
+			continue;
+
+		// Find which children the box falls into.  This is the same as the
+		// center split tests in FilterBox since the filter bounds of the children 
+		// meet at the center.
+		uint32 iFirstChild = m_pFirstChild[iNode];
+		uint32 childMask;
+
+#ifdef WORLDTREE_SSE
+		__m128 vIn = _mm_and_ps(
+			_mm_cmplt_ps(vQueryMinX, _mm_loadu_ps(&m_pFilterMaxX[iFirstChild])),
+			_mm_cmpgt_ps(vQueryMaxX, _mm_loadu_ps(&m_pFilterMinX[iFirstChild])));
+		vIn = _mm_and_ps(vIn, _mm_and_ps(
+			_mm_cmplt_ps(vQueryMinZ, _mm_loadu_ps(&m_pFilterMaxZ[iFirstChild])),
+			_mm_cmpgt_ps(vQueryMaxZ, _mm_loadu_ps(&m_pFilterMinZ[iFirstChild]))));
+		childMask = (uint32)_mm_movemask_ps(vIn);
+#else
+		childMask = 0;
+		for(uint32 i=0; i < MAX_WTNODE_CHILDREN; i++)
+		{
+			uint32 iChild = iFirstChild + i;
+			if(vMin.x < m_pFilterMaxX[iChild] && vMax.x > m_pFilterMinX[iChild] &&
+				vMin.z < m_pFilterMaxZ[iChild] && vMax.z > m_pFilterMinZ[iChild])
+			{
+				childMask |= (1 << i);
+			}
+		}
+#endif
+
+		// Push them backwards so they come off the stack in order.
+		for(uint32 i=MAX_WTNODE_CHILDREN; i > 0; i--)
+		{
+			if(childMask & (1 << (i - 1)))
+			{
+				ASSERT(nStack < m_NodeStack.size());
+				pStack[nStack++] = iFirstChild + i - 1;
+			}
+		}
+	}
+
+	return (uint32)objects.size();
 }
 
 
@@ -638,22 +723,123 @@ void WorldTree::FindObjectsOnPoint(const LTVector *pPoint,
 void WorldTree::IntersectSegment(const LTVector *pPt1, const LTVector *pPt2, 
 	ISCallback cb, void *pCBUser, NodeObjArray iArray)
 {
-	ISInfo isInfo;
+	WTQueryArray objects(this);
+	CollectObjectsOnSegment(*pPt1, *pPt2, objects.Get(), iArray);
 
-	
+	for(uint32 i=0; i < objects.Get().size(); i++)
+	{
+		cb(objects.Get()[i], pCBUser);
+	}
+}
+
+
+void WorldTree::FindSegmentNodes(const LTVector &vPt1, const LTVector &vPt2, 
+	std::vector<uint32> &nodeStack, std::vector<uint32> &nodes) const
+{
+	nodeStack.clear();
+	nodes.clear();
+
+	nodeStack.push_back(0);
+	while(!nodeStack.empty())
+	{
+		uint32 iNode = nodeStack.back();
+		nodeStack.pop_back();
+
+		nodes.push_back(iNode);
+
+		const WorldTreeNode *pNode = GetNode(iNode);
+		if(!pNode->HasChildren())
+			continue;
+
+		// Test in front to back order.  Node: it should be possible to remove one of these
+		// tests because the segment can only cross 3 of the nodes so
+		// we could test the front one, the diagonal one it intersects, and the back one.
+		uint32 iX = vPt1.x > pNode->GetCenterX();
+		uint32 iZ = vPt1.z > pNode->GetCenterZ();
+
+		uint32 order[MAX_WTNODE_CHILDREN];
+		order[0] = iX * 2 + iZ;
+		order[1] = (!iX) * 2 + iZ;
+		order[2] = iX * 2 + (!iZ);
+		order[3] = (!iX) * 2 + (!iZ);
+
+		// Push them backwards so the nearest comes off the stack first.
+		uint32 iFirstChild = m_pFirstChild[iNode];
+		for(uint32 i=MAX_WTNODE_CHILDREN; i > 0; i--)
+		{
+			if(DoesSegmentTouchNode(vPt1, vPt2, pNode->GetChild(order[i - 1])))
+			{
+				nodeStack.push_back(iFirstChild + order[i - 1]);
+			}
+		}
+	}
+}
+
+
+uint32 WorldTree::CollectObjectsOnSegment(const LTVector &vPt1, const LTVector &vPt2, 
+	WTObjArray &objects, NodeObjArray iArray)
+{
 	ASSERT(m_pHelper);
 	m_nTempFrameCode = m_pHelper->IncFrameCode();
 
-	isInfo.m_pTree = this;
-	isInfo.m_iObjArray = iArray;
-	isInfo.m_Pts[0] = *pPt1;
-	isInfo.m_Pts[1] = *pPt2;
-	isInfo.m_CB = cb;
-	isInfo.m_pCBUser = pCBUser;
+	objects.clear();
 
-	IntersectSegment_R(&m_RootNode, &isInfo);
+	FindSegmentNodes(vPt1, vPt2, m_SegmentScratch.m_NodeStack, m_SegmentScratch.m_Nodes);
+
+	for(uint32 iNode=0; iNode < m_SegmentScratch.m_Nodes.size(); iNode++)
+	{
+		// Visit objects in this node.
+		const WTObjArray &nodeObjects = GetNode(m_SegmentScratch.m_Nodes[iNode])->m_ObjectArrays[iArray];
+		for(uint32 i=(uint32)nodeObjects.size(); i > 0; i--)
+		{
+			WorldTreeObj *pObj = nodeObjects[i - 1];
+
+			// Check the frame code.
+			if(pObj->m_WTFrameCode == m_nTempFrameCode)
+				continue;
+
+			pObj->m_WTFrameCode = m_nTempFrameCode;
+			objects.push_back(pObj);
+		}
+	}
+
+	return (uint32)objects.size();
 }
 
+
+uint32 WorldTree::CollectObjectsOnSegment(const LTVector &vPt1, const LTVector &vPt2, 
+	WTObjArray &objects, WTQueryScratch &scratch, NodeObjArray iArray) const
+{
+	objects.clear();
+	scratch.m_SharedObjects.clear();
+
+	FindSegmentNodes(vPt1, vPt2, scratch.m_NodeStack, scratch.m_Nodes);
+
+	for(uint32 iNode=0; iNode < scratch.m_Nodes.size(); iNode++)
+	{
+		const WTObjArray &nodeObjects = GetNode(scratch.m_Nodes[iNode])->m_ObjectArrays[iArray];
+		for(uint32 i=(uint32)nodeObjects.size(); i > 0; i--)
+		{
+			WorldTreeObj *pObj = nodeObjects[i - 1];
+
+			// Only objects that were split across nodes can be found twice, and
+			// there aren't many of those, so just keep a list of them.
+			if(pObj->m_Links[1].m_pNode)
+			{
+				if(std::find(scratch.m_SharedObjects.begin(), scratch.m_SharedObjects.end(), pObj) != scratch.m_SharedObjects.end())
+					continue;
+
+				scratch.m_SharedObjects.push_back(pObj);
+			}
+
+			objects.push_back(pObj);
+		}
+	}
+
+	return (uint32)objects.size();
+}
+
+
 bool WorldTree::Inherit(const WorldTree *pOther) 
 {
 	//clear out any old data
@@ -683,6 +869,12 @@ bool WorldTree::Inherit(const WorldTree *pOther)
 
 	//sanity check that we didn't use more nodes than we allocated
 	assert(nCurrOffset == (m_nNumNodes - 1));
+
+	if(!BuildNodeArrays())
+	{
+		Term();
+		return false;
+	}
 			
 	return true;
 }
@@ -731,6 +923,12 @@ bool WorldTree::LoadLayout(ILTStream *pStream)
 
 	//sanity check that we didn't use more nodes than we allocated
 	assert(nCurrOffset == (m_nNumNodes - 1));
+
+	if(!BuildNodeArrays())
+	{
+		Term();
+		return false;
+	}
 			
 	return true;
 }
@@ -748,6 +946,82 @@ void WorldTree::CopyNodeLayout_R(WorldTreeNode *pDest, const WorldTreeNode *pSrc
 	}
 }
 
+bool WorldTree::BuildNodeArrays()
+{
+	FreeNodeArrays();
+
+	LT_MEM_TRACK_ALLOC(m_pFilterMinX = new float[m_nNumNodes * 4], LT_MEM_TYPE_WORLDTREE);
+	LT_MEM_TRACK_ALLOC(m_pFirstChild = new uint32[m_nNumNodes], LT_MEM_TYPE_WORLDTREE);
+
+	if(!m_pFilterMinX || !m_pFirstChild)
+	{
+		FreeNodeArrays();
+		return false;
+	}
+
+	m_pFilterMaxX = &m_pFilterMinX[m_nNumNodes];
+	m_pFilterMinZ = &m_pFilterMinX[m_nNumNodes * 2];
+	m_pFilterMaxZ = &m_pFilterMinX[m_nNumNodes * 3];
+
+	// Depth of each node, to size the traversal stack.
+	std::vector<uint32> depths(m_nNumNodes, 0);
+	uint32 nMaxDepth = 0;
+
+	m_pFilterMinX[0] = -FLT_MAX;
+	m_pFilterMaxX[0] = FLT_MAX;
+	m_pFilterMinZ[0] = -FLT_MAX;
+	m_pFilterMaxZ[0] = FLT_MAX;
+
+	// Children always come after their parent in the node list, so the
+	// parent's filter bounds are set by the time its children are reached.
+	for(uint32 iNode=0; iNode < m_nNumNodes; iNode++)
+	{
+		WorldTreeNode *pNode = GetNode(iNode);
+		if(!pNode->HasChildren())
+		{
+			m_pFirstChild[iNode] = 0;
+			continue;
+		}
+
+		uint32 iFirstChild = (uint32)(pNode->GetChild(0) - m_pNodes) + 1;
+		assert(iFirstChild > iNode && iFirstChild + MAX_WTNODE_CHILDREN <= m_nNumNodes);
+		m_pFirstChild[iNode] = iFirstChild;
+
+		for(uint32 nX=0; nX < 2; nX++)
+		{
+			for(uint32 nZ=0; nZ < 2; nZ++)
+			{
+				uint32 iChild = iFirstChild + nX * 2 + nZ;
+
+				m_pFilterMinX[iChild] = nX ? pNode->GetCenterX() : m_pFilterMinX[iNode];
+				m_pFilterMaxX[iChild] = nX ? m_pFilterMaxX[iNode] : pNode->GetCenterX();
+				m_pFilterMinZ[iChild] = nZ ? pNode->GetCenterZ() : m_pFilterMinZ[iNode];
+				m_pFilterMaxZ[iChild] = nZ ? m_pFilterMaxZ[iNode] : pNode->GetCenterZ();
+
+				depths[iChild] = depths[iNode] + 1;
+				nMaxDepth = LTMAX(nMaxDepth, depths[iChild]);
+			}
+		}
+	}
+
+	// Each level down leaves at most three siblings on the stack.
+	m_NodeStack.resize((nMaxDepth + 1) * MAX_WTNODE_CHILDREN);
+
+	return true;
+}
+
+void WorldTree::FreeNodeArrays()
+{
+	delete [] m_pFilterMinX;
+	delete [] m_pFirstChild;
+
+	m_pFilterMinX = NULL;
+	m_pFilterMaxX = NULL;
+	m_pFilterMinZ = NULL;
+	m_pFilterMaxZ = NULL;
+	m_pFirstChild = NULL;
+}
+
 // Insert an object into the always-visible list
 void WorldTree::InsertAlwaysVisObject(WorldTreeObj *pObj)
 {
@@ -766,3 +1040,27 @@ void WorldTree::RemoveAlwaysVisObject(WorldTreeObj *pObj)
 
 
 
+// -------------------------------------------------------------------------------- //
+// WTQueryArray.
+// -------------------------------------------------------------------------------- //
+
+WTQueryArray::WTQueryArray(WorldTree *pTree) :
+	m_pTree(pTree)
+{
+	if(m_pTree->m_nQueryDepth == m_pTree->m_QueryArrays.size())
+	{
+		WTObjArray *pArray;
+		LT_MEM_TRACK_ALLOC(pArray = new WTObjArray, LT_MEM_TYPE_WORLDTREE);
+		m_pTree->m_QueryArrays.push_back(pArray);
+	}
+
+	m_pArray = m_pTree->m_QueryArrays[m_pTree->m_nQueryDepth];
+	m_pTree->m_nQueryDepth++;
+}
+
+WTQueryArray::~WTQueryArray()
+{
+	assert(m_pTree->m_nQueryDepth > 0);
+	m_pTree->m_nQueryDepth--;
+}
+
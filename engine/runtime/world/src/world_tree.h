@@ -15,6 +15,8 @@ the vis container object, it stops recursing through the WorldTree, and asks
 the vis container to output any visible objects.
 */
 
+#include <vector>
+
 class WorldTreeHelper;
 
 
@@ -52,6 +54,22 @@ typedef bool (*ISCallback)(WorldTreeObj *pObj, void *pUser);
 
 typedef void (*WTObjCallback)(WorldTreeObj *pObj, void *pUser);
 
+// Query results.
+typedef std::vector<WorldTreeObj*> WTObjArray;
+
+
+// Working space for the queries that can run on several threads at once.
+// Keep one per thread and reuse it.
+class WTQueryScratch
+{
+public:
+    std::vector<uint32>     m_NodeStack;
+    std::vector<uint32>     m_Nodes;
+
+    // Objects already found that sit on more than one node.
+    WTObjArray              m_SharedObjects;
+};
+
 
 class FindObjInfo
 {
@@ -89,6 +107,10 @@ class WTObjLink
 public:
     LTLink          m_Link;
     WorldTreeNode   *m_pNode;
+
+    // Where the object sits in m_pNode's object array.
+    NodeObjArray    m_iNodeArray;
+    uint32          m_iNodeSlot;
 };
 
 
@@ -180,6 +202,10 @@ public:
 
 	//gets the smallest of the X and Z dimensions (Y is essentially irrelevant)
 	float					GetSmallestDim() const						{ return m_fSmallestDim; }
+
+	//accesses the objects sitting on this node as a contiguous array, in no particular order
+	uint32					GetNumObjects(NodeObjArray iArray) const	{ return (uint32)m_ObjectArrays[iArray].size(); }
+	WorldTreeObj* const*	GetObjects(NodeObjArray iArray) const		{ return m_ObjectArrays[iArray].empty() ? LTNULL : &m_ObjectArrays[iArray][0]; }
     
     // All the objects sitting on this node.
     CheapLTLink				m_Objects[NUM_NODEOBJ_ARRAYS];
@@ -218,6 +244,10 @@ private:
 	// How many objects are on or below this node? Used to stop recursion early.
     uint32					m_nObjectsOnOrBelow;
 
+	// The same objects as m_Objects, kept packed so the queries can scan them
+	// without chasing the list.  Removal swaps the last object into the hole.
+	WTObjArray				m_ObjectArrays[NUM_NODEOBJ_ARRAYS];
+
     // Parent node, NULL if none.
     WorldTreeNode			*m_pParent;
 
@@ -253,6 +283,13 @@ public:
     
     void			FindObjectsInBox2(FindObjInfo *pInfo);
 
+    // Fills in the objects touching the box and returns how many there are.
+    // Nothing is called on the objects, so the tree can be changed freely while
+    // the results are being used.
+    uint32			CollectObjectsInBox(const LTVector &vMin, const LTVector &vMax,
+										WTObjArray &objects,
+										NodeObjArray iArray=NOA_Objects);
+
     // Calls the specified callback for objects touching the specified point.
     void			FindObjectsOnPoint(	const LTVector *pPoint,
 										WTObjCallback cb, void *pCBUser, 
@@ -263,6 +300,20 @@ public:
 										ISCallback cb, void *pCBUser, 
 										NodeObjArray iArray=NOA_Objects);
 
+    // Fills in the objects in the nodes that the segment intersects, in the
+    // order IntersectSegment visits them (nearest nodes first).
+    uint32			CollectObjectsOnSegment(const LTVector &vPt1, const LTVector &vPt2,
+											WTObjArray &objects,
+											NodeObjArray iArray=NOA_Objects);
+
+    // Same as above, but it doesn't touch the objects' frame codes or any of 
+    // the tree's scratch space, so several threads can run it at once as long
+    // as nothing changes the tree in the meantime.
+    uint32			CollectObjectsOnSegment(const LTVector &vPt1, const LTVector &vPt2,
+											WTObjArray &objects,
+											WTQueryScratch &scratch,
+											NodeObjArray iArray=NOA_Objects) const;
+
     // Copy from the other tree.
     bool            Inherit(const WorldTree *pOther);
 
@@ -280,10 +331,24 @@ public:
 
 private:
 
+friend class WTQueryArray;
+
     // Used by Inherit to recursively copy nodes over
     void            CopyNodeLayout_R(WorldTreeNode *pDest, const WorldTreeNode *pSrc, 
 									 WorldTreeNode* pNodeList, uint32& nCurrOffset);
 
+    // Builds the flat node arrays once the layout is set up.
+    bool            BuildNodeArrays();
+    void            FreeNodeArrays();
+
+    // Node 0 is the root, node i is m_pNodes[i-1].
+    WorldTreeNode*  GetNode(uint32 iNode)       { return iNode ? &m_pNodes[iNode - 1] : &m_RootNode; }
+    const WorldTreeNode*	GetNode(uint32 iNode) const	{ return iNode ? &m_pNodes[iNode - 1] : &m_RootNode; }
+
+    // Fills in the nodes the segment intersects, nearest first.
+    void            FindSegmentNodes(const LTVector &vPt1, const LTVector &vPt2, 
+                                     std::vector<uint32> &nodeStack, std::vector<uint32> &nodes) const;
+
 	//the number of nodes in the tree, including the root node
 	uint32			m_nNumNodes;
 
@@ -298,6 +363,48 @@ private:
 
 	//our allocated list of nodes (not including the first one)
 	WorldTreeNode*	m_pNodes;
+
+	// The nodes' filter bounds in flat arrays, indexed by node.  The four
+	// children of a node are always next to each other so they can be tested
+	// together.  The bounds on the outside of the tree go out to infinity so
+	// objects hanging off the edges of the world are still found, just like
+	// the center split tests the insertion does.
+	float			*m_pFilterMinX;
+	float			*m_pFilterMaxX;
+	float			*m_pFilterMinZ;
+	float			*m_pFilterMaxZ;
+
+	// Index of each node's first child, 0 if it has none.
+	uint32			*m_pFirstChild;
+
+	// Scratch stack for walking the nodes, big enough for the deepest leaf.
+	std::vector<uint32>	m_NodeStack;
+
+	// Scratch space for the segment queries.
+	WTQueryScratch	m_SegmentScratch;
+
+	// Result arrays for the callback queries, one per level of nesting (the
+	// callbacks can move objects, which runs more queries).
+	std::vector<WTObjArray*>	m_QueryArrays;
+	uint32			m_nQueryDepth;
+};
+
+
+// Borrows one of the tree's result arrays for the lifetime of the object, so
+// a query doesn't have to allocate one.
+class WTQueryArray
+{
+public:
+
+					WTQueryArray(WorldTree *pTree);
+					~WTQueryArray();
+
+	WTObjArray&		Get()				{ return *m_pArray; }
+
+private:
+
+	WorldTree		*m_pTree;
+	WTObjArray		*m_pArray;
 };
 
 
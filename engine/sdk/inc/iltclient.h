@@ -13,6 +13,10 @@
 #include "iltinfo.h"
 #endif
 
+#ifndef __LTPARTICLEARRAYS_H__
+#include "ltparticlearrays.h"
+#endif
+
 #ifdef LITHTECH_ESD
 #include "iltesd.h"
 #endif // LITHTECH_ESD
@@ -50,7 +54,13 @@ enum
 	PS_COLLIDE =	  (1<<6),
 
 //! Are the particles in world space? If flag is not set, they are in object space.
-	PS_WORLDSPACE =	  (1<<7)
+	PS_WORLDSPACE =	  (1<<7),
+
+//! Keep the particles in arrays (see ltparticlearrays.h) instead of a list of LTParticle. Set it before adding any particles.
+	PS_ARRAYS =		  (1<<8),
+
+//! Draw the particles of a \b PS_ARRAYS system from the last one added to the first.
+	PS_DRAWREVERSED = (1<<9)
 };
 //@}
 
@@ -2830,7 +2840,8 @@ Used for: Special FX.
 \param  lifeTime    Lifetime.
 
 \return If successful, returns a pointer to the particle added.
-\return \b LTNULL - \em hObj is invalid (NULL, or not an \b OT_PARTICLESYSTEM).
+\return \b LTNULL - \em hObj is invalid (NULL, not an \b OT_PARTICLESYSTEM, or
+            created with \b PS_ARRAYS).
 
 Adds a particle to a particle system.
 
@@ -2869,7 +2880,8 @@ Used for: Special FX.
 \param pTail    (return) Tail of list.
 
 \return \b true - Successful.
-\return \b false - \em hObj is invalid (NULL, or not an \b OT_PARTICLESYSTEM).
+\return \b false - \em hObj is invalid (NULL, not an \b OT_PARTICLESYSTEM, or
+            created with \b PS_ARRAYS).
 
 Get a pointer to the linked list of particles. This is so that you can
 iterate through them and move them all. The engine will usually do
@@ -3788,6 +3800,68 @@ Used for: Misc.
 */
     LTRESULT (*QueryGraphicDevice)(LTGraphicsCaps* pCaps);
 
+/*!
+\param pQueries    The queries, one per segment.  Each one has its own flags and filter functions.
+\param pInfos      (return) The results, one per query.  \b m_hObject is \b LTNULL for queries that didn't hit anything.
+\param nQueries    The number of queries.
+\param batchFlags  A combination of the batch intersect flags (in ltcodes.h).
+\return The number of queries that hit something.
+
+Runs IntersectSegment on each query against the client world.  The
+segments may be run in any order and, with \b INTERSECTBATCH_THREADED, on
+several threads at once.
+
+Used for: Misc.
+*/
+    uint32 (*IntersectSegmentBatch)(ClientIntersectQuery *pQueries, ClientIntersectInfo *pInfos,
+        uint32 nQueries, uint32 batchFlags);
+
+/*!
+\param hObj     Particle system to query.
+\param pArrays  (return) The particles.
+
+\return \b true - Successful.
+\return \b false - \em hObj is invalid (NULL, or not an \b OT_PARTICLESYSTEM
+            created with \b PS_ARRAYS).
+
+Gets the particles of a \b PS_ARRAYS particle system so you can update
+them.  The arrays move when particles are added or removed.
+
+Used for: Special FX.
+*/
+    bool (*GetParticleArrays)(HLOCALOBJ hObj, LTParticleArrays *pArrays);
+
+/*!
+\param hObj         Particle system to which the particles will be added.
+\param nParticles   Number of particles to add.
+\param pArrays      (return) The particles, including the new ones at the end.
+
+\return \b LT_INVALIDPARAMS - \em hObj is invalid (NULL, or not an
+            \b OT_PARTICLESYSTEM created with \b PS_ARRAYS).
+\return \b LT_OUTOFMEMORY - The particles couldn't be added.
+\return \b LT_OK - Successful.
+
+Adds particles to a \b PS_ARRAYS particle system.  The new particles are
+at rest at the origin, white, the size of the system's particles, and
+have no lifetime; fill them in before the system is next updated.
+
+Used for: Special FX.
+*/
+    LTRESULT (*AddParticleArrays)(HLOCALOBJ hObj, uint32 nParticles, LTParticleArrays *pArrays);
+
+/*!
+\param hSystem      Particle system to modify.
+
+\return The number of particles removed.
+
+Removes the particles of a \b PS_ARRAYS particle system whose lifetime is
+zero or less.  The rest keep their order.  To remove a particle early,
+set its lifetime to zero.
+
+Used for: Special FX.
+*/
+    uint32 (*RemoveExpiredParticles)(HLOCALOBJ hSystem);
+
 protected:
     #ifdef LITHTECH_ESD
     ILTRealAudioMgr     *m_pRealAudioMgr;
@@ -1733,6 +1733,9 @@ Used for: Server Management.
 \return \b LT_NOTFOUND if it can't find the file.
 
 Cache the given file.  Only call this from ServerShell::CacheFiles.
+Models and sounds are read in the background and loaded together once
+CacheFiles returns, so a model that exists but fails to load is
+reported on the console then rather than by this call.
 
 Used for: Misc.
 */
@@ -1930,6 +1933,22 @@ Used for: Special FX.
 */
     LTRESULT (*SetGlobalLightObject)(HOBJECT hObj);
 
+/*!
+\param pQueries    The queries, one per segment.  Each one has its own flags and filter functions.
+\param pInfos      (return) The results, one per query.  \b m_hObject is \b LTNULL for queries that didn't hit anything.
+\param nQueries    The number of queries.
+\param batchFlags  A combination of the batch intersect flags (in ltcodes.h).
+\return The number of queries that hit something.
+
+Intersect a batch of line segments with the world.  Each query gives the same
+result as IntersectSegment, but the engine is free to reorder the segments and,
+with \b INTERSECTBATCH_THREADED, split them across threads.
+
+Used for: Misc.
+*/
+    uint32 (*IntersectSegmentBatch)(IntersectQuery *pQueries, IntersectInfo *pInfos,
+        uint32 nQueries, uint32 batchFlags);
+
 };
 
 #endif  //! __ILTSERVER_H__
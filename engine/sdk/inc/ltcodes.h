@@ -276,6 +276,18 @@ enum
 };
 
 
+/*!
+Batch intersect flags.
+*/
+enum
+{
+//! Split the batch across the engine's worker threads.  Only set this if the
+//  queries' filter functions are safe to call from other threads.  Queries
+//  with \b INTERSECT_MODELOBBS always run on the calling thread.
+    INTERSECTBATCH_THREADED =   1   ,
+};
+
+
 /*!
 Object net flags.
 */
@@ -78,6 +78,7 @@ enum
 	LT_MEM_TYPE_OBJECTSHELL,
 	LT_MEM_TYPE_CLIENTFX,
 	LT_MEM_TYPE_GAMECODE,
+	LT_MEM_TYPE_FRAMEARENA,
 	
 	//this must come last
 	LT_NUM_MEM_TYPES
@@ -0,0 +1,298 @@
+
+/*!
+ Implementation of the structure-of-arrays particle routines.
+
+*/
+
+#include "ltbasedefs.h"
+#include "ltparticlearrays.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LTPARTICLEARRAYS_SSE2
+#include <emmintrin.h>
+#endif
+
+
+// Gets the arrays of every field, for copying particles around without
+// caring what's in them.
+static inline void GetFields(const LTParticleArrays &arrays, uint8 *pFields[PARTICLEARRAYS_NUMFIELDS])
+{
+	pFields[0]	= (uint8*)arrays.m_pPosX;
+	pFields[1]	= (uint8*)arrays.m_pPosY;
+	pFields[2]	= (uint8*)arrays.m_pPosZ;
+	pFields[3]	= (uint8*)arrays.m_pVelX;
+	pFields[4]	= (uint8*)arrays.m_pVelY;
+	pFields[5]	= (uint8*)arrays.m_pVelZ;
+	pFields[6]	= (uint8*)arrays.m_pSize;
+	pFields[7]	= (uint8*)arrays.m_pColorR;
+	pFields[8]	= (uint8*)arrays.m_pColorG;
+	pFields[9]	= (uint8*)arrays.m_pColorB;
+	pFields[10]	= (uint8*)arrays.m_pAlpha;
+	pFields[11]	= (uint8*)arrays.m_pAngle;
+	pFields[12]	= (uint8*)arrays.m_pAngularVelocity;
+	pFields[13]	= (uint8*)arrays.m_pLifetime;
+	pFields[14]	= (uint8*)arrays.m_pTotalLifetime;
+	pFields[15]	= (uint8*)arrays.m_pUserData;
+}
+
+
+void lt_MoveParticleArrays(LTParticleArrays &arrays, void *pBlock, uint32 nCapacity)
+{
+	uint8 *pOldFields[PARTICLEARRAYS_NUMFIELDS];
+	GetFields(arrays, pOldFields);
+
+	uint8 *pFields[PARTICLEARRAYS_NUMFIELDS];
+	for(uint32 nField=0; nField < PARTICLEARRAYS_NUMFIELDS; nField++)
+	{
+		pFields[nField] = (uint8*)pBlock + nField * nCapacity * 4;
+
+		if(arrays.m_nParticles)
+			memcpy(pFields[nField], pOldFields[nField], arrays.m_nParticles * 4);
+	}
+
+	arrays.m_pPosX				= (float*)pFields[0];
+	arrays.m_pPosY				= (float*)pFields[1];
+	arrays.m_pPosZ				= (float*)pFields[2];
+	arrays.m_pVelX				= (float*)pFields[3];
+	arrays.m_pVelY				= (float*)pFields[4];
+	arrays.m_pVelZ				= (float*)pFields[5];
+	arrays.m_pSize				= (float*)pFields[6];
+	arrays.m_pColorR			= (float*)pFields[7];
+	arrays.m_pColorG			= (float*)pFields[8];
+	arrays.m_pColorB			= (float*)pFields[9];
+	arrays.m_pAlpha				= (float*)pFields[10];
+	arrays.m_pAngle				= (float*)pFields[11];
+	arrays.m_pAngularVelocity	= (float*)pFields[12];
+	arrays.m_pLifetime			= (float*)pFields[13];
+	arrays.m_pTotalLifetime		= (float*)pFields[14];
+	arrays.m_pUserData			= (uint32*)pFields[15];
+}
+
+
+void lt_IntegrateParticles(const LTParticleArrays &arrays, float tmFrame,
+	const LTVector &vVelAdd, float fVelScale)
+{
+	float *pPosX = arrays.m_pPosX;
+	float *pPosY = arrays.m_pPosY;
+	float *pPosZ = arrays.m_pPosZ;
+	float *pVelX = arrays.m_pVelX;
+	float *pVelY = arrays.m_pVelY;
+	float *pVelZ = arrays.m_pVelZ;
+	float *pAngle = arrays.m_pAngle;
+	const float *pAngularVelocity = arrays.m_pAngularVelocity;
+	float *pLifetime = arrays.m_pLifetime;
+
+	uint32 i = 0;
+
+#ifdef LTPARTICLEARRAYS_SSE2
+	const __m128 t = _mm_set1_ps(tmFrame);
+	const __m128 scale = _mm_set1_ps(fVelScale);
+	const __m128 addX = _mm_set1_ps(vVelAdd.x);
+	const __m128 addY = _mm_set1_ps(vVelAdd.y);
+	const __m128 addZ = _mm_set1_ps(vVelAdd.z);
+
+	for(; i + 4 <= arrays.m_nParticles; i += 4)
+	{
+		_mm_storeu_ps(pLifetime + i, _mm_sub_ps(_mm_loadu_ps(pLifetime + i), t));
+		_mm_storeu_ps(pAngle + i, _mm_add_ps(_mm_loadu_ps(pAngle + i), _mm_mul_ps(_mm_loadu_ps(pAngularVelocity + i), t)));
+
+		__m128 velX = _mm_loadu_ps(pVelX + i);
+		__m128 velY = _mm_loadu_ps(pVelY + i);
+		__m128 velZ = _mm_loadu_ps(pVelZ + i);
+
+		_mm_storeu_ps(pPosX + i, _mm_add_ps(_mm_loadu_ps(pPosX + i), _mm_mul_ps(velX, t)));
+		_mm_storeu_ps(pPosY + i, _mm_add_ps(_mm_loadu_ps(pPosY + i), _mm_mul_ps(velY, t)));
+		_mm_storeu_ps(pPosZ + i, _mm_add_ps(_mm_loadu_ps(pPosZ + i), _mm_mul_ps(velZ, t)));
+
+		_mm_storeu_ps(pVelX + i, _mm_add_ps(_mm_mul_ps(velX, scale), addX));
+		_mm_storeu_ps(pVelY + i, _mm_add_ps(_mm_mul_ps(velY, scale), addY));
+		_mm_storeu_ps(pVelZ + i, _mm_add_ps(_mm_mul_ps(velZ, scale), addZ));
+	}
+#endif
+
+	for(; i < arrays.m_nParticles; i++)
+	{
+		pLifetime[i] -= tmFrame;
+		pAngle[i] += pAngularVelocity[i] * tmFrame;
+
+		pPosX[i] += pVelX[i] * tmFrame;
+		pPosY[i] += pVelY[i] * tmFrame;
+		pPosZ[i] += pVelZ[i] * tmFrame;
+
+		pVelX[i] = pVelX[i] * fVelScale + vVelAdd.x;
+		pVelY[i] = pVelY[i] * fVelScale + vVelAdd.y;
+		pVelZ[i] = pVelZ[i] * fVelScale + vVelAdd.z;
+	}
+}
+
+
+void lt_TransformParticles(const LTParticleArrays &arrays, const LTMatrix &mTransform)
+{
+	float *pPosX = arrays.m_pPosX;
+	float *pPosY = arrays.m_pPosY;
+	float *pPosZ = arrays.m_pPosZ;
+	const float (*m)[4] = mTransform.m;
+
+	uint32 i = 0;
+
+#ifdef LTPARTICLEARRAYS_SSE2
+	__m128 row[3][4];
+	for(uint32 nRow=0; nRow < 3; nRow++)
+	{
+		for(uint32 nCol=0; nCol < 4; nCol++)
+			row[nRow][nCol] = _mm_set1_ps(m[nRow][nCol]);
+	}
+
+	for(; i + 4 <= arrays.m_nParticles; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(pPosX + i);
+		__m128 y = _mm_loadu_ps(pPosY + i);
+		__m128 z = _mm_loadu_ps(pPosZ + i);
+
+		for(uint32 nRow=0; nRow < 3; nRow++)
+		{
+			__m128 d = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(x, row[nRow][0]), _mm_mul_ps(y, row[nRow][1])),
+				_mm_add_ps(_mm_mul_ps(z, row[nRow][2]), row[nRow][3]));
+
+			_mm_storeu_ps(((nRow == 0) ? pPosX : (nRow == 1) ? pPosY : pPosZ) + i, d);
+		}
+	}
+#endif
+
+	for(; i < arrays.m_nParticles; i++)
+	{
+		float x = pPosX[i];
+		float y = pPosY[i];
+		float z = pPosZ[i];
+
+		pPosX[i] = x*m[0][0] + y*m[0][1] + z*m[0][2] + m[0][3];
+		pPosY[i] = x*m[1][0] + y*m[1][1] + z*m[1][2] + m[1][3];
+		pPosZ[i] = x*m[2][0] + y*m[2][1] + z*m[2][2] + m[2][3];
+	}
+}
+
+
+uint32 lt_CompactParticles(const LTParticleArrays &arrays)
+{
+	const float *pLifetime = arrays.m_pLifetime;
+
+	// Skip the particles that stay where they are.
+	uint32 nKept = 0;
+	while(nKept < arrays.m_nParticles && pLifetime[nKept] > 0.0f)
+		nKept++;
+
+	for(uint32 i = nKept + 1; i < arrays.m_nParticles; i++)
+	{
+		if(pLifetime[i] > 0.0f)
+		{
+			lt_CopyParticle(arrays, nKept, i);
+			nKept++;
+		}
+	}
+
+	return nKept;
+}
+
+
+void lt_CopyParticle(const LTParticleArrays &arrays, uint32 iDest, uint32 iSrc)
+{
+	uint8 *pFields[PARTICLEARRAYS_NUMFIELDS];
+	GetFields(arrays, pFields);
+
+	for(uint32 nField=0; nField < PARTICLEARRAYS_NUMFIELDS; nField++)
+		memcpy(pFields[nField] + iDest * 4, pFields[nField] + iSrc * 4, 4);
+}
+
+
+void lt_SwapParticles(const LTParticleArrays &arrays, uint32 iA, uint32 iB)
+{
+	uint8 *pFields[PARTICLEARRAYS_NUMFIELDS];
+	GetFields(arrays, pFields);
+
+	for(uint32 nField=0; nField < PARTICLEARRAYS_NUMFIELDS; nField++)
+	{
+		uint8 temp[4];
+		memcpy(temp, pFields[nField] + iA * 4, 4);
+		memcpy(pFields[nField] + iA * 4, pFields[nField] + iB * 4, 4);
+		memcpy(pFields[nField] + iB * 4, temp, 4);
+	}
+}
+
+
+bool lt_GetParticleBounds(const LTParticleArrays &arrays, float fSizeScale,
+	LTVector &vMin, LTVector &vMax)
+{
+	if(arrays.m_nParticles == 0)
+		return false;
+
+	const float *pPosX = arrays.m_pPosX;
+	const float *pPosY = arrays.m_pPosY;
+	const float *pPosZ = arrays.m_pPosZ;
+	const float *pSize = arrays.m_pSize;
+
+	vMin.Init(pPosX[0], pPosY[0], pPosZ[0]);
+	vMax = vMin;
+
+	uint32 i = 0;
+
+#ifdef LTPARTICLEARRAYS_SSE2
+	if(arrays.m_nParticles >= 4)
+	{
+		const __m128 scale = _mm_set1_ps(fSizeScale);
+
+		__m128 minX = _mm_set1_ps(vMin.x), maxX = minX;
+		__m128 minY = _mm_set1_ps(vMin.y), maxY = minY;
+		__m128 minZ = _mm_set1_ps(vMin.z), maxZ = minZ;
+
+		for(; i + 4 <= arrays.m_nParticles; i += 4)
+		{
+			__m128 size = _mm_mul_ps(_mm_loadu_ps(pSize + i), scale);
+			__m128 x = _mm_loadu_ps(pPosX + i);
+			__m128 y = _mm_loadu_ps(pPosY + i);
+			__m128 z = _mm_loadu_ps(pPosZ + i);
+
+			minX = _mm_min_ps(minX, _mm_sub_ps(x, size));
+			minY = _mm_min_ps(minY, _mm_sub_ps(y, size));
+			minZ = _mm_min_ps(minZ, _mm_sub_ps(z, size));
+			maxX = _mm_max_ps(maxX, _mm_add_ps(x, size));
+			maxY = _mm_max_ps(maxY, _mm_add_ps(y, size));
+			maxZ = _mm_max_ps(maxZ, _mm_add_ps(z, size));
+		}
+
+		float fLanes[6][4];
+		_mm_storeu_ps(fLanes[0], minX);
+		_mm_storeu_ps(fLanes[1], minY);
+		_mm_storeu_ps(fLanes[2], minZ);
+		_mm_storeu_ps(fLanes[3], maxX);
+		_mm_storeu_ps(fLanes[4], maxY);
+		_mm_storeu_ps(fLanes[5], maxZ);
+
+		for(uint32 nLane=0; nLane < 4; nLane++)
+		{
+			vMin.x = LTMIN(vMin.x, fLanes[0][nLane]);
+			vMin.y = LTMIN(vMin.y, fLanes[1][nLane]);
+			vMin.z = LTMIN(vMin.z, fLanes[2][nLane]);
+			vMax.x = LTMAX(vMax.x, fLanes[3][nLane]);
+			vMax.y = LTMAX(vMax.y, fLanes[4][nLane]);
+			vMax.z = LTMAX(vMax.z, fLanes[5][nLane]);
+		}
+	}
+#endif
+
+	for(; i < arrays.m_nParticles; i++)
+	{
+		float fSize = pSize[i] * fSizeScale;
+
+		vMin.x = LTMIN(vMin.x, pPosX[i] - fSize);
+		vMin.y = LTMIN(vMin.y, pPosY[i] - fSize);
+		vMin.z = LTMIN(vMin.z, pPosZ[i] - fSize);
+		vMax.x = LTMAX(vMax.x, pPosX[i] + fSize);
+		vMax.y = LTMAX(vMax.y, pPosY[i] + fSize);
+		vMax.z = LTMAX(vMax.z, pPosZ[i] + fSize);
+	}
+
+	return true;
+}
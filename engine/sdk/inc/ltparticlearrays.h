@@ -0,0 +1,112 @@
+/*!
+Structure-of-arrays particle storage.  Particle systems created with
+\b PS_ARRAYS keep their particles as one array per field instead of a
+linked list of \b LTParticle, so whole systems can be updated with straight
+loops and the renderer can build its vertices from the arrays directly.
+
+The routines here work on a view of the arrays and never allocate; the
+engine owns the memory.
+*/
+
+#ifndef __LTPARTICLEARRAYS_H__
+#define __LTPARTICLEARRAYS_H__
+
+#ifndef __LTBASETYPES_H__
+#include "ltbasetypes.h"
+#endif
+
+
+/*!
+The particles of a \b PS_ARRAYS particle system.  Particle \em i is at index
+\em i of every array.  The fields mean the same as in \b LTParticle.
+
+The pointers stay valid until particles are added or removed.
+*/
+struct LTParticleArrays
+{
+	uint32		m_nParticles;
+
+	float		*m_pPosX;
+	float		*m_pPosY;
+	float		*m_pPosZ;
+
+	float		*m_pVelX;
+	float		*m_pVelY;
+	float		*m_pVelZ;
+
+	float		*m_pSize;
+
+	float		*m_pColorR;				//! RGB 0-255
+	float		*m_pColorG;
+	float		*m_pColorB;
+	float		*m_pAlpha;				//! 0-1
+
+	float		*m_pAngle;
+	float		*m_pAngularVelocity;
+
+	float		*m_pLifetime;
+	float		*m_pTotalLifetime;
+
+	uint32		*m_pUserData;
+};
+
+//! The number of arrays in \b LTParticleArrays.  They're all 4 bytes per particle.
+#define PARTICLEARRAYS_NUMFIELDS	16
+
+
+/*!
+\param arrays		Particles to move.  Updated to point into the block.
+\param pBlock		Room for \b PARTICLEARRAYS_NUMFIELDS arrays of \em nCapacity.
+\param nCapacity	The number of particles the block can hold.
+
+Moves the particles into a new block of memory, one field after another.
+Pass null arrays with no particles to set up a new block.
+*/
+void lt_MoveParticleArrays(LTParticleArrays &arrays, void *pBlock, uint32 nCapacity);
+
+/*!
+\param arrays		Particles to update.
+\param tmFrame		Frame time.
+\param vVelAdd		Added to every velocity after it's scaled (gravity * tmFrame, say).
+\param fVelScale	Every velocity is multiplied by this (friction).
+
+Counts down the lifetimes, then moves the particles and turns them by their
+velocities before updating the velocities.  Particles whose lifetime runs
+out are moved too; remove them with \b lt_CompactParticles.
+*/
+void lt_IntegrateParticles(const LTParticleArrays &arrays, float tmFrame,
+	const LTVector &vVelAdd, float fVelScale);
+
+/*!
+Transforms every particle position by the matrix.
+*/
+void lt_TransformParticles(const LTParticleArrays &arrays, const LTMatrix &mTransform);
+
+/*!
+\return The number of particles left.
+
+Removes the particles whose lifetime is zero or less, keeping the rest in
+order.  Doesn't change \b arrays.m_nParticles.
+*/
+uint32 lt_CompactParticles(const LTParticleArrays &arrays);
+
+/*!
+Copies every field of particle \em iSrc over particle \em iDest.
+*/
+void lt_CopyParticle(const LTParticleArrays &arrays, uint32 iDest, uint32 iSrc);
+
+/*!
+Swaps every field of two particles.
+*/
+void lt_SwapParticles(const LTParticleArrays &arrays, uint32 iA, uint32 iB);
+
+/*!
+\return \b false if there are no particles.
+
+Finds the box around the particles, each grown by its size times \em fSizeScale.
+*/
+bool lt_GetParticleBounds(const LTParticleArrays &arrays, float fSizeScale,
+	LTVector &vMin, LTVector &vMax);
+
+
+#endif  // __LTPARTICLEARRAYS_H__
@@ -203,7 +203,25 @@ the binding of the geometry to the object at processing time.
 /*!
 Objects of this class do not have an associated HOBJECT
 */
-	CF_CLASSONLY =	  (1<<5)
+	CF_CLASSONLY =	  (1<<5),
+
+/*!
+The class's \b OnUpdate is safe to run on a worker thread alongside
+other objects' updates.  When the server is running parallel object
+updates, it may read its own object's state and set plain state on it
+(next update, velocity, acceleration and so on).  Changes that would
+be sent to clients (user flags, FLAGS2, model info, render info) are
+held on the object and applied on the main thread after the update.
+It must not query the world (IntersectSegment, CastRay,
+FindObjectsTouchingSphere, GetBoxIntersecters and so on), create,
+remove, move, rotate or resize objects, change their FLAG_ flags or
+state, send messages, or touch other objects; debug builds assert on
+these.
+The model animation and physics for the object still run on the main
+thread, before and after the update.  This flag is not inherited by
+subclasses.
+*/
+	CF_THREADSAFEUPDATE = (1<<6)
 };
 
 
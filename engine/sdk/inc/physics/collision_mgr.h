@@ -190,6 +190,31 @@ public:
 	Used For: Physics.
 	*/
 	virtual void Term() = 0;
+
+	/*!
+	\param	o	A collision object address.
+
+	Refresh the database after an ILTCollisionObject's position,
+	orientation or size changed.  Queries only consider objects
+	whose bounds overlap, so this must be called after an object
+	in the database is moved.
+
+	Used For: Physics.
+	*/
+	virtual void Update( ILTCollisionObject* o ) = 0;
+
+	/*!
+	\param	o	A collision object address.
+	\param	p0	Where the object's LTObject moved from.
+	\param	p1	Where the object's LTObject moved to.
+
+	Refresh the database after the engine moved the LTObject an
+	ILTCollisionObject represents.  The object's own m_P0 and m_P1
+	are left alone.
+
+	Used For: Physics.
+	*/
+	virtual void Move( ILTCollisionObject* o, const LTVector3f& p0, const LTVector3f& p1 ) = 0;
 };
 
 
@@ -15,6 +15,22 @@ namespace ul = bibendovsky::spul;
 class AudioDecoder
 {
 public:
+	// Resampling quality, used when the output sample rate differs from the
+	// input one.
+	enum class ResampleQuality
+	{
+		// Interpolates linearly between neighbouring frames.
+		linear,
+
+		// Repeats or skips whole frames.
+		// Cheapest, but aliases audibly.
+		nearest,
+
+		// Windowed-sinc polyphase filter.
+		// Best quality, most expensive.
+		polyphase,
+	};
+
 	// Open object parameter.
 	struct OpenParam
 	{
@@ -30,6 +46,9 @@ public:
 		// Set to zero to skip convertion.
 		int dst_sample_rate_;
 
+		// How to resample, if the sample rate is converted.
+		ResampleQuality resample_quality_;
+
 		// An input data stream.
 		ul::Stream* stream_ptr_;
 
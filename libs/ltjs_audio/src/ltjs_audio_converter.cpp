@@ -1,11 +1,18 @@
 #include "ltjs_audio_converter.h"
 
 #include <cassert>
+#include <cmath>
+#include <cstring>
 
 #include <algorithm>
 
 #include "ltjs_audio_sample_converter.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LTJS_AUDIO_CONVERTER_SSE2 1
+#include <emmintrin.h>
+#endif
+
 // ==========================================================================
 
 static_assert(sizeof(int) >= sizeof(std::int32_t), "Unsupported data model.");
@@ -14,6 +21,118 @@ static_assert(sizeof(int) >= sizeof(std::int32_t), "Unsupported data model.");
 
 namespace ltjs {
 
+namespace {
+
+// Block kernels shared by the format conversions.  The SIMD versions give
+// exactly the same results as AudioSampleConverter.
+
+void convert_samples_u8_to_s16(const std::uint8_t* src_samples, std::int16_t* dst_samples, int sample_count) noexcept
+{
+	auto i = 0;
+
+#ifdef LTJS_AUDIO_CONVERTER_SSE2
+	// 257 * x is x in both bytes of a word.
+	const auto sign_mask = _mm_set1_epi16(-32768);
+
+	for (; i + 16 <= sample_count; i += 16)
+	{
+		const auto u8s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src_samples[i]));
+		const auto s16s_lo = _mm_xor_si128(_mm_unpacklo_epi8(u8s, u8s), sign_mask);
+		const auto s16s_hi = _mm_xor_si128(_mm_unpackhi_epi8(u8s, u8s), sign_mask);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dst_samples[i]), s16s_lo);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dst_samples[i + 8]), s16s_hi);
+	}
+#endif
+
+	for (; i < sample_count; ++i)
+	{
+		dst_samples[i] = AudioSampleConverter::u8_to_s16(src_samples[i]);
+	}
+}
+
+#ifdef LTJS_AUDIO_CONVERTER_SSE2
+// Signed 16-bit samples to unsigned 8-bit ones, one per word.
+inline __m128i convert_s16_to_u8_words(__m128i s16s) noexcept
+{
+	// (x + 32768) / 257 == ((x + 32768) * 0xFF01) >> 24 for every 16-bit x.
+	const auto biased = _mm_xor_si128(s16s, _mm_set1_epi16(-32768));
+	return _mm_srli_epi16(_mm_mulhi_epu16(biased, _mm_set1_epi16(static_cast<short>(0xFF01))), 8);
+}
+
+// Averages the pairs of signed 16-bit samples, rounding toward zero.
+inline __m128i mix_s16_pairs(__m128i s16s) noexcept
+{
+	const auto sums = _mm_madd_epi16(s16s, _mm_set1_epi16(1));
+	return _mm_srai_epi32(_mm_add_epi32(sums, _mm_srli_epi32(sums, 31)), 1);
+}
+#endif
+
+void convert_samples_s16_to_u8(const std::int16_t* src_samples, std::uint8_t* dst_samples, int sample_count) noexcept
+{
+	auto i = 0;
+
+#ifdef LTJS_AUDIO_CONVERTER_SSE2
+	for (; i + 16 <= sample_count; i += 16)
+	{
+		const auto u8s_lo = convert_s16_to_u8_words(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src_samples[i])));
+		const auto u8s_hi = convert_s16_to_u8_words(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src_samples[i + 8])));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dst_samples[i]), _mm_packus_epi16(u8s_lo, u8s_hi));
+	}
+#endif
+
+	for (; i < sample_count; ++i)
+	{
+		dst_samples[i] = AudioSampleConverter::s16_to_u8(src_samples[i]);
+	}
+}
+
+void mix_frames_s16(const std::int16_t* src_samples, std::int16_t* dst_samples, int frame_count) noexcept
+{
+	auto i = 0;
+
+#ifdef LTJS_AUDIO_CONVERTER_SSE2
+	for (; i + 8 <= frame_count; i += 8)
+	{
+		const auto mixed_lo = mix_s16_pairs(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src_samples[2 * i])));
+		const auto mixed_hi = mix_s16_pairs(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src_samples[(2 * i) + 8])));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dst_samples[i]), _mm_packs_epi32(mixed_lo, mixed_hi));
+	}
+#endif
+
+	for (; i < frame_count; ++i)
+	{
+		dst_samples[i] = static_cast<std::int16_t>((src_samples[2 * i] + src_samples[(2 * i) + 1]) / 2);
+	}
+}
+
+void mix_frames_u8_to_s16(const std::uint8_t* src_samples, std::int16_t* dst_samples, int frame_count) noexcept
+{
+	auto i = 0;
+
+#ifdef LTJS_AUDIO_CONVERTER_SSE2
+	const auto sign_mask = _mm_set1_epi16(-32768);
+
+	for (; i + 8 <= frame_count; i += 8)
+	{
+		const auto u8s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src_samples[2 * i]));
+		const auto s16s_lo = _mm_xor_si128(_mm_unpacklo_epi8(u8s, u8s), sign_mask);
+		const auto s16s_hi = _mm_xor_si128(_mm_unpackhi_epi8(u8s, u8s), sign_mask);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dst_samples[i]), _mm_packs_epi32(mix_s16_pairs(s16s_lo), mix_s16_pairs(s16s_hi)));
+	}
+#endif
+
+	for (; i < frame_count; ++i)
+	{
+		const auto sample_s16_0 = AudioSampleConverter::u8_to_s16(src_samples[2 * i]);
+		const auto sample_s16_1 = AudioSampleConverter::u8_to_s16(src_samples[(2 * i) + 1]);
+		dst_samples[i] = static_cast<std::int16_t>((sample_s16_0 + sample_s16_1) / 2);
+	}
+}
+
+} // namespace
+
+// ==========================================================================
+
 void AudioConverter::close() noexcept
 {
 	is_open_ = false;
@@ -27,10 +146,25 @@ void AudioConverter::close() noexcept
 	dst_frame_size_ = 0;
 	cache_byte_count_ = 0;
 	cache_byte_offset_ = 0;
-	sample_rate_counter_ = 0;
 	cache_ = nullptr;
 	convert_format_func_ = nullptr;
 	convert_func_ = nullptr;
+	resample_quality_ = AudioConverterResampleQuality{};
+	resample_func_ = nullptr;
+	convert_window_func_ = nullptr;
+	window_channel_count_ = 0;
+	filter_tap_count_ = 0;
+	filter_lag_ = 0;
+	filter_lead_ = 0;
+	step_whole_ = 0;
+	step_fraction_ = 0;
+	phase_scale_ = 0;
+	window_frame_count_ = 0;
+	window_data_end_ = 0;
+	window_position_ = 0;
+	window_phase_ = 0;
+	window_skip_count_ = 0;
+	is_drained_ = false;
 }
 
 bool AudioConverter::open(const AudioConverterOpenParam& param) noexcept
@@ -50,13 +184,14 @@ bool AudioConverter::open(const AudioConverterOpenParam& param) noexcept
 	dst_sample_rate_ = param.dst_sample_rate;
 	src_frame_size_ = param.src_channel_count * (param.src_bit_depth / 8);
 	dst_frame_size_ = param.dst_channel_count * (param.dst_bit_depth / 8);
-	sample_rate_counter_ = dst_sample_rate_;
 
 	if (!set_funcs(param))
 	{
 		return false;
 	}
 
+	reset_window();
+
 	is_open_ = true;
 	return is_open();
 }
@@ -71,8 +206,8 @@ bool AudioConverter::reset() noexcept
 
 	cache_byte_count_ = 0;
 	cache_byte_offset_ = 0;
-	sample_rate_counter_ = dst_sample_rate_;
 	cache_ = nullptr;
+	reset_window();
 	return true;
 }
 
@@ -154,6 +289,41 @@ bool AudioConverter::is_filled() const noexcept
 	return cache_byte_offset_ != cache_byte_count_;
 }
 
+bool AudioConverter::drain() noexcept
+{
+	if (!is_open())
+	{
+		assert(false && "Closed.");
+		return false;
+	}
+
+	if (convert_func_ != &AudioConverter::convert_with_format_and_sample_rate || is_drained_ || is_filled())
+	{
+		return false;
+	}
+
+	is_drained_ = true;
+	compact_window();
+
+	if (window_position_ >= window_data_end_)
+	{
+		return false;
+	}
+
+	// Pad the end so the last frames have all of their taps.  Linear
+	// interpolation holds the last frame, the filter fades to silence.
+	for (auto channel = 0; channel < window_channel_count_; ++channel)
+	{
+		const auto pad_sample = resample_quality_ == AudioConverterResampleQuality::polyphase ?
+			std::int16_t{} : window_[channel][window_data_end_ - 1];
+
+		std::fill_n(&window_[channel][window_frame_count_], filter_lead_, pad_sample);
+	}
+
+	window_frame_count_ += filter_lead_;
+	return true;
+}
+
 bool AudioConverter::validate(const AudioConverterOpenParam& param) noexcept
 {
 	switch (param.src_channel_count)
@@ -212,198 +382,334 @@ bool AudioConverter::validate(const AudioConverterOpenParam& param) noexcept
 		return false;
 	}
 
+	switch (param.resample_quality)
+	{
+		case AudioConverterResampleQuality::nearest:
+		case AudioConverterResampleQuality::linear:
+		case AudioConverterResampleQuality::polyphase:
+			break;
+
+		default:
+			assert(false && "Unsupported resample quality.");
+			return false;
+	}
+
 	return true;
 }
 
-void AudioConverter::convert_format_c1u8_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c1u8_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
-	dst_bytes[0] = src_bytes[0];
+	std::memcpy(dst_bytes, src_bytes, frame_count);
 }
 
-void AudioConverter::convert_format_c2u8_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c2u8_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
-	dst_bytes[0] = src_bytes[0];
-	dst_bytes[1] = src_bytes[1];
+	std::memcpy(dst_bytes, src_bytes, 2 * frame_count);
 }
 
-void AudioConverter::convert_format_c1s16_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c1s16_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
-	const auto src_samples = reinterpret_cast<const std::int16_t*>(src_bytes);
-	const auto dst_samples = reinterpret_cast<std::int16_t*>(dst_bytes);
-	dst_samples[0] = src_samples[0];
+	std::memcpy(dst_bytes, src_bytes, 2 * frame_count);
 }
 
-void AudioConverter::convert_format_c2s16_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c2s16_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
-	const auto src_samples = reinterpret_cast<const std::int16_t*>(src_bytes);
-	const auto dst_samples = reinterpret_cast<std::int16_t*>(dst_bytes);
-	dst_samples[0] = src_samples[0];
-	dst_samples[1] = src_samples[1];
+	std::memcpy(dst_bytes, src_bytes, 4 * frame_count);
 }
 
-void AudioConverter::convert_format_c1u8_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c1u8_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
-	const auto dst_samples = reinterpret_cast<std::int16_t*>(dst_bytes);
-	dst_samples[0] = AudioSampleConverter::u8_to_s16(src_bytes[0]);
+	convert_samples_u8_to_s16(src_bytes, reinterpret_cast<std::int16_t*>(dst_bytes), frame_count);
 }
 
-void AudioConverter::convert_format_c1u8_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c1u8_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
-	const auto sample_u8 = src_bytes[0];
-	dst_bytes[0] = sample_u8;
-	dst_bytes[1] = sample_u8;
+	auto i = 0;
+
+#ifdef LTJS_AUDIO_CONVERTER_SSE2
+	for (; i + 16 <= frame_count; i += 16)
+	{
+		const auto u8s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src_bytes[i]));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dst_bytes[2 * i]), _mm_unpacklo_epi8(u8s, u8s));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dst_bytes[(2 * i) + 16]), _mm_unpackhi_epi8(u8s, u8s));
+	}
+#endif
+
+	for (; i < frame_count; ++i)
+	{
+		const auto sample_u8 = src_bytes[i];
+		dst_bytes[(2 * i) + 0] = sample_u8;
+		dst_bytes[(2 * i) + 1] = sample_u8;
+	}
 }
 
-void AudioConverter::convert_format_c1u8_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c1u8_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
-	const auto sample_s16 = AudioSampleConverter::u8_to_s16(src_bytes[0]);
 	const auto dst_samples = reinterpret_cast<std::int16_t*>(dst_bytes);
-	dst_samples[0] = sample_s16;
-	dst_samples[1] = sample_s16;
+	auto i = 0;
+
+#ifdef LTJS_AUDIO_CONVERTER_SSE2
+	const auto sign_mask = _mm_set1_epi16(-32768);
+
+	for (; i + 16 <= frame_count; i += 16)
+	{
+		const auto u8s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src_bytes[i]));
+		const auto s16s_lo = _mm_xor_si128(_mm_unpacklo_epi8(u8s, u8s), sign_mask);
+		const auto s16s_hi = _mm_xor_si128(_mm_unpackhi_epi8(u8s, u8s), sign_mask);
+		const auto dst = reinterpret_cast<__m128i*>(&dst_samples[2 * i]);
+		_mm_storeu_si128(dst + 0, _mm_unpacklo_epi16(s16s_lo, s16s_lo));
+		_mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(s16s_lo, s16s_lo));
+		_mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(s16s_hi, s16s_hi));
+		_mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(s16s_hi, s16s_hi));
+	}
+#endif
+
+	for (; i < frame_count; ++i)
+	{
+		const auto sample_s16 = AudioSampleConverter::u8_to_s16(src_bytes[i]);
+		dst_samples[(2 * i) + 0] = sample_s16;
+		dst_samples[(2 * i) + 1] = sample_s16;
+	}
 }
 
-void AudioConverter::convert_format_c1s16_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c1s16_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
-	const auto src_samples = reinterpret_cast<const std::int16_t*>(src_bytes);
-	dst_bytes[0] = AudioSampleConverter::s16_to_u8(src_samples[0]);
+	convert_samples_s16_to_u8(reinterpret_cast<const std::int16_t*>(src_bytes), dst_bytes, frame_count);
 }
 
-void AudioConverter::convert_format_c1s16_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c1s16_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
 	const auto src_samples = reinterpret_cast<const std::int16_t*>(src_bytes);
-	const auto sample_u8 = AudioSampleConverter::s16_to_u8(src_samples[0]);
-	dst_bytes[0] = sample_u8;
-	dst_bytes[1] = sample_u8;
+	auto i = 0;
+
+#ifdef LTJS_AUDIO_CONVERTER_SSE2
+	for (; i + 8 <= frame_count; i += 8)
+	{
+		const auto u8s = convert_s16_to_u8_words(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src_samples[i])));
+		const auto u8_pairs = _mm_packus_epi16(_mm_unpacklo_epi16(u8s, u8s), _mm_unpackhi_epi16(u8s, u8s));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dst_bytes[2 * i]), u8_pairs);
+	}
+#endif
+
+	for (; i < frame_count; ++i)
+	{
+		const auto sample_u8 = AudioSampleConverter::s16_to_u8(src_samples[i]);
+		dst_bytes[(2 * i) + 0] = sample_u8;
+		dst_bytes[(2 * i) + 1] = sample_u8;
+	}
 }
 
-void AudioConverter::convert_format_c1s16_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c1s16_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
 	const auto src_samples = reinterpret_cast<const std::int16_t*>(src_bytes);
 	const auto dst_samples = reinterpret_cast<std::int16_t*>(dst_bytes);
-	const auto sample_s16 = src_samples[0];
-	dst_samples[0] = sample_s16;
-	dst_samples[1] = sample_s16;
+	auto i = 0;
+
+#ifdef LTJS_AUDIO_CONVERTER_SSE2
+	for (; i + 8 <= frame_count; i += 8)
+	{
+		const auto s16s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src_samples[i]));
+		const auto dst = reinterpret_cast<__m128i*>(&dst_samples[2 * i]);
+		_mm_storeu_si128(dst + 0, _mm_unpacklo_epi16(s16s, s16s));
+		_mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(s16s, s16s));
+	}
+#endif
+
+	for (; i < frame_count; ++i)
+	{
+		const auto sample_s16 = src_samples[i];
+		dst_samples[(2 * i) + 0] = sample_s16;
+		dst_samples[(2 * i) + 1] = sample_s16;
+	}
 }
 
-void AudioConverter::convert_format_c2u8_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c2u8_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
-	dst_bytes[0] = static_cast<std::uint8_t>((src_bytes[0] + src_bytes[1]) / 2);
+	auto i = 0;
+
+#ifdef LTJS_AUDIO_CONVERTER_SSE2
+	const auto low_byte_mask = _mm_set1_epi16(0x00FF);
+
+	for (; i + 16 <= frame_count; i += 16)
+	{
+		const auto u8s_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src_bytes[2 * i]));
+		const auto u8s_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src_bytes[(2 * i) + 16]));
+		const auto mixed_lo = _mm_srli_epi16(_mm_add_epi16(_mm_and_si128(u8s_lo, low_byte_mask), _mm_srli_epi16(u8s_lo, 8)), 1);
+		const auto mixed_hi = _mm_srli_epi16(_mm_add_epi16(_mm_and_si128(u8s_hi, low_byte_mask), _mm_srli_epi16(u8s_hi, 8)), 1);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dst_bytes[i]), _mm_packus_epi16(mixed_lo, mixed_hi));
+	}
+#endif
+
+	for (; i < frame_count; ++i)
+	{
+		dst_bytes[i] = static_cast<std::uint8_t>((src_bytes[2 * i] + src_bytes[(2 * i) + 1]) / 2);
+	}
 }
 
-void AudioConverter::convert_format_c2u8_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c2u8_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
-	const auto sample_s16_0 = AudioSampleConverter::u8_to_s16(src_bytes[0]);
-	const auto sample_s16_1 = AudioSampleConverter::u8_to_s16(src_bytes[1]);
-	const auto dst_samples = reinterpret_cast<std::int16_t*>(dst_bytes);
-	dst_samples[0] = static_cast<std::int16_t>((sample_s16_0 + sample_s16_1) / 2);
+	mix_frames_u8_to_s16(src_bytes, reinterpret_cast<std::int16_t*>(dst_bytes), frame_count);
 }
 
-void AudioConverter::convert_format_c2u8_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c2u8_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
-	const auto dst_samples = reinterpret_cast<std::int16_t*>(dst_bytes);
-	dst_samples[0] = AudioSampleConverter::u8_to_s16(src_bytes[0]);
-	dst_samples[1] = AudioSampleConverter::u8_to_s16(src_bytes[1]);
+	convert_samples_u8_to_s16(src_bytes, reinterpret_cast<std::int16_t*>(dst_bytes), 2 * frame_count);
 }
 
-void AudioConverter::convert_format_c2s16_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c2s16_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
 	const auto src_samples = reinterpret_cast<const std::int16_t*>(src_bytes);
-	const auto sample_s16 = static_cast<std::int16_t>((src_samples[0] + src_samples[1]) / 2);
-	dst_bytes[0] = AudioSampleConverter::s16_to_u8(sample_s16);
+	auto i = 0;
+
+#ifdef LTJS_AUDIO_CONVERTER_SSE2
+	for (; i + 16 <= frame_count; i += 16)
+	{
+		const auto src = reinterpret_cast<const __m128i*>(&src_samples[2 * i]);
+		const auto mixed_lo = _mm_packs_epi32(mix_s16_pairs(_mm_loadu_si128(src + 0)), mix_s16_pairs(_mm_loadu_si128(src + 1)));
+		const auto mixed_hi = _mm_packs_epi32(mix_s16_pairs(_mm_loadu_si128(src + 2)), mix_s16_pairs(_mm_loadu_si128(src + 3)));
+		const auto u8s = _mm_packus_epi16(convert_s16_to_u8_words(mixed_lo), convert_s16_to_u8_words(mixed_hi));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dst_bytes[i]), u8s);
+	}
+#endif
+
+	for (; i < frame_count; ++i)
+	{
+		const auto sample_s16 = static_cast<std::int16_t>((src_samples[2 * i] + src_samples[(2 * i) + 1]) / 2);
+		dst_bytes[i] = AudioSampleConverter::s16_to_u8(sample_s16);
+	}
 }
 
-void AudioConverter::convert_format_c2s16_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c2s16_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
-	const auto src_samples = reinterpret_cast<const std::int16_t*>(src_bytes);
-	const auto dst_samples = reinterpret_cast<std::int16_t*>(dst_bytes);
-	dst_samples[0] = static_cast<std::int16_t>((src_samples[0] + src_samples[1]) / 2);
+	mix_frames_s16(reinterpret_cast<const std::int16_t*>(src_bytes), reinterpret_cast<std::int16_t*>(dst_bytes), frame_count);
 }
 
-void AudioConverter::convert_format_c2s16_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept
+void AudioConverter::convert_format_c2s16_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept
 {
-	const auto src_samples = reinterpret_cast<const std::int16_t*>(src_bytes);
-	dst_bytes[0] = AudioSampleConverter::s16_to_u8(src_samples[0]);
-	dst_bytes[1] = AudioSampleConverter::s16_to_u8(src_samples[1]);
+	convert_samples_s16_to_u8(reinterpret_cast<const std::int16_t*>(src_bytes), dst_bytes, 2 * frame_count);
 }
 
-bool AudioConverter::set_convert_format_func(const AudioConverterOpenParam& param) noexcept
+AudioConverter::ConvertFormatFunc AudioConverter::get_convert_format_func(
+	int src_channel_count,
+	int src_bit_depth,
+	int dst_channel_count,
+	int dst_bit_depth) noexcept
 {
-	const auto s_c1 = param.src_channel_count == 1;
-	const auto s_c2 = param.src_channel_count == 2;
-	const auto s_u8 = param.src_bit_depth == 8;
-	const auto s_s16 = param.src_bit_depth == 16;
+	const auto s_c1 = src_channel_count == 1;
+	const auto s_c2 = src_channel_count == 2;
+	const auto s_u8 = src_bit_depth == 8;
+	const auto s_s16 = src_bit_depth == 16;
 
-	const auto d_c1 = param.dst_channel_count == 1;
-	const auto d_c2 = param.dst_channel_count == 2;
-	const auto d_u8 = param.dst_bit_depth == 8;
-	const auto d_s16 = param.dst_bit_depth == 16;
+	const auto d_c1 = dst_channel_count == 1;
+	const auto d_c2 = dst_channel_count == 2;
+	const auto d_u8 = dst_bit_depth == 8;
+	const auto d_s16 = dst_bit_depth == 16;
 
 	if (false) {}
 	else if (s_c1 && s_u8 && d_c1 && d_u8)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c1u8_to_c1u8;
+		return &AudioConverter::convert_format_c1u8_to_c1u8;
 	}
 	else if (s_c2 && s_u8 && d_c2 && d_u8)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c2u8_to_c2u8;
+		return &AudioConverter::convert_format_c2u8_to_c2u8;
 	}
 	else if (s_c1 && s_s16 && d_c1 && d_s16)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c1s16_to_c1s16;
+		return &AudioConverter::convert_format_c1s16_to_c1s16;
 	}
 	else if (s_c2 && s_s16 && d_c2 && d_s16)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c2s16_to_c2s16;
+		return &AudioConverter::convert_format_c2s16_to_c2s16;
 	}
 	else if (s_c1 && s_u8 && d_c1 && d_s16)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c1u8_to_c1s16;
+		return &AudioConverter::convert_format_c1u8_to_c1s16;
 	}
 	else if (s_c1 && s_u8 && d_c2 && d_u8)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c1u8_to_c2u8;
+		return &AudioConverter::convert_format_c1u8_to_c2u8;
 	}
 	else if (s_c1 && s_u8 && d_c2 && d_s16)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c1u8_to_c2s16;
+		return &AudioConverter::convert_format_c1u8_to_c2s16;
 	}
 	else if (s_c1 && s_s16 && d_c1 && d_u8)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c1s16_to_c1u8;
+		return &AudioConverter::convert_format_c1s16_to_c1u8;
 	}
 	else if (s_c1 && s_s16 && d_c2 && d_u8)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c1s16_to_c2u8;
+		return &AudioConverter::convert_format_c1s16_to_c2u8;
 	}
 	else if (s_c1 && s_s16 && d_c2 && d_s16)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c1s16_to_c2s16;
+		return &AudioConverter::convert_format_c1s16_to_c2s16;
 	}
 	else if (s_c2 && s_u8 && d_c1 && d_u8)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c2u8_to_c1u8;
+		return &AudioConverter::convert_format_c2u8_to_c1u8;
 	}
 	else if (s_c2 && s_u8 && d_c1 && d_s16)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c2u8_to_c1s16;
+		return &AudioConverter::convert_format_c2u8_to_c1s16;
 	}
 	else if (s_c2 && s_u8 && d_c2 && d_s16)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c2u8_to_c2s16;
+		return &AudioConverter::convert_format_c2u8_to_c2s16;
 	}
 	else if (s_c2 && s_s16 && d_c1 && d_u8)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c2s16_to_c1u8;
+		return &AudioConverter::convert_format_c2s16_to_c1u8;
 	}
 	else if (s_c2 && s_s16 && d_c1 && d_s16)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c2s16_to_c1s16;
+		return &AudioConverter::convert_format_c2s16_to_c1s16;
 	}
 	else if (s_c2 && s_s16 && d_c2 && d_u8)
 	{
-		convert_format_func_ = &AudioConverter::convert_format_c2s16_to_c2u8;
+		return &AudioConverter::convert_format_c2s16_to_c2u8;
 	}
 
+	return nullptr;
+}
+
+int AudioConverter::filter_sample(const std::int16_t* samples, const std::int16_t* coefficients, int tap_count) noexcept
+{
+	auto sum = 0;
+
+#ifdef LTJS_AUDIO_CONVERTER_SSE2
+	auto sums = _mm_setzero_si128();
+
+	for (auto i = 0; i < tap_count; i += 8)
+	{
+		const auto sample_s16s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i]));
+		const auto coefficient_s16s = _mm_load_si128(reinterpret_cast<const __m128i*>(&coefficients[i]));
+		sums = _mm_add_epi32(sums, _mm_madd_epi16(sample_s16s, coefficient_s16s));
+	}
+
+	sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(1, 0, 3, 2)));
+	sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(2, 3, 0, 1)));
+	sum = _mm_cvtsi128_si32(sums);
+#else
+	for (auto i = 0; i < tap_count; ++i)
+	{
+		sum += samples[i] * coefficients[i];
+	}
+#endif
+
+	// The coefficients are 2.14 fixed point.
+	return std::clamp((sum + (1 << 13)) >> 14, -32768, 32767);
+}
+
+bool AudioConverter::set_convert_format_func(const AudioConverterOpenParam& param) noexcept
+{
+	convert_format_func_ = get_convert_format_func(
+		param.src_channel_count,
+		param.src_bit_depth,
+		param.dst_channel_count,
+		param.dst_bit_depth);
+
 	if (convert_format_func_ == nullptr)
 	{
 		assert(false && "Unknown format.");
@@ -439,6 +745,58 @@ bool AudioConverter::set_convert_func(const AudioConverterOpenParam& param) noex
 	return true;
 }
 
+bool AudioConverter::set_resampler(const AudioConverterOpenParam& param) noexcept
+{
+	resample_quality_ = param.resample_quality;
+
+	// Stereo to mono is mixed before resampling, mono to stereo is split after.
+	window_channel_count_ = std::min(param.src_channel_count, param.dst_channel_count);
+
+	if (window_channel_count_ == 1)
+	{
+		convert_window_func_ = get_convert_format_func(param.src_channel_count, param.src_bit_depth, 1, 16);
+	}
+
+	step_whole_ = param.src_sample_rate / param.dst_sample_rate;
+	step_fraction_ = param.src_sample_rate % param.dst_sample_rate;
+
+	switch (resample_quality_)
+	{
+		case AudioConverterResampleQuality::nearest:
+			resample_func_ = &AudioConverter::resample<AudioConverterResampleQuality::nearest>;
+			filter_tap_count_ = 1;
+			break;
+
+		case AudioConverterResampleQuality::linear:
+			resample_func_ = &AudioConverter::resample<AudioConverterResampleQuality::linear>;
+			filter_tap_count_ = 2;
+			phase_scale_ = (std::uint64_t{1} << 47) / static_cast<std::uint64_t>(param.dst_sample_rate);
+			break;
+
+		case AudioConverterResampleQuality::polyphase:
+			resample_func_ = &AudioConverter::resample<AudioConverterResampleQuality::polyphase>;
+
+			// Downsampling needs a longer filter for its lower cutoff.
+			filter_tap_count_ = param.src_sample_rate > param.dst_sample_rate ? max_filter_tap_count : 16;
+			phase_scale_ = (std::uint64_t{filter_phase_count} << 32) / static_cast<std::uint64_t>(param.dst_sample_rate);
+			break;
+
+		default:
+			assert(false && "Unsupported resample quality.");
+			return false;
+	}
+
+	filter_lag_ = std::max((filter_tap_count_ / 2) - 1, 0);
+	filter_lead_ = filter_tap_count_ / 2;
+
+	if (resample_quality_ == AudioConverterResampleQuality::polyphase && convert_func_ == &AudioConverter::convert_with_format_and_sample_rate)
+	{
+		make_filter_table();
+	}
+
+	return true;
+}
+
 bool AudioConverter::set_funcs(const AudioConverterOpenParam& param) noexcept
 {
 	if (!set_convert_format_func(param))
@@ -451,9 +809,252 @@ bool AudioConverter::set_funcs(const AudioConverterOpenParam& param) noexcept
 		return false;
 	}
 
+	if (!set_resampler(param))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void AudioConverter::make_filter_table() noexcept
+{
+	constexpr auto pi = 3.14159265358979323846;
+
+	// Cutoff relative to the source's Nyquist frequency, pulled in a little
+	// since the filter is short.
+	const auto cutoff = 0.9 * std::min(1.0, static_cast<double>(dst_sample_rate_) / src_sample_rate_);
+	const auto half_width = filter_tap_count_ / 2.0;
+
+	for (auto phase = 0; phase < filter_phase_count; ++phase)
+	{
+		const auto fraction = static_cast<double>(phase) / filter_phase_count;
+
+		double taps[max_filter_tap_count];
+		auto tap_sum = 0.0;
+
+		for (auto tap = 0; tap < filter_tap_count_; ++tap)
+		{
+			// Distance from the output frame to the tap's frame.
+			const auto x = (tap - filter_lag_) - fraction;
+			const auto sinc_x = cutoff * x * pi;
+			const auto sinc = sinc_x == 0.0 ? 1.0 : std::sin(sinc_x) / sinc_x;
+
+			// Blackman window.
+			const auto window_x = pi * x / half_width;
+			const auto window = 0.42 + (0.5 * std::cos(window_x)) + (0.08 * std::cos(2.0 * window_x));
+
+			taps[tap] = std::abs(x) < half_width ? sinc * window : 0.0;
+			tap_sum += taps[tap];
+		}
+
+		// Normalize each phase to unity gain, putting any rounding error on
+		// the biggest tap.
+		auto coefficient_sum = 0;
+		auto biggest_tap = 0;
+
+		for (auto tap = 0; tap < max_filter_tap_count; ++tap)
+		{
+			auto coefficient = 0;
+
+			if (tap < filter_tap_count_)
+			{
+				coefficient = static_cast<int>(std::lround(taps[tap] / tap_sum * 16384.0));
+
+				if (taps[tap] > taps[biggest_tap])
+				{
+					biggest_tap = tap;
+				}
+			}
+
+			filter_table_[phase][tap] = static_cast<std::int16_t>(coefficient);
+			coefficient_sum += coefficient;
+		}
+
+		filter_table_[phase][biggest_tap] = static_cast<std::int16_t>(filter_table_[phase][biggest_tap] + 16384 - coefficient_sum);
+	}
+}
+
+void AudioConverter::reset_window() noexcept
+{
+	// Silence before the first frame for the filter's earlier taps.
+	for (auto channel = 0; channel < window_channel_count_; ++channel)
+	{
+		std::fill_n(window_[channel], filter_lag_, std::int16_t{});
+	}
+
+	window_frame_count_ = filter_lag_;
+	window_data_end_ = filter_lag_;
+	window_position_ = filter_lag_;
+	window_phase_ = 0;
+	window_skip_count_ = 0;
+	is_drained_ = false;
+}
+
+void AudioConverter::compact_window() noexcept
+{
+	// Drop the frames no output frame needs any more.  Downsampling can step
+	// past the end of the window, in which case the frames it stepped over are
+	// skipped when they're read in.
+	const auto drop_count = window_position_ - filter_lag_;
+
+	if (drop_count <= 0)
+	{
+		return;
+	}
+
+	const auto window_drop_count = std::min(drop_count, window_frame_count_);
+	const auto keep_count = window_frame_count_ - window_drop_count;
+
+	for (auto channel = 0; channel < window_channel_count_; ++channel)
+	{
+		std::memmove(window_[channel], &window_[channel][window_drop_count], keep_count * sizeof(std::int16_t));
+	}
+
+	window_frame_count_ = keep_count;
+	window_data_end_ = std::max(window_data_end_ - window_drop_count, 0);
+	window_position_ -= drop_count;
+	window_skip_count_ += drop_count - window_drop_count;
+}
+
+bool AudioConverter::refill_window() noexcept
+{
+	compact_window();
+
+	if (cache_byte_offset_ == cache_byte_count_)
+	{
+		return false;
+	}
+
+	auto cache_frame_count = (cache_byte_count_ - cache_byte_offset_) / src_frame_size_;
+
+	const auto skip_count = std::min(window_skip_count_, cache_frame_count);
+	cache_byte_offset_ += skip_count * src_frame_size_;
+	cache_frame_count -= skip_count;
+	window_skip_count_ -= skip_count;
+
+	// Leave room to pad the end once the input has been drained.
+	const auto frame_count = std::min(cache_frame_count, window_capacity - max_filter_tap_count - window_frame_count_);
+
+	if (frame_count <= 0)
+	{
+		return cache_frame_count > 0;
+	}
+
+	const auto src_bytes = &cache_[cache_byte_offset_];
+
+	if (window_channel_count_ == 1)
+	{
+		convert_window_func_(src_bytes, reinterpret_cast<std::uint8_t*>(&window_[0][window_frame_count_]), frame_count);
+	}
+	else if (src_bit_depth_ == 8)
+	{
+		for (auto i = 0; i < frame_count; ++i)
+		{
+			window_[0][window_frame_count_ + i] = AudioSampleConverter::u8_to_s16(src_bytes[(2 * i) + 0]);
+			window_[1][window_frame_count_ + i] = AudioSampleConverter::u8_to_s16(src_bytes[(2 * i) + 1]);
+		}
+	}
+	else
+	{
+		const auto src_samples = reinterpret_cast<const std::int16_t*>(src_bytes);
+
+		for (auto i = 0; i < frame_count; ++i)
+		{
+			window_[0][window_frame_count_ + i] = src_samples[(2 * i) + 0];
+			window_[1][window_frame_count_ + i] = src_samples[(2 * i) + 1];
+		}
+	}
+
+	cache_byte_offset_ += frame_count * src_frame_size_;
+	window_frame_count_ += frame_count;
+	window_data_end_ = window_frame_count_;
 	return true;
 }
 
+void AudioConverter::write_frame(std::uint8_t* dst_bytes, int sample_0, int sample_1) const noexcept
+{
+	if (dst_bit_depth_ == 16)
+	{
+		const auto dst_samples = reinterpret_cast<std::int16_t*>(dst_bytes);
+		dst_samples[0] = static_cast<std::int16_t>(sample_0);
+
+		if (dst_channel_count_ == 2)
+		{
+			dst_samples[1] = static_cast<std::int16_t>(sample_1);
+		}
+	}
+	else
+	{
+		dst_bytes[0] = AudioSampleConverter::s16_to_u8(static_cast<std::int16_t>(sample_0));
+
+		if (dst_channel_count_ == 2)
+		{
+			dst_bytes[1] = AudioSampleConverter::s16_to_u8(static_cast<std::int16_t>(sample_1));
+		}
+	}
+}
+
+template<AudioConverterResampleQuality TQuality>
+int AudioConverter::resample(std::uint8_t* dst_bytes, int dst_frame_count) noexcept
+{
+	auto frame_count = 0;
+
+	while (frame_count < dst_frame_count &&
+		window_position_ < window_data_end_ &&
+		window_position_ + filter_lead_ < window_frame_count_)
+	{
+		int samples[AudioLimits::max_channels];
+
+		for (auto channel = 0; channel < window_channel_count_; ++channel)
+		{
+			const auto channel_samples = window_[channel];
+
+			if constexpr (TQuality == AudioConverterResampleQuality::nearest)
+			{
+				samples[channel] = channel_samples[window_position_];
+			}
+			else if constexpr (TQuality == AudioConverterResampleQuality::linear)
+			{
+				// 1.15 fixed point.
+				const auto fraction = static_cast<int>((static_cast<std::uint64_t>(window_phase_) * phase_scale_) >> 32);
+				const auto sample_0 = channel_samples[window_position_];
+				const auto sample_1 = channel_samples[window_position_ + 1];
+				samples[channel] = sample_0 + (((sample_1 - sample_0) * fraction) >> 15);
+			}
+			else
+			{
+				const auto phase = static_cast<int>((static_cast<std::uint64_t>(window_phase_) * phase_scale_) >> 32);
+
+				samples[channel] = filter_sample(
+					&channel_samples[window_position_ - filter_lag_],
+					filter_table_[phase],
+					filter_tap_count_);
+			}
+		}
+
+		if (window_channel_count_ == 1)
+		{
+			samples[1] = samples[0];
+		}
+
+		write_frame(dst_bytes, samples[0], samples[1]);
+		dst_bytes += dst_frame_size_;
+		++frame_count;
+
+		window_position_ += step_whole_;
+		window_phase_ += step_fraction_;
+
+		if (window_phase_ >= dst_sample_rate_)
+		{
+			window_phase_ -= dst_sample_rate_;
+			++window_position_;
+		}
+	}
+
+	return frame_count;
+}
+
 int AudioConverter::convert_without_conversion(void* buffer, int buffer_size) noexcept
 {
 	const auto dst_bytes = static_cast<std::uint8_t*>(buffer);
@@ -477,56 +1078,44 @@ int AudioConverter::convert_without_conversion(void* buffer, int buffer_size) no
 
 int AudioConverter::convert_with_format(void* buffer, int buffer_size) noexcept
 {
-	const auto dst_bytes = static_cast<std::uint8_t*>(buffer);
-	auto dst_offset = 0;
+	const auto rest_src_frame_count = (cache_byte_count_ - cache_byte_offset_) / src_frame_size_;
+	const auto rest_dst_frame_count = buffer_size / dst_frame_size_;
+	const auto frame_count = std::min(rest_src_frame_count, rest_dst_frame_count);
 
-	while (dst_offset < buffer_size)
+	if (frame_count <= 0)
 	{
-		if (cache_byte_offset_ == cache_byte_count_)
-		{
-			break;
-		}
-
-		const auto rest_src_frame_count = (cache_byte_count_ - cache_byte_offset_) / src_frame_size_;
-		const auto rest_dst_frame_count = (buffer_size - dst_offset) / dst_frame_size_;
-		const auto frame_count = std::min(rest_src_frame_count, rest_dst_frame_count);
-
-		for (auto i = 0; i < frame_count; ++i)
-		{
-			convert_format_func_(&cache_[cache_byte_offset_], &dst_bytes[dst_offset]);
-			cache_byte_offset_ += src_frame_size_;
-			dst_offset += dst_frame_size_;
-		}
+		return 0;
 	}
 
-	return dst_offset;
+	convert_format_func_(&cache_[cache_byte_offset_], static_cast<std::uint8_t*>(buffer), frame_count);
+	cache_byte_offset_ += frame_count * src_frame_size_;
+	return frame_count * dst_frame_size_;
 }
 
 int AudioConverter::convert_with_format_and_sample_rate(void* buffer, int buffer_size) noexcept
 {
 	const auto dst_bytes = static_cast<std::uint8_t*>(buffer);
-	auto dst_offset = 0;
+	const auto dst_frame_count = buffer_size / dst_frame_size_;
+	auto dst_frame_offset = 0;
 
-	while (dst_offset < buffer_size)
+	while (true)
 	{
-		if (sample_rate_counter_ >= dst_sample_rate_)
-		{
-			if (cache_byte_offset_ == cache_byte_count_)
-			{
-				break;
-			}
+		dst_frame_offset += (this->*resample_func_)(
+			&dst_bytes[dst_frame_offset * dst_frame_size_],
+			dst_frame_count - dst_frame_offset);
 
-			convert_format_func_(&cache_[cache_byte_offset_], frame_cache_);
-			cache_byte_offset_ += src_frame_size_;
-			sample_rate_counter_ -= dst_sample_rate_;
+		if (dst_frame_offset == dst_frame_count || is_drained_)
+		{
+			break;
 		}
 
-		sample_rate_counter_ += src_sample_rate_;
-		std::copy_n(frame_cache_, dst_frame_size_, &dst_bytes[dst_offset]);
-		dst_offset += dst_frame_size_;
+		if (!refill_window())
+		{
+			break;
+		}
 	}
 
-	return dst_offset;
+	return dst_frame_offset * dst_frame_size_;
 }
 
 } // namespace ltjs
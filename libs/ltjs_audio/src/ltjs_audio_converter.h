@@ -9,6 +9,18 @@
 
 namespace ltjs {
 
+enum class AudioConverterResampleQuality
+{
+	// Repeats or skips whole frames.
+	nearest,
+
+	// Interpolates between neighbouring frames.
+	linear,
+
+	// Windowed-sinc polyphase filter.
+	polyphase,
+};
+
 struct AudioConverterOpenParam
 {
 	int src_channel_count;
@@ -17,6 +29,7 @@ struct AudioConverterOpenParam
 	int dst_channel_count;
 	int dst_bit_depth;
 	int dst_sample_rate;
+	AudioConverterResampleQuality resample_quality;
 };
 
 // ==========================================================================
@@ -32,10 +45,28 @@ public:
 	bool is_open() const noexcept;
 	bool is_filled() const noexcept;
 
+	// Tells the converter that the input has ended, so the frames held back
+	// for the resampling filter can be output.
+	//
+	// Returns:
+	//    - "true" if there are frames left to output.
+	//    - "false" otherwise.
+	//
+	bool drain() noexcept;
+
 private:
-	using FrameCache = std::uint8_t[AudioLimits::max_frame_size];
-	using ConvertFormatFunc = void (*)(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes);
+	static constexpr auto max_filter_tap_count = 32;
+	static constexpr auto filter_phase_count = 128;
+
+	// Source frames held for resampling, plus room for the filter's taps on
+	// either side.
+	static constexpr auto window_capacity = 1024 + (2 * max_filter_tap_count);
+
+	using ConvertFormatFunc = void (*)(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count);
 	using ConvertFunc = int (AudioConverter::*)(void* buffer, int buffer_size);
+	using ResampleFunc = int (AudioConverter::*)(std::uint8_t* dst_bytes, int dst_frame_count);
+	using Window = std::int16_t[AudioLimits::max_channels][window_capacity];
+	using FilterTable = std::int16_t[filter_phase_count][max_filter_tap_count];
 
 private:
 	bool is_open_{};
@@ -49,40 +80,80 @@ private:
 	int dst_frame_size_{};
 	int cache_byte_count_{};
 	int cache_byte_offset_{};
-	int sample_rate_counter_{};
 	const std::uint8_t* cache_{};
 	ConvertFormatFunc convert_format_func_{};
 	ConvertFunc convert_func_{};
-	FrameCache frame_cache_{};
+
+	// Resampling state.
+	//
+	// Source frames are converted to signed 16-bit, one plane per channel,
+	// into the window.  Stereo is mixed down before resampling rather than
+	// after, and mono is only copied to both channels on output.
+	AudioConverterResampleQuality resample_quality_{};
+	ResampleFunc resample_func_{};
+	ConvertFormatFunc convert_window_func_{};
+	int window_channel_count_{};
+	int filter_tap_count_{};
+	int filter_lag_{};
+	int filter_lead_{};
+	int step_whole_{};
+	int step_fraction_{};
+	std::uint64_t phase_scale_{};
+	int window_frame_count_{};
+	int window_data_end_{};
+	int window_position_{};
+	int window_phase_{};
+	int window_skip_count_{};
+	bool is_drained_{};
+	Window window_{};
+	alignas(16) FilterTable filter_table_{};
 
 private:
 	static bool validate(const AudioConverterOpenParam& param) noexcept;
 
-	static void convert_format_c1u8_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
-	static void convert_format_c2u8_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
-	static void convert_format_c1s16_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
-	static void convert_format_c2s16_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
+	static void convert_format_c1u8_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
+	static void convert_format_c2u8_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
+	static void convert_format_c1s16_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
+	static void convert_format_c2s16_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
+
+	static void convert_format_c1u8_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
+	static void convert_format_c1u8_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
+	static void convert_format_c1u8_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
 
-	static void convert_format_c1u8_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
-	static void convert_format_c1u8_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
-	static void convert_format_c1u8_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
+	static void convert_format_c1s16_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
+	static void convert_format_c1s16_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
+	static void convert_format_c1s16_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
 
-	static void convert_format_c1s16_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
-	static void convert_format_c1s16_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
-	static void convert_format_c1s16_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
+	static void convert_format_c2u8_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
+	static void convert_format_c2u8_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
+	static void convert_format_c2u8_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
 
-	static void convert_format_c2u8_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
-	static void convert_format_c2u8_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
-	static void convert_format_c2u8_to_c2s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
+	static void convert_format_c2s16_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
+	static void convert_format_c2s16_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
+	static void convert_format_c2s16_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes, int frame_count) noexcept;
 
-	static void convert_format_c2s16_to_c1u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
-	static void convert_format_c2s16_to_c1s16(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
-	static void convert_format_c2s16_to_c2u8(const std::uint8_t* src_bytes, std::uint8_t* dst_bytes) noexcept;
+	static ConvertFormatFunc get_convert_format_func(
+		int src_channel_count,
+		int src_bit_depth,
+		int dst_channel_count,
+		int dst_bit_depth) noexcept;
+
+	static int filter_sample(const std::int16_t* samples, const std::int16_t* coefficients, int tap_count) noexcept;
 
 	bool set_convert_format_func(const AudioConverterOpenParam& param) noexcept;
 	bool set_convert_func(const AudioConverterOpenParam& param) noexcept;
+	bool set_resampler(const AudioConverterOpenParam& param) noexcept;
 	bool set_funcs(const AudioConverterOpenParam& param) noexcept;
 
+	void make_filter_table() noexcept;
+	void reset_window() noexcept;
+	void compact_window() noexcept;
+	bool refill_window() noexcept;
+	void write_frame(std::uint8_t* dst_bytes, int sample_0, int sample_1) const noexcept;
+
+	template<AudioConverterResampleQuality TQuality>
+	int resample(std::uint8_t* dst_bytes, int dst_frame_count) noexcept;
+
 	int convert_without_conversion(void* buffer, int buffer_size) noexcept;
 	int convert_with_format(void* buffer, int buffer_size) noexcept;
 	int convert_with_format_and_sample_rate(void* buffer, int buffer_size) noexcept;
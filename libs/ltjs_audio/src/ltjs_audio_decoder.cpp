@@ -91,6 +91,7 @@ private:
 	int dst_channel_count_{};
 	int dst_bit_depth_{};
 	int dst_sample_rate_{};
+	ResampleQuality resample_quality_{};
 	int dst_frame_size_{};
 	int dst_frame_count_{};
 	int dst_data_size_{};
@@ -169,6 +170,7 @@ void AudioDecoder::Impl::close() noexcept
 	dst_channel_count_ = 0;
 	dst_bit_depth_ = 0;
 	dst_sample_rate_ = 0;
+	resample_quality_ = ResampleQuality{};
 	dst_frame_size_ = 0;
 	dst_frame_count_ = 0;
 	dst_data_size_ = 0;
@@ -746,6 +748,21 @@ bool AudioDecoder::Impl::open_converter() noexcept
 	param.dst_bit_depth = dst_bit_depth_;
 	param.dst_sample_rate = dst_sample_rate_;
 
+	switch (resample_quality_)
+	{
+		case ResampleQuality::nearest:
+			param.resample_quality = AudioConverterResampleQuality::nearest;
+			break;
+
+		case ResampleQuality::polyphase:
+			param.resample_quality = AudioConverterResampleQuality::polyphase;
+			break;
+
+		default:
+			param.resample_quality = AudioConverterResampleQuality::linear;
+			break;
+	}
+
 	return audio_converter_.open(param);
 }
 
@@ -789,6 +806,7 @@ bool AudioDecoder::Impl::open_internal(const OpenParam& param) noexcept
 	dst_channel_count_ = param.dst_channel_count_ != 0 ? param.dst_channel_count_ : src_channel_count_;
 	dst_bit_depth_ = param.dst_bit_depth_ != 0 ? param.dst_bit_depth_ : src_bit_depth_;
 	dst_sample_rate_ = param.dst_sample_rate_ != 0 ? param.dst_sample_rate_ : src_sample_rate_;
+	resample_quality_ = param.resample_quality_;
 
 	if (!open_converter())
 	{
@@ -889,6 +907,12 @@ int AudioDecoder::Impl::decode_with_conversion(void* buffer, int buffer_size) no
 
 			if (cache_byte_count_ == 0)
 			{
+				// Out of input; the resampler may still be holding some frames back.
+				if (audio_converter_.drain())
+				{
+					continue;
+				}
+
 				break;
 			}
 
@@ -947,6 +971,9 @@ bool AudioDecoder::OpenParam::validate() const noexcept
 		(dst_channel_count_ == 0 || dst_channel_count_ == 1 || dst_channel_count_ == 2) &&
 		(dst_bit_depth_ == 0 || dst_bit_depth_ == 8 || dst_bit_depth_ == 16) &&
 		dst_sample_rate_ >= 0 &&
+		(resample_quality_ == ResampleQuality::linear ||
+			resample_quality_ == ResampleQuality::nearest ||
+			resample_quality_ == ResampleQuality::polyphase) &&
 		stream_ptr_ != nullptr &&
 		stream_ptr_->is_open() &&
 		stream_ptr_->is_readable() &&
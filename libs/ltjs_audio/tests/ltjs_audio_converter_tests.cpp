@@ -0,0 +1,685 @@
+#include "ltjs_audio_converter.h"
+#include "ltjs_audio_sample_converter.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+
+using ltjs::AudioConverter;
+using ltjs::AudioConverterOpenParam;
+using ltjs::AudioConverterResampleQuality;
+using ltjs::AudioSampleConverter;
+
+using Bytes = std::vector<std::uint8_t>;
+
+constexpr auto source_frame_count = 3000;
+
+struct Format
+{
+	int channel_count;
+	int bit_depth;
+};
+
+constexpr Format formats[] = {{1, 8}, {1, 16}, {2, 8}, {2, 16}};
+
+// A triangle wave per channel with some noise on top, made without any
+// floating point so it's the same everywhere.
+std::int16_t source_sample(int frame, int channel) noexcept
+{
+	const auto period = channel == 0 ? 100 : 73;
+	const auto phase = frame % period;
+	const auto triangle = phase < period / 2 ?
+		-20000 + ((40000 * phase) / (period / 2)) :
+		20000 - ((40000 * (phase - (period / 2))) / (period - (period / 2)));
+
+	auto seed = static_cast<std::uint32_t>((frame * 2) + channel);
+	seed = (seed * 1664525U) + 1013904223U;
+	seed = (seed * 1664525U) + 1013904223U;
+	const auto noise = static_cast<int>(seed >> 20) - 2048;
+
+	return static_cast<std::int16_t>(triangle + noise);
+}
+
+Bytes make_source(const Format& format, int frame_count)
+{
+	const auto byte_depth = format.bit_depth / 8;
+	Bytes bytes(frame_count * format.channel_count * byte_depth);
+
+	for (auto frame = 0; frame < frame_count; ++frame)
+	{
+		for (auto channel = 0; channel < format.channel_count; ++channel)
+		{
+			const auto sample = source_sample(frame, channel);
+			const auto index = (frame * format.channel_count) + channel;
+
+			if (format.bit_depth == 16)
+			{
+				std::memcpy(&bytes[index * 2], &sample, 2);
+			}
+			else
+			{
+				bytes[index] = static_cast<std::uint8_t>((sample >> 8) + 128);
+			}
+		}
+	}
+
+	return bytes;
+}
+
+// The source as the converter sees it before resampling: signed 16-bit with
+// stereo mixed down if the output is mono.
+std::vector<std::vector<int>> make_reference_window(const Format& src, const Format& dst, const Bytes& src_bytes)
+{
+	const auto frame_count = static_cast<int>(src_bytes.size()) / (src.channel_count * (src.bit_depth / 8));
+	const auto channel_count = std::min(src.channel_count, dst.channel_count);
+	std::vector<std::vector<int>> window(channel_count, std::vector<int>(frame_count));
+
+	for (auto frame = 0; frame < frame_count; ++frame)
+	{
+		int samples[2];
+
+		for (auto channel = 0; channel < src.channel_count; ++channel)
+		{
+			const auto index = (frame * src.channel_count) + channel;
+
+			if (src.bit_depth == 16)
+			{
+				std::int16_t sample;
+				std::memcpy(&sample, &src_bytes[index * 2], 2);
+				samples[channel] = sample;
+			}
+			else
+			{
+				samples[channel] = AudioSampleConverter::u8_to_s16(src_bytes[index]);
+			}
+		}
+
+		if (channel_count == 1 && src.channel_count == 2)
+		{
+			samples[0] = (samples[0] + samples[1]) / 2;
+		}
+
+		for (auto channel = 0; channel < channel_count; ++channel)
+		{
+			window[channel][frame] = samples[channel];
+		}
+	}
+
+	return window;
+}
+
+// Output sample as a signed 16-bit value, or as unsigned 8-bit widened to int.
+int output_sample(const Format& dst, const Bytes& dst_bytes, int frame, int channel)
+{
+	const auto index = (frame * dst.channel_count) + channel;
+
+	if (dst.bit_depth == 16)
+	{
+		std::int16_t sample;
+		std::memcpy(&sample, &dst_bytes[index * 2], 2);
+		return sample;
+	}
+
+	return dst_bytes[index];
+}
+
+int to_output(const Format& dst, int sample_s16)
+{
+	return dst.bit_depth == 16 ? sample_s16 : AudioSampleConverter::s16_to_u8(static_cast<std::int16_t>(sample_s16));
+}
+
+struct RunParam
+{
+	Format src;
+	Format dst;
+	int src_sample_rate;
+	int dst_sample_rate;
+	AudioConverterResampleQuality quality;
+	int fill_frame_count;
+	int convert_frame_count;
+	bool drain;
+};
+
+// Converts the whole source, filling and converting in chunks of the given
+// sizes.
+Bytes run(const RunParam& param, const Bytes& src_bytes)
+{
+	auto open_param = AudioConverterOpenParam{};
+	open_param.src_channel_count = param.src.channel_count;
+	open_param.src_bit_depth = param.src.bit_depth;
+	open_param.src_sample_rate = param.src_sample_rate;
+	open_param.dst_channel_count = param.dst.channel_count;
+	open_param.dst_bit_depth = param.dst.bit_depth;
+	open_param.dst_sample_rate = param.dst_sample_rate;
+	open_param.resample_quality = param.quality;
+
+	auto converter = AudioConverter{};
+	EXPECT_TRUE(converter.open(open_param));
+
+	const auto src_frame_size = param.src.channel_count * (param.src.bit_depth / 8);
+	const auto dst_frame_size = param.dst.channel_count * (param.dst.bit_depth / 8);
+
+	Bytes dst_bytes;
+	Bytes buffer(param.convert_frame_count * dst_frame_size);
+
+	const auto convert_all = [&]()
+	{
+		while (true)
+		{
+			const auto size = converter.convert(buffer.data(), static_cast<int>(buffer.size()));
+
+			if (size <= 0)
+			{
+				EXPECT_EQ(size, 0);
+				break;
+			}
+
+			dst_bytes.insert(dst_bytes.end(), buffer.begin(), buffer.begin() + size);
+		}
+	};
+
+	for (auto offset = 0; offset < static_cast<int>(src_bytes.size()); )
+	{
+		const auto size = std::min(param.fill_frame_count * src_frame_size, static_cast<int>(src_bytes.size()) - offset);
+		EXPECT_EQ(converter.fill(&src_bytes[offset], size), size);
+		offset += size;
+
+		convert_all();
+		EXPECT_FALSE(converter.is_filled());
+	}
+
+	if (param.drain && converter.drain())
+	{
+		convert_all();
+	}
+
+	return dst_bytes;
+}
+
+std::uint64_t fnv1a(const Bytes& bytes) noexcept
+{
+	auto hash = std::uint64_t{14695981039346656037ULL};
+
+	for (const auto byte : bytes)
+	{
+		hash ^= byte;
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+// Number of output frames for a whole stream, one for each output frame that
+// starts before the end of the source.
+int expected_frame_count(int src_frame_count, int src_sample_rate, int dst_sample_rate)
+{
+	const auto product = static_cast<std::int64_t>(src_frame_count) * dst_sample_rate;
+	return static_cast<int>((product + src_sample_rate - 1) / src_sample_rate);
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Format conversion
+// -----------------------------------------------------------------------------
+
+TEST(AudioConverter, Format_EveryPairMatchesSampleConverter)
+{
+	for (const auto& src : formats)
+	{
+		for (const auto& dst : formats)
+		{
+			SCOPED_TRACE(testing::Message() << "c" << src.channel_count << "b" << src.bit_depth <<
+				" -> c" << dst.channel_count << "b" << dst.bit_depth);
+
+			const auto src_bytes = make_source(src, source_frame_count);
+			const auto dst_bytes = run({src, dst, 22050, 22050, AudioConverterResampleQuality::linear, 317, 101, true}, src_bytes);
+			ASSERT_EQ(dst_bytes.size(), static_cast<std::size_t>(source_frame_count * dst.channel_count * (dst.bit_depth / 8)));
+
+			const auto window = make_reference_window(src, dst, src_bytes);
+
+			for (auto frame = 0; frame < source_frame_count; ++frame)
+			{
+				for (auto channel = 0; channel < dst.channel_count; ++channel)
+				{
+					const auto& window_channel = window[std::min(channel, static_cast<int>(window.size()) - 1)];
+
+					// Unsigned 8-bit to unsigned 8-bit is copied or averaged
+					// as is.
+					auto expected = to_output(dst, window_channel[frame]);
+
+					if (src.bit_depth == 8 && dst.bit_depth == 8)
+					{
+						const auto& src_frame = &src_bytes[frame * src.channel_count];
+						expected = src.channel_count == dst.channel_count ?
+							src_frame[channel] :
+							src.channel_count == 2 ? (src_frame[0] + src_frame[1]) / 2 : src_frame[0];
+					}
+
+					ASSERT_EQ(output_sample(dst, dst_bytes, frame, channel), expected) << "frame " << frame << " channel " << channel;
+				}
+			}
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Resampling against a reference
+// -----------------------------------------------------------------------------
+
+namespace {
+
+struct RatePair
+{
+	int src_sample_rate;
+	int dst_sample_rate;
+};
+
+constexpr RatePair rate_pairs[] = {{22050, 48000}, {44100, 22050}, {48000, 11025}};
+
+} // namespace
+
+TEST(AudioConverter, Nearest_PicksTheFrameBeforeEachOutputFrame)
+{
+	for (const auto& rates : rate_pairs)
+	{
+		for (const auto& src : formats)
+		{
+			for (const auto& dst : formats)
+			{
+				SCOPED_TRACE(testing::Message() << rates.src_sample_rate << " -> " << rates.dst_sample_rate << ", c" <<
+					src.channel_count << "b" << src.bit_depth << " -> c" << dst.channel_count << "b" << dst.bit_depth);
+
+				const auto src_bytes = make_source(src, source_frame_count);
+				const auto dst_bytes = run({src, dst, rates.src_sample_rate, rates.dst_sample_rate, AudioConverterResampleQuality::nearest, 317, 101, true}, src_bytes);
+
+				const auto frame_count = expected_frame_count(source_frame_count, rates.src_sample_rate, rates.dst_sample_rate);
+				ASSERT_EQ(dst_bytes.size(), static_cast<std::size_t>(frame_count * dst.channel_count * (dst.bit_depth / 8)));
+
+				const auto window = make_reference_window(src, dst, src_bytes);
+
+				for (auto frame = 0; frame < frame_count; ++frame)
+				{
+					const auto src_frame = static_cast<int>((static_cast<std::int64_t>(frame) * rates.src_sample_rate) / rates.dst_sample_rate);
+
+					for (auto channel = 0; channel < dst.channel_count; ++channel)
+					{
+						const auto& window_channel = window[std::min(channel, static_cast<int>(window.size()) - 1)];
+						ASSERT_EQ(output_sample(dst, dst_bytes, frame, channel), to_output(dst, window_channel[src_frame])) << "frame " << frame;
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST(AudioConverter, Linear_InterpolatesBetweenNeighbouringFrames)
+{
+	for (const auto& rates : rate_pairs)
+	{
+		for (const auto& src : formats)
+		{
+			for (const auto& dst : formats)
+			{
+				SCOPED_TRACE(testing::Message() << rates.src_sample_rate << " -> " << rates.dst_sample_rate << ", c" <<
+					src.channel_count << "b" << src.bit_depth << " -> c" << dst.channel_count << "b" << dst.bit_depth);
+
+				const auto src_bytes = make_source(src, source_frame_count);
+				const auto dst_bytes = run({src, dst, rates.src_sample_rate, rates.dst_sample_rate, AudioConverterResampleQuality::linear, 317, 101, true}, src_bytes);
+
+				const auto frame_count = expected_frame_count(source_frame_count, rates.src_sample_rate, rates.dst_sample_rate);
+				ASSERT_EQ(dst_bytes.size(), static_cast<std::size_t>(frame_count * dst.channel_count * (dst.bit_depth / 8)));
+
+				const auto window = make_reference_window(src, dst, src_bytes);
+
+				for (auto frame = 0; frame < frame_count; ++frame)
+				{
+					const auto position = static_cast<std::int64_t>(frame) * rates.src_sample_rate;
+					const auto src_frame = static_cast<int>(position / rates.dst_sample_rate);
+					const auto fraction = static_cast<double>(position % rates.dst_sample_rate) / rates.dst_sample_rate;
+
+					for (auto channel = 0; channel < dst.channel_count; ++channel)
+					{
+						// The last frame is held once the input has run out.
+						const auto& window_channel = window[std::min(channel, static_cast<int>(window.size()) - 1)];
+						const auto sample_0 = window_channel[src_frame];
+						const auto sample_1 = window_channel[std::min(src_frame + 1, source_frame_count - 1)];
+						const auto expected = sample_0 + ((sample_1 - sample_0) * fraction);
+
+						// Q15 with truncation, so a sample or so out, which
+						// can tip an 8-bit sample over.
+						const auto tolerance = 2.0;
+						const auto actual = output_sample(dst, dst_bytes, frame, channel);
+
+						if (dst.bit_depth == 16)
+						{
+							ASSERT_NEAR(actual, expected, tolerance) << "frame " << frame;
+						}
+						else
+						{
+							ASSERT_LE(std::abs(actual - to_output(dst, static_cast<int>(expected))), 1) << "frame " << frame;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST(AudioConverter, Polyphase_PassesDCAtUnityGain)
+{
+	for (const auto& rates : rate_pairs)
+	{
+		SCOPED_TRACE(testing::Message() << rates.src_sample_rate << " -> " << rates.dst_sample_rate);
+
+		const auto src = Format{1, 16};
+		const auto dc = std::int16_t{12345};
+		Bytes src_bytes(source_frame_count * 2);
+
+		for (auto frame = 0; frame < source_frame_count; ++frame)
+		{
+			std::memcpy(&src_bytes[frame * 2], &dc, 2);
+		}
+
+		const auto dst_bytes = run({src, src, rates.src_sample_rate, rates.dst_sample_rate, AudioConverterResampleQuality::polyphase, 317, 101, true}, src_bytes);
+
+		const auto frame_count = expected_frame_count(source_frame_count, rates.src_sample_rate, rates.dst_sample_rate);
+		ASSERT_EQ(dst_bytes.size(), static_cast<std::size_t>(frame_count * 2));
+
+		// Away from the silence either side of the stream every phase sums
+		// to exactly one.
+		const auto margin = frame_count / 10;
+
+		for (auto frame = margin; frame < frame_count - margin; ++frame)
+		{
+			ASSERT_EQ(output_sample(src, dst_bytes, frame, 0), dc) << "frame " << frame;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Golden output
+// -----------------------------------------------------------------------------
+
+namespace {
+
+struct GoldenCase
+{
+	int src_channel_count;
+	int src_bit_depth;
+	int dst_channel_count;
+	int dst_bit_depth;
+	AudioConverterResampleQuality quality;
+	int src_sample_rate;
+	int dst_sample_rate;
+	std::uint64_t hash;
+};
+
+constexpr auto nearest = AudioConverterResampleQuality::nearest;
+constexpr auto linear = AudioConverterResampleQuality::linear;
+constexpr auto polyphase = AudioConverterResampleQuality::polyphase;
+
+// FNV-1a of the whole drained output for the test signal.
+constexpr GoldenCase golden_cases[] = {
+	{1, 8, 1, 8, nearest, 22050, 48000, 0x665576D60A6BC154ULL},
+	{1, 8, 1, 16, nearest, 22050, 48000, 0x4FE7AACE01277133ULL},
+	{1, 8, 2, 8, nearest, 22050, 48000, 0x6A5786F106B900B3ULL},
+	{1, 8, 2, 16, nearest, 22050, 48000, 0xD45F2F176AFA4F79ULL},
+	{1, 16, 1, 8, nearest, 22050, 48000, 0xE05EE4AB706BF5F9ULL},
+	{1, 16, 1, 16, nearest, 22050, 48000, 0x08F2B0EB7958DE77ULL},
+	{1, 16, 2, 8, nearest, 22050, 48000, 0xF23378BB1E062F69ULL},
+	{1, 16, 2, 16, nearest, 22050, 48000, 0xAC4E0767F9BE60ADULL},
+	{2, 8, 1, 8, nearest, 22050, 48000, 0x1A7A7F94DEB4D21AULL},
+	{2, 8, 1, 16, nearest, 22050, 48000, 0x58C449302505E21BULL},
+	{2, 8, 2, 8, nearest, 22050, 48000, 0xACF320E393BF5E9CULL},
+	{2, 8, 2, 16, nearest, 22050, 48000, 0x13F85709083506CBULL},
+	{2, 16, 1, 8, nearest, 22050, 48000, 0xD0DA86F050190FD0ULL},
+	{2, 16, 1, 16, nearest, 22050, 48000, 0x6FDCDD4CF4A74167ULL},
+	{2, 16, 2, 8, nearest, 22050, 48000, 0x8450721EF1DCF87CULL},
+	{2, 16, 2, 16, nearest, 22050, 48000, 0xF846311733AE132DULL},
+
+	{1, 8, 1, 8, linear, 22050, 48000, 0x0F17D8D69428823FULL},
+	{1, 8, 1, 16, linear, 22050, 48000, 0x882C18174386F6A5ULL},
+	{1, 8, 2, 8, linear, 22050, 48000, 0xD1565F43684F5B9DULL},
+	{1, 8, 2, 16, linear, 22050, 48000, 0x18AFFC4A277C10D1ULL},
+	{1, 16, 1, 8, linear, 22050, 48000, 0xC98E838FF47B4098ULL},
+	{1, 16, 1, 16, linear, 22050, 48000, 0x6B8A8567AB1FB21CULL},
+	{1, 16, 2, 8, linear, 22050, 48000, 0x3277D0715F61F657ULL},
+	{1, 16, 2, 16, linear, 22050, 48000, 0x6DE7B8C493C817F5ULL},
+	{2, 8, 1, 8, linear, 22050, 48000, 0x741C826AD40E8358ULL},
+	{2, 8, 1, 16, linear, 22050, 48000, 0x465BF4ED544CD4C8ULL},
+	{2, 8, 2, 8, linear, 22050, 48000, 0xDA8113A47D263285ULL},
+	{2, 8, 2, 16, linear, 22050, 48000, 0x117587CE4036E9D2ULL},
+	{2, 16, 1, 8, linear, 22050, 48000, 0xE313A81DD5B0FEFCULL},
+	{2, 16, 1, 16, linear, 22050, 48000, 0xF8868503217CFAFAULL},
+	{2, 16, 2, 8, linear, 22050, 48000, 0xCBFB7BE6B65341C7ULL},
+	{2, 16, 2, 16, linear, 22050, 48000, 0xC61C284068B816D4ULL},
+
+	{1, 8, 1, 8, polyphase, 22050, 48000, 0x3B7BC1F69FA43FB2ULL},
+	{1, 8, 1, 16, polyphase, 22050, 48000, 0x81A150A1EBE153EFULL},
+	{1, 8, 2, 8, polyphase, 22050, 48000, 0x638FDE9B4D161BFBULL},
+	{1, 8, 2, 16, polyphase, 22050, 48000, 0x4AE2D2CFA6275509ULL},
+	{1, 16, 1, 8, polyphase, 22050, 48000, 0xD9EBD47D65055B7EULL},
+	{1, 16, 1, 16, polyphase, 22050, 48000, 0x8F4B78D61B1CEE1DULL},
+	{1, 16, 2, 8, polyphase, 22050, 48000, 0xADEE0735259365CFULL},
+	{1, 16, 2, 16, polyphase, 22050, 48000, 0x3D1A84507DEAE3B5ULL},
+	{2, 8, 1, 8, polyphase, 22050, 48000, 0xB87BB844AC1E5803ULL},
+	{2, 8, 1, 16, polyphase, 22050, 48000, 0x119551261C41BC9FULL},
+	{2, 8, 2, 8, polyphase, 22050, 48000, 0x2C54C0FDF42784C1ULL},
+	{2, 8, 2, 16, polyphase, 22050, 48000, 0x23D1ACD8976F09D7ULL},
+	{2, 16, 1, 8, polyphase, 22050, 48000, 0x4E4A2F3DB936F22BULL},
+	{2, 16, 1, 16, polyphase, 22050, 48000, 0x81AB9156001FC67BULL},
+	{2, 16, 2, 8, polyphase, 22050, 48000, 0x9C181895DBC8E5B6ULL},
+	{2, 16, 2, 16, polyphase, 22050, 48000, 0xCC22CBC36A50F647ULL},
+
+	{1, 8, 1, 8, nearest, 44100, 32000, 0x58CB073E0939CDD9ULL},
+	{1, 8, 1, 16, nearest, 44100, 32000, 0xBBC1C4D24730B431ULL},
+	{1, 8, 2, 8, nearest, 44100, 32000, 0x0ED5571D50269BB1ULL},
+	{1, 8, 2, 16, nearest, 44100, 32000, 0x1E09495654A5D225ULL},
+	{1, 16, 1, 8, nearest, 44100, 32000, 0x39592974B04CED63ULL},
+	{1, 16, 1, 16, nearest, 44100, 32000, 0x758803861DFCCE8AULL},
+	{1, 16, 2, 8, nearest, 44100, 32000, 0x1AD439E5797331B9ULL},
+	{1, 16, 2, 16, nearest, 44100, 32000, 0x2EFED8ECC899945DULL},
+	{2, 8, 1, 8, nearest, 44100, 32000, 0xE08A5153BA5A3A18ULL},
+	{2, 8, 1, 16, nearest, 44100, 32000, 0x4E92973BC812694DULL},
+	{2, 8, 2, 8, nearest, 44100, 32000, 0x86DF1E8E15D336E2ULL},
+	{2, 8, 2, 16, nearest, 44100, 32000, 0x3906A1310913C0AFULL},
+	{2, 16, 1, 8, nearest, 44100, 32000, 0x66550E43D6E67644ULL},
+	{2, 16, 1, 16, nearest, 44100, 32000, 0x7632CDC18B4C716FULL},
+	{2, 16, 2, 8, nearest, 44100, 32000, 0xFC9FE0167AAB8035ULL},
+	{2, 16, 2, 16, nearest, 44100, 32000, 0x50AA3BCCBCB8ECD7ULL},
+
+	{1, 8, 1, 8, linear, 44100, 32000, 0x36F663ED91E98FBDULL},
+	{1, 8, 1, 16, linear, 44100, 32000, 0x13A8CE72122CF590ULL},
+	{1, 8, 2, 8, linear, 44100, 32000, 0x65C1F270E6270ED1ULL},
+	{1, 8, 2, 16, linear, 44100, 32000, 0x26F9D9196BC81DDDULL},
+	{1, 16, 1, 8, linear, 44100, 32000, 0x04E6FF9FEA7FE7A4ULL},
+	{1, 16, 1, 16, linear, 44100, 32000, 0x338C99438B05C937ULL},
+	{1, 16, 2, 8, linear, 44100, 32000, 0x4BB61D16668B08EFULL},
+	{1, 16, 2, 16, linear, 44100, 32000, 0x290E1EA431C66C05ULL},
+	{2, 8, 1, 8, linear, 44100, 32000, 0xE4F1704E64625BF6ULL},
+	{2, 8, 1, 16, linear, 44100, 32000, 0x1DDD35B382191B5EULL},
+	{2, 8, 2, 8, linear, 44100, 32000, 0x594A58A478745988ULL},
+	{2, 8, 2, 16, linear, 44100, 32000, 0xC7E858530517EC4DULL},
+	{2, 16, 1, 8, linear, 44100, 32000, 0x6B28D1D56A58E15EULL},
+	{2, 16, 1, 16, linear, 44100, 32000, 0xFD3C7566F8B20C51ULL},
+	{2, 16, 2, 8, linear, 44100, 32000, 0xD147C0A63CEF645BULL},
+	{2, 16, 2, 16, linear, 44100, 32000, 0x1D553A8DB858C144ULL},
+
+	{1, 8, 1, 8, polyphase, 44100, 32000, 0x489FDEBA2B0EA998ULL},
+	{1, 8, 1, 16, polyphase, 44100, 32000, 0x1AC5528FEF53B888ULL},
+	{1, 8, 2, 8, polyphase, 44100, 32000, 0x11278C9F4148D86FULL},
+	{1, 8, 2, 16, polyphase, 44100, 32000, 0x041E6896818F711DULL},
+	{1, 16, 1, 8, polyphase, 44100, 32000, 0x55E5C6376CEEA11AULL},
+	{1, 16, 1, 16, polyphase, 44100, 32000, 0x12A3D551E82D26FCULL},
+	{1, 16, 2, 8, polyphase, 44100, 32000, 0x3C8EEEE5E72FD4CFULL},
+	{1, 16, 2, 16, polyphase, 44100, 32000, 0xB4714EA916EC893DULL},
+	{2, 8, 1, 8, polyphase, 44100, 32000, 0x6ECF8C8FEAF57A64ULL},
+	{2, 8, 1, 16, polyphase, 44100, 32000, 0x24C2C055EC2A2984ULL},
+	{2, 8, 2, 8, polyphase, 44100, 32000, 0xF3381DDDC00D4B03ULL},
+	{2, 8, 2, 16, polyphase, 44100, 32000, 0x05CCDC5114B04E73ULL},
+	{2, 16, 1, 8, polyphase, 44100, 32000, 0xD45D91CF01204D6AULL},
+	{2, 16, 1, 16, polyphase, 44100, 32000, 0xA6A5CDFDC8D7DCF1ULL},
+	{2, 16, 2, 8, polyphase, 44100, 32000, 0x545ED54C532F3C89ULL},
+	{2, 16, 2, 16, polyphase, 44100, 32000, 0x160B7151F32EC000ULL},
+};
+
+class AudioConverterGolden : public testing::TestWithParam<GoldenCase>
+{
+};
+
+std::string golden_case_name(const testing::TestParamInfo<GoldenCase>& info)
+{
+	const auto& golden = info.param;
+	const char* const quality_names[] = {"nearest", "linear", "polyphase"};
+
+	return
+		"c" + std::to_string(golden.src_channel_count) + "b" + std::to_string(golden.src_bit_depth) +
+		"_c" + std::to_string(golden.dst_channel_count) + "b" + std::to_string(golden.dst_bit_depth) +
+		"_" + quality_names[static_cast<int>(golden.quality)] +
+		"_" + std::to_string(golden.src_sample_rate) + "_" + std::to_string(golden.dst_sample_rate);
+}
+
+} // namespace
+
+TEST_P(AudioConverterGolden, MatchesWithAnyChunking)
+{
+	const auto& golden = GetParam();
+	const auto src = Format{golden.src_channel_count, golden.src_bit_depth};
+	const auto dst = Format{golden.dst_channel_count, golden.dst_bit_depth};
+	const auto src_bytes = make_source(src, source_frame_count);
+
+	// One big fill, then odd sizes that split the window refills and the
+	// output differently.
+	const int chunkings[][2] = {{source_frame_count, 4096}, {317, 101}, {1, 7}, {1031, 1}};
+
+	for (const auto& chunking : chunkings)
+	{
+		SCOPED_TRACE(testing::Message() << "fill " << chunking[0] << ", convert " << chunking[1]);
+
+		const auto dst_bytes = run({src, dst, golden.src_sample_rate, golden.dst_sample_rate, golden.quality, chunking[0], chunking[1], true}, src_bytes);
+		EXPECT_EQ(fnv1a(dst_bytes), golden.hash);
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(AudioConverter, AudioConverterGolden, testing::ValuesIn(golden_cases), golden_case_name);
+
+// -----------------------------------------------------------------------------
+// Draining
+// -----------------------------------------------------------------------------
+
+namespace {
+
+AudioConverter open_converter(int src_sample_rate, int dst_sample_rate, AudioConverterResampleQuality quality)
+{
+	auto param = AudioConverterOpenParam{};
+	param.src_channel_count = 1;
+	param.src_bit_depth = 16;
+	param.src_sample_rate = src_sample_rate;
+	param.dst_channel_count = 1;
+	param.dst_bit_depth = 16;
+	param.dst_sample_rate = dst_sample_rate;
+	param.resample_quality = quality;
+
+	auto converter = AudioConverter{};
+	EXPECT_TRUE(converter.open(param));
+	return converter;
+}
+
+} // namespace
+
+TEST(AudioConverter, Drain_FlushesTheFramesHeldForTheFilter)
+{
+	const auto src = Format{1, 16};
+	const auto src_bytes = make_source(src, source_frame_count);
+	const auto frame_count = expected_frame_count(source_frame_count, 22050, 48000);
+
+	for (const auto quality : {nearest, linear, polyphase})
+	{
+		SCOPED_TRACE(testing::Message() << "quality " << static_cast<int>(quality));
+
+		const auto undrained = run({src, src, 22050, 48000, quality, 317, 101, false}, src_bytes);
+		const auto drained = run({src, src, 22050, 48000, quality, 317, 101, true}, src_bytes);
+
+		EXPECT_EQ(drained.size(), static_cast<std::size_t>(frame_count * 2));
+
+		// Only the filters look ahead.
+		if (quality == nearest)
+		{
+			EXPECT_EQ(undrained, drained);
+		}
+		else
+		{
+			ASSERT_LT(undrained.size(), drained.size());
+			EXPECT_TRUE(std::equal(undrained.begin(), undrained.end(), drained.begin()));
+		}
+	}
+}
+
+TEST(AudioConverter, Drain_OnlyOncePerStream)
+{
+	auto converter = open_converter(22050, 44100, linear);
+	const auto src_bytes = make_source({1, 16}, 100);
+	std::int16_t buffer[512];
+
+	ASSERT_EQ(converter.fill(src_bytes.data(), static_cast<int>(src_bytes.size())), static_cast<int>(src_bytes.size()));
+
+	// Not while there's input left.
+	EXPECT_FALSE(converter.drain());
+
+	// The last two frames need the one after the end.
+	EXPECT_EQ(converter.convert(buffer, sizeof(buffer)), 2 * 198);
+	EXPECT_FALSE(converter.is_filled());
+
+	EXPECT_TRUE(converter.drain());
+	EXPECT_FALSE(converter.drain());
+
+	// The last frame is held, so the tail is the last source sample.
+	EXPECT_EQ(converter.convert(buffer, sizeof(buffer)), 2 * 2);
+	EXPECT_EQ(buffer[0], source_sample(99, 0));
+	EXPECT_EQ(buffer[1], source_sample(99, 0));
+	EXPECT_EQ(converter.convert(buffer, sizeof(buffer)), 0);
+
+	// Nothing left to fill, and nothing more comes out once drained.
+	EXPECT_EQ(converter.fill(src_bytes.data(), static_cast<int>(src_bytes.size())), static_cast<int>(src_bytes.size()));
+	EXPECT_EQ(converter.convert(buffer, sizeof(buffer)), 0);
+}
+
+TEST(AudioConverter, Drain_ResetStartsANewStream)
+{
+	auto converter = open_converter(44100, 22050, polyphase);
+	const auto src_bytes = make_source({1, 16}, 1000);
+	std::int16_t buffer[1024];
+
+	const auto convert_stream = [&]()
+	{
+		EXPECT_EQ(converter.fill(src_bytes.data(), static_cast<int>(src_bytes.size())), static_cast<int>(src_bytes.size()));
+		auto frame_count = converter.convert(buffer, sizeof(buffer)) / 2;
+		EXPECT_TRUE(converter.drain());
+		frame_count += converter.convert(&buffer[frame_count], sizeof(buffer) - (frame_count * 2)) / 2;
+		return frame_count;
+	};
+
+	EXPECT_EQ(convert_stream(), 500);
+	ASSERT_TRUE(converter.reset());
+	EXPECT_EQ(convert_stream(), 500);
+}
+
+TEST(AudioConverter, Drain_NothingToDoWithoutResampling)
+{
+	auto converter = open_converter(22050, 22050, polyphase);
+	const auto src_bytes = make_source({1, 16}, 100);
+	std::int16_t buffer[128];
+
+	ASSERT_EQ(converter.fill(src_bytes.data(), static_cast<int>(src_bytes.size())), static_cast<int>(src_bytes.size()));
+	EXPECT_EQ(converter.convert(buffer, sizeof(buffer)), static_cast<int>(src_bytes.size()));
+	EXPECT_FALSE(converter.drain());
+}